@@ -145,6 +145,12 @@ macro(write_configtable)
   string(APPEND out "DPDK NetDevice                : ")
   check_on_or_off("NS3_DPDK" "ENABLE_DPDKDEVNET")
 
+  string(APPEND out "Event pool                    : ")
+  check_on_or_off("NS3_EVENT_POOL" "ENABLE_EVENT_POOL")
+
+  string(APPEND out "Event profiler                : ")
+  check_on_or_off("NS3_EVENT_PROFILER" "NS3_EVENT_PROFILER")
+
   string(APPEND out "Emulation FdNetDevice         : ")
   check_on_or_off("ENABLE_EMU" "ENABLE_EMUNETDEV")
 
@@ -166,6 +172,9 @@ macro(write_configtable)
   string(APPEND out "MPI Support                   : ")
   check_on_or_off("NS3_MPI" "MPI_FOUND")
 
+  string(APPEND out "Multithreaded simulator       : ")
+  check_on_or_off("NS3_MULTITHREADED" "ENABLE_MULTITHREADED")
+
   string(APPEND out "ns-3 Click Integration        : ")
   check_on_or_off("ON" "NS3_CLICK")
 
@@ -363,6 +363,29 @@ macro(process_options)
     add_definitions(-DENABLE_DES_METRICS)
   endif()
 
+  set(ENABLE_EVENT_POOL OFF)
+  if(${NS3_EVENT_POOL})
+    if(${NS3_SANITIZE} OR ${NS3_SANITIZE_MEMORY})
+      # The event pool would hide event use-after-free errors
+      set(ENABLE_EVENT_POOL_REASON "sanitizers enabled")
+    else()
+      set(ENABLE_EVENT_POOL ON)
+      add_definitions(-DNS3_EVENT_POOL_ENABLE)
+    endif()
+  endif()
+
+  if(${NS3_EVENT_PROFILER})
+    add_definitions(-DNS3_EVENT_PROFILER_ENABLE)
+  endif()
+
+  set(ENABLE_MULTITHREADED OFF)
+  if(${NS3_MULTITHREADED})
+    # Atomic reference counts for the objects and packets shared by the
+    # threads of MultithreadedSimulatorImpl
+    set(ENABLE_MULTITHREADED ON)
+    add_definitions(-DNS3_MULTITHREADED_ENABLE)
+  endif()
+
   if(${NS3_SANITIZE} AND ${NS3_SANITIZE_MEMORY})
     message(
       FATAL_ERROR
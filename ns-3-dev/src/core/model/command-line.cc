@@ -22,6 +22,7 @@
 #include "config.h"
 #include "des-metrics.h"
 #include "environment-variable.h"
+#include "event-profiler.h"
 #include "global-value.h"
 #include "log.h"
 #include "string.h"
@@ -201,6 +202,9 @@ CommandLine::Parse(std::vector<std::string> args)
 
     if (!args.empty())
     {
+#ifdef NS3_EVENT_PROFILER_ENABLE
+        EventProfiler::Get()->Initialize({args.front()});
+#endif
         args.erase(args.begin()); // discard the program name
 
         HandleHardOptions(args);
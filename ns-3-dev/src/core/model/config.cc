@@ -26,7 +26,9 @@
 #include "pointer.h"
 #include "singleton.h"
 
+#include <limits>
 #include <sstream>
+#include <unordered_map>
 
 /**
  * \file
@@ -216,6 +218,12 @@ class ArrayMatcher
     bool Matches(std::size_t i) const;
 
   private:
+    /**
+     * Parse a Config path specification into the ranges of indices it matches.
+     *
+     * \param [in] element The Config path specification.
+     */
+    void Parse(std::string element);
     /**
      * Convert a string to an \c uint32_t.
      *
@@ -224,8 +232,11 @@ class ArrayMatcher
      * \returns \c true if the string could be converted.
      */
     bool StringToUint32(std::string str, uint32_t* value) const;
+
     /** The Config path element. */
     std::string m_element;
+    /** The ranges of indices matched by the element, bounds included. */
+    std::vector<std::pair<std::size_t, std::size_t>> m_ranges;
 
 }; // class ArrayMatcher
 
@@ -233,65 +244,60 @@ ArrayMatcher::ArrayMatcher(std::string element)
     : m_element(element)
 {
     NS_LOG_FUNCTION(this << element);
+    Parse(element);
 }
 
-bool
-ArrayMatcher::Matches(std::size_t i) const
+void
+ArrayMatcher::Parse(std::string element)
 {
-    NS_LOG_FUNCTION(this << i);
-    if (m_element == "*")
+    NS_LOG_FUNCTION(this << element);
+    if (element == "*")
     {
-        NS_LOG_DEBUG("Array " << i << " matches *");
-        return true;
+        m_ranges.emplace_back(0, std::numeric_limits<std::size_t>::max());
+        return;
     }
     std::string::size_type tmp;
-    tmp = m_element.find('|');
+    tmp = element.find('|');
     if (tmp != std::string::npos)
     {
-        std::string left = m_element.substr(0, tmp - 0);
-        std::string right = m_element.substr(tmp + 1, m_element.size() - (tmp + 1));
-        ArrayMatcher matcher = ArrayMatcher(left);
-        if (matcher.Matches(i))
-        {
-            NS_LOG_DEBUG("Array " << i << " matches " << left);
-            return true;
-        }
-        matcher = ArrayMatcher(right);
-        if (matcher.Matches(i))
-        {
-            NS_LOG_DEBUG("Array " << i << " matches " << right);
-            return true;
-        }
-        NS_LOG_DEBUG("Array " << i << " does not match " << m_element);
-        return false;
+        Parse(element.substr(0, tmp - 0));
+        Parse(element.substr(tmp + 1, element.size() - (tmp + 1)));
+        return;
     }
-    std::string::size_type leftBracket = m_element.find('[');
-    std::string::size_type rightBracket = m_element.find(']');
-    std::string::size_type dash = m_element.find('-');
-    if (leftBracket == 0 && rightBracket == m_element.size() - 1 && dash > leftBracket &&
+    std::string::size_type leftBracket = element.find('[');
+    std::string::size_type rightBracket = element.find(']');
+    std::string::size_type dash = element.find('-');
+    if (leftBracket == 0 && rightBracket == element.size() - 1 && dash > leftBracket &&
         dash < rightBracket)
     {
-        std::string lowerBound = m_element.substr(leftBracket + 1, dash - (leftBracket + 1));
-        std::string upperBound = m_element.substr(dash + 1, rightBracket - (dash + 1));
+        std::string lowerBound = element.substr(leftBracket + 1, dash - (leftBracket + 1));
+        std::string upperBound = element.substr(dash + 1, rightBracket - (dash + 1));
         uint32_t min;
         uint32_t max;
-        if (StringToUint32(lowerBound, &min) && StringToUint32(upperBound, &max) && i >= min &&
-            i <= max)
+        if (StringToUint32(lowerBound, &min) && StringToUint32(upperBound, &max))
         {
-            NS_LOG_DEBUG("Array " << i << " matches " << m_element);
-            return true;
-        }
-        else
-        {
-            NS_LOG_DEBUG("Array " << i << " does not " << m_element);
-            return false;
+            m_ranges.emplace_back(min, max);
         }
+        return;
     }
     uint32_t value;
-    if (StringToUint32(m_element, &value) && i == value)
+    if (StringToUint32(element, &value))
     {
-        NS_LOG_DEBUG("Array " << i << " matches " << m_element);
-        return true;
+        m_ranges.emplace_back(value, value);
+    }
+}
+
+bool
+ArrayMatcher::Matches(std::size_t i) const
+{
+    NS_LOG_FUNCTION(this << i);
+    for (const auto& range : m_ranges)
+    {
+        if (i >= range.first && i <= range.second)
+        {
+            NS_LOG_DEBUG("Array " << i << " matches " << m_element);
+            return true;
+        }
     }
     NS_LOG_DEBUG("Array " << i << " does not match " << m_element);
     return false;
@@ -309,144 +315,220 @@ ArrayMatcher::StringToUint32(std::string str, uint32_t* value) const
 
 /**
  * \ingroup config-impl
- * Abstract class to parse Config paths into object references.
+ * A Config path parsed into its elements, to be resolved into object references.
  */
-class Resolver
+class PathMatcher
 {
   public:
     /**
-     * Construct from a base Config path.
+     * Construct from a Config path.
      *
      * \param [in] path The Config path.
      */
-    Resolver(std::string path);
-    /** Destructor. */
-    virtual ~Resolver();
+    PathMatcher(std::string path);
+
+    /** \returns The Config path. */
+    std::string GetPath() const;
 
     /**
-     * Parse the stored Config path into an object reference,
-     * beginning at the indicated root object.
+     * Resolve the Config path into object references, beginning at the
+     * indicated root object.
      *
-     * \param [in] root The object corresponding to the current position in
-     *                  in the Config path.
+     * \param [in] root The object the path starts from, or null to start
+     *                  from the root of the "/Names" namespace.
+     * \param [in,out] objects The objects matching the path.
+     * \param [in,out] paths The matching Config path of each object, if not null.
      */
-    void Resolve(Ptr<Object> root);
+    void Resolve(Ptr<Object> root,
+                 std::vector<Ptr<Object>>* objects,
+                 std::vector<std::string>* paths) const;
 
   private:
-    /** Ensure the Config path starts and ends with a '/'. */
-    void Canonicalize();
-    /**
-     * Parse the next element in the Config path.
-     *
-     * \param [in] path The remaining portion of the Config path.
-     * \param [in] root The object corresponding to the current position
-     *                  in the Config path.
-     */
-    void DoResolve(std::string path, Ptr<Object> root);
+    /** An attribute of an object matched by an element of the path. */
+    struct Attribute
+    {
+        std::string name; //!< The name of the attribute.
+        bool pointer;     //!< Whether the attribute is a pointer to an Object.
+        bool container;   //!< Whether the attribute is a container of Objects.
+    };
+
+    /** An element of the path. */
+    struct Element
+    {
+        /**
+         * Parse an element.
+         *
+         * \param [in] item The element.
+         */
+        Element(std::string item);
+
+        std::string item;     //!< The element.
+        bool names;           //!< Whether the element starts the "/Names" namespace.
+        bool object;          //!< Whether the element gets an aggregated object.
+        bool tidFound;        //!< Whether the TypeId of the aggregated object exists.
+        TypeId tid;           //!< The TypeId of the aggregated object.
+        ArrayMatcher matcher; //!< The indices matched, following a container.
+        /** The attributes matched by the element, per TypeId uid. */
+        mutable std::unordered_map<uint16_t, std::vector<Attribute>> attributes;
+    };
+
+    /** The state of a resolution. */
+    struct Resolution
+    {
+        std::vector<std::string> workStack; //!< The elements resolved so far.
+        std::vector<Ptr<Object>>* objects;  //!< The objects matching the path.
+        std::vector<std::string>* paths;    //!< The matching paths, if needed.
+    };
+
     /**
-     * Parse an index on the Config path.
+     * Get the attributes matched by an element.
      *
-     * \param [in] path The remaining Config path.
-     * \param [in,out] vector The resulting list of matching objects.
+     * \param [in] element The element.
+     * \param [in] tid The TypeId of the object.
+     * \returns The attributes of the object, or of its parents, matched by
+     *          the element.
      */
-    void DoArrayResolve(std::string path, const ObjectPtrContainerValue& vector);
+    const std::vector<Attribute>& GetAttributes(const Element& element, TypeId tid) const;
+
     /**
-     * Handle one object found on the path.
+     * Resolve the next element of the path.
      *
-     * \param [in] object The current object on the Config path.
+     * \param [in] i The index of the element.
+     * \param [in] root The object corresponding to the current position in
+     *                  the Config path.
+     * \param [in,out] resolution The state of the resolution.
      */
-    void DoResolveOne(Ptr<Object> object);
+    void DoResolve(std::size_t i, Ptr<Object> root, Resolution& resolution) const;
+
     /**
      * Get the current Config path.
      *
+     * \param [in] resolution The state of the resolution.
      * \returns The current Config path.
      */
-    std::string GetResolvedPath() const;
-    /**
-     * Handle one found object.
-     *
-     * \param [in] object The found object.
-     * \param [in] path The matching Config path context.
-     */
-    virtual void DoOne(Ptr<Object> object, std::string path) = 0;
+    std::string GetResolvedPath(const Resolution& resolution) const;
 
-    /** Current list of path tokens. */
-    std::vector<std::string> m_workStack;
     /** The Config path. */
     std::string m_path;
+    /** The elements of the path. */
+    std::vector<Element> m_elements;
 
-}; // class Resolver
+}; // class PathMatcher
 
-Resolver::Resolver(std::string path)
-    : m_path(path)
+PathMatcher::Element::Element(std::string item)
+    : item(item),
+      names(item.compare(0, 5, "Names") == 0),
+      object(item.find('$') == 0),
+      tidFound(false),
+      matcher(item)
 {
-    NS_LOG_FUNCTION(this << path);
-    Canonicalize();
-}
-
-Resolver::~Resolver()
-{
-    NS_LOG_FUNCTION(this);
+    if (object)
+    {
+        tidFound = TypeId::LookupByNameFailSafe(item.substr(1, item.size() - 1), &tid);
+    }
 }
 
-void
-Resolver::Canonicalize()
+PathMatcher::PathMatcher(std::string path)
+    : m_path(path)
 {
-    NS_LOG_FUNCTION(this);
+    NS_LOG_FUNCTION(this << path);
 
     // ensure that we start and end with a '/'
-    std::string::size_type tmp = m_path.find('/');
+    std::string::size_type tmp = path.find('/');
     if (tmp != 0)
     {
         // no slash at start
-        m_path = "/" + m_path;
+        path = "/" + path;
     }
-    tmp = m_path.find_last_of('/');
-    if (tmp != (m_path.size() - 1))
+    tmp = path.find_last_of('/');
+    if (tmp != (path.size() - 1))
     {
         // no slash at end
-        m_path = m_path + "/";
+        path = path + "/";
+    }
+
+    for (std::string::size_type start = 0, next = path.find('/', 1); next != std::string::npos;
+         start = next, next = path.find('/', next + 1))
+    {
+        m_elements.emplace_back(path.substr(start + 1, next - (start + 1)));
     }
 }
 
-void
-Resolver::Resolve(Ptr<Object> root)
+std::string
+PathMatcher::GetPath() const
 {
-    NS_LOG_FUNCTION(this << root);
+    NS_LOG_FUNCTION(this);
+    return m_path;
+}
 
-    DoResolve(m_path, root);
+void
+PathMatcher::Resolve(Ptr<Object> root,
+                     std::vector<Ptr<Object>>* objects,
+                     std::vector<std::string>* paths) const
+{
+    NS_LOG_FUNCTION(this << root << objects << paths);
+    Resolution resolution;
+    resolution.objects = objects;
+    resolution.paths = paths;
+    DoResolve(0, root, resolution);
 }
 
 std::string
-Resolver::GetResolvedPath() const
+PathMatcher::GetResolvedPath(const Resolution& resolution) const
 {
     NS_LOG_FUNCTION(this);
-
     std::string fullPath = "/";
-    for (auto i = m_workStack.begin(); i != m_workStack.end(); i++)
+    for (const auto& item : resolution.workStack)
     {
-        fullPath += *i + "/";
+        fullPath += item + "/";
     }
     return fullPath;
 }
 
-void
-Resolver::DoResolveOne(Ptr<Object> object)
+const std::vector<PathMatcher::Attribute>&
+PathMatcher::GetAttributes(const Element& element, TypeId tid) const
 {
-    NS_LOG_FUNCTION(this << object);
-
-    NS_LOG_DEBUG("resolved=" << GetResolvedPath());
-    DoOne(object, GetResolvedPath());
+    NS_LOG_FUNCTION(this << element.item << tid);
+    auto found = element.attributes.find(tid.GetUid());
+    if (found != element.attributes.end())
+    {
+        return found->second;
+    }
+    std::vector<Attribute>& attributes = element.attributes[tid.GetUid()];
+    TypeId nextTid = tid;
+    do
+    {
+        tid = nextTid;
+        for (uint32_t i = 0; i < tid.GetAttributeN(); i++)
+        {
+            TypeId::AttributeInformation info = tid.GetAttribute(i);
+            if (info.name != element.item && element.item != "*")
+            {
+                continue;
+            }
+            Attribute attribute;
+            attribute.name = info.name;
+            attribute.pointer =
+                dynamic_cast<const PointerChecker*>(PeekPointer(info.checker)) != nullptr;
+            attribute.container =
+                dynamic_cast<const ObjectPtrContainerChecker*>(PeekPointer(info.checker)) !=
+                nullptr;
+            // anything else could be anything, and we don't know what to do with it
+            if (attribute.pointer || attribute.container)
+            {
+                attributes.push_back(attribute);
+            }
+        }
+        nextTid = tid.GetParent();
+    } while (nextTid != tid);
+    return attributes;
 }
 
 void
-Resolver::DoResolve(std::string path, Ptr<Object> root)
+PathMatcher::DoResolve(std::size_t i, Ptr<Object> root, Resolution& resolution) const
 {
-    NS_LOG_FUNCTION(this << path << root);
-    NS_ASSERT((path.find('/')) == 0);
-    std::string::size_type next = path.find('/', 1);
-
-    if (next == std::string::npos)
+    NS_LOG_FUNCTION(this << i << root);
+    if (i == m_elements.size())
     {
         //
         // If root is zero, we're beginning to see if we can use the object name
@@ -458,12 +540,16 @@ Resolver::DoResolve(std::string path, Ptr<Object> root)
         //
         if (root)
         {
-            DoResolveOne(root);
+            resolution.objects->push_back(root);
+            if (resolution.paths)
+            {
+                NS_LOG_DEBUG("resolved=" << GetResolvedPath(resolution));
+                resolution.paths->push_back(GetResolvedPath(resolution));
+            }
         }
         return;
     }
-    std::string item = path.substr(1, next - 1);
-    std::string pathLeft = path.substr(next, path.size() - next);
+    const Element& element = m_elements[i];
 
     //
     // If root is zero, we're beginning to see if we can use the object name
@@ -472,16 +558,12 @@ Resolver::DoResolve(std::string path, Ptr<Object> root)
     // the root of the "/Names" namespace, so we just ignore it and move on to
     // the next segment.
     //
-    if (!root)
+    if (!root && element.names)
     {
-        std::string::size_type offset = path.find("/Names");
-        if (offset == 0)
-        {
-            m_workStack.push_back(item);
-            DoResolve(pathLeft, root);
-            m_workStack.pop_back();
-            return;
-        }
+        resolution.workStack.push_back(element.item);
+        DoResolve(i + 1, root, resolution);
+        resolution.workStack.pop_back();
+        return;
     }
 
     //
@@ -490,13 +572,13 @@ Resolver::DoResolve(std::string path, Ptr<Object> root)
     // zero, this means to look in the root of the "/Names" name space, otherwise
     // it refers to a name space context (level).
     //
-    Ptr<Object> namedObject = Names::Find<Object>(root, item);
+    Ptr<Object> namedObject = Names::Find<Object>(root, element.item);
     if (namedObject)
     {
-        NS_LOG_DEBUG("Name system resolved item = " << item << " to " << namedObject);
-        m_workStack.push_back(item);
-        DoResolve(pathLeft, namedObject);
-        m_workStack.pop_back();
+        NS_LOG_DEBUG("Name system resolved item = " << element.item << " to " << namedObject);
+        resolution.workStack.push_back(element.item);
+        DoResolve(i + 1, namedObject, resolution);
+        resolution.workStack.pop_back();
         return;
     }
 
@@ -511,120 +593,81 @@ Resolver::DoResolve(std::string path, Ptr<Object> root)
     {
         return;
     }
-    std::string::size_type dollarPos = item.find('$');
-    if (dollarPos == 0)
+
+    if (element.object)
     {
         // This is a call to GetObject
-        std::string tidString = item.substr(1, item.size() - 1);
-        NS_LOG_DEBUG("GetObject=" << tidString << " on path=" << GetResolvedPath());
-        TypeId tid = TypeId::LookupByName(tidString);
-        Ptr<Object> object = root->GetObject<Object>(tid);
-        if (!object)
+        NS_LOG_DEBUG("GetObject=" << element.item << " on path=" << GetResolvedPath(resolution));
+        if (!element.tidFound)
         {
-            NS_LOG_DEBUG("GetObject (" << tidString << ") failed on path=" << GetResolvedPath());
-            return;
+            // raise the error of an unknown TypeId
+            TypeId::LookupByName(element.item.substr(1, element.item.size() - 1));
         }
-        m_workStack.push_back(item);
-        DoResolve(pathLeft, object);
-        m_workStack.pop_back();
-    }
-    else
-    {
-        // this is a normal attribute.
-        TypeId tid;
-        TypeId nextTid = root->GetInstanceTypeId();
-        bool foundMatch = false;
-
-        do
-        {
-            tid = nextTid;
-
-            for (uint32_t i = 0; i < tid.GetAttributeN(); i++)
-            {
-                TypeId::AttributeInformation info;
-                info = tid.GetAttribute(i);
-                if (info.name != item && item != "*")
-                {
-                    continue;
-                }
-                // attempt to cast to a pointer checker.
-                const auto pChecker =
-                    dynamic_cast<const PointerChecker*>(PeekPointer(info.checker));
-                if (pChecker != nullptr)
-                {
-                    NS_LOG_DEBUG("GetAttribute(ptr)=" << info.name
-                                                      << " on path=" << GetResolvedPath());
-                    PointerValue pValue;
-                    root->GetAttribute(info.name, pValue);
-                    Ptr<Object> object = pValue.Get<Object>();
-                    if (!object)
-                    {
-                        NS_LOG_ERROR("Requested object name=\"" << item << "\" exists on path=\""
-                                                                << GetResolvedPath()
-                                                                << "\""
-                                                                   " but is null.");
-                        continue;
-                    }
-                    foundMatch = true;
-                    m_workStack.push_back(info.name);
-                    DoResolve(pathLeft, object);
-                    m_workStack.pop_back();
-                }
-                // attempt to cast to an object vector.
-                const auto vectorChecker =
-                    dynamic_cast<const ObjectPtrContainerChecker*>(PeekPointer(info.checker));
-                if (vectorChecker != nullptr)
-                {
-                    NS_LOG_DEBUG("GetAttribute(vector)=" << info.name << " on path="
-                                                         << GetResolvedPath() << pathLeft);
-                    foundMatch = true;
-                    ObjectPtrContainerValue vector;
-                    root->GetAttribute(info.name, vector);
-                    m_workStack.push_back(info.name);
-                    DoArrayResolve(pathLeft, vector);
-                    m_workStack.pop_back();
-                }
-                // this could be anything else and we don't know what to do with it.
-                // So, we just ignore it.
-            }
-
-            nextTid = tid.GetParent();
-        } while (nextTid != tid);
-
-        if (!foundMatch)
+        Ptr<Object> object = root->GetObject<Object>(element.tid);
+        if (!object)
         {
-            NS_LOG_DEBUG("Requested item=" << item
-                                           << " does not exist on path=" << GetResolvedPath());
+            NS_LOG_DEBUG("GetObject (" << element.item
+                                       << ") failed on path=" << GetResolvedPath(resolution));
             return;
         }
+        resolution.workStack.push_back(element.item);
+        DoResolve(i + 1, object, resolution);
+        resolution.workStack.pop_back();
+        return;
     }
-}
 
-void
-Resolver::DoArrayResolve(std::string path, const ObjectPtrContainerValue& container)
-{
-    NS_LOG_FUNCTION(this << path << &container);
-    NS_ASSERT(!path.empty());
-    NS_ASSERT((path.find('/')) == 0);
-    std::string::size_type next = path.find('/', 1);
-    if (next == std::string::npos)
+    // this is a normal attribute.
+    const std::vector<Attribute>& attributes = GetAttributes(element, root->GetInstanceTypeId());
+    if (attributes.empty())
     {
+        NS_LOG_DEBUG("Requested item=" << element.item << " does not exist on path="
+                                       << GetResolvedPath(resolution));
         return;
     }
-    std::string item = path.substr(1, next - 1);
-    std::string pathLeft = path.substr(next, path.size() - next);
-
-    ArrayMatcher matcher = ArrayMatcher(item);
-    ObjectPtrContainerValue::Iterator it;
-    for (it = container.Begin(); it != container.End(); ++it)
+    for (const auto& attribute : attributes)
     {
-        if (matcher.Matches((*it).first))
+        if (attribute.pointer)
         {
-            std::ostringstream oss;
-            oss << (*it).first;
-            m_workStack.push_back(oss.str());
-            DoResolve(pathLeft, (*it).second);
-            m_workStack.pop_back();
+            NS_LOG_DEBUG("GetAttribute(ptr)=" << attribute.name
+                                              << " on path=" << GetResolvedPath(resolution));
+            PointerValue pValue;
+            root->GetAttribute(attribute.name, pValue);
+            Ptr<Object> object = pValue.Get<Object>();
+            if (!object)
+            {
+                NS_LOG_ERROR("Requested object name=\"" << element.item << "\" exists on path=\""
+                                                        << GetResolvedPath(resolution)
+                                                        << "\""
+                                                           " but is null.");
+                continue;
+            }
+            resolution.workStack.push_back(attribute.name);
+            DoResolve(i + 1, object, resolution);
+            resolution.workStack.pop_back();
+        }
+        if (attribute.container)
+        {
+            NS_LOG_DEBUG("GetAttribute(vector)=" << attribute.name
+                                                 << " on path=" << GetResolvedPath(resolution));
+            // the next element is the index in the container
+            if (i + 1 == m_elements.size())
+            {
+                continue;
+            }
+            const ArrayMatcher& matcher = m_elements[i + 1].matcher;
+            ObjectPtrContainerValue container;
+            root->GetAttribute(attribute.name, container);
+            resolution.workStack.push_back(attribute.name);
+            for (auto it = container.Begin(); it != container.End(); ++it)
+            {
+                if (matcher.Matches(it->first))
+                {
+                    resolution.workStack.push_back(std::to_string(it->first));
+                    DoResolve(i + 2, it->second, resolution);
+                    resolution.workStack.pop_back();
+                }
+            }
+            resolution.workStack.pop_back();
         }
     }
 }
@@ -652,6 +695,14 @@ class ConfigImpl : public Singleton<ConfigImpl>
     void Disconnect(std::string path, const CallbackBase& cb);
     /** \copydoc ns3::Config::LookupMatches() */
     MatchContainer LookupMatches(std::string path);
+    /**
+     * Find the objects which match a parsed Config path.
+     *
+     * \param [in] matcher The parsed Config path.
+     * \param [in] contexts Whether the matched paths are needed.
+     * \returns A container of the objects which match the path.
+     */
+    MatchContainer LookupMatches(const PathMatcher& matcher, bool contexts);
 
     /** \copydoc ns3::Config::RegisterRootNamespaceObject() */
     void RegisterRootNamespaceObject(Ptr<Object> obj);
@@ -701,7 +752,7 @@ ConfigImpl::Set(std::string path, const AttributeValue& value)
     std::string root;
     std::string leaf;
     ParsePath(path, &root, &leaf);
-    MatchContainer container = LookupMatches(root);
+    MatchContainer container = LookupMatches(PathMatcher(root), false);
     container.Set(leaf, value);
 }
 
@@ -713,7 +764,7 @@ ConfigImpl::SetFailSafe(std::string path, const AttributeValue& value)
     std::string root;
     std::string leaf;
     ParsePath(path, &root, &leaf);
-    MatchContainer container = LookupMatches(root);
+    MatchContainer container = LookupMatches(PathMatcher(root), false);
     return container.SetFailSafe(leaf, value);
 }
 
@@ -724,7 +775,7 @@ ConfigImpl::ConnectWithoutContextFailSafe(std::string path, const CallbackBase&
     std::string root;
     std::string leaf;
     ParsePath(path, &root, &leaf);
-    MatchContainer container = LookupMatches(root);
+    MatchContainer container = LookupMatches(PathMatcher(root), false);
     return container.ConnectWithoutContextFailSafe(leaf, cb);
 }
 
@@ -735,7 +786,7 @@ ConfigImpl::DisconnectWithoutContext(std::string path, const CallbackBase& cb)
     std::string root;
     std::string leaf;
     ParsePath(path, &root, &leaf);
-    MatchContainer container = LookupMatches(root);
+    MatchContainer container = LookupMatches(PathMatcher(root), false);
     if (container.GetN() == 0)
     {
         std::size_t lastFwdSlash = root.rfind('/');
@@ -782,27 +833,19 @@ ConfigImpl::LookupMatches(std::string path)
 {
     NS_LOG_FUNCTION(this << path);
 
-    class LookupMatchesResolver : public Resolver
-    {
-      public:
-        LookupMatchesResolver(std::string path)
-            : Resolver(path)
-        {
-        }
-
-        void DoOne(Ptr<Object> object, std::string path) override
-        {
-            m_objects.push_back(object);
-            m_contexts.push_back(path);
-        }
+    return LookupMatches(PathMatcher(path), true);
+}
 
-        std::vector<Ptr<Object>> m_objects;
-        std::vector<std::string> m_contexts;
-    } resolver = LookupMatchesResolver(path);
+MatchContainer
+ConfigImpl::LookupMatches(const PathMatcher& matcher, bool contexts)
+{
+    NS_LOG_FUNCTION(this << matcher.GetPath() << contexts);
 
+    std::vector<Ptr<Object>> objects;
+    std::vector<std::string> paths;
     for (auto i = m_roots.begin(); i != m_roots.end(); i++)
     {
-        resolver.Resolve(*i);
+        matcher.Resolve(*i, &objects, contexts ? &paths : nullptr);
     }
 
     //
@@ -810,9 +853,9 @@ ConfigImpl::LookupMatches(std::string path)
     // the root pointer zeroed indicates to the resolver that it should start
     // looking at the root of the "/Names" namespace during this go.
     //
-    resolver.Resolve(nullptr);
+    matcher.Resolve(nullptr, &objects, contexts ? &paths : nullptr);
 
-    return MatchContainer(resolver.m_objects, resolver.m_contexts, path);
+    return MatchContainer(objects, paths, matcher.GetPath());
 }
 
 void
@@ -1029,6 +1072,132 @@ GetRootNamespaceObject(uint32_t i)
     return ConfigImpl::Get()->GetRootNamespaceObject(i);
 }
 
+CompiledPath::CompiledPath(std::string path, bool cache)
+    : m_path(path),
+      m_cache(cache),
+      m_cached(false)
+{
+    NS_LOG_FUNCTION(this << path << cache);
+    std::string::size_type slash = path.find_last_of('/');
+    NS_ASSERT_MSG(slash != std::string::npos, "Config path " << path << " has no element");
+    m_leaf = path.substr(slash + 1, path.size() - (slash + 1));
+    m_matcher = std::make_shared<const PathMatcher>(path.substr(0, slash));
+}
+
+std::string
+CompiledPath::GetPath() const
+{
+    NS_LOG_FUNCTION(this);
+    return m_path;
+}
+
+void
+CompiledPath::ClearCache()
+{
+    NS_LOG_FUNCTION(this);
+    m_cached = false;
+    m_matches = MatchContainer();
+}
+
+MatchContainer&
+CompiledPath::GetMatches(bool contexts, MatchContainer& lookup)
+{
+    NS_LOG_FUNCTION(this << contexts);
+    if (!m_cache)
+    {
+        lookup = ConfigImpl::Get()->LookupMatches(*m_matcher, contexts);
+        return lookup;
+    }
+    if (!m_cached)
+    {
+        m_matches = ConfigImpl::Get()->LookupMatches(*m_matcher, true);
+        m_cached = true;
+    }
+    return m_matches;
+}
+
+void
+CompiledPath::Set(const AttributeValue& value)
+{
+    NS_LOG_FUNCTION(this << &value);
+    MatchContainer lookup;
+    GetMatches(false, lookup).Set(m_leaf, value);
+}
+
+bool
+CompiledPath::SetFailSafe(const AttributeValue& value)
+{
+    NS_LOG_FUNCTION(this << &value);
+    MatchContainer lookup;
+    return GetMatches(false, lookup).SetFailSafe(m_leaf, value);
+}
+
+void
+CompiledPath::Connect(const CallbackBase& cb)
+{
+    NS_LOG_FUNCTION(this << &cb);
+    if (!ConnectFailSafe(cb))
+    {
+        NS_FATAL_ERROR("Could not connect callback to " << m_path);
+    }
+}
+
+bool
+CompiledPath::ConnectFailSafe(const CallbackBase& cb)
+{
+    NS_LOG_FUNCTION(this << &cb);
+    MatchContainer lookup;
+    return GetMatches(true, lookup).ConnectFailSafe(m_leaf, cb);
+}
+
+void
+CompiledPath::ConnectWithoutContext(const CallbackBase& cb)
+{
+    NS_LOG_FUNCTION(this << &cb);
+    if (!ConnectWithoutContextFailSafe(cb))
+    {
+        NS_FATAL_ERROR("Could not connect callback to " << m_path);
+    }
+}
+
+bool
+CompiledPath::ConnectWithoutContextFailSafe(const CallbackBase& cb)
+{
+    NS_LOG_FUNCTION(this << &cb);
+    MatchContainer lookup;
+    return GetMatches(false, lookup).ConnectWithoutContextFailSafe(m_leaf, cb);
+}
+
+void
+CompiledPath::Disconnect(const CallbackBase& cb)
+{
+    NS_LOG_FUNCTION(this << &cb);
+    MatchContainer lookup;
+    GetMatches(true, lookup).Disconnect(m_leaf, cb);
+}
+
+void
+CompiledPath::DisconnectWithoutContext(const CallbackBase& cb)
+{
+    NS_LOG_FUNCTION(this << &cb);
+    MatchContainer lookup;
+    GetMatches(false, lookup).DisconnectWithoutContext(m_leaf, cb);
+}
+
+bool
+CompiledPath::DoConnectWithoutContext(Ptr<Object> object, const CallbackBase& cb) const
+{
+    NS_LOG_FUNCTION(this << object << &cb);
+    std::vector<Ptr<Object>> objects;
+    m_matcher->Resolve(object, &objects, nullptr);
+    bool ok = false;
+    for (const auto& match : objects)
+    {
+        ok |= match->TraceConnectWithoutContext(m_leaf, cb);
+    }
+    return ok;
+}
+
 } // namespace Config
 
 } // namespace ns3
@@ -19,8 +19,10 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
+#include "fatal-error.h"
 #include "ptr.h"
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -390,6 +392,178 @@ std::size_t GetRootNamespaceObjectN();
  */
 Ptr<Object> GetRootNamespaceObject(uint32_t i);
 
+class PathMatcher;
+
+/**
+ * \ingroup config
+ * \brief A Config path parsed once, to be resolved many times.
+ *
+ * Config::Set and Config::Connect parse their path on each call. A
+ * CompiledPath parses it at construction: the TypeIds of the "$" elements
+ * are looked up and the index expressions are parsed once, and the
+ * attributes matched by each element are remembered per TypeId. The path
+ * is then resolved in a single pass over the object graph.
+ *
+ * The objects matched by the path, up to its last element, can also be
+ * cached, for the scripts which set or connect the same path repeatedly.
+ * The cache is not updated when objects are created or destroyed: call
+ * ClearCache() then. The cache keeps the matched objects alive.
+ *
+ * The path can also be resolved relative to each object of a container,
+ * such as the nodes of a NodeContainer, which avoids looking up each node
+ * in the NodeList:
+ * \code
+ *   Config::CompiledPath path("$ns3::MobilityModel/CourseChange");
+ *   path.ConnectWithoutContext(nodes, MakeCallback(&CourseChange));
+ * \endcode
+ */
+class CompiledPath
+{
+  public:
+    /**
+     * \param [in] path The Config path.
+     * \param [in] cache Whether to cache the objects matched by the path.
+     */
+    explicit CompiledPath(std::string path, bool cache = false);
+
+    /** \returns The Config path. */
+    std::string GetPath() const;
+
+    /** Forget the cached objects, so that the next call resolves the path again. */
+    void ClearCache();
+
+    /**
+     * \param [in] value The value to set in all matching attributes.
+     * \see Config::Set
+     */
+    void Set(const AttributeValue& value);
+    /**
+     * \param [in] value The value to set in all matching attributes.
+     * \returns \c true if any matching attributes could be set.
+     * \see Config::SetFailSafe
+     */
+    bool SetFailSafe(const AttributeValue& value);
+    /**
+     * \param [in] cb The callback to connect to the matching trace sources.
+     * \see Config::Connect
+     */
+    void Connect(const CallbackBase& cb);
+    /**
+     * \param [in] cb The callback to connect to the matching trace sources.
+     * \returns \c true if any trace sources could be connected.
+     * \see Config::ConnectFailSafe
+     */
+    bool ConnectFailSafe(const CallbackBase& cb);
+    /**
+     * \param [in] cb The callback to connect to the matching trace sources.
+     * \see Config::ConnectWithoutContext
+     */
+    void ConnectWithoutContext(const CallbackBase& cb);
+    /**
+     * \param [in] cb The callback to connect to the matching trace sources.
+     * \returns \c true if any trace sources could be connected.
+     * \see Config::ConnectWithoutContextFailSafe
+     */
+    bool ConnectWithoutContextFailSafe(const CallbackBase& cb);
+    /**
+     * \param [in] cb The callback to disconnect from the matching trace sources.
+     * \see Config::Disconnect
+     */
+    void Disconnect(const CallbackBase& cb);
+    /**
+     * \param [in] cb The callback to disconnect from the matching trace sources.
+     * \see Config::DisconnectWithoutContext
+     */
+    void DisconnectWithoutContext(const CallbackBase& cb);
+
+    /**
+     * Connect the callback to the trace sources which match the path
+     * relative to each of the objects, and throw a fatal error if none does.
+     *
+     * \tparam C \deduced The container type, iterated with Begin() and End().
+     * \param [in] objects The objects the path starts from.
+     * \param [in] cb The callback to connect to the matching trace sources.
+     */
+    template <typename C>
+    void ConnectWithoutContext(const C& objects, const CallbackBase& cb);
+    /**
+     * Connect the callback to the trace sources which match the path
+     * relative to each of the objects.
+     *
+     * \tparam C \deduced The container type, iterated with Begin() and End().
+     * \param [in] objects The objects the path starts from.
+     * \param [in] cb The callback to connect to the matching trace sources.
+     * \returns \c true if any trace sources could be connected.
+     */
+    template <typename C>
+    bool ConnectWithoutContextFailSafe(const C& objects, const CallbackBase& cb);
+
+  private:
+    /**
+     * Resolve the path, up to its last element, from the root namespace objects.
+     *
+     * The cached matches are returned in place, without a copy.
+     *
+     * \param [in] contexts Whether the matched paths are needed.
+     * \param [out] lookup The matching objects, when they are not cached.
+     * \returns The matching objects, either the cache or \pname{lookup}.
+     */
+    MatchContainer& GetMatches(bool contexts, MatchContainer& lookup);
+    /**
+     * Connect the callback to the trace sources which match the path
+     * relative to an object.
+     *
+     * \param [in] object The object the path starts from.
+     * \param [in] cb The callback to connect to the matching trace sources.
+     * \returns \c true if any trace sources could be connected.
+     */
+    bool DoConnectWithoutContext(Ptr<Object> object, const CallbackBase& cb) const;
+
+    /** The Config path. */
+    std::string m_path;
+    /** The last element of the path, the attribute or trace source name. */
+    std::string m_leaf;
+    /** The parsed path, up to its last element. */
+    std::shared_ptr<const PathMatcher> m_matcher;
+    /** Whether to cache the matching objects. */
+    bool m_cache;
+    /** Whether m_matches holds the matching objects. */
+    bool m_cached;
+    /** The cached matching objects. */
+    MatchContainer m_matches;
+};
+
+} // namespace Config
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace Config
+{
+
+template <typename C>
+void
+CompiledPath::ConnectWithoutContext(const C& objects, const CallbackBase& cb)
+{
+    if (!ConnectWithoutContextFailSafe(objects, cb))
+    {
+        NS_FATAL_ERROR("Could not connect callback to " << m_path);
+    }
+}
+
+template <typename C>
+bool
+CompiledPath::ConnectWithoutContextFailSafe(const C& objects, const CallbackBase& cb)
+{
+    bool ok = false;
+    for (auto i = objects.Begin(); i != objects.End(); ++i)
+    {
+        ok |= DoConnectWithoutContext(*i, cb);
+    }
+    return ok;
+}
+
 } // namespace Config
 
 } // namespace ns3
@@ -20,6 +20,7 @@
 #include "default-simulator-impl.h"
 
 #include "assert.h"
+#include "event-profiler.h"
 #include "log.h"
 #include "scheduler.h"
 #include "simulator.h"
@@ -141,7 +142,11 @@ DefaultSimulatorImpl::ProcessOneEvent()
     m_currentTs = next.key.m_ts;
     m_currentContext = next.key.m_context;
     m_currentUid = next.key.m_uid;
+#ifdef NS3_EVENT_PROFILER_ENABLE
+    EventProfiler::Get()->Invoke(next.impl, next.key.m_context);
+#else
     next.impl->Invoke();
+#endif
     next.impl->Unref();
 
     ProcessEventsWithContext();
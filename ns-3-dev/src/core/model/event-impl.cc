@@ -21,6 +21,8 @@
 
 #include "log.h"
 
+#include <new>
+
 /**
  * \file
  * \ingroup events
@@ -32,6 +34,109 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("EventImpl");
 
+#ifdef NS3_EVENT_POOL_ENABLE
+namespace
+{
+
+/** Size granularity of the event pool size classes. */
+constexpr std::size_t POOL_GRANULE = 16;
+/** Number of size classes of the event pool. */
+constexpr std::size_t POOL_CLASSES = 16;
+
+/**
+ * \ingroup events
+ * Per-thread free lists of events, one per size class. Blocks in the free
+ * lists hold the pointer to the next free block.
+ */
+struct EventPool
+{
+    void* heads[POOL_CLASSES] = {}; //!< The free lists.
+    bool alive = true;              //!< False once the thread is exiting.
+
+    ~EventPool()
+    {
+        alive = false;
+        for (auto& head : heads)
+        {
+            while (head)
+            {
+                void* next = *static_cast<void**>(head);
+                ::operator delete(head);
+                head = next;
+            }
+        }
+    }
+};
+
+/** The free lists of this thread. */
+thread_local EventPool g_eventPool;
+
+/** Whether the event pool is in use. */
+bool g_eventPoolEnabled = true;
+
+} // unnamed namespace
+
+void*
+EventImpl::operator new(std::size_t size)
+{
+    std::size_t sizeClass = (size + POOL_GRANULE - 1) / POOL_GRANULE;
+    if (sizeClass > POOL_CLASSES)
+    {
+        return ::operator new(size);
+    }
+    if (g_eventPoolEnabled)
+    {
+        void*& head = g_eventPool.heads[sizeClass - 1];
+        if (head)
+        {
+            void* p = head;
+            head = *static_cast<void**>(p);
+            return p;
+        }
+    }
+    // Allocate the whole size class, so that the block can go to the free
+    // lists whether or not the pool is enabled when it is freed.
+    return ::operator new(sizeClass * POOL_GRANULE);
+}
+
+void
+EventImpl::operator delete(void* p, std::size_t size)
+{
+    std::size_t sizeClass = (size + POOL_GRANULE - 1) / POOL_GRANULE;
+    if (sizeClass <= POOL_CLASSES && g_eventPoolEnabled && g_eventPool.alive)
+    {
+        void*& head = g_eventPool.heads[sizeClass - 1];
+        *static_cast<void**>(p) = head;
+        head = p;
+        return;
+    }
+    ::operator delete(p);
+}
+
+void
+EventImpl::SetPoolEnabled(bool enabled)
+{
+    g_eventPoolEnabled = enabled;
+}
+
+bool
+EventImpl::IsPoolEnabled()
+{
+    return g_eventPoolEnabled;
+}
+#else
+void
+EventImpl::SetPoolEnabled(bool enabled)
+{
+}
+
+bool
+EventImpl::IsPoolEnabled()
+{
+    return false;
+}
+#endif
+
 EventImpl::~EventImpl()
 {
     NS_LOG_FUNCTION(this);
@@ -53,6 +158,12 @@ EventImpl::Invoke()
     }
 }
 
+EventImpl::ProfileKey
+EventImpl::GetProfileKey() const
+{
+    return {nullptr, &typeid(*this)};
+}
+
 void
 EventImpl::Cancel()
 {
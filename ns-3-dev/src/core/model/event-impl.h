@@ -21,7 +21,9 @@
 
 #include "simple-ref-count.h"
 
+#include <cstddef>
 #include <stdint.h>
+#include <typeinfo>
 
 /**
  * \file
@@ -67,6 +69,69 @@ class EventImpl : public SimpleRefCount<EventImpl>
      */
     bool IsCancelled();
 
+#ifdef NS3_EVENT_POOL_ENABLE
+    /**
+     * Allocate an event from the free list of its size class.
+     *
+     * Events are small, short lived and allocated at a high rate, so
+     * freed events are kept in per-thread free lists, one per 16-byte
+     * size class up to 256 bytes, instead of going back to the heap.
+     * Larger events use the global operator new. The free lists never
+     * shrink: their memory only goes back to the heap when the thread
+     * exits.
+     *
+     * \param [in] size The size of the event.
+     * \returns The memory for the event.
+     */
+    static void* operator new(std::size_t size);
+    /**
+     * Return an event to the free list of its size class.
+     *
+     * \param [in] p The memory of the event.
+     * \param [in] size The size of the event.
+     */
+    static void operator delete(void* p, std::size_t size);
+#endif
+
+    /**
+     * Enable or disable the event pool at run time. When disabled, events
+     * are allocated from and freed to the heap, as without the pool, for
+     * example to check them with a memory checker.
+     *
+     * Without the NS3_EVENT_POOL build option, this has no effect.
+     *
+     * \param [in] enabled Whether to use the event pool.
+     */
+    static void SetPoolEnabled(bool enabled);
+    /**
+     * \returns true if events are allocated from the event pool.
+     */
+    static bool IsPoolEnabled();
+
+    /** Identification of the function called by an event, for the EventProfiler. */
+    struct ProfileKey
+    {
+        /** The code address of the function, or nullptr if it is not known. */
+        const void* function;
+        /** The type of the function, or of the event. */
+        const std::type_info* type;
+    };
+
+    /**
+     * Identify the function this event calls.
+     *
+     * The events made by MakeEvent() give the address of the bound function
+     * or class method, which the EventProfiler resolves to a symbol name.
+     * Other events return their own type.
+     *
+     * This is declared in every build, so that the layout of the vtable does
+     * not depend on the NS3_EVENT_PROFILER build option, but the overrides of
+     * MakeEvent() are only compiled with it.
+     *
+     * \returns The function called by this event.
+     */
+    virtual ProfileKey GetProfileKey() const;
+
   protected:
     /**
      * Implementation for Invoke().
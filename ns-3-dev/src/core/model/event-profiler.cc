@@ -0,0 +1,363 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * @file
+ * @ingroup simulator
+ * ns3::EventProfiler implementation.
+ */
+
+#include "event-profiler.h"
+
+#include "log.h"
+#include "system-path.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+#if defined(__GNUC__) && !defined(_WIN32)
+#include <cxxabi.h>
+#include <dlfcn.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("EventProfiler");
+
+namespace
+{
+
+/**
+ * \returns The steady clock, in ns.
+ */
+uint64_t
+SteadyNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/**
+ * Demangle a symbol or type name.
+ *
+ * \param [in] name The mangled name.
+ * \returns The demangled name, or name if it cannot be demangled.
+ */
+std::string
+Demangle(const char* name)
+{
+#if defined(__GNUC__) && !defined(_WIN32)
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    if (status == 0 && demangled)
+    {
+        std::string result(demangled);
+        std::free(demangled);
+        return result;
+    }
+#endif
+    return name;
+}
+
+} // unnamed namespace
+
+EventProfiler::EventProfiler()
+    : m_outputName("eventProfile"),
+      m_startTicks(Now()),
+      m_startNs(SteadyNs())
+{
+}
+
+EventProfiler::~EventProfiler()
+{
+    for (auto table : m_tables)
+    {
+        delete table;
+    }
+}
+
+void
+EventProfiler::Initialize(std::vector<std::string> args, std::string outDir /* = "" */)
+{
+    std::string modelName("eventProfile");
+    if (!args.empty())
+    {
+        modelName = SystemPath::Split(args[0]).back();
+    }
+    m_outputName = modelName + "-event-profile";
+    if (!outDir.empty())
+    {
+        m_outputName = SystemPath::Append(outDir, m_outputName);
+    }
+}
+
+uint64_t
+EventProfiler::Now()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return SteadyNs();
+#endif
+}
+
+std::size_t
+EventProfiler::KeyHash::operator()(const Key& key) const
+{
+    std::size_t h = reinterpret_cast<uintptr_t>(key.function);
+    h ^= reinterpret_cast<uintptr_t>(key.type) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    h ^= key.context + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    return h;
+}
+
+EventProfiler::Table&
+EventProfiler::GetTable()
+{
+    // The tables outlive their threads, so that the events of the worker
+    // threads of the multithreaded simulator are in the report.
+    thread_local Table* table = nullptr;
+    if (!table)
+    {
+        table = new Table;
+        std::unique_lock lock{m_mutex};
+        m_tables.push_back(table);
+    }
+    return *table;
+}
+
+void
+EventProfiler::Invoke(EventImpl* event, uint32_t context)
+{
+#ifdef NS3_EVENT_PROFILER_ENABLE
+    // the function of a cancelled event may refer to an object which no
+    // longer exists
+    if (event->IsCancelled())
+    {
+        return;
+    }
+    EventImpl::ProfileKey key = event->GetProfileKey();
+    uint64_t start = Now();
+    event->Invoke();
+    Record(key.function, key.type, context, Now() - start);
+#else
+    event->Invoke();
+#endif
+}
+
+void
+EventProfiler::Record(const void* function,
+                      const std::type_info* type,
+                      uint32_t context,
+                      uint64_t ticks)
+{
+    Stats& stats = GetTable()[Key{function, type, context}];
+    stats.count++;
+    stats.ticks += ticks;
+}
+
+double
+EventProfiler::GetSecondsPerTick() const
+{
+#if defined(__x86_64__) || defined(__i386__)
+    uint64_t ticks = Now() - m_startTicks;
+    uint64_t ns = SteadyNs() - m_startNs;
+    return ticks ? 1e-9 * ns / ticks : 0;
+#else
+    return 1e-9;
+#endif
+}
+
+std::string
+EventProfiler::GetName(const void* function, const std::type_info* type)
+{
+#if defined(__GNUC__) && !defined(_WIN32)
+    Dl_info info;
+    if (function && dladdr(function, &info) && info.dli_sname && info.dli_saddr == function)
+    {
+        return Demangle(info.dli_sname);
+    }
+#endif
+    std::string name = Demangle(type->name());
+    if (function)
+    {
+        std::ostringstream oss;
+        oss << name << " [" << function << "]";
+        name = oss.str();
+    }
+    return name;
+}
+
+std::vector<EventProfiler::Entry>
+EventProfiler::GetEntries()
+{
+    // merge the tables of the threads
+    Table total;
+    {
+        std::unique_lock lock{m_mutex};
+        for (auto table : m_tables)
+        {
+            for (const auto& [key, stats] : *table)
+            {
+                Stats& sum = total[key];
+                sum.count += stats.count;
+                sum.ticks += stats.ticks;
+            }
+        }
+    }
+
+    // the same function may be reached through several keys (for example a
+    // method bound to different pointer types), so merge by name
+    double secondsPerTick = GetSecondsPerTick();
+    std::map<std::pair<std::string, uint32_t>, Stats> byName;
+    std::unordered_map<const void*, std::string> names;
+    for (const auto& [key, stats] : total)
+    {
+        const void* id = key.function ? key.function : static_cast<const void*>(key.type);
+        auto name = names.find(id);
+        if (name == names.end())
+        {
+            name = names.emplace(id, GetName(key.function, key.type)).first;
+        }
+        Stats& sum = byName[{name->second, key.context}];
+        sum.count += stats.count;
+        sum.ticks += stats.ticks;
+    }
+
+    std::vector<Entry> entries;
+    entries.reserve(byName.size());
+    for (const auto& [key, stats] : byName)
+    {
+        entries.push_back({key.first, key.second, stats.count, stats.ticks * secondsPerTick});
+    }
+    std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.seconds > b.seconds;
+    });
+    return entries;
+}
+
+void
+EventProfiler::Write()
+{
+    std::vector<Entry> entries = GetEntries();
+    if (entries.empty())
+    {
+        return;
+    }
+
+    // totals per function
+    std::map<std::string, Entry> functions;
+    double totalSeconds = 0;
+    uint64_t totalCount = 0;
+    for (const auto& entry : entries)
+    {
+        auto [it, inserted] = functions.try_emplace(entry.function, entry);
+        if (!inserted)
+        {
+            it->second.count += entry.count;
+            it->second.seconds += entry.seconds;
+        }
+        totalSeconds += entry.seconds;
+        totalCount += entry.count;
+    }
+    std::vector<Entry> byFunction;
+    for (const auto& [name, entry] : functions)
+    {
+        byFunction.push_back(entry);
+    }
+    std::stable_sort(byFunction.begin(), byFunction.end(), [](const Entry& a, const Entry& b) {
+        return a.seconds > b.seconds;
+    });
+
+    std::ofstream report(m_outputName + ".txt");
+    report << "events: " << totalCount << ", time in events: " << std::fixed
+           << std::setprecision(3) << totalSeconds << " s" << std::endl;
+    auto printLine = [&report, totalSeconds](const Entry& entry, bool context) {
+        report << std::setw(12) << std::setprecision(3) << entry.seconds * 1e3 << std::setw(8)
+               << std::setprecision(1) << (totalSeconds > 0 ? 100 * entry.seconds / totalSeconds : 0)
+               << std::setw(12) << entry.count << std::setw(10) << std::setprecision(0)
+               << entry.seconds * 1e9 / entry.count;
+        if (context)
+        {
+            report << std::setw(11);
+            if (entry.context == 0xffffffff)
+            {
+                report << "-";
+            }
+            else
+            {
+                report << entry.context;
+            }
+        }
+        report << "  " << entry.function << std::endl;
+    };
+
+    report << std::endl << "Per function:" << std::endl;
+    report << std::setw(12) << "time(ms)" << std::setw(8) << "%" << std::setw(12) << "calls"
+           << std::setw(10) << "ns/call"
+           << "  function" << std::endl;
+    for (const auto& entry : byFunction)
+    {
+        printLine(entry, false);
+    }
+    report << std::endl << "Per function and context:" << std::endl;
+    report << std::setw(12) << "time(ms)" << std::setw(8) << "%" << std::setw(12) << "calls"
+           << std::setw(10) << "ns/call" << std::setw(11) << "context"
+           << "  function" << std::endl;
+    for (const auto& entry : entries)
+    {
+        printLine(entry, true);
+    }
+
+    std::ofstream folded(m_outputName + ".folded");
+    for (const auto& entry : entries)
+    {
+        std::string function = entry.function;
+        std::replace(function.begin(), function.end(), ';', ':');
+        folded << function << ";";
+        if (entry.context == 0xffffffff)
+        {
+            folded << "no context";
+        }
+        else
+        {
+            folded << "node " << entry.context;
+        }
+        folded << " " << static_cast<uint64_t>(entry.seconds * 1e9) << "\n";
+    }
+    NS_LOG_INFO("wrote " << m_outputName << ".txt and " << m_outputName << ".folded");
+}
+
+void
+EventProfiler::Reset()
+{
+    std::unique_lock lock{m_mutex};
+    for (auto table : m_tables)
+    {
+        table->clear();
+    }
+}
+
+} // namespace ns3
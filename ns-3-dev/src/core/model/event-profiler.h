@@ -0,0 +1,221 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+/**
+ * @file
+ * @ingroup simulator
+ * ns3::EventProfiler declaration.
+ */
+
+#include "event-impl.h"
+#include "singleton.h"
+
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * @ingroup simulator
+ * @brief Wall clock time of the events, per function and per context.
+ *
+ * The simulator implementations time every event they execute and
+ * attribute the time to the function the event calls (the class method or
+ * function bound by MakeEvent(), resolved to its demangled symbol name) and
+ * to the context of the event, which is the node id for the events of
+ * the nodes. Only the execution of the event itself is timed: the time the
+ * scheduler spends inserting and removing the events, and the rest of the
+ * event loop, are not accounted for.
+ *
+ * The time stamp counter of the processor is used where there is one, the
+ * steady clock otherwise. The cost of the profiling itself has not been
+ * measured, and is included in the times reported.
+ *
+ * At each Simulator::Destroy() two files are written, with the totals since
+ * the start of the program:
+ *
+ * \li \c <program>-event-profile.txt, the functions sorted by their total
+ *   time, followed by the (function, context) pairs sorted the same way;
+ * \li \c <program>-event-profile.folded, one line per (function, context)
+ *   pair in the folded stack format of FlameGraph
+ *   (https://github.com/brendangregg/FlameGraph), the function above the
+ *   context and the time in nanoseconds as the sample count:
+ * \verbatim
+ns3::RangerMac::CheckQueue();node 12 1835200 \endverbatim
+ *
+ * As with DesMetrics, the program name is taken from CommandLine; programs
+ * which do not use it write \c eventProfile-event-profile.txt.
+ * Functions whose symbol is not exported (for example those of the program
+ * itself, unless it is linked with \c -rdynamic) are shown by their type
+ * and address. Lambdas are shown by their type.
+ *
+ * <b> Enabling the event profiler </b>
+ *
+ * The profiler is compiled in with
+ * \verbatim
+   $ ns3 configure ... --enable-event-profiler \endverbatim
+ * Without it, the event loop of the simulators is left unchanged.
+ * Use it with the optimized or release build profiles, as logging and
+ * asserts otherwise dominate the times.
+ */
+class EventProfiler : public Singleton<EventProfiler>
+{
+  public:
+    /** Statistics of a function in a context. */
+    struct Entry
+    {
+        std::string function; //!< Demangled name of the function
+        uint32_t context;     //!< The context
+        uint64_t count;       //!< Number of calls
+        double seconds;       //!< Cumulative wall clock time
+    };
+
+    EventProfiler();
+    ~EventProfiler() override;
+
+    /**
+     * Set the name of the output files after the program.
+     *
+     * \param args [in] Command line arguments.
+     * \param outDir [in] Directory where the files should be written.
+     */
+    void Initialize(std::vector<std::string> args, std::string outDir = "");
+
+    /**
+     * Read the clock used to time the events.
+     *
+     * \returns The current tick count.
+     */
+    static uint64_t Now();
+
+    /**
+     * Execute an event, unless it has been cancelled, and account for its
+     * execution. Without the NS3_EVENT_PROFILER build option the event is
+     * only executed.
+     *
+     * \param event [in] The event.
+     * \param context [in] The context of the event.
+     */
+    void Invoke(EventImpl* event, uint32_t context);
+
+    /**
+     * Account for the execution of an event.
+     *
+     * \param function [in] Code address of the function called by the event,
+     *   or nullptr.
+     * \param type [in] Type of the function or of the event.
+     * \param context [in] The context of the event.
+     * \param ticks [in] The clock ticks spent in the event.
+     */
+    void Record(const void* function,
+                const std::type_info* type,
+                uint32_t context,
+                uint64_t ticks);
+
+    /**
+     * Get the statistics recorded so far by all the threads, sorted by
+     * decreasing total time.
+     *
+     * \returns The (function, context) statistics.
+     */
+    std::vector<Entry> GetEntries();
+
+    /** Write the report and the folded stacks. */
+    void Write();
+
+    /** Forget the statistics recorded so far. */
+    void Reset();
+
+  private:
+    /** The key of the statistics. */
+    struct Key
+    {
+        const void* function;       //!< Code address of the function
+        const std::type_info* type; //!< Type of the function or event
+        uint32_t context;           //!< The context
+
+        /**
+         * \param other [in] The key to compare to.
+         * \returns true if both keys are the same.
+         */
+        bool operator==(const Key& other) const
+        {
+            return function == other.function && type == other.type && context == other.context;
+        }
+    };
+
+    /** Hash of a Key. */
+    struct KeyHash
+    {
+        /**
+         * \param key [in] The key.
+         * \returns The hash of the key.
+         */
+        std::size_t operator()(const Key& key) const;
+    };
+
+    /** Call count and ticks. */
+    struct Stats
+    {
+        uint64_t count{0}; //!< Number of calls
+        uint64_t ticks{0}; //!< Cumulative ticks
+    };
+
+    /** Statistics recorded by one thread. */
+    using Table = std::unordered_map<Key, Stats, KeyHash>;
+
+    /**
+     * Get the table of the calling thread, registering it on first use.
+     *
+     * \returns The table of the calling thread.
+     */
+    Table& GetTable();
+
+    /**
+     * Resolve the name of a function.
+     *
+     * \param function [in] Code address of the function, or nullptr.
+     * \param type [in] Type of the function or event.
+     * \returns The demangled name of the function.
+     */
+    static std::string GetName(const void* function, const std::type_info* type);
+
+    /**
+     * \returns The number of seconds per clock tick.
+     */
+    double GetSecondsPerTick() const;
+
+    /** Tables of all the threads, owned by the profiler. */
+    std::vector<Table*> m_tables;
+    /** Mutex to control access to m_tables. */
+    std::mutex m_mutex;
+
+    std::string m_outputName; //!< Output file name, without the extension
+    uint64_t m_startTicks;    //!< Clock ticks at construction
+    uint64_t m_startNs;       //!< Steady clock at construction, in ns
+
+}; // class EventProfiler
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
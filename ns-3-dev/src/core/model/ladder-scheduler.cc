@@ -0,0 +1,328 @@
+/*
+ * Copyright (c) 2009 INRIA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+
+#include "assert.h"
+#include "event-impl.h"
+#include "log.h"
+#include "uinteger.h"
+
+#include <algorithm>
+#include <limits>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED(LadderScheduler);
+
+TypeId
+LadderScheduler::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::LadderScheduler")
+            .SetParent<Scheduler>()
+            .SetGroupName("Core")
+            .AddConstructor<LadderScheduler>()
+            .AddAttribute("Threshold",
+                          "Number of events in a bucket above which it is split into a new rung",
+                          TypeId::ATTR_CONSTRUCT,
+                          UintegerValue(50),
+                          MakeUintegerAccessor(&LadderScheduler::m_threshold),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("MaxRungs",
+                          "Maximum number of rungs of the ladder",
+                          TypeId::ATTR_CONSTRUCT,
+                          UintegerValue(8),
+                          MakeUintegerAccessor(&LadderScheduler::m_maxRungs),
+                          MakeUintegerChecker<uint32_t>(1));
+    return tid;
+}
+
+LadderScheduler::LadderScheduler()
+    : m_topMin(std::numeric_limits<uint64_t>::max()),
+      m_topMax(0),
+      m_topStart(0),
+      m_nRungs(0),
+      m_bottomHead(0),
+      m_qSize(0),
+      m_threshold(50),
+      m_maxRungs(8)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+LadderScheduler::~LadderScheduler()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+LadderScheduler::Insert(const Scheduler::Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    DoInsert(ev);
+    m_qSize++;
+    if (m_bottomHead == m_bottom.size())
+    {
+        Refill();
+    }
+}
+
+bool
+LadderScheduler::IsEmpty() const
+{
+    NS_LOG_FUNCTION(this);
+    return m_qSize == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext() const
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!IsEmpty());
+    return m_bottom[m_bottomHead];
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!IsEmpty());
+    Scheduler::Event ev = m_bottom[m_bottomHead++];
+    m_qSize--;
+    if (m_bottomHead == m_bottom.size())
+    {
+        Refill();
+    }
+    NS_LOG_LOGIC("remove ts=" << ev.key.m_ts << ", key=" << ev.key.m_uid
+                              << ", from bottom, size=" << m_qSize);
+    return ev;
+}
+
+void
+LadderScheduler::Remove(const Scheduler::Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    NS_ASSERT(!IsEmpty());
+
+    uint64_t ts = ev.key.m_ts;
+    Bucket* bucket = nullptr;
+    Rung* rung = nullptr;
+    if (ts >= m_topStart)
+    {
+        bucket = &m_top;
+    }
+    else
+    {
+        uint32_t i = FindRung(ts);
+        if (i < m_nRungs)
+        {
+            rung = &m_rungs[i];
+            bucket = &rung->buckets[(ts - rung->start) / rung->width];
+        }
+    }
+
+    if (bucket)
+    {
+        // buckets are unsorted, fill the hole with the last event
+        auto it = std::find(bucket->begin(), bucket->end(), ev);
+        NS_ASSERT(it != bucket->end());
+        *it = bucket->back();
+        bucket->pop_back();
+        if (rung)
+        {
+            rung->count--;
+        }
+    }
+    else
+    {
+        auto it = std::lower_bound(m_bottom.begin() + m_bottomHead, m_bottom.end(), ev);
+        NS_ASSERT(it != m_bottom.end() && *it == ev);
+        m_bottom.erase(it);
+    }
+    m_qSize--;
+
+    if (m_bottomHead == m_bottom.size())
+    {
+        Refill();
+    }
+}
+
+void
+LadderScheduler::DoInsert(const Scheduler::Event& ev)
+{
+    uint64_t ts = ev.key.m_ts;
+    if (ts >= m_topStart)
+    {
+        m_top.push_back(ev);
+        m_topMin = std::min(m_topMin, ts);
+        m_topMax = std::max(m_topMax, ts);
+        return;
+    }
+
+    uint32_t i = FindRung(ts);
+    if (i < m_nRungs)
+    {
+        Rung& rung = m_rungs[i];
+        rung.buckets[(ts - rung.start) / rung.width].push_back(ev);
+        rung.count++;
+        return;
+    }
+
+    InsertBottom(ev);
+}
+
+void
+LadderScheduler::InsertBottom(const Scheduler::Event& ev)
+{
+    // new events are mostly later than the ones in Bottom, search from the end
+    auto it = m_bottom.end();
+    while (it != m_bottom.begin() + m_bottomHead && ev < *(it - 1))
+    {
+        --it;
+    }
+    m_bottom.insert(it, ev);
+}
+
+uint32_t
+LadderScheduler::FindRung(uint64_t ts) const
+{
+    // each rung covers the events from its current bucket up to the
+    // current bucket of the rung above, the first rung up to Top
+    for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+        if (ts >= m_rungs[i].CurrentStart())
+        {
+            return i;
+        }
+    }
+    return m_nRungs;
+}
+
+void
+LadderScheduler::SpawnRung(uint64_t start, uint64_t span, Bucket& events)
+{
+    NS_LOG_FUNCTION(this << start << span << events.size());
+    NS_ASSERT(span > 0 && !events.empty());
+
+    if (m_nRungs == m_rungs.size())
+    {
+        m_rungs.emplace_back();
+    }
+    Rung& rung = m_rungs[m_nRungs++];
+
+    uint64_t nBuckets = events.size();
+    rung.width = (span + nBuckets - 1) / nBuckets;
+    nBuckets = (span + rung.width - 1) / rung.width;
+    rung.start = start;
+    rung.current = 0;
+    rung.count = events.size();
+    rung.buckets.resize(nBuckets);
+
+    for (const auto& ev : events)
+    {
+        rung.buckets[(ev.key.m_ts - start) / rung.width].push_back(ev);
+    }
+    events.clear();
+}
+
+void
+LadderScheduler::Refill()
+{
+    NS_LOG_FUNCTION(this);
+    m_bottom.clear();
+    m_bottomHead = 0;
+
+    while (true)
+    {
+        if (m_nRungs == 0)
+        {
+            if (m_top.empty())
+            {
+                NS_ASSERT(m_qSize == 0);
+                return;
+            }
+
+            uint64_t start = m_topMin;
+            uint64_t span = m_topMax - m_topMin + 1;
+            if (m_top.size() <= m_threshold || span == 1)
+            {
+                m_topStart = m_topMax + 1;
+                m_bottom.swap(m_top);
+            }
+            else
+            {
+                SpawnRung(start, span, m_top);
+                const Rung& rung = m_rungs[0];
+                m_topStart = rung.start + rung.buckets.size() * rung.width;
+            }
+            m_topMin = std::numeric_limits<uint64_t>::max();
+            m_topMax = 0;
+            if (!m_bottom.empty())
+            {
+                break;
+            }
+            continue;
+        }
+
+        Rung& rung = m_rungs[m_nRungs - 1];
+        if (rung.count == 0)
+        {
+            m_nRungs--;
+            continue;
+        }
+        while (rung.buckets[rung.current].empty())
+        {
+            rung.current++;
+        }
+
+        Bucket& bucket = rung.buckets[rung.current];
+        uint64_t bucketStart = rung.CurrentStart();
+        uint64_t width = rung.width;
+        rung.current++;
+        rung.count -= bucket.size();
+
+        if (bucket.size() > m_threshold && width > 1 && m_nRungs < m_maxRungs)
+        {
+            // spread the bucket over a new rung. Adding the rung may move
+            // rung and bucket, so give the bucket its storage back by index.
+            Bucket events;
+            events.swap(bucket);
+            SpawnRung(bucketStart, width, events);
+            m_rungs[m_nRungs - 2].buckets[m_rungs[m_nRungs - 2].current - 1].swap(events);
+            continue;
+        }
+
+        m_bottom.swap(bucket);
+        break;
+    }
+
+    std::sort(m_bottom.begin(), m_bottom.end());
+    NS_LOG_LOGIC("refilled bottom with " << m_bottom.size() << " events, " << m_nRungs
+                                         << " rungs, " << m_top.size() << " events in top");
+}
+
+} // namespace ns3
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2009 INRIA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the ladder queue of
+ * ["Ladder Queue: An O(1) Priority Queue Structure for Large-Scale
+ * Discrete Event Simulation" by Tang, Goh and Thng][Tang].
+ * Events are kept in three tiers:
+ *
+ * - *Top*, an unsorted vector of the events furthest in the future,
+ *   those with a timestamp at or after `m_topStart`.
+ * - The *ladder*, a stack of rungs. Each rung is an array of unsorted
+ *   buckets of uniform width; each rung below the first subdivides a
+ *   single bucket of the rung above it.
+ * - *Bottom*, a short sorted vector holding the events that are
+ *   dequeued next.
+ *
+ * When Bottom runs empty the next non empty bucket of the lowest rung
+ * is sorted into it, unless that bucket holds more than `Threshold`
+ * events, in which case a new rung is spawned to spread them over finer
+ * buckets. When the ladder is exhausted Top becomes its first rung, its
+ * width adapted to the span and number of the events in Top. Since the
+ * rungs follow the event density, time distributions mixing dense short
+ * delays with sparse long timers do not cause the resizing that the
+ * CalendarScheduler goes through.
+ *
+ * Within a timestamp events are dequeued in uid order, as with the
+ * other schedulers.
+ *
+ * [Tang]: https://doi.org/10.1145/1103323.1103324 "Tang"
+ *
+ * \par Time Complexity
+ *
+ * Operation    | Amortized %Time | Reason
+ * :----------- | :-------------- | :-----
+ * Insert()     | ~Constant       | Append to Top or to a bucket; sorted insertion into Bottom
+ * IsEmpty()    | Constant        | Explicit queue size
+ * PeekNext()   | Constant        | Bottom is kept non empty
+ * Remove()     | ~Constant       | Search within a bucket
+ * RemoveNext() | ~Constant       | Refill Bottom from a bucket of bounded size
+ *
+ * \par Memory Complexity
+ *
+ * Category  | Memory                           | Reason
+ * :-------- | :------------------------------- | :-----
+ * Overhead  | 3 x `std::vector` + rungs        | `std::vector`
+ * Per Event | 2 x `sizeof (*)`                 | `std::vector`
+ */
+class LadderScheduler : public Scheduler
+{
+  public:
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /** Constructor. */
+    LadderScheduler();
+    /** Destructor. */
+    ~LadderScheduler() override;
+
+    // Inherited
+    void Insert(const Scheduler::Event& ev) override;
+    bool IsEmpty() const override;
+    Scheduler::Event PeekNext() const override;
+    Scheduler::Event RemoveNext() override;
+    void Remove(const Scheduler::Event& ev) override;
+
+  private:
+    /** Bucket type: an unsorted vector of Events. */
+    typedef std::vector<Scheduler::Event> Bucket;
+
+    /** A rung of the ladder. */
+    struct Rung
+    {
+        uint64_t start;               //!< Timestamp of the start of the first bucket.
+        uint64_t width;               //!< Width of a bucket, in dimensionless time units.
+        uint32_t current;             //!< Index of the first bucket not dequeued yet.
+        uint64_t count;               //!< Number of events in the buckets.
+        std::vector<Bucket> buckets;  //!< The buckets.
+
+        /**
+         * \returns The timestamp of the start of the current bucket.
+         */
+        uint64_t CurrentStart() const
+        {
+            return start + current * width;
+        }
+    };
+
+    /**
+     * Place an event in the tier its timestamp belongs to.
+     *
+     * \param [in] ev The event.
+     */
+    void DoInsert(const Scheduler::Event& ev);
+    /**
+     * Insert an event into Bottom, keeping it sorted.
+     *
+     * \param [in] ev The event.
+     */
+    void InsertBottom(const Scheduler::Event& ev);
+    /**
+     * Find the rung whose current and later buckets cover a timestamp.
+     *
+     * \param [in] ts The timestamp, which must be before \c m_topStart.
+     * \returns The index of the rung, or \c m_nRungs if \p ts belongs to Bottom.
+     */
+    uint32_t FindRung(uint64_t ts) const;
+    /**
+     * Push a new lowest rung covering a time span, and move events into it.
+     *
+     * \param [in] start The start of the span.
+     * \param [in] span The length of the span, in dimensionless time units.
+     * \param [in] events The events to move, all within the span.
+     */
+    void SpawnRung(uint64_t start, uint64_t span, Bucket& events);
+    /** Move events from the ladder or Top to Bottom, until it is non empty. */
+    void Refill();
+
+    /** Events with a timestamp at or after \c m_topStart, unsorted. */
+    Bucket m_top;
+    /** Smallest timestamp in Top. */
+    uint64_t m_topMin;
+    /** Largest timestamp in Top. */
+    uint64_t m_topMax;
+    /** Timestamp from which events go to Top. */
+    uint64_t m_topStart;
+
+    /**
+     * The rungs, the first \c m_nRungs of them in use. Rungs are kept
+     * when popped so that their buckets are reused.
+     */
+    std::vector<Rung> m_rungs;
+    /** Number of rungs in use. */
+    uint32_t m_nRungs;
+
+    /** The next events, sorted, starting at \c m_bottomHead. */
+    Bucket m_bottom;
+    /** Index of the first event of Bottom. */
+    std::size_t m_bottomHead;
+
+    /** Number of events in queue. */
+    uint64_t m_qSize;
+
+    /** Number of events in a bucket above which a new rung is spawned. */
+    uint32_t m_threshold;
+    /** Maximum number of rungs. */
+    uint32_t m_maxRungs;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
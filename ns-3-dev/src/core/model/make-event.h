@@ -353,6 +353,14 @@ EventImpl* MakeEvent(T function);
 #include "event-impl.h"
 #include "type-traits.h"
 
+#ifdef NS3_EVENT_PROFILER_ENABLE
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <typeinfo>
+#endif
+
 namespace ns3
 {
 
@@ -392,6 +400,91 @@ struct EventMemberImplObjTraits<T*>
     }
 };
 
+#ifdef NS3_EVENT_PROFILER_ENABLE
+/**
+ * \ingroup makeeventmemptr
+ * Get the code address of a class method called on an object, for the
+ * EventProfiler.
+ *
+ * Virtual methods are looked up in the virtual table of the object. This
+ * relies on the representation of pointers to member functions of the
+ * Itanium C++ ABI (and its ARM variant); with other ABIs the address is
+ * not known.
+ *
+ * \tparam OBJ \deduced The class type holding the method.
+ * \tparam MEM \deduced The class method function signature.
+ * \param [in] obj The object.
+ * \param [in] mem_ptr The class method.
+ * \returns The code address of the method, or nullptr.
+ */
+template <typename OBJ, typename MEM>
+const void*
+EventMemberFunctionAddress(const OBJ& obj, MEM mem_ptr)
+{
+#if defined(__GNUC__) && !defined(_WIN32)
+    /** Pointer to member function of the Itanium C++ ABI. */
+    struct ItaniumMemberFunction
+    {
+        uintptr_t ptr;  //!< Function address, or virtual table offset
+        ptrdiff_t adj; //!< Adjustment of the this pointer
+    };
+
+    if constexpr (sizeof(MEM) != sizeof(ItaniumMemberFunction))
+    {
+        return nullptr;
+    }
+    else
+    {
+        ItaniumMemberFunction pmf;
+        std::memcpy(&pmf, &mem_ptr, sizeof(pmf));
+#if defined(__arm__) || defined(__aarch64__)
+        bool isVirtual = pmf.adj & 1;
+        ptrdiff_t adj = pmf.adj >> 1;
+        uintptr_t offset = pmf.ptr;
+#else
+        bool isVirtual = pmf.ptr & 1;
+        ptrdiff_t adj = pmf.adj;
+        uintptr_t offset = pmf.ptr - 1;
+#endif
+        if (!isVirtual)
+        {
+            return reinterpret_cast<const void*>(pmf.ptr);
+        }
+        const char* self = reinterpret_cast<const char*>(
+                               std::addressof(EventMemberImplObjTraits<OBJ>::GetReference(obj))) +
+                           adj;
+        const char* vtable = *reinterpret_cast<const char* const*>(self);
+        return *reinterpret_cast<const void* const*>(vtable + offset);
+    }
+#else
+    return nullptr;
+#endif
+}
+
+/**
+ * \ingroup makeeventfnptr
+ * Get the code address of a function, for the EventProfiler.
+ *
+ * \tparam F \deduced The function type.
+ * \param [in] f The function.
+ * \returns The code address of the function, or nullptr if it is not a
+ * function pointer.
+ */
+template <typename F>
+const void*
+EventFunctionAddress(F f)
+{
+    if constexpr (std::is_pointer_v<F> && std::is_function_v<std::remove_pointer_t<F>>)
+    {
+        return reinterpret_cast<const void*>(f);
+    }
+    else
+    {
+        return nullptr;
+    }
+}
+#endif
+
 template <typename MEM, typename OBJ>
 EventImpl*
 MakeEvent(MEM mem_ptr, OBJ obj)
@@ -410,6 +503,13 @@ MakeEvent(MEM mem_ptr, OBJ obj)
         {
         }
 
+#ifdef NS3_EVENT_PROFILER_ENABLE
+        ProfileKey GetProfileKey() const override
+        {
+            return {EventMemberFunctionAddress(m_obj, m_function), &typeid(MEM)};
+        }
+#endif
+
       private:
         void Notify() override
         {
@@ -438,6 +538,13 @@ MakeEvent(MEM mem_ptr, OBJ obj, T1 a1)
         {
         }
 
+#ifdef NS3_EVENT_PROFILER_ENABLE
+        ProfileKey GetProfileKey() const override
+        {
+            return {EventMemberFunctionAddress(m_obj, m_function), &typeid(MEM)};
+        }
+#endif
+
       protected:
         ~EventMemberImpl1() override
         {
@@ -473,6 +580,13 @@ MakeEvent(MEM mem_ptr, OBJ obj, T1 a1, T2 a2)
         {
         }
 
+#ifdef NS3_EVENT_PROFILER_ENABLE
+        ProfileKey GetProfileKey() const override
+        {
+            return {EventMemberFunctionAddress(m_obj, m_function), &typeid(MEM)};
+        }
+#endif
+
       protected:
         ~EventMemberImpl2() override
         {
@@ -510,6 +624,13 @@ MakeEvent(MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3)
         {
         }
 
+#ifdef NS3_EVENT_PROFILER_ENABLE
+        ProfileKey GetProfileKey() const override
+        {
+            return {EventMemberFunctionAddress(m_obj, m_function), &typeid(MEM)};
+        }
+#endif
+
       protected:
         ~EventMemberImpl3() override
         {
@@ -549,6 +670,13 @@ MakeEvent(MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3, T4 a4)
         {
         }
 
+#ifdef NS3_EVENT_PROFILER_ENABLE
+        ProfileKey GetProfileKey() const override
+        {
+            return {EventMemberFunctionAddress(m_obj, m_function), &typeid(MEM)};
+        }
+#endif
+
       protected:
         ~EventMemberImpl4() override
         {
@@ -597,6 +725,13 @@ MakeEvent(MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3, T4 a4, T5 a5)
         {
         }
 
+#ifdef NS3_EVENT_PROFILER_ENABLE
+        ProfileKey GetProfileKey() const override
+        {
+            return {EventMemberFunctionAddress(m_obj, m_function), &typeid(MEM)};
+        }
+#endif
+
       protected:
         ~EventMemberImpl5() override
         {
@@ -648,6 +783,13 @@ MakeEvent(MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6)
         {
         }
 
+#ifdef NS3_EVENT_PROFILER_ENABLE
+        ProfileKey GetProfileKey() const override
+        {
+            return {EventMemberFunctionAddress(m_obj, m_function), &typeid(MEM)};
+        }
+#endif
+
       protected:
         ~EventMemberImpl6() override
         {
@@ -689,6 +831,13 @@ MakeEvent(void (*f)(U1), T1 a1)
         {
         }
 
+#ifdef NS3_EVENT_PROFILER_ENABLE
+        ProfileKey GetProfileKey() const override
+        {
+            return {EventFunctionAddress(m_function), &typeid(F)};
+        }
+#endif
+
       protected:
         ~EventFunctionImpl1() override
         {
@@ -724,6 +873,13 @@ MakeEvent(void (*f)(U1, U2), T1 a1, T2 a2)
         {
         }
 
+#ifdef NS3_EVENT_PROFILER_ENABLE
+        ProfileKey GetProfileKey() const override
+        {
+            return {EventFunctionAddress(m_function), &typeid(F)};
+        }
+#endif
+
       protected:
         ~EventFunctionImpl2() override
         {
@@ -761,6 +917,13 @@ MakeEvent(void (*f)(U1, U2, U3), T1 a1, T2 a2, T3 a3)
         {
         }
 
+#ifdef NS3_EVENT_PROFILER_ENABLE
+        ProfileKey GetProfileKey() const override
+        {
+            return {EventFunctionAddress(m_function), &typeid(F)};
+        }
+#endif
+
       protected:
         ~EventFunctionImpl3() override
         {
@@ -807,6 +970,13 @@ MakeEvent(void (*f)(U1, U2, U3, U4), T1 a1, T2 a2, T3 a3, T4 a4)
         {
         }
 
+#ifdef NS3_EVENT_PROFILER_ENABLE
+        ProfileKey GetProfileKey() const override
+        {
+            return {EventFunctionAddress(m_function), &typeid(F)};
+        }
+#endif
+
       protected:
         ~EventFunctionImpl4() override
         {
@@ -857,6 +1027,13 @@ MakeEvent(void (*f)(U1, U2, U3, U4, U5), T1 a1, T2 a2, T3 a3, T4 a4, T5 a5)
         {
         }
 
+#ifdef NS3_EVENT_PROFILER_ENABLE
+        ProfileKey GetProfileKey() const override
+        {
+            return {EventFunctionAddress(m_function), &typeid(F)};
+        }
+#endif
+
       protected:
         ~EventFunctionImpl5() override
         {
@@ -911,6 +1088,13 @@ MakeEvent(void (*f)(U1, U2, U3, U4, U5, U6), T1 a1, T2 a2, T3 a3, T4 a4, T5 a5,
         {
         }
 
+#ifdef NS3_EVENT_PROFILER_ENABLE
+        ProfileKey GetProfileKey() const override
+        {
+            return {EventFunctionAddress(m_function), &typeid(F)};
+        }
+#endif
+
       protected:
         ~EventFunctionImpl6() override
         {
@@ -950,6 +1134,13 @@ MakeEvent(T function)
         {
         }
 
+#ifdef NS3_EVENT_PROFILER_ENABLE
+        ProfileKey GetProfileKey() const override
+        {
+            return {EventFunctionAddress(m_function), &typeid(T)};
+        }
+#endif
+
       private:
         void Notify() override
         {
@@ -0,0 +1,620 @@
+/*
+ * Copyright (c) 2005,2006 INRIA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-simulator-impl.h"
+
+#include "abort.h"
+#include "assert.h"
+#include "event-profiler.h"
+#include "log.h"
+#include "scheduler.h"
+#include "simulator.h"
+#include "uinteger.h"
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::MultithreadedSimulatorImpl implementation.
+ */
+
+namespace ns3
+{
+
+// Note:  Logging in this file is largely avoided due to the
+// number of calls that are made to these functions and the possibility
+// of causing recursions leading to stack overflow
+NS_LOG_COMPONENT_DEFINE("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED(MultithreadedSimulatorImpl);
+
+thread_local MultithreadedSimulatorImpl::Partition* MultithreadedSimulatorImpl::t_partition =
+    nullptr;
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::MultithreadedSimulatorImpl")
+            .SetParent<SimulatorImpl>()
+            .SetGroupName("Core")
+            .AddConstructor<MultithreadedSimulatorImpl>()
+            .AddAttribute("ThreadCount",
+                          "The number of threads, each running the events of a partition "
+                          "of the contexts.",
+                          TypeId::ATTR_CONSTRUCT,
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&MultithreadedSimulatorImpl::m_threadCount),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("Lookahead",
+                          "The minimum delay of the events scheduled for another context, "
+                          "and the length of the synchronization windows. It must be set "
+                          "before Run() is called.",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&MultithreadedSimulatorImpl::m_lookahead),
+                          MakeTimeChecker());
+    return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl()
+    : m_threadCount(1),
+      m_windowStartTs(0),
+      m_windowEndTs(0),
+      m_windowEventCount(0),
+      m_done(false),
+      m_stop(false),
+      m_currentTs(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    for (auto& partition : m_partitions)
+    {
+        while (!partition->events->IsEmpty())
+        {
+            Scheduler::Event next = partition->events->RemoveNext();
+            next.impl->Unref();
+        }
+        partition->events = nullptr;
+    }
+    m_partitions.clear();
+    SimulatorImpl::DoDispose();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy()
+{
+    NS_LOG_FUNCTION(this);
+    while (!m_destroyEvents.empty())
+    {
+        Ptr<EventImpl> ev = m_destroyEvents.front().PeekEventImpl();
+        m_destroyEvents.pop_front();
+        NS_LOG_LOGIC("handle destroy " << ev);
+        if (!ev->IsCancelled())
+        {
+            ev->Invoke();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::CreatePartitions()
+{
+    NS_LOG_FUNCTION(this << m_threadCount);
+#ifndef NS3_MULTITHREADED_ENABLE
+    NS_ABORT_MSG_IF(m_threadCount > 1,
+                    "MultithreadedSimulatorImpl: a ThreadCount of "
+                        << m_threadCount
+                        << " needs the thread-safe reference counts of a build with "
+                           "NS3_MULTITHREADED (--enable-multithreaded)");
+#endif
+    // one partition per thread, and one for the events without context
+    for (uint32_t i = 0; i <= m_threadCount; i++)
+    {
+        auto partition = std::make_unique<Partition>();
+        partition->index = i;
+        partition->uid = EventId::UID::VALID;
+        partition->currentUid = EventId::UID::INVALID;
+        partition->currentTs = 0;
+        partition->currentContext = Simulator::NO_CONTEXT;
+        partition->eventCount = 0;
+        partition->objectUid = 0;
+        partition->outboxes.resize(m_threadCount + 1);
+        m_partitions.push_back(std::move(partition));
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler(ObjectFactory schedulerFactory)
+{
+    NS_LOG_FUNCTION(this << schedulerFactory);
+    m_schedulerFactory = schedulerFactory;
+    if (m_partitions.empty())
+    {
+        CreatePartitions();
+    }
+
+    for (auto& partition : m_partitions)
+    {
+        Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler>();
+        if (partition->events)
+        {
+            while (!partition->events->IsEmpty())
+            {
+                Scheduler::Event next = partition->events->RemoveNext();
+                scheduler->Insert(next);
+            }
+        }
+        partition->events = scheduler;
+    }
+}
+
+// System ID for non-distributed simulation is always zero
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId() const
+{
+    return 0;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartition(uint32_t context) const
+{
+    return context == Simulator::NO_CONTEXT ? m_threadCount : context % m_threadCount;
+}
+
+EventId
+MultithreadedSimulatorImpl::Insert(Partition& partition,
+                                   uint64_t ts,
+                                   uint32_t context,
+                                   EventImpl* event)
+{
+    Scheduler::Event ev;
+    ev.impl = event;
+    ev.key.m_ts = ts;
+    ev.key.m_context = context;
+    ev.key.m_uid = partition.uid;
+    partition.uid++;
+    partition.events->Insert(ev);
+    return EventId(event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent(Partition& partition)
+{
+    Scheduler::Event next = partition.events->RemoveNext();
+
+    PreEventHook(EventId(next.impl, next.key.m_ts, next.key.m_context, next.key.m_uid));
+
+    NS_ASSERT(next.key.m_ts >= partition.currentTs);
+    partition.eventCount++;
+
+    partition.currentTs = next.key.m_ts;
+    partition.currentContext = next.key.m_context;
+    partition.currentUid = next.key.m_uid;
+#ifdef NS3_EVENT_PROFILER_ENABLE
+    EventProfiler::Get()->Invoke(next.impl, next.key.m_context);
+#else
+    next.impl->Invoke();
+#endif
+    next.impl->Unref();
+}
+
+void
+MultithreadedSimulatorImpl::DrainInbox(uint32_t index)
+{
+    Partition& partition = *m_partitions[index];
+    std::vector<CrossEvent>& inbox = partition.inbox;
+    for (uint32_t source = 0; source < m_threadCount; source++)
+    {
+        std::vector<CrossEvent>& outbox = m_partitions[source]->outboxes[index];
+        inbox.insert(inbox.end(), outbox.begin(), outbox.end());
+        outbox.clear();
+    }
+    // The events of a context all come from the same outbox, in the order
+    // they were scheduled. Sorting on the source context gives an order, and
+    // thus event uids, independent of the partitioning.
+    std::stable_sort(inbox.begin(), inbox.end(), [](const CrossEvent& a, const CrossEvent& b) {
+        return a.source < b.source;
+    });
+    for (const auto& ev : inbox)
+    {
+        Insert(partition, ev.timestamp, ev.context, ev.event);
+    }
+    inbox.clear();
+}
+
+void
+MultithreadedSimulatorImpl::WindowCompletion::operator()() noexcept
+{
+    impl->NextWindow();
+}
+
+void
+MultithreadedSimulatorImpl::NextWindow()
+{
+    DrainInbox(m_threadCount);
+    Partition& global = *m_partitions[m_threadCount];
+    const uint64_t none = std::numeric_limits<uint64_t>::max();
+
+    while (!m_stop)
+    {
+        uint64_t next = none;
+        for (uint32_t i = 0; i < m_threadCount; i++)
+        {
+            if (!m_partitions[i]->events->IsEmpty())
+            {
+                next = std::min(next, m_partitions[i]->events->PeekNext().key.m_ts);
+            }
+        }
+        uint64_t nextGlobal =
+            global.events->IsEmpty() ? none : global.events->PeekNext().key.m_ts;
+
+        if (next == none && nextGlobal == none)
+        {
+            break;
+        }
+        if (nextGlobal <= next)
+        {
+            // the global events run alone, before the events of the
+            // partitions with the same timestamp
+            t_partition = &global;
+            while (!m_stop && !global.events->IsEmpty() &&
+                   global.events->PeekNext().key.m_ts == nextGlobal)
+            {
+                ProcessOneEvent(global);
+            }
+            t_partition = nullptr;
+            continue;
+        }
+
+        uint64_t lookahead = m_lookahead.GetTimeStep();
+        m_windowStartTs = next;
+        m_windowEndTs = (next > none - lookahead) ? none : next + lookahead;
+        m_windowEndTs = std::min(m_windowEndTs, nextGlobal);
+        m_windowEventCount = CountEvents();
+        return;
+    }
+    m_done = true;
+}
+
+void
+MultithreadedSimulatorImpl::RunPartition(uint32_t index)
+{
+    Partition& partition = *m_partitions[index];
+    while (true)
+    {
+        DrainInbox(index);
+        m_windowStart->arrive_and_wait();
+        if (m_done)
+        {
+            break;
+        }
+
+        t_partition = &partition;
+        while (!partition.events->IsEmpty() &&
+               partition.events->PeekNext().key.m_ts < m_windowEndTs)
+        {
+            ProcessOneEvent(partition);
+        }
+        t_partition = nullptr;
+
+        m_windowEnd->arrive_and_wait();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Run()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ABORT_MSG_UNLESS(m_lookahead.IsStrictlyPositive(),
+                        "MultithreadedSimulatorImpl: the Lookahead attribute must be set");
+    NS_ASSERT_MSG(t_partition == nullptr, "MultithreadedSimulatorImpl::Run() from an event");
+
+    m_stop = false;
+    m_done = false;
+    m_windowStart =
+        std::make_unique<std::barrier<WindowCompletion>>(m_threadCount, WindowCompletion{this});
+    m_windowEnd = std::make_unique<std::barrier<>>(m_threadCount);
+
+    std::vector<std::thread> threads;
+    for (uint32_t i = 1; i < m_threadCount; i++)
+    {
+        threads.emplace_back(&MultithreadedSimulatorImpl::RunPartition, this, i);
+    }
+    RunPartition(0);
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    m_windowStart.reset();
+    m_windowEnd.reset();
+
+    for (auto& partition : m_partitions)
+    {
+        m_currentTs = std::max(m_currentTs, partition->currentTs);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Stop()
+{
+    NS_LOG_FUNCTION(this);
+    m_stop = true;
+}
+
+EventId
+MultithreadedSimulatorImpl::Stop(const Time& delay)
+{
+    NS_LOG_FUNCTION(this << delay.GetTimeStep());
+    return Simulator::Schedule(delay, &Simulator::Stop);
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished() const
+{
+    if (m_stop)
+    {
+        return true;
+    }
+    for (const auto& partition : m_partitions)
+    {
+        if (!partition->events->IsEmpty())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//
+// Schedule an event for a _relative_ time in the future.
+//
+EventId
+MultithreadedSimulatorImpl::Schedule(const Time& delay, EventImpl* event)
+{
+    NS_LOG_FUNCTION(this << delay.GetTimeStep() << event);
+    NS_ASSERT_MSG(delay.IsPositive(), "MultithreadedSimulatorImpl::Schedule(): Negative delay");
+
+    Partition* current = t_partition;
+    if (current == nullptr)
+    {
+        // outside of Run(): the events without context are global
+        return Insert(*m_partitions[m_threadCount],
+                      m_currentTs + delay.GetTimeStep(),
+                      Simulator::NO_CONTEXT,
+                      event);
+    }
+    return Insert(*current,
+                  current->currentTs + delay.GetTimeStep(),
+                  current->currentContext,
+                  event);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext(uint32_t context,
+                                                const Time& delay,
+                                                EventImpl* event)
+{
+    NS_LOG_FUNCTION(this << context << delay.GetTimeStep() << event);
+
+    Partition* current = t_partition;
+    if (current == nullptr || current == m_partitions[m_threadCount].get())
+    {
+        // the other partitions are waiting, insert the event directly
+        uint64_t now = current == nullptr ? m_currentTs : current->currentTs;
+        Insert(*m_partitions[GetPartition(context)], now + delay.GetTimeStep(), context, event);
+    }
+    else if (context == current->currentContext)
+    {
+        Insert(*current, current->currentTs + delay.GetTimeStep(), context, event);
+    }
+    else
+    {
+        NS_ABORT_MSG_IF(delay < m_lookahead,
+                        "MultithreadedSimulatorImpl: event for context "
+                            << context << " scheduled by context " << current->currentContext
+                            << " with a delay of " << delay.As(Time::NS)
+                            << ", below the lookahead of " << m_lookahead.As(Time::NS));
+        CrossEvent ev;
+        ev.context = context;
+        ev.source = current->currentContext;
+        ev.timestamp = current->currentTs + delay.GetTimeStep();
+        ev.event = event;
+        current->outboxes[GetPartition(context)].push_back(ev);
+    }
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow(EventImpl* event)
+{
+    return Schedule(Time(0), event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy(EventImpl* event)
+{
+    EventId id(Ptr<EventImpl>(event, false), Now().GetTimeStep(), 0xffffffff, 2);
+    std::unique_lock lock{m_destroyEventsMutex};
+    m_destroyEvents.push_back(id);
+    return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now() const
+{
+    // Do not add function logging here, to avoid stack overflow
+    Partition* current = t_partition;
+    return TimeStep(current == nullptr ? m_currentTs : current->currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft(const EventId& id) const
+{
+    if (IsExpired(id))
+    {
+        return TimeStep(0);
+    }
+    else
+    {
+        return TimeStep(id.GetTs() - Now().GetTimeStep());
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove(const EventId& id)
+{
+    if (id.GetUid() == EventId::UID::DESTROY)
+    {
+        // destroy events.
+        std::unique_lock lock{m_destroyEventsMutex};
+        for (auto i = m_destroyEvents.begin(); i != m_destroyEvents.end(); i++)
+        {
+            if (*i == id)
+            {
+                m_destroyEvents.erase(i);
+                break;
+            }
+        }
+        return;
+    }
+    if (IsExpired(id))
+    {
+        return;
+    }
+    Partition& partition = *m_partitions[GetPartition(id.GetContext())];
+    NS_ASSERT_MSG(t_partition == nullptr || t_partition == &partition ||
+                      t_partition == m_partitions[m_threadCount].get(),
+                  "MultithreadedSimulatorImpl::Remove(): event of another partition");
+    Scheduler::Event event;
+    event.impl = id.PeekEventImpl();
+    event.key.m_ts = id.GetTs();
+    event.key.m_context = id.GetContext();
+    event.key.m_uid = id.GetUid();
+    partition.events->Remove(event);
+    event.impl->Cancel();
+    // whenever we remove an event from the event list, we have to unref it.
+    event.impl->Unref();
+}
+
+void
+MultithreadedSimulatorImpl::Cancel(const EventId& id)
+{
+    if (!IsExpired(id))
+    {
+        id.PeekEventImpl()->Cancel();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired(const EventId& id) const
+{
+    if (id.GetUid() == EventId::UID::DESTROY)
+    {
+        if (id.PeekEventImpl() == nullptr || id.PeekEventImpl()->IsCancelled())
+        {
+            return true;
+        }
+        // destroy events.
+        std::unique_lock lock{m_destroyEventsMutex};
+        for (auto i = m_destroyEvents.begin(); i != m_destroyEvents.end(); i++)
+        {
+            if (*i == id)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    if (id.PeekEventImpl() == nullptr)
+    {
+        return true;
+    }
+    Partition* current = t_partition;
+    if (current != nullptr && current != m_partitions[m_threadCount].get() &&
+        id.GetContext() != current->currentContext && id.GetContext() != Simulator::NO_CONTEXT)
+    {
+        // another context may be run by another thread: only the events
+        // before the window are known to have run, whatever the number of
+        // threads
+        return id.GetTs() < m_windowStartTs || id.PeekEventImpl()->IsCancelled();
+    }
+    const Partition& partition = *m_partitions[GetPartition(id.GetContext())];
+    return id.GetTs() < partition.currentTs ||
+           (id.GetTs() == partition.currentTs && id.GetUid() <= partition.currentUid) ||
+           id.PeekEventImpl()->IsCancelled();
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime() const
+{
+    return TimeStep(0x7fffffffffffffffLL);
+}
+
+uint64_t
+MultithreadedSimulatorImpl::AllocateUid()
+{
+    Partition* current = t_partition;
+    if (current == nullptr)
+    {
+        return 0;
+    }
+    return static_cast<uint64_t>(current->index + 1) << 32 | current->objectUid++;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext() const
+{
+    Partition* current = t_partition;
+    return current == nullptr ? Simulator::NO_CONTEXT : current->currentContext;
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetEventCount() const
+{
+    Partition* current = t_partition;
+    if (current != nullptr && current != m_partitions[m_threadCount].get())
+    {
+        // the other partitions are running
+        return m_windowEventCount;
+    }
+    return CountEvents();
+}
+
+uint64_t
+MultithreadedSimulatorImpl::CountEvents() const
+{
+    uint64_t count = 0;
+    for (const auto& partition : m_partitions)
+    {
+        count += partition->eventCount;
+    }
+    return count;
+}
+
+} // namespace ns3
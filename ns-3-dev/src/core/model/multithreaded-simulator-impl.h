@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2005,2006 INRIA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MULTITHREADED_SIMULATOR_IMPL_H
+#define MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "nstime.h"
+#include "simulator-impl.h"
+
+#include <atomic>
+#include <barrier>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::MultithreadedSimulatorImpl declaration.
+ */
+
+namespace ns3
+{
+
+// Forward
+class Scheduler;
+
+/**
+ * \ingroup simulator
+ *
+ * A shared memory parallel simulator implementation.
+ *
+ * The execution contexts (the node ids) are spread over ThreadCount
+ * partitions, context \c c going to partition <tt>c % ThreadCount</tt>.
+ * Every partition has its own event scheduler and is run by its own
+ * thread, the thread calling Run() taking the first partition.
+ *
+ * The partitions are synchronized with conservative time windows: if
+ * \c T is the earliest event timestamp of all the partitions, every
+ * partition runs its events up to <tt>T + Lookahead</tt> (excluded), and
+ * then waits for the others. For this to be correct, an event scheduled
+ * for another context must not be scheduled less than Lookahead in the
+ * future; the simulation aborts otherwise. The Lookahead is typically the
+ * smallest propagation delay between two nodes, see
+ * SpectrumChannel::GetMinPropagationDelay().
+ *
+ * The events scheduled for another context are appended, without any lock,
+ * to an outbox of the sending partition, one for each destination
+ * partition. At the end of the window every partition drains the outboxes
+ * destined to it in the order of the sending contexts, so that the order of
+ * the events, and thus the results, do not depend on the number of threads.
+ * They may differ from the results of DefaultSimulatorImpl, which orders
+ * simultaneous events of different contexts by scheduling order.
+ *
+ * The events without context (Simulator::NO_CONTEXT), such as the events
+ * scheduled with Simulator::Schedule() before Run() is called, run alone:
+ * the windows end at their timestamp, and they are run by a single thread
+ * while the partitions wait. They can safely access every node. Stop() is
+ * an event without context when it is scheduled before Run(), so it stops
+ * the simulation at the exact time. When Simulator::Stop() is called from
+ * a partition, the simulation stops at the end of the current window.
+ *
+ * While the partitions run, an event only sees the state of the other
+ * contexts at the start of the current window: IsExpired() is only true
+ * for their events with a timestamp before the window, and GetEventCount()
+ * returns the number of events run before the window. The events without
+ * context, run between the windows, are seen exactly.
+ *
+ * The models run by the partitions must not share mutable state across
+ * nodes, other than through events. The reference counts of the objects
+ * and of the packets shared by the nodes are only thread-safe if ns-3 is
+ * built with NS3_MULTITHREADED (--enable-multithreaded), and a ThreadCount
+ * above 1 aborts otherwise. Models with hidden shared state, such as the
+ * propagation loss models drawing random variables or the mobility models
+ * updating their position when it is read, cannot be used across
+ * partitions. The random variables must be created before Run(), or by
+ * events without context: the stream of a variable created without an
+ * explicit one depends on the order in which the threads create them.
+ *
+ * In such a build, the packets created by the events of a partition take
+ * their uid from the range of the partition, see AllocateUid(). The uids
+ * then depend on ThreadCount, but not on the interleaving of the threads.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+  public:
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /** Constructor. */
+    MultithreadedSimulatorImpl();
+    /** Destructor. */
+    ~MultithreadedSimulatorImpl() override;
+
+    // Inherited
+    void Destroy() override;
+    bool IsFinished() const override;
+    void Stop() override;
+    EventId Stop(const Time& delay) override;
+    EventId Schedule(const Time& delay, EventImpl* event) override;
+    void ScheduleWithContext(uint32_t context, const Time& delay, EventImpl* event) override;
+    EventId ScheduleNow(EventImpl* event) override;
+    EventId ScheduleDestroy(EventImpl* event) override;
+    void Remove(const EventId& id) override;
+    void Cancel(const EventId& id) override;
+    bool IsExpired(const EventId& id) const override;
+    void Run() override;
+    Time Now() const override;
+    Time GetDelayLeft(const EventId& id) const override;
+    Time GetMaximumSimulationTime() const override;
+    void SetScheduler(ObjectFactory schedulerFactory) override;
+    uint32_t GetSystemId() const override;
+    uint32_t GetContext() const override;
+    uint64_t GetEventCount() const override;
+
+    /**
+     * Get a unique id for an object created by the current event, such as a
+     * Packet. Each partition hands out the ids of its own range, partition
+     * \c i setting <tt>i + 1</tt> in the upper 32 bits, so that the ids do
+     * not depend on the order in which the threads create objects.
+     * \return The id, or 0 when not called from an event of a
+     *         MultithreadedSimulatorImpl.
+     */
+    static uint64_t AllocateUid();
+
+  private:
+    void DoDispose() override;
+
+    /** An event scheduled for another context, waiting for the end of the window. */
+    struct CrossEvent
+    {
+        /** The event context. */
+        uint32_t context;
+        /** The context which scheduled the event. */
+        uint32_t source;
+        /** Event timestamp. */
+        uint64_t timestamp;
+        /** The event implementation. */
+        EventImpl* event;
+    };
+
+    /** The events of a set of contexts, and the state of the thread running them. */
+    struct Partition
+    {
+        /** The index of the partition. */
+        uint32_t index;
+        /** The event priority queue. */
+        Ptr<Scheduler> events;
+        /** Next event unique id. */
+        uint32_t uid;
+        /** Unique id of the current event. */
+        uint32_t currentUid;
+        /** Timestamp of the current event. */
+        uint64_t currentTs;
+        /** Execution context of the current event. */
+        uint32_t currentContext;
+        /** The event count. */
+        uint64_t eventCount;
+        /** Next id returned by AllocateUid(). */
+        uint32_t objectUid;
+        /** The events for the other contexts, by destination partition. */
+        std::vector<std::vector<CrossEvent>> outboxes;
+        /** The events received at the end of the window, reused between windows. */
+        std::vector<CrossEvent> inbox;
+    };
+
+    /** Compute the next window; run by one thread while the others wait. */
+    struct WindowCompletion
+    {
+        /** The simulator. */
+        MultithreadedSimulatorImpl* impl;
+
+        /** Compute the next window. */
+        void operator()() noexcept;
+    };
+
+    /** Create the partitions, once ThreadCount is known. */
+    void CreatePartitions();
+    /**
+     * Get the partition of a context.
+     * \param [in] context The context.
+     * \return The index of the partition.
+     */
+    uint32_t GetPartition(uint32_t context) const;
+    /**
+     * Count the events run by all the partitions, while they are waiting.
+     * \return The event count.
+     */
+    uint64_t CountEvents() const;
+    /**
+     * Insert an event in a partition.
+     * \param [in] partition The partition.
+     * \param [in] ts The event timestamp.
+     * \param [in] context The event context.
+     * \param [in] event The event implementation.
+     * \return The id of the event.
+     */
+    EventId Insert(Partition& partition, uint64_t ts, uint32_t context, EventImpl* event);
+    /**
+     * Process the next event of a partition.
+     * \param [in] partition The partition.
+     */
+    void ProcessOneEvent(Partition& partition);
+    /**
+     * Insert the events sent to a partition by the others during the last window.
+     * \param [in] index The index of the partition.
+     */
+    void DrainInbox(uint32_t index);
+    /**
+     * Run the global events due, and compute the end of the next window,
+     * or stop the simulation.
+     */
+    void NextWindow();
+    /**
+     * Run the windows of a partition until the end of the simulation.
+     * \param [in] index The index of the partition.
+     */
+    void RunPartition(uint32_t index);
+
+    /**
+     * The partitions, the last one holding the global events, without context.
+     */
+    std::vector<std::unique_ptr<Partition>> m_partitions;
+    /** The partition of the events run by this thread, if any. */
+    static thread_local Partition* t_partition;
+
+    /** The scheduler factory, to create the schedulers of the partitions. */
+    ObjectFactory m_schedulerFactory;
+    /** Number of partitions and threads. */
+    uint32_t m_threadCount;
+    /** The minimum delay of the events scheduled for another context. */
+    Time m_lookahead;
+
+    /** Barrier at the start of each window. */
+    std::unique_ptr<std::barrier<WindowCompletion>> m_windowStart;
+    /** Barrier at the end of each window. */
+    std::unique_ptr<std::barrier<>> m_windowEnd;
+    /** Start of the current window: the events before it have all run. */
+    uint64_t m_windowStartTs;
+    /** End of the current window (excluded). */
+    uint64_t m_windowEndTs;
+    /** The event count at the start of the current window. */
+    uint64_t m_windowEventCount;
+    /** Flag set when the threads should leave Run(). */
+    bool m_done;
+    /** Flag calling for the end of the simulation. */
+    std::atomic<bool> m_stop;
+    /** Timestamp of the last event run, between the runs. */
+    uint64_t m_currentTs;
+
+    /** Container type for the events to run at Simulator::Destroy() */
+    typedef std::list<EventId> DestroyEvents;
+    /** The container of events to run at Destroy. */
+    DestroyEvents m_destroyEvents;
+    /** Mutex to control access to the list of events to run at Destroy. */
+    mutable std::mutex m_destroyEventsMutex;
+};
+
+} // namespace ns3
+
+#endif /* MULTITHREADED_SIMULATOR_IMPL_H */
@@ -21,6 +21,7 @@
 #include "boolean.h"
 #include "enum.h"
 #include "event-impl.h"
+#include "event-profiler.h"
 #include "fatal-error.h"
 #include "log.h"
 #include "pointer.h"
@@ -390,7 +391,11 @@ RealtimeSimulatorImpl::ProcessOneEvent()
 
     EventImpl* event = next.impl;
     m_synchronizer->EventStart();
+#ifdef NS3_EVENT_PROFILER_ENABLE
+    EventProfiler::Get()->Invoke(event, next.key.m_context);
+#else
     event->Invoke();
+#endif
     m_synchronizer->EventEnd();
     event->Unref();
 }
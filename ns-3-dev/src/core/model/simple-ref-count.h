@@ -27,6 +27,10 @@
 #include <limits>
 #include <stdint.h>
 
+#ifdef NS3_MULTITHREADED_ENABLE
+#include <atomic>
+#endif
+
 /**
  * \file
  * \ingroup ptr
@@ -125,8 +129,7 @@ class SimpleRefCount : public PARENT
      */
     inline void Unref() const
     {
-        m_count--;
-        if (m_count == 0)
+        if (--m_count == 0)
         {
             DELETER::Delete(static_cast<T*>(const_cast<SimpleRefCount*>(this)));
         }
@@ -149,9 +152,15 @@ class SimpleRefCount : public PARENT
      *
      * \internal
      * Note we make this mutable so that the const methods can still
-     * change it.
+     * change it. It is atomic when ns-3 is built for
+     * MultithreadedSimulatorImpl, since the objects shared by the nodes
+     * are then referenced from several threads.
      */
+#ifdef NS3_MULTITHREADED_ENABLE
+    mutable std::atomic<uint32_t> m_count;
+#else
     mutable uint32_t m_count;
+#endif
 };
 
 } // namespace ns3
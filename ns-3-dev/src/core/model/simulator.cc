@@ -21,6 +21,7 @@
 #include "assert.h"
 #include "des-metrics.h"
 #include "event-impl.h"
+#include "event-profiler.h"
 #include "global-value.h"
 #include "log.h"
 #include "map-scheduler.h"
@@ -158,6 +159,10 @@ Simulator::Destroy()
     (*pimpl)->Destroy();
     (*pimpl)->Unref();
     *pimpl = nullptr;
+
+#ifdef NS3_EVENT_PROFILER_ENABLE
+    EventProfiler::Get()->Write();
+#endif
 }
 
 void
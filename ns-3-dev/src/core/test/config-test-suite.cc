@@ -864,6 +864,144 @@ SearchAttributesOfParentObjectsTestCase::DoRun()
     NS_TEST_ASSERT_MSG_EQ(iv.Get(), 42, "Object Attribute \"X\" not settable in derived class");
 }
 
+/**
+ * \ingroup config-tests
+ * Test for the ability to set and trace connect through compiled paths.
+ */
+class CompiledPathConfigTestCase : public TestCase
+{
+  public:
+    /** Constructor. */
+    CompiledPathConfigTestCase();
+
+    /** Destructor. */
+    ~CompiledPathConfigTestCase() override
+    {
+    }
+
+    /**
+     * Trace callback without context.
+     * \param oldValue The old value.
+     * \param newValue The new value.
+     */
+    void Trace(int16_t oldValue [[maybe_unused]], int16_t newValue)
+    {
+        m_newValue = newValue;
+        m_traces++;
+    }
+
+    /**
+     * Trace callback with context path.
+     * \param path The context path.
+     * \param old The old value.
+     * \param newValue The new value.
+     */
+    void TraceWithPath(std::string path, int16_t old [[maybe_unused]], int16_t newValue)
+    {
+        m_newValue = newValue;
+        m_path = path;
+    }
+
+  private:
+    void DoRun() override;
+
+    int16_t m_newValue; //!< Flag to detect tracing result.
+    uint32_t m_traces;  //!< Number of traces without context.
+    std::string m_path; //!< The context path.
+};
+
+CompiledPathConfigTestCase::CompiledPathConfigTestCase()
+    : TestCase("Check ability to set and trace connect through compiled paths")
+{
+}
+
+void
+CompiledPathConfigTestCase::DoRun()
+{
+    IntegerValue iv;
+
+    //
+    // Create a root namespace object, with four objects two levels down.
+    //
+    Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject>();
+    Config::RegisterRootNamespaceObject(root);
+    Ptr<ConfigTestObject> a = CreateObject<ConfigTestObject>();
+    root->SetNodeA(a);
+    Ptr<ConfigTestObject> b = CreateObject<ConfigTestObject>();
+    a->SetNodeB(b);
+    std::vector<Ptr<ConfigTestObject>> objs;
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        objs.push_back(CreateObject<ConfigTestObject>());
+        b->AddNodeB(objs.back());
+    }
+
+    //
+    // The index expressions are parsed once, and match as with Config::Set.
+    //
+    Config::CompiledPath set("/NodeA/NodeB/NodesB/[0-1]|3/A");
+    NS_TEST_ASSERT_MSG_EQ(set.GetPath(), "/NodeA/NodeB/NodesB/[0-1]|3/A", "Wrong path");
+    set.Set(IntegerValue(-11));
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        int64_t expected = (i == 2) ? 10 : -11;
+        objs[i]->GetAttribute("A", iv);
+        NS_TEST_ASSERT_MSG_EQ(iv.Get(), expected, "Object Attribute \"A\" not set");
+    }
+
+    //
+    // A cached path does not see the new objects until its cache is cleared.
+    //
+    Config::CompiledPath cached("/NodeA/NodeB/NodesB/*/B", true);
+    cached.Set(IntegerValue(-12));
+    objs.push_back(CreateObject<ConfigTestObject>());
+    b->AddNodeB(objs.back());
+    cached.Set(IntegerValue(-13));
+    objs[0]->GetAttribute("B", iv);
+    NS_TEST_ASSERT_MSG_EQ(iv.Get(), -13, "Object Attribute \"B\" not set");
+    objs[4]->GetAttribute("B", iv);
+    NS_TEST_ASSERT_MSG_EQ(iv.Get(), 9, "Object Attribute \"B\" unexpectedly set");
+    cached.ClearCache();
+    cached.Set(IntegerValue(-14));
+    objs[4]->GetAttribute("B", iv);
+    NS_TEST_ASSERT_MSG_EQ(iv.Get(), -14, "Object Attribute \"B\" not set");
+
+    //
+    // The context path of a compiled path is the one of Config::Connect.
+    //
+    Config::CompiledPath("/NodeA/NodeB/NodesB/3/Source")
+        .Connect(MakeCallback(&CompiledPathConfigTestCase::TraceWithPath, this));
+    m_newValue = 0;
+    m_path = "";
+    objs[3]->SetAttribute("Source", IntegerValue(-4));
+    NS_TEST_ASSERT_MSG_EQ(m_newValue, -4, "Trace 3 did not fire as expected");
+    NS_TEST_ASSERT_MSG_EQ(m_path,
+                          "/NodeA/NodeB/NodesB/3/Source",
+                          "Trace 3 did not provide expected context");
+
+    //
+    // A relative path is resolved from each object of a container.
+    //
+    Ptr<ConfigTestObject> other = CreateObject<ConfigTestObject>();
+    Ptr<ConfigTestObject> otherB = CreateObject<ConfigTestObject>();
+    other->SetNodeB(otherB);
+    Config::MatchContainer roots({a, other}, {"", ""}, "");
+    m_traces = 0;
+    Config::CompiledPath("NodeB/Source")
+        .ConnectWithoutContext(roots, MakeCallback(&CompiledPathConfigTestCase::Trace, this));
+    b->SetAttribute("Source", IntegerValue(-5));
+    otherB->SetAttribute("Source", IntegerValue(-6));
+    NS_TEST_ASSERT_MSG_EQ(m_traces, 2, "Traces did not fire as expected");
+    NS_TEST_ASSERT_MSG_EQ(m_newValue, -6, "Trace did not fire as expected");
+    bool ok = Config::CompiledPath("NodeA/Source")
+                  .ConnectWithoutContextFailSafe(roots,
+                                                 MakeCallback(&CompiledPathConfigTestCase::Trace,
+                                                              this));
+    NS_TEST_ASSERT_MSG_EQ(ok, false, "Trace connected through a null pointer");
+
+    Config::UnregisterRootNamespaceObject(root);
+}
+
 /**
  * \ingroup config-tests
  * The Test Suite that glues all of the Test Cases together.
@@ -882,6 +1020,7 @@ ConfigTestSuite::ConfigTestSuite()
     AddTestCase(new UnderRootNamespaceConfigTestCase);
     AddTestCase(new ObjectVectorConfigTestCase);
     AddTestCase(new SearchAttributesOfParentObjectsTestCase);
+    AddTestCase(new CompiledPathConfigTestCase);
 }
 
 /**
@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2005,2006 INRIA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+#include <set>
+#include <utility>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \file
+ * \ingroup simulator-tests
+ * MultithreadedSimulatorImpl test suite
+ */
+
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Check the event times, the contexts and the event order of
+ * MultithreadedSimulatorImpl for several numbers of threads.
+ *
+ * Every context starts a tree of events: each event is recorded by its
+ * context, schedules a local event at the same time and forwards the tree to
+ * the next two contexts after the lookahead, so that the contexts receive
+ * events from several sources at the same timestamp. A global event checks
+ * the time in the middle of the run, and Stop() ends it. The event traces
+ * of all the contexts, and the event counts they see, must not depend on
+ * the number of threads. The ids of AllocateUid() must be unique, and the
+ * same in two runs with the same number of threads.
+ *
+ * The events only record what they see, the checks are made by the main
+ * thread once the run is over. Without NS3_MULTITHREADED, only one thread
+ * is allowed.
+ */
+class MultithreadedSimulatorTestCase : public TestCase
+{
+  public:
+    MultithreadedSimulatorTestCase();
+    void DoRun() override;
+
+  private:
+    /** Event trace of a context: timestamp and tag of every event. */
+    typedef std::vector<std::pair<int64_t, uint32_t>> Trace;
+    /** Values recorded by the Hop events of a context. */
+    typedef std::vector<uint64_t> Values;
+
+    /**
+     * Run the scenario.
+     * \param threads The number of threads.
+     * \return The number of events run.
+     */
+    uint64_t RunScenario(uint32_t threads);
+    /**
+     * Event forwarding the tree.
+     * \param context The expected context.
+     * \param source The context which started the tree.
+     * \param depth The remaining depth of the tree.
+     */
+    void Hop(uint32_t context, uint32_t source, uint32_t depth);
+    /**
+     * Event scheduled locally by Hop.
+     * \param context The expected context.
+     * \param tag The tag to record.
+     */
+    void Local(uint32_t context, uint32_t tag);
+    /** Global event, run without context. */
+    void Global();
+
+    static constexpr uint32_t CONTEXTS = 7; //!< Number of contexts.
+    static constexpr uint32_t DEPTH = 8;    //!< Depth of the event trees.
+
+    std::vector<Trace> m_traces;     //!< The event traces, by context.
+    std::vector<Values> m_counts;    //!< The event counts seen by the Hop events, by context.
+    std::vector<Values> m_uids;      //!< The ids allocated by the Hop events, by context.
+    std::vector<uint32_t> m_errors;  //!< The context and time errors, by context.
+    std::vector<int64_t> m_globals;  //!< The times of the global events.
+    std::vector<uint32_t> m_globalContexts; //!< The contexts of the global events.
+};
+
+MultithreadedSimulatorTestCase::MultithreadedSimulatorTestCase()
+    : TestCase("Check that the events do not depend on the number of threads")
+{
+}
+
+void
+MultithreadedSimulatorTestCase::Hop(uint32_t context, uint32_t source, uint32_t depth)
+{
+    if (Simulator::GetContext() != context)
+    {
+        m_errors[context]++;
+    }
+    m_traces[context].emplace_back(Simulator::Now().GetTimeStep(), source * 100 + depth);
+    m_counts[context].push_back(Simulator::GetEventCount());
+    m_uids[context].push_back(MultithreadedSimulatorImpl::AllocateUid());
+    Simulator::ScheduleNow(&MultithreadedSimulatorTestCase::Local, this, context, depth);
+    if (depth > 0)
+    {
+        for (uint32_t i = 1; i <= 2; i++)
+        {
+            uint32_t next = (context + i) % CONTEXTS;
+            Simulator::ScheduleWithContext(next,
+                                           MilliSeconds(1),
+                                           &MultithreadedSimulatorTestCase::Hop,
+                                           this,
+                                           next,
+                                           source,
+                                           depth - 1);
+        }
+    }
+}
+
+void
+MultithreadedSimulatorTestCase::Local(uint32_t context, uint32_t tag)
+{
+    if (Simulator::GetContext() != context)
+    {
+        m_errors[context]++;
+    }
+    m_traces[context].emplace_back(Simulator::Now().GetTimeStep(), 1000000 + tag);
+}
+
+void
+MultithreadedSimulatorTestCase::Global()
+{
+    m_globalContexts.push_back(Simulator::GetContext());
+    m_globals.push_back(Simulator::Now().GetTimeStep());
+    // a global event may schedule events for any context
+    Simulator::ScheduleWithContext(3,
+                                   Seconds(0),
+                                   &MultithreadedSimulatorTestCase::Local,
+                                   this,
+                                   3,
+                                   7);
+}
+
+uint64_t
+MultithreadedSimulatorTestCase::RunScenario(uint32_t threads)
+{
+    m_traces.assign(CONTEXTS, Trace());
+    m_counts.assign(CONTEXTS, Values());
+    m_uids.assign(CONTEXTS, Values());
+    m_errors.assign(CONTEXTS, 0);
+    m_globals.clear();
+    m_globalContexts.clear();
+
+    Simulator::Destroy();
+    ObjectFactory factory("ns3::MultithreadedSimulatorImpl");
+    factory.Set("ThreadCount", UintegerValue(threads));
+    factory.Set("Lookahead", TimeValue(MilliSeconds(1)));
+    Simulator::SetImplementation(factory.Create<SimulatorImpl>());
+
+    for (uint32_t context = 0; context < CONTEXTS; context++)
+    {
+        Simulator::ScheduleWithContext(context,
+                                       MicroSeconds(context % 2),
+                                       &MultithreadedSimulatorTestCase::Hop,
+                                       this,
+                                       context,
+                                       context,
+                                       DEPTH);
+    }
+    Simulator::Schedule(MicroSeconds(3500), &MultithreadedSimulatorTestCase::Global, this);
+    Simulator::Stop(MilliSeconds(6));
+    Simulator::Run();
+
+    NS_TEST_EXPECT_MSG_EQ(Simulator::Now(), MilliSeconds(6), "wrong stop time");
+    uint64_t events = Simulator::GetEventCount();
+    Simulator::Destroy();
+
+    for (uint32_t context = 0; context < CONTEXTS; context++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(m_errors[context], 0U, "events run with a wrong context");
+        for (const auto& event : m_traces[context])
+        {
+            NS_TEST_EXPECT_MSG_LT(event.first,
+                                  MilliSeconds(6).GetTimeStep(),
+                                  "event run after the stop time");
+        }
+    }
+    NS_TEST_EXPECT_MSG_EQ(m_globals.size(), 1U, "global event not run once");
+    NS_TEST_EXPECT_MSG_EQ(m_globals[0], MicroSeconds(3500).GetTimeStep(), "wrong global time");
+    for (uint32_t context : m_globalContexts)
+    {
+        NS_TEST_EXPECT_MSG_EQ(context, Simulator::NO_CONTEXT, "global event run with a context");
+    }
+
+    std::set<uint64_t> uids;
+    std::size_t hops = 0;
+    for (const auto& values : m_uids)
+    {
+        uids.insert(values.begin(), values.end());
+        hops += values.size();
+    }
+    NS_TEST_EXPECT_MSG_EQ(uids.size(), hops, "ids allocated twice");
+    NS_TEST_EXPECT_MSG_EQ(uids.count(0), 0, "id allocated outside of the partitions");
+    return events;
+}
+
+void
+MultithreadedSimulatorTestCase::DoRun()
+{
+    uint64_t events = RunScenario(1);
+    std::vector<Trace> reference = m_traces;
+    std::vector<Values> referenceCounts = m_counts;
+    // every context runs its tree and receives the trees of two others
+    NS_TEST_EXPECT_MSG_GT(reference[0].size(), 2 * DEPTH, "too few events");
+
+#ifdef NS3_MULTITHREADED_ENABLE
+    std::vector<uint32_t> threadCounts = {1, 2, 3, 4, 8};
+#else
+    std::vector<uint32_t> threadCounts = {1};
+#endif
+    for (uint32_t threads : threadCounts)
+    {
+        NS_TEST_EXPECT_MSG_EQ(RunScenario(threads), events, "wrong event count");
+        std::vector<Values> uids = m_uids;
+        for (uint32_t context = 0; context < CONTEXTS; context++)
+        {
+            NS_TEST_EXPECT_MSG_EQ((m_traces[context] == reference[context]),
+                                  true,
+                                  "different events for context " << context << " with "
+                                                                  << threads << " threads");
+            NS_TEST_EXPECT_MSG_EQ((m_counts[context] == referenceCounts[context]),
+                                  true,
+                                  "different event counts for context " << context << " with "
+                                                                        << threads << " threads");
+        }
+
+        RunScenario(threads);
+        for (uint32_t context = 0; context < CONTEXTS; context++)
+        {
+            NS_TEST_EXPECT_MSG_EQ((m_uids[context] == uids[context]),
+                                  true,
+                                  "different ids for context " << context << " in two runs with "
+                                                               << threads << " threads");
+        }
+    }
+}
+
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief The MultithreadedSimulatorImpl test suite.
+ */
+class MultithreadedSimulatorTestSuite : public TestSuite
+{
+  public:
+    MultithreadedSimulatorTestSuite()
+        : TestSuite("multithreaded-simulator")
+    {
+        AddTestCase(new MultithreadedSimulatorTestCase(), TestCase::QUICK);
+    }
+};
+
+static MultithreadedSimulatorTestSuite
+    g_multithreadedSimulatorTestSuite; //!< Static variable for test initialization
@@ -17,12 +17,21 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "ns3/calendar-scheduler.h"
+#include "ns3/event-profiler.h"
 #include "ns3/heap-scheduler.h"
+#include "ns3/ladder-scheduler.h"
 #include "ns3/list-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/priority-queue-scheduler.h"
 #include "ns3/simulator.h"
 #include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <set>
 
 using namespace ns3;
 
@@ -707,6 +716,292 @@ SimulatorTemplateTestCase::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Check the order in which a scheduler dequeues events against a
+ * sorted set, over a random sequence of insertions and removals.
+ *
+ * The delays mix zero, short and long delays, as the timers of a network
+ * model do, so that every tier of the LadderScheduler is exercised.
+ */
+class SchedulerOrderTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     * \param schedulerFactory Scheduler factory.
+     * \param description Description of the scheduler configuration.
+     */
+    SchedulerOrderTestCase(ObjectFactory schedulerFactory, std::string description);
+    void DoRun() override;
+
+  private:
+    ObjectFactory m_schedulerFactory; //!< Scheduler factory.
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase(ObjectFactory schedulerFactory,
+                                               std::string description)
+    : TestCase("Check the event order of " + description),
+      m_schedulerFactory(schedulerFactory)
+{
+}
+
+void
+SchedulerOrderTestCase::DoRun()
+{
+    Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler>();
+    std::set<Scheduler::EventKey> reference;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::exponential_distribution<double> shortDelay(1.0 / 1000);
+    std::uniform_int_distribution<uint64_t> longDelay(900000000, 1100000000);
+
+    uint64_t now = 0;
+    uint32_t uid = 0;
+    for (uint32_t i = 0; i < 200000; i++)
+    {
+        double choice = uniform(rng);
+        // keep a population of a few thousand events
+        double insertProbability = reference.size() < 3000 ? 0.6 : 0.4;
+        if (reference.empty() || choice < insertProbability)
+        {
+            double kind = uniform(rng);
+            uint64_t delay = 0;
+            if (kind < 0.1)
+            {
+                delay = 0;
+            }
+            else if (kind < 0.95)
+            {
+                delay = static_cast<uint64_t>(shortDelay(rng));
+            }
+            else
+            {
+                delay = longDelay(rng);
+            }
+            Scheduler::Event ev = {nullptr, {now + delay, uid++, 0}};
+            scheduler->Insert(ev);
+            reference.insert(ev.key);
+        }
+        else if (choice < insertProbability + 0.05)
+        {
+            auto it = reference.begin();
+            std::advance(it, std::uniform_int_distribution<std::size_t>(0, reference.size() - 1)(rng));
+            scheduler->Remove({nullptr, *it});
+            reference.erase(it);
+        }
+        else
+        {
+            Scheduler::Event next = scheduler->PeekNext();
+            NS_TEST_ASSERT_MSG_EQ(next.key.m_uid, reference.begin()->m_uid, "PeekNext order");
+            Scheduler::Event ev = scheduler->RemoveNext();
+            NS_TEST_ASSERT_MSG_EQ(ev.key.m_ts, reference.begin()->m_ts, "RemoveNext timestamp");
+            NS_TEST_ASSERT_MSG_EQ(ev.key.m_uid, reference.begin()->m_uid, "RemoveNext order");
+            now = ev.key.m_ts;
+            reference.erase(reference.begin());
+        }
+        NS_TEST_ASSERT_MSG_EQ(scheduler->IsEmpty(), reference.empty(), "IsEmpty");
+    }
+
+    while (!reference.empty())
+    {
+        Scheduler::Event ev = scheduler->RemoveNext();
+        NS_TEST_ASSERT_MSG_EQ(ev.key.m_uid, reference.begin()->m_uid, "RemoveNext order");
+        reference.erase(reference.begin());
+    }
+    NS_TEST_ASSERT_MSG_EQ(scheduler->IsEmpty(), true, "IsEmpty once drained");
+}
+
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Check the statistics and the files of the EventProfiler, fed
+ * directly, so that they are tested without the NS3_EVENT_PROFILER option.
+ */
+class EventProfilerRecordTestCase : public TestCase
+{
+  public:
+    EventProfilerRecordTestCase();
+    void DoRun() override;
+
+    /** Type of the first event. */
+    struct First
+    {
+    };
+
+    /** Type of the second event. */
+    struct Second
+    {
+    };
+};
+
+EventProfilerRecordTestCase::EventProfilerRecordTestCase()
+    : TestCase("Check the statistics and files of the event profiler")
+{
+}
+
+void
+EventProfilerRecordTestCase::DoRun()
+{
+    EventProfiler* profiler = EventProfiler::Get();
+    profiler->Reset();
+    NS_TEST_ASSERT_MSG_EQ(profiler->GetEntries().empty(), true, "entries after Reset");
+
+    profiler->Record(nullptr, &typeid(First), 7, 100);
+    profiler->Record(nullptr, &typeid(First), 7, 200);
+    profiler->Record(nullptr, &typeid(First), 0xffffffff, 1000);
+    profiler->Record(nullptr, &typeid(Second), 7, 10);
+
+    std::vector<EventProfiler::Entry> entries = profiler->GetEntries();
+    NS_TEST_ASSERT_MSG_EQ(entries.size(), 3, "one entry per function and context");
+    const std::string first = "EventProfilerRecordTestCase::First";
+    const std::string second = "EventProfilerRecordTestCase::Second";
+    // sorted by decreasing time
+    NS_TEST_EXPECT_MSG_EQ(entries[0].function, first, "name of entry 0");
+    NS_TEST_EXPECT_MSG_EQ(entries[0].context, 0xffffffff, "context of entry 0");
+    NS_TEST_EXPECT_MSG_EQ(entries[0].count, 1, "count of entry 0");
+    NS_TEST_EXPECT_MSG_EQ(entries[1].function, first, "name of entry 1");
+    NS_TEST_EXPECT_MSG_EQ(entries[1].context, 7, "context of entry 1");
+    NS_TEST_EXPECT_MSG_EQ(entries[1].count, 2, "count of entry 1");
+    NS_TEST_EXPECT_MSG_EQ(entries[2].function, second, "name of entry 2");
+    NS_TEST_EXPECT_MSG_EQ(entries[2].count, 1, "count of entry 2");
+    NS_TEST_EXPECT_MSG_GT(entries[2].seconds, 0, "time of entry 2");
+    NS_TEST_EXPECT_MSG_EQ_TOL(entries[1].seconds / entries[2].seconds,
+                              30,
+                              1e-9,
+                              "times not proportional to the ticks");
+
+    std::string dir = CreateTempDirFilename("");
+    profiler->Initialize({"profiled-program"}, dir);
+    profiler->Write();
+    std::ifstream report(dir + "/profiled-program-event-profile.txt");
+    std::string line;
+    std::getline(report, line);
+    NS_TEST_EXPECT_MSG_EQ(line.rfind("events: 4,", 0), 0, "first line of the report: " << line);
+    std::ifstream folded(dir + "/profiled-program-event-profile.folded");
+    std::vector<std::string> lines;
+    while (std::getline(folded, line))
+    {
+        lines.push_back(line.substr(0, line.rfind(' ')));
+    }
+    NS_TEST_ASSERT_MSG_EQ(lines.size(), 3, "lines of the folded stacks");
+    NS_TEST_EXPECT_MSG_EQ(lines[0], first + ";no context", "folded line 0");
+    NS_TEST_EXPECT_MSG_EQ(lines[1], first + ";node 7", "folded line 1");
+    NS_TEST_EXPECT_MSG_EQ(lines[2], second + ";node 7", "folded line 2");
+
+    profiler->Reset();
+    profiler->Initialize({});
+    NS_TEST_EXPECT_MSG_EQ(profiler->GetEntries().empty(), true, "entries after Reset");
+}
+
+#ifdef NS3_EVENT_PROFILER_ENABLE
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Check that the EventProfiler counts the events per function and
+ * context, resolving virtual methods to the method of the object.
+ */
+class EventProfilerTestCase : public TestCase
+{
+  public:
+    EventProfilerTestCase();
+    void DoRun() override;
+
+    /** A non virtual event method. */
+    void Plain();
+
+    uint32_t m_plainCalls{0}; //!< Calls of Plain()
+
+    /** Base class with a virtual event method. */
+    class Base
+    {
+      public:
+        virtual ~Base() = default;
+        /** The virtual event method. */
+        virtual void Handle();
+
+        uint32_t m_baseCalls{0}; //!< Calls of Base::Handle()
+    };
+
+    /** Derived class overriding the virtual event method. */
+    class Derived : public Base
+    {
+      public:
+        void Handle() override;
+
+        double m_derivedCalls{0}; //!< Calls of Derived::Handle()
+    };
+};
+
+EventProfilerTestCase::EventProfilerTestCase()
+    : TestCase("Check the event profiler")
+{
+}
+
+void
+EventProfilerTestCase::Plain()
+{
+    // the methods differ, so that the compiler does not merge them
+    m_plainCalls++;
+}
+
+void
+EventProfilerTestCase::Base::Handle()
+{
+    m_baseCalls++;
+}
+
+void
+EventProfilerTestCase::Derived::Handle()
+{
+    m_derivedCalls += 1;
+}
+
+void
+EventProfilerTestCase::DoRun()
+{
+    EventProfiler::Get()->Reset();
+    Derived derived;
+    Base* base = &derived;
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        Simulator::ScheduleWithContext(7, Seconds(i), &EventProfilerTestCase::Plain, this);
+    }
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        Simulator::ScheduleWithContext(9, Seconds(i), &EventProfilerTestCase::Plain, this);
+    }
+    Simulator::Schedule(Seconds(1), &Base::Handle, base);
+    EventId cancelled = Simulator::Schedule(Seconds(2), &EventProfilerTestCase::Plain, this);
+    cancelled.Cancel();
+    Simulator::Run();
+
+    std::map<std::pair<std::string, uint32_t>, uint64_t> counts;
+    for (const auto& entry : EventProfiler::Get()->GetEntries())
+    {
+        counts[{entry.function, entry.context}] += entry.count;
+    }
+    auto count = [&counts](std::string function, uint32_t context) {
+        return counts[std::make_pair(function, context)];
+    };
+    NS_TEST_EXPECT_MSG_EQ(count("EventProfilerTestCase::Plain()", 7), 3, "context 7");
+    NS_TEST_EXPECT_MSG_EQ(count("EventProfilerTestCase::Plain()", 9), 2, "context 9");
+    NS_TEST_EXPECT_MSG_EQ(count("EventProfilerTestCase::Plain()", 0xffffffff),
+                          0,
+                          "cancelled event counted");
+    NS_TEST_EXPECT_MSG_EQ(count("EventProfilerTestCase::Derived::Handle()", 0xffffffff),
+                          1,
+                          "virtual method not resolved");
+    NS_TEST_EXPECT_MSG_EQ(m_plainCalls, 5, "wrong number of calls");
+    NS_TEST_EXPECT_MSG_EQ(derived.m_derivedCalls, 1, "wrong number of calls");
+
+    // keep Simulator::Destroy from writing the report of the test
+    EventProfiler::Get()->Reset();
+    Simulator::Destroy();
+}
+#endif
+
 /**
  * \ingroup simulator-tests
  *
@@ -730,6 +1025,24 @@ class SimulatorTestSuite : public TestSuite
         AddTestCase(new SimulatorEventsTestCase(factory), TestCase::QUICK);
         factory.SetTypeId(PriorityQueueScheduler::GetTypeId());
         AddTestCase(new SimulatorEventsTestCase(factory), TestCase::QUICK);
+        factory.SetTypeId(LadderScheduler::GetTypeId());
+        AddTestCase(new SimulatorEventsTestCase(factory), TestCase::QUICK);
+
+        factory.SetTypeId(CalendarScheduler::GetTypeId());
+        AddTestCase(new SchedulerOrderTestCase(factory, "ns3::CalendarScheduler"),
+                    TestCase::QUICK);
+        factory.SetTypeId(LadderScheduler::GetTypeId());
+        AddTestCase(new SchedulerOrderTestCase(factory, "ns3::LadderScheduler"), TestCase::QUICK);
+        // small buckets and a short ladder, to spawn rungs often and hit the limit
+        factory.Set("Threshold", UintegerValue(4));
+        factory.Set("MaxRungs", UintegerValue(3));
+        AddTestCase(
+            new SchedulerOrderTestCase(factory, "ns3::LadderScheduler, Threshold 4, MaxRungs 3"),
+            TestCase::QUICK);
+        AddTestCase(new EventProfilerRecordTestCase(), TestCase::QUICK);
+#ifdef NS3_EVENT_PROFILER_ENABLE
+        AddTestCase(new EventProfilerTestCase(), TestCase::QUICK);
+#endif
     }
 };
 
@@ -0,0 +1,121 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Measure the cost of demultiplexing a received packet to its endpoint with
+ * Ipv4EndPointDemux, as a function of the number of endpoints.
+ *
+ * For each endpoint count, a server listening on port 80 has that many
+ * connections, each with its own peer address and port, the endpoints being
+ * allocated and then given their peer as TCP does. The demux then looks up
+ * the endpoint of random packets: 9 in 10 belong to one of the connections,
+ * the others come from new peers and go to the listening endpoint. The time
+ * to allocate the endpoints and the time per lookup are printed, one line per
+ * endpoint count.
+ *
+ * ./ns3 run "end-point-demux-benchmark"
+ * ./ns3 run "end-point-demux-benchmark --endPointCnts=10,10000 --lookups=100000"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/network-module.h"
+#include "ns3/simple-net-device.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+int
+main(int argc, char* argv[])
+{
+    CommandLine cmd(__FILE__);
+    std::string endPointCnts = "10,100,1000,10000,100000";
+    uint32_t lookups = 1000000;
+    cmd.AddValue("endPointCnts", "Comma separated list of endpoint counts", endPointCnts);
+    cmd.AddValue("lookups", "Number of lookups per point", lookups);
+    cmd.Parse(argc, argv);
+
+    std::vector<uint32_t> counts;
+    std::istringstream iss(endPointCnts);
+    std::string item;
+    while (std::getline(iss, item, ','))
+    {
+        counts.push_back(std::stoul(item));
+    }
+
+    Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable>();
+    rand->SetStream(1);
+
+    Ipv4Address local("10.1.1.1");
+    Ptr<Ipv4Interface> interface = CreateObject<Ipv4Interface>();
+    interface->SetDevice(CreateObject<SimpleNetDevice>());
+    interface->AddAddress(Ipv4InterfaceAddress(local, "255.255.255.0"));
+
+    std::cout << std::setw(10) << "endpoints" << std::setw(12) << "alloc(ms)" << std::setw(12)
+              << "ns/lookup" << std::setw(10) << "found" << std::endl;
+    for (auto n : counts)
+    {
+        std::vector<Ipv4Address> peers;
+        std::vector<uint16_t> ports;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            peers.emplace_back(0x0b000000 + i);
+            ports.push_back(1024 + i % 60000);
+        }
+
+        Ipv4EndPointDemux demux;
+        SystemWallClockMs clock;
+        clock.Start();
+        demux.Allocate(nullptr, Ipv4Address::GetAny(), 80);
+        for (uint32_t i = 0; i < n; i++)
+        {
+            Ipv4EndPoint* endPoint = demux.Allocate(nullptr, local, 80, Ipv4Address::GetAny(), 0);
+            endPoint->SetPeer(peers[i], ports[i]);
+        }
+        double allocMs = clock.End();
+
+        std::vector<uint32_t> packets;
+        for (uint32_t i = 0; i < lookups; i++)
+        {
+            packets.push_back(rand->GetInteger(0, n * 10 / 9));
+        }
+        uint32_t found = 0;
+        auto begin = std::chrono::steady_clock::now();
+        for (auto j : packets)
+        {
+            Ipv4Address peer = j < n ? peers[j] : Ipv4Address(0x0c000000 + j);
+            uint16_t port = j < n ? ports[j] : 1024;
+            if (!demux.Lookup(local, 80, peer, port, interface).empty())
+            {
+                found++;
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+        double nsPerLookup =
+            std::chrono::duration<double, std::nano>(end - begin).count() / lookups;
+        std::cout << std::setw(10) << n << std::fixed << std::setprecision(1) << std::setw(12)
+                  << allocMs << std::setw(12) << nsPerLookup << std::setw(10) << found << std::endl;
+    }
+    Simulator::Destroy();
+    return 0;
+}
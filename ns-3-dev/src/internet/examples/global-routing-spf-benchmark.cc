@@ -0,0 +1,177 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Measure the time of the SPF calculations of the global routing as a
+ * function of the size of the topology and of the number of threads.
+ *
+ * The topology is a square grid of routers, each linked to its right and
+ * lower neighbors by a point-to-point link of random metric.  For each size,
+ * the routing tables are computed with each number of threads, and compared
+ * to those computed with one thread.
+ *
+ * ./ns3 run "global-routing-spf-benchmark"
+ * ./ns3 run "global-routing-spf-benchmark --sides=10,20,30 --threads=1,2,4,8"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Parse a comma separated list of numbers.
+ *
+ * \param list the list
+ * \return the numbers
+ */
+static std::vector<uint32_t>
+ParseList(const std::string& list)
+{
+    std::vector<uint32_t> values;
+    std::istringstream iss(list);
+    std::string item;
+    while (std::getline(iss, item, ','))
+    {
+        values.push_back(std::stoul(item));
+    }
+    return values;
+}
+
+/**
+ * Connect two routers with a point-to-point link.
+ *
+ * \param a the first router
+ * \param b the second router
+ * \param metric the metric of the link
+ * \param address the address helper, which is moved to the next network
+ */
+static void
+Link(Ptr<Node> a, Ptr<Node> b, uint16_t metric, Ipv4AddressHelper& address)
+{
+    SimpleNetDeviceHelper devices;
+    devices.SetNetDevicePointToPointMode(true);
+    Ipv4InterfaceContainer interfaces = address.Assign(devices.Install(NodeContainer(a, b)));
+    address.NewNetwork();
+    for (uint32_t i = 0; i < interfaces.GetN(); i++)
+    {
+        interfaces.Get(i).first->SetMetric(interfaces.Get(i).second, metric);
+    }
+}
+
+/**
+ * Build a grid of side x side routers.
+ *
+ * The metrics of the links are random, so that there are few equal cost
+ * paths: the number of paths of the SPF tree grows exponentially with them.
+ *
+ * \param side the number of routers on a side of the grid
+ */
+static void
+BuildGrid(uint32_t side)
+{
+    NodeContainer nodes;
+    nodes.Create(side * side);
+    InternetStackHelper internet;
+    internet.Install(nodes);
+
+    Ptr<UniformRandomVariable> metric = CreateObject<UniformRandomVariable>();
+    metric->SetStream(1);
+    Ipv4AddressHelper address("10.0.0.0", "255.255.255.252");
+    for (uint32_t row = 0; row < side; row++)
+    {
+        for (uint32_t col = 0; col < side; col++)
+        {
+            Ptr<Node> node = nodes.Get(row * side + col);
+            if (col + 1 < side)
+            {
+                Link(node, nodes.Get(row * side + col + 1), metric->GetInteger(1, 1000), address);
+            }
+            if (row + 1 < side)
+            {
+                Link(node, nodes.Get((row + 1) * side + col), metric->GetInteger(1, 1000), address);
+            }
+        }
+    }
+}
+
+/**
+ * \return the routes of the global routing of all the nodes, one per line,
+ * after a line with the id of the node
+ */
+static std::string
+DumpRoutes()
+{
+    std::ostringstream oss;
+    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    {
+        Ptr<GlobalRouter> router = (*i)->GetObject<GlobalRouter>();
+        Ptr<Ipv4GlobalRouting> routing = router->GetRoutingProtocol();
+        oss << "node " << (*i)->GetId() << "\n";
+        for (uint32_t j = 0; j < routing->GetNRoutes(); j++)
+        {
+            oss << *routing->GetRoute(j) << "\n";
+        }
+    }
+    return oss.str();
+}
+
+int
+main(int argc, char* argv[])
+{
+    CommandLine cmd(__FILE__);
+    std::string sides = "10,20,30";
+    std::string threads = "1,2,4";
+    cmd.AddValue("sides", "Comma separated list of grid sides", sides);
+    cmd.AddValue("threads", "Comma separated list of thread counts", threads);
+    cmd.Parse(argc, argv);
+
+    std::cout << std::setw(8) << "routers" << std::setw(9) << "threads" << std::setw(12)
+              << "spf(ms)" << std::setw(10) << "routes" << std::setw(10) << "same" << std::endl;
+    for (auto side : ParseList(sides))
+    {
+        BuildGrid(side);
+        std::string reference;
+        for (auto n : ParseList(threads))
+        {
+            Config::SetGlobal("GlobalRoutingThreads", UintegerValue(n));
+            GlobalRouteManager::DeleteGlobalRoutes();
+            GlobalRouteManager::BuildGlobalRoutingDatabase();
+            SystemWallClockMs clock;
+            clock.Start();
+            GlobalRouteManager::InitializeRoutes();
+            int64_t ms = clock.End();
+
+            std::string routes = DumpRoutes();
+            uint32_t nRoutes = std::count(routes.begin(), routes.end(), '\n') - side * side;
+            if (reference.empty())
+            {
+                reference = routes;
+            }
+            std::cout << std::setw(8) << side * side << std::setw(9) << n << std::setw(12) << ms
+                      << std::setw(10) << nRoutes << std::setw(10)
+                      << (routes == reference ? "yes" : "NO") << std::endl;
+        }
+        Simulator::Destroy();
+    }
+    return 0;
+}
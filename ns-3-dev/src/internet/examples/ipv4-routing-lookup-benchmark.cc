@@ -0,0 +1,319 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Measure the cost of a route lookup of Ipv4StaticRouting and
+ * Ipv4GlobalRouting as a function of the number of routes.
+ *
+ * For each route count, a node is given that many network routes, with
+ * random prefixes of 8 to 30 bits, and looks up the route of random
+ * destinations, half of them inside one of the networks. The time to add the
+ * routes and the time per lookup are printed, one line per route count.
+ *
+ * The "linear" and "index" lines compare the longest prefix match alone,
+ * without the rest of RouteOutput: "linear" is the scan of the route list
+ * Ipv4StaticRouting did before it used Ipv4RoutingTableIndex, "index" is the
+ * lookup through the index that replaced it. Both pick the route of the
+ * lowest metric among the longest prefixes, the last one added on a tie; the
+ * benchmark aborts if they ever pick different routes.
+ *
+ * ./ns3 run "ipv4-routing-lookup-benchmark"
+ * ./ns3 run "ipv4-routing-lookup-benchmark --routeCnts=10,1000,10000 --lookups=100000"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include "ns3/simple-net-device.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Result of one benchmark point.
+ */
+struct LookupResult
+{
+    double addMs;       //!< wall time to add the routes
+    double nsPerLookup; //!< wall time per lookup
+    uint32_t found;     //!< number of lookups which found a route
+};
+
+/**
+ * Add the routes to a routing protocol and time the lookups.
+ *
+ * \param routing the routing protocol, Ipv4StaticRouting or Ipv4GlobalRouting
+ * \param networks the destination networks
+ * \param masks the network masks
+ * \param dests the destinations to look up
+ * \return the result
+ */
+template <typename Routing>
+static LookupResult
+RunPoint(Ptr<Routing> routing,
+         const std::vector<Ipv4Address>& networks,
+         const std::vector<Ipv4Mask>& masks,
+         const std::vector<Ipv4Address>& dests)
+{
+    LookupResult result{};
+    SystemWallClockMs clock;
+    clock.Start();
+    for (uint32_t i = 0; i < networks.size(); i++)
+    {
+        routing->AddNetworkRouteTo(networks[i], masks[i], Ipv4Address("192.168.1.2"), 1);
+    }
+    result.addMs = clock.End();
+
+    Ipv4Header header;
+    Socket::SocketErrno sockerr;
+    auto begin = std::chrono::steady_clock::now();
+    for (const auto& dest : dests)
+    {
+        header.SetDestination(dest);
+        if (routing->RouteOutput(nullptr, header, nullptr, sockerr))
+        {
+            result.found++;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    result.nsPerLookup =
+        std::chrono::duration<double, std::nano>(end - begin).count() / dests.size();
+    return result;
+}
+
+/**
+ * Time the longest prefix match over a list of routes, with a linear scan or
+ * with an Ipv4RoutingTableIndex.
+ *
+ * \param networks the destination networks
+ * \param masks the network masks
+ * \param dests the destinations to look up
+ * \param linearResult [out] the result of the linear scan
+ * \param indexResult [out] the result of the index
+ */
+static void
+RunScanPoint(const std::vector<Ipv4Address>& networks,
+             const std::vector<Ipv4Mask>& masks,
+             const std::vector<Ipv4Address>& dests,
+             LookupResult& linearResult,
+             LookupResult& indexResult)
+{
+    linearResult = LookupResult{};
+    indexResult = LookupResult{};
+    std::vector<Ipv4RoutingTableEntry> entries;
+    entries.reserve(networks.size());
+    for (uint32_t i = 0; i < networks.size(); i++)
+    {
+        entries.push_back(Ipv4RoutingTableEntry::CreateNetworkRouteTo(networks[i],
+                                                                     masks[i],
+                                                                     Ipv4Address("192.168.1.2"),
+                                                                     1));
+    }
+
+    // the route list of Ipv4StaticRouting, with a metric per route
+    SystemWallClockMs clock;
+    clock.Start();
+    std::vector<std::pair<Ipv4RoutingTableEntry*, uint32_t>> routes;
+    for (uint32_t i = 0; i < entries.size(); i++)
+    {
+        routes.emplace_back(&entries[i], i % 3);
+    }
+    linearResult.addMs = clock.End();
+
+    clock.Start();
+    Ipv4RoutingTableIndex index;
+    for (uint32_t i = 0; i < entries.size(); i++)
+    {
+        index.Add(&entries[i], i % 3);
+    }
+    indexResult.addMs = clock.End();
+
+    std::vector<const Ipv4RoutingTableEntry*> linearRoutes;
+    linearRoutes.reserve(dests.size());
+    auto begin = std::chrono::steady_clock::now();
+    for (const auto& dest : dests)
+    {
+        // the loop of Ipv4StaticRouting::LookupStatic before the index
+        uint16_t longestMask = 0;
+        uint32_t shortestMetric = 0xffffffff;
+        const Ipv4RoutingTableEntry* found = nullptr;
+        for (const auto& [route, metric] : routes)
+        {
+            Ipv4Mask mask = route->GetDestNetworkMask();
+            uint16_t masklen = mask.GetPrefixLength();
+            if (!mask.IsMatch(dest, route->GetDestNetwork()) || masklen < longestMask)
+            {
+                continue;
+            }
+            if (masklen > longestMask)
+            {
+                shortestMetric = 0xffffffff;
+            }
+            longestMask = masklen;
+            if (metric > shortestMetric)
+            {
+                continue;
+            }
+            shortestMetric = metric;
+            found = route;
+        }
+        linearRoutes.push_back(found);
+    }
+    auto end = std::chrono::steady_clock::now();
+    linearResult.nsPerLookup =
+        std::chrono::duration<double, std::nano>(end - begin).count() / dests.size();
+
+    std::vector<const Ipv4RoutingTableEntry*> indexRoutes;
+    indexRoutes.reserve(dests.size());
+    std::vector<Ipv4RoutingTableIndex::Match> matches;
+    begin = std::chrono::steady_clock::now();
+    for (const auto& dest : dests)
+    {
+        // the selection of Ipv4StaticRouting::LookupStatic, without host routes
+        index.Lookup(dest, matches);
+        const Ipv4RoutingTableIndex::Match* best = nullptr;
+        for (const auto& match : matches)
+        {
+            if (best && match.prefixLength < best->prefixLength)
+            {
+                break;
+            }
+            if (!best || match.metric < best->metric ||
+                (match.metric == best->metric && match.order > best->order))
+            {
+                best = &match;
+            }
+        }
+        indexRoutes.push_back(best ? best->route : nullptr);
+    }
+    end = std::chrono::steady_clock::now();
+    indexResult.nsPerLookup =
+        std::chrono::duration<double, std::nano>(end - begin).count() / dests.size();
+
+    for (uint32_t i = 0; i < dests.size(); i++)
+    {
+        NS_ABORT_MSG_IF(linearRoutes[i] != indexRoutes[i],
+                        "the index and the linear scan disagree on the route to " << dests[i]);
+        linearResult.found += linearRoutes[i] != nullptr;
+        indexResult.found += indexRoutes[i] != nullptr;
+    }
+}
+
+/**
+ * Create a node with one interface, in 192.168.1.0/24.
+ *
+ * \return the IPv4 stack of the node
+ */
+static Ptr<Ipv4>
+CreateIpv4Node()
+{
+    Ptr<Node> node = CreateObject<Node>();
+    InternetStackHelper internet;
+    internet.Install(node);
+    Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice>();
+    device->SetAddress(Mac48Address::Allocate());
+    node->AddDevice(device);
+    Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
+    int32_t ifIndex = ipv4->AddInterface(device);
+    ipv4->AddAddress(ifIndex, Ipv4InterfaceAddress("192.168.1.1", "255.255.255.0"));
+    ipv4->SetUp(ifIndex);
+    return ipv4;
+}
+
+int
+main(int argc, char* argv[])
+{
+    CommandLine cmd(__FILE__);
+    std::string routeCnts = "10,100,1000,10000";
+    uint32_t lookups = 1000000;
+    cmd.AddValue("routeCnts", "Comma separated list of route counts", routeCnts);
+    cmd.AddValue("lookups", "Number of lookups per point", lookups);
+    cmd.Parse(argc, argv);
+
+    std::vector<uint32_t> counts;
+    std::istringstream iss(routeCnts);
+    std::string item;
+    while (std::getline(iss, item, ','))
+    {
+        counts.push_back(std::stoul(item));
+    }
+
+    Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable>();
+    rand->SetStream(1);
+
+    std::cout << std::setw(8) << "routes" << std::setw(10) << "routing" << std::setw(12)
+              << "add(ms)" << std::setw(12) << "ns/lookup" << std::setw(10) << "found"
+              << std::endl;
+    for (auto n : counts)
+    {
+        std::vector<Ipv4Address> networks;
+        std::vector<Ipv4Mask> masks;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            uint32_t length = rand->GetInteger(8, 30);
+            Ipv4Mask mask(~0U << (32 - length));
+            networks.emplace_back(rand->GetInteger(0x0a000000, 0x7effffff) & mask.Get());
+            masks.push_back(mask);
+        }
+        std::vector<Ipv4Address> dests;
+        for (uint32_t i = 0; i < lookups; i++)
+        {
+            uint32_t dest = rand->GetInteger(0x0a000000, 0x7effffff);
+            if (i % 2 == 0)
+            {
+                uint32_t j = rand->GetInteger(0, n - 1);
+                dest = networks[j].Get() | (dest & ~masks[j].Get());
+            }
+            dests.emplace_back(dest);
+        }
+
+        for (int mode = 0; mode < 2; mode++)
+        {
+            Ptr<Ipv4> ipv4 = CreateIpv4Node();
+            Ptr<Ipv4RoutingProtocol> protocol = ipv4->GetRoutingProtocol();
+            LookupResult r =
+                mode == 0
+                    ? RunPoint(Ipv4RoutingHelper::GetRouting<Ipv4StaticRouting>(protocol),
+                               networks,
+                               masks,
+                               dests)
+                    : RunPoint(Ipv4RoutingHelper::GetRouting<Ipv4GlobalRouting>(protocol),
+                               networks,
+                               masks,
+                               dests);
+            std::cout << std::setw(8) << n << std::setw(10) << (mode == 0 ? "static" : "global")
+                      << std::fixed << std::setprecision(1) << std::setw(12) << r.addMs
+                      << std::setw(12) << r.nsPerLookup << std::setw(10) << r.found << std::endl;
+        }
+        Simulator::Destroy();
+
+        LookupResult linear;
+        LookupResult indexed;
+        RunScanPoint(networks, masks, dests, linear, indexed);
+        for (const auto& [name, r] : {std::make_pair("linear", linear),
+                                      std::make_pair("index", indexed)})
+        {
+            std::cout << std::setw(8) << n << std::setw(10) << name << std::fixed
+                      << std::setprecision(1) << std::setw(12) << r.addMs << std::setw(12)
+                      << r.nsPerLookup << std::setw(10) << r.found << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,210 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Measure the cost of the ArpCache and NdiscCache operations as a function
+ * of the number of entries, as on a large flat L2 segment.
+ *
+ * For each entry count, the caches are filled with that many neighbors, then
+ * looked up for random addresses, 9 in 10 of them in the cache. For the ARP
+ * cache, 1 in 10 entries then waits for a reply which never comes, and the
+ * wait reply timer runs until the requests have been retransmitted and the
+ * entries marked dead. The time per insertion, per lookup and per timeout of
+ * the wait reply timer are printed, one line per cache and entry count.
+ *
+ * ./ns3 run "neighbor-cache-benchmark"
+ * ./ns3 run "neighbor-cache-benchmark --entryCnts=1000,100000 --lookups=100000"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+/// The number of ARP requests sent by the caches
+static uint32_t g_requests = 0;
+
+/**
+ * Count an ARP request.
+ *
+ * \param cache the ARP cache
+ * \param address the address to resolve
+ */
+static void
+CountRequest(Ptr<const ArpCache> cache, Ipv4Address address)
+{
+    g_requests++;
+}
+
+/**
+ * \param begin the start time
+ * \return the nanoseconds elapsed since begin
+ */
+static double
+NanoSecondsSince(std::chrono::steady_clock::time_point begin)
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin)
+        .count();
+}
+
+/**
+ * Print a line of results.
+ *
+ * \param cache the name of the cache
+ * \param n the number of entries
+ * \param insertNs the time per insertion
+ * \param lookupNs the time per lookup
+ * \param found the number of lookups which found an entry
+ * \param timeoutUs the time per timeout of the wait reply timer, or a negative value
+ */
+static void
+Print(std::string cache,
+      uint32_t n,
+      double insertNs,
+      double lookupNs,
+      uint32_t found,
+      double timeoutUs)
+{
+    std::cout << std::setw(6) << cache << std::setw(10) << n << std::fixed << std::setprecision(1)
+              << std::setw(12) << insertNs << std::setw(12) << lookupNs << std::setw(10) << found
+              << std::setw(14);
+    if (timeoutUs < 0)
+    {
+        std::cout << "-";
+    }
+    else
+    {
+        std::cout << timeoutUs;
+    }
+    std::cout << std::setw(10) << g_requests << std::endl;
+}
+
+int
+main(int argc, char* argv[])
+{
+    CommandLine cmd(__FILE__);
+    std::string entryCnts = "1000,10000,100000";
+    uint32_t lookups = 1000000;
+    cmd.AddValue("entryCnts", "Comma separated list of entry counts", entryCnts);
+    cmd.AddValue("lookups", "Number of lookups per point", lookups);
+    cmd.Parse(argc, argv);
+
+    std::vector<uint32_t> counts;
+    std::istringstream iss(entryCnts);
+    std::string item;
+    while (std::getline(iss, item, ','))
+    {
+        counts.push_back(std::stoul(item));
+    }
+
+    Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable>();
+    rand->SetStream(1);
+
+    std::cout << std::setw(6) << "cache" << std::setw(10) << "entries" << std::setw(12)
+              << "insert(ns)" << std::setw(12) << "lookup(ns)" << std::setw(10) << "found"
+              << std::setw(14) << "timeout(us)" << std::setw(10) << "requests" << std::endl;
+    for (auto n : counts)
+    {
+        std::vector<uint32_t> targets;
+        for (uint32_t i = 0; i < lookups; i++)
+        {
+            targets.push_back(rand->GetInteger(0, n * 10 / 9));
+        }
+
+        // ARP
+        {
+            g_requests = 0;
+            Ptr<ArpCache> cache = CreateObject<ArpCache>();
+            cache->SetArpRequestCallback(MakeCallback(&CountRequest));
+            auto begin = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < n; i++)
+            {
+                ArpCache::Entry* entry = cache->Add(Ipv4Address(0x0a000000 + i));
+                entry->SetMacAddress(Mac48Address::Allocate());
+                entry->MarkPermanent();
+            }
+            double insertNs = NanoSecondsSince(begin) / n;
+
+            uint32_t found = 0;
+            begin = std::chrono::steady_clock::now();
+            for (auto j : targets)
+            {
+                found += cache->Lookup(Ipv4Address(0x0a000000 + j)) != nullptr;
+            }
+            double lookupNs = NanoSecondsSince(begin) / lookups;
+
+            // the entries of 1 in 10 neighbors wait for a reply
+            for (uint32_t i = 0; i < n; i += 10)
+            {
+                cache->Remove(cache->Lookup(Ipv4Address(0x0a000000 + i)));
+                ArpCache::Entry* entry = cache->Add(Ipv4Address(0x0a000000 + i));
+                entry->MarkWaitReply(
+                    ArpCache::Ipv4PayloadHeaderPair(Create<Packet>(), Ipv4Header()));
+            }
+            cache->StartWaitReplyTimer();
+            begin = std::chrono::steady_clock::now();
+            Simulator::Run();
+            // the requests are retransmitted MaxRetries times, then the entries are dead
+            UintegerValue maxRetries;
+            cache->GetAttribute("MaxRetries", maxRetries);
+            double timeoutUs = NanoSecondsSince(begin) / 1000 / (maxRetries.Get() + 1);
+            Print("arp", n, insertNs, lookupNs, found, timeoutUs);
+            cache->Dispose();
+            Simulator::Destroy();
+        }
+
+        // NDISC
+        {
+            g_requests = 0;
+            Ptr<NdiscCache> cache = CreateObject<NdiscCache>();
+            std::vector<Ipv6Address> addresses;
+            for (uint32_t i = 0; i < n * 10 / 9 + 1; i++)
+            {
+                uint8_t buf[16] = {0x20, 0x01, 0x0d, 0xb8};
+                buf[13] = i >> 16;
+                buf[14] = i >> 8;
+                buf[15] = i;
+                addresses.emplace_back(buf);
+            }
+            auto begin = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < n; i++)
+            {
+                NdiscCache::Entry* entry = cache->Add(addresses[i]);
+                entry->SetMacAddress(Mac48Address::Allocate());
+                entry->MarkPermanent();
+            }
+            double insertNs = NanoSecondsSince(begin) / n;
+
+            uint32_t found = 0;
+            begin = std::chrono::steady_clock::now();
+            for (auto j : targets)
+            {
+                found += cache->Lookup(addresses[j]) != nullptr;
+            }
+            double lookupNs = NanoSecondsSince(begin) / lookups;
+            Print("ndisc", n, insertNs, lookupNs, found, -1);
+            cache->Dispose();
+            Simulator::Destroy();
+        }
+    }
+    return 0;
+}
@@ -30,6 +30,8 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
 
+#include <vector>
+
 namespace ns3
 {
 
@@ -197,12 +199,17 @@ void
 ArpCache::HandleWaitReplyTimeout()
 {
     NS_LOG_FUNCTION(this);
-    ArpCache::Entry* entry;
     bool restartWaitReplyTimer = false;
-    for (auto i = m_arpCache.begin(); i != m_arpCache.end(); i++)
+    // copy the entries, as handling them takes them out of the WAIT_REPLY state
+    std::vector<ArpCache::Entry*> entries;
+    entries.reserve(m_waitReplyEntries.size());
+    for (const auto& i : m_waitReplyEntries)
+    {
+        entries.push_back(i.second);
+    }
+    for (auto entry : entries)
     {
-        entry = (*i).second;
-        if (entry != nullptr && entry->IsWaitReply())
+        if (entry->IsWaitReply())
         {
             if (entry->GetRetries() < m_maxRetries)
             {
@@ -245,11 +252,8 @@ void
 ArpCache::Flush()
 {
     NS_LOG_FUNCTION(this);
-    for (auto i = m_arpCache.begin(); i != m_arpCache.end(); i++)
-    {
-        delete (*i).second;
-    }
-    m_arpCache.erase(m_arpCache.begin(), m_arpCache.end());
+    m_waitReplyEntries.clear();
+    m_arpCache.Clear();
     if (m_waitReplyTimer.IsRunning())
     {
         NS_LOG_LOGIC("Stopping WaitReplyTimer at " << Simulator::Now().GetSeconds()
@@ -264,9 +268,9 @@ ArpCache::PrintArpCache(Ptr<OutputStreamWrapper> stream)
     NS_LOG_FUNCTION(this << stream);
     std::ostream* os = stream->GetStream();
 
-    for (auto i = m_arpCache.begin(); i != m_arpCache.end(); i++)
+    for (auto entry : m_arpCache.GetSortedEntries())
     {
-        *os << i->first << " dev ";
+        *os << entry->GetIpv4Address() << " dev ";
         std::string found = Names::FindName(m_device);
         if (!Names::FindName(m_device).empty())
         {
@@ -277,21 +281,21 @@ ArpCache::PrintArpCache(Ptr<OutputStreamWrapper> stream)
             *os << static_cast<int>(m_device->GetIfIndex());
         }
 
-        *os << " lladdr " << i->second->GetMacAddress();
+        *os << " lladdr " << entry->GetMacAddress();
 
-        if (i->second->IsAlive())
+        if (entry->IsAlive())
         {
             *os << " REACHABLE\n";
         }
-        else if (i->second->IsWaitReply())
+        else if (entry->IsWaitReply())
         {
             *os << " DELAY\n";
         }
-        else if (i->second->IsPermanent())
+        else if (entry->IsPermanent())
         {
             *os << " PERMANENT\n";
         }
-        else if (i->second->IsAutoGenerated())
+        else if (entry->IsAutoGenerated())
         {
             *os << " STATIC_AUTOGENERATED\n";
         }
@@ -306,16 +310,12 @@ void
 ArpCache::RemoveAutoGeneratedEntries()
 {
     NS_LOG_FUNCTION(this);
-    for (auto i = m_arpCache.begin(); i != m_arpCache.end();)
+    for (auto entry : m_arpCache.GetSortedEntries())
     {
-        if (i->second->IsAutoGenerated())
+        if (entry->IsAutoGenerated())
         {
-            i->second->ClearPendingPacket(); // clear the pending packets for entry's ipaddress
-            delete i->second;
-            m_arpCache.erase(i++);
-            continue;
+            Remove(entry);
         }
-        i++;
     }
 }
 
@@ -325,9 +325,8 @@ ArpCache::LookupInverse(Address to)
     NS_LOG_FUNCTION(this << to);
 
     std::list<ArpCache::Entry*> entryList;
-    for (auto i = m_arpCache.begin(); i != m_arpCache.end(); i++)
+    for (auto entry : m_arpCache.GetSortedEntries())
     {
-        ArpCache::Entry* entry = (*i).second;
         if (entry->GetMacAddress() == to)
         {
             entryList.push_back(entry);
@@ -340,22 +339,16 @@ ArpCache::Entry*
 ArpCache::Lookup(Ipv4Address to)
 {
     NS_LOG_FUNCTION(this << to);
-    auto it = m_arpCache.find(to);
-    if (it != m_arpCache.end())
-    {
-        return it->second;
-    }
-    return nullptr;
+    return m_arpCache.Lookup(to);
 }
 
 ArpCache::Entry*
 ArpCache::Add(Ipv4Address to)
 {
     NS_LOG_FUNCTION(this << to);
-    NS_ASSERT(m_arpCache.find(to) == m_arpCache.end());
+    NS_ASSERT(!m_arpCache.Lookup(to));
 
-    auto entry = new ArpCache::Entry(this);
-    m_arpCache[to] = entry;
+    ArpCache::Entry* entry = m_arpCache.Emplace(to, this);
     entry->SetIpv4Address(to);
     return entry;
 }
@@ -365,19 +358,37 @@ ArpCache::Remove(ArpCache::Entry* entry)
 {
     NS_LOG_FUNCTION(this << entry);
 
-    for (auto i = m_arpCache.begin(); i != m_arpCache.end(); i++)
+    auto i = m_arpCache.Find(entry->GetIpv4Address());
+    if (i == m_arpCache.End() || i->second != entry)
     {
-        if ((*i).second == entry)
+        // the address of the entry has been changed since it was added
+        i = m_arpCache.Begin();
+        while (i != m_arpCache.End() && i->second != entry)
         {
-            m_arpCache.erase(i);
-            entry->ClearPendingPacket(); // clear the pending packets for entry's ipaddress
-            delete entry;
-            return;
+            ++i;
         }
     }
+    if (i != m_arpCache.End())
+    {
+        Erase(i);
+        return;
+    }
     NS_LOG_WARN("Entry not found in this ARP Cache");
 }
 
+void
+ArpCache::Erase(Cache::Iterator it)
+{
+    NS_LOG_FUNCTION(this << it->first);
+    ArpCache::Entry* entry = it->second;
+    entry->ClearPendingPacket(); // clear the pending packets for entry's ipaddress
+    if (entry->IsWaitReply())
+    {
+        entry->MarkDead(); // leave the list of the entries in WAIT_REPLY state
+    }
+    m_arpCache.Erase(it);
+}
+
 ArpCache::Entry::Entry(ArpCache* arp)
     : m_arp(arp),
       m_state(ALIVE),
@@ -386,6 +397,21 @@ ArpCache::Entry::Entry(ArpCache* arp)
     NS_LOG_FUNCTION(this << arp);
 }
 
+void
+ArpCache::Entry::SetState(ArpCacheEntryState_e state)
+{
+    NS_LOG_FUNCTION(this << state);
+    if (m_state == WAIT_REPLY && state != WAIT_REPLY)
+    {
+        m_arp->m_waitReplyEntries.erase(m_waitReply);
+    }
+    else if (m_state != WAIT_REPLY && state == WAIT_REPLY)
+    {
+        m_waitReply = m_arp->m_waitReplyEntries.emplace(m_ipv4Address, this).first;
+    }
+    m_state = state;
+}
+
 bool
 ArpCache::Entry::IsDead()
 {
@@ -426,7 +452,7 @@ ArpCache::Entry::MarkDead()
 {
     NS_LOG_FUNCTION(this);
     NS_ASSERT(m_state == ALIVE || m_state == WAIT_REPLY || m_state == DEAD);
-    m_state = DEAD;
+    SetState(DEAD);
     ClearRetries();
     UpdateSeen();
 }
@@ -437,7 +463,7 @@ ArpCache::Entry::MarkAlive(Address macAddress)
     NS_LOG_FUNCTION(this << macAddress);
     NS_ASSERT(m_state == WAIT_REPLY);
     m_macAddress = macAddress;
-    m_state = ALIVE;
+    SetState(ALIVE);
     ClearRetries();
     UpdateSeen();
 }
@@ -448,7 +474,7 @@ ArpCache::Entry::MarkPermanent()
     NS_LOG_FUNCTION(this << m_macAddress);
     NS_ASSERT(!m_macAddress.IsInvalid());
 
-    m_state = PERMANENT;
+    SetState(PERMANENT);
     ClearRetries();
     UpdateSeen();
 }
@@ -459,7 +485,7 @@ ArpCache::Entry::MarkAutoGenerated()
     NS_LOG_FUNCTION(this << m_macAddress);
     NS_ASSERT(!m_macAddress.IsInvalid());
 
-    m_state = STATIC_AUTOGENERATED;
+    SetState(STATIC_AUTOGENERATED);
     ClearRetries();
     UpdateSeen();
 }
@@ -489,7 +515,7 @@ ArpCache::Entry::MarkWaitReply(Ipv4PayloadHeaderPair waiting)
     NS_ASSERT(m_pending.empty());
     NS_ASSERT_MSG(waiting.first, "Can not add a null packet to the ARP queue");
 
-    m_state = WAIT_REPLY;
+    SetState(WAIT_REPLY);
     m_pending.push_back(waiting);
     UpdateSeen();
     m_arp->StartWaitReplyTimer();
@@ -19,6 +19,8 @@
 #ifndef ARP_CACHE_H
 #define ARP_CACHE_H
 
+#include "cache-table.h"
+
 #include "ns3/address.h"
 #include "ns3/callback.h"
 #include "ns3/ipv4-address.h"
@@ -48,6 +50,10 @@ class Ipv4Header;
  *
  * A cached lookup table for translating layer 3 addresses to layer 2.
  * This implementation does lookups from IPv4 to a MAC address
+ *
+ * The entries are kept in a CacheTable, and those in WAIT_REPLY state are
+ * also listed apart, by address, so that the wait reply timer only visits
+ * them.
  */
 class ArpCache : public Object
 {
@@ -302,6 +308,13 @@ class ArpCache : public Object
             STATIC_AUTOGENERATED
         };
 
+        /**
+         * \brief Changes the state of this entry, and keeps the list of the
+         * entries in WAIT_REPLY state of the cache up to date.
+         * \param state the new state
+         */
+        void SetState(ArpCacheEntryState_e state);
+
         /**
          * \brief Returns the entry timeout
          * \returns the entry timeout
@@ -315,20 +328,24 @@ class ArpCache : public Object
         Ipv4Address m_ipv4Address;    //!< entry's IP address
         std::list<Ipv4PayloadHeaderPair> m_pending; //!< list of pending packets for the entry's IP
         uint32_t m_retries;                         //!< rerty counter
+        /** position in the list of the entries in WAIT_REPLY state of the cache */
+        std::map<Ipv4Address, Entry*>::iterator m_waitReply;
     };
 
   private:
     /**
      * \brief ARP Cache container
      */
-    typedef std::map<Ipv4Address, ArpCache::Entry*> Cache;
-    /**
-     * \brief ARP Cache container iterator
-     */
-    typedef std::map<Ipv4Address, ArpCache::Entry*>::iterator CacheI;
+    typedef CacheTable<Ipv4Address, ArpCache::Entry, Ipv4AddressHash> Cache;
 
     void DoDispose() override;
 
+    /**
+     * \brief Remove an entry from the cache and delete it.
+     * \param it iterator on the entry
+     */
+    void Erase(Cache::Iterator it);
+
     Ptr<NetDevice> m_device;        //!< NetDevice associated with the cache
     Ptr<Ipv4Interface> m_interface; //!< Ipv4Interface associated with the cache
     Time m_aliveTimeout;            //!< cache alive state timeout
@@ -349,6 +366,8 @@ class ArpCache : public Object
     Cache m_arpCache;            //!< the ARP cache
     TracedCallback<Ptr<const Packet>>
         m_dropTrace; //!< trace for packets dropped by the ARP cache queue
+
+    std::map<Ipv4Address, ArpCache::Entry*> m_waitReplyEntries; //!< the WAIT_REPLY entries
 };
 
 } // namespace ns3
@@ -0,0 +1,349 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef CACHE_TABLE_H
+#define CACHE_TABLE_H
+
+#include "ns3/assert.h"
+
+#include <algorithm>
+#include <deque>
+#include <new>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup internet
+ * \brief Open addressing hash table of the entries of the ARP and NDISC caches.
+ *
+ * The table maps an address to an entry it owns. The entries are
+ * constructed in place in a std::deque of raw storage, which never moves
+ * them, and the storage of the erased entries is reused, so that the entry
+ * pointers handed out by the caches stay valid until the entry is erased.
+ * The slots of the table hold the key and the pointer to the entry, with
+ * linear probing and backward shift deletion.
+ *
+ * Iterating over the table visits the entries in no particular order;
+ * GetSortedEntries() returns them in key order, as the former std::map did.
+ *
+ * \tparam Key the address type
+ * \tparam Entry the entry type
+ * \tparam Hash the hash function of Key
+ */
+template <typename Key, typename Entry, typename Hash>
+class CacheTable
+{
+  public:
+    /** A slot: the key and the entry, nullptr if the slot is empty. */
+    typedef std::pair<Key, Entry*> Slot;
+
+    /** Iterator over the entries of the table. */
+    class Iterator
+    {
+      public:
+        /**
+         * \param slot the current slot
+         * \param end the end of the slots
+         */
+        Iterator(const Slot* slot, const Slot* end)
+            : m_slot(slot),
+              m_end(end)
+        {
+            Skip();
+        }
+
+        /** \return the current slot */
+        const Slot& operator*() const
+        {
+            return *m_slot;
+        }
+
+        /** \return the current slot */
+        const Slot* operator->() const
+        {
+            return m_slot;
+        }
+
+        /** \return the iterator on the next entry */
+        Iterator& operator++()
+        {
+            m_slot++;
+            Skip();
+            return *this;
+        }
+
+        /**
+         * \param other the iterator to compare to
+         * \return true if the iterators differ
+         */
+        bool operator!=(const Iterator& other) const
+        {
+            return m_slot != other.m_slot;
+        }
+
+        /**
+         * \param other the iterator to compare to
+         * \return true if the iterators are the same
+         */
+        bool operator==(const Iterator& other) const
+        {
+            return m_slot == other.m_slot;
+        }
+
+      private:
+        friend class CacheTable;
+
+        /** Skip the empty slots. */
+        void Skip()
+        {
+            while (m_slot != m_end && !m_slot->second)
+            {
+                m_slot++;
+            }
+        }
+
+        const Slot* m_slot; //!< current slot
+        const Slot* m_end;  //!< end of the slots
+    };
+
+    CacheTable() = default;
+
+    ~CacheTable()
+    {
+        Clear();
+    }
+
+    // Delete copy constructor and assignment operator, the table owns the entries
+    CacheTable(const CacheTable&) = delete;
+    CacheTable& operator=(const CacheTable&) = delete;
+
+    /** \return an iterator on the first entry */
+    Iterator Begin() const
+    {
+        return Iterator(m_slots.data(), m_slots.data() + m_slots.size());
+    }
+
+    /** \return the iterator past the last entry */
+    Iterator End() const
+    {
+        return Iterator(m_slots.data() + m_slots.size(), m_slots.data() + m_slots.size());
+    }
+
+    /** \return the number of entries */
+    std::size_t GetSize() const
+    {
+        return m_size;
+    }
+
+    /** \return the entries, sorted by key */
+    std::vector<Entry*> GetSortedEntries() const
+    {
+        std::vector<Slot> slots;
+        slots.reserve(m_size);
+        for (auto i = Begin(); i != End(); ++i)
+        {
+            slots.push_back(*i);
+        }
+        std::sort(slots.begin(), slots.end(), [](const Slot& a, const Slot& b) {
+            return a.first < b.first;
+        });
+        std::vector<Entry*> entries;
+        entries.reserve(m_size);
+        for (const auto& slot : slots)
+        {
+            entries.push_back(slot.second);
+        }
+        return entries;
+    }
+
+    /**
+     * \param key the key
+     * \return the entry of the key, nullptr if there is none
+     */
+    Entry* Lookup(const Key& key) const
+    {
+        if (m_size == 0)
+        {
+            return nullptr;
+        }
+        for (std::size_t i = GetHome(key);; i = (i + 1) & m_mask)
+        {
+            const Slot& slot = m_slots[i];
+            if (!slot.second || slot.first == key)
+            {
+                return slot.second;
+            }
+        }
+    }
+
+    /**
+     * \param key the key
+     * \return an iterator on the entry of the key, End() if there is none
+     */
+    Iterator Find(const Key& key) const
+    {
+        if (m_size != 0)
+        {
+            for (std::size_t i = GetHome(key); m_slots[i].second; i = (i + 1) & m_mask)
+            {
+                if (m_slots[i].first == key)
+                {
+                    return Iterator(&m_slots[i], m_slots.data() + m_slots.size());
+                }
+            }
+        }
+        return End();
+    }
+
+    /**
+     * Create the entry of a key, which must not be in the table.
+     *
+     * \param key the key
+     * \param args the arguments of the constructor of the entry
+     * \return the new entry
+     */
+    template <typename... Args>
+    Entry* Emplace(const Key& key, Args&&... args)
+    {
+        NS_ASSERT(!Lookup(key));
+        if ((m_size + 1) * 4 > m_slots.size() * 3)
+        {
+            Grow();
+        }
+        void* storage;
+        if (m_free.empty())
+        {
+            m_blocks.emplace_back();
+            storage = &m_blocks.back();
+        }
+        else
+        {
+            storage = m_free.back();
+            m_free.pop_back();
+        }
+        auto entry = new (storage) Entry(std::forward<Args>(args)...);
+        Insert(Slot(key, entry));
+        m_size++;
+        return entry;
+    }
+
+    /**
+     * Destroy an entry. The iterators on the table are invalidated.
+     *
+     * \param it an iterator on the entry
+     */
+    void Erase(Iterator it)
+    {
+        NS_ASSERT(it != End());
+        std::size_t i = it.m_slot - m_slots.data();
+        Entry* entry = m_slots[i].second;
+        // backward shift of the entries which follow in the cluster
+        for (std::size_t j = (i + 1) & m_mask; m_slots[j].second; j = (j + 1) & m_mask)
+        {
+            std::size_t home = GetHome(m_slots[j].first);
+            if (((j - home) & m_mask) >= ((j - i) & m_mask))
+            {
+                m_slots[i] = m_slots[j];
+                i = j;
+            }
+        }
+        m_slots[i] = Slot(Key(), nullptr);
+        m_size--;
+        entry->~Entry();
+        m_free.push_back(entry);
+    }
+
+    /** Destroy all the entries. */
+    void Clear()
+    {
+        for (auto& slot : m_slots)
+        {
+            if (slot.second)
+            {
+                slot.second->~Entry();
+                slot = Slot(Key(), nullptr);
+            }
+        }
+        m_size = 0;
+        m_free.clear();
+        m_blocks.clear();
+    }
+
+  private:
+    /** Raw storage of an entry. */
+    struct Block
+    {
+        alignas(Entry) unsigned char data[sizeof(Entry)]; //!< the storage
+    };
+
+    /**
+     * \param key the key
+     * \return the first slot to probe for the key
+     */
+    std::size_t GetHome(const Key& key) const
+    {
+        return static_cast<std::size_t>((uint64_t(Hash()(key)) * 0x9e3779b97f4a7c15ULL) >>
+                                        m_shift);
+    }
+
+    /**
+     * Insert a slot in the first free slot of its probe sequence.
+     *
+     * \param slot the slot
+     */
+    void Insert(const Slot& slot)
+    {
+        std::size_t i = GetHome(slot.first);
+        while (m_slots[i].second)
+        {
+            i = (i + 1) & m_mask;
+        }
+        m_slots[i] = slot;
+    }
+
+    /** Double the number of slots. */
+    void Grow()
+    {
+        std::vector<Slot> slots(m_slots.empty() ? 16 : 2 * m_slots.size(), Slot(Key(), nullptr));
+        slots.swap(m_slots);
+        m_mask = m_slots.size() - 1;
+        m_shift = 64;
+        for (std::size_t n = m_slots.size(); n > 1; n >>= 1)
+        {
+            m_shift--;
+        }
+        for (const auto& slot : slots)
+        {
+            if (slot.second)
+            {
+                Insert(slot);
+            }
+        }
+    }
+
+    std::vector<Slot> m_slots;  //!< the slots, a power of two
+    std::size_t m_mask{0};      //!< number of slots minus one
+    unsigned m_shift{64};       //!< shift of the hash to get the home slot
+    std::size_t m_size{0};      //!< number of entries
+    std::deque<Block> m_blocks; //!< storage of the entries, never moved
+    std::vector<void*> m_free;  //!< storage of the erased entries
+};
+
+} // namespace ns3
+
+#endif /* CACHE_TABLE_H */
@@ -30,13 +30,17 @@
 
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
+#include "ns3/global-value.h"
 #include "ns3/log.h"
 #include "ns3/node-list.h"
 #include "ns3/simulator.h"
+#include "ns3/uinteger.h"
 
 #include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <queue>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -45,6 +49,17 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("GlobalRouteManagerImpl");
 
+/**
+ * \ingroup globalrouting
+ * The number of threads running the SPF calculations of the routers.
+ */
+static GlobalValue g_globalRoutingThreads =
+    GlobalValue("GlobalRoutingThreads",
+                "The number of threads running the SPF calculations of the routers "
+                "when the global routing tables are computed.",
+                UintegerValue(1),
+                MakeUintegerChecker<uint32_t>(1));
+
 /**
  * \brief Stream insertion operator.
  *
@@ -496,12 +511,10 @@ GlobalRouteManagerLSDB::GetLSA(Ipv4Address addr) const
     //
     // Look up an LSA by its address.
     //
-    for (auto i = m_database.begin(); i != m_database.end(); i++)
+    auto i = m_database.find(addr);
+    if (i != m_database.end())
     {
-        if (i->first == addr)
-        {
-            return i->second;
-        }
+        return i->second;
     }
     return nullptr;
 }
@@ -537,16 +550,27 @@ GlobalRouteManagerLSDB::GetLSAByLinkData(Ipv4Address addr) const
 // ---------------------------------------------------------------------------
 
 GlobalRouteManagerImpl::GlobalRouteManagerImpl()
-    : m_spfroot(nullptr)
+    : m_spfroot(nullptr),
+      m_ownLsdb(true),
+      m_root{}
 {
     NS_LOG_FUNCTION(this);
     m_lsdb = new GlobalRouteManagerLSDB();
 }
 
+GlobalRouteManagerImpl::GlobalRouteManagerImpl(GlobalRouteManagerLSDB* lsdb)
+    : m_spfroot(nullptr),
+      m_lsdb(lsdb),
+      m_ownLsdb(false),
+      m_root{}
+{
+    NS_LOG_FUNCTION(this << lsdb);
+}
+
 GlobalRouteManagerImpl::~GlobalRouteManagerImpl()
 {
     NS_LOG_FUNCTION(this);
-    if (m_lsdb)
+    if (m_lsdb && m_ownLsdb)
     {
         delete m_lsdb;
     }
@@ -696,6 +720,7 @@ GlobalRouteManagerImpl::InitializeRoutes()
     // Walk the list of nodes in the system.
     //
     NS_LOG_INFO("About to start SPF calculation");
+    std::vector<SPFRoot> roots;
     for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
     {
         Ptr<Node> node = *i;
@@ -718,12 +743,140 @@ GlobalRouteManagerImpl::InitializeRoutes()
         //
         if (rtr && rtr->GetNumLSAs())
         {
-            SPFCalculate(rtr->GetRouterId());
+            roots.push_back(GetSPFRoot(node));
+        }
+    }
+
+    UintegerValue threads;
+    g_globalRoutingThreads.GetValue(threads);
+    uint32_t nThreads = std::min<std::size_t>(threads.Get(), roots.size());
+    if (nThreads <= 1)
+    {
+        for (const auto& root : roots)
+        {
+            SPFCalculate(root);
+            InstallRoutes(root, m_routes);
         }
+        NS_LOG_INFO("Finished SPF calculation");
+        return;
+    }
+
+    //
+    // Each thread takes the next root, runs its SPF calculation with its own
+    // worker and keeps the routes found.  The routes are added once all the
+    // calculations are done, in the order of the nodes.
+    //
+    NS_LOG_INFO("Running the SPF calculations in " << nThreads << " threads");
+    std::vector<std::vector<SPFRoute>> routes(roots.size());
+    std::atomic<std::size_t> next{0};
+    auto calculate = [this, &roots, &routes, &next]() {
+        GlobalRouteManagerImpl worker(m_lsdb);
+        for (std::size_t i = next++; i < roots.size(); i = next++)
+        {
+            worker.SPFCalculate(roots[i]);
+            routes[i].swap(worker.m_routes);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (uint32_t i = 1; i < nThreads; i++)
+    {
+        pool.emplace_back(calculate);
+    }
+    calculate();
+    for (auto& thread : pool)
+    {
+        thread.join();
+    }
+    for (std::size_t i = 0; i < roots.size(); i++)
+    {
+        InstallRoutes(roots[i], routes[i]);
     }
     NS_LOG_INFO("Finished SPF calculation");
 }
 
+GlobalRouteManagerImpl::SPFRoot
+GlobalRouteManagerImpl::GetSPFRoot(Ptr<Node> node) const
+{
+    NS_LOG_FUNCTION(this << node);
+    Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter>();
+    NS_ASSERT(rtr);
+    Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
+    NS_ASSERT_MSG(ipv4,
+                  "GlobalRouteManagerImpl::GetSPFRoot (): "
+                  "GetObject for <Ipv4> interface failed");
+    return {rtr->GetRouterId(),
+            node->GetId(),
+            PeekPointer(ipv4),
+            PeekPointer(rtr->GetRoutingProtocol())};
+}
+
+GlobalRouteManagerImpl::SPFRoot
+GlobalRouteManagerImpl::GetSPFRoot(Ipv4Address routerId) const
+{
+    NS_LOG_FUNCTION(this << routerId);
+    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    {
+        Ptr<Node> node = *i;
+        Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter>();
+        if (rtr && rtr->GetRouterId() == routerId)
+        {
+            return GetSPFRoot(node);
+        }
+    }
+    NS_LOG_LOGIC("No node with router id " << routerId);
+    return {routerId, 0, nullptr, nullptr};
+}
+
+GlobalRoutingLSA::SPFStatus
+GlobalRouteManagerImpl::GetLSAStatus(const GlobalRoutingLSA* lsa) const
+{
+    auto i = m_lsaStatus.find(lsa);
+    return i == m_lsaStatus.end() ? GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED : i->second;
+}
+
+void
+GlobalRouteManagerImpl::SetLSAStatus(const GlobalRoutingLSA* lsa,
+                                     GlobalRoutingLSA::SPFStatus status)
+{
+    m_lsaStatus[lsa] = status;
+}
+
+void
+GlobalRouteManagerImpl::AddRoute(SPFRoute::Type type,
+                                 Ipv4Address dest,
+                                 Ipv4Mask mask,
+                                 Ipv4Address nextHop,
+                                 uint32_t interface)
+{
+    NS_LOG_FUNCTION(this << type << dest << mask << nextHop << interface);
+    m_routes.push_back({type, dest, mask, nextHop, interface});
+}
+
+void
+GlobalRouteManagerImpl::InstallRoutes(const SPFRoot& root, const std::vector<SPFRoute>& routes)
+{
+    NS_LOG_FUNCTION(this << root.routerId << routes.size());
+    NS_ASSERT(root.routing || routes.empty());
+    for (const auto& route : routes)
+    {
+        switch (route.type)
+        {
+        case SPFRoute::HOST:
+            root.routing->AddHostRouteTo(route.dest, route.nextHop, route.interface);
+            break;
+        case SPFRoute::NETWORK:
+            root.routing->AddNetworkRouteTo(route.dest, route.mask, route.nextHop, route.interface);
+            break;
+        case SPFRoute::EXTERNAL:
+            root.routing->AddASExternalRouteTo(route.dest,
+                                               route.mask,
+                                               route.nextHop,
+                                               route.interface);
+            break;
+        }
+    }
+}
+
 //
 // This method is derived from quagga ospf_spf_next ().  See RFC2328 Section
 // 16.1 (2) for further details.
@@ -827,7 +980,7 @@ GlobalRouteManagerImpl::SPFNext(SPFVertex* v, CandidateQueue& candidate)
         // If the link is to a router that is already in the shortest path first tree
         // then we have it covered -- ignore it.
         //
-        if (w_lsa->GetStatus() == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE)
+        if (GetLSAStatus(w_lsa) == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE)
         {
             NS_LOG_LOGIC("Skipping ->  LSA " << w_lsa->GetLinkStateId() << " already in SPF tree");
             continue;
@@ -851,7 +1004,7 @@ GlobalRouteManagerImpl::SPFNext(SPFVertex* v, CandidateQueue& candidate)
         NS_LOG_LOGIC("Considering w_lsa " << w_lsa->GetLinkStateId());
 
         // Is there already vertex w in candidate list?
-        if (w_lsa->GetStatus() == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
+        if (GetLSAStatus(w_lsa) == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
         {
             // Calculate nexthop to w
             // We need to figure out how to actually get to the new router represented
@@ -863,7 +1016,7 @@ GlobalRouteManagerImpl::SPFNext(SPFVertex* v, CandidateQueue& candidate)
             w = new SPFVertex(w_lsa);
             if (SPFNexthopCalculation(v, w, l, distance))
             {
-                w_lsa->SetStatus(GlobalRoutingLSA::LSA_SPF_CANDIDATE);
+                SetLSAStatus(w_lsa, GlobalRoutingLSA::LSA_SPF_CANDIDATE);
                 //
                 // Push this new vertex onto the priority queue (ordered by distance from the
                 // root node).
@@ -880,7 +1033,7 @@ GlobalRouteManagerImpl::SPFNext(SPFVertex* v, CandidateQueue& candidate)
                                   << "return false, but it does now!");
             }
         }
-        else if (w_lsa->GetStatus() == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
+        else if (GetLSAStatus(w_lsa) == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
         {
             //
             // We have already considered the link represented by <w>.  What wse have to
@@ -1234,7 +1387,9 @@ void
 GlobalRouteManagerImpl::DebugSPFCalculate(Ipv4Address root)
 {
     NS_LOG_FUNCTION(this << root);
-    SPFCalculate(root);
+    SPFRoot spfRoot = GetSPFRoot(root);
+    SPFCalculate(spfRoot);
+    InstallRoutes(spfRoot, m_routes);
 }
 
 //
@@ -1307,14 +1462,12 @@ GlobalRouteManagerImpl::CheckForStubNode(Ipv4Address root)
                 if (lr->GetLinkId() == myRouterId)
                 {
                     // Next hop is stored in the LinkID field of lr
-                    Ptr<GlobalRouter> router = rlsa->GetNode()->GetObject<GlobalRouter>();
-                    NS_ASSERT(router);
-                    Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol();
-                    NS_ASSERT(gr);
-                    gr->AddNetworkRouteTo(Ipv4Address("0.0.0.0"),
-                                          Ipv4Mask("0.0.0.0"),
-                                          lr->GetLinkData(),
-                                          FindOutgoingInterfaceId(transitLink->GetLinkData()));
+                    NS_ASSERT(m_root.routing);
+                    AddRoute(SPFRoute::NETWORK,
+                             Ipv4Address("0.0.0.0"),
+                             Ipv4Mask("0.0.0.0"),
+                             lr->GetLinkData(),
+                             FindOutgoingInterfaceId(transitLink->GetLinkData()));
                     NS_LOG_LOGIC("Inserting default route for node "
                                  << myRouterId << " to next hop " << lr->GetLinkData()
                                  << " via interface "
@@ -1329,15 +1482,19 @@ GlobalRouteManagerImpl::CheckForStubNode(Ipv4Address root)
 
 // quagga ospf_spf_calculate
 void
-GlobalRouteManagerImpl::SPFCalculate(Ipv4Address root)
+GlobalRouteManagerImpl::SPFCalculate(const SPFRoot& root)
 {
-    NS_LOG_FUNCTION(this << root);
+    NS_LOG_FUNCTION(this << root.routerId);
 
     SPFVertex* v;
     //
-    // Initialize the Link State Database.
+    // Initialize the state of the calculation.  The status of the LSAs is
+    // kept by the manager rather than in the Link State Database, which may be
+    // shared with the calculations of other roots.
     //
-    m_lsdb->Initialize();
+    m_root = root;
+    m_lsaStatus.clear();
+    m_routes.clear();
     //
     // The candidate queue is a priority queue of SPFVertex objects, with the top
     // of the queue being the closest vertex in terms of distance from the root
@@ -1350,26 +1507,28 @@ GlobalRouteManagerImpl::SPFCalculate(Ipv4Address root)
     // calculation.  Each router (and corresponding network) is a vertex in the
     // shortest path first (SPF) tree.
     //
-    v = new SPFVertex(m_lsdb->GetLSA(root));
+    v = new SPFVertex(m_lsdb->GetLSA(root.routerId));
     //
     // This vertex is the root of the SPF tree and it is distance 0 from the root.
     // We also mark this vertex as being in the SPF tree.
     //
     m_spfroot = v;
     v->SetDistanceFromRoot(0);
-    v->GetLSA()->SetStatus(GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
-    NS_LOG_LOGIC("Starting SPFCalculate for node " << root);
+    SetLSAStatus(v->GetLSA(), GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+    NS_LOG_LOGIC("Starting SPFCalculate for node " << root.routerId);
 
     //
     // Optimize SPF calculation, for ns-3.
     // We do not need to calculate SPF for every node in the network if this
     // node has only one interface through which another router can be
     // reached.  Instead, short-circuit this computation and just install
-    // a default route in the CheckForStubNode() method.
+    // a default route in the CheckForStubNode() method.  The unit tests run
+    // the calculation on an LSDB without nodes, in which case there is no
+    // route to install.
     //
-    if (NodeList::GetNNodes() > 0 && CheckForStubNode(root))
+    if (root.routing && CheckForStubNode(root.routerId))
     {
-        NS_LOG_LOGIC("SPFCalculate truncated for stub node " << root);
+        NS_LOG_LOGIC("SPFCalculate truncated for stub node " << root.routerId);
         delete m_spfroot;
         return;
     }
@@ -1418,7 +1577,7 @@ GlobalRouteManagerImpl::SPFCalculate(Ipv4Address root)
         // Update the status field of the vertex to indicate that it is in the SPF
         // tree.
         //
-        v->GetLSA()->SetStatus(GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+        SetLSAStatus(v->GetLSA(), GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
         //
         // The current vertex has a parent pointer.  By calling this rather oddly
         // named method (blame quagga) we add the current vertex to the list of
@@ -1548,103 +1707,64 @@ GlobalRouteManagerImpl::SPFAddASExternal(GlobalRoutingLSA* extlsa, SPFVertex* v)
 
     NS_LOG_LOGIC("Vertex ID = " << routerId);
     //
-    // We need to walk the list of nodes looking for the one that has the router
-    // ID corresponding to the root vertex.  This is the one we're going to write
-    // the routing information to.
+    // The routes are written to the routing table of the root, which is the
+    // node with this router ID, if there is one.
     //
-    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    if (!m_root.routing)
     {
-        Ptr<Node> node = *i;
-        //
-        // The router ID is accessible through the GlobalRouter interface, so we need
-        // to QI for that interface.  If there's no GlobalRouter interface, the node
-        // in question cannot be the router we want, so we continue.
-        //
-        Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter>();
+        NS_LOG_LOGIC("No node with router ID " << routerId);
+        return;
+    }
+    NS_LOG_LOGIC("Setting routes for node " << m_root.nodeId);
+    //
+    // Get the Global Router Link State Advertisement from the vertex we're
+    // adding the routes to.  The LSA will have a number of attached Global Router
+    // Link Records corresponding to links off of that vertex / node.  We're going
+    // to be interested in the records corresponding to point-to-point links.
+    //
+    NS_ASSERT_MSG(v->GetLSA(),
+                  "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                  "Expected valid LSA in SPFVertex* v");
+    Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask();
+    Ipv4Address tempip = extlsa->GetLinkStateId();
+    tempip = tempip.CombineMask(tempmask);
 
-        if (!rtr)
+    //
+    // Here's why we did all of that work.  We're going to add a host route to the
+    // host address found in the m_linkData field of the point-to-point link
+    // record.  In the case of a point-to-point link, this is the local IP address
+    // of the node connected to the link.  Each of these point-to-point links
+    // will correspond to a local interface that has an IP address to which
+    // the node at the root of the SPF tree can send packets.  The vertex <v>
+    // (corresponding to the node that has these links and interfaces) has
+    // an m_nextHop address precalculated for us that is the address to which the
+    // root node should send packets to be forwarded to these IP addresses.
+    // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
+    // which the packets should be send for forwarding.
+    //
+    // walk through all next-hop-IPs and out-going-interfaces for reaching
+    // the stub network gateway 'v' from the root node
+    for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
+    {
+        SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
+        Ipv4Address nextHop = exit.first;
+        int32_t outIf = exit.second;
+        if (outIf >= 0)
         {
-            NS_LOG_LOGIC("No GlobalRouter interface on node " << node->GetId());
-            continue;
+            AddRoute(SPFRoute::EXTERNAL, tempip, tempmask, nextHop, outIf);
+            NS_LOG_LOGIC("(Route " << i << ") Node " << m_root.nodeId
+                                   << " add external network route to " << tempip
+                                   << " using next hop " << nextHop << " via interface "
+                                   << outIf);
         }
-        //
-        // If the router ID of the current node is equal to the router ID of the
-        // root of the SPF tree, then this node is the one for which we need to
-        // write the routing tables.
-        //
-        NS_LOG_LOGIC("Considering router " << rtr->GetRouterId());
-
-        if (rtr->GetRouterId() == routerId)
+        else
         {
-            NS_LOG_LOGIC("Setting routes for node " << node->GetId());
-            //
-            // Routing information is updated using the Ipv4 interface.  We need to QI
-            // for that interface.  If the node is acting as an IP version 4 router, it
-            // should absolutely have an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                          "QI for <Ipv4> interface failed");
-            //
-            // Get the Global Router Link State Advertisement from the vertex we're
-            // adding the routes to.  The LSA will have a number of attached Global Router
-            // Link Records corresponding to links off of that vertex / node.  We're going
-            // to be interested in the records corresponding to point-to-point links.
-            //
-            NS_ASSERT_MSG(v->GetLSA(),
-                          "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                          "Expected valid LSA in SPFVertex* v");
-            Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask();
-            Ipv4Address tempip = extlsa->GetLinkStateId();
-            tempip = tempip.CombineMask(tempmask);
-
-            //
-            // Here's why we did all of that work.  We're going to add a host route to the
-            // host address found in the m_linkData field of the point-to-point link
-            // record.  In the case of a point-to-point link, this is the local IP address
-            // of the node connected to the link.  Each of these point-to-point links
-            // will correspond to a local interface that has an IP address to which
-            // the node at the root of the SPF tree can send packets.  The vertex <v>
-            // (corresponding to the node that has these links and interfaces) has
-            // an m_nextHop address precalculated for us that is the address to which the
-            // root node should send packets to be forwarded to these IP addresses.
-            // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-            // which the packets should be send for forwarding.
-            //
-            Ptr<GlobalRouter> router = node->GetObject<GlobalRouter>();
-            if (!router)
-            {
-                continue;
-            }
-            Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol();
-            NS_ASSERT(gr);
-            // walk through all next-hop-IPs and out-going-interfaces for reaching
-            // the stub network gateway 'v' from the root node
-            for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
-            {
-                SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
-                Ipv4Address nextHop = exit.first;
-                int32_t outIf = exit.second;
-                if (outIf >= 0)
-                {
-                    gr->AddASExternalRouteTo(tempip, tempmask, nextHop, outIf);
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " add external network route to " << tempip
-                                           << " using next hop " << nextHop << " via interface "
-                                           << outIf);
-                }
-                else
-                {
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " NOT able to add network route to " << tempip
-                                           << " using next hop " << nextHop
-                                           << " since outgoing interface id is negative");
-                }
-            }
-            return;
-        } // if
-    }     // for
+            NS_LOG_LOGIC("(Route " << i << ") Node " << m_root.nodeId
+                                   << " NOT able to add network route to " << tempip
+                                   << " using next hop " << nextHop
+                                   << " since outgoing interface id is negative");
+        }
+    }
 }
 
 // Processing logic from RFC 2328, page 166 and quagga ospf_spf_process_stubs ()
@@ -1712,106 +1832,66 @@ GlobalRouteManagerImpl::SPFIntraAddStub(GlobalRoutingLinkRecord* l, SPFVertex* v
 
     NS_LOG_LOGIC("Vertex ID = " << routerId);
     //
-    // We need to walk the list of nodes looking for the one that has the router
-    // ID corresponding to the root vertex.  This is the one we're going to write
-    // the routing information to.
+    // The routes are written to the routing table of the root, which is the
+    // node with this router ID, if there is one.
     //
-    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    if (!m_root.routing)
     {
-        Ptr<Node> node = *i;
-        //
-        // The router ID is accessible through the GlobalRouter interface, so we need
-        // to QI for that interface.  If there's no GlobalRouter interface, the node
-        // in question cannot be the router we want, so we continue.
-        //
-        Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter>();
+        NS_LOG_LOGIC("No node with router ID " << routerId);
+        return;
+    }
+    NS_LOG_LOGIC("Setting routes for node " << m_root.nodeId);
+    //
+    // Get the Global Router Link State Advertisement from the vertex we're
+    // adding the routes to.  The LSA will have a number of attached Global Router
+    // Link Records corresponding to links off of that vertex / node.  We're going
+    // to be interested in the records corresponding to point-to-point links.
+    //
+    NS_ASSERT_MSG(v->GetLSA(),
+                  "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                  "Expected valid LSA in SPFVertex* v");
+    Ipv4Mask tempmask(l->GetLinkData().Get());
+    Ipv4Address tempip = l->GetLinkId();
+    tempip = tempip.CombineMask(tempmask);
+    //
+    // Here's why we did all of that work.  We're going to add a host route to the
+    // host address found in the m_linkData field of the point-to-point link
+    // record.  In the case of a point-to-point link, this is the local IP address
+    // of the node connected to the link.  Each of these point-to-point links
+    // will correspond to a local interface that has an IP address to which
+    // the node at the root of the SPF tree can send packets.  The vertex <v>
+    // (corresponding to the node that has these links and interfaces) has
+    // an m_nextHop address precalculated for us that is the address to which the
+    // root node should send packets to be forwarded to these IP addresses.
+    // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
+    // which the packets should be send for forwarding.
+    //
 
-        if (!rtr)
+    // walk through all next-hop-IPs and out-going-interfaces for reaching
+    // the stub network gateway 'v' from the root node
+    for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
+    {
+        SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
+        Ipv4Address nextHop = exit.first;
+        int32_t outIf = exit.second;
+        if (outIf >= 0)
         {
-            NS_LOG_LOGIC("No GlobalRouter interface on node " << node->GetId());
-            continue;
+            AddRoute(SPFRoute::NETWORK, tempip, tempmask, nextHop, outIf);
+            NS_LOG_LOGIC("(Route " << i << ") Node " << m_root.nodeId
+                                   << " add network route to " << tempip
+                                   << " using next hop " << nextHop << " via interface "
+                                   << outIf);
         }
-        //
-        // If the router ID of the current node is equal to the router ID of the
-        // root of the SPF tree, then this node is the one for which we need to
-        // write the routing tables.
-        //
-        NS_LOG_LOGIC("Considering router " << rtr->GetRouterId());
-
-        if (rtr->GetRouterId() == routerId)
+        else
         {
-            NS_LOG_LOGIC("Setting routes for node " << node->GetId());
-            //
-            // Routing information is updated using the Ipv4 interface.  We need to QI
-            // for that interface.  If the node is acting as an IP version 4 router, it
-            // should absolutely have an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                          "QI for <Ipv4> interface failed");
-            //
-            // Get the Global Router Link State Advertisement from the vertex we're
-            // adding the routes to.  The LSA will have a number of attached Global Router
-            // Link Records corresponding to links off of that vertex / node.  We're going
-            // to be interested in the records corresponding to point-to-point links.
-            //
-            NS_ASSERT_MSG(v->GetLSA(),
-                          "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                          "Expected valid LSA in SPFVertex* v");
-            Ipv4Mask tempmask(l->GetLinkData().Get());
-            Ipv4Address tempip = l->GetLinkId();
-            tempip = tempip.CombineMask(tempmask);
-            //
-            // Here's why we did all of that work.  We're going to add a host route to the
-            // host address found in the m_linkData field of the point-to-point link
-            // record.  In the case of a point-to-point link, this is the local IP address
-            // of the node connected to the link.  Each of these point-to-point links
-            // will correspond to a local interface that has an IP address to which
-            // the node at the root of the SPF tree can send packets.  The vertex <v>
-            // (corresponding to the node that has these links and interfaces) has
-            // an m_nextHop address precalculated for us that is the address to which the
-            // root node should send packets to be forwarded to these IP addresses.
-            // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-            // which the packets should be send for forwarding.
-            //
-
-            Ptr<GlobalRouter> router = node->GetObject<GlobalRouter>();
-            if (!router)
-            {
-                continue;
-            }
-            Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol();
-            NS_ASSERT(gr);
-            // walk through all next-hop-IPs and out-going-interfaces for reaching
-            // the stub network gateway 'v' from the root node
-            for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
-            {
-                SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
-                Ipv4Address nextHop = exit.first;
-                int32_t outIf = exit.second;
-                if (outIf >= 0)
-                {
-                    gr->AddNetworkRouteTo(tempip, tempmask, nextHop, outIf);
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " add network route to " << tempip
-                                           << " using next hop " << nextHop << " via interface "
-                                           << outIf);
-                }
-                else
-                {
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " NOT able to add network route to " << tempip
-                                           << " using next hop " << nextHop
-                                           << " since outgoing interface id is negative");
-                }
-            }
-            return;
-        } // if
-    }     // for
+            NS_LOG_LOGIC("(Route " << i << ") Node " << m_root.nodeId
+                                   << " NOT able to add network route to " << tempip
+                                   << " using next hop " << nextHop
+                                   << " since outgoing interface id is negative");
+        }
+    }
 }
 
-//
 // Return the interface number corresponding to a given IP address and mask
 // This is a wrapper around GetInterfaceForPrefix(), but we first
 // have to find the right node pointer to pass to that function.
@@ -1832,58 +1912,29 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId(Ipv4Address a, Ipv4Mask amask)
     //
     Ipv4Address routerId = m_spfroot->GetVertexId();
     //
-    // Walk the list of nodes in the system looking for the one corresponding to
-    // the node at the root of the SPF tree.  This is the node for which we are
-    // building the routing table.
+    // The IPv4 stack of the node at the root of the SPF tree has been found
+    // when the calculation started, if there is such a node.
     //
-    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    if (!m_root.ipv4)
     {
-        Ptr<Node> node = *i;
-
-        Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter>();
-        //
-        // If the node doesn't have a GlobalRouter interface it can't be the one
-        // we're interested in.
-        //
-        if (!rtr)
-        {
-            continue;
-        }
-
-        if (rtr->GetRouterId() == routerId)
-        {
-            //
-            // This is the node we're building the routing table for.  We're going to need
-            // the Ipv4 interface to look for the ipv4 interface index.  Since this node
-            // is participating in routing IP version 4 packets, it certainly must have
-            // an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
-                          "GetObject for <Ipv4> interface failed");
-            //
-            // Look through the interfaces on this node for one that has the IP address
-            // we're looking for.  If we find one, return the corresponding interface
-            // index, or -1 if not found.
-            //
-            int32_t interface = ipv4->GetInterfaceForPrefix(a, amask);
-
-#if 0
-          if (interface < 0)
-            {
-              NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
-            }
-#endif
-            return interface;
-        }
+        NS_LOG_LOGIC("FindOutgoingInterfaceId():Can't find root node " << routerId);
+        return -1;
     }
     //
-    // Couldn't find it.
+    // Look through the interfaces on this node for one that has the IP address
+    // we're looking for.  If we find one, return the corresponding interface
+    // index, or -1 if not found.
     //
-    NS_LOG_LOGIC("FindOutgoingInterfaceId():Can't find root node " << routerId);
-    return -1;
+    int32_t interface = m_root.ipv4->GetInterfaceForPrefix(a, amask);
+
+#if 0
+  if (interface < 0)
+    {
+      NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
+                      "Expected an interface associated with address a:" << a);
+    }
+#endif
+    return interface;
 }
 
 //
@@ -1919,128 +1970,86 @@ GlobalRouteManagerImpl::SPFIntraAddRouter(SPFVertex* v)
 
     NS_LOG_LOGIC("Vertex ID = " << routerId);
     //
-    // We need to walk the list of nodes looking for the one that has the router
-    // ID corresponding to the root vertex.  This is the one we're going to write
-    // the routing information to.
+    // The routes are written to the routing table of the root, which is the
+    // node with this router ID, if there is one.
     //
-    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    if (!m_root.routing)
+    {
+        NS_LOG_LOGIC("No node with router ID " << routerId);
+        return;
+    }
+    NS_LOG_LOGIC("Setting routes for node " << m_root.nodeId);
+    //
+    // Get the Global Router Link State Advertisement from the vertex we're
+    // adding the routes to.  The LSA will have a number of attached Global Router
+    // Link Records corresponding to links off of that vertex / node.  We're going
+    // to be interested in the records corresponding to point-to-point links.
+    //
+    GlobalRoutingLSA* lsa = v->GetLSA();
+    NS_ASSERT_MSG(lsa,
+                  "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                  "Expected valid LSA in SPFVertex* v");
+
+    uint32_t nLinkRecords = lsa->GetNLinkRecords();
+    //
+    // Iterate through the link records on the vertex to which we're going to add
+    // routes.  To make sure we're being clear, we're going to add routing table
+    // entries to the tables on the node corresping to the root of the SPF tree.
+    // These entries will have routes to the IP addresses we find from looking at
+    // the local side of the point-to-point links found on the node described by
+    // the vertex <v>.
+    //
+    NS_LOG_LOGIC(" Node " << m_root.nodeId << " found " << nLinkRecords
+                          << " link records in LSA " << lsa << "with LinkStateId "
+                          << lsa->GetLinkStateId());
+    for (uint32_t j = 0; j < nLinkRecords; ++j)
     {
-        Ptr<Node> node = *i;
         //
-        // The router ID is accessible through the GlobalRouter interface, so we need
-        // to GetObject for that interface.  If there's no GlobalRouter interface,
-        // the node in question cannot be the router we want, so we continue.
+        // We are only concerned about point-to-point links
         //
-        Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter>();
-
-        if (!rtr)
+        GlobalRoutingLinkRecord* lr = lsa->GetLinkRecord(j);
+        if (lr->GetLinkType() != GlobalRoutingLinkRecord::PointToPoint)
         {
-            NS_LOG_LOGIC("No GlobalRouter interface on node " << node->GetId());
             continue;
         }
         //
-        // If the router ID of the current node is equal to the router ID of the
-        // root of the SPF tree, then this node is the one for which we need to
-        // write the routing tables.
+        // Here's why we did all of that work.  We're going to add a host route to the
+        // host address found in the m_linkData field of the point-to-point link
+        // record.  In the case of a point-to-point link, this is the local IP address
+        // of the node connected to the link.  Each of these point-to-point links
+        // will correspond to a local interface that has an IP address to which
+        // the node at the root of the SPF tree can send packets.  The vertex <v>
+        // (corresponding to the node that has these links and interfaces) has
+        // an m_nextHop address precalculated for us that is the address to which the
+        // root node should send packets to be forwarded to these IP addresses.
+        // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
+        // which the packets should be send for forwarding.
         //
-        NS_LOG_LOGIC("Considering router " << rtr->GetRouterId());
-
-        if (rtr->GetRouterId() == routerId)
+        // walk through all available exit directions due to ECMP,
+        // and add host route for each of the exit direction toward
+        // the vertex 'v'
+        for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
         {
-            NS_LOG_LOGIC("Setting routes for node " << node->GetId());
-            //
-            // Routing information is updated using the Ipv4 interface.  We need to
-            // GetObject for that interface.  If the node is acting as an IP version 4
-            // router, it should absolutely have an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                          "GetObject for <Ipv4> interface failed");
-            //
-            // Get the Global Router Link State Advertisement from the vertex we're
-            // adding the routes to.  The LSA will have a number of attached Global Router
-            // Link Records corresponding to links off of that vertex / node.  We're going
-            // to be interested in the records corresponding to point-to-point links.
-            //
-            GlobalRoutingLSA* lsa = v->GetLSA();
-            NS_ASSERT_MSG(lsa,
-                          "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                          "Expected valid LSA in SPFVertex* v");
-
-            uint32_t nLinkRecords = lsa->GetNLinkRecords();
-            //
-            // Iterate through the link records on the vertex to which we're going to add
-            // routes.  To make sure we're being clear, we're going to add routing table
-            // entries to the tables on the node corresping to the root of the SPF tree.
-            // These entries will have routes to the IP addresses we find from looking at
-            // the local side of the point-to-point links found on the node described by
-            // the vertex <v>.
-            //
-            NS_LOG_LOGIC(" Node " << node->GetId() << " found " << nLinkRecords
-                                  << " link records in LSA " << lsa << "with LinkStateId "
-                                  << lsa->GetLinkStateId());
-            for (uint32_t j = 0; j < nLinkRecords; ++j)
+            SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
+            Ipv4Address nextHop = exit.first;
+            int32_t outIf = exit.second;
+            if (outIf >= 0)
             {
-                //
-                // We are only concerned about point-to-point links
-                //
-                GlobalRoutingLinkRecord* lr = lsa->GetLinkRecord(j);
-                if (lr->GetLinkType() != GlobalRoutingLinkRecord::PointToPoint)
-                {
-                    continue;
-                }
-                //
-                // Here's why we did all of that work.  We're going to add a host route to the
-                // host address found in the m_linkData field of the point-to-point link
-                // record.  In the case of a point-to-point link, this is the local IP address
-                // of the node connected to the link.  Each of these point-to-point links
-                // will correspond to a local interface that has an IP address to which
-                // the node at the root of the SPF tree can send packets.  The vertex <v>
-                // (corresponding to the node that has these links and interfaces) has
-                // an m_nextHop address precalculated for us that is the address to which the
-                // root node should send packets to be forwarded to these IP addresses.
-                // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-                // which the packets should be send for forwarding.
-                //
-                Ptr<GlobalRouter> router = node->GetObject<GlobalRouter>();
-                if (!router)
-                {
-                    continue;
-                }
-                Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol();
-                NS_ASSERT(gr);
-                // walk through all available exit directions due to ECMP,
-                // and add host route for each of the exit direction toward
-                // the vertex 'v'
-                for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
-                {
-                    SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
-                    Ipv4Address nextHop = exit.first;
-                    int32_t outIf = exit.second;
-                    if (outIf >= 0)
-                    {
-                        gr->AddHostRouteTo(lr->GetLinkData(), nextHop, outIf);
-                        NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                               << " adding host route to " << lr->GetLinkData()
-                                               << " using next hop " << nextHop
-                                               << " and outgoing interface " << outIf);
-                    }
-                    else
-                    {
-                        NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                               << " NOT able to add host route to "
-                                               << lr->GetLinkData() << " using next hop " << nextHop
-                                               << " since outgoing interface id is negative "
-                                               << outIf);
-                    }
-                } // for all routes from the root the vertex 'v'
+                AddRoute(SPFRoute::HOST, lr->GetLinkData(), Ipv4Mask::GetOnes(), nextHop, outIf);
+                NS_LOG_LOGIC("(Route " << i << ") Node " << m_root.nodeId
+                                       << " adding host route to " << lr->GetLinkData()
+                                       << " using next hop " << nextHop
+                                       << " and outgoing interface " << outIf);
             }
-            //
-            // Done adding the routes for the selected node.
-            //
-            return;
-        }
+            else
+            {
+                NS_LOG_LOGIC("(Route " << i << ") Node " << m_root.nodeId
+                                       << " NOT able to add host route to "
+                                       << lr->GetLinkData() << " using next hop " << nextHop
+                                       << " since outgoing interface id is negative "
+                                       << outIf);
+            }
+        } // for all routes from the root the vertex 'v'
     }
 }
 
@@ -2061,89 +2070,51 @@ GlobalRouteManagerImpl::SPFIntraAddTransit(SPFVertex* v)
 
     NS_LOG_LOGIC("Vertex ID = " << routerId);
     //
-    // We need to walk the list of nodes looking for the one that has the router
-    // ID corresponding to the root vertex.  This is the one we're going to write
-    // the routing information to.
+    // The routes are written to the routing table of the root, which is the
+    // node with this router ID, if there is one.
     //
-    for (auto i = NodeList::Begin(); i != NodeList::End(); i++)
+    if (!m_root.routing)
     {
-        Ptr<Node> node = *i;
-        //
-        // The router ID is accessible through the GlobalRouter interface, so we need
-        // to GetObject for that interface.  If there's no GlobalRouter interface,
-        // the node in question cannot be the router we want, so we continue.
-        //
-        Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter>();
+        NS_LOG_LOGIC("No node with router ID " << routerId);
+        return;
+    }
+    NS_LOG_LOGIC("setting routes for node " << m_root.nodeId);
+    //
+    // Get the Global Router Link State Advertisement from the vertex we're
+    // adding the routes to.  The LSA will have a number of attached Global Router
+    // Link Records corresponding to links off of that vertex / node.  We're going
+    // to be interested in the records corresponding to point-to-point links.
+    //
+    GlobalRoutingLSA* lsa = v->GetLSA();
+    NS_ASSERT_MSG(lsa,
+                  "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                  "Expected valid LSA in SPFVertex* v");
+    Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask();
+    Ipv4Address tempip = lsa->GetLinkStateId();
+    tempip = tempip.CombineMask(tempmask);
+    // walk through all available exit directions due to ECMP,
+    // and add host route for each of the exit direction toward
+    // the vertex 'v'
+    for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
+    {
+        SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
+        Ipv4Address nextHop = exit.first;
+        int32_t outIf = exit.second;
 
-        if (!rtr)
+        if (outIf >= 0)
         {
-            NS_LOG_LOGIC("No GlobalRouter interface on node " << node->GetId());
-            continue;
+            AddRoute(SPFRoute::NETWORK, tempip, tempmask, nextHop, outIf);
+            NS_LOG_LOGIC("(Route " << i << ") Node " << m_root.nodeId
+                                   << " add network route to " << tempip
+                                   << " using next hop " << nextHop << " via interface "
+                                   << outIf);
         }
-        //
-        // If the router ID of the current node is equal to the router ID of the
-        // root of the SPF tree, then this node is the one for which we need to
-        // write the routing tables.
-        //
-        NS_LOG_LOGIC("Considering router " << rtr->GetRouterId());
-
-        if (rtr->GetRouterId() == routerId)
+        else
         {
-            NS_LOG_LOGIC("setting routes for node " << node->GetId());
-            //
-            // Routing information is updated using the Ipv4 interface.  We need to
-            // GetObject for that interface.  If the node is acting as an IP version 4
-            // router, it should absolutely have an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                          "GetObject for <Ipv4> interface failed");
-            //
-            // Get the Global Router Link State Advertisement from the vertex we're
-            // adding the routes to.  The LSA will have a number of attached Global Router
-            // Link Records corresponding to links off of that vertex / node.  We're going
-            // to be interested in the records corresponding to point-to-point links.
-            //
-            GlobalRoutingLSA* lsa = v->GetLSA();
-            NS_ASSERT_MSG(lsa,
-                          "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                          "Expected valid LSA in SPFVertex* v");
-            Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask();
-            Ipv4Address tempip = lsa->GetLinkStateId();
-            tempip = tempip.CombineMask(tempmask);
-            Ptr<GlobalRouter> router = node->GetObject<GlobalRouter>();
-            if (!router)
-            {
-                continue;
-            }
-            Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol();
-            NS_ASSERT(gr);
-            // walk through all available exit directions due to ECMP,
-            // and add host route for each of the exit direction toward
-            // the vertex 'v'
-            for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
-            {
-                SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
-                Ipv4Address nextHop = exit.first;
-                int32_t outIf = exit.second;
-
-                if (outIf >= 0)
-                {
-                    gr->AddNetworkRouteTo(tempip, tempmask, nextHop, outIf);
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " add network route to " << tempip
-                                           << " using next hop " << nextHop << " via interface "
-                                           << outIf);
-                }
-                else
-                {
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " NOT able to add network route to " << tempip
-                                           << " using next hop " << nextHop
-                                           << " since outgoing interface id is negative " << outIf);
-                }
-            }
+            NS_LOG_LOGIC("(Route " << i << ") Node " << m_root.nodeId
+                                   << " NOT able to add network route to " << tempip
+                                   << " using next hop " << nextHop
+                                   << " since outgoing interface id is negative " << outIf);
         }
     }
 }
@@ -31,6 +31,7 @@
 #include <map>
 #include <queue>
 #include <stdint.h>
+#include <unordered_map>
 #include <vector>
 
 namespace ns3
@@ -39,7 +40,9 @@ namespace ns3
 const uint32_t SPF_INFINITY = 0xffffffff; //!< "infinite" distance between nodes
 
 class CandidateQueue;
+class Ipv4;
 class Ipv4GlobalRouting;
+class Node;
 
 /**
  * \ingroup globalrouting
@@ -693,6 +696,13 @@ class GlobalRouteManagerLSDB
  * and finally configure each of the node's forwarding tables.
  *
  * The design is guided by OSPFv2 \RFC{2328} section 16.1.1 and quagga ospfd.
+ *
+ * The SPF calculations of the routers are independent of each other, and
+ * InitializeRoutes() can run them in several threads, as set by the
+ * "GlobalRoutingThreads" GlobalValue.  Each thread has its own SPF state;
+ * the routes found are added to the routing tables by the calling thread,
+ * in the order of the nodes, so that the routing tables do not depend on
+ * the number of threads.
  */
 class GlobalRouteManagerImpl
 {
@@ -738,8 +748,106 @@ class GlobalRouteManagerImpl
     void DebugSPFCalculate(Ipv4Address root);
 
   private:
+    /**
+     * \brief The router at the root of an SPF calculation.
+     *
+     * The calculations of several roots may run in different threads, which
+     * must not copy smart pointers to shared objects, as the reference counts
+     * are not thread-safe.  The IPv4 stack and the routing protocol of the root
+     * are only used by the thread of the root, and are held by raw pointers.
+     */
+    struct SPFRoot
+    {
+        Ipv4Address routerId;       //!< the router id
+        uint32_t nodeId;            //!< the id of the node of the router
+        Ipv4* ipv4;                 //!< the IPv4 stack of the node, or nullptr
+        Ipv4GlobalRouting* routing; //!< the global routing protocol of the node, or nullptr
+    };
+
+    /**
+     * \brief A route found by an SPF calculation, for the root.
+     */
+    struct SPFRoute
+    {
+        /// The kind of route
+        enum Type
+        {
+            HOST,     //!< route to a host
+            NETWORK,  //!< route to a network
+            EXTERNAL, //!< route to an external network
+        };
+
+        Type type;           //!< the kind of route
+        Ipv4Address dest;    //!< the destination host or network
+        Ipv4Mask mask;       //!< the network mask
+        Ipv4Address nextHop; //!< the next hop
+        uint32_t interface;  //!< the outgoing interface
+    };
+
+    /**
+     * \brief Create a worker running SPF calculations on the LSDB of another
+     * manager.
+     * \param lsdb the LSDB, which is not owned by the worker
+     */
+    explicit GlobalRouteManagerImpl(GlobalRouteManagerLSDB* lsdb);
+
     SPFVertex* m_spfroot;           //!< the root node
     GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+    bool m_ownLsdb;                 //!< true if m_lsdb is deleted with the manager
+    SPFRoot m_root;                 //!< the router at the root of the current SPF calculation
+    /// the status of the LSAs in the current SPF calculation, if explored
+    std::unordered_map<const GlobalRoutingLSA*, GlobalRoutingLSA::SPFStatus> m_lsaStatus;
+    std::vector<SPFRoute> m_routes; //!< the routes found by the current SPF calculation
+
+    /**
+     * \brief Get the router of a node, at the root of an SPF calculation.
+     * \param node the node, which must have a GlobalRouter
+     * \returns the root
+     */
+    SPFRoot GetSPFRoot(Ptr<Node> node) const;
+
+    /**
+     * \brief Find the router at the root of an SPF calculation.
+     * \param routerId the router id
+     * \returns the root, whose pointers are null if no node has this router id
+     */
+    SPFRoot GetSPFRoot(Ipv4Address routerId) const;
+
+    /**
+     * \brief Get the status of an LSA in the current SPF calculation.
+     * \param lsa the LSA
+     * \returns the status
+     */
+    GlobalRoutingLSA::SPFStatus GetLSAStatus(const GlobalRoutingLSA* lsa) const;
+
+    /**
+     * \brief Set the status of an LSA in the current SPF calculation.
+     * \param lsa the LSA
+     * \param status the status
+     */
+    void SetLSAStatus(const GlobalRoutingLSA* lsa, GlobalRoutingLSA::SPFStatus status);
+
+    /**
+     * \brief Record a route to be added to the routing table of the root.
+     * \param type the kind of route
+     * \param dest the destination host or network
+     * \param mask the network mask
+     * \param nextHop the next hop
+     * \param interface the outgoing interface
+     */
+    void AddRoute(SPFRoute::Type type,
+                  Ipv4Address dest,
+                  Ipv4Mask mask,
+                  Ipv4Address nextHop,
+                  uint32_t interface);
+
+    /**
+     * \brief Add the routes found by an SPF calculation to the routing table
+     * of its root.
+     * \param root the root
+     * \param routes the routes
+     */
+    void InstallRoutes(const SPFRoot& root, const std::vector<SPFRoute>& routes);
 
     /**
      * \brief Test if a node is a stub, from an OSPF sense.
@@ -756,10 +864,11 @@ class GlobalRouteManagerImpl
     /**
      * \brief Calculate the shortest path first (SPF) tree
      *
-     * Equivalent to quagga ospf_spf_calculate
+     * Equivalent to quagga ospf_spf_calculate.  The routes found are
+     * stored in m_routes, to be added by InstallRoutes().
      * \param root the root node
      */
-    void SPFCalculate(Ipv4Address root);
+    void SPFCalculate(const SPFRoot& root);
 
     /**
      * \brief Process Stub nodes
@@ -24,6 +24,8 @@
 
 #include "ns3/log.h"
 
+#include <algorithm>
+
 namespace ns3
 {
 
@@ -43,33 +45,88 @@ Ipv4EndPointDemux::~Ipv4EndPointDemux()
     for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
     {
         Ipv4EndPoint* endPoint = *i;
+        endPoint->m_demux = nullptr;
         delete endPoint;
     }
     m_endPoints.clear();
+    m_tuples.clear();
+    m_ports.clear();
 }
 
 bool
-Ipv4EndPointDemux::LookupPortLocal(uint16_t port)
+Ipv4EndPointDemux::Tuple::operator==(const Tuple& other) const
 {
-    NS_LOG_FUNCTION(this << port);
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    return localAddress == other.localAddress && localPort == other.localPort &&
+           peerAddress == other.peerAddress && peerPort == other.peerPort;
+}
+
+std::size_t
+Ipv4EndPointDemux::TupleHash::operator()(const Tuple& tuple) const
+{
+    uint64_t addresses = (uint64_t(tuple.localAddress.Get()) << 32) | tuple.peerAddress.Get();
+    uint64_t ports = (uint64_t(tuple.localPort) << 16) | tuple.peerPort;
+    return std::hash<uint64_t>()(addresses ^ (ports * 0x9e3779b97f4a7c15ULL));
+}
+
+Ipv4EndPointDemux::Tuple
+Ipv4EndPointDemux::GetTuple(const Ipv4EndPoint* endPoint)
+{
+    return {endPoint->GetLocalAddress(),
+            endPoint->GetLocalPort(),
+            endPoint->GetPeerAddress(),
+            endPoint->GetPeerPort()};
+}
+
+Ipv4EndPoint*
+Ipv4EndPointDemux::Insert(Ipv4EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    m_endPoints.push_back(endPoint);
+    m_ports[endPoint->GetLocalPort()].push_back(endPoint);
+    Index(endPoint);
+    endPoint->m_demux = this;
+    NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
+    return endPoint;
+}
+
+void
+Ipv4EndPointDemux::Index(Ipv4EndPoint* endPoint)
+{
+    m_tuples[GetTuple(endPoint)].push_back(endPoint);
+}
+
+void
+Ipv4EndPointDemux::Unindex(Ipv4EndPoint* endPoint)
+{
+    auto i = m_tuples.find(GetTuple(endPoint));
+    NS_ASSERT(i != m_tuples.end());
+    auto& endPoints = i->second;
+    endPoints.erase(std::find(endPoints.begin(), endPoints.end(), endPoint));
+    if (endPoints.empty())
     {
-        if ((*i)->GetLocalPort() == port)
-        {
-            return true;
-        }
+        m_tuples.erase(i);
     }
-    return false;
+}
+
+bool
+Ipv4EndPointDemux::LookupPortLocal(uint16_t port)
+{
+    NS_LOG_FUNCTION(this << port);
+    return m_ports.find(port) != m_ports.end();
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal(Ptr<NetDevice> boundNetDevice, Ipv4Address addr, uint16_t port)
 {
     NS_LOG_FUNCTION(this << addr << port);
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    auto endPoints = m_ports.find(port);
+    if (endPoints == m_ports.end())
+    {
+        return false;
+    }
+    for (auto endPoint : endPoints->second)
     {
-        if ((*i)->GetLocalPort() == port && (*i)->GetLocalAddress() == addr &&
-            (*i)->GetBoundNetDevice() == boundNetDevice)
+        if (endPoint->GetLocalAddress() == addr && endPoint->GetBoundNetDevice() == boundNetDevice)
         {
             return true;
         }
@@ -87,10 +144,7 @@ Ipv4EndPointDemux::Allocate()
         NS_LOG_WARN("Ephemeral port allocation failed.");
         return nullptr;
     }
-    auto endPoint = new Ipv4EndPoint(Ipv4Address::GetAny(), port);
-    m_endPoints.push_back(endPoint);
-    NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
-    return endPoint;
+    return Insert(new Ipv4EndPoint(Ipv4Address::GetAny(), port));
 }
 
 Ipv4EndPoint*
@@ -103,10 +157,7 @@ Ipv4EndPointDemux::Allocate(Ipv4Address address)
         NS_LOG_WARN("Ephemeral port allocation failed.");
         return nullptr;
     }
-    auto endPoint = new Ipv4EndPoint(address, port);
-    m_endPoints.push_back(endPoint);
-    NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
-    return endPoint;
+    return Insert(new Ipv4EndPoint(address, port));
 }
 
 Ipv4EndPoint*
@@ -126,10 +177,7 @@ Ipv4EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice, Ipv4Address address,
         NS_LOG_WARN("Duplicated endpoint.");
         return nullptr;
     }
-    auto endPoint = new Ipv4EndPoint(address, port);
-    m_endPoints.push_back(endPoint);
-    NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
-    return endPoint;
+    return Insert(new Ipv4EndPoint(address, port));
 }
 
 Ipv4EndPoint*
@@ -140,23 +188,21 @@ Ipv4EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice,
                             uint16_t peerPort)
 {
     NS_LOG_FUNCTION(this << localAddress << localPort << peerAddress << peerPort << boundNetDevice);
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    auto endPoints = m_tuples.find({localAddress, localPort, peerAddress, peerPort});
+    if (endPoints != m_tuples.end())
     {
-        if ((*i)->GetLocalPort() == localPort && (*i)->GetLocalAddress() == localAddress &&
-            (*i)->GetPeerPort() == peerPort && (*i)->GetPeerAddress() == peerAddress &&
-            ((*i)->GetBoundNetDevice() == boundNetDevice || !(*i)->GetBoundNetDevice()))
+        for (auto endPoint : endPoints->second)
         {
-            NS_LOG_WARN("Duplicated endpoint.");
-            return nullptr;
+            if (endPoint->GetBoundNetDevice() == boundNetDevice || !endPoint->GetBoundNetDevice())
+            {
+                NS_LOG_WARN("Duplicated endpoint.");
+                return nullptr;
+            }
         }
     }
     auto endPoint = new Ipv4EndPoint(localAddress, localPort);
     endPoint->SetPeer(peerAddress, peerPort);
-    m_endPoints.push_back(endPoint);
-
-    NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
-
-    return endPoint;
+    return Insert(endPoint);
 }
 
 void
@@ -167,6 +213,14 @@ Ipv4EndPointDemux::DeAllocate(Ipv4EndPoint* endPoint)
     {
         if (*i == endPoint)
         {
+            Unindex(endPoint);
+            auto& endPoints = m_ports[endPoint->GetLocalPort()];
+            endPoints.erase(std::find(endPoints.begin(), endPoints.end(), endPoint));
+            if (endPoints.empty())
+            {
+                m_ports.erase(endPoint->GetLocalPort());
+            }
+            endPoint->m_demux = nullptr;
             delete endPoint;
             m_endPoints.erase(i);
             break;
@@ -191,30 +245,18 @@ Ipv4EndPointDemux::GetAllEndPoints()
     return ret;
 }
 
-/*
- * If we have an exact match, we return it.
- * Otherwise, if we find a generic match, we return it.
- * Otherwise, we return 0.
- */
-Ipv4EndPointDemux::EndPoints
-Ipv4EndPointDemux::Lookup(Ipv4Address daddr,
-                          uint16_t dport,
-                          Ipv4Address saddr,
-                          uint16_t sport,
-                          Ptr<Ipv4Interface> incomingInterface)
+void
+Ipv4EndPointDemux::AddMatches(EndPoints& matches,
+                              const Tuple& tuple,
+                              Ptr<Ipv4Interface> incomingInterface) const
 {
-    NS_LOG_FUNCTION(this << daddr << dport << saddr << sport << incomingInterface);
-
-    EndPoints retval1; // Matches exact on local port, wildcards on others
-    EndPoints retval2; // Matches exact on local port/adder, wildcards on others
-    EndPoints retval3; // Matches all but local address
-    EndPoints retval4; // Exact match on all 4
-
-    NS_LOG_DEBUG("Looking up endpoint for destination address " << daddr << ":" << dport);
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    auto endPoints = m_tuples.find(tuple);
+    if (endPoints == m_tuples.end())
+    {
+        return;
+    }
+    for (auto endP : endPoints->second)
     {
-        Ipv4EndPoint* endP = *i;
-
         NS_LOG_DEBUG("Looking at endpoint dport="
                      << endP->GetLocalPort() << " daddr=" << endP->GetLocalAddress()
                      << " sport=" << endP->GetPeerPort() << " saddr=" << endP->GetPeerAddress());
@@ -226,13 +268,6 @@ Ipv4EndPointDemux::Lookup(Ipv4Address daddr,
             continue;
         }
 
-        if (endP->GetLocalPort() != dport)
-        {
-            NS_LOG_LOGIC("Skipping endpoint " << &endP << " because endpoint dport "
-                                              << endP->GetLocalPort()
-                                              << " does not match packet dport " << dport);
-            continue;
-        }
         if (endP->GetBoundNetDevice())
         {
             if (endP->GetBoundNetDevice() != incomingInterface->GetDevice())
@@ -245,119 +280,76 @@ Ipv4EndPointDemux::Lookup(Ipv4Address daddr,
             }
         }
 
-        bool localAddressMatchesExact = false;
-        bool localAddressIsAny = false;
-        bool localAddressIsSubnetAny = false;
+        NS_LOG_LOGIC("Found an endpoint, adding " << endP->GetLocalAddress() << ":"
+                                                  << endP->GetLocalPort());
+        matches.push_back(endP);
+    }
+}
 
-        // We have 3 cases:
-        // 1) Exact local / destination address match
-        // 2) Local endpoint bound to Any -> matches anything
-        // 3) Local endpoint bound to x.y.z.0 -> matches Subnet-directed broadcast packet (e.g.,
-        // x.y.z.255 in a /24 net) and direct destination match.
+/*
+ * If we have an exact match, we return it.
+ * Otherwise, if we find a generic match, we return it.
+ * Otherwise, we return 0.
+ */
+Ipv4EndPointDemux::EndPoints
+Ipv4EndPointDemux::Lookup(Ipv4Address daddr,
+                          uint16_t dport,
+                          Ipv4Address saddr,
+                          uint16_t sport,
+                          Ptr<Ipv4Interface> incomingInterface)
+{
+    NS_LOG_FUNCTION(this << daddr << dport << saddr << sport << incomingInterface);
 
-        if (endP->GetLocalAddress() == daddr)
-        {
-            // Case 1:
-            localAddressMatchesExact = true;
-        }
-        else if (endP->GetLocalAddress() == Ipv4Address::GetAny())
+    NS_LOG_DEBUG("Looking up endpoint for destination address " << daddr << ":" << dport);
+    EndPoints retval;
+
+    // Exact match on all 4 - this is the case of an open TCP connection, for example.
+    AddMatches(retval, {daddr, dport, saddr, sport}, incomingInterface);
+    if (retval.empty())
+    {
+        // The local addresses which match the destination as a wildcard:
+        // 1) Local endpoint bound to Any -> matches anything
+        // 2) Local endpoint bound to x.y.z.0 -> matches Subnet-directed broadcast packet (e.g.,
+        // x.y.z.255 in a /24 net) and direct destination match.
+        std::vector<Ipv4Address> wildcards;
+        if (daddr != Ipv4Address::GetAny())
         {
-            // Case 2:
-            localAddressIsAny = true;
+            wildcards.push_back(Ipv4Address::GetAny());
         }
-        else
+        for (uint32_t i = 0; i < incomingInterface->GetNAddresses(); i++)
         {
-            // Case 3:
-            for (uint32_t i = 0; i < incomingInterface->GetNAddresses(); i++)
-            {
-                Ipv4InterfaceAddress addr = incomingInterface->GetAddress(i);
-
-                Ipv4Address addrNetpart = addr.GetLocal().CombineMask(addr.GetMask());
-                if (endP->GetLocalAddress() == addrNetpart)
-                {
-                    NS_LOG_LOGIC("Endpoint is SubnetDirectedAny "
-                                 << endP->GetLocalAddress() << "/"
-                                 << addr.GetMask().GetPrefixLength());
-
-                    Ipv4Address daddrNetPart = daddr.CombineMask(addr.GetMask());
-                    if (addrNetpart == daddrNetPart)
-                    {
-                        localAddressIsSubnetAny = true;
-                    }
-                }
-            }
+            Ipv4InterfaceAddress addr = incomingInterface->GetAddress(i);
 
-            // if no match here, keep looking
-            if (!localAddressIsSubnetAny)
+            Ipv4Address addrNetpart = addr.GetLocal().CombineMask(addr.GetMask());
+            if (addrNetpart != daddr && addrNetpart == daddr.CombineMask(addr.GetMask()) &&
+                std::find(wildcards.begin(), wildcards.end(), addrNetpart) == wildcards.end())
             {
-                continue;
+                NS_LOG_LOGIC("Looking for SubnetDirectedAny endpoints "
+                             << addrNetpart << "/" << addr.GetMask().GetPrefixLength());
+                wildcards.push_back(addrNetpart);
             }
         }
 
-        bool remotePortMatchesExact = endP->GetPeerPort() == sport;
-        bool remotePortMatchesWildCard = endP->GetPeerPort() == 0;
-        bool remoteAddressMatchesExact = endP->GetPeerAddress() == saddr;
-        bool remoteAddressMatchesWildCard = endP->GetPeerAddress() == Ipv4Address::GetAny();
-
-        // If remote does not match either with exact or wildcard,
-        // skip this one
-        if (!(remotePortMatchesExact || remotePortMatchesWildCard))
+        // All but local address - no idea what this case could be.
+        for (const auto& wildcard : wildcards)
         {
-            continue;
+            AddMatches(retval, {wildcard, dport, saddr, sport}, incomingInterface);
         }
-        if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
+        // Only local port and local address matches exactly - Not yet opened connection
+        if (retval.empty())
         {
-            continue;
+            AddMatches(retval, {daddr, dport, Ipv4Address::GetAny(), 0}, incomingInterface);
         }
-
-        bool localAddressMatchesWildCard = localAddressIsAny || localAddressIsSubnetAny;
-
-        if (localAddressMatchesExact && remoteAddressMatchesExact && remotePortMatchesExact)
-        { // All 4 match - this is the case of an open TCP connection, for example.
-            NS_LOG_LOGIC("Found an endpoint for case 4, adding " << endP->GetLocalAddress() << ":"
-                                                                 << endP->GetLocalPort());
-            retval4.push_back(endP);
-        }
-        if (localAddressMatchesWildCard && remoteAddressMatchesExact && remotePortMatchesExact)
-        { // All but local address - no idea what this case could be.
-            NS_LOG_LOGIC("Found an endpoint for case 3, adding " << endP->GetLocalAddress() << ":"
-                                                                 << endP->GetLocalPort());
-            retval3.push_back(endP);
-        }
-        if (localAddressMatchesExact && remoteAddressMatchesWildCard && remotePortMatchesWildCard)
-        { // Only local port and local address matches exactly - Not yet opened connection
-            NS_LOG_LOGIC("Found an endpoint for case 2, adding " << endP->GetLocalAddress() << ":"
-                                                                 << endP->GetLocalPort());
-            retval2.push_back(endP);
-        }
-        if (localAddressMatchesWildCard && remoteAddressMatchesWildCard &&
-            remotePortMatchesWildCard)
-        { // Only local port matches exactly - Endpoint open to "any" connection
-            NS_LOG_LOGIC("Found an endpoint for case 1, adding " << endP->GetLocalAddress() << ":"
-                                                                 << endP->GetLocalPort());
-            retval1.push_back(endP);
+        // Only local port matches exactly - Endpoint open to "any" connection
+        if (retval.empty())
+        {
+            for (const auto& wildcard : wildcards)
+            {
+                AddMatches(retval, {wildcard, dport, Ipv4Address::GetAny(), 0}, incomingInterface);
+            }
         }
     }
 
-    // Here we find the most exact match
-    EndPoints retval;
-    if (!retval4.empty())
-    {
-        retval = retval4;
-    }
-    else if (!retval3.empty())
-    {
-        retval = retval3;
-    }
-    else if (!retval2.empty())
-    {
-        retval = retval2;
-    }
-    else
-    {
-        retval = retval1;
-    }
-
     NS_ABORT_MSG_IF(retval.size() > 1,
                     "Too many endpoints - perhaps you created too many sockets without binding "
                     "them to different NetDevices.");
@@ -376,12 +368,13 @@ Ipv4EndPointDemux::SimpleLookup(Ipv4Address daddr,
     // function.
     uint32_t genericity = 3;
     Ipv4EndPoint* generic = nullptr;
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    auto endPoints = m_ports.find(dport);
+    if (endPoints == m_ports.end())
+    {
+        return nullptr;
+    }
+    for (auto i = endPoints->second.begin(); i != endPoints->second.end(); i++)
     {
-        if ((*i)->GetLocalPort() != dport)
-        {
-            continue;
-        }
         if ((*i)->GetLocalAddress() == daddr && (*i)->GetPeerPort() == sport &&
             (*i)->GetPeerAddress() == saddr)
         {
@@ -26,6 +26,8 @@
 
 #include <list>
 #include <stdint.h>
+#include <unordered_map>
+#include <vector>
 
 namespace ns3
 {
@@ -42,6 +44,14 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * Besides the list, the endpoints are indexed by their four-tuple and by
+ * their local port, so that a lookup does not depend on the number of
+ * endpoints.  A listening endpoint is indexed with the wildcard peer
+ * (any address, port 0), so the four-tuple index also gives the endpoints
+ * bound to a (local address, port) pair, and those bound to a port only
+ * (local address any).  The endpoints keep the index up to date when their
+ * local address or their peer is changed.
  */
 
 class Ipv4EndPointDemux
@@ -171,6 +181,77 @@ class Ipv4EndPointDemux
     void DeAllocate(Ipv4EndPoint* endPoint);
 
   private:
+    friend class Ipv4EndPoint;
+
+    /**
+     * \brief The four-tuple of an endpoint.
+     */
+    struct Tuple
+    {
+        Ipv4Address localAddress; //!< Local address
+        uint16_t localPort;       //!< Local port
+        Ipv4Address peerAddress;  //!< Peer address
+        uint16_t peerPort;        //!< Peer port
+
+        /**
+         * \param other the tuple to compare to
+         * \return true if both tuples are the same
+         */
+        bool operator==(const Tuple& other) const;
+    };
+
+    /**
+     * \brief Hash function of a Tuple.
+     */
+    struct TupleHash
+    {
+        /**
+         * \param tuple the tuple to hash
+         * \return the hash of the tuple
+         */
+        std::size_t operator()(const Tuple& tuple) const;
+    };
+
+    /**
+     * \brief Get the four-tuple of an end point.
+     * \param endPoint the end point
+     * \return the four-tuple
+     */
+    static Tuple GetTuple(const Ipv4EndPoint* endPoint);
+
+    /**
+     * \brief Add a new end point to the list and to the indexes.
+     * \param endPoint the end point
+     * \return the end point
+     */
+    Ipv4EndPoint* Insert(Ipv4EndPoint* endPoint);
+
+    /**
+     * \brief Add an end point to the four-tuple index.
+     * \param endPoint the end point
+     */
+    void Index(Ipv4EndPoint* endPoint);
+
+    /**
+     * \brief Remove an end point from the four-tuple index.
+     *
+     * Must be called before the four-tuple of the end point is changed.
+     *
+     * \param endPoint the end point
+     */
+    void Unindex(Ipv4EndPoint* endPoint);
+
+    /**
+     * \brief Append the end points with a four-tuple which can receive
+     * packets from an interface.
+     * \param matches the end points found
+     * \param tuple the four-tuple
+     * \param incomingInterface the incoming interface
+     */
+    void AddMatches(EndPoints& matches,
+                    const Tuple& tuple,
+                    Ptr<Ipv4Interface> incomingInterface) const;
+
     /**
      * \brief Allocate an ephemeral port.
      * \returns the ephemeral port
@@ -196,6 +277,16 @@ class Ipv4EndPointDemux
      * \brief A list of IPv4 end points.
      */
     EndPoints m_endPoints;
+
+    /**
+     * \brief The IPv4 end points, by four-tuple.
+     */
+    std::unordered_map<Tuple, std::vector<Ipv4EndPoint*>, TupleHash> m_tuples;
+
+    /**
+     * \brief The IPv4 end points, by local port.
+     */
+    std::unordered_map<uint16_t, std::vector<Ipv4EndPoint*>> m_ports;
 };
 
 } // namespace ns3
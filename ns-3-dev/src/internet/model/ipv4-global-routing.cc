@@ -30,6 +30,7 @@
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 
+#include <algorithm>
 #include <iomanip>
 #include <vector>
 
@@ -83,6 +84,7 @@ Ipv4GlobalRouting::AddHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_
     auto route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateHostRouteTo(dest, nextHop, interface);
     m_hostRoutes.push_back(route);
+    m_hostIndex.Add(route);
 }
 
 void
@@ -92,6 +94,7 @@ Ipv4GlobalRouting::AddHostRouteTo(Ipv4Address dest, uint32_t interface)
     auto route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateHostRouteTo(dest, interface);
     m_hostRoutes.push_back(route);
+    m_hostIndex.Add(route);
 }
 
 void
@@ -104,6 +107,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo(Ipv4Address network,
     auto route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, nextHop, interface);
     m_networkRoutes.push_back(route);
+    m_networkIndex.Add(route);
 }
 
 void
@@ -113,6 +117,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo(Ipv4Address network, Ipv4Mask networkMask,
     auto route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, interface);
     m_networkRoutes.push_back(route);
+    m_networkIndex.Add(route);
 }
 
 void
@@ -125,6 +130,7 @@ Ipv4GlobalRouting::AddASExternalRouteTo(Ipv4Address network,
     auto route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, nextHop, interface);
     m_ASexternalRoutes.push_back(route);
+    m_ASexternalIndex.Add(route);
 }
 
 Ptr<Ipv4Route>
@@ -137,66 +143,72 @@ Ipv4GlobalRouting::LookupGlobal(Ipv4Address dest, Ptr<NetDevice> oif)
     typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
     RouteVec_t allRoutes;
 
+    // The indexes return the candidate routes in the order they were added,
+    // which is the order the routes would be found in the lists.
     NS_LOG_LOGIC("Number of m_hostRoutes = " << m_hostRoutes.size());
-    for (auto i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
+    m_hostIndex.LookupNetwork(dest, Ipv4Mask::GetOnes(), m_matches);
+    for (const auto& match : m_matches)
     {
-        NS_ASSERT((*i)->IsHost());
-        if ((*i)->GetDest() == dest)
+        Ipv4RoutingTableEntry* route = match.route;
+        NS_ASSERT(route->IsHost());
+        if (oif)
         {
-            if (oif)
+            if (oif != m_ipv4->GetNetDevice(route->GetInterface()))
             {
-                if (oif != m_ipv4->GetNetDevice((*i)->GetInterface()))
-                {
-                    NS_LOG_LOGIC("Not on requested interface, skipping");
-                    continue;
-                }
+                NS_LOG_LOGIC("Not on requested interface, skipping");
+                continue;
             }
-            allRoutes.push_back(*i);
-            NS_LOG_LOGIC(allRoutes.size() << "Found global host route" << *i);
         }
+        allRoutes.push_back(route);
+        NS_LOG_LOGIC(allRoutes.size() << "Found global host route" << route);
     }
     if (allRoutes.empty()) // if no host route is found
     {
         NS_LOG_LOGIC("Number of m_networkRoutes" << m_networkRoutes.size());
-        for (auto j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j++)
+        m_networkIndex.Lookup(dest, m_matches);
+        std::sort(m_matches.begin(),
+                  m_matches.end(),
+                  [](const Ipv4RoutingTableIndex::Match& a, const Ipv4RoutingTableIndex::Match& b) {
+                      return a.order < b.order;
+                  });
+        for (const auto& match : m_matches)
         {
-            Ipv4Mask mask = (*j)->GetDestNetworkMask();
-            Ipv4Address entry = (*j)->GetDestNetwork();
-            if (mask.IsMatch(dest, entry))
+            Ipv4RoutingTableEntry* route = match.route;
+            if (oif)
             {
-                if (oif)
+                if (oif != m_ipv4->GetNetDevice(route->GetInterface()))
                 {
-                    if (oif != m_ipv4->GetNetDevice((*j)->GetInterface()))
-                    {
-                        NS_LOG_LOGIC("Not on requested interface, skipping");
-                        continue;
-                    }
+                    NS_LOG_LOGIC("Not on requested interface, skipping");
+                    continue;
                 }
-                allRoutes.push_back(*j);
-                NS_LOG_LOGIC(allRoutes.size() << "Found global network route" << *j);
             }
+            allRoutes.push_back(route);
+            NS_LOG_LOGIC(allRoutes.size() << "Found global network route" << route);
         }
     }
     if (allRoutes.empty()) // consider external if no host/network found
     {
-        for (auto k = m_ASexternalRoutes.begin(); k != m_ASexternalRoutes.end(); k++)
+        m_ASexternalIndex.Lookup(dest, m_matches);
+        const Ipv4RoutingTableIndex::Match* first = nullptr;
+        for (const auto& match : m_matches)
         {
-            Ipv4Mask mask = (*k)->GetDestNetworkMask();
-            Ipv4Address entry = (*k)->GetDestNetwork();
-            if (mask.IsMatch(dest, entry))
+            NS_LOG_LOGIC("Found external route" << match.route);
+            if (oif)
             {
-                NS_LOG_LOGIC("Found external route" << *k);
-                if (oif)
+                if (oif != m_ipv4->GetNetDevice(match.route->GetInterface()))
                 {
-                    if (oif != m_ipv4->GetNetDevice((*k)->GetInterface()))
-                    {
-                        NS_LOG_LOGIC("Not on requested interface, skipping");
-                        continue;
-                    }
+                    NS_LOG_LOGIC("Not on requested interface, skipping");
+                    continue;
                 }
-                allRoutes.push_back(*k);
-                break;
             }
+            if (!first || match.order < first->order)
+            {
+                first = &match;
+            }
+        }
+        if (first)
+        {
+            allRoutes.push_back(first->route);
         }
     }
     if (!allRoutes.empty()) // if route(s) is found
@@ -297,6 +309,7 @@ Ipv4GlobalRouting::RemoveRoute(uint32_t index)
             if (tmp == index)
             {
                 NS_LOG_LOGIC("Removing route " << index << "; size = " << m_hostRoutes.size());
+                m_hostIndex.Remove(*i);
                 delete *i;
                 m_hostRoutes.erase(i);
                 NS_LOG_LOGIC("Done removing host route "
@@ -313,6 +326,7 @@ Ipv4GlobalRouting::RemoveRoute(uint32_t index)
         if (tmp == index)
         {
             NS_LOG_LOGIC("Removing route " << index << "; size = " << m_networkRoutes.size());
+            m_networkIndex.Remove(*j);
             delete *j;
             m_networkRoutes.erase(j);
             NS_LOG_LOGIC("Done removing network route "
@@ -328,6 +342,7 @@ Ipv4GlobalRouting::RemoveRoute(uint32_t index)
         if (tmp == index)
         {
             NS_LOG_LOGIC("Removing route " << index << "; size = " << m_ASexternalRoutes.size());
+            m_ASexternalIndex.Remove(*k);
             delete *k;
             m_ASexternalRoutes.erase(k);
             NS_LOG_LOGIC("Done removing network route "
@@ -351,6 +366,9 @@ void
 Ipv4GlobalRouting::DoDispose()
 {
     NS_LOG_FUNCTION(this);
+    m_hostIndex.Clear();
+    m_networkIndex.Clear();
+    m_ASexternalIndex.Clear();
     for (auto i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i = m_hostRoutes.erase(i))
     {
         delete (*i);
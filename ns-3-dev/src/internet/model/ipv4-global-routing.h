@@ -21,6 +21,7 @@
 
 #include "ipv4-header.h"
 #include "ipv4-routing-protocol.h"
+#include "ipv4-routing-table-entry.h"
 #include "ipv4.h"
 
 #include "ns3/ipv4-address.h"
@@ -29,6 +30,7 @@
 
 #include <list>
 #include <stdint.h>
+#include <vector>
 
 namespace ns3
 {
@@ -278,6 +280,12 @@ class Ipv4GlobalRouting : public Ipv4RoutingProtocol
     NetworkRoutes m_networkRoutes;       //!< Routes to networks
     ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+    Ipv4RoutingTableIndex m_hostIndex;       //!< Index of m_hostRoutes
+    Ipv4RoutingTableIndex m_networkIndex;    //!< Index of m_networkRoutes
+    Ipv4RoutingTableIndex m_ASexternalIndex; //!< Index of m_ASexternalRoutes
+    /// the matches of the last lookup in one of the indexes
+    std::vector<Ipv4RoutingTableIndex::Match> m_matches;
+
     Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
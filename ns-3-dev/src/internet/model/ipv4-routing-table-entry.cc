@@ -22,6 +22,8 @@
 #include "ns3/assert.h"
 #include "ns3/log.h"
 
+#include <algorithm>
+
 namespace ns3
 {
 
@@ -364,4 +366,126 @@ operator==(const Ipv4MulticastRoutingTableEntry a, const Ipv4MulticastRoutingTab
             a.GetOutputInterfaces() == b.GetOutputInterfaces());
 }
 
+/*****************************************************
+ *     Ipv4RoutingTableIndex
+ *****************************************************/
+
+Ipv4RoutingTableIndex::Ipv4RoutingTableIndex()
+    : m_order(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+Ipv4RoutingTableIndex::Add(Ipv4RoutingTableEntry* route, uint32_t metric)
+{
+    NS_LOG_FUNCTION(this << route << metric);
+    Ipv4Mask mask = route->GetDestNetworkMask();
+    uint16_t prefixLength = mask.GetPrefixLength();
+    auto group = std::find_if(m_groups.begin(), m_groups.end(), [mask](const Group& g) {
+        return g.mask == mask;
+    });
+    if (group == m_groups.end())
+    {
+        // keep the groups sorted by decreasing prefix length
+        group = std::find_if(m_groups.begin(), m_groups.end(), [prefixLength](const Group& g) {
+            return g.prefixLength < prefixLength;
+        });
+        group = m_groups.insert(group, Group{mask, prefixLength, {}});
+    }
+    uint32_t network = route->GetDestNetwork().Get() & mask.Get();
+    group->routes[network].push_back({route, metric, m_order++, prefixLength});
+}
+
+void
+Ipv4RoutingTableIndex::Remove(const Ipv4RoutingTableEntry* route)
+{
+    NS_LOG_FUNCTION(this << route);
+    Ipv4Mask mask = route->GetDestNetworkMask();
+    for (auto group = m_groups.begin(); group != m_groups.end(); group++)
+    {
+        if (group->mask != mask)
+        {
+            continue;
+        }
+        auto bucket = group->routes.find(route->GetDestNetwork().Get() & mask.Get());
+        if (bucket == group->routes.end())
+        {
+            break;
+        }
+        std::vector<Match>& matches = bucket->second;
+        for (auto match = matches.begin(); match != matches.end(); match++)
+        {
+            if (match->route == route)
+            {
+                matches.erase(match);
+                break;
+            }
+        }
+        if (matches.empty())
+        {
+            group->routes.erase(bucket);
+            if (group->routes.empty())
+            {
+                m_groups.erase(group);
+            }
+        }
+        return;
+    }
+    NS_ASSERT_MSG(false, "Route " << *route << " is not in the index");
+}
+
+void
+Ipv4RoutingTableIndex::Clear()
+{
+    NS_LOG_FUNCTION(this);
+    m_groups.clear();
+}
+
+void
+Ipv4RoutingTableIndex::Lookup(Ipv4Address dest, std::vector<Match>& matches) const
+{
+    NS_LOG_FUNCTION(this << dest);
+    matches.clear();
+    for (const auto& group : m_groups)
+    {
+        auto bucket = group.routes.find(dest.Get() & group.mask.Get());
+        if (bucket != group.routes.end())
+        {
+            matches.insert(matches.end(), bucket->second.begin(), bucket->second.end());
+        }
+    }
+}
+
+void
+Ipv4RoutingTableIndex::LookupNetwork(Ipv4Address network,
+                                     Ipv4Mask mask,
+                                     std::vector<Match>& matches) const
+{
+    NS_LOG_FUNCTION(this << network << mask);
+    matches.clear();
+    const Group* group = FindGroup(mask);
+    if (group)
+    {
+        auto bucket = group->routes.find(network.Get() & mask.Get());
+        if (bucket != group->routes.end())
+        {
+            matches = bucket->second;
+        }
+    }
+}
+
+const Ipv4RoutingTableIndex::Group*
+Ipv4RoutingTableIndex::FindGroup(Ipv4Mask mask) const
+{
+    for (const auto& group : m_groups)
+    {
+        if (group.mask == mask)
+        {
+            return &group;
+        }
+    }
+    return nullptr;
+}
+
 } // namespace ns3
@@ -23,6 +23,7 @@
 
 #include <list>
 #include <ostream>
+#include <unordered_map>
 #include <vector>
 
 namespace ns3
@@ -288,6 +289,93 @@ std::ostream& operator<<(std::ostream& os, const Ipv4MulticastRoutingTableEntry&
  */
 bool operator==(const Ipv4MulticastRoutingTableEntry a, const Ipv4MulticastRoutingTableEntry b);
 
+/**
+ * \ingroup ipv4Routing
+ *
+ * An index of Ipv4RoutingTableEntry by destination network, for the longest
+ * prefix match lookups of Ipv4StaticRouting and Ipv4GlobalRouting.
+ *
+ * The entries are grouped by network mask, and each group is a hash table
+ * keyed by the destination network.  A lookup probes every group once, from
+ * the longest mask to the shortest, so that its cost depends on the number of
+ * distinct masks in the table instead of the number of routes.  The index
+ * does not own the entries.  It records the order in which they were added,
+ * which the routing protocols use to break ties the way a scan of their
+ * route lists would.
+ */
+class Ipv4RoutingTableIndex
+{
+  public:
+    /**
+     * An entry of the index.
+     */
+    struct Match
+    {
+        Ipv4RoutingTableEntry* route; //!< the routing table entry
+        uint32_t metric;              //!< the metric of the route
+        uint64_t order;               //!< rank of the entry in the order they were added
+        uint16_t prefixLength;        //!< prefix length of the destination network
+    };
+
+    Ipv4RoutingTableIndex();
+
+    /**
+     * \brief Add an entry.
+     * \param route the entry, which must not be in the index yet
+     * \param metric the metric of the route
+     */
+    void Add(Ipv4RoutingTableEntry* route, uint32_t metric = 0);
+
+    /**
+     * \brief Remove an entry.
+     * \param route the entry
+     */
+    void Remove(const Ipv4RoutingTableEntry* route);
+
+    /**
+     * \brief Remove all the entries.
+     */
+    void Clear();
+
+    /**
+     * \brief Get the entries whose destination network contains an address.
+     * \param dest the address
+     * \param matches [out] the entries, by decreasing prefix length; those with
+     * the same network mask are in the order they were added
+     */
+    void Lookup(Ipv4Address dest, std::vector<Match>& matches) const;
+
+    /**
+     * \brief Get the entries of a destination network.
+     * \param network the destination network
+     * \param mask the network mask
+     * \param matches [out] the entries, in the order they were added
+     */
+    void LookupNetwork(Ipv4Address network, Ipv4Mask mask, std::vector<Match>& matches) const;
+
+  private:
+    /**
+     * The entries with the same network mask.
+     */
+    struct Group
+    {
+        Ipv4Mask mask;         //!< the network mask
+        uint16_t prefixLength; //!< the prefix length of the mask
+        /// the entries, by destination network
+        std::unordered_map<uint32_t, std::vector<Match>> routes;
+    };
+
+    /**
+     * \brief Find the group of a network mask.
+     * \param mask the network mask
+     * \returns the group, or nullptr
+     */
+    const Group* FindGroup(Ipv4Mask mask) const;
+
+    std::vector<Group> m_groups; //!< groups, by decreasing prefix length
+    uint64_t m_order;            //!< rank of the next entry
+};
+
 } // namespace ns3
 
 #endif /* IPV4_ROUTING_TABLE_ENTRY_H */
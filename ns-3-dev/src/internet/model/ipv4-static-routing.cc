@@ -80,6 +80,7 @@ Ipv4StaticRouting::AddNetworkRouteTo(Ipv4Address network,
     {
         auto routePtr = new Ipv4RoutingTableEntry(route);
         m_networkRoutes.emplace_back(routePtr, metric);
+        m_networkIndex.Add(routePtr, metric);
     }
 }
 
@@ -98,6 +99,7 @@ Ipv4StaticRouting::AddNetworkRouteTo(Ipv4Address network,
         auto routePtr = new Ipv4RoutingTableEntry(route);
 
         m_networkRoutes.emplace_back(routePtr, metric);
+        m_networkIndex.Add(routePtr, metric);
     }
 }
 
@@ -153,6 +155,7 @@ Ipv4StaticRouting::SetDefaultMulticastRoute(uint32_t outputInterface)
     Ipv4Mask networkMask("240.0.0.0");
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, outputInterface);
     m_networkRoutes.emplace_back(route, 0);
+    m_networkIndex.Add(route, 0);
 }
 
 uint32_t
@@ -224,14 +227,15 @@ Ipv4StaticRouting::RemoveMulticastRoute(uint32_t index)
 bool
 Ipv4StaticRouting::LookupRoute(const Ipv4RoutingTableEntry& route, uint32_t metric)
 {
-    for (auto j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j++)
+    m_networkIndex.LookupNetwork(route.GetDest(), route.GetDestNetworkMask(), m_matches);
+    for (const auto& match : m_matches)
     {
-        Ipv4RoutingTableEntry* rtentry = j->first;
+        Ipv4RoutingTableEntry* rtentry = match.route;
 
         if (rtentry->GetDest() == route.GetDest() &&
             rtentry->GetDestNetworkMask() == route.GetDestNetworkMask() &&
             rtentry->GetGateway() == route.GetGateway() &&
-            rtentry->GetInterface() == route.GetInterface() && j->second == metric)
+            rtentry->GetInterface() == route.GetInterface() && match.metric == metric)
         {
             return true;
         }
@@ -261,55 +265,55 @@ Ipv4StaticRouting::LookupStatic(Ipv4Address dest, Ptr<NetDevice> oif)
         return rtentry;
     }
 
-    for (auto i = m_networkRoutes.begin(); i != m_networkRoutes.end(); i++)
-    {
-        Ipv4RoutingTableEntry* j = i->first;
-        uint32_t metric = i->second;
-        Ipv4Mask mask = (j)->GetDestNetworkMask();
-        uint16_t masklen = mask.GetPrefixLength();
-        Ipv4Address entry = (j)->GetDestNetwork();
-        NS_LOG_LOGIC("Searching for route to " << dest << ", checking against route to " << entry
-                                               << "/" << masklen);
-        if (mask.IsMatch(dest, entry))
+    // The matching routes come by decreasing mask length.  Among the routes
+    // with the longest mask, pick the one with the lowest metric, the last
+    // one added in case of a tie, except for host routes, where the first one
+    // added wins.  This is the route a scan of m_networkRoutes would find.
+    m_networkIndex.Lookup(dest, m_matches);
+    const Ipv4RoutingTableIndex::Match* best = nullptr;
+    for (const auto& match : m_matches)
+    {
+        Ipv4RoutingTableEntry* j = match.route;
+        uint32_t metric = match.metric;
+        uint16_t masklen = match.prefixLength;
+        NS_LOG_LOGIC("Found global network route " << j << ", mask length " << masklen
+                                                   << ", metric " << metric);
+        if (best && masklen < longest_mask) // Not interested if got shorter mask
         {
-            NS_LOG_LOGIC("Found global network route " << j << ", mask length " << masklen
-                                                       << ", metric " << metric);
-            if (oif)
-            {
-                if (oif != m_ipv4->GetNetDevice(j->GetInterface()))
-                {
-                    NS_LOG_LOGIC("Not on requested interface, skipping");
-                    continue;
-                }
-            }
-            if (masklen < longest_mask) // Not interested if got shorter mask
+            NS_LOG_LOGIC("Previous match longer, done");
+            break;
+        }
+        if (oif)
+        {
+            if (oif != m_ipv4->GetNetDevice(j->GetInterface()))
             {
-                NS_LOG_LOGIC("Previous match longer, skipping");
+                NS_LOG_LOGIC("Not on requested interface, skipping");
                 continue;
             }
-            if (masklen > longest_mask) // Reset metric if longer masklen
-            {
-                shortest_metric = 0xffffffff;
-            }
-            longest_mask = masklen;
-            if (metric > shortest_metric)
+        }
+        if (best)
+        {
+            if (masklen == 32 ? match.order > best->order
+                              : (metric > shortest_metric ||
+                                 (metric == shortest_metric && match.order < best->order)))
             {
-                NS_LOG_LOGIC("Equal mask length, but previous metric shorter, skipping");
+                NS_LOG_LOGIC("Equal mask length, but previous route preferred, skipping");
                 continue;
             }
-            shortest_metric = metric;
-            Ipv4RoutingTableEntry* route = (j);
-            uint32_t interfaceIdx = route->GetInterface();
-            rtentry = Create<Ipv4Route>();
-            rtentry->SetDestination(route->GetDest());
-            rtentry->SetSource(m_ipv4->SourceAddressSelection(interfaceIdx, route->GetDest()));
-            rtentry->SetGateway(route->GetGateway());
-            rtentry->SetOutputDevice(m_ipv4->GetNetDevice(interfaceIdx));
-            if (masklen == 32)
-            {
-                break;
-            }
         }
+        longest_mask = masklen;
+        shortest_metric = metric;
+        best = &match;
+    }
+    if (best)
+    {
+        Ipv4RoutingTableEntry* route = best->route;
+        uint32_t interfaceIdx = route->GetInterface();
+        rtentry = Create<Ipv4Route>();
+        rtentry->SetDestination(route->GetDest());
+        rtentry->SetSource(m_ipv4->SourceAddressSelection(interfaceIdx, route->GetDest()));
+        rtentry->SetGateway(route->GetGateway());
+        rtentry->SetOutputDevice(m_ipv4->GetNetDevice(interfaceIdx));
     }
     if (rtentry)
     {
@@ -457,6 +461,7 @@ Ipv4StaticRouting::RemoveRoute(uint32_t index)
     {
         if (tmp == index)
         {
+            m_networkIndex.Remove(j->first);
             delete j->first;
             m_networkRoutes.erase(j);
             return;
@@ -588,6 +593,7 @@ void
 Ipv4StaticRouting::DoDispose()
 {
     NS_LOG_FUNCTION(this);
+    m_networkIndex.Clear();
     for (auto j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j = m_networkRoutes.erase(j))
     {
         delete (j->first);
@@ -631,6 +637,7 @@ Ipv4StaticRouting::NotifyInterfaceDown(uint32_t i)
     {
         if (it->first->GetInterface() == i)
         {
+            m_networkIndex.Remove(it->first);
             delete it->first;
             it = m_networkRoutes.erase(it);
         }
@@ -676,6 +683,7 @@ Ipv4StaticRouting::NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress
             it->first->GetDestNetwork() == networkAddress &&
             it->first->GetDestNetworkMask() == networkMask)
         {
+            m_networkIndex.Remove(it->first);
             delete it->first;
             it = m_networkRoutes.erase(it);
         }
@@ -23,6 +23,7 @@
 
 #include "ipv4-header.h"
 #include "ipv4-routing-protocol.h"
+#include "ipv4-routing-table-entry.h"
 #include "ipv4.h"
 
 #include "ns3/ipv4-address.h"
@@ -32,6 +33,7 @@
 #include <list>
 #include <stdint.h>
 #include <utility>
+#include <vector>
 
 namespace ns3
 {
@@ -411,6 +413,16 @@ class Ipv4StaticRouting : public Ipv4RoutingProtocol
      */
     NetworkRoutes m_networkRoutes;
 
+    /**
+     * \brief index of m_networkRoutes by destination, used by the lookups.
+     */
+    Ipv4RoutingTableIndex m_networkIndex;
+
+    /**
+     * \brief the matches of the last lookup in m_networkIndex.
+     */
+    std::vector<Ipv4RoutingTableIndex::Match> m_matches;
+
     /**
      * \brief the forwarding table for multicast.
      */
@@ -23,6 +23,8 @@
 
 #include "ns3/log.h"
 
+#include <algorithm>
+
 namespace ns3
 {
 
@@ -42,33 +44,109 @@ Ipv6EndPointDemux::~Ipv6EndPointDemux()
     for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
     {
         Ipv6EndPoint* endPoint = *i;
+        endPoint->m_demux = nullptr;
         delete endPoint;
     }
     m_endPoints.clear();
+    m_tuples.clear();
+    m_ports.clear();
 }
 
 bool
-Ipv6EndPointDemux::LookupPortLocal(uint16_t port)
+Ipv6EndPointDemux::Tuple::operator==(const Tuple& other) const
 {
-    NS_LOG_FUNCTION(this << port);
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    return localAddress == other.localAddress && localPort == other.localPort &&
+           peerAddress == other.peerAddress && peerPort == other.peerPort;
+}
+
+std::size_t
+Ipv6EndPointDemux::TupleHash::operator()(const Tuple& tuple) const
+{
+    Ipv6AddressHash addressHash;
+    std::size_t h = addressHash(tuple.localAddress);
+    h ^= addressHash(tuple.peerAddress) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    h ^= ((tuple.localPort << 16) | tuple.peerPort) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    return h;
+}
+
+Ipv6EndPointDemux::Tuple
+Ipv6EndPointDemux::GetTuple(const Ipv6EndPoint* endPoint)
+{
+    return {endPoint->GetLocalAddress(),
+            endPoint->GetLocalPort(),
+            endPoint->GetPeerAddress(),
+            endPoint->GetPeerPort()};
+}
+
+Ipv6EndPoint*
+Ipv6EndPointDemux::Insert(Ipv6EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    m_endPoints.push_back(endPoint);
+    IndexPort(endPoint);
+    Index(endPoint);
+    endPoint->m_demux = this;
+    NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
+    return endPoint;
+}
+
+void
+Ipv6EndPointDemux::Index(Ipv6EndPoint* endPoint)
+{
+    m_tuples[GetTuple(endPoint)].push_back(endPoint);
+}
+
+void
+Ipv6EndPointDemux::Unindex(Ipv6EndPoint* endPoint)
+{
+    auto i = m_tuples.find(GetTuple(endPoint));
+    NS_ASSERT(i != m_tuples.end());
+    auto& endPoints = i->second;
+    endPoints.erase(std::find(endPoints.begin(), endPoints.end(), endPoint));
+    if (endPoints.empty())
     {
-        if ((*i)->GetLocalPort() == port)
-        {
-            return true;
-        }
+        m_tuples.erase(i);
+    }
+}
+
+void
+Ipv6EndPointDemux::IndexPort(Ipv6EndPoint* endPoint)
+{
+    m_ports[endPoint->GetLocalPort()].push_back(endPoint);
+}
+
+void
+Ipv6EndPointDemux::UnindexPort(Ipv6EndPoint* endPoint)
+{
+    auto i = m_ports.find(endPoint->GetLocalPort());
+    NS_ASSERT(i != m_ports.end());
+    auto& endPoints = i->second;
+    endPoints.erase(std::find(endPoints.begin(), endPoints.end(), endPoint));
+    if (endPoints.empty())
+    {
+        m_ports.erase(i);
     }
-    return false;
+}
+
+bool
+Ipv6EndPointDemux::LookupPortLocal(uint16_t port)
+{
+    NS_LOG_FUNCTION(this << port);
+    return m_ports.find(port) != m_ports.end();
 }
 
 bool
 Ipv6EndPointDemux::LookupLocal(Ptr<NetDevice> boundNetDevice, Ipv6Address addr, uint16_t port)
 {
     NS_LOG_FUNCTION(this << addr << port);
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    auto endPoints = m_ports.find(port);
+    if (endPoints == m_ports.end())
     {
-        if ((*i)->GetLocalPort() == port && (*i)->GetLocalAddress() == addr &&
-            (*i)->GetBoundNetDevice() == boundNetDevice)
+        return false;
+    }
+    for (auto endPoint : endPoints->second)
+    {
+        if (endPoint->GetLocalAddress() == addr && endPoint->GetBoundNetDevice() == boundNetDevice)
         {
             return true;
         }
@@ -86,10 +164,7 @@ Ipv6EndPointDemux::Allocate()
         NS_LOG_WARN("Ephemeral port allocation failed.");
         return nullptr;
     }
-    auto endPoint = new Ipv6EndPoint(Ipv6Address::GetAny(), port);
-    m_endPoints.push_back(endPoint);
-    NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
-    return endPoint;
+    return Insert(new Ipv6EndPoint(Ipv6Address::GetAny(), port));
 }
 
 Ipv6EndPoint*
@@ -102,10 +177,7 @@ Ipv6EndPointDemux::Allocate(Ipv6Address address)
         NS_LOG_WARN("Ephemeral port allocation failed.");
         return nullptr;
     }
-    auto endPoint = new Ipv6EndPoint(address, port);
-    m_endPoints.push_back(endPoint);
-    NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
-    return endPoint;
+    return Insert(new Ipv6EndPoint(address, port));
 }
 
 Ipv6EndPoint*
@@ -125,10 +197,7 @@ Ipv6EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice, Ipv6Address address,
         NS_LOG_WARN("Duplicated endpoint.");
         return nullptr;
     }
-    auto endPoint = new Ipv6EndPoint(address, port);
-    m_endPoints.push_back(endPoint);
-    NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
-    return endPoint;
+    return Insert(new Ipv6EndPoint(address, port));
 }
 
 Ipv6EndPoint*
@@ -139,23 +208,21 @@ Ipv6EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice,
                             uint16_t peerPort)
 {
     NS_LOG_FUNCTION(this << boundNetDevice << localAddress << localPort << peerAddress << peerPort);
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    auto endPoints = m_tuples.find({localAddress, localPort, peerAddress, peerPort});
+    if (endPoints != m_tuples.end())
     {
-        if ((*i)->GetLocalPort() == localPort && (*i)->GetLocalAddress() == localAddress &&
-            (*i)->GetPeerPort() == peerPort && (*i)->GetPeerAddress() == peerAddress &&
-            ((*i)->GetBoundNetDevice() == boundNetDevice || !(*i)->GetBoundNetDevice()))
+        for (auto endPoint : endPoints->second)
         {
-            NS_LOG_WARN("Duplicated endpoint.");
-            return nullptr;
+            if (endPoint->GetBoundNetDevice() == boundNetDevice || !endPoint->GetBoundNetDevice())
+            {
+                NS_LOG_WARN("Duplicated endpoint.");
+                return nullptr;
+            }
         }
     }
     auto endPoint = new Ipv6EndPoint(localAddress, localPort);
     endPoint->SetPeer(peerAddress, peerPort);
-    m_endPoints.push_back(endPoint);
-
-    NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
-
-    return endPoint;
+    return Insert(endPoint);
 }
 
 void
@@ -166,6 +233,9 @@ Ipv6EndPointDemux::DeAllocate(Ipv6EndPoint* endPoint)
     {
         if (*i == endPoint)
         {
+            Unindex(endPoint);
+            UnindexPort(endPoint);
+            endPoint->m_demux = nullptr;
             delete endPoint;
             m_endPoints.erase(i);
             break;
@@ -173,30 +243,18 @@ Ipv6EndPointDemux::DeAllocate(Ipv6EndPoint* endPoint)
     }
 }
 
-/*
- * If we have an exact match, we return it.
- * Otherwise, if we find a generic match, we return it.
- * Otherwise, we return 0.
- */
-Ipv6EndPointDemux::EndPoints
-Ipv6EndPointDemux::Lookup(Ipv6Address daddr,
-                          uint16_t dport,
-                          Ipv6Address saddr,
-                          uint16_t sport,
-                          Ptr<Ipv6Interface> incomingInterface)
+void
+Ipv6EndPointDemux::AddMatches(EndPoints& matches,
+                              const Tuple& tuple,
+                              Ptr<Ipv6Interface> incomingInterface) const
 {
-    NS_LOG_FUNCTION(this << daddr << dport << saddr << sport << incomingInterface);
-
-    EndPoints retval1; /* Matches exact on local port, wildcards on others */
-    EndPoints retval2; /* Matches exact on local port/adder, wildcards on others */
-    EndPoints retval3; /* Matches all but local address */
-    EndPoints retval4; /* Exact match on all 4 */
-
-    NS_LOG_DEBUG("Looking up endpoint for destination address " << daddr);
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    auto endPoints = m_tuples.find(tuple);
+    if (endPoints == m_tuples.end())
+    {
+        return;
+    }
+    for (auto endP : endPoints->second)
     {
-        Ipv6EndPoint* endP = *i;
-
         NS_LOG_DEBUG("Looking at endpoint dport="
                      << endP->GetLocalPort() << " daddr=" << endP->GetLocalAddress()
                      << " sport=" << endP->GetPeerPort() << " saddr=" << endP->GetPeerAddress());
@@ -208,14 +266,6 @@ Ipv6EndPointDemux::Lookup(Ipv6Address daddr,
             continue;
         }
 
-        if (endP->GetLocalPort() != dport)
-        {
-            NS_LOG_LOGIC("Skipping endpoint " << &endP << " because endpoint dport "
-                                              << endP->GetLocalPort()
-                                              << " does not match packet dport " << dport);
-            continue;
-        }
-
         if (endP->GetBoundNetDevice())
         {
             if (!incomingInterface)
@@ -232,73 +282,47 @@ Ipv6EndPointDemux::Lookup(Ipv6Address daddr,
             }
         }
 
-        /*    Ipv6Address incomingInterfaceAddr = incomingInterface->GetAddress (); */
-        NS_LOG_DEBUG("dest addr " << daddr);
-
-        bool localAddressMatchesWildCard = endP->GetLocalAddress() == Ipv6Address::GetAny();
-        bool localAddressMatchesExact = endP->GetLocalAddress() == daddr;
-        bool localAddressMatchesAllRouters =
-            endP->GetLocalAddress() == Ipv6Address::GetAllRoutersMulticast();
-
-        /* if no match here, keep looking */
-        if (!(localAddressMatchesExact || localAddressMatchesWildCard))
-        {
-            continue;
-        }
-        bool remotePeerMatchesExact = endP->GetPeerPort() == sport;
-        bool remotePeerMatchesWildCard = endP->GetPeerPort() == 0;
-        bool remoteAddressMatchesExact = endP->GetPeerAddress() == saddr;
-        bool remoteAddressMatchesWildCard = endP->GetPeerAddress() == Ipv6Address::GetAny();
-
-        /* If remote does not match either with exact or wildcard,i
-           skip this one */
-        if (!(remotePeerMatchesExact || remotePeerMatchesWildCard))
-        {
-            continue;
-        }
-        if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
-        {
-            continue;
-        }
-
-        /* Now figure out which return list to add this one to */
-        if (localAddressMatchesWildCard && remotePeerMatchesWildCard &&
-            remoteAddressMatchesWildCard)
-        { /* Only local port matches exactly */
-            retval1.push_back(endP);
-        }
-        if ((localAddressMatchesExact || (localAddressMatchesAllRouters)) &&
-            remotePeerMatchesWildCard && remoteAddressMatchesWildCard)
-        { /* Only local port and local address matches exactly */
-            retval2.push_back(endP);
-        }
-        if (localAddressMatchesWildCard && remotePeerMatchesExact && remoteAddressMatchesExact)
-        { /* All but local address */
-            retval3.push_back(endP);
-        }
-        if (localAddressMatchesExact && remotePeerMatchesExact && remoteAddressMatchesExact)
-        { /* All 4 match */
-            retval4.push_back(endP);
-        }
+        NS_LOG_LOGIC("Found an endpoint, adding " << endP->GetLocalAddress() << ":"
+                                                  << endP->GetLocalPort());
+        matches.push_back(endP);
     }
+}
 
-    // Here we find the most exact match
+/*
+ * If we have an exact match, we return it.
+ * Otherwise, if we find a generic match, we return it.
+ * Otherwise, we return 0.
+ */
+Ipv6EndPointDemux::EndPoints
+Ipv6EndPointDemux::Lookup(Ipv6Address daddr,
+                          uint16_t dport,
+                          Ipv6Address saddr,
+                          uint16_t sport,
+                          Ptr<Ipv6Interface> incomingInterface)
+{
+    NS_LOG_FUNCTION(this << daddr << dport << saddr << sport << incomingInterface);
+
+    NS_LOG_DEBUG("Looking up endpoint for destination address " << daddr);
     EndPoints retval;
-    if (!retval4.empty())
-    {
-        retval = retval4;
-    }
-    else if (!retval3.empty())
+
+    /* All 4 match */
+    AddMatches(retval, {daddr, dport, saddr, sport}, incomingInterface);
+    /* All but local address */
+    if (retval.empty() && daddr != Ipv6Address::GetAny())
     {
-        retval = retval3;
+        AddMatches(retval, {Ipv6Address::GetAny(), dport, saddr, sport}, incomingInterface);
     }
-    else if (!retval2.empty())
+    /* Only local port and local address matches exactly */
+    if (retval.empty())
     {
-        retval = retval2;
+        AddMatches(retval, {daddr, dport, Ipv6Address::GetAny(), 0}, incomingInterface);
     }
-    else
+    /* Only local port matches exactly */
+    if (retval.empty() && daddr != Ipv6Address::GetAny())
     {
-        retval = retval1;
+        AddMatches(retval,
+                   {Ipv6Address::GetAny(), dport, Ipv6Address::GetAny(), 0},
+                   incomingInterface);
     }
 
     NS_ABORT_MSG_IF(retval.size() > 1,
@@ -313,15 +337,15 @@ Ipv6EndPointDemux::SimpleLookup(Ipv6Address dst, uint16_t dport, Ipv6Address src
     uint32_t genericity = 3;
     Ipv6EndPoint* generic = nullptr;
 
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    auto endPoints = m_ports.find(dport);
+    if (endPoints == m_ports.end())
+    {
+        return nullptr;
+    }
+    for (auto i = endPoints->second.begin(); i != endPoints->second.end(); i++)
     {
         uint32_t tmp = 0;
 
-        if ((*i)->GetLocalPort() != dport)
-        {
-            continue;
-        }
-
         if ((*i)->GetLocalAddress() == dst && (*i)->GetPeerPort() == sport &&
             (*i)->GetPeerAddress() == src)
         {
@@ -26,6 +26,8 @@
 
 #include <list>
 #include <stdint.h>
+#include <unordered_map>
+#include <vector>
 
 namespace ns3
 {
@@ -36,6 +38,9 @@ class Ipv6EndPoint;
  * \ingroup ipv6
  *
  * \brief Demultiplexer for end points.
+ *
+ * The endpoints are indexed by their four-tuple and by their local port, as
+ * in Ipv4EndPointDemux.
  */
 class Ipv6EndPointDemux
 {
@@ -161,6 +166,92 @@ class Ipv6EndPointDemux
     EndPoints GetEndPoints() const;
 
   private:
+    friend class Ipv6EndPoint;
+
+    /**
+     * \brief The four-tuple of an endpoint.
+     */
+    struct Tuple
+    {
+        Ipv6Address localAddress; //!< Local address
+        uint16_t localPort;       //!< Local port
+        Ipv6Address peerAddress;  //!< Peer address
+        uint16_t peerPort;        //!< Peer port
+
+        /**
+         * \param other the tuple to compare to
+         * \return true if both tuples are the same
+         */
+        bool operator==(const Tuple& other) const;
+    };
+
+    /**
+     * \brief Hash function of a Tuple.
+     */
+    struct TupleHash
+    {
+        /**
+         * \param tuple the tuple to hash
+         * \return the hash of the tuple
+         */
+        std::size_t operator()(const Tuple& tuple) const;
+    };
+
+    /**
+     * \brief Get the four-tuple of an end point.
+     * \param endPoint the end point
+     * \return the four-tuple
+     */
+    static Tuple GetTuple(const Ipv6EndPoint* endPoint);
+
+    /**
+     * \brief Add a new end point to the list and to the indexes.
+     * \param endPoint the end point
+     * \return the end point
+     */
+    Ipv6EndPoint* Insert(Ipv6EndPoint* endPoint);
+
+    /**
+     * \brief Add an end point to the four-tuple index.
+     * \param endPoint the end point
+     */
+    void Index(Ipv6EndPoint* endPoint);
+
+    /**
+     * \brief Remove an end point from the four-tuple index.
+     *
+     * Must be called before the four-tuple of the end point is changed.
+     *
+     * \param endPoint the end point
+     */
+    void Unindex(Ipv6EndPoint* endPoint);
+
+    /**
+     * \brief Add an end point to the local port index.
+     * \param endPoint the end point
+     */
+    void IndexPort(Ipv6EndPoint* endPoint);
+
+    /**
+     * \brief Remove an end point from the local port index.
+     *
+     * Must be called before the local port of the end point is changed.
+     *
+     * \param endPoint the end point
+     */
+    void UnindexPort(Ipv6EndPoint* endPoint);
+
+    /**
+     * \brief Append the end points with a four-tuple which can receive
+     * packets from an interface.
+     * \param matches the end points found
+     * \param tuple the four-tuple
+     * \param incomingInterface the incoming interface
+     */
+    void AddMatches(EndPoints& matches,
+                    const Tuple& tuple,
+                    Ptr<Ipv6Interface> incomingInterface) const;
+
     /**
      * \brief Allocate a ephemeral port.
      * \return a port
@@ -186,6 +277,16 @@ class Ipv6EndPointDemux
      * \brief A list of IPv6 end points.
      */
     EndPoints m_endPoints;
+
+    /**
+     * \brief The IPv6 end points, by four-tuple.
+     */
+    std::unordered_map<Tuple, std::vector<Ipv6EndPoint*>, TupleHash> m_tuples;
+
+    /**
+     * \brief The IPv6 end points, by local port.
+     */
+    std::unordered_map<uint16_t, std::vector<Ipv6EndPoint*>> m_ports;
 };
 
 } /* namespace ns3 */
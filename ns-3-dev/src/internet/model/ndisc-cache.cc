@@ -101,9 +101,9 @@ NdiscCache::Lookup(Ipv6Address dst)
 {
     NS_LOG_FUNCTION(this << dst);
 
-    if (m_ndCache.find(dst) != m_ndCache.end())
+    NdiscCache::Entry* entry = m_ndCache.Lookup(dst);
+    if (entry)
     {
-        NdiscCache::Entry* entry = m_ndCache[dst];
         NS_LOG_LOGIC("Found an entry: " << *entry);
 
         return entry;
@@ -118,9 +118,8 @@ NdiscCache::LookupInverse(Address dst)
     NS_LOG_FUNCTION(this << dst);
 
     std::list<NdiscCache::Entry*> entryList;
-    for (auto i = m_ndCache.begin(); i != m_ndCache.end(); i++)
+    for (auto entry : m_ndCache.GetSortedEntries())
     {
-        NdiscCache::Entry* entry = (*i).second;
         if (entry->GetMacAddress() == dst)
         {
             NS_LOG_LOGIC("Found an entry:" << (*entry));
@@ -134,11 +133,10 @@ NdiscCache::Entry*
 NdiscCache::Add(Ipv6Address to)
 {
     NS_LOG_FUNCTION(this << to);
-    NS_ASSERT(m_ndCache.find(to) == m_ndCache.end());
+    NS_ASSERT(!m_ndCache.Lookup(to));
 
-    auto entry = new NdiscCache::Entry(this);
+    NdiscCache::Entry* entry = m_ndCache.Emplace(to, this);
     entry->SetIpv6Address(to);
-    m_ndCache[to] = entry;
     return entry;
 }
 
@@ -147,16 +145,21 @@ NdiscCache::Remove(NdiscCache::Entry* entry)
 {
     NS_LOG_FUNCTION(this << entry);
 
-    for (auto i = m_ndCache.begin(); i != m_ndCache.end(); i++)
+    auto i = m_ndCache.Find(entry->GetIpv6Address());
+    if (i == m_ndCache.End() || i->second != entry)
     {
-        if ((*i).second == entry)
+        // the address of the entry has been changed since it was added
+        i = m_ndCache.Begin();
+        while (i != m_ndCache.End() && i->second != entry)
         {
-            m_ndCache.erase(i);
-            entry->ClearWaitingPacket();
-            delete entry;
-            return;
+            ++i;
         }
     }
+    if (i != m_ndCache.End())
+    {
+        entry->ClearWaitingPacket();
+        m_ndCache.Erase(i);
+    }
 }
 
 void
@@ -164,12 +167,7 @@ NdiscCache::Flush()
 {
     NS_LOG_FUNCTION(this);
 
-    for (auto i = m_ndCache.begin(); i != m_ndCache.end(); i++)
-    {
-        delete (*i).second; /* delete the pointer NdiscCache::Entry */
-    }
-
-    m_ndCache.erase(m_ndCache.begin(), m_ndCache.end());
+    m_ndCache.Clear();
 }
 
 void
@@ -192,9 +190,9 @@ NdiscCache::PrintNdiscCache(Ptr<OutputStreamWrapper> stream)
     NS_LOG_FUNCTION(this << stream);
     std::ostream* os = stream->GetStream();
 
-    for (auto i = m_ndCache.begin(); i != m_ndCache.end(); i++)
+    for (auto entry : m_ndCache.GetSortedEntries())
     {
-        *os << i->first << " dev ";
+        *os << entry->GetIpv6Address() << " dev ";
         std::string found = Names::FindName(m_device);
         if (!Names::FindName(m_device).empty())
         {
@@ -205,33 +203,33 @@ NdiscCache::PrintNdiscCache(Ptr<OutputStreamWrapper> stream)
             *os << static_cast<int>(m_device->GetIfIndex());
         }
 
-        *os << " lladdr " << i->second->GetMacAddress();
+        *os << " lladdr " << entry->GetMacAddress();
 
-        if (i->second->IsReachable())
+        if (entry->IsReachable())
         {
             *os << " REACHABLE\n";
         }
-        else if (i->second->IsDelay())
+        else if (entry->IsDelay())
         {
             *os << " DELAY\n";
         }
-        else if (i->second->IsIncomplete())
+        else if (entry->IsIncomplete())
         {
             *os << " INCOMPLETE\n";
         }
-        else if (i->second->IsProbe())
+        else if (entry->IsProbe())
         {
             *os << " PROBE\n";
         }
-        else if (i->second->IsStale())
+        else if (entry->IsStale())
         {
             *os << " STALE\n";
         }
-        else if (i->second->IsPermanent())
+        else if (entry->IsPermanent())
         {
             *os << " PERMANENT\n";
         }
-        else if (i->second->IsAutoGenerated())
+        else if (entry->IsAutoGenerated())
         {
             *os << " STATIC_AUTOGENERATED\n";
         }
@@ -717,16 +715,12 @@ void
 NdiscCache::RemoveAutoGeneratedEntries()
 {
     NS_LOG_FUNCTION(this);
-    for (auto i = m_ndCache.begin(); i != m_ndCache.end();)
+    for (auto entry : m_ndCache.GetSortedEntries())
     {
-        if (i->second->IsAutoGenerated())
+        if (entry->IsAutoGenerated())
         {
-            i->second->ClearWaitingPacket();
-            delete i->second;
-            m_ndCache.erase(i++);
-            continue;
+            Remove(entry);
         }
-        i++;
     }
 }
 
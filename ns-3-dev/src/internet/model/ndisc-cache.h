@@ -20,6 +20,8 @@
 #ifndef NDISC_CACHE_H
 #define NDISC_CACHE_H
 
+#include "cache-table.h"
+
 #include "ns3/ipv6-address.h"
 #include "ns3/net-device.h"
 #include "ns3/nstime.h"
@@ -29,7 +31,6 @@
 #include "ns3/timer.h"
 
 #include <list>
-#include <map>
 #include <stdint.h>
 
 namespace ns3
@@ -44,6 +45,8 @@ class Icmpv6L4Protocol;
  * \ingroup ipv6
  *
  * \brief IPv6 Neighbor Discovery cache.
+ *
+ * The entries are kept in a CacheTable; each entry runs its own NUD timer.
  */
 class NdiscCache : public Object
 {
@@ -457,11 +460,11 @@ class NdiscCache : public Object
     /**
      * \brief Neighbor Discovery Cache container
      */
-    typedef std::map<Ipv6Address, NdiscCache::Entry*> Cache;
+    typedef CacheTable<Ipv6Address, NdiscCache::Entry, Ipv6AddressHash> Cache;
     /**
      * \brief Neighbor Discovery Cache container iterator
      */
-    typedef std::map<Ipv6Address, NdiscCache::Entry*>::iterator CacheI;
+    typedef Cache::Iterator CacheI;
 
     /**
      * \brief A list of Entry.
@@ -0,0 +1,240 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Unit tests of the lookups of Ipv4EndPointDemux and Ipv6EndPointDemux
+
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv4-interface-address.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv6-end-point-demux.h"
+#include "ns3/ipv6-end-point.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief Ipv4EndPointDemux lookup test.
+ *
+ * Checks that the most specific endpoint is found (connected, then bound
+ * to a peer only, then bound to the local address, then bound to the port
+ * only), including subnet-directed broadcasts, and that the index follows
+ * the changes of the endpoints.
+ */
+class Ipv4EndPointDemuxTestCase : public TestCase
+{
+  public:
+    Ipv4EndPointDemuxTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Lookup an endpoint.
+     * \param daddr destination address
+     * \param dport destination port
+     * \param saddr source address
+     * \param sport source port
+     * \returns the endpoint found, nullptr if none
+     */
+    Ipv4EndPoint* Lookup(Ipv4Address daddr, uint16_t dport, Ipv4Address saddr, uint16_t sport);
+
+    Ipv4EndPointDemux m_demux;      //!< The demux under test
+    Ptr<Ipv4Interface> m_interface; //!< The incoming interface
+};
+
+Ipv4EndPointDemuxTestCase::Ipv4EndPointDemuxTestCase()
+    : TestCase("Lookup of the IPv4 endpoints")
+{
+}
+
+Ipv4EndPoint*
+Ipv4EndPointDemuxTestCase::Lookup(Ipv4Address daddr,
+                                  uint16_t dport,
+                                  Ipv4Address saddr,
+                                  uint16_t sport)
+{
+    Ipv4EndPointDemux::EndPoints endPoints =
+        m_demux.Lookup(daddr, dport, saddr, sport, m_interface);
+    NS_TEST_EXPECT_MSG_LT(endPoints.size(), 2, "Several endpoints found");
+    return endPoints.empty() ? nullptr : endPoints.front();
+}
+
+void
+Ipv4EndPointDemuxTestCase::DoRun()
+{
+    Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice>();
+    Ptr<SimpleNetDevice> otherDevice = CreateObject<SimpleNetDevice>();
+    m_interface = CreateObject<Ipv4Interface>();
+    m_interface->SetDevice(device);
+    m_interface->AddAddress(Ipv4InterfaceAddress("10.1.1.1", "255.255.255.0"));
+
+    Ipv4Address local("10.1.1.1");
+    Ipv4Address peer("10.2.2.2");
+
+    Ipv4EndPoint* any = m_demux.Allocate(nullptr, Ipv4Address::GetAny(), 9);
+    NS_TEST_EXPECT_MSG_EQ(Lookup(local, 9, peer, 1000), any, "Port-only endpoint not found");
+    NS_TEST_EXPECT_MSG_EQ(Lookup(local, 10, peer, 1000), nullptr, "Wrong port matched");
+
+    Ipv4EndPoint* bound = m_demux.Allocate(nullptr, local, 9);
+    NS_TEST_EXPECT_MSG_EQ(Lookup(local, 9, peer, 1000), bound, "Bound endpoint not preferred");
+    NS_TEST_EXPECT_MSG_EQ(m_demux.Allocate(nullptr, local, 9), nullptr, "Duplicate allowed");
+
+    Ipv4EndPoint* connected = m_demux.Allocate(nullptr, local, 9, peer, 1000);
+    NS_TEST_EXPECT_MSG_EQ(Lookup(local, 9, peer, 1000), connected, "Connection not preferred");
+    NS_TEST_EXPECT_MSG_EQ(Lookup(local, 9, peer, 1001), bound, "Other peer port matched");
+    NS_TEST_EXPECT_MSG_EQ(m_demux.Allocate(nullptr, local, 9, peer, 1000),
+                          nullptr,
+                          "Duplicate connection allowed");
+
+    Ipv4EndPoint* anyConnected = m_demux.Allocate(nullptr, Ipv4Address::GetAny(), 9, peer, 1001);
+    NS_TEST_EXPECT_MSG_EQ(Lookup(local, 9, peer, 1001), anyConnected, "Peer match not preferred");
+
+    connected->SetRxEnabled(false);
+    NS_TEST_EXPECT_MSG_EQ(Lookup(local, 9, peer, 1000), bound, "Rx disabled endpoint matched");
+    connected->SetRxEnabled(true);
+
+    // an endpoint bound to the network address receives the subnet-directed broadcasts
+    Ipv4EndPoint* subnet = m_demux.Allocate(nullptr, Ipv4Address("10.1.1.0"), 7);
+    NS_TEST_EXPECT_MSG_EQ(Lookup("10.1.1.255", 7, peer, 1000), subnet, "Subnet broadcast");
+    NS_TEST_EXPECT_MSG_EQ(Lookup("10.1.2.255", 7, peer, 1000), nullptr, "Other subnet matched");
+
+    Ipv4EndPoint* other = m_demux.Allocate(otherDevice, Ipv4Address::GetAny(), 11);
+    other->BindToNetDevice(otherDevice);
+    NS_TEST_EXPECT_MSG_EQ(Lookup(local, 11, peer, 1000), nullptr, "Other device matched");
+    other->BindToNetDevice(device);
+    NS_TEST_EXPECT_MSG_EQ(Lookup(local, 11, peer, 1000), other, "Bound device not matched");
+
+    // the endpoints of the connections are allocated before their peer is set
+    Ipv4EndPoint* client = m_demux.Allocate(local);
+    uint16_t port = client->GetLocalPort();
+    NS_TEST_EXPECT_MSG_EQ(m_demux.LookupPortLocal(port), true, "Ephemeral port not in use");
+    client->SetPeer(peer, 80);
+    NS_TEST_EXPECT_MSG_EQ(Lookup(local, port, peer, 80), client, "Peer change not indexed");
+    NS_TEST_EXPECT_MSG_EQ(Lookup(local, port, peer, 81), nullptr, "Old tuple still indexed");
+    client->SetLocalAddress(Ipv4Address("10.1.1.2"));
+    NS_TEST_EXPECT_MSG_EQ(Lookup(local, port, peer, 80), nullptr, "Old address still indexed");
+    NS_TEST_EXPECT_MSG_EQ(Lookup("10.1.1.2", port, peer, 80), client, "Address not indexed");
+
+    NS_TEST_EXPECT_MSG_EQ(m_demux.SimpleLookup(local, 9, peer, 1000), connected, "Simple lookup");
+    NS_TEST_EXPECT_MSG_EQ(m_demux.SimpleLookup(local, 11, peer, 1000), other, "Generic lookup");
+
+    m_demux.DeAllocate(connected);
+    m_demux.DeAllocate(bound);
+    NS_TEST_EXPECT_MSG_EQ(Lookup(local, 9, peer, 1000), any, "Deallocated endpoint matched");
+    m_demux.DeAllocate(any);
+    m_demux.DeAllocate(anyConnected);
+    NS_TEST_EXPECT_MSG_EQ(Lookup(local, 9, peer, 1000), nullptr, "Deallocated endpoint matched");
+    NS_TEST_EXPECT_MSG_EQ(m_demux.LookupPortLocal(9), false, "Deallocated port in use");
+    NS_TEST_EXPECT_MSG_EQ(m_demux.GetAllEndPoints().size(), 3, "Wrong number of endpoints");
+
+    m_interface = nullptr;
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief Ipv6EndPointDemux lookup test.
+ */
+class Ipv6EndPointDemuxTestCase : public TestCase
+{
+  public:
+    Ipv6EndPointDemuxTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+Ipv6EndPointDemuxTestCase::Ipv6EndPointDemuxTestCase()
+    : TestCase("Lookup of the IPv6 endpoints")
+{
+}
+
+void
+Ipv6EndPointDemuxTestCase::DoRun()
+{
+    Ipv6EndPointDemux demux;
+    Ipv6Address local("2001:1::1");
+    Ipv6Address peer("2001:2::2");
+    auto lookup = [&demux](Ipv6Address daddr,
+                           uint16_t dport,
+                           Ipv6Address saddr,
+                           uint16_t sport) -> Ipv6EndPoint* {
+        Ipv6EndPointDemux::EndPoints endPoints = demux.Lookup(daddr, dport, saddr, sport, nullptr);
+        return endPoints.empty() ? nullptr : endPoints.front();
+    };
+
+    Ipv6EndPoint* any = demux.Allocate(nullptr, Ipv6Address::GetAny(), 9);
+    NS_TEST_EXPECT_MSG_EQ(lookup(local, 9, peer, 1000), any, "Port-only endpoint not found");
+    Ipv6EndPoint* bound = demux.Allocate(nullptr, local, 9);
+    NS_TEST_EXPECT_MSG_EQ(lookup(local, 9, peer, 1000), bound, "Bound endpoint not preferred");
+    Ipv6EndPoint* anyConnected = demux.Allocate(nullptr, Ipv6Address::GetAny(), 9, peer, 1000);
+    NS_TEST_EXPECT_MSG_EQ(lookup(local, 9, peer, 1000), anyConnected, "Peer match not preferred");
+    Ipv6EndPoint* connected = demux.Allocate(nullptr, local, 9, peer, 1000);
+    NS_TEST_EXPECT_MSG_EQ(lookup(local, 9, peer, 1000), connected, "Connection not preferred");
+    NS_TEST_EXPECT_MSG_EQ(lookup(local, 9, peer, 1001), bound, "Other peer port matched");
+
+    // without an incoming interface, the endpoints bound to a device do not match
+    Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice>();
+    Ipv6EndPoint* other = demux.Allocate(device, Ipv6Address::GetAny(), 11);
+    other->BindToNetDevice(device);
+    NS_TEST_EXPECT_MSG_EQ(lookup(local, 11, peer, 1000), nullptr, "Bound device matched");
+
+    Ipv6EndPoint* client = demux.Allocate(local);
+    uint16_t port = client->GetLocalPort();
+    client->SetPeer(peer, 80);
+    NS_TEST_EXPECT_MSG_EQ(lookup(local, port, peer, 80), client, "Peer change not indexed");
+    NS_TEST_EXPECT_MSG_EQ(lookup(local, port, peer, 81), nullptr, "Old tuple still indexed");
+
+    Ipv6EndPoint* moved = demux.Allocate(nullptr, local, 20);
+    moved->SetLocalPort(21);
+    NS_TEST_EXPECT_MSG_EQ(lookup(local, 21, peer, 1000), moved, "Port change not indexed");
+    NS_TEST_EXPECT_MSG_EQ(lookup(local, 20, peer, 1000), nullptr, "Old port still indexed");
+    NS_TEST_EXPECT_MSG_EQ(demux.LookupPortLocal(20), false, "Old port still in use");
+    NS_TEST_EXPECT_MSG_EQ(demux.SimpleLookup(local, 21, peer, 1000), moved, "Simple lookup");
+    demux.DeAllocate(moved);
+    NS_TEST_EXPECT_MSG_EQ(demux.LookupPortLocal(21), false, "Deallocated port in use");
+
+    demux.DeAllocate(connected);
+    NS_TEST_EXPECT_MSG_EQ(lookup(local, 9, peer, 1000), anyConnected, "Deallocated endpoint");
+    demux.DeAllocate(other);
+    NS_TEST_EXPECT_MSG_EQ(demux.LookupPortLocal(11), false, "Deallocated port in use");
+    NS_TEST_EXPECT_MSG_EQ(demux.GetEndPoints().size(), 4, "Wrong number of endpoints");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief End point demux TestSuite
+ */
+class EndPointDemuxTestSuite : public TestSuite
+{
+  public:
+    EndPointDemuxTestSuite()
+        : TestSuite("end-point-demux", UNIT)
+    {
+        AddTestCase(new Ipv4EndPointDemuxTestCase(), TestCase::QUICK);
+        AddTestCase(new Ipv6EndPointDemuxTestCase(), TestCase::QUICK);
+    }
+};
+
+static EndPointDemuxTestSuite g_endPointDemuxTestSuite; //!< Static variable for test initialization
@@ -23,6 +23,7 @@
 #include "ns3/ipv4-global-routing.h"
 #include "ns3/ipv4-l3-protocol.h"
 #include "ns3/ipv4-packet-info-tag.h"
+#include "ns3/ipv4-route.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/ipv4-static-routing-helper.h"
@@ -41,6 +42,8 @@
 #include "ns3/udp-socket-factory.h"
 #include "ns3/uinteger.h"
 
+#include <set>
+#include <sstream>
 #include <vector>
 
 using namespace ns3;
@@ -1311,6 +1314,236 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup internet-test
+ *
+ * \brief IPv4 GlobalRouting lookup Test
+ *
+ * Checks the order in which the routes are considered: the host routes, then
+ * the network routes in the order they were added, whatever their prefix, then
+ * the first matching external route; and the random choice between the
+ * routes of the same kind when RandomEcmpRouting is set.
+ */
+class Ipv4GlobalRoutingLookupTestCase : public TestCase
+{
+  public:
+    Ipv4GlobalRoutingLookupTestCase();
+
+  private:
+    /**
+     * \brief Look up a route.
+     * \param routing The routing protocol.
+     * \param dest The destination address.
+     * \param oif The output device, or nullptr.
+     * \returns The gateway of the route, or 0.0.0.0 if there is none.
+     */
+    Ipv4Address Lookup(Ptr<Ipv4GlobalRouting> routing,
+                       std::string dest,
+                       Ptr<NetDevice> oif = nullptr);
+
+    void DoRun() override;
+};
+
+Ipv4GlobalRoutingLookupTestCase::Ipv4GlobalRoutingLookupTestCase()
+    : TestCase("Global routing choice between overlapping routes")
+{
+}
+
+Ipv4Address
+Ipv4GlobalRoutingLookupTestCase::Lookup(Ptr<Ipv4GlobalRouting> routing,
+                                        std::string dest,
+                                        Ptr<NetDevice> oif)
+{
+    Ipv4Header header;
+    header.SetDestination(Ipv4Address(dest.c_str()));
+    Socket::SocketErrno sockerr;
+    Ptr<Ipv4Route> route = routing->RouteOutput(nullptr, header, oif, sockerr);
+    return route ? route->GetGateway() : Ipv4Address::GetZero();
+}
+
+void
+Ipv4GlobalRoutingLookupTestCase::DoRun()
+{
+    Ptr<Node> node = CreateObject<Node>();
+    InternetStackHelper internet;
+    internet.Install(node);
+    Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
+
+    Ptr<SimpleNetDevice> device[2];
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        device[i] = CreateObject<SimpleNetDevice>();
+        device[i]->SetAddress(Mac48Address::Allocate());
+        node->AddDevice(device[i]);
+        int32_t ifIndex = ipv4->AddInterface(device[i]);
+        Ipv4Address address(Ipv4Address("192.168.1.1").Get() + (i << 8));
+        ipv4->AddAddress(ifIndex, Ipv4InterfaceAddress(address, Ipv4Mask("/24")));
+        ipv4->SetUp(ifIndex);
+    }
+
+    Ptr<Ipv4GlobalRouting> routing =
+        Ipv4RoutingHelper::GetRouting<Ipv4GlobalRouting>(ipv4->GetRoutingProtocol());
+    NS_TEST_ASSERT_MSG_NE(routing, nullptr, "No global routing");
+    routing->AddNetworkRouteTo(Ipv4Address("10.0.0.0"),
+                               Ipv4Mask("/8"),
+                               Ipv4Address("192.168.1.11"),
+                               1);
+    routing->AddNetworkRouteTo(Ipv4Address("10.1.0.0"),
+                               Ipv4Mask("/16"),
+                               Ipv4Address("192.168.2.12"),
+                               2);
+    routing->AddNetworkRouteTo(Ipv4Address("10.1.0.0"),
+                               Ipv4Mask("/16"),
+                               Ipv4Address("192.168.1.13"),
+                               1);
+    routing->AddHostRouteTo(Ipv4Address("10.1.2.3"), Ipv4Address("192.168.2.14"), 2);
+    routing->AddASExternalRouteTo(Ipv4Address("0.0.0.0"),
+                                  Ipv4Mask("/0"),
+                                  Ipv4Address("192.168.1.15"),
+                                  1);
+    routing->AddASExternalRouteTo(Ipv4Address("172.16.0.0"),
+                                  Ipv4Mask("/12"),
+                                  Ipv4Address("192.168.2.16"),
+                                  2);
+
+    NS_TEST_EXPECT_MSG_EQ(Lookup(routing, "10.1.2.3"),
+                          Ipv4Address("192.168.2.14"),
+                          "The host route should win");
+    NS_TEST_EXPECT_MSG_EQ(Lookup(routing, "10.1.9.9"),
+                          Ipv4Address("192.168.1.11"),
+                          "The network route added first should win");
+    NS_TEST_EXPECT_MSG_EQ(Lookup(routing, "10.1.9.9", device[1]),
+                          Ipv4Address("192.168.2.12"),
+                          "Wrong network route on the second interface");
+    NS_TEST_EXPECT_MSG_EQ(Lookup(routing, "172.16.1.1"),
+                          Ipv4Address("192.168.1.15"),
+                          "The external route added first should win");
+    NS_TEST_EXPECT_MSG_EQ(Lookup(routing, "172.16.1.1", device[1]),
+                          Ipv4Address("192.168.2.16"),
+                          "Wrong external route on the second interface");
+    NS_TEST_EXPECT_MSG_EQ(Lookup(routing, "10.1.2.3", device[0]),
+                          Ipv4Address("192.168.1.11"),
+                          "Wrong route to the host on the first interface");
+
+    // the host route is the first route of the table
+    routing->RemoveRoute(0);
+    NS_TEST_EXPECT_MSG_EQ(Lookup(routing, "10.1.2.3"),
+                          Ipv4Address("192.168.1.11"),
+                          "Wrong route after the removal of the host route");
+
+    routing->SetAttribute("RandomEcmpRouting", BooleanValue(true));
+    std::set<Ipv4Address> gateways;
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        gateways.insert(Lookup(routing, "10.1.9.9"));
+    }
+    NS_TEST_EXPECT_MSG_EQ(gateways.size(), 3, "All the network routes should be used");
+    gateways.clear();
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        gateways.insert(Lookup(routing, "10.2.9.9"));
+    }
+    NS_TEST_EXPECT_MSG_EQ(gateways.size(), 1, "Only the /8 route matches");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief IPv4 GlobalRouting parallel SPF Test
+ *
+ * Checks that the routing tables computed with several threads are the same
+ * as those computed with one thread, route by route.
+ */
+class Ipv4GlobalRoutingThreadsTestCase : public TestCase
+{
+  public:
+    Ipv4GlobalRoutingThreadsTestCase();
+
+  private:
+    /**
+     * \brief Print the global routes of all the nodes.
+     * \param nodes The nodes.
+     * \returns The routes, one per line.
+     */
+    std::string DumpRoutes(const NodeContainer& nodes) const;
+
+    void DoRun() override;
+};
+
+Ipv4GlobalRoutingThreadsTestCase::Ipv4GlobalRoutingThreadsTestCase()
+    : TestCase("Global routing tables computed with several threads")
+{
+}
+
+std::string
+Ipv4GlobalRoutingThreadsTestCase::DumpRoutes(const NodeContainer& nodes) const
+{
+    std::ostringstream oss;
+    for (auto i = nodes.Begin(); i != nodes.End(); i++)
+    {
+        Ptr<Ipv4GlobalRouting> routing = Ipv4RoutingHelper::GetRouting<Ipv4GlobalRouting>(
+            (*i)->GetObject<Ipv4>()->GetRoutingProtocol());
+        oss << "node " << (*i)->GetId() << "\n";
+        for (uint32_t j = 0; j < routing->GetNRoutes(); j++)
+        {
+            oss << *routing->GetRoute(j) << "\n";
+        }
+    }
+    return oss.str();
+}
+
+void
+Ipv4GlobalRoutingThreadsTestCase::DoRun()
+{
+    // a 4x4 grid of point-to-point links, so that there are equal cost paths
+    const uint32_t side = 4;
+    NodeContainer nodes;
+    nodes.Create(side * side);
+    InternetStackHelper internet;
+    internet.Install(nodes);
+    SimpleNetDeviceHelper devices;
+    devices.SetNetDevicePointToPointMode(true);
+    Ipv4AddressHelper address("10.0.0.0", "255.255.255.252");
+    for (uint32_t row = 0; row < side; row++)
+    {
+        for (uint32_t col = 0; col < side; col++)
+        {
+            Ptr<Node> node = nodes.Get(row * side + col);
+            if (col + 1 < side)
+            {
+                address.Assign(
+                    devices.Install(NodeContainer(node, nodes.Get(row * side + col + 1))));
+                address.NewNetwork();
+            }
+            if (row + 1 < side)
+            {
+                address.Assign(
+                    devices.Install(NodeContainer(node, nodes.Get((row + 1) * side + col))));
+                address.NewNetwork();
+            }
+        }
+    }
+
+    Config::SetGlobal("GlobalRoutingThreads", UintegerValue(1));
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+    std::string reference = DumpRoutes(nodes);
+    NS_TEST_ASSERT_MSG_GT(reference.size(), 0, "No routes");
+
+    for (uint32_t threads : {2, 4, 32})
+    {
+        Config::SetGlobal("GlobalRoutingThreads", UintegerValue(threads));
+        Ipv4GlobalRoutingHelper::RecomputeRoutingTables();
+        NS_TEST_EXPECT_MSG_EQ(DumpRoutes(nodes),
+                              reference,
+                              "Different routes with " << threads << " threads");
+    }
+    Config::SetGlobal("GlobalRoutingThreads", UintegerValue(1));
+
+    Simulator::Destroy();
+}
+
 /**
  * \ingroup internet-test
  *
@@ -1333,6 +1566,8 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite()
     AddTestCase(new TwoBridgeTest, TestCase::QUICK);
     AddTestCase(new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase(new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase(new Ipv4GlobalRoutingLookupTestCase, TestCase::QUICK);
+    AddTestCase(new Ipv4GlobalRoutingThreadsTestCase, TestCase::QUICK);
 }
 
 static Ipv4GlobalRoutingTestSuite
@@ -20,7 +20,9 @@
 #include "ns3/inet-socket-address.h"
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-route.h"
 #include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/ipv4-static-routing.h"
 #include "ns3/node-container.h"
 #include "ns3/node.h"
 #include "ns3/packet.h"
@@ -207,6 +209,160 @@ Ipv4StaticRoutingSlash32TestCase::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup internet-test
+ *
+ * \brief IPv4 StaticRouting lookup Test
+ *
+ * Checks the choice between overlapping routes: the longest prefix wins, then
+ * the lowest metric, then the route added last, except for host routes, where
+ * the route added first wins.
+ */
+class Ipv4StaticRoutingLookupTestCase : public TestCase
+{
+  public:
+    Ipv4StaticRoutingLookupTestCase();
+
+  private:
+    /**
+     * \brief Look up a route.
+     * \param routing The routing protocol.
+     * \param dest The destination address.
+     * \param oif The output device, or nullptr.
+     * \returns The gateway of the route, or 0.0.0.0 if there is none.
+     */
+    Ipv4Address Lookup(Ptr<Ipv4StaticRouting> routing,
+                       std::string dest,
+                       Ptr<NetDevice> oif = nullptr);
+
+    void DoRun() override;
+};
+
+Ipv4StaticRoutingLookupTestCase::Ipv4StaticRoutingLookupTestCase()
+    : TestCase("Static routing choice between overlapping routes")
+{
+}
+
+Ipv4Address
+Ipv4StaticRoutingLookupTestCase::Lookup(Ptr<Ipv4StaticRouting> routing,
+                                        std::string dest,
+                                        Ptr<NetDevice> oif)
+{
+    Ipv4Header header;
+    header.SetDestination(Ipv4Address(dest.c_str()));
+    Socket::SocketErrno sockerr;
+    Ptr<Ipv4Route> route = routing->RouteOutput(nullptr, header, oif, sockerr);
+    return route ? route->GetGateway() : Ipv4Address::GetZero();
+}
+
+void
+Ipv4StaticRoutingLookupTestCase::DoRun()
+{
+    Ptr<Node> node = CreateObject<Node>();
+    InternetStackHelper internet;
+    internet.Install(node);
+    Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
+
+    Ptr<SimpleNetDevice> device[2];
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        device[i] = CreateObject<SimpleNetDevice>();
+        device[i]->SetAddress(Mac48Address::Allocate());
+        node->AddDevice(device[i]);
+        int32_t ifIndex = ipv4->AddInterface(device[i]);
+        Ipv4Address address(Ipv4Address("192.168.1.1").Get() + (i << 8));
+        ipv4->AddAddress(ifIndex, Ipv4InterfaceAddress(address, Ipv4Mask("/24")));
+        ipv4->SetUp(ifIndex);
+    }
+
+    Ipv4StaticRoutingHelper ipv4RoutingHelper;
+    Ptr<Ipv4StaticRouting> routing = ipv4RoutingHelper.GetStaticRouting(ipv4);
+    routing->SetDefaultRoute(Ipv4Address("192.168.1.10"), 1);
+    routing->AddNetworkRouteTo(Ipv4Address("10.0.0.0"),
+                               Ipv4Mask("/8"),
+                               Ipv4Address("192.168.1.11"),
+                               1,
+                               5);
+    routing->AddNetworkRouteTo(Ipv4Address("10.1.0.0"),
+                               Ipv4Mask("/16"),
+                               Ipv4Address("192.168.2.12"),
+                               2,
+                               3);
+    routing->AddNetworkRouteTo(Ipv4Address("10.1.0.0"),
+                               Ipv4Mask("/16"),
+                               Ipv4Address("192.168.1.13"),
+                               1,
+                               3);
+    routing->AddNetworkRouteTo(Ipv4Address("10.1.2.0"),
+                               Ipv4Mask("/24"),
+                               Ipv4Address("192.168.2.14"),
+                               2,
+                               9);
+    routing->AddNetworkRouteTo(Ipv4Address("10.1.2.0"),
+                               Ipv4Mask("/24"),
+                               Ipv4Address("192.168.1.15"),
+                               1,
+                               1);
+    routing->AddHostRouteTo(Ipv4Address("10.1.2.3"), Ipv4Address("192.168.2.16"), 2, 7);
+    routing->AddHostRouteTo(Ipv4Address("10.1.2.3"), Ipv4Address("192.168.1.17"), 1, 0);
+
+    NS_TEST_EXPECT_MSG_EQ(Lookup(routing, "172.16.0.1"),
+                          Ipv4Address("192.168.1.10"),
+                          "Wrong default route");
+    NS_TEST_EXPECT_MSG_EQ(Lookup(routing, "10.200.0.1"),
+                          Ipv4Address("192.168.1.11"),
+                          "Wrong /8 route");
+    NS_TEST_EXPECT_MSG_EQ(Lookup(routing, "10.1.200.1"),
+                          Ipv4Address("192.168.1.13"),
+                          "The /16 route added last should win");
+    NS_TEST_EXPECT_MSG_EQ(Lookup(routing, "10.1.200.1", device[1]),
+                          Ipv4Address("192.168.2.12"),
+                          "Wrong /16 route on the second interface");
+    NS_TEST_EXPECT_MSG_EQ(Lookup(routing, "10.1.2.4"),
+                          Ipv4Address("192.168.1.15"),
+                          "The /24 route with the lowest metric should win");
+    NS_TEST_EXPECT_MSG_EQ(Lookup(routing, "10.1.2.3"),
+                          Ipv4Address("192.168.2.16"),
+                          "The host route added first should win");
+    NS_TEST_EXPECT_MSG_EQ(Lookup(routing, "10.1.2.3", device[0]),
+                          Ipv4Address("192.168.1.17"),
+                          "Wrong host route on the first interface");
+    NS_TEST_EXPECT_MSG_EQ(Lookup(routing, "192.168.2.20"),
+                          Ipv4Address::GetZero(),
+                          "Wrong route to the subnet of the second interface");
+
+    // remove the /24 route with the lowest metric and the first host route
+    for (uint32_t i = 0; i < routing->GetNRoutes();)
+    {
+        Ipv4Address gateway = routing->GetRoute(i).GetGateway();
+        if (gateway == Ipv4Address("192.168.1.15") || gateway == Ipv4Address("192.168.2.16"))
+        {
+            routing->RemoveRoute(i);
+        }
+        else
+        {
+            i++;
+        }
+    }
+    NS_TEST_EXPECT_MSG_EQ(Lookup(routing, "10.1.2.4"),
+                          Ipv4Address("192.168.2.14"),
+                          "Wrong /24 route after removal");
+    NS_TEST_EXPECT_MSG_EQ(Lookup(routing, "10.1.2.3"),
+                          Ipv4Address("192.168.1.17"),
+                          "Wrong host route after removal");
+
+    // the routes of an interface go away with it
+    ipv4->SetDown(1);
+    NS_TEST_EXPECT_MSG_EQ(Lookup(routing, "10.1.2.3"),
+                          Ipv4Address("192.168.2.14"),
+                          "Wrong route after the first interface went down");
+    NS_TEST_EXPECT_MSG_EQ(Lookup(routing, "10.200.0.1"),
+                          Ipv4Address::GetZero(),
+                          "No route expected after the first interface went down");
+
+    Simulator::Destroy();
+}
+
 /**
  * \ingroup internet-test
  *
@@ -222,6 +378,7 @@ Ipv4StaticRoutingTestSuite::Ipv4StaticRoutingTestSuite()
     : TestSuite("ipv4-static-routing", UNIT)
 {
     AddTestCase(new Ipv4StaticRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase(new Ipv4StaticRoutingLookupTestCase, TestCase::QUICK);
 }
 
 static Ipv4StaticRoutingTestSuite
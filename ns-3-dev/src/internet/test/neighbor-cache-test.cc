@@ -17,6 +17,7 @@
  * Author: Zhiheng Dong <dzh2077@gmail.com>
  */
 
+#include "ns3/arp-cache.h"
 #include "ns3/icmpv4-l4-protocol.h"
 #include "ns3/icmpv6-l4-protocol.h"
 #include "ns3/internet-stack-helper.h"
@@ -26,6 +27,7 @@
 #include "ns3/ipv6-address-helper.h"
 #include "ns3/ipv6-l3-protocol.h"
 #include "ns3/ipv6-routing-helper.h"
+#include "ns3/ndisc-cache.h"
 #include "ns3/neighbor-cache-helper.h"
 #include "ns3/simple-channel.h"
 #include "ns3/simple-net-device-helper.h"
@@ -35,6 +37,7 @@
 #include "ns3/socket.h"
 #include "ns3/test.h"
 #include "ns3/udp-l4-protocol.h"
+#include "ns3/uinteger.h"
 #include "ns3/udp-socket-factory.h"
 
 using namespace ns3;
@@ -1221,6 +1224,151 @@ DynamicPartialTest::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup internet-test
+ *
+ * \brief Neighbor Cache Table Test
+ *
+ * Adds and removes many entries to the ARP and NDISC caches, and checks
+ * the lookups, the address order of the printed entries and the
+ * retransmissions of the ARP requests of the entries waiting for a reply.
+ */
+class CacheTableTest : public TestCase
+{
+  public:
+    void DoRun() override;
+    CacheTableTest();
+
+  private:
+    /**
+     * \brief Count an ARP request.
+     * \param cache The ARP cache.
+     * \param address The address to resolve.
+     */
+    void ArpRequest(Ptr<const ArpCache> cache, Ipv4Address address);
+
+    uint32_t m_requests; //!< Number of ARP requests.
+};
+
+CacheTableTest::CacheTableTest()
+    : TestCase("The CacheTableTest checks the lookups and the expiry of large neighbor caches."),
+      m_requests(0)
+{
+}
+
+void
+CacheTableTest::ArpRequest(Ptr<const ArpCache> cache, Ipv4Address address)
+{
+    m_requests++;
+}
+
+void
+CacheTableTest::DoRun()
+{
+    const uint32_t n = 1000;
+    Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice>();
+    Ptr<ArpCache> arp = CreateObject<ArpCache>();
+    arp->SetDevice(device, nullptr);
+    arp->SetArpRequestCallback(MakeCallback(&CacheTableTest::ArpRequest, this));
+    for (uint32_t i = 0; i < n; i++)
+    {
+        ArpCache::Entry* entry = arp->Add(Ipv4Address(0x0a000000 + i));
+        entry->SetMacAddress(Mac48Address::Allocate());
+        entry->MarkPermanent();
+    }
+    for (uint32_t i = 0; i < n; i += 3)
+    {
+        arp->Remove(arp->Lookup(Ipv4Address(0x0a000000 + i)));
+    }
+    for (uint32_t i = 0; i < n; i++)
+    {
+        ArpCache::Entry* entry = arp->Lookup(Ipv4Address(0x0a000000 + i));
+        if (i % 3 == 0)
+        {
+            NS_TEST_EXPECT_MSG_EQ(entry, nullptr, "Removed ARP entry found.");
+        }
+        else
+        {
+            NS_TEST_EXPECT_MSG_NE(entry, nullptr, "ARP entry not found.");
+            NS_TEST_EXPECT_MSG_EQ(entry->GetIpv4Address(),
+                                  Ipv4Address(0x0a000000 + i),
+                                  "Wrong ARP entry found.");
+        }
+    }
+
+    // ten entries wait for a reply: one is answered and one removed before the timeout
+    std::vector<ArpCache::Entry*> waiting;
+    for (uint32_t i = 0; i < 30; i += 3)
+    {
+        ArpCache::Entry* entry = arp->Add(Ipv4Address(0x0a000000 + i));
+        entry->MarkWaitReply(ArpCache::Ipv4PayloadHeaderPair(Create<Packet>(), Ipv4Header()));
+        waiting.push_back(entry);
+    }
+    waiting[2]->MarkAlive(Mac48Address::Allocate());
+    arp->Remove(waiting[5]);
+    Simulator::Run();
+    UintegerValue maxRetries;
+    arp->GetAttribute("MaxRetries", maxRetries);
+    NS_TEST_EXPECT_MSG_EQ(m_requests, 8 * maxRetries.Get(), "Wrong number of ARP requests.");
+    for (uint32_t i = 0; i < waiting.size(); i++)
+    {
+        if (i != 2 && i != 5)
+        {
+            NS_TEST_EXPECT_MSG_EQ(waiting[i]->IsDead(), true, "ARP entry not dead.");
+        }
+    }
+    NS_TEST_EXPECT_MSG_EQ(waiting[2]->IsAlive(), true, "Answered ARP entry not alive.");
+    Simulator::Destroy();
+
+    // the entries are printed in address order
+    arp->Flush();
+    for (uint32_t i : {3, 1, 2})
+    {
+        ArpCache::Entry* entry = arp->Add(Ipv4Address(0x0a000000 + i));
+        entry->SetMacAddress(Mac48Address(("00:00:00:00:00:0" + std::to_string(i)).c_str()));
+        entry->MarkPermanent();
+    }
+    std::ostringstream arpStream;
+    Ptr<OutputStreamWrapper> arpWrapper = Create<OutputStreamWrapper>(&arpStream);
+    arp->PrintArpCache(arpWrapper);
+    std::string arpCache = "10.0.0.1 dev 0 lladdr 04-06-00:00:00:00:00:01 PERMANENT\n"
+                           "10.0.0.2 dev 0 lladdr 04-06-00:00:00:00:00:02 PERMANENT\n"
+                           "10.0.0.3 dev 0 lladdr 04-06-00:00:00:00:00:03 PERMANENT\n";
+    NS_TEST_EXPECT_MSG_EQ(arpStream.str(), arpCache, "Arp cache is incorrect.");
+    arp->Dispose();
+
+    Ptr<NdiscCache> ndisc = CreateObject<NdiscCache>();
+    std::vector<Ipv6Address> addresses;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        uint8_t buf[16] = {0x20, 0x01};
+        buf[14] = i >> 8;
+        buf[15] = i;
+        addresses.emplace_back(buf);
+        NdiscCache::Entry* entry = ndisc->Add(addresses.back());
+        entry->SetMacAddress(Mac48Address::Allocate());
+        entry->MarkPermanent();
+    }
+    for (uint32_t i = 0; i < n; i += 3)
+    {
+        ndisc->Remove(ndisc->Lookup(addresses[i]));
+    }
+    for (uint32_t i = 0; i < n; i++)
+    {
+        NdiscCache::Entry* entry = ndisc->Lookup(addresses[i]);
+        if (i % 3 == 0)
+        {
+            NS_TEST_EXPECT_MSG_EQ(entry, nullptr, "Removed NDISC entry found.");
+        }
+        else
+        {
+            NS_TEST_EXPECT_MSG_NE(entry, nullptr, "NDISC entry not found.");
+            NS_TEST_EXPECT_MSG_EQ(entry->GetIpv6Address(), addresses[i], "Wrong entry found.");
+        }
+    }
+    ndisc->Dispose();
+}
+
 /**
  * \ingroup internet-test
  *
@@ -1239,6 +1387,7 @@ class NeighborCacheTestSuite : public TestSuite
         AddTestCase(new FlushTest, TestCase::QUICK);
         AddTestCase(new DuplicateTest, TestCase::QUICK);
         AddTestCase(new DynamicPartialTest, TestCase::QUICK);
+        AddTestCase(new CacheTableTest, TestCase::QUICK);
     }
 };
 
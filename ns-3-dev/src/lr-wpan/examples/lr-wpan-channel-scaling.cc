@@ -0,0 +1,283 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Measures how the cost of a SingleModelSpectrumChannel transmission scales
+ * with the number of attached LrWpanPhy, with and without the spatial index
+ * of the channel (SpatialIndex attribute).
+ *
+ * The PHYs are placed uniformly at random in a square whose side grows with
+ * the number of PHYs, so that each transmission reaches about the same number
+ * of receivers within MaxLossDb. Random PHYs transmit at random times. Both
+ * runs of a given size must schedule the same number of events and deliver
+ * the same frames; the program reports the wall-clock time of each run and
+ * fails if the runs differ.
+ *
+ * Usage: ./ns3 run "lr-wpan-channel-scaling --nodeCnts=100,1000,10000"
+ */
+
+#include <ns3/boolean.h>
+#include <ns3/command-line.h>
+#include <ns3/config.h>
+#include <ns3/constant-position-mobility-model.h>
+#include <ns3/double.h>
+#include <ns3/log.h>
+#include <ns3/lr-wpan-phy.h>
+#include <ns3/nstime.h>
+#include <ns3/packet.h>
+#include <ns3/propagation-loss-model.h>
+#include <ns3/random-walk-2d-mobility-model.h>
+#include <ns3/rectangle.h>
+#include <ns3/simulator.h>
+#include <ns3/single-model-spectrum-channel.h>
+#include <ns3/string.h>
+#include <ns3/system-wall-clock-ms.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("LrWpanChannelScaling");
+
+/// Outcome of one run
+struct ScalingResult
+{
+    uint64_t events{0};    //!< events executed by the simulator
+    uint64_t received{0};  //!< frames delivered to the PHY users
+    uint64_t digest{0};    //!< hash of the deliveries (PHY, time, LQI)
+    int64_t wallMs{0};     //!< wall-clock time of Simulator::Run (ms)
+    int64_t setupMs{0};    //!< wall-clock time of the setup (ms)
+};
+
+static ScalingResult g_result;              //!< result of the current run
+static std::vector<Ptr<LrWpanPhy>> g_phys; //!< PHYs of the current run
+
+/**
+ * Folds a value in the delivery digest (FNV-1a)
+ * \param value the value
+ */
+static void
+Digest(uint64_t value)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        g_result.digest ^= (value >> (8 * i)) & 0xff;
+        g_result.digest *= 1099511628211ULL;
+    }
+}
+
+/**
+ * Records a frame delivered by a PHY
+ * \param index index of the PHY
+ * \param psduLength PSDU length
+ * \param p packet
+ * \param lqi link quality indication
+ */
+static void
+ReceivePdDataIndication(uint32_t index, uint32_t psduLength, Ptr<Packet> p, uint8_t lqi)
+{
+    g_result.received++;
+    Digest(index);
+    Digest(Simulator::Now().GetTimeStep());
+    Digest(lqi);
+}
+
+/**
+ * Puts a PHY back in reception once its frame is sent
+ * \param index index of the PHY
+ * \param status status of the transmission
+ */
+static void
+PdDataConfirm(uint32_t index, LrWpanPhyEnumeration status)
+{
+    g_phys[index]->PlmeSetTRXStateRequest(IEEE_802_15_4_PHY_RX_ON);
+}
+
+/**
+ * Sends one frame from a PHY that has been switched to TX_ON
+ * \param index index of the PHY
+ */
+static void
+SendOnePacket(uint32_t index)
+{
+    Ptr<Packet> p = Create<Packet>(20);
+    g_phys[index]->PdDataRequest(p->GetSize(), p);
+}
+
+/**
+ * Switches a PHY to TX_ON and sends a frame once the transceiver is ready
+ * \param index index of the PHY
+ */
+static void
+StartTransmission(uint32_t index)
+{
+    g_phys[index]->PlmeSetTRXStateRequest(IEEE_802_15_4_PHY_TX_ON);
+    Simulator::Schedule(MilliSeconds(1), &SendOnePacket, index);
+}
+
+/**
+ * Runs the scenario once
+ * \param nodeCnt number of PHYs
+ * \param spatialIndex whether the channel uses its spatial index
+ * \param neighbors mean number of PHYs within range of a transmitter
+ * \param txCnt number of transmissions
+ * \param speed speed of the PHYs (m/s), 0 for static PHYs
+ * \param simTime simulated time
+ * \return the result of the run
+ */
+static ScalingResult
+RunOnce(uint32_t nodeCnt,
+        bool spatialIndex,
+        double neighbors,
+        uint32_t txCnt,
+        double speed,
+        Time simTime)
+{
+    g_result = ScalingResult();
+    SystemWallClockMs setupClock;
+    setupClock.Start();
+
+    Ptr<LogDistancePropagationLossModel> lossModel =
+        CreateObject<LogDistancePropagationLossModel>();
+    Ptr<SingleModelSpectrumChannel> channel = CreateObject<SingleModelSpectrumChannel>();
+    channel->SetAttribute("MaxLossDb", DoubleValue(110));
+    channel->SetAttribute("SpatialIndex", BooleanValue(spatialIndex));
+    channel->AddPropagationLossModel(lossModel);
+
+    double range = lossModel->GetMaxRange(0, -110);
+    double side = std::sqrt(nodeCnt * M_PI * range * range / neighbors);
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<double> coordinate(0, side);
+
+    g_phys.reserve(nodeCnt);
+    for (uint32_t i = 0; i < nodeCnt; i++)
+    {
+        Ptr<LrWpanPhy> phy = CreateObject<LrWpanPhy>();
+        phy->AssignStreams(i);
+        Vector position(coordinate(rng), coordinate(rng), 0);
+        if (speed > 0)
+        {
+            Ptr<RandomWalk2dMobilityModel> mobility = CreateObject<RandomWalk2dMobilityModel>();
+            mobility->SetAttribute("Bounds", RectangleValue(Rectangle(0, side, 0, side)));
+            mobility->SetAttribute("Mode", StringValue("Time"));
+            mobility->SetAttribute("Time", TimeValue(Seconds(1)));
+            std::ostringstream speedValue;
+            speedValue << "ns3::ConstantRandomVariable[Constant=" << speed << "]";
+            mobility->SetAttribute("Speed", StringValue(speedValue.str()));
+            mobility->AssignStreams(nodeCnt + 2 * i);
+            mobility->SetPosition(position);
+            mobility->Initialize();
+            phy->SetMobility(mobility);
+        }
+        else
+        {
+            Ptr<ConstantPositionMobilityModel> mobility =
+                CreateObject<ConstantPositionMobilityModel>();
+            mobility->SetPosition(position);
+            phy->SetMobility(mobility);
+        }
+        phy->SetChannel(channel);
+        channel->AddRx(phy);
+        phy->SetPdDataIndicationCallback(MakeBoundCallback(&ReceivePdDataIndication, i));
+        phy->SetPdDataConfirmCallback(MakeBoundCallback(&PdDataConfirm, i));
+        phy->PlmeSetTRXStateRequest(IEEE_802_15_4_PHY_RX_ON);
+        g_phys.push_back(phy);
+    }
+
+    std::uniform_int_distribution<uint32_t> sender(0, nodeCnt - 1);
+    std::uniform_real_distribution<double> start(1, simTime.GetSeconds());
+    for (uint32_t i = 0; i < txCnt; i++)
+    {
+        Time at = Seconds(start(rng));
+        Simulator::Schedule(at, &StartTransmission, sender(rng));
+    }
+    g_result.setupMs = setupClock.End();
+
+    SystemWallClockMs runClock;
+    runClock.Start();
+    Simulator::Stop(simTime + Seconds(1));
+    Simulator::Run();
+    g_result.wallMs = runClock.End();
+    g_result.events = Simulator::GetEventCount();
+
+    Simulator::Destroy();
+    for (auto& phy : g_phys)
+    {
+        phy->Dispose();
+    }
+    g_phys.clear();
+    channel->Dispose();
+    return g_result;
+}
+
+int
+main(int argc, char* argv[])
+{
+    std::string nodeCnts = "100,1000,10000";
+    double neighbors = 20;
+    uint32_t txCnt = 2000;
+    double speed = 0;
+    double simTime = 20;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("nodeCnts", "Comma-separated list of PHY counts", nodeCnts);
+    cmd.AddValue("neighbors", "Mean number of PHYs within range of a transmitter", neighbors);
+    cmd.AddValue("txCnt", "Number of transmissions", txCnt);
+    cmd.AddValue("speed", "Speed of the PHYs (m/s), 0 for static PHYs", speed);
+    cmd.AddValue("simTime", "Simulated time (s)", simTime);
+    cmd.Parse(argc, argv);
+
+    std::cout << std::setw(8) << "nodes" << std::setw(8) << "index" << std::setw(12) << "events"
+              << std::setw(10) << "rx" << std::setw(10) << "setup ms" << std::setw(10)
+              << "run ms" << std::setw(10) << "speedup" << std::endl;
+
+    bool mismatch = false;
+    std::istringstream list(nodeCnts);
+    std::string item;
+    while (std::getline(list, item, ','))
+    {
+        auto nodeCnt = static_cast<uint32_t>(std::stoul(item));
+        ScalingResult scan = RunOnce(nodeCnt, false, neighbors, txCnt, speed, Seconds(simTime));
+        ScalingResult grid = RunOnce(nodeCnt, true, neighbors, txCnt, speed, Seconds(simTime));
+
+        for (bool indexed : {false, true})
+        {
+            const ScalingResult& result = indexed ? grid : scan;
+            std::cout << std::setw(8) << nodeCnt << std::setw(8) << (indexed ? "on" : "off")
+                      << std::setw(12) << result.events << std::setw(10) << result.received
+                      << std::setw(10) << result.setupMs << std::setw(10) << result.wallMs;
+            if (indexed)
+            {
+                std::cout << std::setw(9) << std::fixed << std::setprecision(1)
+                          << static_cast<double>(scan.wallMs) / std::max<int64_t>(grid.wallMs, 1)
+                          << "x";
+            }
+            std::cout << std::endl;
+        }
+        if (scan.events != grid.events || scan.received != grid.received ||
+            scan.digest != grid.digest)
+        {
+            std::cout << "  runs differ for " << nodeCnt << " PHYs" << std::endl;
+            mismatch = true;
+        }
+    }
+    return mismatch ? 1 : 0;
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2011 The Boeing Company
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Microbenchmark of the LrWpanPhy receive path: wall time per received
+ * signal against the number of overlapping transmitters.
+ *
+ * A single receiver PHY is fed with a stream of frames of 4 ms, without a
+ * channel. A new frame starts every 4 ms / --overlap, so that --overlap
+ * frames are always in the air and every start of a frame follows the end
+ * of another one. The frame powers are drawn between -95 and -60 dBm. The
+ * PHY locks on a frame when idle and sees the others as interference, so
+ * every StartRx and EndRx updates the accumulated interference and computes
+ * the SINR of the frame being received. The mean wall time per frame is
+ * reported, with the number of frames delivered as a sanity check.
+ *
+ * ./ns3 run "lr-wpan-interference-benchmark --overlaps=1,4,16,64,256"
+ */
+#include <ns3/command-line.h>
+#include <ns3/lr-wpan-error-model.h>
+#include <ns3/lr-wpan-phy.h>
+#include <ns3/lr-wpan-spectrum-signal-parameters.h>
+#include <ns3/lr-wpan-spectrum-value-helper.h>
+#include <ns3/packet-burst.h>
+#include <ns3/packet.h>
+#include <ns3/simulator.h>
+#include <ns3/spectrum-value.h>
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+using namespace ns3;
+
+/**
+ * Count the frames delivered by the PHY.
+ * \param delivered the counter
+ * \param psduLength PSDU length
+ * \param p packet
+ * \param lqi link quality indication
+ */
+static void
+CountDelivered(uint64_t* delivered, uint32_t psduLength, Ptr<Packet> p, uint8_t lqi)
+{
+    (*delivered)++;
+}
+
+/**
+ * Start the reception of the next frame of the stream, and schedule the one
+ * after it.
+ * \param phy the receiver
+ * \param frames the frames to send in turn
+ * \param interval the time between two frames
+ * \param left number of frames left to send
+ */
+static void
+StartFrame(Ptr<LrWpanPhy> phy,
+           const std::vector<Ptr<LrWpanSpectrumSignalParameters>>* frames,
+           Time interval,
+           uint32_t left)
+{
+    // each reception gets its own parameters, as from a channel
+    Ptr<LrWpanSpectrumSignalParameters> params =
+        Create<LrWpanSpectrumSignalParameters>(*(*frames)[left % frames->size()]);
+    phy->StartRx(params);
+    if (left > 1)
+    {
+        Simulator::Schedule(interval, &StartFrame, phy, frames, interval, left - 1);
+    }
+}
+
+/**
+ * Run the stream for one number of overlapping frames.
+ * \param overlap number of overlapping frames
+ * \param count number of frames
+ * \param delivered the frames delivered
+ * \return the mean wall time per frame, in nanoseconds
+ */
+static double
+RunOverlap(uint32_t overlap, uint32_t count, uint64_t* delivered)
+{
+    const uint32_t channel = 11;
+    Ptr<LrWpanPhy> phy = CreateObject<LrWpanPhy>();
+    phy->SetErrorModel(CreateObject<LrWpanErrorModel>());
+    phy->SetPdDataIndicationCallback(MakeBoundCallback(&CountDelivered, delivered));
+    phy->PlmeSetTRXStateRequest(IEEE_802_15_4_PHY_RX_ON);
+
+    // a pool of frames with random powers, sent in turn
+    std::mt19937 rng(overlap);
+    std::uniform_real_distribution<double> rxPowerDbm(-95.0, -60.0);
+    LrWpanSpectrumValueHelper psdHelper;
+    std::vector<Ptr<LrWpanSpectrumSignalParameters>> frames;
+    Time duration = MilliSeconds(4);
+    for (uint32_t i = 0; i < 2 * overlap + 1; i++)
+    {
+        Ptr<LrWpanSpectrumSignalParameters> params = Create<LrWpanSpectrumSignalParameters>();
+        params->psd = psdHelper.CreateTxPowerSpectralDensity(rxPowerDbm(rng), channel);
+        params->duration = duration;
+        params->packetBurst = CreateObject<PacketBurst>();
+        params->packetBurst->AddPacket(Create<Packet>(100));
+        frames.push_back(params);
+    }
+
+    Simulator::Schedule(MilliSeconds(10), &StartFrame, phy, &frames, duration / overlap, count);
+
+    auto start = std::chrono::steady_clock::now();
+    Simulator::Run();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    Simulator::Destroy();
+    phy->Dispose();
+
+    return elapsed.count() / count;
+}
+
+int
+main(int argc, char* argv[])
+{
+    std::string overlaps = "1,4,16,64,256";
+    uint32_t frames = 200000;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("overlaps", "Comma-separated list of numbers of overlapping frames", overlaps);
+    cmd.AddValue("frames", "Frames received per measurement", frames);
+    cmd.Parse(argc, argv);
+
+    std::cout << std::setw(8) << "overlap" << std::setw(12) << "delivered" << std::setw(14)
+              << "ns/frame" << std::endl;
+
+    std::stringstream ss(overlaps);
+    std::string item;
+    while (std::getline(ss, item, ','))
+    {
+        uint32_t overlap = std::stoul(item);
+        uint64_t delivered = 0;
+        double ns = RunOverlap(overlap, frames, &delivered);
+        std::cout << std::setw(8) << overlap << std::setw(12) << delivered << std::setw(14)
+                  << std::fixed << std::setprecision(1) << ns << std::endl;
+    }
+
+    return 0;
+}
@@ -19,20 +19,36 @@
  */
 #include "lr-wpan-interference-helper.h"
 
+#include "lr-wpan-spectrum-value-helper.h"
+
 #include <ns3/log.h>
 #include <ns3/spectrum-model.h>
 #include <ns3/spectrum-value.h>
 
+#include <algorithm>
+#include <cmath>
+
 namespace ns3
 {
 
 NS_LOG_COMPONENT_DEFINE("LrWpanInterferenceHelper");
 
+/**
+ * Number of signal removals after which the running sum is computed again
+ * from scratch, to keep the rounding errors of the subtractions bounded.
+ */
+static const uint32_t RESUM_INTERVAL = 1024;
+
 LrWpanInterferenceHelper::LrWpanInterferenceHelper(Ptr<const SpectrumModel> spectrumModel)
     : m_spectrumModel(spectrumModel),
-      m_dirty(false)
+      m_removals(0),
+      m_powerChannel(0),
+      m_power(0.0)
 {
     m_signal = Create<SpectrumValue>(m_spectrumModel);
+#ifdef NS3_ASSERT_ENABLE
+    m_maxValue = 0.0;
+#endif
 }
 
 LrWpanInterferenceHelper::~LrWpanInterferenceHelper()
@@ -52,9 +68,16 @@ LrWpanInterferenceHelper::AddSignal(Ptr<const SpectrumValue> signal)
     if (signal->GetSpectrumModel() == m_spectrumModel)
     {
         result = m_signals.insert(signal).second;
-        if (result && !m_dirty)
+        if (result)
         {
             *m_signal += *signal;
+            m_powerChannel = 0;
+#ifdef NS3_ASSERT_ENABLE
+            for (auto it = signal->ConstValuesBegin(); it != signal->ConstValuesEnd(); ++it)
+            {
+                m_maxValue = std::max(m_maxValue, std::abs(*it));
+            }
+#endif
         }
     }
     return result;
@@ -72,7 +95,12 @@ LrWpanInterferenceHelper::RemoveSignal(Ptr<const SpectrumValue> signal)
         result = (m_signals.erase(signal) == 1);
         if (result)
         {
-            m_dirty = true;
+            *m_signal -= *signal;
+            m_powerChannel = 0;
+            if (m_signals.empty() || ++m_removals == RESUM_INTERVAL)
+            {
+                Resum();
+            }
         }
     }
     return result;
@@ -84,7 +112,12 @@ LrWpanInterferenceHelper::ClearSignals()
     NS_LOG_FUNCTION(this);
 
     m_signals.clear();
-    m_dirty = true;
+    m_signal = Create<SpectrumValue>(m_spectrumModel);
+    m_removals = 0;
+    m_powerChannel = 0;
+#ifdef NS3_ASSERT_ENABLE
+    m_maxValue = 0.0;
+#endif
 }
 
 Ptr<SpectrumValue>
@@ -92,18 +125,74 @@ LrWpanInterferenceHelper::GetSignalPsd() const
 {
     NS_LOG_FUNCTION(this);
 
-    if (m_dirty)
+    return m_signal->Copy();
+}
+
+Ptr<const SpectrumModel>
+LrWpanInterferenceHelper::GetSpectrumModel() const
+{
+    NS_LOG_FUNCTION(this);
+
+    return m_spectrumModel;
+}
+
+double
+LrWpanInterferenceHelper::GetSignalPower(uint32_t channel) const
+{
+    NS_LOG_FUNCTION(this << channel);
+
+    if (m_powerChannel != channel)
     {
-        // Sum up the current interference PSD.
-        m_signal = Create<SpectrumValue>(m_spectrumModel);
+        // The subtractions can leave a tiny negative residue.
+        m_power = std::max(0.0, LrWpanSpectrumValueHelper::TotalAvgPower(m_signal, channel));
+        m_powerChannel = channel;
+    }
+    return m_power;
+}
+
+void
+LrWpanInterferenceHelper::Resum()
+{
+    NS_LOG_FUNCTION(this);
+
+    // Sum up the current interference PSD. Without signals, the sum is zero
+    // and m_signal can be reset in place.
+    Ptr<SpectrumValue> signal = m_signal;
+    if (!m_signals.empty())
+    {
+        signal = Create<SpectrumValue>(m_spectrumModel);
         for (auto it = m_signals.begin(); it != m_signals.end(); ++it)
         {
-            *m_signal += *(*it);
+            *signal += *(*it);
         }
-        m_dirty = false;
     }
 
-    return m_signal->Copy();
+#ifdef NS3_ASSERT_ENABLE
+    // The running sum must match the exact one, up to rounding errors.
+    double tolerance = 1e-9 * m_maxValue;
+    auto exact = signal->ConstValuesBegin();
+    for (auto it = m_signal->ConstValuesBegin(); it != m_signal->ConstValuesEnd(); ++it, ++exact)
+    {
+        double value = m_signals.empty() ? 0.0 : *exact;
+        NS_ASSERT_MSG(std::abs(*it - value) <= tolerance,
+                      "running sum " << *it << " differs from the sum " << value);
+    }
+#endif
+
+    if (m_signals.empty())
+    {
+        *m_signal = 0.0;
+    }
+    m_signal = signal;
+    m_removals = 0;
+
+#ifdef NS3_ASSERT_ENABLE
+    m_maxValue = 0.0;
+    for (auto it = m_signal->ConstValuesBegin(); it != m_signal->ConstValuesEnd(); ++it)
+    {
+        m_maxValue = std::max(m_maxValue, std::abs(*it));
+    }
+#endif
 }
 
 } // namespace ns3
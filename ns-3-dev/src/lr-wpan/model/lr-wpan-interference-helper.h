@@ -80,6 +80,17 @@ class LrWpanInterferenceHelper : public SimpleRefCount<LrWpanInterferenceHelper>
      */
     Ptr<SpectrumValue> GetSignalPsd() const;
 
+    /**
+     * Get the in-band power of the sum of all accumulated signals, as
+     * LrWpanSpectrumValueHelper::TotalAvgPower would compute it from
+     * GetSignalPsd(). The value is cached for the last requested channel
+     * until a signal is added or removed.
+     *
+     * \param channel the channel number (11..26)
+     * \return the total average power in the channel, in W
+     */
+    double GetSignalPower(uint32_t channel) const;
+
     /**
      * Get the SpectrumModel used by the helper.
      *
@@ -109,15 +120,40 @@ class LrWpanInterferenceHelper : public SimpleRefCount<LrWpanInterferenceHelper>
     std::set<Ptr<const SpectrumValue>> m_signals;
 
     /**
-     * The precomputed sum of all accumulated signals.
+     * Sum up the accumulated signals again into m_signal, dropping the
+     * rounding errors of the incremental updates.
+     */
+    void Resum();
+
+    /**
+     * The running sum of all accumulated signals. Signals are added to and
+     * subtracted from it as they come and go.
+     */
+    Ptr<SpectrumValue> m_signal;
+
+    /**
+     * Number of signals subtracted from m_signal since it was last summed up
+     * from scratch.
+     */
+    uint32_t m_removals;
+
+    /**
+     * The channel of m_power, 0 if m_power is not valid.
+     */
+    mutable uint32_t m_powerChannel;
+
+    /**
+     * The cached in-band power of m_signal in m_powerChannel.
      */
-    mutable Ptr<SpectrumValue> m_signal;
+    mutable double m_power;
 
+#ifdef NS3_ASSERT_ENABLE
     /**
-     * Mark m_signal as dirty, whenever a signal is added or removed. m_signal has
-     * to be recomputed before next use.
+     * Largest value of the signals added since m_signal was last summed up
+     * from scratch, the scale of its rounding errors.
      */
-    mutable bool m_dirty;
+    double m_maxValue;
+#endif
 };
 
 } // namespace ns3
@@ -43,6 +43,8 @@
 #include <ns3/spectrum-channel.h>
 #include <ns3/spectrum-value.h>
 
+#include <algorithm>
+
 namespace ns3
 {
 
@@ -194,7 +196,8 @@ LrWpanPhy::GetTypeId()
                             "ns3::Packet::SinrTracedCallback")
             .AddTraceSource("PhyRxDrop",
                             "Trace source indicating a packet has been "
-                            "dropped by the device during reception",
+                            "dropped by the device during reception. "
+                            "The sinks get their own copy of the packet.",
                             MakeTraceSourceAccessor(&LrWpanPhy::m_phyRxDropTrace),
                             "ns3::Packet::TracedCallback");
     return tid;
@@ -370,8 +373,7 @@ LrWpanPhy::StartRx(Ptr<SpectrumSignalParameters> spectrumRxParams)
         // Update the average receive power during ED.
         Time now = Simulator::Now();
         m_edPower.averagePower +=
-            LrWpanSpectrumValueHelper::TotalAvgPower(m_signal->GetSignalPsd(),
-                                                     m_phyPIBAttributes.phyCurrentChannel) *
+            m_signal->GetSignalPower(m_phyPIBAttributes.phyCurrentChannel) *
             (now - m_edPower.lastUpdate).GetTimeStep() / m_edPower.measurementLength.GetTimeStep();
         m_edPower.lastUpdate = now;
     }
@@ -388,8 +390,7 @@ LrWpanPhy::StartRx(Ptr<SpectrumSignalParameters> spectrumRxParams)
         if (!m_ccaRequest.IsExpired())
         {
             double power =
-                LrWpanSpectrumValueHelper::TotalAvgPower(m_signal->GetSignalPsd(),
-                                                         m_phyPIBAttributes.phyCurrentChannel);
+                m_signal->GetSignalPower(m_phyPIBAttributes.phyCurrentChannel);
             if (m_ccaPeakPower < power)
             {
                 m_ccaPeakPower = power;
@@ -429,20 +430,20 @@ LrWpanPhy::StartRx(Ptr<SpectrumSignalParameters> spectrumRxParams)
                                  30
                           << "dBm");
         m_signal->AddSignal(lrWpanRxParams->psd);
-        Ptr<SpectrumValue> interferenceAndNoise = m_signal->GetSignalPsd();
-        *interferenceAndNoise -= *lrWpanRxParams->psd;
-        *interferenceAndNoise += *m_noise;
-        double sinr =
-            LrWpanSpectrumValueHelper::TotalAvgPower(lrWpanRxParams->psd,
-                                                     m_phyPIBAttributes.phyCurrentChannel) /
-            LrWpanSpectrumValueHelper::TotalAvgPower(interferenceAndNoise,
-                                                     m_phyPIBAttributes.phyCurrentChannel);
+        double sinr = GetSinr(lrWpanRxParams->psd);
 
         // Std. 802.15.4-2006, appendix E, Figure E.2
         // At SNR < -5 the BER is less than 10e-1.
         // It's useless to even *try* to decode the packet.
         if (10 * log10(sinr) > -5)
         {
+            // The packet burst is shared with the other receivers of the
+            // transmission. Copy it now, as the packet gets an LQI tag and is
+            // handed over to the MAC.
+            lrWpanRxParams->packetBurst = lrWpanRxParams->packetBurst->Copy();
+            p = lrWpanRxParams->packetBurst->GetPackets().front();
+            m_rxPacketCopies++;
+
             ChangeTrxState(IEEE_802_15_4_PHY_BUSY_RX);
             m_currentRxPacket = std::make_pair(lrWpanRxParams, false);
             m_phyRxBeginTrace(p);
@@ -451,14 +452,14 @@ LrWpanPhy::StartRx(Ptr<SpectrumSignalParameters> spectrumRxParams)
         }
         else
         {
-            m_phyRxDropTrace(p);
+            TraceSharedRxDrop(p);
         }
     }
     else if (m_trxState == IEEE_802_15_4_PHY_BUSY_RX)
     {
         // Drop the new packet.
         NS_LOG_DEBUG(this << " packet collision");
-        m_phyRxDropTrace(p);
+        TraceSharedRxDrop(p);
 
         // Check if we correctly received the old packet up to now.
         CheckInterference();
@@ -472,7 +473,7 @@ LrWpanPhy::StartRx(Ptr<SpectrumSignalParameters> spectrumRxParams)
     {
         // Simply drop the packet.
         NS_LOG_DEBUG(this << " transceiver not in RX state");
-        m_phyRxDropTrace(p);
+        TraceSharedRxDrop(p);
 
         // Add the signal power to the interference, anyway.
         m_signal->AddSignal(lrWpanRxParams->psd);
@@ -482,8 +483,7 @@ LrWpanPhy::StartRx(Ptr<SpectrumSignalParameters> spectrumRxParams)
     if (!m_ccaRequest.IsExpired())
     {
         double power =
-            LrWpanSpectrumValueHelper::TotalAvgPower(m_signal->GetSignalPsd(),
-                                                     m_phyPIBAttributes.phyCurrentChannel);
+            m_signal->GetSignalPower(m_phyPIBAttributes.phyCurrentChannel);
         if (m_ccaPeakPower < power)
         {
             m_ccaPeakPower = power;
@@ -496,6 +496,16 @@ LrWpanPhy::StartRx(Ptr<SpectrumSignalParameters> spectrumRxParams)
     Simulator::Schedule(spectrumRxParams->duration, &LrWpanPhy::EndRx, this, spectrumRxParams);
 }
 
+void
+LrWpanPhy::TraceSharedRxDrop(Ptr<const Packet> p)
+{
+    if (!m_phyRxDropTrace.IsEmpty())
+    {
+        m_rxPacketCopies++;
+        m_phyRxDropTrace(p->Copy());
+    }
+}
+
 void
 LrWpanPhy::CheckInterference()
 {
@@ -514,14 +524,7 @@ LrWpanPhy::CheckInterference()
             // How many bits did we receive since the last calculation?
             double t = (Simulator::Now() - m_rxLastUpdate).ToDouble(Time::MS);
             uint32_t chunkSize = ceil(t * (GetDataOrSymbolRate(true) / 1000));
-            Ptr<SpectrumValue> interferenceAndNoise = m_signal->GetSignalPsd();
-            *interferenceAndNoise -= *currentRxParams->psd;
-            *interferenceAndNoise += *m_noise;
-            double sinr =
-                LrWpanSpectrumValueHelper::TotalAvgPower(currentRxParams->psd,
-                                                         m_phyPIBAttributes.phyCurrentChannel) /
-                LrWpanSpectrumValueHelper::TotalAvgPower(interferenceAndNoise,
-                                                         m_phyPIBAttributes.phyCurrentChannel);
+            double sinr = GetSinr(currentRxParams->psd);
             double per = 1.0 - m_errorModel->GetChunkSuccessRate(sinr, chunkSize);
 
             // The LQI is the total packet success rate scaled to 0-255.
@@ -546,6 +549,19 @@ LrWpanPhy::CheckInterference()
     m_rxLastUpdate = Simulator::Now();
 }
 
+double
+LrWpanPhy::GetSinr(Ptr<const SpectrumValue> psd) const
+{
+    // The signal is part of the accumulated signals. The in-band power is
+    // linear in the PSD, so the interference is the accumulated power minus
+    // the one of the signal.
+    uint32_t channel = m_phyPIBAttributes.phyCurrentChannel;
+    double signal = LrWpanSpectrumValueHelper::TotalAvgPower(psd, channel);
+    double interference = std::max(0.0, m_signal->GetSignalPower(channel) - signal);
+    double noise = LrWpanSpectrumValueHelper::TotalAvgPower(m_noise, channel);
+    return signal / (interference + noise);
+}
+
 void
 LrWpanPhy::EndRx(Ptr<SpectrumSignalParameters> par)
 {
@@ -558,8 +574,7 @@ LrWpanPhy::EndRx(Ptr<SpectrumSignalParameters> par)
         // Update the average receive power during ED.
         Time now = Simulator::Now();
         m_edPower.averagePower +=
-            LrWpanSpectrumValueHelper::TotalAvgPower(m_signal->GetSignalPsd(),
-                                                     m_phyPIBAttributes.phyCurrentChannel) *
+            m_signal->GetSignalPower(m_phyPIBAttributes.phyCurrentChannel) *
             (now - m_edPower.lastUpdate).GetTimeStep() / m_edPower.measurementLength.GetTimeStep();
         m_edPower.lastUpdate = now;
     }
@@ -667,8 +682,10 @@ LrWpanPhy::PdDataRequest(const uint32_t psduLength, Ptr<Packet> p)
             txParams->txPhy = GetObject<SpectrumPhy>();
             txParams->psd = m_txPsd;
             txParams->txAntenna = m_antenna;
+            // The receivers share the packet of the signal, so it must not
+            // change with the packet of the MAC.
             Ptr<PacketBurst> pb = CreateObject<PacketBurst>();
-            pb->AddPacket(p);
+            pb->AddPacket(p->Copy());
             txParams->packetBurst = pb;
             m_channel->StartTx(txParams);
             m_pdDataRequest = Simulator::Schedule(txParams->duration, &LrWpanPhy::EndTx, this);
@@ -1392,8 +1409,7 @@ LrWpanPhy::EndEd()
     NS_LOG_FUNCTION(this);
 
     m_edPower.averagePower +=
-        LrWpanSpectrumValueHelper::TotalAvgPower(m_signal->GetSignalPsd(),
-                                                 m_phyPIBAttributes.phyCurrentChannel) *
+        m_signal->GetSignalPower(m_phyPIBAttributes.phyCurrentChannel) *
         (Simulator::Now() - m_edPower.lastUpdate).GetTimeStep() /
         m_edPower.measurementLength.GetTimeStep();
 
@@ -1429,8 +1445,7 @@ LrWpanPhy::EndCca()
     LrWpanPhyEnumeration sensedChannelState = IEEE_802_15_4_PHY_UNSPECIFIED;
 
     // Update peak power.
-    double power = LrWpanSpectrumValueHelper::TotalAvgPower(m_signal->GetSignalPsd(),
-                                                            m_phyPIBAttributes.phyCurrentChannel);
+    double power = m_signal->GetSignalPower(m_phyPIBAttributes.phyCurrentChannel);
     if (m_ccaPeakPower < power)
     {
         m_ccaPeakPower = power;
@@ -1594,6 +1609,12 @@ LrWpanPhy::GetCurrentChannelNum() const
     return m_phyPIBAttributes.phyCurrentChannel;
 }
 
+uint64_t
+LrWpanPhy::GetRxPacketCopies() const
+{
+    return m_rxPacketCopies;
+}
+
 double
 LrWpanPhy::GetDataOrSymbolRate(bool isData)
 {
@@ -1778,6 +1799,20 @@ LrWpanPhy::SetRxSensitivity(double dbmSensitivity)
     m_rxSensitivity = DbmToW(dbmSensitivity);
 }
 
+void
+LrWpanPhy::SetRxSensitivity(double dbmSensitivity, Ptr<const SpectrumValue> noisePsd)
+{
+    NS_LOG_FUNCTION(this << dbmSensitivity << "dBm" << noisePsd);
+    NS_ASSERT(noisePsd);
+
+    m_noise = noisePsd;
+    if (!m_signal || m_signal->GetSpectrumModel() != noisePsd->GetSpectrumModel())
+    {
+        m_signal = Create<LrWpanInterferenceHelper>(noisePsd->GetSpectrumModel());
+    }
+    m_rxSensitivity = DbmToW(dbmSensitivity);
+}
+
 double
 LrWpanPhy::GetRxSensitivity()
 {
@@ -1856,8 +1891,7 @@ double
 LrWpanPhy::GetCurrentSignalPsd()
 {
     double powerWatts =
-        LrWpanSpectrumValueHelper::TotalAvgPower(m_signal->GetSignalPsd(),
-                                                 m_phyPIBAttributes.phyCurrentChannel);
+        m_signal->GetSignalPower(m_phyPIBAttributes.phyCurrentChannel);
     return WToDbm(powerWatts);
 }
 
@@ -352,6 +352,20 @@ class LrWpanPhy : public SpectrumPhy
      */
     void SetRxSensitivity(double dbmSensitivity);
 
+    /**
+     * Set the receiver power sensitivity used by this device in dBm, with a
+     * noise PSD already computed for it, e.g. by another PHY given the same
+     * sensitivity and channel.
+     *
+     * Unlike SetRxSensitivity(double), no PSD is built: the tx PSD is kept,
+     * and the interference helper too unless the noise PSD uses another
+     * SpectrumModel. This lets many PHYs share one noise PSD.
+     *
+     * \param dbmSensitivity The receiver power sensitivity to set in dBm.
+     * \param noisePsd The noise PSD matching this sensitivity.
+     */
+    void SetRxSensitivity(double dbmSensitivity, Ptr<const SpectrumValue> noisePsd);
+
     /**
      * Get the receiver power sensitivity used by this device in dBm.
      *
@@ -498,6 +512,17 @@ class LrWpanPhy : public SpectrumPhy
      */
     double GetDataOrSymbolRate(bool isData);
 
+    /**
+     * Get the number of packets this PHY copied to receive frames.
+     * The packets of a transmission are shared by all the receivers
+     * of the channel, and copied only by the PHYs that synchronize to the
+     * frame, just before they modify it, or that drop it while PhyRxDrop has
+     * sinks.
+     *
+     * \return the number of packet copies
+     */
+    uint64_t GetRxPacketCopies() const;
+
     /**
      * set the error model to use
      *
@@ -604,6 +629,24 @@ class LrWpanPhy : public SpectrumPhy
      */
     void EndTx();
 
+    /**
+     * Compute the SINR of a signal that is part of the accumulated signals,
+     * over the current channel.
+     *
+     * \param psd the PSD of the signal
+     * \return the SINR
+     */
+    double GetSinr(Ptr<const SpectrumValue> psd) const;
+
+    /**
+     * Fire the PhyRxDrop trace for a frame this PHY did not synchronize to.
+     * Its packet is shared with the other receivers of the transmission, so
+     * the sinks, if any, get a copy of it.
+     *
+     * \param p the packet of the dropped frame
+     */
+    void TraceSharedRxDrop(Ptr<const Packet> p);
+
     /**
      * Check if the interference destroys a frame currently received. Called
      * whenever a change in interference is detected.
@@ -926,6 +969,11 @@ class LrWpanPhy : public SpectrumPhy
      */
     std::pair<Ptr<LrWpanSpectrumSignalParameters>, bool> m_currentRxPacket;
 
+    /**
+     * Number of packets copied to receive frames.
+     */
+    uint64_t m_rxPacketCopies{0};
+
     /**
      * Status information of the currently transmitted packet. The first parameter
      * contains the frame. If the second parameter is set to true, the frame has not
@@ -36,7 +36,7 @@ LrWpanSpectrumSignalParameters::LrWpanSpectrumSignalParameters(
     : SpectrumSignalParameters(p)
 {
     NS_LOG_FUNCTION(this << &p);
-    packetBurst = p.packetBurst->Copy();
+    packetBurst = p.packetBurst;
 }
 
 Ptr<SpectrumSignalParameters>
@@ -43,6 +43,12 @@ struct LrWpanSpectrumSignalParameters : public SpectrumSignalParameters
 
     /**
      * copy constructor
+     *
+     * The packet burst is shared with \p p rather than copied: the channel
+     * copies the parameters for every receiver, and most receivers never
+     * touch the packet. A receiver that modifies the packet copies the burst
+     * first, as LrWpanPhy does when it synchronizes to a frame.
+     *
      * \param p the object to copy from.
      */
     LrWpanSpectrumSignalParameters(const LrWpanSpectrumSignalParameters& p);
@@ -0,0 +1,156 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Measure the setup time of the Config paths as a function of the number of
+ * nodes, each with one SimpleNetDevice.
+ *
+ * The PhyRxDrop trace source of every device is connected:
+ *  - per-node: with one Config::ConnectWithoutContext per node, each path
+ *    naming the index of its node in the NodeList,
+ *  - wildcard: with one Config::ConnectWithoutContext matching all the
+ *    nodes of the NodeList,
+ *  - compiled: with one Config::CompiledPath matching all the nodes,
+ *  - bulk: with a Config::CompiledPath relative to the nodes of a
+ *    NodeContainer.
+ * Then an attribute of every device is set ten times, with Config::Set and
+ * with a Config::CompiledPath caching its matches.
+ *
+ * ./ns3 run "config-path-benchmark"
+ * ./ns3 run "config-path-benchmark --nodeCnts=1000,10000 --maxPerNodeCnt=1000"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+/// The number of times an attribute is set
+static const uint32_t SET_CNT = 10;
+
+/**
+ * The traced callback, never called.
+ *
+ * \param packet the dropped packet
+ */
+static void
+PhyRxDrop(Ptr<const Packet> packet)
+{
+}
+
+/**
+ * \param begin the start time
+ * \return the milliseconds elapsed since begin
+ */
+static double
+MilliSecondsSince(std::chrono::steady_clock::time_point begin)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin)
+        .count();
+}
+
+int
+main(int argc, char* argv[])
+{
+    CommandLine cmd(__FILE__);
+    std::string nodeCnts = "1000,10000,50000";
+    uint32_t maxPerNodeCnt = 10000;
+    cmd.AddValue("nodeCnts", "Comma separated list of node counts", nodeCnts);
+    cmd.AddValue("maxPerNodeCnt",
+                 "Largest node count for which the trace is connected node per node",
+                 maxPerNodeCnt);
+    cmd.Parse(argc, argv);
+
+    std::vector<uint32_t> counts;
+    std::istringstream iss(nodeCnts);
+    std::string item;
+    while (std::getline(iss, item, ','))
+    {
+        counts.push_back(std::stoul(item));
+    }
+
+    std::string trace = "/DeviceList/*/$ns3::SimpleNetDevice/PhyRxDrop";
+    std::string attribute = "/NodeList/*/DeviceList/*/$ns3::SimpleNetDevice/PointToPointMode";
+    std::cout << std::setw(8) << "nodes" << std::setw(10) << "matches" << std::setw(14)
+              << "per-node(ms)" << std::setw(14) << "wildcard(ms)" << std::setw(14)
+              << "compiled(ms)" << std::setw(10) << "bulk(ms)" << std::setw(10) << "set(ms)"
+              << std::setw(16) << "cached set(ms)" << std::endl;
+    for (auto n : counts)
+    {
+        NodeContainer nodes;
+        nodes.Create(n);
+        for (auto i = nodes.Begin(); i != nodes.End(); ++i)
+        {
+            (*i)->AddDevice(CreateObject<SimpleNetDevice>());
+        }
+        std::size_t matches =
+            Config::LookupMatches("/NodeList/*/DeviceList/*/$ns3::SimpleNetDevice").GetN();
+        std::cout << std::setw(8) << n << std::setw(10) << matches << std::fixed
+                  << std::setprecision(1) << std::setw(14);
+
+        if (n <= maxPerNodeCnt)
+        {
+            auto begin = std::chrono::steady_clock::now();
+            for (auto i = nodes.Begin(); i != nodes.End(); ++i)
+            {
+                std::ostringstream oss;
+                oss << "/NodeList/" << (*i)->GetId() << trace;
+                Config::ConnectWithoutContext(oss.str(), MakeCallback(&PhyRxDrop));
+            }
+            std::cout << MilliSecondsSince(begin);
+        }
+        else
+        {
+            std::cout << "-";
+        }
+
+        auto begin = std::chrono::steady_clock::now();
+        Config::ConnectWithoutContext("/NodeList/*" + trace, MakeCallback(&PhyRxDrop));
+        std::cout << std::setw(14) << MilliSecondsSince(begin);
+
+        begin = std::chrono::steady_clock::now();
+        Config::CompiledPath("/NodeList/*" + trace)
+            .ConnectWithoutContext(MakeCallback(&PhyRxDrop));
+        std::cout << std::setw(14) << MilliSecondsSince(begin);
+
+        begin = std::chrono::steady_clock::now();
+        Config::CompiledPath(trace).ConnectWithoutContext(nodes, MakeCallback(&PhyRxDrop));
+        std::cout << std::setw(10) << MilliSecondsSince(begin);
+
+        begin = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < SET_CNT; i++)
+        {
+            Config::Set(attribute, BooleanValue(i % 2));
+        }
+        std::cout << std::setw(10) << MilliSecondsSince(begin);
+
+        begin = std::chrono::steady_clock::now();
+        Config::CompiledPath path(attribute, true);
+        for (uint32_t i = 0; i < SET_CNT; i++)
+        {
+            path.Set(BooleanValue(i % 2));
+        }
+        std::cout << std::setw(16) << MilliSecondsSince(begin) << std::endl;
+
+        Simulator::Destroy();
+    }
+    return 0;
+}
@@ -54,7 +54,11 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("Buffer");
 
+#ifdef NS3_MULTITHREADED_ENABLE
+thread_local uint32_t Buffer::g_recommendedStart = 0;
+#else
 uint32_t Buffer::g_recommendedStart = 0;
+#endif
 #ifdef BUFFER_FREE_LIST
 /* The following macros are pretty evil but they are needed to allow us to
  * keep track of 3 possible states for the g_freeList variable:
@@ -266,8 +270,7 @@ Buffer::operator=(const Buffer& o)
     if (m_data != o.m_data)
     {
         // not assignment to self.
-        m_data->m_count--;
-        if (m_data->m_count == 0)
+        if (--m_data->m_count == 0)
         {
             Recycle(m_data);
         }
@@ -289,8 +292,7 @@ Buffer::~Buffer()
     NS_LOG_FUNCTION(this);
     NS_ASSERT(CheckInternalState());
     g_recommendedStart = std::max(g_recommendedStart, m_maxZeroAreaStart);
-    m_data->m_count--;
-    if (m_data->m_count == 0)
+    if (--m_data->m_count == 0)
     {
         Recycle(m_data);
     }
@@ -315,7 +317,13 @@ Buffer::AddAtStart(uint32_t start)
 {
     NS_LOG_FUNCTION(this << start);
     NS_ASSERT(CheckInternalState());
+#ifdef NS3_MULTITHREADED_ENABLE
+    // the other owners of a shared data may be writing its dirty area from
+    // another thread
+    bool isDirty = m_data->m_count > 1;
+#else
     bool isDirty = m_data->m_count > 1 && m_start > m_data->m_dirtyStart;
+#endif
     if (m_start >= start && !isDirty)
     {
         /* enough space in the buffer and not dirty.
@@ -333,8 +341,7 @@ Buffer::AddAtStart(uint32_t start)
         uint32_t newSize = GetInternalSize() + start;
         Buffer::Data* newData = Buffer::Create(newSize);
         memcpy(newData->m_data + start, m_data->m_data + m_start, GetInternalSize());
-        m_data->m_count--;
-        if (m_data->m_count == 0)
+        if (--m_data->m_count == 0)
         {
             Buffer::Recycle(m_data);
         }
@@ -361,7 +368,11 @@ Buffer::AddAtEnd(uint32_t end)
 {
     NS_LOG_FUNCTION(this << end);
     NS_ASSERT(CheckInternalState());
+#ifdef NS3_MULTITHREADED_ENABLE
+    bool isDirty = m_data->m_count > 1;
+#else
     bool isDirty = m_data->m_count > 1 && m_end < m_data->m_dirtyEnd;
+#endif
     if (GetInternalEnd() + end <= m_data->m_size && !isDirty)
     {
         /* enough space in buffer and not dirty
@@ -379,8 +390,7 @@ Buffer::AddAtEnd(uint32_t end)
         uint32_t newSize = GetInternalSize() + end;
         Buffer::Data* newData = Buffer::Create(newSize);
         memcpy(newData->m_data, m_data->m_data + m_start, GetInternalSize());
-        m_data->m_count--;
-        if (m_data->m_count == 0)
+        if (--m_data->m_count == 0)
         {
             Buffer::Recycle(m_data);
         }
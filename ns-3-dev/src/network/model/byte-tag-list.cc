@@ -24,7 +24,12 @@
 #include <limits>
 #include <vector>
 
+#ifdef NS3_MULTITHREADED_ENABLE
+#include <atomic>
+#else
+// the free list is not shared by the threads of MultithreadedSimulatorImpl
 #define USE_FREE_LIST 1
+#endif
 #define FREE_LIST_SIZE 1000
 #define OFFSET_MAX (std::numeric_limits<int32_t>::max())
 
@@ -42,8 +47,12 @@ NS_LOG_COMPONENT_DEFINE("ByteTagList");
  */
 struct ByteTagListData
 {
-    uint32_t size;   //!< size of the data
-    uint32_t count;  //!< use counter (for smart deallocation)
+    uint32_t size; //!< size of the data
+#ifdef NS3_MULTITHREADED_ENABLE
+    std::atomic<uint32_t> count; //!< use counter (for smart deallocation)
+#else
+    uint32_t count; //!< use counter (for smart deallocation)
+#endif
     uint32_t dirty;  //!< number of bytes actually in use
     uint8_t data[4]; //!< data
 };
@@ -211,7 +220,13 @@ ByteTagList::Add(TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
         m_data = Allocate(spaceNeeded);
         m_used = 0;
     }
+#ifdef NS3_MULTITHREADED_ENABLE
+    // the other owners of a shared data may be appending to it from another
+    // thread
+    else if (m_data->size < spaceNeeded || m_data->count != 1)
+#else
     else if (m_data->size < spaceNeeded || (m_data->count != 1 && m_data->dirty != m_used))
+#endif
     {
         ByteTagListData* newData = Allocate(spaceNeeded);
         std::memcpy(&newData->data, &m_data->data, m_used);
@@ -386,8 +401,7 @@ ByteTagList::Deallocate(ByteTagListData* data)
         return;
     }
     g_maxSize = std::max(g_maxSize, data->size);
-    data->count--;
-    if (data->count == 0)
+    if (--data->count == 0)
     {
         if (g_freeList.size() > FREE_LIST_SIZE || data->size < g_maxSize)
         {
@@ -423,8 +437,7 @@ ByteTagList::Deallocate(ByteTagListData* data)
     {
         return;
     }
-    data->count--;
-    if (data->count == 0)
+    if (--data->count == 0)
     {
         uint8_t* buffer = (uint8_t*)data;
         delete[] buffer;
@@ -36,10 +36,17 @@ NS_LOG_COMPONENT_DEFINE("PacketMetadata");
 
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
+#ifdef NS3_MULTITHREADED_ENABLE
+std::atomic<bool> PacketMetadata::m_metadataSkipped = false;
+thread_local uint32_t PacketMetadata::m_maxSize = 0;
+std::atomic<uint16_t> PacketMetadata::m_chunkUid = 0;
+thread_local PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+#else
 bool PacketMetadata::m_metadataSkipped = false;
 uint32_t PacketMetadata::m_maxSize = 0;
 uint16_t PacketMetadata::m_chunkUid = 0;
 PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+#endif
 
 PacketMetadata::DataFreeList::~DataFreeList()
 {
@@ -80,8 +87,7 @@ PacketMetadata::ReserveCopy(uint32_t size)
     PacketMetadata::Data* newData = PacketMetadata::Create(m_used + size);
     memcpy(newData->m_data, m_data->m_data, m_used);
     newData->m_dirtyEnd = m_used;
-    m_data->m_count--;
-    if (m_data->m_count == 0)
+    if (--m_data->m_count == 0)
     {
         PacketMetadata::Recycle(m_data);
     }
@@ -104,8 +110,14 @@ PacketMetadata::Reserve(uint32_t size)
 {
     NS_LOG_FUNCTION(this << size);
     NS_ASSERT(m_data != nullptr);
+#ifdef NS3_MULTITHREADED_ENABLE
+    // the other owners of a shared data may be appending to it from another
+    // thread
+    if (m_data->m_size >= m_used + size && m_data->m_count == 1)
+#else
     if (m_data->m_size >= m_used + size &&
         (m_head == 0xffff || m_data->m_count == 1 || m_data->m_dirtyEnd == m_used))
+#endif
     {
         /* enough room, not dirty. */
     }
@@ -384,8 +396,12 @@ PacketMetadata::AddSmall(const PacketMetadata::SmallItem* item)
     uint32_t typeUidSize = GetUleb128Size(item->typeUid);
     uint32_t sizeSize = GetUleb128Size(item->size);
     uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2;
+#ifdef NS3_MULTITHREADED_ENABLE
+    if (m_used + n > m_data->m_size || m_data->m_count != 1)
+#else
     if (m_used + n > m_data->m_size ||
         (m_head != 0xffff && m_data->m_count != 1 && m_used != m_data->m_dirtyEnd))
+#endif
     {
         ReserveCopy(n);
     }
@@ -421,8 +437,12 @@ PacketMetadata::AddBig(uint32_t next,
     uint32_t fragEndSize = GetUleb128Size(extraItem->fragmentEnd);
     uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2 + fragStartSize + fragEndSize + 4;
 
+#ifdef NS3_MULTITHREADED_ENABLE
+    if (m_used + n > m_data->m_size || m_data->m_count != 1)
+#else
     if (m_used + n > m_data->m_size ||
         (m_head != 0xffff && m_data->m_count != 1 && m_used != m_data->m_dirtyEnd))
+#endif
     {
         ReserveCopy(n);
     }
@@ -670,8 +690,7 @@ PacketMetadata::DoAddHeader(uint32_t uid, uint32_t size)
     item.prev = 0xffff;
     item.typeUid = uid;
     item.size = size;
-    item.chunkUid = m_chunkUid;
-    m_chunkUid++;
+    item.chunkUid = m_chunkUid++;
     uint16_t written = AddSmall(&item);
     UpdateHead(written);
 }
@@ -736,8 +755,7 @@ PacketMetadata::AddTrailer(const Trailer& trailer, uint32_t size)
     item.prev = m_tail;
     item.typeUid = uid;
     item.size = size;
-    item.chunkUid = m_chunkUid;
-    m_chunkUid++;
+    item.chunkUid = m_chunkUid++;
     uint16_t written = AddSmall(&item);
     UpdateTail(written);
     NS_ASSERT(IsStateOk());
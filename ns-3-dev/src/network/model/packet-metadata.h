@@ -29,6 +29,10 @@
 #include <stdint.h>
 #include <vector>
 
+#ifdef NS3_MULTITHREADED_ENABLE
+#include <atomic>
+#endif
+
 namespace ns3
 {
 
@@ -426,7 +430,11 @@ class PacketMetadata
     struct Data
     {
         /** number of references to this struct Data instance. */
+#ifdef NS3_MULTITHREADED_ENABLE
+        std::atomic<uint32_t> m_count;
+#else
         uint32_t m_count;
+#endif
         /** size (in bytes) of m_data buffer below */
         uint32_t m_size;
         /** max of the m_used field over all objects which reference this struct Data instance */
@@ -675,19 +683,30 @@ class PacketMetadata
      */
     static void Deallocate(PacketMetadata::Data* data);
 
+#ifdef NS3_MULTITHREADED_ENABLE
+    // each thread of MultithreadedSimulatorImpl has its own free list
+    static thread_local DataFreeList m_freeList; //!< the metadata data storage
+#else
     static DataFreeList m_freeList; //!< the metadata data storage
-    static bool m_enable;           //!< Enable the packet metadata
-    static bool m_enableChecking;   //!< Enable the packet metadata checking
+#endif
+    static bool m_enable;         //!< Enable the packet metadata
+    static bool m_enableChecking; //!< Enable the packet metadata checking
 
     /**
      * Set to true when adding metadata to a packet is skipped because
      * m_enable is false; used to detect enabling of metadata in the
      * middle of a simulation, which isn't allowed.
      */
+#ifdef NS3_MULTITHREADED_ENABLE
+    static std::atomic<bool> m_metadataSkipped;
+    static thread_local uint32_t m_maxSize; //!< maximum metadata size
+    static std::atomic<uint16_t> m_chunkUid; //!< Chunk Uid
+#else
     static bool m_metadataSkipped;
 
     static uint32_t m_maxSize;  //!< maximum metadata size
     static uint16_t m_chunkUid; //!< Chunk Uid
+#endif
 
     Data* m_data; //!< Metadata storage
     /*
@@ -739,8 +758,7 @@ PacketMetadata::operator=(const PacketMetadata& o)
     {
         // not self assignment
         NS_ASSERT(m_data != nullptr);
-        m_data->m_count--;
-        if (m_data->m_count == 0)
+        if (--m_data->m_count == 0)
         {
             PacketMetadata::Recycle(m_data);
         }
@@ -758,8 +776,7 @@ PacketMetadata::operator=(const PacketMetadata& o)
 PacketMetadata::~PacketMetadata()
 {
     NS_ASSERT(m_data != nullptr);
-    m_data->m_count--;
-    if (m_data->m_count == 0)
+    if (--m_data->m_count == 0)
     {
         PacketMetadata::Recycle(m_data);
     }
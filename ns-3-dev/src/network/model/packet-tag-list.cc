@@ -45,13 +45,28 @@ PacketTagList::CreateTagData(size_t dataSize)
                                             << std::numeric_limits<decltype(TagData::size)>::max());
 
     void* p = std::malloc(sizeof(TagData) + dataSize - 1);
-    // The matching frees are in RemoveAll and RemoveWriter
+    // The matching frees are in RemoveAll, RemoveWriter and Unmerge
 
     auto tag = new (p) TagData;
     tag->size = dataSize;
     return tag;
 }
 
+void
+PacketTagList::Unmerge(PacketTagList::TagData* cur)
+{
+    TagData* next = cur->next;
+    if (--cur->count == 0)
+    {
+        if (next != nullptr)
+        {
+            next->count--;
+        }
+        cur->~TagData();
+        std::free(cur);
+    }
+}
+
 bool
 PacketTagList::COWTraverse(Tag& tag, PacketTagList::COWWriter Writer)
 {
@@ -150,7 +165,6 @@ PacketTagList::COWTraverse(Tag& tag, PacketTagList::COWWriter Writer)
     {
         NS_ASSERT(cur != nullptr);
         NS_ASSERT(cur->count > 1);
-        cur->count--; // unmerge cur
         TagData* copy = CreateTagData(cur->size);
         copy->tid = cur->tid;
         copy->count = 1;
@@ -158,6 +172,7 @@ PacketTagList::COWTraverse(Tag& tag, PacketTagList::COWWriter Writer)
         memcpy(copy->data, cur->data, copy->size);
         copy->next = cur->next; // merge into tail
         copy->next->count++;    // mark new merge
+        Unmerge(cur);           // unmerge cur, once it is not read anymore
         *prevNext = copy;       // point prior list at copy
         prevNext = &copy->next; // advance
         cur = copy->next;
@@ -202,12 +217,12 @@ PacketTagList::RemoveWriter(Tag& tag,
     {
         // cur is always a merge at this point
         // unmerge cur, since we linked around it already
-        cur->count--;
         if (cur->next != nullptr)
         {
             // there's a next, so make it a merge
             cur->next->count++;
         }
+        Unmerge(cur);
     }
     return found;
 }
@@ -243,7 +258,6 @@ PacketTagList::ReplaceWriter(Tag& tag,
     {
         // cur is always a merge at this point
         // need to copy, replace, and link past cur
-        cur->count--; // unmerge cur
         TagData* copy = CreateTagData(tag.GetSerializedSize());
         copy->tid = tag.GetInstanceTypeId();
         copy->count = 1;
@@ -253,6 +267,7 @@ PacketTagList::ReplaceWriter(Tag& tag,
         {
             copy->next->count++; // mark new merge
         }
+        Unmerge(cur);     // unmerge cur
         *prevNext = copy; // point prior list at copy
     }
     return found;
@@ -29,6 +29,10 @@
 #include <ostream>
 #include <stdint.h>
 
+#ifdef NS3_MULTITHREADED_ENABLE
+#include <atomic>
+#endif
+
 namespace ns3
 {
 
@@ -141,8 +145,12 @@ class PacketTagList
      */
     struct TagData
     {
-        TagData* next;   //!< Pointer to next in list
-        uint32_t count;  //!< Number of incoming links
+        TagData* next; //!< Pointer to next in list
+#ifdef NS3_MULTITHREADED_ENABLE
+        std::atomic<uint32_t> count; //!< Number of incoming links
+#else
+        uint32_t count; //!< Number of incoming links
+#endif
         TypeId tid;      //!< Type of the tag serialized into #data
         uint32_t size;   //!< Size of the \c data buffer
         uint8_t data[1]; //!< Serialization buffer
@@ -253,6 +261,17 @@ class PacketTagList
      */
     static TagData* CreateTagData(size_t dataSize);
 
+    /**
+     * Drop the link to a merge which has been copied or linked around.
+     *
+     * The incoming link of the copy to \c cur->next must already be counted.
+     * The merge is only freed when the other lists sharing it have been
+     * destroyed meanwhile, from another thread.
+     *
+     * \param [in] cur The merge.
+     */
+    static void Unmerge(TagData* cur);
+
     /**
      * Typedef of method function pointer for copy-on-write operations
      *
@@ -358,8 +377,7 @@ PacketTagList::RemoveAll()
     TagData* prev = nullptr;
     for (TagData* cur = m_next; cur != nullptr; cur = cur->next)
     {
-        cur->count--;
-        if (cur->count > 0)
+        if (--cur->count > 0)
         {
             break;
         }
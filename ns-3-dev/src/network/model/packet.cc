@@ -22,6 +22,10 @@
 #include "ns3/log.h"
 #include "ns3/simulator.h"
 
+#ifdef NS3_MULTITHREADED_ENABLE
+#include "ns3/multithreaded-simulator-impl.h"
+#endif
+
 #include <cstdarg>
 #include <string>
 
@@ -30,7 +34,38 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("Packet");
 
-uint32_t Packet::m_globalUid = 0;
+#ifdef NS3_MULTITHREADED_ENABLE
+/// Type of the global counter of packets Uid
+typedef std::atomic<uint32_t> PacketUidCounter;
+#else
+/// Type of the global counter of packets Uid
+typedef uint32_t PacketUidCounter;
+#endif
+
+PacketUidCounter Packet::m_globalUid = 0;
+
+/**
+ * \ingroup packet
+ * Get the Uid of a new packet from the global counter. With NS3_MULTITHREADED,
+ * the packets created by the events of a MultithreadedSimulatorImpl take
+ * their Uid from the range of their partition instead, so that the Uids do
+ * not depend on the interleaving of the threads.
+ *
+ * \param [in,out] globalUid The global counter of packets Uid.
+ * \returns The Uid.
+ */
+static uint64_t
+NewPacketUid(PacketUidCounter& globalUid)
+{
+#ifdef NS3_MULTITHREADED_ENABLE
+    uint64_t uid = MultithreadedSimulatorImpl::AllocateUid();
+    if (uid != 0)
+    {
+        return uid;
+    }
+#endif
+    return static_cast<uint64_t>(Simulator::GetSystemId()) << 32 | globalUid++;
+}
 
 TypeId
 ByteTagIterator::Item::GetTypeId() const
@@ -146,10 +181,9 @@ Packet::Packet()
        * zero.  The lower 32 bits are for the
        * global UID
        */
-      m_metadata(static_cast<uint64_t>(Simulator::GetSystemId()) << 32 | m_globalUid, 0),
+      m_metadata(NewPacketUid(m_globalUid), 0),
       m_nixVector(nullptr)
 {
-    m_globalUid++;
 }
 
 Packet::Packet(const Packet& o)
@@ -186,10 +220,9 @@ Packet::Packet(uint32_t size)
        * zero.  The lower 32 bits are for the
        * global UID
        */
-      m_metadata(static_cast<uint64_t>(Simulator::GetSystemId()) << 32 | m_globalUid, size),
+      m_metadata(NewPacketUid(m_globalUid), size),
       m_nixVector(nullptr)
 {
-    m_globalUid++;
 }
 
 Packet::Packet(const uint8_t* buffer, uint32_t size, bool magic)
@@ -213,10 +246,9 @@ Packet::Packet(const uint8_t* buffer, uint32_t size)
        * zero.  The lower 32 bits are for the
        * global UID
        */
-      m_metadata(static_cast<uint64_t>(Simulator::GetSystemId()) << 32 | m_globalUid, size),
+      m_metadata(NewPacketUid(m_globalUid), size),
       m_nixVector(nullptr)
 {
-    m_globalUid++;
     m_buffer.AddAtStart(size);
     Buffer::Iterator i = m_buffer.Begin();
     i.Write(buffer, size);
@@ -183,6 +183,12 @@ Cost231PropagationLossModel::DoCalcRxPower(double txPowerDbm,
     return txPowerDbm + GetLoss(a, b);
 }
 
+bool
+Cost231PropagationLossModel::DoIsDeterministic() const
+{
+    return true;
+}
+
 int64_t
 Cost231PropagationLossModel::DoAssignStreams(int64_t stream)
 {
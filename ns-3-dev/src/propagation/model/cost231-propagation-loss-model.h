@@ -132,6 +132,7 @@ class Cost231PropagationLossModel : public PropagationLossModel
     double DoCalcRxPower(double txPowerDbm,
                          Ptr<MobilityModel> a,
                          Ptr<MobilityModel> b) const override;
+    bool DoIsDeterministic() const override;
     int64_t DoAssignStreams(int64_t stream) override;
 
     double m_BSAntennaHeight; //!< BS Antenna Height [m]
@@ -104,6 +104,12 @@ ItuR1411LosPropagationLossModel::DoCalcRxPower(double txPowerDbm,
     return (txPowerDbm - GetLoss(a, b));
 }
 
+bool
+ItuR1411LosPropagationLossModel::DoIsDeterministic() const
+{
+    return true;
+}
+
 int64_t
 ItuR1411LosPropagationLossModel::DoAssignStreams(int64_t stream)
 {
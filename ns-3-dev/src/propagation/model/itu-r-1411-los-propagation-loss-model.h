@@ -76,6 +76,7 @@ class ItuR1411LosPropagationLossModel : public PropagationLossModel
     double DoCalcRxPower(double txPowerDbm,
                          Ptr<MobilityModel> a,
                          Ptr<MobilityModel> b) const override;
+    bool DoIsDeterministic() const override;
 
     int64_t DoAssignStreams(int64_t stream) override;
 
@@ -235,6 +235,12 @@ ItuR1411NlosOverRooftopPropagationLossModel::DoCalcRxPower(double txPowerDbm,
     return (txPowerDbm - GetLoss(a, b));
 }
 
+bool
+ItuR1411NlosOverRooftopPropagationLossModel::DoIsDeterministic() const
+{
+    return true;
+}
+
 int64_t
 ItuR1411NlosOverRooftopPropagationLossModel::DoAssignStreams(int64_t stream)
 {
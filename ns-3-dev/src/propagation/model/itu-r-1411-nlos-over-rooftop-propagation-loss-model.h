@@ -79,6 +79,7 @@ class ItuR1411NlosOverRooftopPropagationLossModel : public PropagationLossModel
     double DoCalcRxPower(double txPowerDbm,
                          Ptr<MobilityModel> a,
                          Ptr<MobilityModel> b) const override;
+    bool DoIsDeterministic() const override;
     int64_t DoAssignStreams(int64_t stream) override;
 
     double m_frequency;            //!< frequency in MHz
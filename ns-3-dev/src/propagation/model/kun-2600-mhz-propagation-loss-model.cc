@@ -70,6 +70,12 @@ Kun2600MhzPropagationLossModel::DoCalcRxPower(double txPowerDbm,
     return (txPowerDbm - GetLoss(a, b));
 }
 
+bool
+Kun2600MhzPropagationLossModel::DoIsDeterministic() const
+{
+    return true;
+}
+
 int64_t
 Kun2600MhzPropagationLossModel::DoAssignStreams(int64_t stream)
 {
@@ -67,6 +67,7 @@ class Kun2600MhzPropagationLossModel : public PropagationLossModel
     double DoCalcRxPower(double txPowerDbm,
                          Ptr<MobilityModel> a,
                          Ptr<MobilityModel> b) const override;
+    bool DoIsDeterministic() const override;
     int64_t DoAssignStreams(int64_t stream) override;
 };
 
@@ -165,6 +165,12 @@ OkumuraHataPropagationLossModel::DoCalcRxPower(double txPowerDbm,
     return (txPowerDbm - GetLoss(a, b));
 }
 
+bool
+OkumuraHataPropagationLossModel::DoIsDeterministic() const
+{
+    return true;
+}
+
 int64_t
 OkumuraHataPropagationLossModel::DoAssignStreams(int64_t stream)
 {
@@ -68,6 +68,7 @@ class OkumuraHataPropagationLossModel : public PropagationLossModel
     double DoCalcRxPower(double txPowerDbm,
                          Ptr<MobilityModel> a,
                          Ptr<MobilityModel> b) const override;
+    bool DoIsDeterministic() const override;
     int64_t DoAssignStreams(int64_t stream) override;
 
     EnvironmentType m_environment; //!< Environment Scenario
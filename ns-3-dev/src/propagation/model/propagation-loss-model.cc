@@ -30,6 +30,7 @@
 #include "ns3/string.h"
 
 #include <cmath>
+#include <limits>
 
 namespace ns3
 {
@@ -82,6 +83,36 @@ PropagationLossModel::CalcRxPower(double txPowerDbm,
     return self;
 }
 
+double
+PropagationLossModel::GetMaxRange(double txPowerDbm, double rxPowerDbm) const
+{
+    if (m_next)
+    {
+        // the losses of the chained models add up, and nothing tells us how
+        // the other models bound theirs
+        return std::numeric_limits<double>::infinity();
+    }
+    return DoGetMaxRange(txPowerDbm, rxPowerDbm);
+}
+
+double
+PropagationLossModel::DoGetMaxRange(double txPowerDbm, double rxPowerDbm) const
+{
+    return std::numeric_limits<double>::infinity();
+}
+
+bool
+PropagationLossModel::IsDeterministic() const
+{
+    return DoIsDeterministic() && (!m_next || m_next->IsDeterministic());
+}
+
+bool
+PropagationLossModel::DoIsDeterministic() const
+{
+    return false;
+}
+
 int64_t
 PropagationLossModel::AssignStreams(int64_t stream)
 {
@@ -281,6 +312,31 @@ FriisPropagationLossModel::DoCalcRxPower(double txPowerDbm,
     return txPowerDbm - std::max(lossDb, m_minLoss);
 }
 
+double
+FriisPropagationLossModel::DoGetMaxRange(double txPowerDbm, double rxPowerDbm) const
+{
+    double maxLossDb = txPowerDbm - rxPowerDbm;
+    if (m_minLoss > maxLossDb)
+    {
+        return 0;
+    }
+    if (m_systemLoss <= 0)
+    {
+        return std::numeric_limits<double>::infinity();
+    }
+    // invert lossDb = 10 log10 ((4 * pi * d)^2 * L / lambda^2); the small
+    // margin absorbs the rounding of the forward computation
+    double range =
+        m_lambda * std::pow(10.0, maxLossDb / 20) / (4 * M_PI * std::sqrt(m_systemLoss));
+    return range * (1 + 1e-9);
+}
+
+bool
+FriisPropagationLossModel::DoIsDeterministic() const
+{
+    return true;
+}
+
 int64_t
 FriisPropagationLossModel::DoAssignStreams(int64_t stream)
 {
@@ -462,6 +518,12 @@ TwoRayGroundPropagationLossModel::DoCalcRxPower(double txPowerDbm,
     }
 }
 
+bool
+TwoRayGroundPropagationLossModel::DoIsDeterministic() const
+{
+    return true;
+}
+
 int64_t
 TwoRayGroundPropagationLossModel::DoAssignStreams(int64_t stream)
 {
@@ -554,6 +616,31 @@ LogDistancePropagationLossModel::DoCalcRxPower(double txPowerDbm,
     return txPowerDbm + rxc;
 }
 
+double
+LogDistancePropagationLossModel::DoGetMaxRange(double txPowerDbm, double rxPowerDbm) const
+{
+    double maxLossDb = txPowerDbm - rxPowerDbm;
+    if (m_referenceLoss > maxLossDb)
+    {
+        return 0;
+    }
+    if (m_exponent <= 0)
+    {
+        return std::numeric_limits<double>::infinity();
+    }
+    // invert pathLossDb = 10 * n * log10 (d/d0); the small margin absorbs the
+    // rounding of the forward computation
+    double range =
+        m_referenceDistance * std::pow(10.0, (maxLossDb - m_referenceLoss) / (10 * m_exponent));
+    return range * (1 + 1e-9);
+}
+
+bool
+LogDistancePropagationLossModel::DoIsDeterministic() const
+{
+    return true;
+}
+
 int64_t
 LogDistancePropagationLossModel::DoAssignStreams(int64_t stream)
 {
@@ -653,6 +740,12 @@ ThreeLogDistancePropagationLossModel::DoCalcRxPower(double txPowerDbm,
     return txPowerDbm - pathLossDb;
 }
 
+bool
+ThreeLogDistancePropagationLossModel::DoIsDeterministic() const
+{
+    return true;
+}
+
 int64_t
 ThreeLogDistancePropagationLossModel::DoAssignStreams(int64_t stream)
 {
@@ -818,6 +911,12 @@ FixedRssLossModel::DoCalcRxPower(double txPowerDbm,
     return m_rss;
 }
 
+bool
+FixedRssLossModel::DoIsDeterministic() const
+{
+    return true;
+}
+
 int64_t
 FixedRssLossModel::DoAssignStreams(int64_t stream)
 {
@@ -948,6 +1047,26 @@ RangePropagationLossModel::DoCalcRxPower(double txPowerDbm,
     }
 }
 
+double
+RangePropagationLossModel::DoGetMaxRange(double txPowerDbm, double rxPowerDbm) const
+{
+    if (txPowerDbm < rxPowerDbm)
+    {
+        return 0;
+    }
+    if (-1000 < rxPowerDbm)
+    {
+        return m_range;
+    }
+    return std::numeric_limits<double>::infinity();
+}
+
+bool
+RangePropagationLossModel::DoIsDeterministic() const
+{
+    return true;
+}
+
 int64_t
 RangePropagationLossModel::DoAssignStreams(int64_t stream)
 {
@@ -101,6 +101,35 @@ class PropagationLossModel : public Object
      */
     double CalcRxPower(double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
 
+    /**
+     * Returns a distance beyond which the reception power computed by CalcRxPower
+     * is guaranteed to be below a given threshold.
+     *
+     * Callers such as SpectrumChannel use the bound to skip receivers that
+     * cannot be reached without evaluating the model for each of them. Models
+     * whose loss is not a deterministic, non-decreasing function of the distance
+     * return +infinity; so does any chain of more than one model.
+     *
+     * \param txPowerDbm current transmission power (in dBm)
+     * \param rxPowerDbm the reception power threshold (in dBm)
+     * \returns the range (in meters), or +infinity if no bound is known
+     */
+    double GetMaxRange(double txPowerDbm, double rxPowerDbm) const;
+
+    /**
+     * Returns whether CalcRxPower only depends on the positions of the two
+     * mobility models, so that callers such as SpectrumChannel may reuse the
+     * loss computed earlier for the same positions.
+     *
+     * Only the models known to be deterministic, such as the Friis,
+     * LogDistance, Range or FixedRss models, return true; models drawing
+     * random variables or varying over time, and the models that do not say,
+     * return false. So does a chain of models as soon as one of them does.
+     *
+     * \returns true if the loss is a function of the positions only
+     */
+    bool IsDeterministic() const;
+
     /**
      * If this loss model uses objects of type RandomVariableStream,
      * set the stream numbers to the integers starting with the offset
@@ -139,6 +168,26 @@ class PropagationLossModel : public Object
                                  Ptr<MobilityModel> a,
                                  Ptr<MobilityModel> b) const = 0;
 
+    /**
+     * Subclasses with a closed-form inverse should override this; the default
+     * implementation returns +infinity.
+     *
+     * \param txPowerDbm current transmission power (in dBm)
+     * \param rxPowerDbm the reception power threshold (in dBm)
+     * \returns the range (in meters) beyond which the reception power is below
+     * the threshold
+     */
+    virtual double DoGetMaxRange(double txPowerDbm, double rxPowerDbm) const;
+
+    /**
+     * Subclasses whose loss is a function of the positions only may override
+     * this to return true; the default implementation returns false, so that
+     * the loss of an unknown model is never reused.
+     *
+     * \returns true if the loss of this model is a function of the positions only
+     */
+    virtual bool DoIsDeterministic() const;
+
     Ptr<PropagationLossModel> m_next; //!< Next propagation loss model in the list
 };
 
@@ -303,6 +352,8 @@ class FriisPropagationLossModel : public PropagationLossModel
     double DoCalcRxPower(double txPowerDbm,
                          Ptr<MobilityModel> a,
                          Ptr<MobilityModel> b) const override;
+    bool DoIsDeterministic() const override;
+    double DoGetMaxRange(double txPowerDbm, double rxPowerDbm) const override;
     int64_t DoAssignStreams(int64_t stream) override;
 
     /**
@@ -413,6 +464,7 @@ class TwoRayGroundPropagationLossModel : public PropagationLossModel
     double DoCalcRxPower(double txPowerDbm,
                          Ptr<MobilityModel> a,
                          Ptr<MobilityModel> b) const override;
+    bool DoIsDeterministic() const override;
     int64_t DoAssignStreams(int64_t stream) override;
 
     /**
@@ -491,6 +543,8 @@ class LogDistancePropagationLossModel : public PropagationLossModel
     double DoCalcRxPower(double txPowerDbm,
                          Ptr<MobilityModel> a,
                          Ptr<MobilityModel> b) const override;
+    bool DoIsDeterministic() const override;
+    double DoGetMaxRange(double txPowerDbm, double rxPowerDbm) const override;
 
     int64_t DoAssignStreams(int64_t stream) override;
 
@@ -567,6 +621,7 @@ class ThreeLogDistancePropagationLossModel : public PropagationLossModel
     double DoCalcRxPower(double txPowerDbm,
                          Ptr<MobilityModel> a,
                          Ptr<MobilityModel> b) const override;
+    bool DoIsDeterministic() const override;
 
     int64_t DoAssignStreams(int64_t stream) override;
 
@@ -684,6 +739,7 @@ class FixedRssLossModel : public PropagationLossModel
     double DoCalcRxPower(double txPowerDbm,
                          Ptr<MobilityModel> a,
                          Ptr<MobilityModel> b) const override;
+    bool DoIsDeterministic() const override;
 
     int64_t DoAssignStreams(int64_t stream) override;
 
@@ -796,6 +852,8 @@ class RangePropagationLossModel : public PropagationLossModel
     double DoCalcRxPower(double txPowerDbm,
                          Ptr<MobilityModel> a,
                          Ptr<MobilityModel> b) const override;
+    bool DoIsDeterministic() const override;
+    double DoGetMaxRange(double txPowerDbm, double rxPowerDbm) const override;
 
     int64_t DoAssignStreams(int64_t stream) override;
 
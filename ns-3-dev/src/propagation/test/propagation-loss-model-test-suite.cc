@@ -24,6 +24,8 @@
 #include "ns3/simulator.h"
 #include "ns3/test.h"
 
+#include <cmath>
+
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE("PropagationLossModelsTest");
@@ -489,6 +491,102 @@ RangePropagationLossModelTestCase::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup propagation-tests
+ *
+ * \brief PropagationLossModel::GetMaxRange Test
+ *
+ * Checks that the range returned by the models with a closed-form inverse is
+ * a tight bound of the distance at which the reception power drops below the
+ * threshold, and that chained models report no bound.
+ */
+class MaxRangePropagationLossModelTestCase : public TestCase
+{
+  public:
+    MaxRangePropagationLossModelTestCase();
+    ~MaxRangePropagationLossModelTestCase() override;
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Checks the range of a model against CalcRxPower evaluated just inside
+     * and just outside of it.
+     *
+     * \param model the loss model
+     * \param txPowerDbm transmission power (dBm)
+     * \param rxPowerDbm reception power threshold (dBm)
+     */
+    void CheckRange(Ptr<PropagationLossModel> model, double txPowerDbm, double rxPowerDbm);
+};
+
+MaxRangePropagationLossModelTestCase::MaxRangePropagationLossModelTestCase()
+    : TestCase("Test PropagationLossModel::GetMaxRange")
+{
+}
+
+MaxRangePropagationLossModelTestCase::~MaxRangePropagationLossModelTestCase()
+{
+}
+
+void
+MaxRangePropagationLossModelTestCase::CheckRange(Ptr<PropagationLossModel> model,
+                                                 double txPowerDbm,
+                                                 double rxPowerDbm)
+{
+    double range = model->GetMaxRange(txPowerDbm, rxPowerDbm);
+    NS_TEST_ASSERT_MSG_EQ(std::isfinite(range), true, "Expected a finite range");
+
+    Ptr<MobilityModel> a = CreateObject<ConstantPositionMobilityModel>();
+    a->SetPosition(Vector(0, 0, 0));
+    Ptr<MobilityModel> b = CreateObject<ConstantPositionMobilityModel>();
+    b->SetPosition(Vector(range * (1 + 1e-6), 0, 0));
+    NS_TEST_EXPECT_MSG_LT(model->CalcRxPower(txPowerDbm, a, b),
+                          rxPowerDbm,
+                          "Receiver beyond the range is above the threshold");
+    b->SetPosition(Vector(range * (1 - 1e-6), 0, 0));
+    NS_TEST_EXPECT_MSG_GT_OR_EQ(model->CalcRxPower(txPowerDbm, a, b),
+                                rxPowerDbm,
+                                "Range is not tight");
+}
+
+void
+MaxRangePropagationLossModelTestCase::DoRun()
+{
+    Ptr<FriisPropagationLossModel> friis = CreateObject<FriisPropagationLossModel>();
+    friis->SetFrequency(2.4e9);
+    friis->SetSystemLoss(2);
+    CheckRange(friis, 0, -90);
+    CheckRange(friis, 20, -50);
+
+    Ptr<LogDistancePropagationLossModel> logDistance =
+        CreateObject<LogDistancePropagationLossModel>();
+    logDistance->SetPathLossExponent(3.5);
+    logDistance->SetReference(1, 46.6777);
+    CheckRange(logDistance, 0, -106.58);
+    CheckRange(logDistance, 10, -60);
+    // nothing is received, not even at the reference distance
+    NS_TEST_EXPECT_MSG_EQ(logDistance->GetMaxRange(0, -40), 0, "Expected an empty range");
+
+    Ptr<RangePropagationLossModel> range = CreateObject<RangePropagationLossModel>();
+    range->SetAttribute("MaxRange", DoubleValue(127.2));
+    NS_TEST_EXPECT_MSG_EQ(range->GetMaxRange(0, -100), 127.2, "Unexpected range");
+    NS_TEST_EXPECT_MSG_EQ(std::isfinite(range->GetMaxRange(0, -2000)),
+                          false,
+                          "The range should be unbounded");
+
+    // chains and stochastic models do not provide a bound
+    logDistance->SetNext(CreateObject<FriisPropagationLossModel>());
+    NS_TEST_EXPECT_MSG_EQ(std::isfinite(logDistance->GetMaxRange(0, -100)),
+                          false,
+                          "Chained models should not be bounded");
+    Ptr<PropagationLossModel> random = CreateObject<RandomPropagationLossModel>();
+    NS_TEST_EXPECT_MSG_EQ(std::isfinite(random->GetMaxRange(0, -100)),
+                          false,
+                          "Random models should not be bounded");
+    Simulator::Destroy();
+}
+
 /**
  * \ingroup propagation-tests
  *
@@ -500,6 +598,7 @@ RangePropagationLossModelTestCase::DoRun()
  *   - LogDistancePropagationLossModel
  *   - MatrixPropagationLossModel
  *   - RangePropagationLossModel
+ *   - PropagationLossModel::GetMaxRange
  */
 class PropagationLossModelsTestSuite : public TestSuite
 {
@@ -515,6 +614,7 @@ PropagationLossModelsTestSuite::PropagationLossModelsTestSuite()
     AddTestCase(new LogDistancePropagationLossModelTestCase, TestCase::QUICK);
     AddTestCase(new MatrixPropagationLossModelTestCase, TestCase::QUICK);
     AddTestCase(new RangePropagationLossModelTestCase, TestCase::QUICK);
+    AddTestCase(new MaxRangePropagationLossModelTestCase, TestCase::QUICK);
 }
 
 /// Static variable for test initialization
@@ -128,11 +128,17 @@ int main(int argc, char *argv[]) {
     uint8_t nodeCnt = 12;
     uint32_t randomSeed = 1;
     uint32_t randomRun = 1;
-    float intervalPacket = 0.1;
+    double intervalPacket = 0.1;
+    std::string packetTrace = "";
+    std::string audioMode = "Cbr";
+    std::string audioTrace = "";
     cmd.AddValue("nodeCnt", "Number of nodes", nodeCnt);
     cmd.AddValue("randomSeed", "Random seed", randomSeed);
     cmd.AddValue("randomRun", "Random run", randomRun);
     cmd.AddValue("intervalPacket", "Interval between packets", intervalPacket);
+    cmd.AddValue("packetTrace", "Binary file of NWK packet records, empty for none", packetTrace);
+    cmd.AddValue("audioMode", "Audio source pattern: Cbr, OnOff or Trace", audioMode);
+    cmd.AddValue("audioTrace", "Codec trace file of the Trace audio mode", audioTrace);
     cmd.Parse(argc, argv);
     // LogComponentEnable("RangerRoutingProtocol", LOG_LEVEL_INFO);
     // LogComponentEnable("RangerMac", LOG_LEVEL_INFO);
@@ -172,52 +178,30 @@ int main(int argc, char *argv[]) {
     // 创建边界节点
     BoundaryGuards(0, x_max, 0, y_max);
 
-    // 创建Channel
-    Ptr<SingleModelSpectrumChannel> channel = CreateObject<SingleModelSpectrumChannel>();
-    Ptr<LogDistancePropagationLossModel> propModel =
-        CreateObject<LogDistancePropagationLossModel>();
-    Ptr<ConstantSpeedPropagationDelayModel> delayModel =
-        CreateObject<ConstantSpeedPropagationDelayModel>();
-    channel->AddPropagationLossModel(propModel);
-    channel->SetPropagationDelayModel(delayModel);
-
-    // 创建网络设备 1、设置地址 2、绑定channel 3、设置Phy层参数 4、绑定Recorder 5、绑定到node
-    std::vector<Ptr<RangerNetDevice>> devices;
+    // 创建网络设备：设置地址、绑定channel、设置Phy层参数、绑定Recorder、绑定到node
+    RangerHelper ranger;
+    ranger.SetTxPower(txPower);
+    ranger.SetChannelNumber(channelNumber);
+    ranger.SetRxSensitivity(rxSensitivity);
+    ranger.SetBaseAddress(Ipv4Address("255.255.255.0"));
     Ptr<RangerRecorder> recorder = CreateObject<RangerRecorder>();
-    for(int i = 0; i < node_cnt; i++) {
-        Ptr<RangerNetDevice> dev = CreateObject<RangerNetDevice>();
-        // 设置地址
-        std::string address = "255.255.255." + std::to_string(i);
-        char *addr = new char[address.length() + 1];
-        std::strcpy(addr, address.c_str());
-        dev->SetAddress(Ipv4Address(addr));
-        // 绑定channel
-        dev->SetChannel(channel);
-
-        // 设置Phy层参数
-        LrWpanSpectrumValueHelper svh;
-        Ptr<SpectrumValue> psd = svh.CreateTxPowerSpectralDensity(txPower, channelNumber);
-        dev->GetPhy()->SetRxSensitivity(rxSensitivity);
-        dev->GetPhy()->SetTxPowerSpectralDensity(psd);
-
-        // 绑定到Recorder
-        dev->GetRoutingProtocol()->SetReceiveTraceCallback(MakeCallback(&RangerRecorder::recordReceive, recorder));
-        dev->GetRoutingProtocol()->SetSendTraceCallback(MakeCallback(&RangerRecorder::recordSend, recorder));
-
-        // 绑定到node
-        nodes.Get(i)->AddDevice(dev);
-
-        devices.push_back(dev);
-    }
-
-    float PacketNum = (float)(1000 - 100) / intervalPacket;
-    for(int i = 0; i < PacketNum; i++) {
-        Simulator::ScheduleWithContext(1,
-                                    Seconds(10 + intervalPacket * i),  // 每0.5秒触发一次
-                                    &RangerRoutingProtocol::SourceAudioDataRequest,
-                                    devices[0]->GetRoutingProtocol(),
-                                    80);
+    ranger.SetRecorder(recorder);
+    Ptr<RangerPacketTraceSink> packetTraceSink = CreateObject<RangerPacketTraceSink>();
+    if (!packetTrace.empty()) {
+        packetTraceSink->Open(packetTrace);
+        ranger.SetPacketTraceSink(packetTraceSink);
     }
+    NetDeviceContainer devices = ranger.Install(nodes);
+
+    // 音频源：从10秒开始，每intervalPacket秒产生一帧，持续900秒
+    Ptr<RangerAudioApp> audioApp = CreateObject<RangerAudioApp>();
+    audioApp->SetAttribute("Mode", StringValue(audioMode));
+    audioApp->SetAttribute("Interval", TimeValue(Seconds(intervalPacket)));
+    audioApp->SetAttribute("AudioSize", UintegerValue(80));
+    audioApp->SetAttribute("TraceFile", StringValue(audioTrace));
+    audioApp->SetStartTime(Seconds(10));
+    audioApp->SetStopTime(Seconds(10 + 1000 - 100));
+    nodes.Get(0)->AddApplication(audioApp);
     // for(int i = 0; i < 10000; i++) {
     //     Simulator::ScheduleWithContext(1,
     //                                 Seconds(10 + intervalPacket * i),  // 每0.5秒触发一次
@@ -236,6 +220,22 @@ int main(int argc, char *argv[]) {
     // AnimationInterface anim ("animation0430-S12-R12.xml");
     Simulator::Stop(Seconds(1000.0));
     Simulator::Run();
+    packetTraceSink->Close();
+
+    // 接收路径上的数据包复制次数
+    uint64_t rxFrames = 0;
+    uint64_t rxDelivered = 0;
+    uint64_t rxCopies = 0;
+    for (uint32_t i = 0; i < devices.GetN(); i++) {
+        Ptr<RangerNetDevice> dev = DynamicCast<RangerNetDevice>(devices.Get(i));
+        rxFrames += dev->GetMac()->GetRxFrameCount();
+        rxDelivered += dev->GetMac()->GetRxDeliveredCount();
+        rxCopies += dev->GetMac()->GetRxPacketCopies();
+    }
+    std::cout << "MAC frames received: " << rxFrames << ", delivered: " << rxDelivered
+              << ", packet copies: " << rxCopies << " ("
+              << (rxDelivered ? (double)rxCopies / rxDelivered : 0.0) << " per delivered frame)"
+              << std::endl;
     Simulator::Destroy();
 
     return 0;
@@ -158,9 +158,7 @@ main(int argc, char* argv[])
         Ptr<RangerNetDevice> dev = CreateObject<RangerNetDevice>();
         // 设置地址
         std::string address = "255.255.255." + std::to_string(index);
-        char *addr = new char[address.length() + 1];
-        std::strcpy(addr, address.c_str());
-        dev->SetAddress(Ipv4Address(addr));
+        dev->SetAddress(Ipv4Address(address.c_str()));
         // 绑定channel
         dev->SetChannel(channel);
 
@@ -190,9 +188,7 @@ main(int argc, char* argv[])
         Ptr<RangerNetDevice> dev = CreateObject<RangerNetDevice>();
         // 设置地址
         std::string address = "255.255.255." + std::to_string(index);
-        char *addr = new char[address.length() + 1];
-        std::strcpy(addr, address.c_str());
-        dev->SetAddress(Ipv4Address(addr));
+        dev->SetAddress(Ipv4Address(address.c_str()));
         // 绑定channel
         dev->SetChannel(channel);
 
@@ -103,9 +103,7 @@ int main(int argc, char *argv[]) {
         mob->SetPosition(Vector(0.0, 0.0, 0.0));
         // 设置地址
         std::string address = "255.255.255." + std::to_string(i);
-        char *addr = new char[address.length() + 1];
-        std::strcpy(addr, address.c_str());
-        dev->SetAddress(Ipv4Address(addr));
+        dev->SetAddress(Ipv4Address(address.c_str()));
         // 绑定channel
         dev->SetChannel(channel);
 
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2011 The Boeing Company
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Microbenchmark of RangerNeighborList: per-packet cost of the forward
+ * selection against the number of one-hop neighbors.
+ *
+ * For each neighbor count, the list is fed with NODEINFO updates for 10 s of
+ * simulated time. Each neighbor advertises --links two-hop links (at most
+ * MessageHeader::NodeInfo::MAX_LINKS, the links a frame can carry) drawn from a
+ * population four times larger than the neighborhood, and misses some of its
+ * updates, so that the table holds a mix of STABLE, UNSTABLE and NONE links.
+ * The list is then queried like RangerRoutingProtocol does for every audio
+ * packet, and the mean wall time per call is reported. The assigned forwarders
+ * are cached until the list changes; "miss ns" is the cost of a source call
+ * right after a change, "source ns" and "forward ns" the cost between changes.
+ *
+ * ./ns3 run "ranger-nblist-benchmark --nbCnts=16,64,256,512,1024"
+ */
+#include <ns3/command-line.h>
+#include <ns3/ranger-routing-nblist.h>
+#include <ns3/simulator.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+using namespace ns3;
+
+/**
+ * Mean wall time of a call, in nanoseconds.
+ * \param iterations number of calls
+ * \param f the call
+ * \return the mean time per call
+ */
+template <typename F>
+static double
+TimeCalls(uint32_t iterations, F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        f(i);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+/**
+ * Address of the i-th node of the population.
+ * \param i node index
+ * \return the address
+ */
+static Ipv4Address
+NodeAddress(uint32_t i)
+{
+    return Ipv4Address(0x0a000000 | (i + 1));
+}
+
+/**
+ * Sends one round of NODEINFO updates to the list, then refreshes it.
+ * \param nbList the neighbor list
+ * \param nbCnt number of one-hop neighbors
+ * \param links two-hop links per neighbor
+ * \param rng random generator
+ */
+static void
+FeedNeighborList(RangerNeighborList* nbList, uint32_t nbCnt, uint32_t links, std::mt19937* rng)
+{
+    std::uniform_int_distribution<uint32_t> population(0, 4 * nbCnt - 1);
+    std::uniform_int_distribution<uint32_t> status(NeighborStatus::STATUS_NONE,
+                                                   NeighborStatus::STATUS_STABLE);
+    std::bernoulli_distribution received(0.8);
+    for (uint32_t i = 0; i < nbCnt; i++)
+    {
+        if (!received(*rng))
+        {
+            continue;
+        }
+        MessageHeader::NodeInfo nodeinfo;
+        for (uint32_t k = 0; k < links; k++)
+        {
+            MessageHeader::NodeInfo::LinkMessage link;
+            link.neighborAddresses = NodeAddress(population(*rng));
+            link.linkStatus = status(*rng);
+            nodeinfo.linkMessages.push_back(link);
+        }
+        nodeinfo.linkNumber = nodeinfo.linkMessages.size();
+        nbList->UpdateNeighborNodeStatus(NodeAddress(i), nodeinfo);
+    }
+    Simulator::Schedule(MilliSeconds(500), &RangerNeighborList::RefreshNeighborNodeStatus, nbList);
+}
+
+int
+main(int argc, char* argv[])
+{
+    std::string nbCnts = "16,64,256,512,1024";
+    uint32_t links = 20;
+    uint32_t iterations = 2000;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("nbCnts", "Comma-separated list of one-hop neighbor counts", nbCnts);
+    cmd.AddValue("links", "Two-hop links advertised by each neighbor", links);
+    cmd.AddValue("iterations", "Calls timed per measurement", iterations);
+    cmd.Parse(argc, argv);
+
+    std::cout << std::setw(8) << "nbs" << std::setw(8) << "kept" << std::setw(10) << "assigned"
+              << std::setw(12) << "miss ns" << std::setw(12) << "source ns" << std::setw(12)
+              << "forward ns" << std::setw(12) << "ack ns" << std::setw(12) << "find ns"
+              << std::endl;
+
+    std::istringstream list(nbCnts);
+    std::string item;
+    while (std::getline(list, item, ','))
+    {
+        auto nbCnt = static_cast<uint32_t>(std::stoul(item));
+        std::mt19937 rng(nbCnt);
+        RangerNeighborList nbList(Seconds(1.0), Seconds(5.0));
+        nbList.SetMainAddress(NodeAddress(4 * nbCnt));
+        for (uint32_t t = 0; t < 10; t++)
+        {
+            Simulator::Schedule(Seconds(t), &FeedNeighborList, &nbList, nbCnt, links, &rng);
+        }
+        Simulator::Stop(Seconds(10));
+        Simulator::Run();
+
+        uint64_t assigned = 0;
+        double missNs = TimeCalls(iterations, [&](uint32_t) {
+            // setting the address again invalidates the cache like a topology change
+            nbList.SetMainAddress(NodeAddress(4 * nbCnt));
+            MessageHeader::AudioData audioData;
+            nbList.GetSourceAssignNeighbor(audioData);
+        });
+        double sourceNs = TimeCalls(iterations, [&](uint32_t) {
+            MessageHeader::AudioData audioData;
+            nbList.GetSourceAssignNeighbor(audioData);
+            assigned += audioData.AssignNum;
+        });
+        for (uint32_t i = 0; i < nbCnt; i++)
+        {
+            MessageHeader::AudioData audioData;
+            nbList.GetForwardAssignNeighbor(NodeAddress(i), audioData);
+        }
+        double forwardNs = TimeCalls(iterations, [&](uint32_t i) {
+            MessageHeader::AudioData audioData;
+            nbList.GetForwardAssignNeighbor(NodeAddress(i % nbCnt), audioData);
+        });
+        double ackNs = TimeCalls(iterations, [&](uint32_t i) {
+            nbList.GetAckNeighbor(NodeAddress(i % nbCnt));
+        });
+        uint32_t found = 0;
+        double findNs = TimeCalls(iterations, [&](uint32_t i) {
+            uint32_t index;
+            found += nbList.FindNeighbor(NodeAddress(i % (2 * nbCnt)), index);
+        });
+
+        std::cout << std::setw(8) << nbCnt << std::setw(8) << nbList.GetNeighborCount()
+                  << std::setw(10) << assigned / iterations << std::fixed << std::setprecision(0)
+                  << std::setw(12) << missNs << std::setw(12) << sourceNs << std::setw(12) << forwardNs << std::setw(12)
+                  << ackNs << std::setw(12) << findNs << std::endl;
+        Simulator::Destroy();
+    }
+    return 0;
+}
@@ -0,0 +1,320 @@
+/*
+ * Copyright (c) 2011 The Boeing Company
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Run a ranger network with ns3::MultithreadedSimulatorImpl and 1, 2, 4, 8
+ * and 16 threads, and with the default simulator as a reference.
+ *
+ * The nodes stand still on a square grid, and every sourceEvery-th node runs a
+ * RangerAudioApp. The lookahead of the simulator is the smallest propagation
+ * delay between two nodes (SpectrumChannel::GetMinPropagationDelay), so the
+ * grid spacing sets the length of the synchronization windows.
+ *
+ * Every point runs in its own child process. For each point the number of
+ * executed events, events/s, wall time and the speedup over the single thread
+ * run are reported, together with a digest of the NWK send/receive traces of
+ * every node. The digests of the multithreaded runs must match whatever the
+ * number of threads; the default simulator orders the simultaneous events of
+ * different nodes differently, so its digest may not.
+ *
+ * With more than one thread, ns-3 must be configured with
+ * --enable-multithreaded (NS3_MULTITHREADED), for the reference counts of the
+ * packets shared by the nodes to be thread-safe.
+ *
+ * ./ns3 run "ranger-parallel-benchmark --nodeCnt=400 --simTime=5"
+ * ./ns3 run "ranger-parallel-benchmark --threads=1,4 --spacing=300"
+ */
+#include "ns3/core-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+#include <ns3/lr-wpan-module.h>
+#include <ns3/multithreaded-simulator-impl.h>
+#include <ns3/propagation-delay-model.h>
+#include <ns3/propagation-loss-model.h>
+#include <ns3/ranger-module.h>
+#include <ns3/single-model-spectrum-channel.h>
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ns3;
+
+/**
+ * Result of one benchmark point, sent from the child to the parent process.
+ */
+struct BenchResult
+{
+    uint64_t events;     //!< events executed by the simulator
+    double wallMs;       //!< wall time of Simulator::Run
+    double lookaheadNs;  //!< lookahead of the multithreaded simulator
+    uint64_t sendCnt;    //!< NWK send traces
+    uint64_t receiveCnt; //!< NWK receive traces
+    uint64_t digest;     //!< digest of the NWK traces of all the nodes
+};
+
+/**
+ * NWK traces of one node. The trace sinks of a node are only called by the
+ * thread that runs it.
+ */
+struct NodeTrace
+{
+    uint64_t sendCnt;    //!< NWK send traces
+    uint64_t receiveCnt; //!< NWK receive traces
+    uint64_t digest;     //!< FNV-1a digest of the NWK traces
+};
+
+static std::vector<NodeTrace> g_traces;
+
+static void
+Digest(uint32_t a, uint32_t b, uint8_t seq, Time time)
+{
+    NodeTrace& trace = g_traces[a & 0xffff];
+    const uint64_t values[4] = {a, b, seq, static_cast<uint64_t>(time.GetTimeStep())};
+    for (auto v : values)
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            trace.digest ^= (v >> (8 * i)) & 0xff;
+            trace.digest *= 1099511628211ULL;
+        }
+    }
+}
+
+static void
+RecordReceive(Ipv4Address receiver, Ipv4Address origin, uint8_t seq, Time time)
+{
+    g_traces[receiver.Get() & 0xffff].receiveCnt++;
+    Digest(receiver.Get(), origin.Get(), seq, time);
+}
+
+static void
+RecordSend(Ipv4Address sender, Ipv4Address origin, uint8_t seq, Time time)
+{
+    g_traces[sender.Get() & 0xffff].sendCnt++;
+    Digest(sender.Get(), origin.Get(), seq, time);
+}
+
+/**
+ * Run the scenario once.
+ *
+ * \param threads number of threads of the multithreaded simulator, 0 for the
+ * default simulator
+ */
+static BenchResult
+RunScenario(uint32_t threads,
+            uint32_t nodeCnt,
+            double spacing,
+            uint32_t sourceEvery,
+            double simTime,
+            double intervalPacket)
+{
+    if (threads > 0)
+    {
+        GlobalValue::Bind("SimulatorImplementationType",
+                          StringValue("ns3::MultithreadedSimulatorImpl"));
+        Config::SetDefault("ns3::MultithreadedSimulatorImpl::ThreadCount",
+                           UintegerValue(threads));
+    }
+
+    // 配置一些Phy层参数
+    double txPower = 30;
+    uint32_t channelNumber = 11;
+    double rxSensitivity = -93; // dBm
+
+    // 节点固定在正方形网格上
+    uint32_t columns = std::ceil(std::sqrt(nodeCnt));
+    NodeContainer nodes;
+    nodes.Create(nodeCnt);
+    MobilityHelper mobility;
+    mobility.SetPositionAllocator("ns3::GridPositionAllocator",
+                                  "DeltaX", DoubleValue(spacing),
+                                  "DeltaY", DoubleValue(spacing),
+                                  "GridWidth", UintegerValue(columns));
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    mobility.Install(nodes);
+
+    // 创建Channel
+    Ptr<SingleModelSpectrumChannel> channel = CreateObject<SingleModelSpectrumChannel>();
+    channel->AddPropagationLossModel(CreateObject<LogDistancePropagationLossModel>());
+    channel->SetPropagationDelayModel(CreateObject<ConstantSpeedPropagationDelayModel>());
+
+    g_traces.assign(nodeCnt, NodeTrace{0, 0, 14695981039346656037ULL});
+    for (uint32_t i = 0; i < nodeCnt; i++)
+    {
+        Ptr<RangerNetDevice> dev = CreateObject<RangerNetDevice>();
+        dev->SetAddress(Ipv4Address(i | 0xffff0000));
+        dev->SetChannel(channel);
+
+        LrWpanSpectrumValueHelper svh;
+        Ptr<SpectrumValue> psd = svh.CreateTxPowerSpectralDensity(txPower, channelNumber);
+        dev->GetPhy()->SetRxSensitivity(rxSensitivity);
+        dev->GetPhy()->SetTxPowerSpectralDensity(psd);
+
+        dev->GetRoutingProtocol()->SetReceiveTraceCallback(MakeCallback(&RecordReceive));
+        dev->GetRoutingProtocol()->SetSendTraceCallback(MakeCallback(&RecordSend));
+
+        nodes.Get(i)->AddDevice(dev);
+    }
+
+    for (uint32_t i = 0; i < nodeCnt; i += sourceEvery)
+    {
+        Ptr<RangerAudioApp> audioApp = CreateObject<RangerAudioApp>();
+        audioApp->SetAttribute("Interval", TimeValue(Seconds(intervalPacket)));
+        audioApp->SetAttribute("AudioSize", UintegerValue(80));
+        // 错开各个源的起始时间
+        audioApp->SetStartTime(Seconds(1) + MilliSeconds(7 * (i / sourceEvery)));
+        nodes.Get(i)->AddApplication(audioApp);
+    }
+
+    BenchResult result{};
+    Time lookahead = channel->GetMinPropagationDelay();
+    if (threads > 0)
+    {
+        NS_ABORT_MSG_UNLESS(lookahead.IsStrictlyPositive(),
+                            "the nodes must be apart for the lookahead to be positive");
+        Simulator::GetImplementation()->SetAttribute("Lookahead", TimeValue(lookahead));
+        result.lookaheadNs = lookahead.GetNanoSeconds();
+    }
+
+    Simulator::Stop(Seconds(simTime));
+    SystemWallClockMs clock;
+    clock.Start();
+    Simulator::Run();
+    result.wallMs = clock.End();
+    result.events = Simulator::GetEventCount();
+    Simulator::Destroy();
+
+    // combine the digests of the nodes in node order, whatever thread ran them
+    result.digest = 14695981039346656037ULL;
+    for (const auto& trace : g_traces)
+    {
+        result.sendCnt += trace.sendCnt;
+        result.receiveCnt += trace.receiveCnt;
+        for (int i = 0; i < 8; i++)
+        {
+            result.digest ^= (trace.digest >> (8 * i)) & 0xff;
+            result.digest *= 1099511628211ULL;
+        }
+    }
+    return result;
+}
+
+/**
+ * Run one point in a child process and return its result.
+ */
+static BenchResult
+RunInChild(uint32_t threads,
+           uint32_t nodeCnt,
+           double spacing,
+           uint32_t sourceEvery,
+           double simTime,
+           double intervalPacket)
+{
+    int fds[2];
+    NS_ABORT_MSG_IF(pipe(fds) != 0, "pipe() failed");
+    pid_t pid = fork();
+    NS_ABORT_MSG_IF(pid < 0, "fork() failed");
+    if (pid == 0)
+    {
+        close(fds[0]);
+        BenchResult result =
+            RunScenario(threads, nodeCnt, spacing, sourceEvery, simTime, intervalPacket);
+        ssize_t written = write(fds[1], &result, sizeof(result));
+        _exit(written == sizeof(result) ? 0 : 1);
+    }
+    close(fds[1]);
+    BenchResult result{};
+    ssize_t got = read(fds[0], &result, sizeof(result));
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    NS_ABORT_MSG_IF(got != sizeof(result) || !WIFEXITED(status) || WEXITSTATUS(status) != 0,
+                    "benchmark child for " << threads << " threads failed");
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    CommandLine cmd(__FILE__);
+    std::string threadCnts = "1,2,4,8,16";
+    uint32_t nodeCnt = 400;
+    double spacing = 100;
+    uint32_t sourceEvery = 50;
+    double simTime = 5;
+    double intervalPacket = 0.1;
+    cmd.AddValue("threads", "Comma separated list of thread counts", threadCnts);
+    cmd.AddValue("nodeCnt", "Number of nodes", nodeCnt);
+    cmd.AddValue("spacing", "Distance between two neighbors of the grid (m)", spacing);
+    cmd.AddValue("sourceEvery", "Run an audio source on every n-th node", sourceEvery);
+    cmd.AddValue("simTime", "Simulated time of each run (s), traffic starts at 1 s", simTime);
+    cmd.AddValue("intervalPacket", "Interval between packets", intervalPacket);
+    cmd.Parse(argc, argv);
+
+    NS_ABORT_MSG_IF(nodeCnt < 2 || nodeCnt > 0x10000, "nodeCnt must be in [2, 65536]");
+    NS_ABORT_MSG_IF(sourceEvery == 0, "sourceEvery must be positive");
+
+    std::vector<uint32_t> threads;
+    std::istringstream iss(threadCnts);
+    std::string item;
+    while (std::getline(iss, item, ','))
+    {
+        threads.push_back(std::stoul(item));
+        NS_ABORT_MSG_IF(threads.back() == 0, "thread counts must be positive");
+#ifndef NS3_MULTITHREADED_ENABLE
+        NS_ABORT_MSG_IF(threads.back() > 1,
+                        "more than one thread requires ns-3 configured with "
+                        "--enable-multithreaded");
+#endif
+    }
+
+    BenchResult serial = RunInChild(0, nodeCnt, spacing, sourceEvery, simTime, intervalPacket);
+    std::cout << "default simulator: " << serial.events << " events, " << std::fixed
+              << std::setprecision(0) << serial.wallMs << " ms, " << serial.sendCnt
+              << " sends, " << serial.receiveCnt << " receives" << std::endl;
+
+    std::cout << std::setw(8) << "threads" << std::setw(14) << "events" << std::setw(14)
+              << "events/s" << std::setw(12) << "wall(ms)" << std::setw(10) << "speedup"
+              << std::setw(10) << "sends" << std::setw(12) << "receives" << std::setw(8)
+              << "match" << std::endl;
+    bool allMatch = true;
+    BenchResult reference{};
+    for (std::size_t i = 0; i < threads.size(); i++)
+    {
+        BenchResult r =
+            RunInChild(threads[i], nodeCnt, spacing, sourceEvery, simTime, intervalPacket);
+        if (i == 0)
+        {
+            reference = r;
+            std::cout << "lookahead: " << r.lookaheadNs << " ns" << std::endl;
+        }
+        bool match = r.digest == reference.digest && r.events == reference.events &&
+                     r.sendCnt == reference.sendCnt && r.receiveCnt == reference.receiveCnt;
+        allMatch = allMatch && match;
+        std::cout << std::setw(8) << threads[i] << std::setw(14) << r.events << std::setw(14)
+                  << std::fixed << std::setprecision(0) << r.events / (r.wallMs / 1000.0)
+                  << std::setw(12) << r.wallMs << std::setw(10) << std::setprecision(2)
+                  << reference.wallMs / r.wallMs << std::setw(10) << r.sendCnt << std::setw(12)
+                  << r.receiveCnt << std::setw(8) << (match ? "yes" : "NO") << std::endl;
+    }
+
+    return allMatch ? 0 : 1;
+}
@@ -0,0 +1,448 @@
+/*
+ * Copyright (c) 2011 The Boeing Company
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Compare the periodic (1 ms polling) and the event driven Tx queue checks of
+ * RangerMac and RangerRoutingProtocol on the ranger-comprehensive-test scenario.
+ *
+ * Every (nodeCnt, mode) point runs in its own child process, so that both
+ * modes start from the same random stream indices. For each point the number
+ * of executed events, events/s and wall time are reported, together with a
+ * digest of every NWK send/receive trace. The digests of both modes match as
+ * long as no two nodes start a transmission at the very same instant. When they
+ * do, the frame a receiver locks on to depends on the order of the events with
+ * that timestamp, which differs between the modes, and the traces diverge from
+ * there although both runs are valid. All the nodes start from the same
+ * position, so depending on the random realization this can happen in the
+ * larger networks.
+ *
+ * --scheduler selects the event scheduler of the runs. With --eventTrace the
+ * event driven run of every node count also writes the delay of each event
+ * scheduled, in seconds and one per line, to <eventTrace>-<nodeCnt>.txt. That
+ * is the event time file format of utils/bench-scheduler (--file).
+ *
+ * --gainCache enables the path gain cache of the channel, which reuses the gain
+ * of a transmitter/receiver pair until one of them has moved by more than
+ * --gainCacheTolerance meters. The nodes of this scenario keep walking, so with
+ * a tolerance of 0 nearly every lookup misses. The hit rate of the cache is
+ * reported for each point. With a tolerance the gains differ slightly from the
+ * uncached run, so the traces should only be compared between the modes.
+ *
+ * ./ns3 run "ranger-queue-benchmark --nodeCnts=50,200,1000 --simTime=30"
+ * ./ns3 run "ranger-queue-benchmark --nodeCnts=200 --scheduler=ns3::LadderScheduler"
+ * ./ns3 run "ranger-queue-benchmark --nodeCnts=200 --gainCache=1 --gainCacheTolerance=1"
+ */
+#include "ns3/core-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+#include "ns3/random-walk-2d-mobility-model.h"
+#include <ns3/ranger-module.h>
+#include <ns3/spectrum-channel.h>
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ns3;
+
+/**
+ * Result of one benchmark point, sent from the child to the parent process.
+ */
+struct BenchResult
+{
+    uint64_t events;        //!< events executed by the simulator
+    double wallMs;          //!< wall time of Simulator::Run
+    uint64_t sendCnt;       //!< NWK send traces
+    uint64_t receiveCnt;    //!< NWK receive traces
+    uint64_t digest;        //!< FNV-1a digest of all NWK traces
+    uint64_t gainHits;      //!< gain cache hits of the channel
+    uint64_t gainMisses;    //!< gain cache misses of the channel
+};
+
+static BenchResult g_result;
+
+/**
+ * Scheduler that writes the delay of every event inserted to a file, and
+ * hands the event to another scheduler.
+ */
+class EventTraceScheduler : public Scheduler
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::EventTraceScheduler")
+                .SetParent<Scheduler>()
+                .SetGroupName("Ranger")
+                .AddConstructor<EventTraceScheduler>()
+                .AddAttribute("Scheduler",
+                              "TypeId of the scheduler that holds the events",
+                              TypeId::ATTR_CONSTRUCT,
+                              StringValue("ns3::MapScheduler"),
+                              MakeStringAccessor(&EventTraceScheduler::SetScheduler),
+                              MakeStringChecker())
+                .AddAttribute("FileName",
+                              "File to write the event delays to",
+                              TypeId::ATTR_CONSTRUCT,
+                              StringValue(""),
+                              MakeStringAccessor(&EventTraceScheduler::SetFileName),
+                              MakeStringChecker());
+        return tid;
+    }
+
+    void Insert(const Event& ev) override
+    {
+        m_file << (ev.key.m_ts - Simulator::Now().GetTimeStep()) * m_secondsPerStep << '\n';
+        m_scheduler->Insert(ev);
+    }
+
+    bool IsEmpty() const override
+    {
+        return m_scheduler->IsEmpty();
+    }
+
+    Event PeekNext() const override
+    {
+        return m_scheduler->PeekNext();
+    }
+
+    Event RemoveNext() override
+    {
+        return m_scheduler->RemoveNext();
+    }
+
+    void Remove(const Event& ev) override
+    {
+        m_scheduler->Remove(ev);
+    }
+
+  private:
+    void SetScheduler(std::string type)
+    {
+        m_scheduler = ObjectFactory(type).Create<Scheduler>();
+    }
+
+    void SetFileName(std::string fileName)
+    {
+        if (!fileName.empty())
+        {
+            m_file.open(fileName);
+            NS_ABORT_MSG_UNLESS(m_file.is_open(), "cannot open " << fileName);
+            m_file << std::setprecision(9) << std::fixed;
+        }
+    }
+
+    Ptr<Scheduler> m_scheduler;
+    std::ofstream m_file;
+    double m_secondsPerStep = TimeStep(1).GetSeconds();
+};
+
+NS_OBJECT_ENSURE_REGISTERED(EventTraceScheduler);
+
+static void
+Digest(uint32_t a, uint32_t b, uint8_t seq, Time time)
+{
+    const uint64_t values[4] = {a, b, seq, static_cast<uint64_t>(time.GetTimeStep())};
+    for (auto v : values)
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            g_result.digest ^= (v >> (8 * i)) & 0xff;
+            g_result.digest *= 1099511628211ULL;
+        }
+    }
+}
+
+static void
+RecordReceive(Ipv4Address receiver, Ipv4Address origin, uint8_t seq, Time time)
+{
+    g_result.receiveCnt++;
+    Digest(receiver.Get(), origin.Get(), seq, time);
+}
+
+static void
+RecordSend(Ipv4Address sender, Ipv4Address origin, uint8_t seq, Time time)
+{
+    g_result.sendCnt++;
+    Digest(sender.Get(), origin.Get(), seq, time);
+}
+
+void BoundaryGuards(uint32_t x_min, uint32_t x_max, uint32_t y_min, uint32_t y_max) {
+    NodeContainer boundaryNodes;
+    boundaryNodes.Create(4);
+
+    Ptr<ListPositionAllocator> boundaryPositions = CreateObject<ListPositionAllocator>();
+    boundaryPositions->Add(Vector(x_min, y_min, 0));    // 左下角
+    boundaryPositions->Add(Vector(x_max, y_min, 0));    // 右下角
+    boundaryPositions->Add(Vector(x_min, y_max, 0));    // 左上角
+    boundaryPositions->Add(Vector(x_max, y_max, 0));    // 右上角
+
+    MobilityHelper boundaryMobility;
+    boundaryMobility.SetPositionAllocator(boundaryPositions);
+    boundaryMobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    boundaryMobility.Install(boundaryNodes);
+}
+
+// 输入节点集合和当前逃逸的节点的索引，调整逃逸节点的方向，朝向所有节点中心点运动
+double AdjustDirection(NodeContainer &nodes, uint32_t nodeIndex) {
+    Vector pos_ave = Vector(0, 0, 0);
+    for(uint32_t i = 0; i < nodes.GetN(); i++) {
+        if(i == nodeIndex) continue;
+        Ptr<Node> node = nodes.Get(i);
+        Vector pos_i = node->GetObject<MobilityModel>()->GetPosition();
+        pos_ave.x += pos_i.x;
+        pos_ave.y += pos_i.y;
+        pos_ave.z += pos_i.z;
+    }
+    pos_ave.x /= (nodes.GetN() - 1);
+    pos_ave.y /= (nodes.GetN() - 1);
+    pos_ave.z /= (nodes.GetN() - 1);
+
+    Vector pos_target = nodes.Get(nodeIndex)->GetObject<MobilityModel>()->GetPosition();
+    double angle = atan2(pos_ave.y - pos_target.y, pos_ave.x - pos_target.x);
+    if (angle < 0) {
+        angle += 2 * M_PI;
+    }
+    return angle;
+}
+
+void CheckDistances(NodeContainer &nodes, double maxDistance, Time interval) {
+    for (uint32_t i = 0; i < nodes.GetN(); ++i) {
+        Ptr<Node> node = nodes.Get(i);
+        Vector pos_i = node->GetObject<MobilityModel>()->GetPosition();
+        bool foundCloseNeighbor = false;
+
+        for (uint32_t j = 0; j < nodes.GetN(); ++j) {
+            if (i == j) continue;
+            Ptr<Node> other = nodes.Get(j);
+            Vector pos_j = other->GetObject<MobilityModel>()->GetPosition();
+            double distance = CalculateDistance(pos_i, pos_j);
+            if (distance < maxDistance) {
+                foundCloseNeighbor = true;
+                break;
+            }
+        }
+
+        Ptr<RandomWalk2dMobilityModel> mobility = node->GetObject<RandomWalk2dMobilityModel>();
+        mobility->SetAttribute("Mode", StringValue("Time"));
+        mobility->SetAttribute("Time", TimeValue(Seconds(10.0)));
+        mobility->SetAttribute("Speed", StringValue("ns3::ConstantRandomVariable[Constant=5.0]"));
+        if (!foundCloseNeighbor) {
+            // 如果没有找到近邻，重新设置移动模型的方向和速度
+            Ptr<ConstantRandomVariable> directionVar = CreateObject<ConstantRandomVariable>();
+            directionVar->SetAttribute("Constant", DoubleValue(AdjustDirection(nodes, i)));
+            mobility->SetAttribute("Direction", PointerValue(directionVar));
+        } else {
+            mobility->SetAttribute("Direction", StringValue("ns3::UniformRandomVariable[Min=0.0|Max=6.283184]"));
+        }
+    }
+    Simulator::Schedule(interval, &CheckDistances, std::ref(nodes), 300.0, interval);
+}
+
+/**
+ * Run the ranger-comprehensive-test scenario once and fill g_result.
+ */
+static void
+RunScenario(uint32_t nodeCnt,
+            bool eventDriven,
+            double simTime,
+            double intervalPacket,
+            const std::string& scheduler,
+            const std::string& eventTrace)
+{
+    if (eventDriven && !eventTrace.empty())
+    {
+        ObjectFactory factory("ns3::EventTraceScheduler");
+        factory.Set("Scheduler", StringValue(scheduler));
+        factory.Set("FileName",
+                    StringValue(eventTrace + "-" + std::to_string(nodeCnt) + ".txt"));
+        Simulator::SetScheduler(factory);
+    }
+    else
+    {
+        Simulator::SetScheduler(ObjectFactory(scheduler));
+    }
+    Config::SetDefault("ns3::RangerMac::EventDrivenQueue", BooleanValue(eventDriven));
+    Config::SetDefault("ns3::RangerRoutingProtocol::EventDrivenQueue", BooleanValue(eventDriven));
+
+    uint32_t x_max = 2000;
+    uint32_t y_max = 2000;
+
+    Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator>();
+    for (uint32_t i = 0; i < nodeCnt; ++i) {
+        positionAlloc->Add(Vector(x_max / 2, y_max / 2, 0));  // 为每个节点设置相同的初始位置
+    }
+
+    // 创建节点、设置移动模型
+    NodeContainer nodes;
+    nodes.Create(nodeCnt);
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::RandomWalk2dMobilityModel",
+                              "Mode", StringValue("Time"),
+                              "Time", TimeValue(Seconds(10.0)),
+                              "Speed", StringValue("ns3::ConstantRandomVariable[Constant=5.0]"),
+                              "Bounds", RectangleValue(Rectangle(0, x_max, 0, y_max)));
+    mobility.SetPositionAllocator(positionAlloc);
+    mobility.Install(nodes);
+    Simulator::Schedule(Seconds(5.0), &CheckDistances, std::ref(nodes), 300.0, Seconds(5.0));
+
+    // 创建边界节点
+    BoundaryGuards(0, x_max, 0, y_max);
+
+    // 创建网络设备：默认的Channel和Phy层参数（30 dBm，信道11，-93 dBm），
+    // 所有设备共用PSD和误码模型
+    RangerHelper ranger;
+    NetDeviceContainer devices = ranger.Install(nodes);
+    for (uint32_t i = 0; i < devices.GetN(); i++) {
+        Ptr<RangerRoutingProtocol> routing =
+            DynamicCast<RangerNetDevice>(devices.Get(i))->GetRoutingProtocol();
+        routing->SetReceiveTraceCallback(MakeCallback(&RecordReceive));
+        routing->SetSendTraceCallback(MakeCallback(&RecordSend));
+    }
+    Ptr<SpectrumChannel> channel = ranger.GetChannel();
+
+    Ptr<RangerAudioApp> audioApp = CreateObject<RangerAudioApp>();
+    audioApp->SetAttribute("Interval", TimeValue(Seconds(intervalPacket)));
+    audioApp->SetAttribute("AudioSize", UintegerValue(80));
+    audioApp->SetStartTime(Seconds(10));
+    nodes.Get(0)->AddApplication(audioApp);
+
+    Simulator::Stop(Seconds(simTime));
+    SystemWallClockMs clock;
+    clock.Start();
+    Simulator::Run();
+    g_result.wallMs = clock.End();
+    g_result.events = Simulator::GetEventCount();
+    g_result.gainHits = channel->GetGainCacheHits();
+    g_result.gainMisses = channel->GetGainCacheMisses();
+    Simulator::Destroy();
+}
+
+/**
+ * Run one point in a child process and return its result.
+ */
+static BenchResult
+RunInChild(uint32_t nodeCnt,
+           bool eventDriven,
+           double simTime,
+           double intervalPacket,
+           const std::string& scheduler,
+           const std::string& eventTrace)
+{
+    int fds[2];
+    NS_ABORT_MSG_IF(pipe(fds) != 0, "pipe() failed");
+    pid_t pid = fork();
+    NS_ABORT_MSG_IF(pid < 0, "fork() failed");
+    if (pid == 0)
+    {
+        close(fds[0]);
+        g_result = BenchResult{0, 0.0, 0, 0, 14695981039346656037ULL, 0, 0};
+        RunScenario(nodeCnt, eventDriven, simTime, intervalPacket, scheduler, eventTrace);
+        ssize_t written = write(fds[1], &g_result, sizeof(g_result));
+        _exit(written == sizeof(g_result) ? 0 : 1);
+    }
+    close(fds[1]);
+    BenchResult result{};
+    ssize_t got = read(fds[0], &result, sizeof(result));
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    NS_ABORT_MSG_IF(got != sizeof(result) || !WIFEXITED(status) || WEXITSTATUS(status) != 0,
+                    "benchmark child for " << nodeCnt << " nodes failed");
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    CommandLine cmd(__FILE__);
+    std::string nodeCnts = "50,200,1000";
+    double simTime = 30;
+    double intervalPacket = 0.1;
+    std::string scheduler = "ns3::MapScheduler";
+    std::string eventTrace;
+    bool gainCache = false;
+    double gainCacheTolerance = 0;
+    cmd.AddValue("nodeCnts", "Comma separated list of node counts", nodeCnts);
+    cmd.AddValue("simTime", "Simulated time of each run (s), traffic starts at 10 s", simTime);
+    cmd.AddValue("intervalPacket", "Interval between packets", intervalPacket);
+    cmd.AddValue("scheduler", "TypeId of the event scheduler", scheduler);
+    cmd.AddValue("eventTrace",
+                 "Prefix of the files of event delays written by the event driven runs",
+                 eventTrace);
+    cmd.AddValue("gainCache", "Enable the path gain cache of the channel", gainCache);
+    cmd.AddValue("gainCacheTolerance",
+                 "Movement (m) up to which a cached path gain is reused",
+                 gainCacheTolerance);
+    cmd.Parse(argc, argv);
+
+    Config::SetDefault("ns3::SpectrumChannel::GainCache", BooleanValue(gainCache));
+    Config::SetDefault("ns3::SpectrumChannel::GainCacheTolerance",
+                       DoubleValue(gainCacheTolerance));
+
+    std::vector<uint32_t> counts;
+    std::istringstream iss(nodeCnts);
+    std::string item;
+    while (std::getline(iss, item, ','))
+    {
+        counts.push_back(std::stoul(item));
+    }
+
+    std::cout << std::setw(6) << "nodes" << std::setw(8) << "mode" << std::setw(14) << "events"
+              << std::setw(14) << "events/s" << std::setw(12) << "wall(ms)" << std::setw(10)
+              << "sends" << std::setw(12) << "receives" << std::setw(8) << "match" << std::setw(8) << "hit%"
+              << std::endl;
+    bool allMatch = true;
+    for (auto n : counts)
+    {
+        BenchResult results[2];
+        for (int mode = 0; mode < 2; mode++)
+        {
+            results[mode] =
+                RunInChild(n, mode == 1, simTime, intervalPacket, scheduler, eventTrace);
+        }
+        bool match = results[0].digest == results[1].digest &&
+                     results[0].sendCnt == results[1].sendCnt &&
+                     results[0].receiveCnt == results[1].receiveCnt;
+        allMatch = allMatch && match;
+        for (int mode = 0; mode < 2; mode++)
+        {
+            const BenchResult& r = results[mode];
+            std::cout << std::setw(6) << n << std::setw(8) << (mode == 0 ? "poll" : "event")
+                      << std::setw(14) << r.events << std::setw(14) << std::fixed
+                      << std::setprecision(0) << r.events / (r.wallMs / 1000.0) << std::setw(12)
+                      << r.wallMs << std::setw(10) << r.sendCnt << std::setw(12) << r.receiveCnt
+                      << std::setw(8) << (match ? "yes" : "NO");
+            uint64_t lookups = r.gainHits + r.gainMisses;
+            if (lookups > 0)
+            {
+                std::cout << std::setw(8) << std::setprecision(1)
+                          << 100.0 * r.gainHits / lookups;
+            }
+            else
+            {
+                std::cout << std::setw(8) << "-";
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    return allMatch ? 0 : 1;
+}
@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2011 The Boeing Company
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Measure the startup cost of a ranger network: the time to create the nodes
+ * and their devices, the time to initialize them (a run stopped at 0 s) and
+ * the growth of the resident set size.
+ *
+ * Two ways to build the devices are compared. "loop" is the hand-written loop
+ * of the examples, which gives each device its own error model and tx PSD.
+ * "helper" uses RangerHelper, which shares them between all the devices.
+ * Every (nodeCnt, mode) point runs in its own child process, so that the RSS
+ * of a point is not affected by the memory freed by the previous ones.
+ *
+ * ./ns3 run "ranger-startup-benchmark"
+ * ./ns3 run "ranger-startup-benchmark --nodeCnts=1000,10000,50000"
+ */
+#include "ns3/core-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+#include <ns3/lr-wpan-module.h>
+#include <ns3/propagation-delay-model.h>
+#include <ns3/propagation-loss-model.h>
+#include <ns3/ranger-module.h>
+#include <ns3/single-model-spectrum-channel.h>
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ns3;
+
+/// Recorder of the child process, never destroyed so that it prints no summary
+Ptr<RangerRecorder> g_recorder;
+
+/**
+ * Result of one benchmark point, sent from the child to the parent process.
+ */
+struct StartupResult
+{
+    double buildMs;    //!< wall time to create the nodes and devices
+    double initMs;     //!< wall time to initialize them
+    uint64_t rssBytes; //!< growth of the resident set size
+};
+
+/**
+ * \return the resident set size of the process, in bytes
+ */
+static uint64_t
+GetRss()
+{
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size = 0;
+    uint64_t resident = 0;
+    statm >> size >> resident;
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+/**
+ * Build the devices like the examples do.
+ */
+static void
+InstallLoop(NodeContainer& nodes, Ptr<RangerRecorder> recorder)
+{
+    double txPower = 30;
+    uint32_t channelNumber = 11;
+    double rxSensitivity = -93; // dBm
+
+    Ptr<SingleModelSpectrumChannel> channel = CreateObject<SingleModelSpectrumChannel>();
+    channel->AddPropagationLossModel(CreateObject<LogDistancePropagationLossModel>());
+    channel->SetPropagationDelayModel(CreateObject<ConstantSpeedPropagationDelayModel>());
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+        Ptr<RangerNetDevice> dev = CreateObject<RangerNetDevice>();
+        dev->SetAddress(Ipv4Address(i | 0xffff0000));
+        dev->SetChannel(channel);
+        // 每个设备一个错误模型，与原来的CompleteConfig相同
+        dev->GetPhy()->SetErrorModel(CreateObject<LrWpanErrorModel>());
+
+        LrWpanSpectrumValueHelper svh;
+        Ptr<SpectrumValue> psd = svh.CreateTxPowerSpectralDensity(txPower, channelNumber);
+        dev->GetPhy()->SetRxSensitivity(rxSensitivity);
+        dev->GetPhy()->SetTxPowerSpectralDensity(psd);
+
+        dev->GetRoutingProtocol()->SetReceiveTraceCallback(
+            MakeCallback(&RangerRecorder::recordReceive, recorder));
+        dev->GetRoutingProtocol()->SetSendTraceCallback(
+            MakeCallback(&RangerRecorder::recordSend, recorder));
+        nodes.Get(i)->AddDevice(dev);
+    }
+}
+
+/**
+ * Build and initialize a network of nodeCnt nodes.
+ */
+static StartupResult
+RunPoint(uint32_t nodeCnt, bool helper)
+{
+    StartupResult result{};
+    uint64_t rss = GetRss();
+    SystemWallClockMs clock;
+    clock.Start();
+
+    NodeContainer nodes;
+    nodes.Create(nodeCnt);
+    MobilityHelper mobility;
+    mobility.SetPositionAllocator("ns3::GridPositionAllocator",
+                                  "DeltaX",
+                                  DoubleValue(50),
+                                  "DeltaY",
+                                  DoubleValue(50),
+                                  "GridWidth",
+                                  UintegerValue(100));
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    mobility.Install(nodes);
+
+    g_recorder = CreateObject<RangerRecorder>();
+    if (helper)
+    {
+        RangerHelper ranger;
+        ranger.SetRecorder(g_recorder);
+        ranger.Install(nodes);
+    }
+    else
+    {
+        InstallLoop(nodes, g_recorder);
+    }
+    result.buildMs = clock.End();
+
+    clock.Start();
+    Simulator::Stop(Seconds(0));
+    Simulator::Run();
+    result.initMs = clock.End();
+    result.rssBytes = GetRss() - rss;
+    Simulator::Destroy();
+    return result;
+}
+
+/**
+ * Run one point in a child process and return its result.
+ */
+static StartupResult
+RunInChild(uint32_t nodeCnt, bool helper)
+{
+    int fds[2];
+    NS_ABORT_MSG_IF(pipe(fds) != 0, "pipe() failed");
+    pid_t pid = fork();
+    NS_ABORT_MSG_IF(pid < 0, "fork() failed");
+    if (pid == 0)
+    {
+        close(fds[0]);
+        StartupResult result = RunPoint(nodeCnt, helper);
+        ssize_t written = write(fds[1], &result, sizeof(result));
+        _exit(written == sizeof(result) ? 0 : 1);
+    }
+    close(fds[1]);
+    StartupResult result{};
+    ssize_t got = read(fds[0], &result, sizeof(result));
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    NS_ABORT_MSG_IF(got != sizeof(result) || !WIFEXITED(status) || WEXITSTATUS(status) != 0,
+                    "benchmark child for " << nodeCnt << " nodes failed");
+    return result;
+}
+
+int
+main(int argc, char* argv[])
+{
+    CommandLine cmd(__FILE__);
+    std::string nodeCnts = "1000,10000";
+    cmd.AddValue("nodeCnts", "Comma separated list of node counts", nodeCnts);
+    cmd.Parse(argc, argv);
+
+    std::vector<uint32_t> counts;
+    std::istringstream iss(nodeCnts);
+    std::string item;
+    while (std::getline(iss, item, ','))
+    {
+        counts.push_back(std::stoul(item));
+    }
+
+    std::cout << std::setw(7) << "nodes" << std::setw(8) << "mode" << std::setw(12) << "build(ms)"
+              << std::setw(12) << "init(ms)" << std::setw(12) << "RSS(MiB)" << std::setw(14)
+              << "bytes/node" << std::endl;
+    for (auto n : counts)
+    {
+        for (int mode = 0; mode < 2; mode++)
+        {
+            StartupResult r = RunInChild(n, mode == 1);
+            std::cout << std::setw(7) << n << std::setw(8) << (mode == 0 ? "loop" : "helper")
+                      << std::fixed << std::setprecision(0) << std::setw(12) << r.buildMs
+                      << std::setw(12) << r.initMs << std::setw(12) << std::setprecision(1)
+                      << r.rssBytes / 1048576.0 << std::setw(14) << std::setprecision(0)
+                      << double(r.rssBytes) / n << std::endl;
+        }
+    }
+    return 0;
+}
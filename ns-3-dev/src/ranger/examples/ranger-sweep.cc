@@ -0,0 +1,511 @@
+/*
+ * Copyright (c) 2011 The Boeing Company
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Parameter sweep over the ranger-comprehensive-test scenario.
+ *
+ * The grid file lists one parameter per line, followed by its values
+ * separated by spaces or commas; '#' starts a comment:
+ *
+ *   nodeCnt        = 50 200 1000
+ *   randomSeed     = 1
+ *   randomRun      = 1 2 3 4 5
+ *   intervalPacket = 0.1 0.5
+ *   simTime        = 100
+ *   ns3::RangerRoutingProtocol::EventDrivenQueue = true false
+ *
+ * Parameters containing "::" are passed to Config::SetDefault. Every point of
+ * the cartesian product runs in a child process forked from a pool of --jobs
+ * workers (the number of online cores by default), so the TypeId registration
+ * and the rest of the program startup are paid once for the whole sweep. Each
+ * worker reports the RangerRecorder and RangerMacRecorder indicators of its
+ * point and its wall time, and the results are appended to a single CSV file
+ * as soon as each point completes. Points already present in that file are
+ * skipped, so a crashed or interrupted sweep resumes where it stopped; use
+ * --resume=false to start over.
+ *
+ * ./ns3 run "ranger-sweep --grid=sweep.grid --output=sweep.csv"
+ */
+#include "ns3/core-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+#include "ns3/random-walk-2d-mobility-model.h"
+#include <ns3/ranger-module.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ns3;
+
+/**
+ * One point of the grid.
+ */
+struct SweepPoint
+{
+    uint32_t nodeCnt = 50;
+    uint32_t randomSeed = 1;
+    uint64_t randomRun = 1;
+    double intervalPacket = 0.1;
+    double simTime = 100;
+    std::vector<std::pair<std::string, std::string>> defaults; //!< Config::SetDefault values
+    std::string key; //!< "name=value;..." of every grid parameter, identifies the point
+};
+
+/**
+ * Indicators of one point, sent from the worker to the parent process.
+ */
+struct SweepResult
+{
+    double wallMs;            //!< wall time of the point, setup and teardown included
+    uint64_t events;          //!< events executed by the simulator
+    uint64_t sourceCnt;       //!< audio messages originated
+    uint64_t receiveCnt;      //!< audio messages received
+    double receiveRate;       //!< RangerRecorder receive rate
+    double forwardCost;       //!< RangerRecorder forward cost
+    double delayMeanMs;       //!< mean end-to-end delay
+    double delayP95Ms;        //!< 95th percentile of the end-to-end delay
+    double jitterMeanMs;      //!< mean jitter
+    uint64_t macPktCnt;       //!< packets sent by the MACs
+    uint64_t macSendTimesCnt; //!< transmissions of those packets
+    double macAvgSendTimes;   //!< RangerMacRecorder average send times
+};
+
+void BoundaryGuards(uint32_t x_min, uint32_t x_max, uint32_t y_min, uint32_t y_max) {
+    NodeContainer boundaryNodes;
+    boundaryNodes.Create(4);
+
+    Ptr<ListPositionAllocator> boundaryPositions = CreateObject<ListPositionAllocator>();
+    boundaryPositions->Add(Vector(x_min, y_min, 0));    // 左下角
+    boundaryPositions->Add(Vector(x_max, y_min, 0));    // 右下角
+    boundaryPositions->Add(Vector(x_min, y_max, 0));    // 左上角
+    boundaryPositions->Add(Vector(x_max, y_max, 0));    // 右上角
+
+    MobilityHelper boundaryMobility;
+    boundaryMobility.SetPositionAllocator(boundaryPositions);
+    boundaryMobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    boundaryMobility.Install(boundaryNodes);
+}
+
+// 输入节点集合和当前逃逸的节点的索引，调整逃逸节点的方向，朝向所有节点中心点运动
+double AdjustDirection(NodeContainer &nodes, uint32_t nodeIndex) {
+    Vector pos_ave = Vector(0, 0, 0);
+    for(uint32_t i = 0; i < nodes.GetN(); i++) {
+        if(i == nodeIndex) continue;
+        Ptr<Node> node = nodes.Get(i);
+        Vector pos_i = node->GetObject<MobilityModel>()->GetPosition();
+        pos_ave.x += pos_i.x;
+        pos_ave.y += pos_i.y;
+        pos_ave.z += pos_i.z;
+    }
+    pos_ave.x /= (nodes.GetN() - 1);
+    pos_ave.y /= (nodes.GetN() - 1);
+    pos_ave.z /= (nodes.GetN() - 1);
+
+    Vector pos_target = nodes.Get(nodeIndex)->GetObject<MobilityModel>()->GetPosition();
+    double angle = atan2(pos_ave.y - pos_target.y, pos_ave.x - pos_target.x);
+    if (angle < 0) {
+        angle += 2 * M_PI;
+    }
+    return angle;
+}
+
+void CheckDistances(NodeContainer &nodes, double maxDistance, Time interval) {
+    for (uint32_t i = 0; i < nodes.GetN(); ++i) {
+        Ptr<Node> node = nodes.Get(i);
+        Vector pos_i = node->GetObject<MobilityModel>()->GetPosition();
+        bool foundCloseNeighbor = false;
+
+        for (uint32_t j = 0; j < nodes.GetN(); ++j) {
+            if (i == j) continue;
+            Ptr<Node> other = nodes.Get(j);
+            Vector pos_j = other->GetObject<MobilityModel>()->GetPosition();
+            double distance = CalculateDistance(pos_i, pos_j);
+            if (distance < maxDistance) {
+                foundCloseNeighbor = true;
+                break;
+            }
+        }
+
+        Ptr<RandomWalk2dMobilityModel> mobility = node->GetObject<RandomWalk2dMobilityModel>();
+        mobility->SetAttribute("Mode", StringValue("Time"));
+        mobility->SetAttribute("Time", TimeValue(Seconds(10.0)));
+        mobility->SetAttribute("Speed", StringValue("ns3::ConstantRandomVariable[Constant=5.0]"));
+        if (!foundCloseNeighbor) {
+            // 如果没有找到近邻，重新设置移动模型的方向和速度
+            Ptr<ConstantRandomVariable> directionVar = CreateObject<ConstantRandomVariable>();
+            directionVar->SetAttribute("Constant", DoubleValue(AdjustDirection(nodes, i)));
+            mobility->SetAttribute("Direction", PointerValue(directionVar));
+        } else {
+            mobility->SetAttribute("Direction", StringValue("ns3::UniformRandomVariable[Min=0.0|Max=6.283184]"));
+        }
+    }
+    Simulator::Schedule(interval, &CheckDistances, std::ref(nodes), 300.0, interval);
+}
+
+/**
+ * Run the ranger-comprehensive-test scenario for one point.
+ */
+static SweepResult
+RunPoint(const SweepPoint& point)
+{
+    auto start = std::chrono::steady_clock::now();
+    RngSeedManager::SetSeed(point.randomSeed);
+    RngSeedManager::SetRun(point.randomRun);
+    for (const auto& value : point.defaults)
+    {
+        Config::SetDefault(value.first, StringValue(value.second));
+    }
+
+    uint32_t x_max = 2000;
+    uint32_t y_max = 2000;
+
+    Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator>();
+    for (uint32_t i = 0; i < point.nodeCnt; ++i) {
+        positionAlloc->Add(Vector(x_max / 2, y_max / 2, 0));  // 为每个节点设置相同的初始位置
+    }
+
+    // 创建节点、设置移动模型
+    NodeContainer nodes;
+    nodes.Create(point.nodeCnt);
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::RandomWalk2dMobilityModel",
+                              "Mode", StringValue("Time"),
+                              "Time", TimeValue(Seconds(10.0)),
+                              "Speed", StringValue("ns3::ConstantRandomVariable[Constant=5.0]"),
+                              "Bounds", RectangleValue(Rectangle(0, x_max, 0, y_max)));
+    mobility.SetPositionAllocator(positionAlloc);
+    mobility.Install(nodes);
+    Simulator::Schedule(Seconds(5.0), &CheckDistances, std::ref(nodes), 300.0, Seconds(5.0));
+
+    // 创建边界节点
+    BoundaryGuards(0, x_max, 0, y_max);
+
+    // 创建网络设备：默认的Channel和Phy层参数（30 dBm，信道11，-93 dBm），
+    // 所有设备共用PSD和误码模型
+    Ptr<RangerRecorder> recorder = CreateObject<RangerRecorder>();
+    Ptr<RangerMacRecorder> macRecorder = CreateObject<RangerMacRecorder>();
+    RangerHelper ranger;
+    ranger.SetMacRecorder(macRecorder);
+    NetDeviceContainer devices = ranger.Install(nodes);
+    for (uint32_t i = 0; i < devices.GetN(); i++) {
+        recorder->Connect(DynamicCast<RangerNetDevice>(devices.Get(i))->GetRoutingProtocol());
+    }
+
+    Ptr<RangerAudioApp> audioApp = CreateObject<RangerAudioApp>();
+    audioApp->SetAttribute("Interval", TimeValue(Seconds(point.intervalPacket)));
+    audioApp->SetAttribute("AudioSize", UintegerValue(80));
+    audioApp->SetStartTime(Seconds(10));
+    nodes.Get(0)->AddApplication(audioApp);
+
+    Simulator::Stop(Seconds(point.simTime));
+    Simulator::Run();
+
+    SweepResult result{};
+    result.events = Simulator::GetEventCount();
+    recorder->DoCalculation();
+    result.sourceCnt = recorder->GetTotalSourceCnt();
+    result.receiveCnt = recorder->GetTotalReceiveCnt();
+    result.receiveRate = recorder->GetTotalReceiveRate();
+    result.forwardCost = recorder->GetTotalForwardCost();
+    result.delayMeanMs = recorder->GetDelayStatistics().GetMean();
+    result.delayP95Ms = recorder->GetDelayStatistics().GetQuantile(0.95);
+    result.jitterMeanMs = recorder->GetJitterStatistics().GetMean();
+    macRecorder->DoCalculate();
+    result.macPktCnt = macRecorder->GetTotalPktCnt();
+    result.macSendTimesCnt = macRecorder->GetTotalSendTimesCnt();
+    result.macAvgSendTimes = macRecorder->GetAvgSendTimes();
+
+    Simulator::Destroy();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    result.wallMs = elapsed.count();
+    return result;
+}
+
+/**
+ * Split a list of values separated by spaces or commas.
+ */
+static std::vector<std::string>
+SplitValues(const std::string& text)
+{
+    std::vector<std::string> values;
+    std::istringstream iss(text);
+    std::string item;
+    while (iss >> item)
+    {
+        std::istringstream items(item);
+        std::string value;
+        while (std::getline(items, value, ','))
+        {
+            if (!value.empty())
+            {
+                values.push_back(value);
+            }
+        }
+    }
+    return values;
+}
+
+/**
+ * Read the grid file and expand it into its points, in file order with the
+ * last parameter varying fastest.
+ */
+static std::vector<SweepPoint>
+ReadGrid(const std::string& filename)
+{
+    std::ifstream file(filename);
+    NS_ABORT_MSG_UNLESS(file.is_open(), "Cannot open grid file " << filename);
+
+    std::vector<std::pair<std::string, std::vector<std::string>>> params;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        line = line.substr(0, line.find('#'));
+        std::size_t eq = line.find('=');
+        if (eq == std::string::npos)
+        {
+            NS_ABORT_MSG_IF(!SplitValues(line).empty(), "Malformed grid line: " << line);
+            continue;
+        }
+        std::vector<std::string> name = SplitValues(line.substr(0, eq));
+        std::vector<std::string> values = SplitValues(line.substr(eq + 1));
+        NS_ABORT_MSG_IF(name.size() != 1 || values.empty(), "Malformed grid line: " << line);
+        for (const auto& value : values)
+        {
+            NS_ABORT_MSG_IF(value.find(';') != std::string::npos,
+                            "Grid values must not contain ';': " << value);
+        }
+        params.emplace_back(name[0], values);
+    }
+
+    std::vector<SweepPoint> points(1);
+    for (const auto& param : params)
+    {
+        std::vector<SweepPoint> expanded;
+        for (const auto& base : points)
+        {
+            for (const auto& value : param.second)
+            {
+                SweepPoint point = base;
+                if (param.first == "nodeCnt")
+                {
+                    point.nodeCnt = std::stoul(value);
+                }
+                else if (param.first == "randomSeed")
+                {
+                    point.randomSeed = std::stoul(value);
+                }
+                else if (param.first == "randomRun")
+                {
+                    point.randomRun = std::stoull(value);
+                }
+                else if (param.first == "intervalPacket")
+                {
+                    point.intervalPacket = std::stod(value);
+                }
+                else if (param.first == "simTime")
+                {
+                    point.simTime = std::stod(value);
+                }
+                else
+                {
+                    NS_ABORT_MSG_IF(param.first.find("::") == std::string::npos,
+                                    "Unknown grid parameter " << param.first);
+                    point.defaults.emplace_back(param.first, value);
+                }
+                point.key += (point.key.empty() ? "" : ";") + param.first + "=" + value;
+                expanded.push_back(point);
+            }
+        }
+        points.swap(expanded);
+    }
+    return points;
+}
+
+/**
+ * Keys of the points already present in the output file.
+ */
+static std::set<std::string>
+ReadCompleted(const std::string& filename)
+{
+    std::set<std::string> completed;
+    std::ifstream file(filename);
+    std::string line;
+    std::getline(file, line); // header
+    while (std::getline(file, line))
+    {
+        // a row cut short by a crash has less than all the columns, run it again
+        if (std::count(line.begin(), line.end(), ',') == 12)
+        {
+            completed.insert(line.substr(0, line.find(',')));
+        }
+    }
+    return completed;
+}
+
+/**
+ * A point running in a worker process.
+ */
+struct Worker
+{
+    std::size_t point; //!< index of the point
+    int fd;            //!< read end of the result pipe
+};
+
+/**
+ * Fork a worker for a point.
+ */
+static Worker
+StartWorker(const std::vector<SweepPoint>& points, std::size_t index, bool verbose, pid_t* pid)
+{
+    int fds[2];
+    NS_ABORT_MSG_IF(pipe(fds) != 0, "pipe() failed");
+    *pid = fork();
+    NS_ABORT_MSG_IF(*pid < 0, "fork() failed");
+    if (*pid == 0)
+    {
+        close(fds[0]);
+        if (!verbose)
+        {
+            // the recorders print their indicators on destruction
+            int devNull = open("/dev/null", O_WRONLY);
+            dup2(devNull, STDOUT_FILENO);
+            dup2(devNull, STDERR_FILENO);
+            close(devNull);
+        }
+        SweepResult result = RunPoint(points[index]);
+        // the result is smaller than PIPE_BUF, so the write is atomic and does not block
+        ssize_t written = write(fds[1], &result, sizeof(result));
+        _exit(written == sizeof(result) ? 0 : 1);
+    }
+    close(fds[1]);
+    return Worker{index, fds[0]};
+}
+
+int main(int argc, char *argv[]) {
+    CommandLine cmd(__FILE__);
+    std::string grid;
+    std::string output = "ranger-sweep.csv";
+    uint32_t jobs = 0;
+    bool resume = true;
+    bool verbose = false;
+    cmd.AddValue("grid", "Parameter grid file", grid);
+    cmd.AddValue("output", "Merged CSV results file", output);
+    cmd.AddValue("jobs", "Number of worker processes, 0 for the number of online cores", jobs);
+    cmd.AddValue("resume", "Skip the points already present in the results file", resume);
+    cmd.AddValue("verbose", "Let the workers print to stdout/stderr", verbose);
+    cmd.Parse(argc, argv);
+
+    NS_ABORT_MSG_IF(grid.empty(), "--grid is required");
+    if (jobs == 0)
+    {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        jobs = cores > 0 ? cores : 1;
+    }
+
+    std::vector<SweepPoint> points = ReadGrid(grid);
+    std::set<std::string> completed;
+    if (resume)
+    {
+        completed = ReadCompleted(output);
+    }
+    bool writeHeader = !resume || completed.empty();
+    std::ofstream results(output, writeHeader ? std::ios::trunc : std::ios::app);
+    NS_ABORT_MSG_UNLESS(results.is_open(), "Cannot open results file " << output);
+    if (!writeHeader)
+    {
+        // terminate a row cut short by a crash before appending to it
+        std::ifstream last(output);
+        last.seekg(-1, std::ios::end);
+        if (last.get() != '\n')
+        {
+            results << std::endl;
+        }
+    }
+    if (writeHeader)
+    {
+        results << "point,wall_ms,events,source,receive,receive_rate,forward_cost,"
+                   "delay_mean_ms,delay_p95_ms,jitter_mean_ms,mac_pkts,mac_send_times,"
+                   "mac_avg_send_times"
+                << std::endl;
+    }
+
+    std::vector<std::size_t> pending;
+    for (std::size_t i = 0; i < points.size(); i++)
+    {
+        if (completed.find(points[i].key) == completed.end())
+        {
+            pending.push_back(i);
+        }
+    }
+    std::cout << points.size() << " points, " << points.size() - pending.size()
+              << " already done, " << jobs << " workers" << std::endl;
+
+    std::map<pid_t, Worker> running;
+    std::size_t next = 0;
+    uint32_t failed = 0;
+    while (next < pending.size() || !running.empty())
+    {
+        while (next < pending.size() && running.size() < jobs)
+        {
+            pid_t pid;
+            Worker worker = StartWorker(points, pending[next++], verbose, &pid);
+            running.emplace(pid, worker);
+        }
+
+        int status = 0;
+        pid_t pid = waitpid(-1, &status, 0);
+        auto it = running.find(pid);
+        if (it == running.end())
+        {
+            continue;
+        }
+        Worker worker = it->second;
+        running.erase(it);
+
+        SweepResult r{};
+        ssize_t got = read(worker.fd, &r, sizeof(r));
+        close(worker.fd);
+        const SweepPoint& point = points[worker.point];
+        if (got != sizeof(r) || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            // no row is written, so that the point runs again on resume
+            failed++;
+            std::cerr << "FAILED " << point.key
+                      << (WIFSIGNALED(status) ? " signal " : " exit status ")
+                      << (WIFSIGNALED(status) ? WTERMSIG(status) : WEXITSTATUS(status)) << std::endl;
+            continue;
+        }
+        results << point.key << "," << r.wallMs << "," << r.events << "," << r.sourceCnt << ","
+                << r.receiveCnt << "," << r.receiveRate << "," << r.forwardCost << ","
+                << r.delayMeanMs << "," << r.delayP95Ms << "," << r.jitterMeanMs << ","
+                << r.macPktCnt << "," << r.macSendTimesCnt << "," << r.macAvgSendTimes
+                << std::endl;
+        std::cout << point.key << " " << r.wallMs << " ms" << std::endl;
+    }
+
+    return failed == 0 ? 0 : 1;
+}
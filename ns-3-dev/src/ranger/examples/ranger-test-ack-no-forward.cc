@@ -80,7 +80,7 @@ int main(int argc, char *argv[]) {
 
     uint32_t randomSeed = 1;
     uint32_t randomRun = 1;
-    float intervalPacket = 0.1;
+    double intervalPacket = 0.1;
     LogComponentEnable("RangerRoutingProtocol", LOG_LEVEL_INFO);
     // LogComponentEnable("RangerRoutingProtocol", LOG_LEVEL_FUNCTION);
     LogComponentEnable("RangerMac", LOG_LEVEL_INFO);
@@ -152,9 +152,7 @@ int main(int argc, char *argv[]) {
         Ptr<RangerNetDevice> dev = CreateObject<RangerNetDevice>();
         // 设置地址
         std::string address = "255.255.255." + std::to_string(index);
-        char *addr = new char[address.length() + 1];
-        std::strcpy(addr, address.c_str());
-        dev->SetAddress(Ipv4Address(addr));
+        dev->SetAddress(Ipv4Address(address.c_str()));
         // 绑定channel
         dev->SetChannel(channel);
 
@@ -178,9 +176,7 @@ int main(int argc, char *argv[]) {
         Ptr<RangerNetDevice> dev = CreateObject<RangerNetDevice>();
         // 设置地址
         std::string address = "255.255.255." + std::to_string(index);
-        char *addr = new char[address.length() + 1];
-        std::strcpy(addr, address.c_str());
-        dev->SetAddress(Ipv4Address(addr));
+        dev->SetAddress(Ipv4Address(address.c_str()));
         // 绑定channel
         dev->SetChannel(channel);
 
@@ -200,14 +196,13 @@ int main(int argc, char *argv[]) {
         devices.push_back(dev);
     }
 
-    float PacketNum = (float)(1000) / intervalPacket;
-    for(int i = 0; i < PacketNum; i++) {
-        Simulator::ScheduleWithContext(1,
-                                    Seconds(10 + intervalPacket * i),  // 每0.5秒触发一次
-                                    &RangerRoutingProtocol::SourceAudioDataRequest,
-                                    devices[0]->GetRoutingProtocol(),
-                                    80);
-    }
+    // 音频源：从10秒开始，每intervalPacket秒产生一帧，持续1000秒
+    Ptr<RangerAudioApp> audioApp = CreateObject<RangerAudioApp>();
+    audioApp->SetAttribute("Interval", TimeValue(Seconds(intervalPacket)));
+    audioApp->SetAttribute("AudioSize", UintegerValue(80));
+    audioApp->SetStartTime(Seconds(10));
+    audioApp->SetStopTime(Seconds(10 + 1000));
+    nodes_send.Get(0)->AddApplication(audioApp);
     // for(int i = 0; i < 10000; i++) {
     //     Simulator::ScheduleWithContext(1,
     //                                 Seconds(10 + intervalPacket * i),  // 每0.5秒触发一次
@@ -125,6 +125,9 @@ main(int argc, char* argv[])
     mac_sender->SetMcpsDataIndicationCallback(MakeCallback(&McpsDataIndication));
     mac_receiver->SetMcpsDataIndicationCallback(MakeCallback(&McpsDataIndication));
 
+    mac_sender->Initialize();
+    mac_receiver->Initialize();
+
     // // 创建节点容器
     // NodeContainer nodes;
     // nodes.Create(2);
@@ -19,7 +19,21 @@
  *  Sascha Alexander Jopen <jopen@cs.uni-bonn.de>
  */
 #include "ranger-audio-application.h"
-#include <iomanip>
+
+#include <ns3/abort.h>
+#include <ns3/double.h>
+#include <ns3/enum.h>
+#include <ns3/node.h>
+#include <ns3/object-factory.h>
+#include <ns3/pointer.h>
+#include <ns3/ranger-net-device.h>
+#include <ns3/simulator.h>
+#include <ns3/string.h>
+#include <ns3/uinteger.h>
+
+#include <fstream>
+#include <map>
+#include <sstream>
 
 namespace ns3
 {
@@ -30,12 +44,62 @@ NS_OBJECT_ENSURE_REGISTERED(RangerAudioApp);
 TypeId
 RangerAudioApp::GetTypeId()
 {
-    static TypeId tid = TypeId("ns3::RangerAudioApp").SetParent<Object>().SetGroupName("Ranger");
+    static TypeId tid =
+        TypeId("ns3::RangerAudioApp")
+            .SetParent<Application>()
+            .SetGroupName("Ranger")
+            .AddConstructor<RangerAudioApp>()
+            .AddAttribute("Mode",
+                          "The traffic pattern of the source.",
+                          EnumValue(RangerAudioApp::CBR),
+                          MakeEnumAccessor<Mode>(&RangerAudioApp::m_mode),
+                          MakeEnumChecker(RangerAudioApp::CBR,
+                                          "Cbr",
+                                          RangerAudioApp::ON_OFF,
+                                          "OnOff",
+                                          RangerAudioApp::TRACE,
+                                          "Trace"))
+            .AddAttribute("Interval",
+                          "The time between two frames, in Cbr mode and during a talk spurt.",
+                          TimeValue(MilliSeconds(100)),
+                          MakeTimeAccessor(&RangerAudioApp::m_interval),
+                          MakeTimeChecker(TimeStep(1)))
+            .AddAttribute("AudioSize",
+                          "The size of a frame, in bytes, in Cbr and OnOff modes.",
+                          UintegerValue(80),
+                          MakeUintegerAccessor(&RangerAudioApp::m_audioSize),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("OnTime",
+                          "A RandomVariableStream used to pick the duration of a talk spurt (s). "
+                          "If not set, an exponential random variable of mean 1 s is created "
+                          "in OnOff mode.",
+                          PointerValue(),
+                          MakePointerAccessor(&RangerAudioApp::m_onTime),
+                          MakePointerChecker<RandomVariableStream>())
+            .AddAttribute("OffTime",
+                          "A RandomVariableStream used to pick the duration of a silence (s). "
+                          "If not set, an exponential random variable of mean 1.35 s is created "
+                          "in OnOff mode.",
+                          PointerValue(),
+                          MakePointerAccessor(&RangerAudioApp::m_offTime),
+                          MakePointerChecker<RandomVariableStream>())
+            .AddAttribute("TraceFile",
+                          "The codec trace of the Trace mode, one \"<interval ms> <size bytes>\" "
+                          "line per frame.",
+                          StringValue(""),
+                          MakeStringAccessor(&RangerAudioApp::m_traceFile),
+                          MakeStringChecker())
+            .AddTraceSource("Tx",
+                            "An audio frame is requested from the routing protocol.",
+                            MakeTraceSourceAccessor(&RangerAudioApp::m_txTrace),
+                            "ns3::RangerAudioApp::TxTracedCallback");
     return tid;
 }
 
 
 RangerAudioApp::RangerAudioApp()
+    : m_traceIndex(0),
+      m_sentFrames(0)
 {
 
 }
@@ -45,4 +109,134 @@ RangerAudioApp::~RangerAudioApp()
 
 }
 
-} // namespace ns3
\ No newline at end of file
+void
+RangerAudioApp::DoDispose()
+{
+    m_sendEvent.Cancel();
+    m_routing = nullptr;
+    m_trace.reset();
+    Application::DoDispose();
+}
+
+int64_t
+RangerAudioApp::AssignStreams(int64_t stream)
+{
+    if(m_mode != ON_OFF) {
+        return 0;
+    }
+    CreateOnOffVariables();
+    m_onTime->SetStream(stream);
+    m_offTime->SetStream(stream + 1);
+    return 2;
+}
+
+void
+RangerAudioApp::CreateOnOffVariables()
+{
+    // created on demand, so that the other modes do not take random streams
+    if(!m_onTime) {
+        m_onTime = CreateObjectWithAttributes<ExponentialRandomVariable>("Mean", DoubleValue(1.0));
+    }
+    if(!m_offTime) {
+        m_offTime =
+            CreateObjectWithAttributes<ExponentialRandomVariable>("Mean", DoubleValue(1.35));
+    }
+}
+
+uint64_t
+RangerAudioApp::GetSentFrames() const
+{
+    return m_sentFrames;
+}
+
+std::shared_ptr<const std::vector<RangerAudioApp::Frame>>
+RangerAudioApp::LoadTrace(const std::string& filename)
+{
+    // every source of a run usually plays the same trace
+    static std::map<std::string, std::weak_ptr<const std::vector<Frame>>> traces;
+    std::shared_ptr<const std::vector<Frame>> trace = traces[filename].lock();
+    if(trace) {
+        return trace;
+    }
+
+    std::ifstream file(filename);
+    NS_ABORT_MSG_UNLESS(file.is_open(), "Cannot open audio trace " << filename);
+    auto frames = std::make_shared<std::vector<Frame>>();
+    std::string line;
+    while(std::getline(file, line)) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream iss(line);
+        double intervalMs;
+        uint32_t size;
+        if(iss >> intervalMs >> size) {
+            NS_ABORT_MSG_IF(intervalMs <= 0, "Non positive frame interval in " << filename);
+            frames->push_back({Seconds(intervalMs / 1000), size});
+        }
+    }
+    NS_ABORT_MSG_IF(frames->empty(), "Empty audio trace " << filename);
+    traces[filename] = frames;
+    return frames;
+}
+
+void
+RangerAudioApp::StartApplication()
+{
+    NS_LOG_FUNCTION(this);
+    if(!m_routing) {
+        for(uint32_t i = 0; i < GetNode()->GetNDevices(); i++) {
+            Ptr<RangerNetDevice> dev = DynamicCast<RangerNetDevice>(GetNode()->GetDevice(i));
+            if(dev) {
+                m_routing = dev->GetRoutingProtocol();
+                break;
+            }
+        }
+        NS_ABORT_MSG_UNLESS(m_routing, "RangerAudioApp needs a RangerNetDevice on its node");
+    }
+    if(m_mode == TRACE && !m_trace) {
+        m_trace = LoadTrace(m_traceFile);
+        m_traceIndex = 0;
+    }
+    if(m_mode == ON_OFF) {
+        CreateOnOffVariables();
+        m_spurtEnd = Simulator::Now() + Seconds(m_onTime->GetValue());
+    }
+    m_sendEvent.Cancel();
+    // send the first frame from the start event itself, so that it comes before the
+    // other events of the same time step, like the later frames scheduled in advance
+    SendFrame();
+}
+
+void
+RangerAudioApp::StopApplication()
+{
+    NS_LOG_FUNCTION(this);
+    m_sendEvent.Cancel();
+}
+
+void
+RangerAudioApp::SendFrame()
+{
+    uint32_t size = m_audioSize;
+    Time next = m_interval;
+    if(m_mode == TRACE) {
+        const Frame& frame = (*m_trace)[m_traceIndex];
+        size = frame.size;
+        next = frame.interval;
+        m_traceIndex = (m_traceIndex + 1) % m_trace->size();
+    }
+
+    NS_LOG_INFO("[APP][" << m_routing->GetMainAddress() << "] audio frame of " << size << " bytes");
+    m_routing->SourceAudioDataRequest(size);
+    m_txTrace(size);
+    m_sentFrames++;
+
+    if(m_mode == ON_OFF && Simulator::Now() + next >= m_spurtEnd) {
+        // the next frame starts the next talk spurt, after a silence
+        Time spurtStart = m_spurtEnd + Seconds(m_offTime->GetValue());
+        m_spurtEnd = spurtStart + Seconds(m_onTime->GetValue());
+        next = Max(spurtStart - Simulator::Now(), Time(0));
+    }
+    m_sendEvent = Simulator::Schedule(next, &RangerAudioApp::SendFrame, this);
+}
+
+} // namespace ns3
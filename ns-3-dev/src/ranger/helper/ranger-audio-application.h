@@ -20,71 +20,122 @@
  */
 #ifndef RANGER_AUDIO_APPLICATION_H
 #define RANGER_AUDIO_APPLICATION_H
-#include <unordered_map>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include "ns3/nstime.h"
-#include "ns3/ipv4-address.h"
-#include <ns3/ranger-routing-nblist.h>
 #include <ns3/ranger-routing-protocol.h>
-#include <ns3/ranger-net-device.h>
 
-#include <ns3/object.h>
+#include <ns3/application.h>
+#include <ns3/event-id.h>
+#include <ns3/random-variable-stream.h>
+#include <ns3/traced-callback.h>
 
 
 namespace ns3
 {
 
-struct SentenceReceiveStatus
+/**
+ * An audio source: requests one audio frame at a time from the
+ * RangerRoutingProtocol of its node, and schedules the next frame from its own
+ * timer. A source only ever has one pending event, whatever the length of the
+ * run.
+ *
+ * Three patterns are supported:
+ * - CBR: a frame of AudioSize bytes every Interval.
+ * - ON_OFF: talk spurts and silences, of durations drawn from OnTime and
+ *   OffTime. A frame is sent every Interval during a talk spurt.
+ * - TRACE: the frames of a codec trace file, one "<interval ms> <size bytes>"
+ *   line per frame, the interval being the time to the next frame. The trace
+ *   loops when its end is reached.
+ *
+ * Several sources can be installed on the same node, they share the AudioSeq
+ * space of the node.
+ */
+class RangerAudioApp : public Application
 {
-    Ipv4Address mainAddr;
-    uint8_t receiveCnt;
-    Time totalDelay;
-};
+  public:
+    enum Mode
+    {
+        CBR,
+        ON_OFF,
+        TRACE,
+    };
 
+    RangerAudioApp();
+    ~RangerAudioApp() override;
 
-struct RangerAudioAppSentenceElement
-{
-    Time startTime;
-    uint8_t startSeq;
-    uint8_t pacNum;
-    uint32_t interval_ms;
-    Ipv4Address oriAddr;
-    std::vector<SentenceReceiveStatus> receiveList;
-};
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
 
-struct RangerAudioAppSentenceRecord
-{
-    Time startTime;
-    Ipv4Address oriAddr;
-    float receiveRate;
-    Time aveDelay;
-};
+    /**
+     * Assign a fixed random variable stream number to the random variables
+     * used by this model. Only the OnOff mode uses random variables, so the
+     * Mode must be set first.
+     *
+     * \param stream first stream index to use
+     * \return the number of stream indices assigned by this model
+     */
+    int64_t AssignStreams(int64_t stream);
+
+    /**
+     * \return the number of frames requested so far
+     */
+    uint64_t GetSentFrames() const;
+
+    /**
+     * TracedCallback signature for audio frames.
+     *
+     * \param [in] size the frame size, in bytes.
+     */
+    typedef void (*TxTracedCallback)(uint32_t size);
+
+  protected:
+    void DoDispose() override;
 
-class RangerAudioApp : public Object
-{
   private:
-    std::vector<Ptr<RangerNetDevice>> devices;
-    std::vector<RangerAudioAppSentenceRecord> records;
-    std::vector<RangerAudioAppSentenceElement> currRecords;
+    void StartApplication() override;
+    void StopApplication() override;
 
+    struct Frame
+    {
+        Time interval; // time to the next frame
+        uint32_t size;
+    };
 
-  public:
-    RangerAudioApp();
-    ~RangerAudioApp();
+    /**
+     * Load a trace file, once per file name for all the sources.
+     * \param filename the trace file
+     * \return the frames of the trace
+     */
+    static std::shared_ptr<const std::vector<Frame>> LoadTrace(const std::string& filename);
 
     /**
-     * \brief Get the type ID.
-     * \return the object TypeId
+     * Create the default OnTime and OffTime random variables, if not set.
      */
-    static TypeId GetTypeId();
+    void CreateOnOffVariables();
+
+    void SendFrame();
+
+    Mode m_mode;
+    Time m_interval;
+    uint32_t m_audioSize;
+    Ptr<RandomVariableStream> m_onTime;
+    Ptr<RandomVariableStream> m_offTime;
+    std::string m_traceFile;
 
-    void setDevices(std::vector<Ptr<RangerNetDevice>> devices);
+    Ptr<RangerRoutingProtocol> m_routing;
+    EventId m_sendEvent;
+    Time m_spurtEnd;                                    // end of the current talk spurt
+    std::shared_ptr<const std::vector<Frame>> m_trace; // frames of m_traceFile
+    std::size_t m_traceIndex;                           // next frame in m_trace
+    uint64_t m_sentFrames;
 
-    void audioSend(Ipv4Address sender);
-    void audioReceive(Ipv4Address receiver, Ipv4Address sender, uint8_t seq, Time time);
-    void periodClean();
-    void periodPrint();
+    TracedCallback<uint32_t> m_txTrace;
 };
 
 
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2011 The Boeing Company
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ranger-helper.h"
+
+#include <ns3/abort.h>
+#include <ns3/log.h>
+#include <ns3/lr-wpan-error-model.h>
+#include <ns3/lr-wpan-spectrum-value-helper.h>
+#include <ns3/node.h>
+#include <ns3/propagation-delay-model.h>
+#include <ns3/propagation-loss-model.h>
+#include <ns3/single-model-spectrum-channel.h>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("RangerHelper");
+
+RangerHelper::RangerHelper()
+    : m_txPower(30),
+      m_channelNumber(11),
+      m_rxSensitivity(-93),
+      m_nextAddress(0xffff0000)
+{
+    m_channel = CreateObject<SingleModelSpectrumChannel>();
+    m_channel->AddPropagationLossModel(CreateObject<LogDistancePropagationLossModel>());
+    m_channel->SetPropagationDelayModel(CreateObject<ConstantSpeedPropagationDelayModel>());
+    m_errorModel = CreateObject<LrWpanErrorModel>();
+}
+
+RangerHelper::~RangerHelper()
+{
+    m_channel = nullptr;
+    m_errorModel = nullptr;
+}
+
+Ptr<SpectrumChannel>
+RangerHelper::GetChannel() const
+{
+    return m_channel;
+}
+
+void
+RangerHelper::SetChannel(Ptr<SpectrumChannel> channel)
+{
+    m_channel = channel;
+}
+
+void
+RangerHelper::SetTxPower(double txPower)
+{
+    m_txPower = txPower;
+    m_txPsd = nullptr;
+}
+
+void
+RangerHelper::SetChannelNumber(uint32_t channelNumber)
+{
+    m_channelNumber = channelNumber;
+    m_txPsd = nullptr;
+}
+
+void
+RangerHelper::SetRxSensitivity(double rxSensitivity)
+{
+    m_rxSensitivity = rxSensitivity;
+    m_noisePsd = nullptr;
+}
+
+void
+RangerHelper::SetBaseAddress(Ipv4Address base)
+{
+    m_nextAddress = base.Get();
+}
+
+void
+RangerHelper::SetRecorder(Ptr<RangerRecorder> recorder)
+{
+    m_recorder = recorder;
+}
+
+void
+RangerHelper::SetMacRecorder(Ptr<RangerMacRecorder> recorder)
+{
+    m_macRecorder = recorder;
+}
+
+void
+RangerHelper::SetPacketTraceSink(Ptr<RangerPacketTraceSink> sink)
+{
+    m_packetTraceSink = sink;
+}
+
+NetDeviceContainer
+RangerHelper::Install(NodeContainer c)
+{
+    NetDeviceContainer devices;
+    for (auto i = c.Begin(); i != c.End(); i++)
+    {
+        devices.Add(Install(*i));
+    }
+    return devices;
+}
+
+Ptr<RangerNetDevice>
+RangerHelper::Install(Ptr<Node> node)
+{
+    NS_LOG_FUNCTION(this << node);
+    Ptr<RangerNetDevice> dev = CreateObject<RangerNetDevice>();
+    // 设置地址，绑定channel
+    // the routing protocol floods to the broadcast address, which is also the
+    // last one, so the addresses end there rather than wrap around
+    NS_ABORT_MSG_IF(Ipv4Address(m_nextAddress).IsBroadcast(),
+                    "RangerHelper: no address left for node "
+                        << node->GetId() << ", the next one is the broadcast address; "
+                        << "use a lower base address");
+    dev->SetAddress(Ipv4Address(m_nextAddress++));
+    dev->SetChannel(m_channel);
+
+    // 设置Phy层参数。只有第一个Phy按接收灵敏度计算噪声PSD，
+    // 之后的Phy直接使用共用的PSD，不再各自创建
+    Ptr<LrWpanPhy> phy = dev->GetPhy();
+    if (!m_noisePsd)
+    {
+        phy->SetRxSensitivity(m_rxSensitivity);
+        m_noisePsd = phy->GetNoisePowerSpectralDensity();
+    }
+    else
+    {
+        phy->SetRxSensitivity(m_rxSensitivity, m_noisePsd);
+    }
+    if (!m_txPsd)
+    {
+        LrWpanSpectrumValueHelper svh;
+        m_txPsd = svh.CreateTxPowerSpectralDensity(m_txPower, m_channelNumber);
+    }
+    phy->SetTxPowerSpectralDensity(m_txPsd);
+    phy->SetErrorModel(m_errorModel);
+
+    // 绑定到Recorder
+    Ptr<RangerRoutingProtocol> routing = dev->GetRoutingProtocol();
+    if (m_recorder)
+    {
+        routing->SetReceiveTraceCallback(MakeCallback(&RangerRecorder::recordReceive, m_recorder));
+        routing->SetSendTraceCallback(MakeCallback(&RangerRecorder::recordSend, m_recorder));
+    }
+    if (m_macRecorder)
+    {
+        dev->GetMac()->SetMacSendPktTraceCallback(
+            MakeCallback(&RangerMacRecorder::SendPkt, m_macRecorder));
+        dev->GetMac()->SetMacSendTimesTraceCallback(
+            MakeCallback(&RangerMacRecorder::SendTimes, m_macRecorder));
+    }
+    if (m_packetTraceSink)
+    {
+        m_packetTraceSink->Connect(routing);
+    }
+
+    // 绑定到node
+    node->AddDevice(dev);
+    return dev;
+}
+
+int64_t
+RangerHelper::AssignStreams(NetDeviceContainer c, int64_t stream)
+{
+    NS_LOG_FUNCTION(this << stream);
+    int64_t currentStream = stream;
+    for (auto i = c.Begin(); i != c.End(); i++)
+    {
+        Ptr<RangerNetDevice> dev = DynamicCast<RangerNetDevice>(*i);
+        if (dev)
+        {
+            currentStream += dev->AssignStreams(currentStream);
+        }
+    }
+    return (currentStream - stream);
+}
+
+} // namespace ns3
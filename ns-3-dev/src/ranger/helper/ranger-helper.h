@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2011 The Boeing Company
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef RANGER_HELPER_H
+#define RANGER_HELPER_H
+
+#include <ns3/ipv4-address.h>
+#include <ns3/net-device-container.h>
+#include <ns3/node-container.h>
+#include <ns3/ranger-mac-recorder.h>
+#include <ns3/ranger-net-device.h>
+#include <ns3/ranger-packet-trace-sink.h>
+#include <ns3/ranger-recorder.h>
+
+namespace ns3
+{
+
+class LrWpanErrorModel;
+class SpectrumChannel;
+class SpectrumValue;
+
+/**
+ * Create RangerNetDevice objects, attach them to a channel and to nodes.
+ *
+ * All the devices installed by a helper share the objects that do not change
+ * during a simulation: the error model, the tx PSD and the noise PSD (one per
+ * tx power, channel number and rx sensitivity), and through them the
+ * SpectrumModel. Addresses are assigned in sequence from a base address, and
+ * the recorders given to the helper are connected to every device.
+ *
+ * By default a SingleModelSpectrumChannel is created, with a
+ * LogDistancePropagationLossModel and a ConstantSpeedPropagationDelayModel.
+ */
+class RangerHelper
+{
+  public:
+    RangerHelper();
+    ~RangerHelper();
+
+    RangerHelper(const RangerHelper&) = delete;
+    RangerHelper& operator=(const RangerHelper&) = delete;
+
+    /**
+     * \return the channel the devices are attached to
+     */
+    Ptr<SpectrumChannel> GetChannel() const;
+    /**
+     * \param channel the channel to attach the devices to
+     */
+    void SetChannel(Ptr<SpectrumChannel> channel);
+
+    /**
+     * \param txPower the tx power, in dBm
+     */
+    void SetTxPower(double txPower);
+    /**
+     * \param channelNumber the IEEE 802.15.4 channel number of the tx PSD
+     */
+    void SetChannelNumber(uint32_t channelNumber);
+    /**
+     * \param rxSensitivity the rx sensitivity, in dBm
+     */
+    void SetRxSensitivity(double rxSensitivity);
+
+    /**
+     * Set the address of the next installed device, the following ones get
+     * the next addresses. The default base is 255.255.0.0. Installing a
+     * device aborts when its address would be the broadcast address
+     * 255.255.255.255, e.g. for the 65536th device with the default base.
+     * \param base the address of the next device
+     */
+    void SetBaseAddress(Ipv4Address base);
+
+    /**
+     * Connect the send and receive traces of the routing protocols to a recorder.
+     * \param recorder the recorder, or nullptr
+     */
+    void SetRecorder(Ptr<RangerRecorder> recorder);
+    /**
+     * Connect the send traces of the MACs to a recorder.
+     * \param recorder the recorder, or nullptr
+     */
+    void SetMacRecorder(Ptr<RangerMacRecorder> recorder);
+    /**
+     * Connect the PacketTrace trace sources of the routing protocols to a sink.
+     * \param sink the sink, or nullptr
+     */
+    void SetPacketTraceSink(Ptr<RangerPacketTraceSink> sink);
+
+    /**
+     * Create a device on each node of a container.
+     * \param c the nodes
+     * \return the devices, in the order of the nodes
+     */
+    NetDeviceContainer Install(NodeContainer c);
+    /**
+     * Create a device on a node.
+     * \param node the node
+     * \return the device
+     */
+    Ptr<RangerNetDevice> Install(Ptr<Node> node);
+
+    /**
+     * Assign a fixed random variable stream number to the random variables
+     * used by the devices. Install() should have been called before.
+     * \param c the devices
+     * \param stream first stream index to use
+     * \return the number of stream indices assigned by this helper
+     */
+    int64_t AssignStreams(NetDeviceContainer c, int64_t stream);
+
+  private:
+    Ptr<SpectrumChannel> m_channel;
+    double m_txPower;
+    uint32_t m_channelNumber;
+    double m_rxSensitivity;
+    uint32_t m_nextAddress;
+
+    Ptr<RangerRecorder> m_recorder;
+    Ptr<RangerMacRecorder> m_macRecorder;
+    Ptr<RangerPacketTraceSink> m_packetTraceSink;
+
+    // 所有设备共用的误码模型，只保存常量系数
+    Ptr<LrWpanErrorModel> m_errorModel;
+    // 所有设备共用的PSD，参数改变后重新创建
+    Ptr<SpectrumValue> m_txPsd;
+    Ptr<const SpectrumValue> m_noisePsd;
+};
+
+} // namespace ns3
+
+#endif /* RANGER_HELPER_H */
@@ -0,0 +1,123 @@
+#include "ranger-packet-trace-sink.h"
+
+#include <ns3/abort.h>
+
+#include <cstring>
+
+
+namespace ns3
+{
+
+namespace
+{
+const char TRACE_MAGIC[4] = {'R', 'N', 'P', 'T'};
+const uint16_t TRACE_VERSION = 1;
+const std::size_t TRACE_BUFFER_RECORDS = 4096;
+}   // namespace
+
+RangerPacketTraceSink::RangerPacketTraceSink()
+{
+    m_recordCnt = 0;
+}   // RangerPacketTraceSink
+
+RangerPacketTraceSink::~RangerPacketTraceSink()
+{
+    Close();
+}   // ~RangerPacketTraceSink
+
+TypeId
+RangerPacketTraceSink::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::RangerPacketTraceSink").SetParent<Object>().SetGroupName("Ranger");
+    return tid;
+}   // GetTypeId
+
+void
+RangerPacketTraceSink::DoDispose()
+{
+    Close();
+    Object::DoDispose();
+}   // DoDispose
+
+void
+RangerPacketTraceSink::Open(const std::string& filename)
+{
+    Close();
+    m_file.open(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    NS_ABORT_MSG_UNLESS(m_file.is_open(), "Cannot open packet trace file " << filename);
+
+    uint16_t version = TRACE_VERSION;
+    uint16_t recordSize = sizeof(RangerNwkPacketRecord);
+    m_file.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    m_file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    m_file.write(reinterpret_cast<const char*>(&recordSize), sizeof(recordSize));
+    m_buffer.reserve(TRACE_BUFFER_RECORDS);
+}   // Open
+
+void
+RangerPacketTraceSink::Close()
+{
+    if (m_file.is_open())
+    {
+        Flush();
+        m_file.close();
+    }
+}   // Close
+
+void
+RangerPacketTraceSink::Connect(Ptr<RangerRoutingProtocol> routing)
+{
+    routing->TraceConnectWithoutContext("PacketTrace",
+                                        MakeCallback(&RangerPacketTraceSink::Write, this));
+}   // Connect
+
+void
+RangerPacketTraceSink::Write(const RangerNwkPacketRecord& record)
+{
+    m_recordCnt++;
+    if (!m_file.is_open())
+    {
+        return;
+    }
+    m_buffer.push_back(record);
+    if (m_buffer.size() == TRACE_BUFFER_RECORDS)
+    {
+        Flush();
+    }
+}   // Write
+
+void
+RangerPacketTraceSink::Flush()
+{
+    m_file.write(reinterpret_cast<const char*>(m_buffer.data()),
+                 m_buffer.size() * sizeof(RangerNwkPacketRecord));
+    m_buffer.clear();
+}   // Flush
+
+uint64_t
+RangerPacketTraceSink::GetRecordCount() const
+{
+    return m_recordCnt;
+}   // GetRecordCount
+
+bool
+RangerPacketTraceSink::ReadHeader(std::istream& is)
+{
+    char magic[sizeof(TRACE_MAGIC)];
+    uint16_t version = 0;
+    uint16_t recordSize = 0;
+    is.read(magic, sizeof(magic));
+    is.read(reinterpret_cast<char*>(&version), sizeof(version));
+    is.read(reinterpret_cast<char*>(&recordSize), sizeof(recordSize));
+    return is.good() && std::memcmp(magic, TRACE_MAGIC, sizeof(magic)) == 0 &&
+           version == TRACE_VERSION && recordSize == sizeof(RangerNwkPacketRecord);
+}   // ReadHeader
+
+bool
+RangerPacketTraceSink::ReadRecord(std::istream& is, RangerNwkPacketRecord& record)
+{
+    is.read(reinterpret_cast<char*>(&record), sizeof(record));
+    return is.gcount() == sizeof(record);
+}   // ReadRecord
+
+}   // namespace ns3
@@ -0,0 +1,88 @@
+#ifndef RANGER_PACKET_TRACE_SINK_H
+#define RANGER_PACKET_TRACE_SINK_H
+
+#include <ns3/object.h>
+#include <ns3/ranger-routing-protocol.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+namespace ns3
+{
+
+/**
+ * Binary sink of the PacketTrace trace source of RangerRoutingProtocol.
+ *
+ * The file starts with the 4 bytes "RNPT", a uint16_t format version and the
+ * uint16_t size of a record, followed by RangerNwkPacketRecord structs written
+ * as is, in host byte order. Records are buffered and written in blocks.
+ */
+class RangerPacketTraceSink : public Object
+{
+    public:
+    RangerPacketTraceSink();
+    ~RangerPacketTraceSink() override;
+
+    static TypeId GetTypeId();
+
+    /**
+     * Open the output file and write the file header. Aborts if the file
+     * cannot be created.
+     *
+     * \param filename name of the output file
+     */
+    void Open(const std::string& filename);
+    /**
+     * Write the buffered records and close the output file.
+     */
+    void Close();
+
+    /**
+     * Connect the sink to the PacketTrace trace source of a routing protocol.
+     *
+     * \param routing the routing protocol
+     */
+    void Connect(Ptr<RangerRoutingProtocol> routing);
+
+    /**
+     * Store one record.
+     *
+     * \param record the record
+     */
+    void Write(const RangerNwkPacketRecord& record);
+
+    uint64_t GetRecordCount() const;
+
+    /**
+     * Read and check the header of a trace file.
+     *
+     * \param is the input stream
+     * \return true if the stream holds a trace this version can read
+     */
+    static bool ReadHeader(std::istream& is);
+    /**
+     * Read the next record of a trace file.
+     *
+     * \param is the input stream, past the header
+     * \param record the record read
+     * \return false at the end of the file
+     */
+    static bool ReadRecord(std::istream& is, RangerNwkPacketRecord& record);
+
+    protected:
+    void DoDispose() override;
+
+    private:
+    void Flush();
+
+    std::ofstream m_file;
+    std::vector<RangerNwkPacketRecord> m_buffer;
+    uint64_t m_recordCnt;
+};
+
+
+}   // namespace ns3
+
+#endif /* RANGER_PACKET_TRACE_SINK_H */
@@ -19,7 +19,13 @@
  *  Sascha Alexander Jopen <jopen@cs.uni-bonn.de>
  */
 #include "ranger-recorder.h"
+#include <ns3/abort.h>
+#include <ns3/simulator.h>
+
+#include <algorithm>
+#include <cmath>
 #include <iomanip>
+#include <limits>
 
 namespace ns3
 {
@@ -27,6 +33,107 @@ namespace ns3
 NS_LOG_COMPONENT_DEFINE("RangerRecorder");
 NS_OBJECT_ENSURE_REGISTERED(RangerRecorder);
 
+RangerRunningStatistics::RangerRunningStatistics(double binWidth, uint32_t binCount)
+    : m_binWidth(binWidth),
+      m_histogram(binCount, 0)
+{
+    Clear();
+}
+
+void
+RangerRunningStatistics::Add(double value)
+{
+    m_count++;
+    double delta = value - m_mean;
+    m_mean += delta / m_count;
+    m_m2 += delta * (value - m_mean);
+    m_min = std::min(m_min, value);
+    m_max = std::max(m_max, value);
+
+    double bin = std::floor(value / m_binWidth);
+    if(bin < 0) {
+        bin = 0;
+    }
+    m_histogram[std::min<double>(bin, m_histogram.size() - 1)]++;
+}
+
+void
+RangerRunningStatistics::Clear()
+{
+    std::fill(m_histogram.begin(), m_histogram.end(), 0);
+    m_count = 0;
+    m_mean = 0.0;
+    m_m2 = 0.0;
+    m_min = std::numeric_limits<double>::infinity();
+    m_max = -std::numeric_limits<double>::infinity();
+}
+
+uint64_t
+RangerRunningStatistics::GetCount() const
+{
+    return m_count;
+}
+
+double
+RangerRunningStatistics::GetMean() const
+{
+    return m_mean;
+}
+
+double
+RangerRunningStatistics::GetVariance() const
+{
+    return m_count > 1 ? m_m2 / (m_count - 1) : 0.0;
+}
+
+double
+RangerRunningStatistics::GetStdDev() const
+{
+    return std::sqrt(GetVariance());
+}
+
+double
+RangerRunningStatistics::GetMin() const
+{
+    return m_count > 0 ? m_min : 0.0;
+}
+
+double
+RangerRunningStatistics::GetMax() const
+{
+    return m_count > 0 ? m_max : 0.0;
+}
+
+double
+RangerRunningStatistics::GetQuantile(double q) const
+{
+    if(m_count == 0) {
+        return 0.0;
+    }
+    uint64_t rank = std::ceil(q * m_count);
+    uint64_t seen = 0;
+    for(std::size_t i = 0; i < m_histogram.size(); i++) {
+        seen += m_histogram[i];
+        if(seen >= rank && seen > 0) {
+            // the last bin is open, report the largest sample instead of its edge
+            return i + 1 == m_histogram.size() ? m_max : std::min(m_max, (i + 1) * m_binWidth);
+        }
+    }
+    return m_max;
+}
+
+const std::vector<uint64_t>&
+RangerRunningStatistics::GetHistogram() const
+{
+    return m_histogram;
+}
+
+double
+RangerRunningStatistics::GetBinWidth() const
+{
+    return m_binWidth;
+}
+
 TypeId
 RangerRecorder::GetTypeId()
 {
@@ -35,13 +142,17 @@ RangerRecorder::GetTypeId()
 }
 
 
-RangerRecorder::RangerRecorder() : m_receiveList(), m_sendList()
+RangerRecorder::RangerRecorder()
+    : m_delay(0.1, 10000),
+      m_jitter(0.1, 1000),
+      m_hops(1.0, 32)
 {
 
 }
 
 RangerRecorder::~RangerRecorder()
 {
+    m_flushEvent.Cancel();
     std::ostringstream oss;
     // PrintReceiveList(oss);
     // PrintSendList(oss);
@@ -51,106 +162,327 @@ RangerRecorder::~RangerRecorder()
     NS_LOG_UNCOND(oss.str());
 }
 
+void
+RangerRecorder::DoDispose()
+{
+    m_flushEvent.Cancel();
+    if(m_flushFile.is_open()) {
+        m_flushFile.close();
+    }
+    Object::DoDispose();
+}
+
+uint32_t
+RangerRecorder::GetNodeId(Ipv4Address addr)
+{
+    auto result = m_nodeIds.emplace(addr, m_nodeAddrs.size());
+    if(result.second) {
+        m_nodeAddrs.push_back(addr);
+        m_sourceCnt.push_back(0);
+        m_forwardCnt.push_back(0);
+        m_receiveCnt.push_back(0);
+        m_receiver.push_back(false);
+        m_sourceSlot.push_back(NO_SOURCE);
+        m_nodeDelay.emplace_back(10.0, 100);
+    }
+    return result.first->second;
+}
+
+uint32_t
+RangerRecorder::GetSourceSlot(uint32_t node)
+{
+    if(m_sourceSlot[node] == NO_SOURCE) {
+        m_sourceSlot[node] = m_sources.size();
+        SourceStream source;
+        source.node = node;
+        source.lastSeq = 0;
+        source.sendSeq.assign(256, std::numeric_limits<uint64_t>::max());
+        source.sendTime.assign(256, 0);
+        m_sources.push_back(std::move(source));
+        m_streams.emplace_back();
+    }
+    return m_sourceSlot[node];
+}
+
+RangerRecorder::StreamState&
+RangerRecorder::GetStream(uint32_t slot, uint32_t node)
+{
+    std::vector<StreamState>& streams = m_streams[slot];
+    if(streams.size() <= node) {
+        streams.resize(m_nodeAddrs.size());
+    }
+    return streams[node];
+}
+
 void
 RangerRecorder::recordReceive(Ipv4Address receiver, Ipv4Address sender, uint8_t seq, Time time)
 {
-    m_receiveList[receiver].m_fromList[sender].m_totalCnt++;
-    m_receiveList[receiver].m_fromList[sender].m_lastSeq = seq;
-    m_receiveList[receiver].m_fromList[sender].m_lastTime = time;
+    RecordReceive(GetNodeId(receiver), GetNodeId(sender), seq, time, 0);
+}
+
+void
+RangerRecorder::RecordReceive(uint32_t receiver, uint32_t origin, uint8_t seq, Time time, uint8_t hops)
+{
+    m_receiver[receiver] = true;
+    // only the messages of the other nodes that sent audio data count
+    if(receiver == origin || m_sourceSlot[origin] == NO_SOURCE) {
+        return;
+    }
+    uint32_t slot = m_sourceSlot[origin];
+    SourceStream& source = m_sources[slot];
+    StreamState& stream = GetStream(slot, receiver);
+    m_receiveCnt[receiver]++;
+    stream.receiveCnt++;
+
+    // AudioSeq is a single byte, take the latest message sent with that seq
+    uint64_t unwrapped = source.lastSeq - (uint8_t)((uint8_t)source.lastSeq - seq);
+    if(source.sendSeq[seq] == unwrapped) {
+        int64_t delay = time.GetTimeStep() - source.sendTime[seq];
+        double delayMs = Time(delay).GetSeconds() * 1000;
+        m_delay.Add(delayMs);
+        m_nodeDelay[receiver].Add(delayMs);
+        if(stream.delayed) {
+            m_jitter.Add(std::abs(Time(delay - stream.lastDelay).GetSeconds()) * 1000);
+        }
+        stream.lastDelay = delay;
+        stream.delayed = true;
+    }
+    if(hops > 0) {
+        m_hops.Add(hops);
+    }
+    stream.lastSeq = unwrapped;
+    stream.lastHop = hops;
+    stream.received = true;
 }
 
 void
 RangerRecorder::recordSend(Ipv4Address sender, Ipv4Address origin, uint8_t seq, Time time)
 {
+    uint32_t senderId = GetNodeId(sender);
+    uint32_t slot = GetSourceSlot(GetNodeId(origin));
     if(sender != origin)
     {
-        m_forwardList[sender].m_forwardList[origin].m_totalCnt++;
-        m_forwardList[sender].m_forwardList[origin].m_lastSeq = seq;
-        m_forwardList[sender].m_forwardList[origin].m_lastTime = time;
+        m_forwardCnt[senderId]++;
+        GetStream(slot, senderId).forwardCnt++;
+        return;
+    }
+
+    SourceStream& source = m_sources[slot];
+    uint64_t unwrapped = seq;
+    if(m_sourceCnt[senderId] > 0) {
+        unwrapped = source.lastSeq + (uint8_t)(seq - (uint8_t)source.lastSeq);
+    }
+    source.lastSeq = unwrapped;
+    source.sendSeq[seq] = unwrapped;
+    source.sendTime[seq] = time.GetTimeStep();
+    m_sourceCnt[senderId]++;
+}
+
+void
+RangerRecorder::RecordPacket(const RangerNwkPacketRecord& record)
+{
+    if(record.messageType != MessageHeader::AUDIODATA_MESSAGE) {
+        return;
+    }
+    if(record.direction == RangerNwkPacketRecord::SEND) {
+        recordSend(Ipv4Address(record.node), Ipv4Address(record.origin), record.seq, TimeStep(record.time));
+        return;
+    }
+
+    uint32_t receiver = GetNodeId(Ipv4Address(record.node));
+    uint32_t origin = GetNodeId(Ipv4Address(record.origin));
+    uint32_t src = GetNodeId(Ipv4Address(record.src));
+    // one hop more than the copy the previous hop received last, if it is this message
+    uint8_t hops = 0;
+    if(src == origin) {
+        hops = 1;
+    } else if(m_sourceSlot[origin] != NO_SOURCE) {
+        uint32_t slot = m_sourceSlot[origin];
+        uint64_t lastSeq = m_sources[slot].lastSeq;
+        StreamState& prev = GetStream(slot, src);
+        if(prev.received && prev.lastHop > 0 && prev.lastHop < UINT8_MAX &&
+           prev.lastSeq == lastSeq - (uint8_t)((uint8_t)lastSeq - record.seq)) {
+            hops = prev.lastHop + 1;
+        }
+    }
+    RecordReceive(receiver, origin, record.seq, TimeStep(record.time), hops);
+}
+
+void
+RangerRecorder::Connect(Ptr<RangerRoutingProtocol> routing)
+{
+    routing->TraceConnectWithoutContext("PacketTrace", MakeCallback(&RangerRecorder::RecordPacket, this));
+}
+
+void
+RangerRecorder::EnableFlush(const std::string& filename, Time interval, bool binary)
+{
+    m_flushEvent.Cancel();
+    if(m_flushFile.is_open()) {
+        m_flushFile.close();
+    }
+    m_flushFile.open(filename, std::ios::out | std::ios::trunc | (binary ? std::ios::binary : std::ios::out));
+    NS_ABORT_MSG_UNLESS(m_flushFile.is_open(), "Cannot open recorder file " << filename);
+    m_flushBinary = binary;
+    m_flushInterval = interval;
+    if(binary) {
+        // "RNRC", format version, number of columns of a snapshot (address to delay_std_ms)
+        const char magic[4] = {'R', 'N', 'R', 'C'};
+        uint16_t version = 1;
+        uint16_t columns = 8;
+        m_flushFile.write(magic, sizeof(magic));
+        m_flushFile.write(reinterpret_cast<const char*>(&version), sizeof(version));
+        m_flushFile.write(reinterpret_cast<const char*>(&columns), sizeof(columns));
     } else {
-        m_sendList[sender].m_totalCnt++;
-        m_sendList[sender].m_lastSeq = seq;
-        m_sendList[sender].m_lastTime = time;
+        m_flushFile << "time,address,source,forward,receive,receive_rate,delay_cnt,delay_mean_ms,delay_std_ms" << std::endl;
+    }
+    if(interval.IsStrictlyPositive()) {
+        m_flushEvent = Simulator::Schedule(interval, &RangerRecorder::FlushPeriodically, this);
     }
 }
 
 void
-RangerRecorder::DoCalculation()
+RangerRecorder::FlushPeriodically()
 {
-    // Cal receive rate
-    total_receive_cnt = 0;
-    total_should_receive_cnt = 0;
-    total_receive_rate = 0.0;
-    // 遍历所有接受者，把接受者对于发送者的List进行遍历，如果没找到记为0，如果找到了则将这个发送者的包接受数记录
-    // 因为receiver可能也在sender中存在，所以如果receiver和sender相同则不计入总数
-    // 把一个接受者遍历完后，记入总数
-    for(auto& receiver : m_receiveList)
-    {
-        uint32_t total_receive_cnt_tmp = 0;
-        uint32_t total_should_receive_cnt_tmp = 0;
-        for(auto& sender : m_sendList)
-        {
-            uint32_t tmp = 0;
-            if(receiver.second.m_fromList.find(sender.first) != receiver.second.m_fromList.end())
-                tmp = receiver.second.m_fromList[sender.first].m_totalCnt;
-            else 
-                tmp = 0;
+    Flush();
+    m_flushEvent = Simulator::Schedule(m_flushInterval, &RangerRecorder::FlushPeriodically, this);
+}
 
-            if(sender.first != receiver.first) {
-                total_receive_cnt_tmp += tmp;
-                total_should_receive_cnt_tmp += sender.second.m_totalCnt;
-            }
+template <typename T>
+static void
+WriteColumn(std::ostream& os, const std::vector<T>& column)
+{
+    os.write(reinterpret_cast<const char*>(column.data()), column.size() * sizeof(T));
+}
+
+/**
+ * A binary snapshot is a block of
+ *   int64 time step, uint32 row count,
+ * followed by the columns, each one stored contiguously:
+ *   uint32 address, uint64 source, uint64 forward, uint64 receive,
+ *   double receive_rate, uint64 delay_cnt, double delay_mean_ms, double delay_std_ms
+ * in host byte order.
+ */
+void
+RangerRecorder::Flush()
+{
+    if(!m_flushFile.is_open()) {
+        return;
+    }
+    uint64_t totalSource = 0;
+    for(auto cnt : m_sourceCnt) {
+        totalSource += cnt;
+    }
+    std::size_t rows = m_nodeAddrs.size();
+    std::vector<double> receiveRate(rows, 0.0);
+    for(std::size_t i = 0; i < rows; i++) {
+        uint64_t shouldReceive = totalSource - m_sourceCnt[i];
+        if(shouldReceive > 0) {
+            receiveRate[i] = (double)m_receiveCnt[i] / shouldReceive;
         }
-        total_receive_cnt += total_receive_cnt_tmp;
-        total_should_receive_cnt += total_should_receive_cnt_tmp;
     }
-    total_receive_rate = (double)total_receive_cnt / total_should_receive_cnt;
 
-    // Cal the forward cost
+    int64_t now = Simulator::Now().GetTimeStep();
+    if(m_flushBinary) {
+        std::vector<uint32_t> address(rows);
+        std::vector<uint64_t> delayCnt(rows);
+        std::vector<double> delayMean(rows);
+        std::vector<double> delayStd(rows);
+        for(std::size_t i = 0; i < rows; i++) {
+            address[i] = m_nodeAddrs[i].Get();
+            delayCnt[i] = m_nodeDelay[i].GetCount();
+            delayMean[i] = m_nodeDelay[i].GetMean();
+            delayStd[i] = m_nodeDelay[i].GetStdDev();
+        }
+        uint32_t rowCnt = rows;
+        m_flushFile.write(reinterpret_cast<const char*>(&now), sizeof(now));
+        m_flushFile.write(reinterpret_cast<const char*>(&rowCnt), sizeof(rowCnt));
+        WriteColumn(m_flushFile, address);
+        WriteColumn(m_flushFile, m_sourceCnt);
+        WriteColumn(m_flushFile, m_forwardCnt);
+        WriteColumn(m_flushFile, m_receiveCnt);
+        WriteColumn(m_flushFile, receiveRate);
+        WriteColumn(m_flushFile, delayCnt);
+        WriteColumn(m_flushFile, delayMean);
+        WriteColumn(m_flushFile, delayStd);
+    } else {
+        double seconds = Simulator::Now().GetSeconds();
+        for(std::size_t i = 0; i < rows; i++) {
+            m_flushFile << seconds << "," << m_nodeAddrs[i] << "," << m_sourceCnt[i] << "," << m_forwardCnt[i]
+                        << "," << m_receiveCnt[i] << "," << receiveRate[i] << "," << m_nodeDelay[i].GetCount()
+                        << "," << m_nodeDelay[i].GetMean() << "," << m_nodeDelay[i].GetStdDev() << "\n";
+        }
+    }
+    m_flushFile.flush();
+}
+
+void
+RangerRecorder::DoCalculation()
+{
+    // Cal receive rate
+    // 只统计收到过数据的接收者；每个接收者应收到除自己以外所有发送者发出的包
     total_source_cnt = 0;
     total_forward_cnt = 0;
-    total_forward_cost = 0.0;
-    for(auto& sender : m_sendList)
+    total_receive_cnt = 0;
+    total_should_receive_cnt = 0;
+    for(std::size_t i = 0; i < m_nodeAddrs.size(); i++)
     {
-        total_source_cnt += sender.second.m_totalCnt;
+        total_source_cnt += m_sourceCnt[i];
+        total_forward_cnt += m_forwardCnt[i];
     }
-    for(auto& forwarder : m_forwardList)
+    for(std::size_t i = 0; i < m_nodeAddrs.size(); i++)
     {
-        for(auto& origin : forwarder.second.m_forwardList)
-        {
-            total_forward_cnt += origin.second.m_totalCnt;
+        if(m_receiver[i]) {
+            total_receive_cnt += m_receiveCnt[i];
+            total_should_receive_cnt += total_source_cnt - m_sourceCnt[i];
         }
     }
+    total_receive_rate = (double)total_receive_cnt / total_should_receive_cnt;
+
+    // Cal the forward cost
     total_forward_cost = (double)total_forward_cnt / total_source_cnt;
 }
 
 void
 RangerRecorder::Clear()
 {
-    m_receiveList.clear();
-    m_sendList.clear();
-    m_forwardList.clear();
+    m_nodeIds.clear();
+    m_nodeAddrs.clear();
+    m_sourceCnt.clear();
+    m_forwardCnt.clear();
+    m_receiveCnt.clear();
+    m_receiver.clear();
+    m_sourceSlot.clear();
+    m_nodeDelay.clear();
+    m_sources.clear();
+    m_streams.clear();
+    m_delay.Clear();
+    m_jitter.Clear();
+    m_hops.Clear();
     total_source_cnt = 0;
     total_forward_cnt = 0;
     total_receive_cnt = 0;
     total_should_receive_cnt = 0;
     total_receive_rate = 0.0;
     total_forward_cost = 0.0;
-    // total_ratio_forward_receive = 0.0;
-    total_delay = Seconds(0.0);
-    // double total_jitter = 0.0;
 }
 
 void
 RangerRecorder::PrintReceiveList(std::ostream& os)
 {
     os << "-----------------ReceiveList----------------" << std::endl;
-    for(auto& receiver : m_receiveList)
+    for(std::size_t receiver = 0; receiver < m_nodeAddrs.size(); receiver++)
     {
-        os << "Receiver: " << receiver.first << std::endl;
-        for(auto& sender : receiver.second.m_fromList)
+        if(!m_receiver[receiver]) {
+            continue;
+        }
+        os << "Receiver: " << m_nodeAddrs[receiver] << std::endl;
+        for(std::size_t slot = 0; slot < m_sources.size(); slot++)
         {
-            os << "---Sender: " << sender.first << " TotalCnt: " << sender.second.m_totalCnt << std::endl;
+            if(receiver < m_streams[slot].size() && m_streams[slot][receiver].receiveCnt > 0) {
+                os << "---Sender: " << m_nodeAddrs[m_sources[slot].node]
+                   << " TotalCnt: " << m_streams[slot][receiver].receiveCnt << std::endl;
+            }
         }
     }
     os << "-----------------ReceiveList----------------" << std::endl;
@@ -160,9 +492,11 @@ void
 RangerRecorder::PrintSendList(std::ostream& os)
 {
     os << "------------------SendList------------------" << std::endl;
-    for(auto& sender : m_sendList)
+    for(std::size_t sender = 0; sender < m_nodeAddrs.size(); sender++)
     {
-        os << "Sender: " << sender.first << " TotalCnt: " << sender.second.m_totalCnt << std::endl;
+        if(m_sourceCnt[sender] > 0) {
+            os << "Sender: " << m_nodeAddrs[sender] << " TotalCnt: " << m_sourceCnt[sender] << std::endl;
+        }
     }
     os << "------------------SendList------------------" << std::endl;
 }
@@ -171,12 +505,18 @@ void
 RangerRecorder::PrintForwardList(std::ostream& os)
 {
     os << "-----------------ForwardList----------------" << std::endl;
-    for(auto& forwarder : m_forwardList)
+    for(std::size_t forwarder = 0; forwarder < m_nodeAddrs.size(); forwarder++)
     {
-        os << "Forwarder: " << forwarder.first << std::endl;
-        for(auto& origin : forwarder.second.m_forwardList)
+        if(m_forwardCnt[forwarder] == 0) {
+            continue;
+        }
+        os << "Forwarder: " << m_nodeAddrs[forwarder] << std::endl;
+        for(std::size_t slot = 0; slot < m_sources.size(); slot++)
         {
-            os << "---Origin: " << origin.first << " TotalCnt: " << origin.second.m_totalCnt << std::endl;
+            if(forwarder < m_streams[slot].size() && m_streams[slot][forwarder].forwardCnt > 0) {
+                os << "---Origin: " << m_nodeAddrs[m_sources[slot].node]
+                   << " TotalCnt: " << m_streams[slot][forwarder].forwardCnt << std::endl;
+            }
         }
     }
     os << "-----------------ForwardList----------------" << std::endl;
@@ -185,33 +525,34 @@ RangerRecorder::PrintForwardList(std::ostream& os)
 void
 RangerRecorder::PrintReceiveRate(std::ostream& os)
 {
-    total_receive_cnt = 0;
-    total_should_receive_cnt = 0;
-    total_receive_rate = 0.0;
+    DoCalculation();
     os << "=================ReceiveRate=================" << std::endl;
-    for(auto& receiver : m_receiveList)
+    for(std::size_t receiver = 0; receiver < m_nodeAddrs.size(); receiver++)
     {
-        uint32_t total_receive_cnt_tmp = 0;
-        uint32_t total_send_cnt_tmp = 0;
-        os << "Receiver: [" << receiver.first << "]";
-        for(auto& sender : m_sendList)
+        if(!m_receiver[receiver]) {
+            continue;
+        }
+        uint64_t total_receive_cnt_tmp = 0;
+        uint64_t total_send_cnt_tmp = 0;
+        os << "Receiver: [" << m_nodeAddrs[receiver] << "]";
+        for(std::size_t slot = 0; slot < m_sources.size(); slot++)
         {
+            uint32_t sender = m_sources[slot].node;
+            if(m_sourceCnt[sender] == 0) {
+                continue;
+            }
             uint32_t tmp = 0;
-            if(receiver.second.m_fromList.find(sender.first) != receiver.second.m_fromList.end())
-                tmp = receiver.second.m_fromList[sender.first].m_totalCnt;
-            else 
-                tmp = 0;
-
-            os << " ---[" << sender.first << "]:(" << std::setfill('0') << std::setw(6) << tmp \
-             << "/" << std::setfill('0') << std::setw(6) << sender.second.m_totalCnt \
-             << "-" << std::setfill('0') << std::setw(5) << std::fixed << std::setprecision(2) << ((double)tmp / sender.second.m_totalCnt) * 100 << "%)";
-            if(sender.first != receiver.first) {
+            if(receiver < m_streams[slot].size())
+                tmp = m_streams[slot][receiver].receiveCnt;
+
+            os << " ---[" << m_nodeAddrs[sender] << "]:(" << std::setfill('0') << std::setw(6) << tmp \
+             << "/" << std::setfill('0') << std::setw(6) << m_sourceCnt[sender] \
+             << "-" << std::setfill('0') << std::setw(5) << std::fixed << std::setprecision(2) << ((double)tmp / m_sourceCnt[sender]) * 100 << "%)";
+            if(sender != receiver) {
                 total_receive_cnt_tmp += tmp;
-                total_send_cnt_tmp += sender.second.m_totalCnt;
+                total_send_cnt_tmp += m_sourceCnt[sender];
             }
         }
-        total_receive_cnt += total_receive_cnt_tmp;
-        total_should_receive_cnt += total_send_cnt_tmp;
         os << " ---Total:(" << std::setfill('0') << std::setw(6) << total_receive_cnt_tmp \
             << "/" << std::setfill('0') << std::setw(6) << total_send_cnt_tmp \
             << "-" << std::setfill('0') << std::setw(5) << std::fixed << std::setprecision(2) << ((double)total_receive_cnt_tmp / total_send_cnt_tmp) * 100 << "%)";
@@ -219,7 +560,7 @@ RangerRecorder::PrintReceiveRate(std::ostream& os)
     }
     os << "Average Receive Rate:(" << std::setfill('0') << std::setw(8) << total_receive_cnt \
     << "/" << std::setfill('0') << std::setw(8) << total_should_receive_cnt \
-    << "-" << std::setfill('0') << std::setw(5) << std::fixed << std::setprecision(2) << ((double)total_receive_cnt / total_should_receive_cnt) * 100 << "%)";
+    << "-" << std::setfill('0') << std::setw(5) << std::fixed << std::setprecision(2) << total_receive_rate * 100 << "%)";
     os << std::endl;
     os << "=================ReceiveRate=================" << std::endl;
 }
@@ -228,26 +569,31 @@ RangerRecorder::PrintReceiveRate(std::ostream& os)
 void
 RangerRecorder::PrintForwardCost(std::ostream& os)
 {
-    total_source_cnt = 0;
-    for(auto& sender : m_sendList)
-    {
-        total_source_cnt += sender.second.m_totalCnt;
-    }
+    DoCalculation();
     os << "=================ForwardCost=================" << std::endl;
-    total_forward_cnt = 0;
-    total_forward_cost = 0.0;
-    for(auto& forwarder : m_forwardList)
-    {
-        for(auto& origin : forwarder.second.m_forwardList)
-        {
-            total_forward_cnt += origin.second.m_totalCnt;
-        }
-    }
-    total_forward_cost = (double)total_forward_cnt / total_source_cnt;
     os << "Total Forward Cost: " << std::setfill('0') << std::setw(5) << std::fixed << std::setprecision(2) << total_forward_cost << std::endl;
     os << "=================ForwardCost=================" << std::endl;
 }
 
+void
+RangerRecorder::PrintDelay(std::ostream& os)
+{
+    os << "====================Delay====================" << std::endl;
+    const std::pair<const char*, const RangerRunningStatistics*> stats[] = {
+        {"Delay (ms)", &m_delay},
+        {"Jitter (ms)", &m_jitter},
+        {"Hop Count", &m_hops},
+    };
+    for(auto& stat : stats)
+    {
+        os << stat.first << ": cnt " << stat.second->GetCount() << std::fixed << std::setprecision(3)
+           << " mean " << stat.second->GetMean() << " std " << stat.second->GetStdDev()
+           << " min " << stat.second->GetMin() << " p50 " << stat.second->GetQuantile(0.5)
+           << " p95 " << stat.second->GetQuantile(0.95) << " max " << stat.second->GetMax() << std::endl;
+    }
+    os << "====================Delay====================" << std::endl;
+}
+
 /**
  * 1. Calculate the forward cost
  * 2. Calculate the ratio of receive rate to forward cost
@@ -261,7 +607,8 @@ RangerRecorder::PrintGlobalIndicators(std::ostream& os)
     os << "=================GlobalIndicator=================" << std::endl;
     os << "Total Receive Rate: " << std::setfill('0') << std::setw(5) << std::fixed << std::setprecision(2) << total_receive_rate * 100 << "%" << std::endl;
     os << "Total Forward Cost: " << std::setfill('0') << std::setw(5) << std::fixed << std::setprecision(2) << total_forward_cost << std::endl;
-    //os << "Total Receive Rate: " << std::setfill('0') << std::setw(5) << std::fixed << std::setprecision(2) << total_receive_rate * 100 << "%" << std::endl;
+    os << "Average Delay: " << std::fixed << std::setprecision(3) << m_delay.GetMean() << "ms" << std::endl;
+    os << "Average Jitter: " << std::fixed << std::setprecision(3) << m_jitter.GetMean() << "ms" << std::endl;
 
     os << "=================GlobalIndicator=================" << std::endl;
 }
@@ -284,4 +631,28 @@ RangerRecorder::GetTotalReceiveRate() const
     return total_receive_rate;
 }
 
-} // namespace ns3
\ No newline at end of file
+double
+RangerRecorder::GetTotalForwardCost() const
+{
+    return total_forward_cost;
+}
+
+const RangerRunningStatistics&
+RangerRecorder::GetDelayStatistics() const
+{
+    return m_delay;
+}
+
+const RangerRunningStatistics&
+RangerRecorder::GetJitterStatistics() const
+{
+    return m_jitter;
+}
+
+const RangerRunningStatistics&
+RangerRecorder::GetHopStatistics() const
+{
+    return m_hops;
+}
+
+} // namespace ns3
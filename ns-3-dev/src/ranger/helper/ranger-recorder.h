@@ -22,6 +22,7 @@
 #define RANGER_RECORDER_H
 #include <unordered_map>
 
+#include "ns3/event-id.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/nstime.h"
 #include <ns3/ranger-routing-nblist.h>
@@ -29,32 +30,116 @@
 
 #include <ns3/object.h>
 
+#include <fstream>
+#include <string>
+#include <vector>
+
 
 namespace ns3
 {
-struct RecorderElement
-{
-    uint32_t m_totalCnt;
-    uint8_t m_lastSeq;
-    Time m_lastTime;
-};
 
-struct ReceiveRecorderMap
+/**
+ * Online statistics of a sample stream: Welford mean/variance, extrema and a
+ * histogram with fixed bins, the last bin collecting everything above.
+ * Memory does not grow with the number of samples.
+ */
+class RangerRunningStatistics
 {
-    std::unordered_map<Ipv4Address, RecorderElement> m_fromList;
-};
+  public:
+    /**
+     * \param binWidth width of a histogram bin
+     * \param binCount number of histogram bins
+     */
+    RangerRunningStatistics(double binWidth, uint32_t binCount);
 
-struct ForwardRecorderMap
-{
-    std::unordered_map<Ipv4Address, RecorderElement> m_forwardList;
+    void Add(double value);
+    void Clear();
+
+    uint64_t GetCount() const;
+    double GetMean() const;
+    double GetVariance() const;
+    double GetStdDev() const;
+    double GetMin() const;
+    double GetMax() const;
+    /**
+     * Estimate a quantile from the histogram, at the upper edge of its bin.
+     * \param q the quantile, in [0, 1]
+     */
+    double GetQuantile(double q) const;
+    const std::vector<uint64_t>& GetHistogram() const;
+    double GetBinWidth() const;
+
+  private:
+    double m_binWidth;
+    std::vector<uint64_t> m_histogram;
+    uint64_t m_count;
+    double m_mean;
+    double m_m2; // sum of squared differences from the mean
+    double m_min;
+    double m_max;
 };
 
+/**
+ * Delivery, forwarding, delay, jitter and hop count statistics of the audio
+ * data of a run.
+ *
+ * Every address is given a dense node id on first use, and all the counters
+ * are columns indexed by node id, or by (source, node) for the streams of the
+ * nodes that originate audio data. Delay, jitter and hop count are kept as
+ * RangerRunningStatistics, so the memory used does not depend on the length
+ * of the run. With EnableFlush() a snapshot of the per-node columns is
+ * appended to a CSV or columnar binary file periodically.
+ *
+ * Feed it either with the send/receive trace callbacks of
+ * RangerRoutingProtocol (recordSend, recordReceive), or with its PacketTrace
+ * trace source (Connect). Only the latter knows the previous hop of a
+ * message, so hop counts are only recorded in that case.
+ */
 class RangerRecorder : public Object
 {
   private:
-    std::unordered_map<Ipv4Address, ReceiveRecorderMap> m_receiveList;
-    std::unordered_map<Ipv4Address, RecorderElement> m_sendList;
-    std::unordered_map<Ipv4Address, ForwardRecorderMap> m_forwardList;
+    static constexpr uint32_t NO_SOURCE = UINT32_MAX;
+
+    // per source: times of the last 256 audio messages, indexed by AudioSeq
+    struct SourceStream
+    {
+        uint32_t node;                    // node id of the source
+        uint64_t lastSeq;                 // last AudioSeq sent, unwrapped
+        std::vector<uint64_t> sendSeq;    // unwrapped seq of each ring slot
+        std::vector<int64_t> sendTime;    // send time of each ring slot (time steps)
+    };
+
+    // per (source, node)
+    struct StreamState
+    {
+        uint32_t receiveCnt = 0;
+        uint32_t forwardCnt = 0;
+        uint64_t lastSeq = 0;  // last AudioSeq received, unwrapped
+        int64_t lastDelay = 0; // delay of that message (time steps)
+        uint8_t lastHop = 0;   // hop count of that message, 0 if unknown
+        bool received = false; // lastSeq and lastHop are valid
+        bool delayed = false;  // lastDelay is valid
+    };
+
+    // address <-> node id
+    std::unordered_map<Ipv4Address, uint32_t> m_nodeIds;
+    std::vector<Ipv4Address> m_nodeAddrs;
+
+    // per node id
+    std::vector<uint64_t> m_sourceCnt;  // audio messages originated
+    std::vector<uint64_t> m_forwardCnt; // audio messages forwarded
+    std::vector<uint64_t> m_receiveCnt; // audio messages received from the other sources
+    std::vector<bool> m_receiver;       // received any audio message
+    std::vector<uint32_t> m_sourceSlot; // index in m_sources, or NO_SOURCE
+    std::vector<RangerRunningStatistics> m_nodeDelay;
+
+    // per source slot, then per node id
+    std::vector<SourceStream> m_sources;
+    std::vector<std::vector<StreamState>> m_streams;
+
+    RangerRunningStatistics m_delay;  // end-to-end delay (ms)
+    RangerRunningStatistics m_jitter; // delay variation between consecutive messages of a stream (ms)
+    RangerRunningStatistics m_hops;   // hop count
 
     uint64_t total_source_cnt = 0;
     uint64_t total_forward_cnt = 0;
@@ -63,9 +148,21 @@ class RangerRecorder : public Object
 
     double total_receive_rate = 0.0;
     double total_forward_cost = 0.0;
-    //double total_ratio_forward_receive = 0.0;
-    Time total_delay = Seconds(0.0);
-    // double total_jitter = 0.0;
+
+    // periodic flush
+    std::ofstream m_flushFile;
+    bool m_flushBinary = false;
+    Time m_flushInterval;
+    EventId m_flushEvent;
+
+    uint32_t GetNodeId(Ipv4Address addr);
+    uint32_t GetSourceSlot(uint32_t node);
+    StreamState& GetStream(uint32_t slot, uint32_t node);
+    void RecordReceive(uint32_t receiver, uint32_t origin, uint8_t seq, Time time, uint8_t hops);
+    void FlushPeriodically();
+
+  protected:
+    void DoDispose() override;
 
   public:
     RangerRecorder();
@@ -79,6 +176,30 @@ class RangerRecorder : public Object
 
     void recordReceive(Ipv4Address receiver, Ipv4Address sender, uint8_t seq, Time time);
     void recordSend(Ipv4Address sender, Ipv4Address origin, uint8_t seq, Time time);
+    /**
+     * Record an audio message from the PacketTrace trace source.
+     * \param record the message record
+     */
+    void RecordPacket(const RangerNwkPacketRecord& record);
+    /**
+     * Connect the recorder to the PacketTrace trace source of a routing protocol.
+     * \param routing the routing protocol
+     */
+    void Connect(Ptr<RangerRoutingProtocol> routing);
+
+    /**
+     * Append a snapshot of the per-node statistics to a file every interval.
+     * The CSV file has one row per node and snapshot. The binary file has one
+     * block per snapshot, each column of the block stored contiguously.
+     * \param filename name of the output file
+     * \param interval simulated time between two snapshots
+     * \param binary write the binary format instead of CSV
+     */
+    void EnableFlush(const std::string& filename, Time interval, bool binary = false);
+    /**
+     * Append a snapshot of the per-node statistics to the flush file now.
+     */
+    void Flush();
 
     void DoCalculation();
     void Clear();
@@ -88,11 +209,16 @@ class RangerRecorder : public Object
     void PrintForwardList(std::ostream& os);
     void PrintReceiveRate(std::ostream& os);
     void PrintForwardCost(std::ostream& os);
+    void PrintDelay(std::ostream& os);
     void PrintGlobalIndicators(std::ostream& os);
 
     uint64_t GetTotalSourceCnt() const;
     uint64_t GetTotalReceiveCnt() const;
     double GetTotalReceiveRate() const;
+    double GetTotalForwardCost() const;
+    const RangerRunningStatistics& GetDelayStatistics() const;
+    const RangerRunningStatistics& GetJitterStatistics() const;
+    const RangerRunningStatistics& GetHopStatistics() const;
 };
 
 
@@ -181,30 +181,35 @@ RangerMacHeader::GetSerializedSize() const
 void
 RangerMacHeader::Serialize(Buffer::Iterator start) const
 {
+    // 先在栈上编码，再一次写入
+    uint8_t buf[10];
     // 序列化帧控制
-    uint8_t fc = (m_fcFrmType << 5) | (m_fcAckReq << 4);
-    start.WriteU8(fc);
+    buf[0] = (m_fcFrmType << 5) | (m_fcAckReq << 4);
     // 序列化序列号
-    start.WriteU8(m_SeqNum);
+    buf[1] = m_SeqNum;
     // 序列化目的地址
-    WriteTo(start, m_DstAddr);
+    m_DstAddr.Serialize(buf + 2);
     // 序列化源地址
-    WriteTo(start, m_SrcAddr);
+    m_SrcAddr.Serialize(buf + 6);
+    start.Write(buf, 10);
 }
 
 uint32_t
 RangerMacHeader::Deserialize(Buffer::Iterator start)
 {
+    // 一次读出整个头部
+    uint8_t buf[10];
+    start.Read(buf, 10);
     // 反序列化帧控制
-    uint8_t fc = start.ReadU8();
+    uint8_t fc = buf[0];
     m_fcFrmType = (fc >> 5) & 0x07;
     m_fcAckReq = (fc >> 4) & 0x01;
     // 反序列化序列号
-    m_SeqNum = start.ReadU8();
+    m_SeqNum = buf[1];
     // 反序列化目的地址
-    ReadFrom(start, m_DstAddr);
+    m_DstAddr = Ipv4Address::Deserialize(buf + 2);
     // 反序列化源地址
-    ReadFrom(start, m_SrcAddr);
+    m_SrcAddr = Ipv4Address::Deserialize(buf + 6);
     return 10;
 }
 
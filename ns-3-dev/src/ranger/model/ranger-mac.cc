@@ -1,5 +1,11 @@
 #include "ranger-mac.h"
 
+#include <ns3/boolean.h>
+#include <ns3/multithreaded-simulator-impl.h>
+#include <ns3/simulation-singleton.h>
+#include <ns3/trace-source-accessor.h>
+#include <ns3/uinteger.h>
+
 
 namespace ns3
 {
@@ -14,12 +20,89 @@ RangerMac::GetTypeId()
         TypeId("ns3::RangerMac")
             .SetParent<Object>()
             .SetGroupName("Ranger")
-            .AddConstructor<RangerMac>();
+            .AddConstructor<RangerMac>()
+            .AddAttribute("EventDrivenQueue",
+                          "Check the Tx queue only when there is work for it (enqueue, "
+                          "MAC back to IDLE, resend deadline) instead of every 1 ms. "
+                          "The MACs created at the same time share one 1 ms timer, which "
+                          "runs their checks in the same order as the periodic mode.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RangerMac::m_eventDrivenQueue),
+                          MakeBooleanChecker())
+            .AddAttribute("DuplicateFilterDepth",
+                          "Number of sequence numbers remembered per frame type and "
+                          "source address to drop duplicate frames.",
+                          UintegerValue(50),
+                          MakeUintegerAccessor(&RangerMac::SetDuplicateFilterDepth,
+                                               &RangerMac::GetDuplicateFilterDepth),
+                          MakeUintegerChecker<uint32_t>(1, 256))
+            .AddTraceSource("RxDuplicates",
+                            "Number of received frames dropped as duplicates.",
+                            MakeTraceSourceAccessor(&RangerMac::m_rxDuplicateCnt),
+                            "ns3::TracedValueCallback::Uint64");
     return tid;
 }   // RangerMac::GetTypeId
 
+RangerMacDuplicateFilter::RangerMacDuplicateFilter(uint32_t depth)
+{
+    SetDepth(depth);
+}   // RangerMacDuplicateFilter::RangerMacDuplicateFilter
+
+void
+RangerMacDuplicateFilter::SetDepth(uint32_t depth)
+{
+    NS_ASSERT_MSG(depth >= 1 && depth <= 256, "depth must be in [1, 256]");
+    m_depth = depth;
+    m_windows.clear();
+}   // RangerMacDuplicateFilter::SetDepth
+
+uint32_t
+RangerMacDuplicateFilter::GetDepth() const
+{
+    return m_depth;
+}   // RangerMacDuplicateFilter::GetDepth
+
+bool
+RangerMacDuplicateFilter::IsDuplicate(RangerMacHeader::RangerMacType type,
+                                      Ipv4Address srcAddr,
+                                      uint8_t seq)
+{
+    uint64_t key = (static_cast<uint64_t>(type) << 32) | srcAddr.Get();
+    Window& w = m_windows[key];
+
+    uint64_t bit = 1ULL << (seq & 63);
+    uint64_t& word = w.seen[seq >> 6];
+    if (word & bit)
+    {
+        return true;
+    }
+    word |= bit;
+
+    // 窗口已满时用新序列号替换最旧的一个
+    if (w.ring.size() < m_depth)
+    {
+        w.ring.push_back(seq);
+        return false;
+    }
+    uint8_t old = w.ring[w.head];
+    w.seen[old >> 6] &= ~(1ULL << (old & 63));
+    w.ring[w.head] = seq;
+    w.head = (w.head + 1) % m_depth;
+    return false;
+}   // RangerMacDuplicateFilter::IsDuplicate
+
 RangerMac::RangerMac()
+    : m_eventDrivenQueue(false),
+      m_checkQueueTime(Time::Max())
 {
+    {
+        CheckQueueGroupRegistry* registry = SimulationSingleton<CheckQueueGroupRegistry>::Get();
+#ifdef NS3_MULTITHREADED_ENABLE
+        std::unique_lock lock{registry->mutex};
+#endif
+        m_macIndex = registry->macCount++;
+    }
+
     // 初始化MAC地址
     m_address = Ipv4Address("ff.ff.ff.ff");
 
@@ -41,8 +124,10 @@ RangerMac::RangerMac()
     // 初始化发送队列最大长度
     m_maxTxQueueSize = m_txQueue.max_size();
 
-    // 初始化正在接收的数据包指针
-    m_rxPkt = nullptr;
+    // 初始化接收计数
+    m_rxFrameCnt = 0;
+    m_rxDeliveredCnt = 0;
+    m_rxDuplicateCnt = 0;
     // 初始化正在发送的数据包指针
     m_txPkt = nullptr;
     // 初始化重传次数
@@ -64,13 +149,13 @@ RangerMac::RangerMac()
     // 重传间隔
     m_resendInterval = Seconds(0.01);
 
-    // 初始化发送队列检查定时器
-    CheckQueuePeriodically(0.001);
-    
+    // 发送队列检查间隔，定时器在DoInitialize中以节点的上下文启动
+    m_checkQueueInterval = Seconds(0.001);
 }   // RangerMac::RangerMac
 
 RangerMac::~RangerMac()
 {
+    LeaveCheckQueueGroup();
 }   // RangerMac::~RangerMac
 
 void
@@ -78,6 +163,18 @@ RangerMac::DoInitialize()
 {
     SetMacState(ranger::MAC_IDLE);
 
+    // 初始化发送队列检查定时器。事件驱动模式下不周期性检查，只在有发送任务时检查队列
+    m_checkQueueOrigin = Simulator::Now();
+    if (m_eventDrivenQueue)
+    {
+        JoinCheckQueueGroup();
+        ScheduleCheckQueue(Simulator::Now());
+    }
+    else
+    {
+        CheckQueuePeriodically();
+    }
+
     Object::DoInitialize();
 }   // RangerMac::DoInitialize
 
@@ -90,10 +187,11 @@ RangerMac::DoDispose()
         m_txQueue[i]->txQPkt = nullptr;
     }
     m_txQueue.clear();
+    LeaveCheckQueueGroup();
+    m_checkQueueEvent.Cancel();
 
     // 清空指针
     m_phy = nullptr;
-    m_rxPkt = nullptr;
     m_txPkt = nullptr;
 
     // 清空回调函数
@@ -197,43 +295,25 @@ RangerMac::PdDataIndication(uint32_t psduLength, Ptr<Packet> p, uint8_t lqi)
         return;
     }
 
-    // 保存原始包
-    Ptr<Packet> originalPkt = p->Copy();
+    m_rxFrameCnt++;
 
-    // 从包中提取MAC头部
+    // 读取MAC头部，不复制数据包；只有交给上层时才移除头部
     RangerMacHeader macHdr;
-    p->RemoveHeader(macHdr);
+    p->PeekHeader(macHdr);
 
     // 检查是否需要回复ACK
     if (macHdr.GetType() == RangerMacHeader::RANGER_MAC_BROADCAST &&
         macHdr.GetDstAddr() == m_address &&
         macHdr.IsAckReq())
     {
-        m_rxPkt = originalPkt->Copy();
-            SendAck(macHdr.GetSeqNum());
+        SendAck(macHdr.GetSrcAddr(), macHdr.GetSeqNum());
     }
 
     // 比较包的类型、源地址和序列号，如果已收到则丢弃
-    for (auto it = m_rxedPkts.begin(); it != m_rxedPkts.end(); it++)
+    if (m_duplicateFilter.IsDuplicate(macHdr.GetType(), macHdr.GetSrcAddr(), macHdr.GetSeqNum()))
     {
-        if (it->type == macHdr.GetType() &&
-            it->srcAddr == macHdr.GetSrcAddr() &&
-            it->seq == macHdr.GetSeqNum())
-        {
-            return;
-        }
-    }
-
-    // 将包的源地址和序列号加入已收到的包列表
-    RxedPkt rxedPkt;
-    rxedPkt.type = macHdr.GetType();
-    rxedPkt.srcAddr = macHdr.GetSrcAddr();
-    rxedPkt.seq = macHdr.GetSeqNum();
-    m_rxedPkts.emplace_front(rxedPkt);
-    // 如果已收到包队列长度大于50，则删除第一个元素
-    if (m_rxedPkts.size() > 50)
-    {
-        m_rxedPkts.pop_back();
+        m_rxDuplicateCnt++;
+        return;
     }
 
     // 收到ACK包且目的地址是本机
@@ -263,6 +343,8 @@ RangerMac::PdDataIndication(uint32_t psduLength, Ptr<Packet> p, uint8_t lqi)
 
         if (!m_mcpsDataIndicationCallback.IsNull())
         {   // 通知上层数据接收
+            p->RemoveHeader(macHdr);
+            m_rxDeliveredCnt++;
             m_mcpsDataIndicationCallback(indicationParams, p);
         }
     }
@@ -493,6 +575,49 @@ RangerMac::GetAddress() const
     return m_address;
 }   // RangerMac::GetAddress
 
+uint64_t
+RangerMac::GetRxFrameCount() const
+{
+    return m_rxFrameCnt;
+}   // RangerMac::GetRxFrameCount
+
+uint64_t
+RangerMac::GetRxDeliveredCount() const
+{
+    return m_rxDeliveredCnt;
+}   // RangerMac::GetRxDeliveredCount
+
+uint64_t
+RangerMac::GetRxDuplicateCount() const
+{
+    return m_rxDuplicateCnt;
+}   // RangerMac::GetRxDuplicateCount
+
+void
+RangerMac::SetDuplicateFilterDepth(uint32_t depth)
+{
+    m_duplicateFilter.SetDepth(depth);
+}   // RangerMac::SetDuplicateFilterDepth
+
+uint32_t
+RangerMac::GetDuplicateFilterDepth() const
+{
+    return m_duplicateFilter.GetDepth();
+}   // RangerMac::GetDuplicateFilterDepth
+
+uint64_t
+RangerMac::GetRxPacketCopies() const
+{
+    return m_phy ? m_phy->GetRxPacketCopies() : 0;
+}   // RangerMac::GetRxPacketCopies
+
+int64_t
+RangerMac::AssignStreams(int64_t stream)
+{
+    m_random->SetStream(stream);
+    return 1;
+}   // RangerMac::AssignStreams
+
 void
 RangerMac::SetMcpsDataConfirmCallback(ranger::McpsDataConfirmCallback c)
 {
@@ -527,6 +652,7 @@ RangerMac::EnqueueTxQElement(Ptr<TxQueueElement> txQElement)
     {
         m_txQueue.emplace_back(txQElement);
         m_macTxEnqueueTrace(txQElement->txQPkt);
+        ScheduleCheckQueue(Simulator::Now());
     }
     else    // 如果发送队列已满，则丢弃数据包
     {
@@ -579,12 +705,16 @@ RangerMac::CheckQueue()
 
     NS_LOG_FUNCTION(this);
 
+    // 最早的重发时间，事件驱动模式下用于安排下一次检查
+    Time nextResendTime = Time::Max();
+
     // 遍历发送队列
     for (auto it = m_txQueue.begin(); it != m_txQueue.end(); it++)
     {
         // 如果还未到达这个包的重发时间，跳过
         if ((*it)->lastTxTime + m_resendInterval > Simulator::Now())
         {
+            nextResendTime = std::min(nextResendTime, (*it)->lastTxTime + m_resendInterval);
             continue;
         }
         
@@ -602,30 +732,148 @@ RangerMac::CheckQueue()
             copyElement->txQPkt = (*it)->txQPkt->Copy();
             EnqueueTxQElement(copyElement);
         }
-        break;
+        return;
     }
+
+    // 队列中的包都未到重发时间
+    ScheduleCheckQueue(nextResendTime);
 }   // RangerMac::CheckQueue
 
 void
-RangerMac::CheckQueuePeriodically(double t)
+RangerMac::CheckQueuePeriodically()
 {
     CheckQueue();
-    Simulator::Schedule(Seconds(t), &RangerMac::CheckQueuePeriodically, this, t);
+    m_checkQueueEvent =
+        Simulator::Schedule(m_checkQueueInterval, &RangerMac::CheckQueuePeriodically, this);
 }   // RangerMac::CheckQueuePeriodically
 
 void
-RangerMac::SendAck(uint8_t seqNum)
+RangerMac::ScheduleCheckQueue(Time earliest)
 {
-    NS_LOG_FUNCTION(this << static_cast<uint32_t>(seqNum));
+    if (!m_eventDrivenQueue ||
+        m_txQueue.empty() ||
+        m_macState != ranger::MAC_IDLE ||
+        m_setMacState.IsRunning())
+    {
+        return;
+    }
+
+    if (!m_checkQueueGroup)
+    {
+        return;
+    }
+
+    // 本组的定时器还在等待当前时刻时，周期模式下本组当前时刻的检查在本次改变之后执行
+    const EventId& timer = m_checkQueueGroup->timer;
+    bool checkPending = timer.IsRunning() && Simulator::GetDelayLeft(timer).IsZero();
+    Time from = std::max(earliest, Simulator::Now() + TimeStep(checkPending ? 0 : 1));
+    int64_t period = m_checkQueueInterval.GetTimeStep();
+    int64_t offset = (from - m_checkQueueOrigin).GetTimeStep();
+    int64_t steps = offset > 0 ? (offset + period - 1) / period : 0;
+    Time checkTime = m_checkQueueOrigin + TimeStep(steps * period);
+
+    if (m_checkQueueTime <= checkTime)
+    {
+        return;
+    }
+    m_checkQueueTime = checkTime;
+    m_checkQueueGroup->waiting[m_macIndex] = this;
+}   // RangerMac::ScheduleCheckQueue
+
+void
+RangerMac::JoinCheckQueueGroup()
+{
+    // 多线程仿真器中不同节点的事件可能由不同线程执行，每个节点单独成组
+    uint32_t context = Simulator::NO_CONTEXT;
+    if (Simulator::GetImplementation()->GetInstanceTypeId() ==
+        MultithreadedSimulatorImpl::GetTypeId())
+    {
+        context = Simulator::GetContext();
+    }
+
+    CheckQueueGroupRegistry* registry = SimulationSingleton<CheckQueueGroupRegistry>::Get();
+    {
+#ifdef NS3_MULTITHREADED_ENABLE
+        std::unique_lock lock{registry->mutex};
+#endif
+        Ptr<CheckQueueGroup>& group =
+            registry->groups[{m_checkQueueInterval.GetTimeStep(),
+                              m_checkQueueOrigin.GetTimeStep(),
+                              context}];
+        if (!group)
+        {
+            group = Create<CheckQueueGroup>();
+            group->interval = m_checkQueueInterval;
+        }
+        m_checkQueueGroup = group;
+    }
+    m_checkQueueEvent.Cancel();
+    m_checkQueueGroup->members[m_macIndex] = this;
+
+    // 第一个成员在下一个网格点启动本组的定时器
+    if (!m_checkQueueGroup->timer.IsRunning())
+    {
+        int64_t period = m_checkQueueInterval.GetTimeStep();
+        int64_t offset = (Simulator::Now() - m_checkQueueOrigin).GetTimeStep();
+        Time start = m_checkQueueOrigin + TimeStep((offset / period + 1) * period);
+        m_checkQueueGroup->timer = Simulator::Schedule(start - Simulator::Now(),
+                                                       &RangerMac::CheckQueueGroupDue,
+                                                       m_checkQueueGroup);
+    }
+}   // RangerMac::JoinCheckQueueGroup
+
+void
+RangerMac::LeaveCheckQueueGroup()
+{
+    if (!m_checkQueueGroup)
+    {
+        return;
+    }
+    m_checkQueueGroup->members.erase(m_macIndex);
+    m_checkQueueGroup->waiting.erase(m_macIndex);
+    m_checkQueueGroup = nullptr;
+    m_checkQueueTime = Time::Max();
+}   // RangerMac::LeaveCheckQueueGroup
 
-    Ptr<Packet> p = m_rxPkt->Copy();
+void
+RangerMac::CheckQueueGroupDue(Ptr<CheckQueueGroup> group)
+{
+    if (group->members.empty())
+    {
+        return;
+    }
 
-    RangerMacHeader hdr;
-    p->RemoveHeader(hdr);
+    // 先取出到期的MAC，检查时它们可能重新安排下一次检查
+    std::vector<RangerMac*> due;
+    auto& waiting = group->waiting;
+    for (auto it = waiting.begin(); it != waiting.end();)
+    {
+        if (it->second->m_checkQueueTime <= Simulator::Now())
+        {
+            it->second->m_checkQueueTime = Time::Max();
+            due.push_back(it->second);
+            it = waiting.erase(it);
+        }
+        else
+        {
+            it++;
+        }
+    }
+    for (auto mac : due)
+    {
+        mac->CheckQueue();
+    }
+    group->timer = Simulator::Schedule(group->interval, &RangerMac::CheckQueueGroupDue, group);
+}   // RangerMac::CheckQueueGroupDue
+
+void
+RangerMac::SendAck(Ipv4Address dstAddr, uint8_t seqNum)
+{
+    NS_LOG_FUNCTION(this << dstAddr << static_cast<uint32_t>(seqNum));
 
     // Generate a corresponding ACK Frame.
     RangerMacHeader macHdr(RangerMacHeader::RANGER_MAC_ACK, seqNum);
-    macHdr.SetDstAddr(hdr.GetSrcAddr());
+    macHdr.SetDstAddr(dstAddr);
     macHdr.SetSrcAddr(m_address);
 
     Ptr<Packet> ackPacket = Create<Packet>(0);
@@ -639,6 +887,7 @@ RangerMac::SendAck(uint8_t seqNum)
     if (m_txQueue.size() < m_maxTxQueueSize)
     {
         m_txQueue.emplace_front(txQElement);
+        ScheduleCheckQueue(Simulator::Now());
     }
     else    // 如果发送队列已满，则丢弃数据包
     {
@@ -654,6 +903,12 @@ RangerMac::ChangeMacState(ranger::MacState newState)
                     << " to " << newState);
     m_macStateLogger(m_macState, newState);
     m_macState = newState;
+
+    // MAC回到IDLE后，如果队列中还有包，安排下一次检查
+    if (newState == ranger::MAC_IDLE)
+    {
+        ScheduleCheckQueue(Simulator::Now());
+    }
 }   // RangerMac::ChangeMacState
 
 void
@@ -7,12 +7,20 @@
 #include <ns3/lr-wpan-phy.h>
 #include <ns3/log.h>
 #include <ns3/sequence-number.h>
+#include <ns3/simple-ref-count.h>
 #include <ns3/random-variable-stream.h>
 #include <ns3/packet.h>
 #include <ns3/simulator.h>
 #include <ns3/timer.h>
+#include <ns3/traced-value.h>
 
+#include <array>
 #include <deque>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
 
 
 namespace ns3
@@ -156,6 +164,75 @@ using MacSendPktTraceCallback = Callback<void, Ipv4Address>;
 */
 using MacSendTimesTraceCallback = Callback<void, Ipv4Address>;
 
+/**
+ * @ingroup ranger
+ *
+ * @brief Duplicate frame filter of RangerMac.
+ *
+ * Remembers the last sequence numbers received from every (frame type,
+ * source address) pair, up to a depth per pair. Each pair has a bitmap of
+ * the 256 sequence numbers, telling which ones are in the window, and a
+ * ring of the window in arrival order to expire the oldest one. Lookup and
+ * insertion are O(1) whatever the order of the sequence numbers, which
+ * matters for ACKs: their sequence number is the one of the acknowledged
+ * frame.
+ */
+class RangerMacDuplicateFilter
+{
+  public:
+    /**
+     * @param depth number of sequence numbers remembered per source
+     */
+    explicit RangerMacDuplicateFilter(uint32_t depth = 50);
+
+    /**
+     * Set the number of sequence numbers remembered per source, and forget
+     * all of them.
+     *
+     * @param depth the depth, 1 to 256
+     */
+    void SetDepth(uint32_t depth);
+
+    /**
+     * Get the number of sequence numbers remembered per source.
+     *
+     * @return the depth
+     */
+    uint32_t GetDepth() const;
+
+    /**
+     * Check whether a frame was already received, and remember it if not.
+     *
+     * @param type the frame type
+     * @param srcAddr the source address
+     * @param seq the sequence number
+     * @return true if the frame is a duplicate
+     */
+    bool IsDuplicate(RangerMacHeader::RangerMacType type, Ipv4Address srcAddr, uint8_t seq);
+
+  private:
+    /**
+     * The last sequence numbers received from a (frame type, source address)
+     * pair.
+     */
+    struct Window
+    {
+        std::array<uint64_t, 4> seen{}; //!< Bit seq is set if seq is in the window
+        std::vector<uint8_t> ring;      //!< The window, in arrival order, up to the depth
+        uint32_t head = 0;              //!< Index of the oldest entry of ring, once full
+    };
+
+    /**
+     * The windows, keyed by the frame type and the source address.
+     */
+    std::unordered_map<uint64_t, Window> m_windows;
+
+    /**
+     * Number of sequence numbers remembered per source.
+     */
+    uint32_t m_depth;
+};
+
 class RangerMac : public Object
 {
 public:
@@ -201,6 +278,45 @@ public:
      */
     Ipv4Address GetAddress() const;
 
+    /**
+     * Get the number of frames the PHY indicated to this MAC.
+     *
+     * @return the number of frames received
+     */
+    uint64_t GetRxFrameCount() const;
+
+    /**
+     * Get the number of received frames passed to the upper layer.
+     *
+     * @return the number of frames delivered
+     */
+    uint64_t GetRxDeliveredCount() const;
+
+    /**
+     * Get the number of received frames dropped as duplicates.
+     *
+     * @return the number of duplicates
+     */
+    uint64_t GetRxDuplicateCount() const;
+
+    /**
+     * Get the number of packets copied to receive frames. The frames of a
+     * transmission are shared by all the receivers, and only copied by the
+     * PHYs that synchronize to them; the MAC itself does not copy them.
+     *
+     * @return the number of packet copies
+     */
+    uint64_t GetRxPacketCopies() const;
+
+    /**
+     * Assign a fixed random variable stream number to the random variables
+     * used by this model. Return the number of streams that have been assigned.
+     *
+     * @param stream first stream index to use
+     * @return the number of stream indices assigned by this model
+     */
+    int64_t AssignStreams(int64_t stream);
+
     ////////////////////////////////////
     // Interfaces between MAC and PHY //
     ////////////////////////////////////
@@ -327,9 +443,14 @@ private:
     TracedValue<ranger::MacState> m_macState;
 
     /**
-     * The packet which is currently being receive by the MAC layer.
+     * Number of frames indicated by the PHY.
      */
-    Ptr<Packet> m_rxPkt;
+    uint64_t m_rxFrameCnt;
+
+    /**
+     * Number of frames passed to the upper layer.
+     */
+    uint64_t m_rxDeliveredCnt;
 
     /**
      * The packet which is currently being sent by the MAC layer.
@@ -337,15 +458,28 @@ private:
     Ptr<Packet> m_txPkt;
 
     /**
-     * 记录最近收到的包
+     * 记录最近收到的包，过滤重复帧
      */
-    struct RxedPkt
-    {
-        RangerMacHeader::RangerMacType type;
-        Ipv4Address srcAddr;
-        uint8_t seq;
-    };
-    std::deque<RxedPkt> m_rxedPkts;
+    RangerMacDuplicateFilter m_duplicateFilter;
+
+    /**
+     * Number of duplicate frames dropped.
+     */
+    TracedValue<uint64_t> m_rxDuplicateCnt;
+
+    /**
+     * Set the depth of the duplicate frame filter, see DuplicateFilterDepth.
+     *
+     * @param depth the depth, 1 to 256
+     */
+    void SetDuplicateFilterDepth(uint32_t depth);
+
+    /**
+     * Get the depth of the duplicate frame filter.
+     *
+     * @return the depth
+     */
+    uint32_t GetDuplicateFilterDepth() const;
 
     /**
      * The number of already used retransmission for the currently transmitted
@@ -421,14 +555,115 @@ private:
     /**
      * CheckQueue()的定时器
     */
-    void CheckQueuePeriodically(double t);
+    void CheckQueuePeriodically();
+
+    /**
+     * 事件驱动模式下，在m_checkQueueInterval网格上不早于earliest的第一个时刻安排一次
+     * CheckQueue()。如果本组当前时刻的检查还没有执行，可以安排在当前时刻，否则从严格晚于
+     * 当前时刻的网格点开始，和周期模式下这次改变之后的第一次检查相同。
+     * 发送队列为空或MAC不处于空闲状态时不安排，等到入队或MAC回到IDLE时再触发。
+     *
+     * @param earliest the earliest time at which the check may run
+     */
+    void ScheduleCheckQueue(Time earliest);
+
+    /**
+     * If true, CheckQueue() runs only when there is work for it (enqueue, the
+     * MAC going back to IDLE, or a resend deadline), instead of every
+     * m_checkQueueInterval.
+     */
+    bool m_eventDrivenQueue;
+
+    /**
+     * Period of the transmit queue check.
+     */
+    Time m_checkQueueInterval;
+
+    /**
+     * Time of the first transmit queue check. Event driven checks are aligned
+     * to the same grid as the periodic ones.
+     */
+    Time m_checkQueueOrigin;
+
+    /**
+     * The event driven MACs which check their queues on the same grid. The
+     * group has a single timer; at each point of the grid it checks the
+     * queues of the MACs that are due, in the order the MACs were created.
+     * The checks thus run in the same order, among themselves and with the
+     * other events of that time, as the periodic ones.
+     *
+     * With MultithreadedSimulatorImpl the MACs of different nodes may be run
+     * by different threads, so that a group only holds the MACs of one node.
+     */
+    struct CheckQueueGroup : public SimpleRefCount<CheckQueueGroup>
+    {
+        Time interval;                          //!< the period of the timer
+        EventId timer;                          //!< the timer running the checks
+        std::map<uint64_t, RangerMac*> members; //!< the MACs of the group, by creation index
+        std::map<uint64_t, RangerMac*> waiting; //!< the MACs with a check scheduled
+    };
+
+    /**
+     * The groups of event driven MACs of a simulation, by check interval,
+     * origin and, with MultithreadedSimulatorImpl, context. Deleted by
+     * Simulator::Destroy(), see SimulationSingleton.
+     */
+    struct CheckQueueGroupRegistry
+    {
+        /** The groups. */
+        std::map<std::tuple<int64_t, int64_t, uint32_t>, Ptr<CheckQueueGroup>> groups;
+        /** Number of MACs created, to give each one its creation index. */
+        uint64_t macCount{0};
+#ifdef NS3_MULTITHREADED_ENABLE
+        /** The MACs of the nodes join their groups from several threads. */
+        std::mutex mutex;
+#endif
+    };
+
+    /**
+     * Creation index of this MAC.
+     */
+    uint64_t m_macIndex;
+
+    /**
+     * Time of the check scheduled in event driven mode, or Time::Max() if none.
+     */
+    Time m_checkQueueTime;
+
+    /**
+     * The group of this MAC in event driven mode, or nullptr.
+     */
+    Ptr<CheckQueueGroup> m_checkQueueGroup;
+
+    /**
+     * 加入事件驱动模式的检查组，停止自己的定时器。第一个加入的MAC启动本组的定时器。
+     */
+    void JoinCheckQueueGroup();
+
+    /**
+     * 离开检查组。最后一个成员离开后，本组的定时器不再重新安排。
+     */
+    void LeaveCheckQueueGroup();
+
+    /**
+     * 检查组的定时器：按创建顺序检查本组到期的MAC的发送队列。
+     *
+     * @param group the group
+     */
+    static void CheckQueueGroupDue(Ptr<CheckQueueGroup> group);
+
+    /**
+     * Scheduler event for the next transmit queue check.
+     */
+    EventId m_checkQueueEvent;
 
     /**
      * Send an acknowledgment packet for the given sequence number.
      *
+     * @param dstAddr the source address of the frame to acknowledge
      * @param seqNum the sequence number for the ACK
      */
-    void SendAck(uint8_t seqNum);
+    void SendAck(Ipv4Address dstAddr, uint8_t seqNum);
 
     ///////////////
     // Mac State //
@@ -25,6 +25,7 @@
 #include <ns3/abort.h>
 #include <ns3/boolean.h>
 #include <ns3/log.h>
+#include <ns3/lr-wpan-error-model.h>
 #include <ns3/node.h>
 #include <ns3/packet.h>
 #include <ns3/pointer.h>
@@ -335,6 +336,11 @@ void
 RangerNetDevice::DoInitialize()
 {
     NS_LOG_FUNCTION(this);
+    // RangerHelper gives all its PHYs one error model, the others get their own
+    if (!m_phy->GetErrorModel())
+    {
+        m_phy->SetErrorModel(CreateObject<LrWpanErrorModel>());
+    }
     m_phy->Initialize();
     m_routingProtocol->Initialize();
     m_mac->Initialize();
@@ -351,9 +357,6 @@ RangerNetDevice::CompleteConfig()
         return;
     }
     m_mac->SetPhy(m_phy);
-
-    Ptr<LrWpanErrorModel> model = CreateObject<LrWpanErrorModel>();
-    m_phy->SetErrorModel(model);
     m_phy->SetDevice(this);
     
     m_routingProtocol->SetMac(m_mac);
@@ -361,6 +364,18 @@ RangerNetDevice::CompleteConfig()
     m_configComplete = true;
 }
 
+int64_t
+RangerNetDevice::AssignStreams(int64_t stream)
+{
+    NS_LOG_FUNCTION(this << stream);
+    int64_t streamIndex = stream;
+    streamIndex += m_routingProtocol->AssignStreams(streamIndex);
+    streamIndex += m_mac->AssignStreams(streamIndex);
+    streamIndex += m_phy->AssignStreams(streamIndex);
+    NS_LOG_DEBUG("Number of assigned RV streams:  " << (streamIndex - stream));
+    return (streamIndex - stream);
+}
+
 Ptr<LrWpanPhy>
 RangerNetDevice::GetPhy() const
 {
@@ -376,6 +391,21 @@ RangerNetDevice::SetPhy(Ptr<LrWpanPhy> phy)
     CompleteConfig();
 }
 
+Ptr<RangerMac>
+RangerNetDevice::GetMac() const
+{
+    NS_LOG_FUNCTION(this);
+    return m_mac;
+}
+
+void
+RangerNetDevice::SetMac(Ptr<RangerMac> mac)
+{
+    NS_LOG_FUNCTION(this);
+    m_mac = mac;
+    CompleteConfig();
+}
+
 void
 RangerNetDevice::SetRoutingProtocol(Ptr<RangerRoutingProtocol> RoutingProtocol)
 {
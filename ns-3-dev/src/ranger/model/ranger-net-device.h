@@ -186,14 +186,14 @@ class RangerNetDevice : public NetDevice
     //  */
     // void McpsDataIndication(McpsDataIndicationParams params, Ptr<Packet> pkt);
 
-    // /**
-    //  * Assign a fixed random variable stream number to the random variables
-    //  * used by this model.  Return the number of streams that have been assigned.
-    //  *
-    //  * \param stream first stream index to use
-    //  * \return the number of stream indices assigned by this model
-    //  */
-    // int64_t AssignStreams(int64_t stream);
+    /**
+     * Assign a fixed random variable stream number to the random variables
+     * used by this model.  Return the number of streams that have been assigned.
+     *
+     * \param stream first stream index to use
+     * \return the number of stream indices assigned by this model
+     */
+    int64_t AssignStreams(int64_t stream);
 
   private:
     // Inherited from NetDevice/Object
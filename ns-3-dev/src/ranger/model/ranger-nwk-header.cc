@@ -22,9 +22,15 @@
 
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include "ns3/packet.h"
+
+#include <algorithm>
+#include <cstring>
 
 #define IPV4_ADDRESS_SIZE 4
-#define RANGER_MSG_HEADER_SIZE 6
+
+// 各消息先在栈上的缓冲区中编码，再一次写入Buffer；解析时也一次读出。
+// 缓冲区的大小为一帧能携带的最大消息，超出的表项不会被保存，见InlineList。
 
 namespace ns3
 {
@@ -62,7 +68,7 @@ MessageHeader::GetInstanceTypeId() const
 uint32_t
 MessageHeader::GetSerializedSize() const
 {
-    uint32_t size = RANGER_MSG_HEADER_SIZE;
+    uint32_t size = MESSAGE_HEADER_SIZE;
     switch (m_messageType)
     {
     case NODEINFO_MESSAGE:
@@ -119,9 +125,11 @@ void
 MessageHeader::Serialize(Buffer::Iterator start) const
 {
     Buffer::Iterator iter = start;
-    iter.WriteU8(m_messageType);
-    iter.WriteHtonU32(m_srcAddress.Get());
-    iter.WriteU8(m_messageLength);
+    uint8_t buf[MESSAGE_HEADER_SIZE];
+    buf[0] = m_messageType;
+    m_srcAddress.Serialize(buf + 1);
+    buf[5] = m_messageLength;
+    iter.Write(buf, MESSAGE_HEADER_SIZE);
 
     switch (m_messageType)
     {
@@ -144,23 +152,25 @@ MessageHeader::Deserialize(Buffer::Iterator start)
 {
     uint32_t size;
     Buffer::Iterator iter = start;
-    
-    m_messageType = (MessageType)iter.ReadU8();
-    m_srcAddress = Ipv4Address(iter.ReadNtohU32());
-    m_messageLength = iter.ReadU8();
-    size = RANGER_MSG_HEADER_SIZE;
+    uint8_t buf[MESSAGE_HEADER_SIZE];
+    iter.Read(buf, MESSAGE_HEADER_SIZE);
+
+    m_messageType = (MessageType)buf[0];
+    m_srcAddress = Ipv4Address::Deserialize(buf + 1);
+    m_messageLength = buf[5];
+    size = MESSAGE_HEADER_SIZE;
     NS_ASSERT(m_messageType == NODEINFO_MESSAGE || m_messageType == AUDIODATA_MESSAGE || m_messageType == MEMBERHEARTBEAT_MESSAGE);
 
     switch (m_messageType)
     {
     case NODEINFO_MESSAGE:
-        size += m_message.nodeInfo.Deserialize(iter, m_messageLength - RANGER_MSG_HEADER_SIZE);
+        size += m_message.nodeInfo.Deserialize(iter, m_messageLength - MESSAGE_HEADER_SIZE);
         break;
     case AUDIODATA_MESSAGE:
-        size += m_message.audioData.Deserialize(iter, m_messageLength - RANGER_MSG_HEADER_SIZE);
+        size += m_message.audioData.Deserialize(iter, m_messageLength - MESSAGE_HEADER_SIZE);
         break;
     case MEMBERHEARTBEAT_MESSAGE:
-        size += m_message.memberHeartbeat.Deserialize(iter, m_messageLength - RANGER_MSG_HEADER_SIZE);
+        size += m_message.memberHeartbeat.Deserialize(iter, m_messageLength - MESSAGE_HEADER_SIZE);
         break;
     default:
         NS_ASSERT(false);
@@ -193,15 +203,21 @@ void
 MessageHeader::NodeInfo::Serialize(Buffer::Iterator start) const
 {
     Buffer::Iterator iter = start;
+    uint8_t buf[1 + MAX_LINKS * (IPV4_ADDRESS_SIZE + 1)];
+    uint8_t* pos = buf;
 
-    iter.WriteU8(linkNumber); 
-    for (auto i = this->linkMessages.begin(); i != this->linkMessages.end(); i++)
+    *pos++ = linkNumber;
+    for (const auto& lm : linkMessages)
     {
-        const LinkMessage& lm = *i;
-
-        iter.WriteU8(lm.linkStatus);
-        iter.WriteHtonU32(lm.neighborAddresses.Get());
+        *pos++ = lm.linkStatus;
+        lm.neighborAddresses.Serialize(pos);
+        pos += IPV4_ADDRESS_SIZE;
     }
+    iter.Write(buf, pos - buf);
+    // the links beyond the capacity of linkMessages were dropped, zero their room
+    NS_ASSERT_MSG(linkNumber >= linkMessages.size(), "linkNumber smaller than the link list");
+    uint32_t dropped = linkNumber - linkMessages.size();
+    iter.WriteU8(0, dropped * (IPV4_ADDRESS_SIZE + 1));
 }
 
 uint32_t
@@ -215,14 +231,18 @@ MessageHeader::NodeInfo::Deserialize(Buffer::Iterator start, uint32_t messageSiz
 
     this->linkNumber = iter.ReadU8();
 
-    for(int i = 0; i < linkNumber; i++) {
+    uint8_t buf[MAX_LINKS * (IPV4_ADDRESS_SIZE + 1)];
+    uint32_t count = std::min<uint32_t>(linkNumber, MAX_LINKS);
+    iter.Read(buf, count * (IPV4_ADDRESS_SIZE + 1));
+    for (const uint8_t* pos = buf; pos < buf + count * (IPV4_ADDRESS_SIZE + 1);
+         pos += IPV4_ADDRESS_SIZE + 1)
+    {
         LinkMessage lm;
-        lm.linkStatus = iter.ReadU8();
-        lm.neighborAddresses = Ipv4Address(iter.ReadNtohU32());
+        lm.linkStatus = pos[0];
+        lm.neighborAddresses = Ipv4Address::Deserialize(pos + 1);
         this->linkMessages.push_back(lm);
     }
 
-
     return messageSize;
 }
 
@@ -251,15 +271,23 @@ void
 MessageHeader::AudioData::Serialize(Buffer::Iterator start) const
 {
     Buffer::Iterator iter = start;
-    iter.WriteHtonU32(OriAddr.Get());
-    iter.WriteU8(AudioSeq); 
-    iter.WriteU8(AudioSize); 
-    iter.WriteU8(AssignNum); 
-    for (auto i = this->AssignNeighbor.begin(); i != this->AssignNeighbor.end(); i++)
-    {   
-        Ipv4Address Address = *i;
-        iter.WriteHtonU32(Address.Get());
+    uint8_t buf[7 + MAX_ASSIGN * IPV4_ADDRESS_SIZE];
+    uint8_t* pos = buf;
+
+    OriAddr.Serialize(pos);
+    pos += IPV4_ADDRESS_SIZE;
+    *pos++ = AudioSeq;
+    *pos++ = AudioSize;
+    *pos++ = AssignNum;
+    for (const auto& address : AssignNeighbor)
+    {
+        address.Serialize(pos);
+        pos += IPV4_ADDRESS_SIZE;
     }
+    iter.Write(buf, pos - buf);
+    // the neighbors beyond the capacity of AssignNeighbor were dropped, zero their room
+    NS_ASSERT_MSG(AssignNum >= AssignNeighbor.size(), "AssignNum smaller than the neighbor list");
+    iter.WriteU8(0, (AssignNum - AssignNeighbor.size()) * IPV4_ADDRESS_SIZE);
 }
 
 uint32_t
@@ -271,13 +299,18 @@ MessageHeader::AudioData::Deserialize(Buffer::Iterator start, uint32_t messageSi
 
     this->AssignNeighbor.clear();
 
-    this->OriAddr = Ipv4Address(iter.ReadNtohU32());
-    this->AudioSeq = iter.ReadU8();
-    this->AudioSize = iter.ReadU8();
-    this->AssignNum = iter.ReadU8();
+    uint8_t buf[7 + MAX_ASSIGN * IPV4_ADDRESS_SIZE];
+    iter.Read(buf, 7);
+    this->OriAddr = Ipv4Address::Deserialize(buf);
+    this->AudioSeq = buf[4];
+    this->AudioSize = buf[5];
+    this->AssignNum = buf[6];
 
-    for(int i = 0; i < AssignNum; i++) {
-        this->AssignNeighbor.push_back(Ipv4Address(iter.ReadNtohU32()));
+    uint32_t count = std::min<uint32_t>(AssignNum, MAX_ASSIGN);
+    iter.Read(buf + 7, count * IPV4_ADDRESS_SIZE);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        this->AssignNeighbor.push_back(Ipv4Address::Deserialize(buf + 7 + i * IPV4_ADDRESS_SIZE));
     }
 
     return messageSize;
@@ -309,13 +342,21 @@ void
 MessageHeader::MemberHeartbeat::Serialize(Buffer::Iterator start) const
 {
     Buffer::Iterator iter = start;
-    iter.WriteHtonU32(mainAddr.Get());
-    iter.WriteU8(roadNum); 
-    for (auto i = this->roadAddr.begin(); i != this->roadAddr.end(); i++)
-    {   
-        Ipv4Address Address = *i;
-        iter.WriteHtonU32(Address.Get());
+    uint8_t buf[5 + MAX_ROAD * IPV4_ADDRESS_SIZE];
+    uint8_t* pos = buf;
+
+    mainAddr.Serialize(pos);
+    pos += IPV4_ADDRESS_SIZE;
+    *pos++ = roadNum;
+    for (const auto& address : roadAddr)
+    {
+        address.Serialize(pos);
+        pos += IPV4_ADDRESS_SIZE;
     }
+    iter.Write(buf, pos - buf);
+    // the nodes beyond the capacity of roadAddr were dropped, zero their room
+    NS_ASSERT_MSG(roadNum >= roadAddr.size(), "roadNum smaller than the road list");
+    iter.WriteU8(0, (roadNum - roadAddr.size()) * IPV4_ADDRESS_SIZE);
 }
 
 uint32_t
@@ -327,14 +368,90 @@ MessageHeader::MemberHeartbeat::Deserialize(Buffer::Iterator start, uint32_t mes
 
     this->roadAddr.clear();
 
-    this->mainAddr = Ipv4Address(iter.ReadNtohU32());
-    this->roadNum = iter.ReadU8();
+    uint8_t buf[5 + MAX_ROAD * IPV4_ADDRESS_SIZE];
+    iter.Read(buf, 5);
+    this->mainAddr = Ipv4Address::Deserialize(buf);
+    this->roadNum = buf[4];
 
-    for(int i = 0; i < roadNum; i++) {
-        this->roadAddr.push_back(Ipv4Address(iter.ReadNtohU32()));
+    uint32_t count = std::min<uint32_t>(roadNum, MAX_ROAD);
+    iter.Read(buf + 5, count * IPV4_ADDRESS_SIZE);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        this->roadAddr.push_back(Ipv4Address::Deserialize(buf + 5 + i * IPV4_ADDRESS_SIZE));
     }
 
     return messageSize;
 }
 
+// ---------------- MessageHeaderView -------------------------------
+
+MessageHeaderView::MessageHeaderView(Ptr<const Packet> p)
+{
+    m_size = p->CopyData(m_data, ranger::aMaxMessageSize);
+    if (m_size < ranger::aMaxMessageSize)
+    {
+        // a truncated header reads as zeros
+        std::memset(m_data + m_size, 0, ranger::aMaxMessageSize - m_size);
+    }
+}
+
+uint8_t
+MessageHeaderView::GetCount(uint32_t offset, uint32_t itemSize) const
+{
+    uint32_t count = m_data[offset - 1];
+    uint32_t available = m_size > offset ? (m_size - offset) / itemSize : 0;
+    return std::min(count, available);
+}
+
+uint8_t
+MessageHeaderView::GetLinkNumber() const
+{
+    NS_ASSERT(GetMessageType() == MessageHeader::NODEINFO_MESSAGE);
+    return GetCount(MessageHeader::MESSAGE_HEADER_SIZE + 1, IPV4_ADDRESS_SIZE + 1);
+}
+
+MessageHeader::NodeInfo::LinkMessage
+MessageHeaderView::GetLinkMessage(uint32_t i) const
+{
+    NS_ASSERT(i < GetLinkNumber());
+    uint32_t offset = MessageHeader::MESSAGE_HEADER_SIZE + 1 + i * (IPV4_ADDRESS_SIZE + 1);
+    MessageHeader::NodeInfo::LinkMessage lm;
+    lm.linkStatus = m_data[offset];
+    lm.neighborAddresses = ReadAddress(offset + 1);
+    return lm;
+}
+
+uint8_t
+MessageHeaderView::GetAssignNum() const
+{
+    NS_ASSERT(GetMessageType() == MessageHeader::AUDIODATA_MESSAGE);
+    return GetCount(MessageHeader::MESSAGE_HEADER_SIZE + 7, IPV4_ADDRESS_SIZE);
+}
+
+Ipv4Address
+MessageHeaderView::GetAssignNeighbor(uint32_t i) const
+{
+    NS_ASSERT(i < GetAssignNum());
+    return ReadAddress(MessageHeader::MESSAGE_HEADER_SIZE + 7 + i * IPV4_ADDRESS_SIZE);
+}
+
+void
+MessageHeaderView::Print(std::ostream& os) const
+{
+    // only used for logging: parse a copy of the header
+    Buffer buffer;
+    buffer.AddAtStart(m_size);
+    buffer.Begin().Write(m_data, m_size);
+    MessageHeader hdr;
+    hdr.Deserialize(buffer.Begin());
+    hdr.Print(os);
+}
+
+std::ostream&
+operator<<(std::ostream& os, const MessageHeaderView& view)
+{
+    view.Print(os);
+    return os;
+}
+
 } // namespace ns3
\ No newline at end of file
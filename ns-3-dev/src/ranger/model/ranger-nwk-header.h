@@ -22,23 +22,155 @@
 #define RANGER_NWK_HEADER_H
 
 
+#include "ranger-mac-constants.h"
+
+#include "ns3/assert.h"
 #include "ns3/header.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/nstime.h"
+#include "ns3/ptr.h"
 
 #include <stdint.h>
-#include <vector>
 
 namespace ns3
 {
 
+class Packet;
+
+namespace ranger
+{
+
+/**
+ * MessageHeader在一帧中的最大长度，即MAC层能接受的最大负载。
+ * The largest MessageHeader a frame can carry.
+ */
+constexpr uint32_t aMaxMessageSize{aMaxPhyPacketSize - aMPDUOverhead};
+
+/**
+ * A list of at most N items, stored in place.
+ *
+ * The lists of a MessageHeader use it instead of std::vector, so that building,
+ * copying and parsing a header allocate no memory. N is the number of items a
+ * frame can carry; items added to a full list are dropped.
+ */
+template <typename T, uint32_t N>
+class InlineList
+{
+  public:
+    InlineList()
+        : m_size(0)
+    {
+    }
+
+    /**
+     * \return the maximum number of items
+     */
+    static constexpr uint32_t capacity()
+    {
+        return N;
+    }
+
+    /**
+     * \return the number of items
+     */
+    uint32_t size() const
+    {
+        return m_size;
+    }
+
+    /**
+     * \return true if the list holds no item
+     */
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    /**
+     * Remove all the items.
+     */
+    void clear()
+    {
+        m_size = 0;
+    }
+
+    /**
+     * Append an item, unless the list is full.
+     * \param item the item
+     */
+    void push_back(const T& item)
+    {
+        if (m_size < N)
+        {
+            m_items[m_size++] = item;
+        }
+    }
+
+    /**
+     * \param i the index of an item
+     * \return the item
+     */
+    T& operator[](uint32_t i)
+    {
+        NS_ASSERT(i < m_size);
+        return m_items[i];
+    }
+
+    /**
+     * \param i the index of an item
+     * \return the item
+     */
+    const T& operator[](uint32_t i) const
+    {
+        NS_ASSERT(i < m_size);
+        return m_items[i];
+    }
+
+    /// \return an iterator to the first item
+    T* begin()
+    {
+        return m_items;
+    }
+
+    /// \return an iterator past the last item
+    T* end()
+    {
+        return m_items + m_size;
+    }
+
+    /// \return an iterator to the first item
+    const T* begin() const
+    {
+        return m_items;
+    }
+
+    /// \return an iterator past the last item
+    const T* end() const
+    {
+        return m_items + m_size;
+    }
+
+  private:
+    T m_items[N];    //!< The items
+    uint32_t m_size; //!< The number of items
+};
+
+} // namespace ranger
+
 
 /**
  * MessageHeader contain NodeInfo, AudioData
+ *
+ * The address lists are stored in place, with room for as many items as a
+ * frame can carry. The counts (linkNumber, AssignNum, roadNum) are those of
+ * the message and may be larger: the serialized size is computed from them,
+ * so that the MAC still refuses a message too long for a frame.
 */
 class MessageHeader : public Header
 {
   public:
+    /// Size of the common part of the messages
+    static constexpr uint32_t MESSAGE_HEADER_SIZE = 6;
     /**
      * Message type
      */
@@ -137,8 +269,11 @@ class MessageHeader : public Header
             uint8_t linkStatus; //!< Link code
             Ipv4Address neighborAddresses; //!< Neighbor interface address container.
         };
+        /// Number of link messages a frame can carry
+        static constexpr uint32_t MAX_LINKS = (ranger::aMaxMessageSize - MESSAGE_HEADER_SIZE - 1) / 5;
+
         uint8_t linkNumber; //!< Link messages container.
-        std::vector<LinkMessage> linkMessages; //!< Link messages container.
+        ranger::InlineList<LinkMessage, MAX_LINKS> linkMessages; //!< Link messages container.
 
         /**
          * This method is used to print the content of a Hello message.
@@ -182,8 +317,11 @@ class MessageHeader : public Header
         Ipv4Address OriAddr;
         uint8_t AudioSeq;
         uint8_t AudioSize;
+        /// Number of assign nodes a frame can carry
+        static constexpr uint32_t MAX_ASSIGN = (ranger::aMaxMessageSize - MESSAGE_HEADER_SIZE - 7) / 4;
+
         uint8_t AssignNum; //!< Assign node messages container.
-        std::vector<Ipv4Address> AssignNeighbor; //!< Assign node messages container.
+        ranger::InlineList<Ipv4Address, MAX_ASSIGN> AssignNeighbor; //!< Assign node messages container.
 
         /**
          * This method is used to print the content of a Hello message.
@@ -229,8 +367,11 @@ class MessageHeader : public Header
          * item
          */
         Ipv4Address mainAddr;
+        /// Number of road nodes a frame can carry
+        static constexpr uint32_t MAX_ROAD = (ranger::aMaxMessageSize - MESSAGE_HEADER_SIZE - 5) / 4;
+
         uint8_t roadNum; //!< road node messages container.
-        std::vector<Ipv4Address> roadAddr; //!< road node messages container.
+        ranger::InlineList<Ipv4Address, MAX_ROAD> roadAddr; //!< road node messages container.
 
         /**
          * This method is used to print the content of a Hello message.
@@ -358,6 +499,134 @@ class MessageHeader : public Header
 
 };
 
+/**
+ * Read-only access to the MessageHeader at the start of a packet.
+ *
+ * The bytes of the header (at most a frame) are copied once from the packet,
+ * and the fields and the lists are decoded from them when they are read,
+ * instead of being deserialized to a MessageHeader. The receive path uses it
+ * for the messages it does not forward.
+ */
+class MessageHeaderView
+{
+  public:
+    /**
+     * Create a view of the header at the start of a packet.
+     * \param p the packet
+     */
+    explicit MessageHeaderView(Ptr<const Packet> p);
+
+    /**
+     * \return the message type
+     */
+    MessageHeader::MessageType GetMessageType() const
+    {
+        return MessageHeader::MessageType(m_data[0]);
+    }
+
+    /**
+     * \return the srcAddress
+     */
+    Ipv4Address GetSrcAddress() const
+    {
+        return ReadAddress(1);
+    }
+
+    /**
+     * \return the message length
+     */
+    uint8_t GetMessageLength() const
+    {
+        return m_data[5];
+    }
+
+    /**
+     * \return the number of link messages of a NodeInfo message
+     */
+    uint8_t GetLinkNumber() const;
+
+    /**
+     * \param i the index of a link message
+     * \return the link message
+     */
+    MessageHeader::NodeInfo::LinkMessage GetLinkMessage(uint32_t i) const;
+
+    /**
+     * \return the origin of an AudioData message
+     */
+    Ipv4Address GetOriAddr() const
+    {
+        return ReadAddress(MessageHeader::MESSAGE_HEADER_SIZE);
+    }
+
+    /**
+     * \return the sequence number of an AudioData message
+     */
+    uint8_t GetAudioSeq() const
+    {
+        return m_data[MessageHeader::MESSAGE_HEADER_SIZE + 4];
+    }
+
+    /**
+     * \return the audio size of an AudioData message
+     */
+    uint8_t GetAudioSize() const
+    {
+        return m_data[MessageHeader::MESSAGE_HEADER_SIZE + 5];
+    }
+
+    /**
+     * \return the number of assign nodes of an AudioData message
+     */
+    uint8_t GetAssignNum() const;
+
+    /**
+     * \param i the index of an assign node
+     * \return the assign node
+     */
+    Ipv4Address GetAssignNeighbor(uint32_t i) const;
+
+    /**
+     * \return the main address of a MemberHeartbeat message
+     */
+    Ipv4Address GetMainAddr() const
+    {
+        return ReadAddress(MessageHeader::MESSAGE_HEADER_SIZE);
+    }
+
+    /**
+     * Print the header like MessageHeader::Print does.
+     * \param os output stream
+     */
+    void Print(std::ostream& os) const;
+
+  private:
+    /**
+     * \param offset the offset of an address in the header
+     * \return the address
+     */
+    Ipv4Address ReadAddress(uint32_t offset) const
+    {
+        return Ipv4Address::Deserialize(m_data + offset);
+    }
+
+    /**
+     * \param offset the offset of the first item of a list
+     * \param itemSize the size of an item
+     * \return the number of items of the list which are in the view
+     */
+    uint8_t GetCount(uint32_t offset, uint32_t itemSize) const;
+
+    uint8_t m_data[ranger::aMaxMessageSize]; //!< The bytes of the header
+    uint32_t m_size;                         //!< The number of valid bytes
+};
+
+/**
+ * \param os output stream
+ * \param view the view
+ * \return the output stream
+ */
+std::ostream& operator<<(std::ostream& os, const MessageHeaderView& view);
 
 } // namespace ns3
 
@@ -22,77 +22,193 @@
 #include <ns3/log.h>
 #include <ns3/simulator.h>
 
+#include <algorithm>
+
 namespace ns3
 {
 
-#define CONTINUE_SCORE (2.0)
-#define NO_CONTINUE_SCORE (1.0)
 #define UINT8_T_LIMIT (255)
-uint8_t
-NodeInfoReceiveRateBuffer::calLqi() const
+
+namespace
 {
-    uint8_t total_weight = 0;
-    uint8_t lqi_cal = 0;
 
-    for (int j = 0; j < capacity; j++) {
-        int index = head - 1 - j;
-        if (index < 0) {
-            index += capacity;
-        }
+/**
+ * The links of a NodeInfo, decoded from a MessageHeaderView when read.
+ */
+class ViewLinks
+{
+  public:
+    explicit ViewLinks(const MessageHeaderView& view)
+        : m_view(view),
+          m_size(view.GetLinkNumber())
+    {
+    }
 
-        if (j == capacity - 1) {
-            if (buffer[index] == false) {
-                lqi_cal += NO_CONTINUE_SCORE;
-            }
-            total_weight += NO_CONTINUE_SCORE;
-        } else {
-            if (buffer[index] == false) {
-                int prev_index = index - 1;
-                if (prev_index < 0) {
-                    prev_index += capacity;
-                }
-                if (buffer[prev_index] == false) {
-                    lqi_cal += CONTINUE_SCORE;
-                    total_weight += CONTINUE_SCORE;
-                } else {
-                    lqi_cal += NO_CONTINUE_SCORE;
-                    total_weight += NO_CONTINUE_SCORE;
-                }
-            } else {
-                total_weight += NO_CONTINUE_SCORE;
-            }
-        }
+    std::size_t size() const {
+        return m_size;
+    }
+    MessageHeader::NodeInfo::LinkMessage operator[](std::size_t i) const {
+        return m_view.GetLinkMessage(i);
     }
 
-    return (uint8_t)((1.0 - ((float)lqi_cal / (float)total_weight)) * (float)UINT8_T_LIMIT);
-}
+  private:
+    const MessageHeaderView& m_view;
+    std::size_t m_size;
+};
+
+} // namespace
 
 RangerNeighborList::RangerNeighborList(Time refreshInterval, Time onlineMemberRefreshInterval)
 {
     m_refreshInterval = refreshInterval;
     m_onlineMemberRefreshInterval = onlineMemberRefreshInterval;
     m_nbStatus.clear();
+    m_twoHopGarbage = 0;
+    m_epoch = 0;
+    m_version = 1;
+    m_assignCacheVersion = 0;
+    m_assignCacheHits = 0;
+    m_assignCacheMisses = 0;
+    m_oneHopListVersion = 0;
 }
 RangerNeighborList::~RangerNeighborList()
 {
 
 }
 
+uint32_t
+RangerNeighborList::GetAddressId(Ipv4Address addr)
+{
+    auto result = m_addrIds.emplace(addr, m_addrIds.size());
+    if (result.second) {
+        m_addrMark.push_back(0);
+        m_targetMark.push_back(0);
+        m_targetPos.push_back(0);
+    }
+    return result.first->second;
+}
+
+uint32_t
+RangerNeighborList::NextEpoch() const
+{
+    if (++m_epoch == 0) {
+        // wrapped around: clear the marks of all the previous rounds
+        std::fill(m_addrMark.begin(), m_addrMark.end(), 0);
+        std::fill(m_targetMark.begin(), m_targetMark.end(), 0);
+        std::fill(m_assignMark.begin(), m_assignMark.end(), 0);
+        m_epoch = 1;
+    }
+    return m_epoch;
+}
+
+template <typename Links>
+bool
+RangerNeighborList::SetTwoHopLinks(NeighborStatus& nb, const Links& links)
+{
+    if (links.size() == nb.twoHopCount) {
+        bool same = true;
+        for (std::size_t i = 0; same && i < links.size(); i++) {
+            MessageHeader::NodeInfo::LinkMessage a = links[i];
+            const MessageHeader::NodeInfo::LinkMessage& b = m_twoHopLinks[nb.twoHopOffset + i];
+            same = a.neighborAddresses == b.neighborAddresses && a.linkStatus == b.linkStatus;
+        }
+        if (same) {
+            return false;
+        }
+    }
+    if (links.size() > nb.twoHopCapacity) {
+        // does not fit in place, move the neighbor to the end of the arena
+        m_twoHopGarbage += nb.twoHopCapacity;
+        nb.twoHopOffset = m_twoHopLinks.size();
+        nb.twoHopCapacity = links.size();
+        m_twoHopLinks.resize(m_twoHopLinks.size() + links.size());
+        m_twoHopIds.resize(m_twoHopLinks.size());
+    }
+    nb.twoHopCount = links.size();
+    for (std::size_t i = 0; i < links.size(); i++) {
+        MessageHeader::NodeInfo::LinkMessage& link = m_twoHopLinks[nb.twoHopOffset + i];
+        link = links[i];
+        m_twoHopIds[nb.twoHopOffset + i] = GetAddressId(link.neighborAddresses);
+    }
+    if (m_twoHopGarbage > m_twoHopLinks.size() / 2) {
+        CompactTwoHopLinks();
+    }
+    return true;
+}
+
+void
+RangerNeighborList::CompactTwoHopLinks()
+{
+    std::vector<MessageHeader::NodeInfo::LinkMessage> links;
+    std::vector<uint32_t> ids;
+    links.reserve(m_twoHopLinks.size() - m_twoHopGarbage);
+    ids.reserve(m_twoHopLinks.size() - m_twoHopGarbage);
+    for (auto& nb : m_nbStatus) {
+        links.insert(links.end(),
+                     m_twoHopLinks.begin() + nb.twoHopOffset,
+                     m_twoHopLinks.begin() + nb.twoHopOffset + nb.twoHopCount);
+        ids.insert(ids.end(),
+                   m_twoHopIds.begin() + nb.twoHopOffset,
+                   m_twoHopIds.begin() + nb.twoHopOffset + nb.twoHopCount);
+        nb.twoHopOffset = links.size() - nb.twoHopCount;
+        nb.twoHopCapacity = nb.twoHopCount;
+    }
+    m_twoHopLinks.swap(links);
+    m_twoHopIds.swap(ids);
+    m_twoHopGarbage = 0;
+}
+
+void
+RangerNeighborList::RebuildNeighborIndex()
+{
+    m_nbIndex.clear();
+    for (std::size_t i = 0; i < m_nbStatus.size(); i++) {
+        m_nbIndex[m_nbStatus[i].neighborMainAddr] = i;
+    }
+}
+
+void
+RangerNeighborList::RebuildOnlineMemberIndex()
+{
+    m_onlineMemberIndex.clear();
+    for (std::size_t i = 0; i < m_onlineMemberStatus.size(); i++) {
+        m_onlineMemberIndex[m_onlineMemberStatus[i].memberMainAddr] = i;
+    }
+}
+
+void
+RangerNeighborList::UpdateNeighborNodeStatus(Ipv4Address SrcAddress, const MessageHeader::NodeInfo& nodeinfoHdr)
+{
+    UpdateNeighbor(SrcAddress, nodeinfoHdr.linkMessages);
+}
+
 void
-RangerNeighborList::UpdateNeighborNodeStatus(Ipv4Address SrcAddress, MessageHeader::NodeInfo nodeinfoHdr)
+RangerNeighborList::UpdateNeighborNodeStatus(Ipv4Address SrcAddress, const MessageHeaderView& view)
 {
-    uint8_t index = 0;
+    UpdateNeighbor(SrcAddress, ViewLinks(view));
+}
+
+template <typename Links>
+void
+RangerNeighborList::UpdateNeighbor(Ipv4Address SrcAddress, const Links& links)
+{
+    uint32_t index = 0;
     if(FindNeighbor(SrcAddress, index)) {
         m_nbStatus[index].refreshTime = Simulator::Now();
-        m_nbStatus[index].twoHopNodeInfo = nodeinfoHdr.linkMessages;
+        if(SetTwoHopLinks(m_nbStatus[index], links)) {
+            m_version++;
+        }
     } else {
         NeighborStatus nbIns = NeighborStatus();
         nbIns.neighborMainAddr = SrcAddress;
         nbIns.status = NeighborStatus::STATUS_NONE;
         nbIns.lqi = 255;
         nbIns.refreshTime = Simulator::Now();
-        nbIns.twoHopNodeInfo = nodeinfoHdr.linkMessages;
+        nbIns.addrId = GetAddressId(SrcAddress);
+        m_nbIndex[SrcAddress] = m_nbStatus.size();
         m_nbStatus.push_back(nbIns);
+        SetTwoHopLinks(m_nbStatus.back(), links);
+        m_version++;
     }
 
 }
@@ -101,40 +217,58 @@ void
 RangerNeighborList::RefreshNeighborNodeStatus(void)
 {
     Time CurrTime = Simulator::Now();
-    for(auto iter = m_nbStatus.begin(); iter != m_nbStatus.end();) {
-        if(CurrTime - iter->refreshTime > m_refreshInterval) {
-            iter->lqiBuffer.insert(false);
+    std::size_t kept = 0;
+    for(std::size_t i = 0; i < m_nbStatus.size(); i++) {
+        NeighborStatus& nb = m_nbStatus[i];
+        if(CurrTime - nb.refreshTime > m_refreshInterval) {
+            nb.lqiBuffer.insert(false);
         } else {
-            iter->lqiBuffer.insert(true);
+            nb.lqiBuffer.insert(true);
         }
-        iter->lqi = iter->lqiBuffer.calLqi();
+        nb.lqi = nb.lqiBuffer.calLqi();
 
         // update status
-        if(iter->lqi > 170) {
-            iter->status = NeighborStatus::STATUS_STABLE;
-            iter++;
-        } else if(iter->lqi > 75) {
-            iter->status = NeighborStatus::STATUS_UNSTABLE;
-            iter++;
-        } else if (iter->lqi > 0) {
-            iter->status = NeighborStatus::STATUS_NONE;
-            iter++;
+        NeighborStatus::Status status = nb.status;
+        if(nb.lqi > 170) {
+            nb.status = NeighborStatus::STATUS_STABLE;
+        } else if(nb.lqi > 75) {
+            nb.status = NeighborStatus::STATUS_UNSTABLE;
+        } else if (nb.lqi > 0) {
+            nb.status = NeighborStatus::STATUS_NONE;
         } else {
-            iter = m_nbStatus.erase(iter);
+            m_twoHopGarbage += nb.twoHopCapacity;
+            continue;
+        }
+        if(nb.status != status) {
+            m_version++;
+        }
+        // keep the order of the remaining neighbors
+        if (kept != i) {
+            m_nbStatus[kept] = std::move(nb);
+        }
+        kept++;
+    }
+    if (kept != m_nbStatus.size()) {
+        m_nbStatus.erase(m_nbStatus.begin() + kept, m_nbStatus.end());
+        m_version++;
+        RebuildNeighborIndex();
+        if (m_twoHopGarbage > m_twoHopLinks.size() / 2) {
+            CompactTwoHopLinks();
         }
     }
 }
 
 void
-RangerNeighborList::UpdateOnlineMemberStatus(MessageHeader::MemberHeartbeat memberHeartbeatHdr)
+RangerNeighborList::UpdateOnlineMemberStatus(const MessageHeader::MemberHeartbeat& memberHeartbeatHdr)
 {
-    uint8_t index = 0;
+    uint32_t index = 0;
     if(FindOnlineMember(memberHeartbeatHdr.mainAddr, index)) {
         m_onlineMemberStatus[index].refreshTime = Simulator::Now();
     } else {
         OnlineMemberStatus memberIns = OnlineMemberStatus();
         memberIns.memberMainAddr = memberHeartbeatHdr.mainAddr;
         memberIns.refreshTime = Simulator::Now();
+        m_onlineMemberIndex[memberIns.memberMainAddr] = m_onlineMemberStatus.size();
         m_onlineMemberStatus.push_back(memberIns);
     }
 }
@@ -143,19 +277,20 @@ void
 RangerNeighborList::RefreshOnlineMemberStatus(void)
 {
     Time CurrTime = Simulator::Now();
-    for(auto iter = m_onlineMemberStatus.begin(); iter != m_onlineMemberStatus.end();) {
-        if(CurrTime - iter->refreshTime > m_onlineMemberRefreshInterval * 6) {
-            iter = m_onlineMemberStatus.erase(iter);
-        } else {
-            iter++;
-        }
+    auto last = std::remove_if(m_onlineMemberStatus.begin(), m_onlineMemberStatus.end(),
+                               [&](const OnlineMemberStatus& member) {
+                                   return CurrTime - member.refreshTime > m_onlineMemberRefreshInterval * 6;
+                               });
+    if (last != m_onlineMemberStatus.end()) {
+        m_onlineMemberStatus.erase(last, m_onlineMemberStatus.end());
+        RebuildOnlineMemberIndex();
     }
 }
 
 bool
-RangerNeighborList::isMemberHeartbeatNew(MessageHeader::MemberHeartbeat memberHeartbeatHdr)
+RangerNeighborList::isMemberHeartbeatNew(const MessageHeader::MemberHeartbeat& memberHeartbeatHdr)
 {
-    uint8_t index = 0;
+    uint32_t index = 0;
     if(FindOnlineMember(memberHeartbeatHdr.mainAddr, index)) {
         Time CurrTime = Simulator::Now();
         if(CurrTime - m_onlineMemberStatus[index].refreshTime > m_onlineMemberRefreshInterval) {
@@ -169,30 +304,25 @@ RangerNeighborList::isMemberHeartbeatNew(MessageHeader::MemberHeartbeat memberHe
 }
 
 bool
-RangerNeighborList::FindNeighbor(Ipv4Address TargetAddr, uint8_t& index)
+RangerNeighborList::FindNeighbor(Ipv4Address TargetAddr, uint32_t& index) const
 {
-    for(std::size_t i = 0; i < m_nbStatus.size(); i++) {
-        if (m_nbStatus[i].neighborMainAddr == TargetAddr)
-        {
-            index = i;
-            return true;
-        }
+    auto it = m_nbIndex.find(TargetAddr);
+    if (it == m_nbIndex.end()) {
+        return false;
     }
-
-    return false;
+    index = it->second;
+    return true;
 }
 
 bool
-RangerNeighborList::FindOnlineMember(Ipv4Address TargetAddr, uint8_t& index)
+RangerNeighborList::FindOnlineMember(Ipv4Address TargetAddr, uint32_t& index) const
 {
-    for(std::size_t i = 0; i < m_onlineMemberStatus.size(); i++) {
-        if (m_onlineMemberStatus[i].memberMainAddr == TargetAddr) {
-            index = i;
-            return true;
-        }
+    auto it = m_onlineMemberIndex.find(TargetAddr);
+    if (it == m_onlineMemberIndex.end()) {
+        return false;
     }
-
-    return false;
+    index = it->second;
+    return true;
 }
 
 RangerNeighborList::twoHopLinkJudge
@@ -212,197 +342,187 @@ RangerNeighborList::JudgeTwoHopLinkStatus(NeighborStatus::Status oneHopStatus, N
 
 void
 RangerNeighborList::GetNeighborNodeInfo(MessageHeader::NodeInfo& header) {
+    // linkNumber counts all the links, even those beyond the room of the
+    // header, so that a NodeInfo too long for a frame is still refused
+    uint32_t linkNumber = 0;
     for(std::size_t i = 0; i < m_nbStatus.size(); i++) {
         if(m_nbStatus[i].status == NeighborStatus::STATUS_NONE) {
             continue;
         }
+        // linkNumber is a single byte on the wire
+        if(linkNumber == UINT8_T_LIMIT) {
+            break;
+        }
         MessageHeader::NodeInfo::LinkMessage linkMsg;
         linkMsg.neighborAddresses = m_nbStatus[i].neighborMainAddr;
         linkMsg.linkStatus = m_nbStatus[i].status;
         header.linkMessages.push_back(linkMsg);
+        linkNumber++;
     }
-    header.linkNumber = header.linkMessages.size();
+    header.linkNumber = linkNumber;
 }
 
 void
 RangerNeighborList::GetForwardAssignNeighbor(Ipv4Address SrcAddress, MessageHeader::AudioData& header) {
-    std::unordered_set<Ipv4Address> hiddenNode;
-    std::unordered_map<Ipv4Address, std::vector<reachableMapElement>> reachableMap;
-    std::unordered_set<Ipv4Address> assignNeighborSet;
+    uint32_t srcIndex = 0;
+    if(FindNeighbor(SrcAddress, srcIndex)) {
+        GetCachedAssignNeighbor(&m_nbStatus[srcIndex], header);
+    } else {
+        GetCachedAssignNeighbor(nullptr, header);
+    }
+}
+
+void
+RangerNeighborList::GetSourceAssignNeighbor(MessageHeader::AudioData& header) {
+    GetCachedAssignNeighbor(nullptr, header);
+}
+
+void
+RangerNeighborList::GetCachedAssignNeighbor(const NeighborStatus* src, MessageHeader::AudioData& header) {
+    if(m_assignCacheVersion != m_version) {
+        m_assignCache.clear();
+        m_assignCacheVersion = m_version;
+    }
+    // an unknown previous hop hides no more nodes than a source packet
+    auto result = m_assignCache.emplace(src ? src->neighborMainAddr : m_mainAddr, std::vector<Ipv4Address>());
+    std::vector<Ipv4Address>& assignNeighbor = result.first->second;
+    if(result.second) {
+        m_assignCacheMisses++;
+        SelectAssignNeighbor(src, assignNeighbor);
+    } else {
+        m_assignCacheHits++;
+    }
+    header.AssignNum = assignNeighbor.size();
+    for(const auto& addr : assignNeighbor) {
+        header.AssignNeighbor.push_back(addr);
+    }
+}
+
+void
+RangerNeighborList::SelectAssignNeighbor(const NeighborStatus* src, std::vector<Ipv4Address>& assignNeighbor) {
+    uint32_t epoch = NextEpoch();
     // get all the STABLEorUNSTABLE one hop neighbor, mark as hiddenNode.
     // It means there is no need to forward the audio data to them.
-    hiddenNode.insert(m_mainAddr);
+    // For a forward packet, the prev node and all its neighbors are hidden too.
+    m_addrMark[GetAddressId(m_mainAddr)] = epoch;
     for(auto iter = m_nbStatus.begin(); iter != m_nbStatus.end(); iter++) {
-        if(iter->neighborMainAddr == SrcAddress) {
-            hiddenNode.insert(iter->neighborMainAddr);
-            for(auto secondIter = iter->twoHopNodeInfo.begin(); secondIter != iter->twoHopNodeInfo.end(); secondIter++) {
-                hiddenNode.insert(secondIter->neighborAddresses);
+        if(&*iter == src) {
+            m_addrMark[iter->addrId] = epoch;
+            for(uint32_t k = 0; k < iter->twoHopCount; k++) {
+                m_addrMark[m_twoHopIds[iter->twoHopOffset + k]] = epoch;
             }
         } else if(iter->status == NeighborStatus::STATUS_STABLE || iter->status == NeighborStatus::STATUS_UNSTABLE) {
-            hiddenNode.insert(iter->neighborMainAddr);
+            m_addrMark[iter->addrId] = epoch;
         }
     }
-    // find all the node that can be reached from the source node.
-    // if find target, fill it into the reachableMap.
+
+    // find all the node that can be reached from the source node, in the order
+    // they are first met. Count the paths to each target first, then fill them.
+    m_targets.clear();
     for(auto oneHopIter = m_nbStatus.begin(); oneHopIter != m_nbStatus.end(); oneHopIter++) {
-        for(auto twoHopIter = oneHopIter->twoHopNodeInfo.begin(); twoHopIter != oneHopIter->twoHopNodeInfo.end(); twoHopIter++) {
-            if(hiddenNode.find(twoHopIter->neighborAddresses) == hiddenNode.end()) {
-                if(reachableMap.find(twoHopIter->neighborAddresses) != reachableMap.end()) {
-                    reachableMapElement tmpElem;
-                    tmpElem.oneHopAddr = oneHopIter->neighborMainAddr;
-                    tmpElem.linkStatus = JudgeTwoHopLinkStatus(oneHopIter->status, (NeighborStatus::Status)twoHopIter->linkStatus);
-                    reachableMap[twoHopIter->neighborAddresses].push_back(tmpElem);
-                } else {
-                    reachableMapElement tmpElem;
-                    tmpElem.oneHopAddr = oneHopIter->neighborMainAddr;
-                    tmpElem.linkStatus = JudgeTwoHopLinkStatus(oneHopIter->status, (NeighborStatus::Status)twoHopIter->linkStatus);
-                    std::vector<reachableMapElement> tmpVec;
-                    tmpVec.push_back(tmpElem);
-                    reachableMap.insert(std::make_pair(twoHopIter->neighborAddresses, tmpVec));
-                }
+        for(uint32_t k = 0; k < oneHopIter->twoHopCount; k++) {
+            uint32_t id = m_twoHopIds[oneHopIter->twoHopOffset + k];
+            if(m_addrMark[id] == epoch) {
+                continue;
             }
+            if(m_targetMark[id] != epoch) {
+                m_targetMark[id] = epoch;
+                m_targetPos[id] = m_targets.size();
+                m_targets.push_back({0, 0});
+            }
+            m_targets[m_targetPos[id]].pathCount++;
         }
     }
-    // for(auto mapiter = reachableMap.begin(); mapiter != reachableMap.end(); mapiter++) {
-    //     std::cout << "targetAddr:" << mapiter->first;
-    //     for(auto veciter = mapiter->second.begin(); veciter != mapiter->second.end(); veciter++) {
-    //         std::cout << " [" << veciter->oneHopAddr << "]-" << (uint16_t)veciter->linkStatus;
-    //     }
-    //     std::cout << std::endl;
-    // }
-
-    // find all the target node that can be reached from one way, make that onehop node as the assign forward node;
-
-    for(auto mapiter = reachableMap.begin(); mapiter != reachableMap.end(); mapiter++) {
-        if(mapiter->second.size() == 1) {
-            assignNeighborSet.insert(mapiter->second[0].oneHopAddr);
-        }
+    uint32_t pathTotal = 0;
+    for(auto& target : m_targets) {
+        target.pathBegin = pathTotal;
+        pathTotal += target.pathCount;
+        target.pathCount = 0;
     }
-    // // If there is more than one path to reach a target node, first check whether any of the arriving nodes are already in the assigned node SET
-    // // If there is, do not further evaluate; if there isn't, then compare among the multiple paths.
-
-    // todo: 最终的选择并不完备，对于所有有2个选择以上的target，其中间仍然可能存在相同的，在这没有处理，只是按顺序查找。
-    for(auto mapiter = reachableMap.begin(); mapiter != reachableMap.end(); mapiter++) {
-        if(mapiter->second.size() > 1) {
-            bool found = false;
-            for(auto veciter = mapiter->second.begin(); veciter != mapiter->second.end(); veciter++) {
-                if(assignNeighborSet.find(veciter->oneHopAddr) != assignNeighborSet.end()) {
-                    found = true;
-                    break;
-                }
-            }
-            if(!found) {
-                Ipv4Address winAddr = Ipv4Address("255.255.255.255");
-                twoHopLinkJudge winLink = TWOHOP_LINK_INVALID;
-                for(auto veciter = mapiter->second.begin(); veciter != mapiter->second.end(); veciter++) {
-                    if (veciter->linkStatus < winLink)
-                    {
-                        winLink = veciter->linkStatus;
-                        winAddr = veciter->oneHopAddr;
-                    }
-                }
-                assignNeighborSet.insert(winAddr);
+    m_paths.resize(pathTotal);
+    for(std::size_t i = 0; i < m_nbStatus.size(); i++) {
+        const NeighborStatus& oneHop = m_nbStatus[i];
+        for(uint32_t k = 0; k < oneHop.twoHopCount; k++) {
+            uint32_t id = m_twoHopIds[oneHop.twoHopOffset + k];
+            if(m_addrMark[id] == epoch) {
+                continue;
             }
+            ReachableTarget& target = m_targets[m_targetPos[id]];
+            ReachablePath& path = m_paths[target.pathBegin + target.pathCount++];
+            path.oneHopIndex = i;
+            path.linkStatus = JudgeTwoHopLinkStatus(oneHop.status, (NeighborStatus::Status)m_twoHopLinks[oneHop.twoHopOffset + k].linkStatus);
         }
     }
 
-    header.AssignNum = 0;
-    for(auto setIter = assignNeighborSet.begin(); setIter != assignNeighborSet.end(); setIter++) {
-        header.AssignNeighbor.push_back(*setIter);
-        header.AssignNum++;
+    assignNeighbor.clear();
+    if(m_assignMark.size() < m_nbStatus.size()) {
+        m_assignMark.resize(m_nbStatus.size(), 0);
     }
-}
-
-void
-RangerNeighborList::GetSourceAssignNeighbor(MessageHeader::AudioData& header) {
-    std::unordered_set<Ipv4Address> hiddenNode;
-    std::unordered_map<Ipv4Address, std::vector<reachableMapElement>> reachableMap;
-    std::unordered_set<Ipv4Address> assignNeighborSet;
-    // get all the STABLEorUNSTABLE one hop neighbor, mark as hiddenNode.
-    // It means there is no need to forward the audio data to them.
-    hiddenNode.insert(m_mainAddr);
-    for(auto iter = m_nbStatus.begin(); iter != m_nbStatus.end(); iter++) {
-        if(iter->status == NeighborStatus::STATUS_STABLE || iter->status == NeighborStatus::STATUS_UNSTABLE) {
-            hiddenNode.insert(iter->neighborMainAddr);
-        }
-    }
-    // find all the node that can be reached from the source node.
-    // if find target, fill it into the reachableMap.
-    for(auto oneHopIter = m_nbStatus.begin(); oneHopIter != m_nbStatus.end(); oneHopIter++) {
-        for(auto twoHopIter = oneHopIter->twoHopNodeInfo.begin(); twoHopIter != oneHopIter->twoHopNodeInfo.end(); twoHopIter++) {
-            if(hiddenNode.find(twoHopIter->neighborAddresses) == hiddenNode.end()) {
-                if(reachableMap.find(twoHopIter->neighborAddresses) != reachableMap.end()) {
-                    reachableMapElement tmpElem;
-                    tmpElem.oneHopAddr = oneHopIter->neighborMainAddr;
-                    tmpElem.linkStatus = JudgeTwoHopLinkStatus(oneHopIter->status, (NeighborStatus::Status)twoHopIter->linkStatus);
-                    reachableMap[twoHopIter->neighborAddresses].push_back(tmpElem);
-                } else {
-                    reachableMapElement tmpElem;
-                    tmpElem.oneHopAddr = oneHopIter->neighborMainAddr;
-                    tmpElem.linkStatus = JudgeTwoHopLinkStatus(oneHopIter->status, (NeighborStatus::Status)twoHopIter->linkStatus);
-                    std::vector<reachableMapElement> tmpVec;
-                    tmpVec.push_back(tmpElem);
-                    reachableMap.insert(std::make_pair(twoHopIter->neighborAddresses, tmpVec));
-                }
-            }
+    bool assignBroadcast = false;
+    auto assign = [&](Ipv4Address addr) {
+        // AssignNum is a single byte on the wire
+        if(assignNeighbor.size() == UINT8_T_LIMIT) {
+            return;
         }
-    }
-    // for(auto mapiter = reachableMap.begin(); mapiter != reachableMap.end(); mapiter++) {
-    //     std::cout << "targetAddr:" << mapiter->first;
-    //     for(auto veciter = mapiter->second.begin(); veciter != mapiter->second.end(); veciter++) {
-    //         std::cout << " [" << veciter->oneHopAddr << "]-" << (uint16_t)veciter->linkStatus;
-    //     }
-    //     std::cout << std::endl;
-    // }
+        assignNeighbor.push_back(addr);
+    };
 
     // find all the target node that can be reached from one way, make that onehop node as the assign forward node;
-
-    for(auto mapiter = reachableMap.begin(); mapiter != reachableMap.end(); mapiter++) {
-        if(mapiter->second.size() == 1) {
-            assignNeighborSet.insert(mapiter->second[0].oneHopAddr);
+    for(auto& target : m_targets) {
+        if(target.pathCount == 1) {
+            uint32_t oneHopIndex = m_paths[target.pathBegin].oneHopIndex;
+            if(m_assignMark[oneHopIndex] != epoch) {
+                m_assignMark[oneHopIndex] = epoch;
+                assign(m_nbStatus[oneHopIndex].neighborMainAddr);
+            }
         }
     }
     // // If there is more than one path to reach a target node, first check whether any of the arriving nodes are already in the assigned node SET
     // // If there is, do not further evaluate; if there isn't, then compare among the multiple paths.
 
     // todo: 最终的选择并不完备，对于所有有2个选择以上的target，其中间仍然可能存在相同的，在这没有处理，只是按顺序查找。
-    for(auto mapiter = reachableMap.begin(); mapiter != reachableMap.end(); mapiter++) {
-        if(mapiter->second.size() > 1) {
+    for(auto& target : m_targets) {
+        if(target.pathCount > 1) {
             bool found = false;
-            for(auto veciter = mapiter->second.begin(); veciter != mapiter->second.end(); veciter++) {
-                if(assignNeighborSet.find(veciter->oneHopAddr) != assignNeighborSet.end()) {
+            for(uint32_t p = target.pathBegin; p < target.pathBegin + target.pathCount; p++) {
+                if(m_assignMark[m_paths[p].oneHopIndex] == epoch) {
                     found = true;
                     break;
                 }
             }
             if(!found) {
-                Ipv4Address winAddr = Ipv4Address("255.255.255.255");
-                twoHopLinkJudge winLink = TWOHOP_LINK_INVALID;
-                for(auto veciter = mapiter->second.begin(); veciter != mapiter->second.end(); veciter++) {
-                    if (veciter->linkStatus < winLink)
+                uint32_t winIndex = m_nbStatus.size();
+                uint8_t winLink = TWOHOP_LINK_INVALID;
+                for(uint32_t p = target.pathBegin; p < target.pathBegin + target.pathCount; p++) {
+                    if (m_paths[p].linkStatus < winLink)
                     {
-                        winLink = veciter->linkStatus;
-                        winAddr = veciter->oneHopAddr;
+                        winLink = m_paths[p].linkStatus;
+                        winIndex = m_paths[p].oneHopIndex;
+                    }
+                }
+                if(winIndex < m_nbStatus.size()) {
+                    if(m_assignMark[winIndex] != epoch) {
+                        m_assignMark[winIndex] = epoch;
+                        assign(m_nbStatus[winIndex].neighborMainAddr);
                     }
+                } else if(!assignBroadcast) {
+                    // no valid link to the target
+                    assignBroadcast = true;
+                    assign(Ipv4Address("255.255.255.255"));
                 }
-                assignNeighborSet.insert(winAddr);
             }
         }
     }
-
-    header.AssignNum = 0;
-    for(auto setIter = assignNeighborSet.begin(); setIter != assignNeighborSet.end(); setIter++) {
-        header.AssignNeighbor.push_back(*setIter);
-        header.AssignNum++;
-    }
 }
 
 Ipv4Address
 RangerNeighborList::GetAckNeighbor(Ipv4Address srcAddr) const
 {
     Ipv4Address dstAddr = Ipv4Address("255.255.255.255");   // 默认使用广播地址
-    std::vector<Ipv4Address> targetAddr;    // 存储有效邻居节点的地址
-    std::vector<uint8_t> targetLqi;         // 存储相应节点的Lqi
+    std::vector<Ipv4Address>& targetAddr = m_ackTargetAddr;  // 存储有效邻居节点的地址
+    std::vector<uint8_t>& targetLqi = m_ackTargetLqi;        // 存储相应节点的Lqi
+    targetAddr.clear();
+    targetLqi.clear();
 
 #if 0   // 仅排除源节点
 
@@ -418,37 +538,25 @@ RangerNeighborList::GetAckNeighbor(Ipv4Address srcAddr) const
 
 #elif 1 // 排除源节点及其一级邻居节点
 
-    // 存储源节点的一级邻居节点地址
-    std::vector<Ipv4Address> srcNeighborsAddr;
-
-    // 遍历邻居节点列表，找到源节点的一级邻居节点
-    for(auto it = m_nbStatus.begin(); it != m_nbStatus.end(); it++)
+    // 标记源节点的一级邻居节点
+    uint32_t epoch = NextEpoch();
+    uint32_t srcIndex = 0;
+    if (FindNeighbor(srcAddr, srcIndex))    // 找到源节点
     {
-        if (it->neighborMainAddr == srcAddr)    // 找到源节点
+        const NeighborStatus& src = m_nbStatus[srcIndex];
+        for (uint32_t k = 0; k < src.twoHopCount; k++)
         {
-            for(auto jt = it->twoHopNodeInfo.begin(); jt != it->twoHopNodeInfo.end(); jt++)
+            if (m_twoHopLinks[src.twoHopOffset + k].linkStatus != NeighborStatus::STATUS_NONE)
             {
-                if (jt->linkStatus != NeighborStatus::STATUS_NONE)
-                {
-                    srcNeighborsAddr.push_back(jt->neighborAddresses);
-                }
+                m_addrMark[m_twoHopIds[src.twoHopOffset + k]] = epoch;
             }
-            break;
         }
     }
 
     // 遍历邻居节点信息表，收集除源节点及其一级邻居之外的有效邻居节点
     for(auto it = m_nbStatus.begin(); it != m_nbStatus.end(); it++)
     {
-        bool isSrcNeighbor = false;
-        for (uint8_t i = 0; i < srcNeighborsAddr.size(); i++)
-        {
-            if (it->neighborMainAddr == srcNeighborsAddr[i])
-            {
-                isSrcNeighbor = true;
-                break;
-            }
-        }
+        bool isSrcNeighbor = (m_addrMark[it->addrId] == epoch);
         if (it->status != NeighborStatus::STATUS_NONE &&
             it->neighborMainAddr != srcAddr && !isSrcNeighbor)
         {
@@ -717,7 +825,11 @@ RangerNeighborList::Print(std::ostream& os) const
     for(auto iter = m_nbStatus.begin(); iter != m_nbStatus.end(); iter++) {
         os << "[" << iter->neighborMainAddr << "]";
         os << "(" << (uint16_t)iter->lqi << "-" << (uint16_t)iter->status << "):";
-        iter->Print(os);
+        for(auto& link : GetTwoHopList(iter - m_nbStatus.begin())) {
+            os << " [" << link.neighborAddresses << "]";
+            os << "(" << (uint16_t)link.linkStatus << ")";
+        }
+        os << std::endl;
     }
     os << "----------------[" << m_mainAddr << "]---------------- AT +" << Simulator::Now().GetMilliSeconds() << "ms" << std::endl;
 }
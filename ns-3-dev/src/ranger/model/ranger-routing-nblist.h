@@ -46,32 +46,94 @@ struct hash<ns3::Ipv4Address> {
 namespace ns3
 {
 
+#ifndef MAX_NODEINFO_RECEIVE_RATE_BUFFER
 #define MAX_NODEINFO_RECEIVE_RATE_BUFFER (10)
-class NodeInfoReceiveRateBuffer {
-private:
-    std::vector<bool> buffer;
-    int head = 0;  // 指向下一个插入位置
-    bool isFull = false;
-    int capacity;
+#endif
 
-public:
-    explicit NodeInfoReceiveRateBuffer(int capacity) : buffer(capacity, 0), capacity(capacity) {}
+/**
+ * Reception history of the last Window NodeInfo periods of a neighbor, and the
+ * LQI derived from it.
+ *
+ * The history is a bitmask of the lost periods, bit 0 being the latest one.
+ * A lost period costs 1, or 2 if the period before it was lost as well, and
+ * the LQI is 255 * (1 - cost / weight), the weight being Window plus the
+ * number of consecutive losses. Periods not yet observed count as lost.
+ * For windows up to 16 periods the LQI of every history is computed at
+ * compile time, otherwise it is computed from two popcounts.
+ */
+template <uint32_t Window>
+class RangerLqiWindow
+{
+    static_assert(Window >= 2 && Window <= 32, "the LQI window must hold 2 to 32 periods");
 
-    void insert(bool isReceive) {
-        buffer[head] = isReceive;
-        head = (head + 1) % capacity;
+  public:
+    static constexpr uint32_t MASK = Window == 32 ? 0xffffffffU : (1U << Window) - 1;
+
+    /**
+     * \param lost bitmask of the lost periods, bit 0 being the latest one
+     * \return the LQI of this history
+     */
+    static constexpr uint8_t LqiOf(uint32_t lost)
+    {
+        lost &= MASK;
+        uint32_t consecutive = PopCount(lost & (lost >> 1));
+        uint32_t lqi = PopCount(lost) + consecutive;
+        uint32_t weight = Window + consecutive;
+        return (uint8_t)((1.0 - ((float)lqi / (float)weight)) * (float)255);
+    }
 
-        // 检查是否第一次填满
-        if (head == 0 && !isFull) {
-            isFull = true;
+    void insert(bool isReceive) {
+        lost = ((lost << 1) | (isReceive ? 0U : 1U)) & MASK;
+        if (inserted < Window) {
+            inserted++;
         }
     }
     bool isBufferFull() const {
-        return isFull;
+        return inserted == Window;
+    }
+    uint8_t calLqi() const {
+        if constexpr (Window <= 16) {
+            return TABLE[lost];
+        } else {
+            return LqiOf(lost);
+        }
+    }
+
+  private:
+    static constexpr uint32_t PopCount(uint32_t x)
+    {
+        uint32_t n = 0;
+        for (; x != 0; x &= x - 1) {
+            n++;
+        }
+        return n;
     }
-    uint8_t calLqi() const; 
+
+    struct Table
+    {
+        uint8_t lqi[1U << (Window <= 16 ? Window : 1)];
+
+        constexpr Table()
+            : lqi()
+        {
+            for (uint32_t m = 0; m < sizeof(lqi); m++) {
+                lqi[m] = LqiOf(m);
+            }
+        }
+
+        constexpr uint8_t operator[](uint32_t m) const {
+            return lqi[m];
+        }
+    };
+
+    static constexpr Table TABLE{};
+
+    uint32_t lost = MASK; // 1 = NodeInfo not received in that period
+    uint32_t inserted = 0;
 };
 
+typedef RangerLqiWindow<MAX_NODEINFO_RECEIVE_RATE_BUFFER> NodeInfoReceiveRateBuffer;
+
 
 struct NeighborStatus
 {
@@ -88,38 +150,55 @@ struct NeighborStatus
     uint8_t lqi;
     Time refreshTime;
     NodeInfoReceiveRateBuffer lqiBuffer;
-    // from
-    std::vector<MessageHeader::NodeInfo::LinkMessage> twoHopNodeInfo;
+    // from, stored in RangerNeighborList::m_twoHopLinks
+    uint32_t twoHopOffset;   //!< first two-hop link of this neighbor
+    uint32_t twoHopCount;    //!< number of two-hop links of this neighbor
+    uint32_t twoHopCapacity; //!< links reserved for this neighbor in the arena
+    uint32_t addrId;         //!< id of neighborMainAddr, see RangerNeighborList::GetAddressId
+
+    explicit NeighborStatus()
+        : twoHopOffset(0),
+          twoHopCount(0),
+          twoHopCapacity(0),
+          addrId(0)
+    {
+    }
+};
 
-    explicit NeighborStatus() : lqiBuffer(MAX_NODEINFO_RECEIVE_RATE_BUFFER) {}
+/**
+ * Read-only view of the two-hop links advertised by a neighbor.
+ * It is invalidated by the next update of the neighbor list.
+ */
+class TwoHopLinkView
+{
+  public:
+    typedef MessageHeader::NodeInfo::LinkMessage LinkMessage;
 
+    TwoHopLinkView(const LinkMessage* first, std::size_t count)
+        : m_first(first),
+          m_count(count)
+    {
+    }
 
-    /**
-     * Find the target Address. If it exits return <bool>true & put it index into <param>index
-     * \param TargetAddr target address.
-     * \param index target address's index in m_nbStatus.
-     */    
-    bool FindTwoHopNeighbor(Ipv4Address TargetAddr, uint8_t& index) {
-        for(std::size_t i = 0; i < twoHopNodeInfo.size(); i++) {
-            if (twoHopNodeInfo[i].neighborAddresses == TargetAddr)
-            {
-                index = i;
-                return true;
-            }
-        }
-        return false;
+    const LinkMessage* begin() const {
+        return m_first;
     }
-    /**
-     * This method is used to print the content of m_nbStatus.
-     * \param os output stream
-     */
-    void Print(std::ostream& os) const {
-        for(auto i = 0u; i < twoHopNodeInfo.size(); i++) {
-            os << " [" << twoHopNodeInfo[i].neighborAddresses << "]";
-            os << "(" << (uint16_t)twoHopNodeInfo[i].linkStatus << ")";
-        }
-        os << std::endl;
+    const LinkMessage* end() const {
+        return m_first + m_count;
     }
+    std::size_t size() const {
+        return m_count;
+    }
+    bool empty() const {
+        return m_count == 0;
+    }
+    const LinkMessage& operator[](std::size_t i) const {
+        return m_first[i];
+    }
+
+  private:
+    const LinkMessage* m_first;
+    std::size_t m_count;
 };
 
 struct OnlineMemberStatus
@@ -160,6 +239,99 @@ class RangerNeighborList
     Time m_refreshInterval;
     Time m_onlineMemberRefreshInterval;
 
+    // address -> index in m_nbStatus / m_onlineMemberStatus
+    std::unordered_map<Ipv4Address, uint32_t> m_nbIndex;
+    std::unordered_map<Ipv4Address, uint32_t> m_onlineMemberIndex;
+
+    // two-hop links of all the neighbors, each neighbor owns
+    // [twoHopOffset, twoHopOffset + twoHopCapacity)
+    std::vector<MessageHeader::NodeInfo::LinkMessage> m_twoHopLinks;
+    std::vector<uint32_t> m_twoHopIds; // address id of each entry of m_twoHopLinks
+    std::size_t m_twoHopGarbage;       // entries no longer owned by any neighbor
+
+    // dense id of every address seen in the list, used to index the marks below
+    std::unordered_map<Ipv4Address, uint32_t> m_addrIds;
+
+    // scratch state of the forward selection, reused between calls
+    struct ReachableTarget
+    {
+        uint32_t pathBegin; // first path in m_paths
+        uint32_t pathCount; // number of one-hop neighbors that reach the target
+    };
+    struct ReachablePath
+    {
+        uint32_t oneHopIndex; // index in m_nbStatus
+        uint8_t linkStatus;   // twoHopLinkJudge
+    };
+    mutable uint32_t m_epoch;                   // marks equal to m_epoch are set
+    mutable std::vector<uint32_t> m_addrMark;   // per address id: hidden node / excluded
+    mutable std::vector<uint32_t> m_targetMark; // per address id: reachable target
+    std::vector<uint32_t> m_targetPos;          // per address id: index in m_targets
+    mutable std::vector<uint32_t> m_assignMark; // per neighbor index: assigned
+    std::vector<ReachableTarget> m_targets;
+    std::vector<ReachablePath> m_paths;
+    mutable std::vector<Ipv4Address> m_ackTargetAddr;
+    mutable std::vector<uint8_t> m_ackTargetLqi;
+
+    // bumped by every change of the neighbors, their status or their two-hop
+    // links, i.e. by every change that can alter a forward set
+    uint64_t m_version;
+    // assigned forwarders by previous hop, m_mainAddr for a source packet;
+    // valid while m_assignCacheVersion == m_version
+    std::unordered_map<Ipv4Address, std::vector<Ipv4Address>> m_assignCache;
+    uint64_t m_assignCacheVersion;
+    uint64_t m_assignCacheHits;
+    uint64_t m_assignCacheMisses;
+    // one-hop links returned by GetOneHopList(), valid while m_oneHopListVersion == m_version
+    mutable std::vector<MessageHeader::NodeInfo::LinkMessage> m_oneHopList;
+    mutable uint64_t m_oneHopListVersion;
+
+    /**
+     * Get the dense id of an address, allocating one if needed.
+     * \param addr the address.
+     */
+    uint32_t GetAddressId(Ipv4Address addr);
+    /**
+     * Start a new round of marks; all the marks of the previous rounds are cleared.
+     */
+    uint32_t NextEpoch() const;
+    /**
+     * Replace the two-hop links of a neighbor.
+     * \tparam Links a list of LinkMessage with size() and operator[]
+     * \param nb the neighbor.
+     * \param links the links advertised in its last NodeInfo.
+     * \return true if the links differ from the previous ones.
+     */
+    template <typename Links>
+    bool SetTwoHopLinks(NeighborStatus& nb, const Links& links);
+    /**
+     * Update the status of the sender of a NodeInfo.
+     * \tparam Links a list of LinkMessage with size() and operator[]
+     * \param SrcAddress the sender.
+     * \param links the links advertised in the NodeInfo.
+     */
+    template <typename Links>
+    void UpdateNeighbor(Ipv4Address SrcAddress, const Links& links);
+    /**
+     * Drop the two-hop entries no longer owned by any neighbor.
+     */
+    void CompactTwoHopLinks();
+    void RebuildNeighborIndex();
+    void RebuildOnlineMemberIndex();
+    /**
+     * Pick up the assign forward node
+     * \param src the previous hop, or nullptr for a source packet.
+     * \param assignNeighbor the assign forward node, at most 255.
+     */
+    void SelectAssignNeighbor(const NeighborStatus* src, std::vector<Ipv4Address>& assignNeighbor);
+    /**
+     * Edit the header with the assign forward node cached for a previous hop,
+     * selecting them first if the neighbor list changed since the last call.
+     * \param src the previous hop, or nullptr for a source packet.
+     * \param header the packet header.
+     */
+    void GetCachedAssignNeighbor(const NeighborStatus* src, MessageHeader::AudioData& header);
+
     // manage neighbor;
   public:
     // self management
@@ -167,7 +339,14 @@ class RangerNeighborList
      * Receive a NodeInfo Packet & Update the Neighbor Status.
      * \param nodeinfoHdr the nodeinfo header.
      */
-    void UpdateNeighborNodeStatus(Ipv4Address SrcAddress, MessageHeader::NodeInfo nodeinfoHdr);
+    void UpdateNeighborNodeStatus(Ipv4Address SrcAddress, const MessageHeader::NodeInfo& nodeinfoHdr);
+    /**
+     * Receive a NodeInfo Packet & Update the Neighbor Status, reading the
+     * links from the packet.
+     * \param SrcAddress the sender.
+     * \param view the nodeinfo header at the start of the packet.
+     */
+    void UpdateNeighborNodeStatus(Ipv4Address SrcAddress, const MessageHeaderView& view);
     /**
      * Judge whether receive the nodeinfo Packet in last interval 
      *  & calculate the lqi & remove unstable node
@@ -178,7 +357,7 @@ class RangerNeighborList
      * Receive a MemberHeartbeat Packet & Update the OnlineMember Status.
      * \param memberHeartbeat the memberHeartbeat header.
      */
-    void UpdateOnlineMemberStatus(MessageHeader::MemberHeartbeat memberHeartbeatHdr);
+    void UpdateOnlineMemberStatus(const MessageHeader::MemberHeartbeat& memberHeartbeatHdr);
     /**
      * Judge whether receive the MemberHeartbeat Packet in last interval 
      *  & remove timeout node
@@ -186,7 +365,7 @@ class RangerNeighborList
      */
     void RefreshOnlineMemberStatus(void);
 
-    bool isMemberHeartbeatNew(MessageHeader::MemberHeartbeat memberHeartbeatHdr);
+    bool isMemberHeartbeatNew(const MessageHeader::MemberHeartbeat& memberHeartbeatHdr);
 
     // information request
     /**
@@ -194,20 +373,23 @@ class RangerNeighborList
      * \param TargetAddr target address.
      * \param index target address's index in m_nbStatus.
      */
-    bool FindNeighbor(Ipv4Address TargetAddr, uint8_t& index);
-    bool FindOnlineMember(Ipv4Address TargetAddr, uint8_t& index);
+    bool FindNeighbor(Ipv4Address TargetAddr, uint32_t& index) const;
+    bool FindOnlineMember(Ipv4Address TargetAddr, uint32_t& index) const;
 
     bool isEmpty() const {
         return m_nbStatus.empty();
     }
+    std::size_t GetNeighborCount() const {
+        return m_nbStatus.size();
+    }
     // information request
     /**
      * Get Lqi of the target Address. If it exits return lqi if not return 0
      * \param TargetAddr target address.
      * \param index target address's index in m_nbStatus.
      */
-    uint8_t GetNeighborLqi(Ipv4Address TargetAddr) {
-        uint8_t index;
+    uint8_t GetNeighborLqi(Ipv4Address TargetAddr) const {
+        uint32_t index;
         if(FindNeighbor(TargetAddr, index)) {
             return m_nbStatus[index].lqi;
         }
@@ -215,27 +397,51 @@ class RangerNeighborList
     }
 
 
-    std::vector<MessageHeader::NodeInfo::LinkMessage> GetOneHopList() {
-        std::vector<MessageHeader::NodeInfo::LinkMessage> oneHopList;
-        for(auto iter = m_nbStatus.begin(); iter != m_nbStatus.end(); iter++) {
-            MessageHeader::NodeInfo::LinkMessage link;
-            link.neighborAddresses = iter->neighborMainAddr;
-            link.linkStatus = iter->status;
-            oneHopList.push_back(link);
+    /**
+     * Get the one hop Address & status. The list is rebuilt only when the
+     * neighbor list changed, and stays valid until the next change.
+     */
+    const std::vector<MessageHeader::NodeInfo::LinkMessage>& GetOneHopList() const {
+        if(m_oneHopListVersion != m_version) {
+            m_oneHopList.clear();
+            m_oneHopList.reserve(m_nbStatus.size());
+            for(auto iter = m_nbStatus.begin(); iter != m_nbStatus.end(); iter++) {
+                MessageHeader::NodeInfo::LinkMessage link;
+                link.neighborAddresses = iter->neighborMainAddr;
+                link.linkStatus = iter->status;
+                m_oneHopList.push_back(link);
+            }
+            m_oneHopListVersion = m_version;
         }
-        return oneHopList;
+        return m_oneHopList;
+    }
+
+    /**
+     * Version of the neighbor list. It changes whenever a neighbor, its status
+     * or its two-hop links change, so anything computed from them can be
+     * cached until the version changes.
+     */
+    uint64_t GetVersion() const {
+        return m_version;
     }
 
     /**
      * Get the two hop Address.
      * \param targetIndex target Index.
      */
-    std::vector<MessageHeader::NodeInfo::LinkMessage> GetTwoHopList(uint8_t targetIndex) {
-        return m_nbStatus[targetIndex].twoHopNodeInfo;
+    TwoHopLinkView GetTwoHopList(uint32_t targetIndex) const {
+        const NeighborStatus& nb = m_nbStatus[targetIndex];
+        return TwoHopLinkView(m_twoHopLinks.data() + nb.twoHopOffset, nb.twoHopCount);
     }
 
     /**
      * Get the Neighbor Node Info.
+     *
+     * Only the first NodeInfo::MAX_LINKS links, the capacity of linkMessages,
+     * are stored, the following ones are dropped. linkNumber still counts all
+     * the links, up to 255, so that the serialized size of a NodeInfo too long
+     * for a frame makes the MAC refuse it.
+     *
      * \param header the packet header.
      */
     void GetNeighborNodeInfo(MessageHeader::NodeInfo& header);
@@ -250,12 +456,6 @@ class RangerNeighborList
         TWOHOP_LINK_INVALID,
     };
 
-    struct reachableMapElement
-    {
-        // Ipv4Address targetAddr;
-        Ipv4Address oneHopAddr;
-        twoHopLinkJudge linkStatus;
-    };
     /**
      * Transfer the two hop link status and the one hop link status to a enum.
      * \param oneHopStatus one hop link status.
@@ -280,6 +480,19 @@ class RangerNeighborList
      */
     Ipv4Address GetAckNeighbor(Ipv4Address srcAddr) const;
 
+    /**
+     * Number of assign forward node selections answered from the cache.
+     */
+    uint64_t GetAssignCacheHits() const {
+        return m_assignCacheHits;
+    }
+    /**
+     * Number of assign forward node selections that had to be computed.
+     */
+    uint64_t GetAssignCacheMisses() const {
+        return m_assignCacheMisses;
+    }
+
     // 
     /**
      * This method is used to print the content of m_nbStatus.
@@ -289,6 +502,7 @@ class RangerNeighborList
     void Draw(std::ostream& os) const;
     void SetMainAddress(Ipv4Address Address) {
         m_mainAddr = Address;
+        m_version++;
     }
 };
 
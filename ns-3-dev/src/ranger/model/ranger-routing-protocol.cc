@@ -35,6 +35,45 @@ RangerRoutingProtocol::GetTypeId()
             .SetParent<Object>()
             .SetGroupName("Ranger")
             .AddConstructor<RangerRoutingProtocol>()
+            .AddAttribute("EventDrivenQueue",
+                          "Send queued messages only when a message is queued, instead of "
+                          "polling the queue every 1 ms. Sends stay on the same 1 ms grid.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RangerRoutingProtocol::m_eventDrivenQueue),
+                          MakeBooleanChecker())
+            .AddAttribute("AssignCacheHits",
+                          "Number of assigned forwarder sets reused from the cache of the "
+                          "neighbor list.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RangerRoutingProtocol::GetAssignCacheHits),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("AssignCacheMisses",
+                          "Number of assigned forwarder sets computed because the neighbor "
+                          "list changed or the previous hop was new.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RangerRoutingProtocol::GetAssignCacheMisses),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("ForwardJudgeCacheHits",
+                          "Number of Hivemesh forward decisions reused from the cache.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RangerRoutingProtocol::m_forwardJudgeCacheHits),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("ForwardJudgeCacheMisses",
+                          "Number of Hivemesh forward decisions computed because the neighbor "
+                          "list changed or the (previous hop, origin) pair was new.",
+                          TypeId::ATTR_GET,
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RangerRoutingProtocol::m_forwardJudgeCacheMisses),
+                          MakeUintegerChecker<uint64_t>())
+            .AddTraceSource("PacketTrace",
+                            "A NWK message has been sent, or received for the first time. "
+                            "Connect a sink such as RangerPacketTraceSink to record them; "
+                            "without sinks no record is built.",
+                            MakeTraceSourceAccessor(&RangerRoutingProtocol::m_packetTrace),
+                            "ns3::RangerRoutingProtocol::PacketTracedCallback")
             // .AddAttribute("NodeInfoInterval",
             //               "NodeInfo messages emission interval.",
             //               TimeValue(Seconds(1)),
@@ -47,7 +86,11 @@ RangerRoutingProtocol::GetTypeId()
 RangerRoutingProtocol::RangerRoutingProtocol()
     : m_nbList(Seconds(1.0), Seconds(5.0)),
       m_audioManagement(),
+      m_forwardJudgeCacheVersion(0),
+      m_forwardJudgeCacheHits(0),
+      m_forwardJudgeCacheMisses(0),
       m_queuedMessagesTimer(Timer::CANCEL_ON_DESTROY),
+      m_eventDrivenQueue(false),
       m_nodeInfoTimer(Timer::CANCEL_ON_DESTROY),
       m_memberHeartbeatTimer(Timer::CANCEL_ON_DESTROY)
 {
@@ -55,28 +98,42 @@ RangerRoutingProtocol::RangerRoutingProtocol()
     m_queuedMessagesInterval = MilliSeconds(1.0);
     m_nodeInfoInterval = Seconds(1.0);
     m_memberHeartbeatInterval = Seconds(5.0);
+    // created here rather than in DoInitialize: the nodes are initialized by
+    // events, which the multithreaded simulator runs in parallel, and the
+    // stream of a variable depends on the order the variables are created
+    m_randomTime = CreateObject<UniformRandomVariable>();
+    m_randomTime->SetAttribute("Min", DoubleValue(0.0));
+    m_randomTime->SetAttribute("Max", DoubleValue(1.0)); // 最大值设为1秒
 }
 
 RangerRoutingProtocol::~RangerRoutingProtocol()
 {
 }
 
+int64_t
+RangerRoutingProtocol::AssignStreams(int64_t stream)
+{
+    NS_LOG_FUNCTION(this << stream);
+    m_randomTime->SetStream(stream);
+    return 1;
+}
+
 void
 RangerRoutingProtocol::DoInitialize()
 {
     NS_LOG_FUNCTION(this);
-    Ptr<UniformRandomVariable> randomTime = CreateObject<UniformRandomVariable>();
-    randomTime->SetAttribute("Min", DoubleValue(0.0));
-    randomTime->SetAttribute("Max", DoubleValue(1.0)); // 最大值设为1秒
-
     m_queuedMessagesTimer.SetFunction(&RangerRoutingProtocol::QueuedMessagesTimerExpire, this);
-    m_queuedMessagesTimer.Schedule(MilliSeconds(1.0 + randomTime->GetValue()));
+    m_queuedMessagesOrigin = Simulator::Now() + MilliSeconds(1.0 + m_randomTime->GetValue());
+    if (!m_eventDrivenQueue || !m_queuedMessages.empty())
+    {
+        m_queuedMessagesTimer.Schedule(m_queuedMessagesOrigin - Simulator::Now());
+    }
 
     m_nodeInfoTimer.SetFunction(&RangerRoutingProtocol::NodeInfoTimerExpire, this);
-    m_nodeInfoTimer.Schedule(Seconds(1.0 + randomTime->GetValue()));
+    m_nodeInfoTimer.Schedule(Seconds(1.0 + m_randomTime->GetValue()));
 
     m_memberHeartbeatTimer.SetFunction(&RangerRoutingProtocol::MemberHeartbeatExpire, this);
-    m_memberHeartbeatTimer.Schedule(Seconds(5.0 + randomTime->GetValue()));
+    m_memberHeartbeatTimer.Schedule(Seconds(5.0 + m_randomTime->GetValue()));
 }
 void
 RangerRoutingProtocol::DoDispose()
@@ -122,30 +179,32 @@ RangerRoutingProtocol::SendPacket(ranger::McpsDataRequestParams sendParams, Ptr<
 void
 RangerRoutingProtocol::ReceivePacket(ranger::McpsDataIndicationParams receiveParams, Ptr<Packet> p) {
     NS_LOG_FUNCTION(this);
-    MessageHeader msgHdr;
-    p->RemoveHeader(msgHdr);
+    // NodeInfo and AudioData are read in place, only MemberHeartbeat, which
+    // is forwarded, is deserialized
+    MessageHeaderView view(p);
 
-    switch (msgHdr.GetMessageType())
+    switch (view.GetMessageType())
     {
     case MessageHeader::NODEINFO_MESSAGE:
     {
-        std::ostringstream oss;
-        oss << "[NWK][" << m_mainAddr << "](R-AT +" << Simulator::Now().GetMilliSeconds() << "ms)";
-        msgHdr.Print(oss); // 将输出重定向到字符串流
-        NS_LOG_INFO(oss.str()); // 将捕获的字符串输出到日志
-        m_nbList.UpdateNeighborNodeStatus(msgHdr.GetSrcAddress(), msgHdr.GetNodeInfo());
+        NS_LOG_INFO("[NWK][" << m_mainAddr << "](R-AT +" << Simulator::Now().GetMilliSeconds() << "ms)"
+                    << view);
+        TracePacket(RangerNwkPacketRecord::RECEIVE, view);
+        m_nbList.UpdateNeighborNodeStatus(view.GetSrcAddress(), view);
         break;
     }
     case MessageHeader::AUDIODATA_MESSAGE: {
 
-        MessageHeader::AudioData audioDataHdr = msgHdr.GetAudioData();
-        if(m_audioManagement.isNewSeq(audioDataHdr.OriAddr, audioDataHdr.AudioSeq, Simulator::Now())) {
-            std::ostringstream oss;
-            oss << "[NWK][" << m_mainAddr << "](R-AT +" << Simulator::Now().GetMilliSeconds() << "ms)";
-            msgHdr.Print(oss); // 将输出重定向到字符串流
-            NS_LOG_INFO(oss.str()); // 将捕获的字符串输出到日志
+        Ipv4Address oriAddr = view.GetOriAddr();
+        uint8_t audioSeq = view.GetAudioSeq();
+        if(m_audioManagement.isNewSeq(oriAddr, audioSeq, Simulator::Now())) {
+            NS_LOG_INFO("[NWK][" << m_mainAddr << "](R-AT +" << Simulator::Now().GetMilliSeconds() << "ms)"
+                        << view);
+            TracePacket(RangerNwkPacketRecord::RECEIVE, view);
             // Trace
-            m_receiveTraceCallback(m_mainAddr, audioDataHdr.OriAddr, audioDataHdr.AudioSeq, Simulator::Now());
+            if(!m_receiveTraceCallback.IsNull()) {
+                m_receiveTraceCallback(m_mainAddr, oriAddr, audioSeq, Simulator::Now());
+            }
             //NS_LOG_UNCOND("--------------");
             // if(false || isForwardNode(audioDataHdr)) {
             //     ForwardAudioDataRequest(msgHdr);
@@ -159,11 +218,12 @@ RangerRoutingProtocol::ReceivePacket(ranger::McpsDataIndicationParams receivePar
     }
     case MessageHeader::MEMBERHEARTBEAT_MESSAGE:
     {
+        MessageHeader msgHdr;
+        p->PeekHeader(msgHdr);
         if(m_nbList.isMemberHeartbeatNew(msgHdr.GetMemberHeartbeat())) {
-            std::ostringstream oss;
-            oss << "[NWK][" << m_mainAddr << "](R-AT +" << Simulator::Now().GetMilliSeconds() << "ms)";
-            msgHdr.Print(oss); // 将输出重定向到字符串流
-            NS_LOG_INFO(oss.str()); // 将捕获的字符串输出到日志
+            NS_LOG_INFO("[NWK][" << m_mainAddr << "](R-AT +" << Simulator::Now().GetMilliSeconds() << "ms)"
+                        << msgHdr);
+            TracePacket(RangerNwkPacketRecord::RECEIVE, msgHdr);
 
             // 更新在线成员状态
             m_nbList.UpdateOnlineMemberStatus(msgHdr.GetMemberHeartbeat());
@@ -268,12 +328,31 @@ RangerRoutingProtocol::isForwardNode(const MessageHeader::AudioData& assignHdr){
 bool 
 RangerRoutingProtocol::isForwardJudge_Hivemesh(const MessageHeader& hdr){
     NS_LOG_FUNCTION(this);
+    // the decision only depends on the neighbor list, the previous hop and the origin
+    if(m_forwardJudgeCacheVersion != m_nbList.GetVersion()) {
+        m_forwardJudgeCache.clear();
+        m_forwardJudgeCacheVersion = m_nbList.GetVersion();
+    }
+    uint64_t key = (static_cast<uint64_t>(hdr.GetSrcAddress().Get()) << 32) | hdr.GetAudioData().OriAddr.Get();
+    auto cached = m_forwardJudgeCache.find(key);
+    if(cached != m_forwardJudgeCache.end()) {
+        m_forwardJudgeCacheHits++;
+        return cached->second;
+    }
+    m_forwardJudgeCacheMisses++;
+    bool forward_result = JudgeForward_Hivemesh(hdr);
+    m_forwardJudgeCache[key] = forward_result;
+    return forward_result;
+}
+
+bool
+RangerRoutingProtocol::JudgeForward_Hivemesh(const MessageHeader& hdr){
     // std::ostringstream oss;
     // m_nbList.Print(oss);
     // NS_LOG_UNCOND(oss.str());
     // NS_LOG_UNCOND("");
 
-    uint8_t from_idx = 0;
+    uint32_t from_idx = 0;
     // 在邻居列表中找到目标地址，若没找到则直接返回true
     if(!m_nbList.FindNeighbor(hdr.GetSrcAddress(), from_idx)) {
         //NS_LOG_UNCOND("Not Found Target Address");
@@ -284,9 +363,9 @@ RangerRoutingProtocol::isForwardJudge_Hivemesh(const MessageHeader& hdr){
     //NS_LOG_UNCOND("From : " << from_addr << " Origin : " << origin_addr);
 
     // 若找到目标地址，取出其二跳表，备用
-    std::vector<MessageHeader::NodeInfo::LinkMessage> fromTwoHopList = m_nbList.GetTwoHopList(from_idx);
+    TwoHopLinkView fromTwoHopList = m_nbList.GetTwoHopList(from_idx);
     // 取出本地一跳表
-    std::vector<MessageHeader::NodeInfo::LinkMessage> localOneHopList = m_nbList.GetOneHopList();
+    const std::vector<MessageHeader::NodeInfo::LinkMessage>& localOneHopList = m_nbList.GetOneHopList();
     // 若本地一跳节点为空，直接返回true
     if(m_nbList.isEmpty()) {
         //NS_LOG_UNCOND("Empty Local Node List");
@@ -312,7 +391,7 @@ RangerRoutingProtocol::isForwardJudge_Hivemesh(const MessageHeader& hdr){
         // 本地节点表不存在，发送节点表存在的节点，忽略
 
         // 遍历对比发送节点
-        uint8_t j = 0;
+        std::size_t j = 0;
 
         for(; j < fromTwoHopList.size(); j++) {
             if(localIter->neighborAddresses != fromTwoHopList[j].neighborAddresses) {
@@ -334,13 +413,13 @@ RangerRoutingProtocol::isForwardJudge_Hivemesh(const MessageHeader& hdr){
     }
 
     // 从本地周围节点信息表中，取出每个重复节点的周围节点信息表
-    uint8_t finish_forward_node_num = forward_node_table.size();
+    std::size_t finish_forward_node_num = forward_node_table.size();
     // 获取每个公共节点的周围节点信息表
     for(auto publicIter = public_node_table.begin(); publicIter != public_node_table.end(); publicIter++) {
         // 从本地周围节点信息表中，取出每个重复节点的周围节点信息表
-        uint8_t publicIndex = 0;
+        uint32_t publicIndex = 0;
         m_nbList.FindNeighbor(publicIter->neighborAddresses, publicIndex);
-        std::vector<MessageHeader::NodeInfo::LinkMessage> publicTwoHopList = m_nbList.GetTwoHopList(publicIndex);
+        TwoHopLinkView publicTwoHopList = m_nbList.GetTwoHopList(publicIndex);
         // 获取每个转发目标节点，在公共节点的周围节点信息表中进行对比，判断是否为更优转发选择（检查哪个公共节点为最优转发选择）
         // 如果本地节点不是最优转发选择，则从转发列表里删除
         for(auto forwardIter = forward_node_table.begin(); forwardIter != forward_node_table.end();) {
@@ -385,11 +464,79 @@ RangerRoutingProtocol::isForwardJudge_Hivemesh(const MessageHeader& hdr){
 void
 RangerRoutingProtocol::QueuedMessagesTimerExpire() {
     //NS_LOG_FUNCTION(this);
+    m_queuedMessagesLastExpire = Simulator::Now();
     SendQueuedMessages();
-    m_queuedMessagesTimer.Schedule(m_queuedMessagesInterval);
+    if (!m_eventDrivenQueue)
+    {
+        m_queuedMessagesTimer.Schedule(m_queuedMessagesInterval);
+    }
 }
 
 
+void
+RangerRoutingProtocol::TracePacket(RangerNwkPacketRecord::Direction direction, const MessageHeader& hdr) {
+    if (m_packetTrace.IsEmpty()) {
+        return;
+    }
+    RangerNwkPacketRecord record;
+    record.direction = direction;
+    record.messageType = hdr.GetMessageType();
+    record.seq = 0;
+    record.assignNum = 0;
+    record.node = m_mainAddr.Get();
+    record.src = hdr.GetSrcAddress().Get();
+    record.origin = record.src;
+    record.time = Simulator::Now().GetTimeStep();
+    switch (hdr.GetMessageType()) {
+    case MessageHeader::NODEINFO_MESSAGE:
+        record.assignNum = hdr.GetNodeInfo().linkNumber;
+        break;
+    case MessageHeader::AUDIODATA_MESSAGE:
+        record.seq = hdr.GetAudioData().AudioSeq;
+        record.assignNum = hdr.GetAudioData().AssignNum;
+        record.origin = hdr.GetAudioData().OriAddr.Get();
+        break;
+    case MessageHeader::MEMBERHEARTBEAT_MESSAGE:
+        record.origin = hdr.GetMemberHeartbeat().mainAddr.Get();
+        break;
+    default:
+        break;
+    }
+    m_packetTrace(record);
+}
+
+void
+RangerRoutingProtocol::TracePacket(RangerNwkPacketRecord::Direction direction, const MessageHeaderView& hdr) {
+    if (m_packetTrace.IsEmpty()) {
+        return;
+    }
+    RangerNwkPacketRecord record;
+    record.direction = direction;
+    record.messageType = hdr.GetMessageType();
+    record.seq = 0;
+    record.assignNum = 0;
+    record.node = m_mainAddr.Get();
+    record.src = hdr.GetSrcAddress().Get();
+    record.origin = record.src;
+    record.time = Simulator::Now().GetTimeStep();
+    switch (hdr.GetMessageType()) {
+    case MessageHeader::NODEINFO_MESSAGE:
+        record.assignNum = hdr.GetLinkNumber();
+        break;
+    case MessageHeader::AUDIODATA_MESSAGE:
+        record.seq = hdr.GetAudioSeq();
+        record.assignNum = hdr.GetAssignNum();
+        record.origin = hdr.GetOriAddr().Get();
+        break;
+    case MessageHeader::MEMBERHEARTBEAT_MESSAGE:
+        record.origin = hdr.GetMainAddr().Get();
+        break;
+    default:
+        break;
+    }
+    m_packetTrace(record);
+}
+
 void
 RangerRoutingProtocol::SendQueuedMessages() {
     //NS_LOG_FUNCTION(this);
@@ -398,10 +545,9 @@ RangerRoutingProtocol::SendQueuedMessages() {
 
         switch (messageIter->hdr.GetMessageType()) {
         case MessageHeader::NODEINFO_MESSAGE: {
-            std::ostringstream oss;
-            oss << "[NWK][" << m_mainAddr << "](S-AT +" << Simulator::Now().GetMilliSeconds() << "ms)";
-            messageIter->hdr.Print(oss); // 将输出重定向到字符串流
-            NS_LOG_INFO(oss.str()); // 将捕获的字符串输出到日志
+            NS_LOG_INFO("[NWK][" << m_mainAddr << "](S-AT +" << Simulator::Now().GetMilliSeconds() << "ms)"
+                        << messageIter->hdr);
+            TracePacket(RangerNwkPacketRecord::SEND, messageIter->hdr);
 
             Ptr<Packet> p = Create<Packet>(0);
             p->AddHeader(messageIter->hdr);
@@ -412,28 +558,26 @@ RangerRoutingProtocol::SendQueuedMessages() {
             MessageHeader::AudioData tmp = messageIter->hdr.GetAudioData();
 
             if(m_mainAddr == tmp.OriAddr) {
-                std::ostringstream oss;
-                oss << "[NWK][" << m_mainAddr << "](S-AT +" << Simulator::Now().GetMilliSeconds() << "ms)";
-                messageIter->hdr.Print(oss); // 将输出重定向到字符串流
-                NS_LOG_INFO(oss.str()); // 将捕获的字符串输出到日志
+                NS_LOG_INFO("[NWK][" << m_mainAddr << "](S-AT +" << Simulator::Now().GetMilliSeconds() << "ms)"
+                            << messageIter->hdr);
             } else {
-                std::ostringstream oss;
-                oss << "[NWK][" << m_mainAddr << "](F-AT +" << Simulator::Now().GetMilliSeconds() << "ms)";
-                messageIter->hdr.Print(oss); // 将输出重定向到字符串流
-                NS_LOG_INFO(oss.str()); // 将捕获的字符串输出到日志
+                NS_LOG_INFO("[NWK][" << m_mainAddr << "](F-AT +" << Simulator::Now().GetMilliSeconds() << "ms)"
+                            << messageIter->hdr);
             }
+            TracePacket(RangerNwkPacketRecord::SEND, messageIter->hdr);
             Ptr<Packet> p = Create<Packet>(tmp.AudioSize);
             p->AddHeader(messageIter->hdr);
             SendPacket(messageIter->params, p);
             // Trace
-            m_sendTraceCallback(m_mainAddr, messageIter->hdr.GetAudioData().OriAddr, messageIter->hdr.GetAudioData().AudioSeq, Simulator::Now());
+            if(!m_sendTraceCallback.IsNull()) {
+                m_sendTraceCallback(m_mainAddr, messageIter->hdr.GetAudioData().OriAddr, messageIter->hdr.GetAudioData().AudioSeq, Simulator::Now());
+            }
             break;
         }
         case MessageHeader::MEMBERHEARTBEAT_MESSAGE: {
-            std::ostringstream oss;
-            oss << "[NWK][" << m_mainAddr << "](S-AT +" << Simulator::Now().GetMilliSeconds() << "ms)";
-            messageIter->hdr.Print(oss); // 将输出重定向到字符串流
-            NS_LOG_INFO(oss.str()); // 将捕获的字符串输出到日志
+            NS_LOG_INFO("[NWK][" << m_mainAddr << "](S-AT +" << Simulator::Now().GetMilliSeconds() << "ms)"
+                        << messageIter->hdr);
+            TracePacket(RangerNwkPacketRecord::SEND, messageIter->hdr);
 
             Ptr<Packet> p = Create<Packet>(0);
             p->AddHeader(messageIter->hdr);
@@ -451,6 +595,22 @@ RangerRoutingProtocol::SendQueuedMessages() {
 void
 RangerRoutingProtocol::EnqueueMessage(const MessageHeaderElement payload, Time delay) {
     m_queuedMessages.push_back(payload);
+
+    // In event driven mode, arm the timer for the next point of the grid the
+    // periodic timer would have used. When now is itself a point of the grid,
+    // the periodic timer expiring now was scheduled one interval ago, so it
+    // runs after the event that queued the message, unless it already expired.
+    if (m_eventDrivenQueue && !m_queuedMessagesTimer.IsRunning() && IsInitialized()) {
+        int64_t period = m_queuedMessagesInterval.GetTimeStep();
+        int64_t offset = (Simulator::Now() - m_queuedMessagesOrigin).GetTimeStep();
+        int64_t steps = 0;
+        if (offset >= 0) {
+            bool expiresNow = offset % period == 0 && m_queuedMessagesLastExpire != Simulator::Now();
+            steps = expiresNow ? offset / period : offset / period + 1;
+        }
+        Time sendTime = m_queuedMessagesOrigin + TimeStep(steps * period);
+        m_queuedMessagesTimer.Schedule(sendTime - Simulator::Now());
+    }
 }
 
 void
@@ -485,9 +645,11 @@ RangerRoutingProtocol::SendNodeInfo() {
 void
 RangerRoutingProtocol::NodeInfoTimerExpire() {
     m_nbList.RefreshNeighborNodeStatus();
-    std::ostringstream oss;
-    PrintNeighborList(oss);
-    NS_LOG_INFO(oss.str());
+    if (g_log.IsEnabled(ns3::LOG_INFO)) {
+        std::ostringstream oss;
+        PrintNeighborList(oss);
+        NS_LOG_INFO(oss.str());
+    }
 
     SendNodeInfo();
     m_nodeInfoTimer.Schedule(m_nodeInfoInterval);
@@ -36,6 +36,8 @@
 #include "ns3/timer.h"
 #include "ns3/traced-callback.h"
 
+#include <type_traits>
+
 namespace ns3
 {
 
@@ -44,6 +46,33 @@ namespace ns3
 typedef Callback<void, ranger::McpsDataRequestParams, Ptr<Packet>> RangerRoutingProtocolSendCallback;
 typedef Callback<void, Ipv4Address, Ipv4Address, uint8_t, Time> RangerRoutingProtocolReceiveTraceCallback;
 typedef Callback<void, Ipv4Address, Ipv4Address, uint8_t, Time> RangerRoutingProtocolSendTraceCallback;
+/**
+ * Compact record of a NWK message sent or received, as reported by the
+ * PacketTrace trace source of RangerRoutingProtocol. It is a plain fixed
+ * size struct so that sinks can store it as is.
+ */
+struct RangerNwkPacketRecord
+{
+    enum Direction : uint8_t
+    {
+        SEND = 0,
+        RECEIVE = 1,
+    };
+
+    uint8_t direction;   //!< Direction
+    uint8_t messageType; //!< MessageHeader::MessageType
+    uint8_t seq;         //!< AudioSeq of an audio message, 0 otherwise
+    uint8_t assignNum;   //!< AssignNum of an audio message, number of links of a NodeInfo
+    uint32_t node;       //!< main address of the node that traces the message
+    uint32_t src;        //!< NWK source address, i.e. the previous hop
+    uint32_t origin;     //!< address of the node that created the message
+    int64_t time;        //!< Simulator::Now(), in time steps
+};
+
+static_assert(std::is_trivially_copyable<RangerNwkPacketRecord>::value &&
+                  sizeof(RangerNwkPacketRecord) == 24,
+              "RangerNwkPacketRecord must stay a packed POD record");
+
 typedef struct MessageHeaderElement {
     ranger::McpsDataRequestParams params;
     MessageHeader hdr;
@@ -77,6 +106,22 @@ class RangerRoutingProtocol : public Object
      */
     static TypeId GetTypeId();
 
+    /**
+     * TracedCallback signature for NWK message records.
+     *
+     * \param [in] record the message record.
+     */
+    typedef void (*PacketTracedCallback)(const RangerNwkPacketRecord& record);
+
+    /**
+     * Assign a fixed random variable stream number to the random variables
+     * used by this model. Return the number of streams that have been assigned.
+     *
+     * \param stream first stream index to use
+     * \return the number of stream indices assigned by this model
+     */
+    int64_t AssignStreams(int64_t stream);
+
   protected:
     void DoInitialize() override;
     void DoDispose() override;
@@ -148,11 +193,32 @@ class RangerRoutingProtocol : public Object
 
     bool isForwardNode(const MessageHeader::AudioData& assignHdr);       // check if the node is a forward node
     bool isForwardJudge_Hivemesh(const MessageHeader& hdr);
+
+    uint64_t GetAssignCacheHits() const {
+        return m_nbList.GetAssignCacheHits();
+    }
+    uint64_t GetAssignCacheMisses() const {
+        return m_nbList.GetAssignCacheMisses();
+    }
   private:
+    bool JudgeForward_Hivemesh(const MessageHeader& hdr);
+
+    // isForwardJudge_Hivemesh() results by (previous hop, origin), valid while
+    // m_forwardJudgeCacheVersion is the version of m_nbList
+    std::unordered_map<uint64_t, bool> m_forwardJudgeCache;
+    uint64_t m_forwardJudgeCacheVersion;
+    uint64_t m_forwardJudgeCacheHits;
+    uint64_t m_forwardJudgeCacheMisses;
+
+
     // A list of pending messages which are buffered awaiting for being sent.
     QueueMessageList m_queuedMessages;
     Time m_queuedMessagesInterval;
     Timer m_queuedMessagesTimer; //!< timer for throttling outgoing messages
+    bool m_eventDrivenQueue;     //!< only arm m_queuedMessagesTimer when a message is queued
+    Time m_queuedMessagesOrigin; //!< first expiry of m_queuedMessagesTimer, anchors its grid
+    Time m_queuedMessagesLastExpire; //!< last expiry of m_queuedMessagesTimer
+    Ptr<UniformRandomVariable> m_randomTime; //!< jitter of the first expiry of the timers
 
     /**
      * \brief Sends a message from the queuedMessages list.
@@ -166,6 +232,27 @@ class RangerRoutingProtocol : public Object
     RangerRoutingProtocolReceiveTraceCallback m_receiveTraceCallback;
     RangerRoutingProtocolSendTraceCallback m_sendTraceCallback;
 
+    /**
+     * The trace source fired for every NWK message sent, and for every
+     * message received that is not a duplicate.
+     */
+    TracedCallback<const RangerNwkPacketRecord&> m_packetTrace;
+
+    /**
+     * Fire m_packetTrace for a message, if a sink is connected.
+     *
+     * \param direction RangerNwkPacketRecord::SEND or RangerNwkPacketRecord::RECEIVE
+     * \param hdr the message header
+     */
+    void TracePacket(RangerNwkPacketRecord::Direction direction, const MessageHeader& hdr);
+    /**
+     * Fire m_packetTrace for a received message read in place.
+     *
+     * \param direction RangerNwkPacketRecord::RECEIVE
+     * \param hdr the message header
+     */
+    void TracePacket(RangerNwkPacketRecord::Direction direction, const MessageHeaderView& hdr);
+
   public:
     void SetReceiveTraceCallback(RangerRoutingProtocolReceiveTraceCallback cb);
     void SetSendTraceCallback(RangerRoutingProtocolSendTraceCallback cb);
@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2011 The Boeing Company
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/lr-wpan-spectrum-value-helper.h>
+#include <ns3/node.h>
+#include <ns3/pointer.h>
+#include <ns3/propagation-delay-model.h>
+#include <ns3/ranger-audio-application.h>
+#include <ns3/ranger-net-device.h>
+#include <ns3/simulator.h>
+#include <ns3/single-model-spectrum-channel.h>
+#include <ns3/string.h>
+#include <ns3/test.h>
+#include <ns3/uinteger.h>
+
+#include <fstream>
+#include <utility>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup ranger-test
+ * \ingroup tests
+ *
+ * Base of the RangerAudioApp tests: runs one source on a single node and
+ * records the time and size of every frame it requests.
+ */
+class RangerAudioAppTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     * \param name the test case name
+     */
+    RangerAudioAppTestCase(std::string name);
+
+  protected:
+    /**
+     * Run a source from 1 s to the stop time and record its frames.
+     * \param app the source, with its attributes set
+     * \param stop the stop time of the source
+     */
+    void RunSource(Ptr<RangerAudioApp> app, Time stop);
+
+    /** The time and size of the frames requested. */
+    std::vector<std::pair<Time, uint32_t>> m_frames;
+
+  private:
+    /**
+     * Tx trace sink.
+     * \param size the frame size
+     */
+    void Tx(uint32_t size);
+};
+
+RangerAudioAppTestCase::RangerAudioAppTestCase(std::string name)
+    : TestCase(name)
+{
+}
+
+void
+RangerAudioAppTestCase::Tx(uint32_t size)
+{
+    m_frames.emplace_back(Simulator::Now(), size);
+}
+
+void
+RangerAudioAppTestCase::RunSource(Ptr<RangerAudioApp> app, Time stop)
+{
+    m_frames.clear();
+    Ptr<SingleModelSpectrumChannel> channel = CreateObject<SingleModelSpectrumChannel>();
+    channel->SetPropagationDelayModel(CreateObject<ConstantSpeedPropagationDelayModel>());
+
+    Ptr<Node> node = CreateObject<Node>();
+    Ptr<RangerNetDevice> dev = CreateObject<RangerNetDevice>();
+    dev->SetAddress(Ipv4Address("10.0.0.1"));
+    dev->SetChannel(channel);
+    LrWpanSpectrumValueHelper svh;
+    dev->GetPhy()->SetTxPowerSpectralDensity(svh.CreateTxPowerSpectralDensity(30, 11));
+    node->AddDevice(dev);
+
+    app->TraceConnectWithoutContext("Tx", MakeCallback(&RangerAudioAppTestCase::Tx, this));
+    app->SetStartTime(Seconds(1));
+    app->SetStopTime(stop);
+    node->AddApplication(app);
+
+    Simulator::Stop(stop + Seconds(1));
+    Simulator::Run();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup ranger-test
+ * \ingroup tests
+ *
+ * Check the frames of the OnOff mode with constant talk spurts and silences,
+ * and that only this mode creates random variables.
+ */
+class RangerAudioAppOnOffTestCase : public RangerAudioAppTestCase
+{
+  public:
+    RangerAudioAppOnOffTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+RangerAudioAppOnOffTestCase::RangerAudioAppOnOffTestCase()
+    : RangerAudioAppTestCase("Frames of the OnOff mode of RangerAudioApp")
+{
+}
+
+void
+RangerAudioAppOnOffTestCase::DoRun()
+{
+    Ptr<RangerAudioApp> cbr = CreateObject<RangerAudioApp>();
+    PointerValue onTime;
+    cbr->GetAttribute("OnTime", onTime);
+    NS_TEST_ASSERT_MSG_EQ(onTime.Get<RandomVariableStream>(), nullptr, "OnTime created in Cbr");
+    NS_TEST_ASSERT_MSG_EQ(cbr->AssignStreams(0), 0, "streams assigned in Cbr mode");
+
+    // talk spurts of 50 ms and silences of 100 ms, a frame every 10 ms
+    Ptr<RangerAudioApp> app = CreateObject<RangerAudioApp>();
+    app->SetAttribute("Mode", StringValue("OnOff"));
+    app->SetAttribute("Interval", TimeValue(MilliSeconds(10)));
+    app->SetAttribute("AudioSize", UintegerValue(60));
+    app->SetAttribute("OnTime", StringValue("ns3::ConstantRandomVariable[Constant=0.05]"));
+    app->SetAttribute("OffTime", StringValue("ns3::ConstantRandomVariable[Constant=0.1]"));
+    NS_TEST_ASSERT_MSG_EQ(app->AssignStreams(0), 2, "streams assigned in OnOff mode");
+    RunSource(app, MilliSeconds(1400));
+
+    // spurts starting at 1000, 1150 and 1300 ms
+    NS_TEST_ASSERT_MSG_EQ(m_frames.size(), 15, "frame count");
+    for (uint32_t i = 0; i < m_frames.size(); i++)
+    {
+        Time expected = MilliSeconds(1000 + 150 * (i / 5) + 10 * (i % 5));
+        NS_TEST_EXPECT_MSG_EQ(m_frames[i].first, expected, "time of frame " << i);
+        NS_TEST_EXPECT_MSG_EQ(m_frames[i].second, 60, "size of frame " << i);
+    }
+    NS_TEST_EXPECT_MSG_EQ(app->GetSentFrames(), 15, "frames counted by the source");
+}
+
+/**
+ * \ingroup ranger-test
+ * \ingroup tests
+ *
+ * Check the frames of the Trace mode, including the loop of the trace.
+ */
+class RangerAudioAppTraceTestCase : public RangerAudioAppTestCase
+{
+  public:
+    RangerAudioAppTraceTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+RangerAudioAppTraceTestCase::RangerAudioAppTraceTestCase()
+    : RangerAudioAppTestCase("Frames of the Trace mode of RangerAudioApp")
+{
+}
+
+void
+RangerAudioAppTraceTestCase::DoRun()
+{
+    std::string filename = CreateTempDirFilename("ranger-audio-trace.txt");
+    std::ofstream trace(filename);
+    trace << "# interval (ms) and size (bytes) of each frame\n"
+          << "10 20\n"
+          << "\n"
+          << "30 40 # second frame\n";
+    trace.close();
+
+    Ptr<RangerAudioApp> app = CreateObject<RangerAudioApp>();
+    app->SetAttribute("Mode", StringValue("Trace"));
+    app->SetAttribute("TraceFile", StringValue(filename));
+    NS_TEST_ASSERT_MSG_EQ(app->AssignStreams(0), 0, "streams assigned in Trace mode");
+    RunSource(app, MilliSeconds(1085));
+
+    const std::vector<std::pair<Time, uint32_t>> expected = {{MilliSeconds(1000), 20},
+                                                             {MilliSeconds(1010), 40},
+                                                             {MilliSeconds(1040), 20},
+                                                             {MilliSeconds(1050), 40},
+                                                             {MilliSeconds(1080), 20}};
+    NS_TEST_ASSERT_MSG_EQ(m_frames.size(), expected.size(), "frame count");
+    for (uint32_t i = 0; i < m_frames.size(); i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(m_frames[i].first, expected[i].first, "time of frame " << i);
+        NS_TEST_EXPECT_MSG_EQ(m_frames[i].second, expected[i].second, "size of frame " << i);
+    }
+}
+
+/**
+ * \ingroup ranger-test
+ * \ingroup tests
+ *
+ * RangerAudioApp TestSuite
+ */
+class RangerAudioAppTestSuite : public TestSuite
+{
+  public:
+    RangerAudioAppTestSuite();
+};
+
+RangerAudioAppTestSuite::RangerAudioAppTestSuite()
+    : TestSuite("ranger-audio-application", UNIT)
+{
+    AddTestCase(new RangerAudioAppOnOffTestCase, TestCase::QUICK);
+    AddTestCase(new RangerAudioAppTraceTestCase, TestCase::QUICK);
+}
+
+static RangerAudioAppTestSuite
+    g_rangerAudioAppTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2011 The Boeing Company
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/ranger-mac.h>
+#include <ns3/rng-seed-manager.h>
+#include <ns3/test.h>
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <random>
+
+using namespace ns3;
+
+/**
+ * \ingroup ranger-test
+ * \ingroup tests
+ *
+ * Checks RangerMacDuplicateFilter against a scan of the last frames of each
+ * source, the way RangerMac used to filter over all sources.
+ */
+class RangerDuplicateFilterTestCase : public TestCase
+{
+  public:
+    RangerDuplicateFilterTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+RangerDuplicateFilterTestCase::RangerDuplicateFilterTestCase()
+    : TestCase("Check the duplicate filter against a per source FIFO scan")
+{
+}
+
+void
+RangerDuplicateFilterTestCase::DoRun()
+{
+    RangerMacDuplicateFilter filter(4);
+    Ipv4Address a("10.0.0.1");
+    Ipv4Address b("10.0.0.2");
+    auto data = RangerMacHeader::RANGER_MAC_BROADCAST;
+    auto ack = RangerMacHeader::RANGER_MAC_ACK;
+
+    NS_TEST_EXPECT_MSG_EQ(filter.IsDuplicate(data, a, 7), false, "first frame");
+    NS_TEST_EXPECT_MSG_EQ(filter.IsDuplicate(data, a, 7), true, "same frame again");
+    NS_TEST_EXPECT_MSG_EQ(filter.IsDuplicate(data, b, 7), false, "other source");
+    NS_TEST_EXPECT_MSG_EQ(filter.IsDuplicate(ack, a, 7), false, "other type");
+
+    // the oldest sequence number leaves the window, also across the wrap
+    for (uint8_t seq : {254, 255, 0})
+    {
+        NS_TEST_EXPECT_MSG_EQ(filter.IsDuplicate(data, a, seq), false, "new frame");
+    }
+    NS_TEST_EXPECT_MSG_EQ(filter.IsDuplicate(data, a, 7), true, "still in the window");
+    NS_TEST_EXPECT_MSG_EQ(filter.IsDuplicate(data, a, 1), false, "new frame");
+    NS_TEST_EXPECT_MSG_EQ(filter.IsDuplicate(data, a, 7), false, "expired");
+
+    filter.SetDepth(4);
+    NS_TEST_EXPECT_MSG_EQ(filter.IsDuplicate(data, b, 7), false, "SetDepth forgets");
+
+    // random sequence numbers, few sources, so that duplicates are common
+    std::mt19937 rng(RngSeedManager::GetSeed());
+    for (uint32_t depth : {1, 50, 256})
+    {
+        filter.SetDepth(depth);
+        std::map<std::pair<int, uint32_t>, std::deque<uint8_t>> reference;
+        std::uniform_int_distribution<uint32_t> src(1, 3);
+        std::uniform_int_distribution<int> type(0, 2);
+        std::uniform_int_distribution<uint32_t> seq(0, depth == 1 ? 3 : 255);
+        for (int i = 0; i < 20000; i++)
+        {
+            Ipv4Address addr(src(rng));
+            auto t = static_cast<RangerMacHeader::RangerMacType>(type(rng));
+            auto s = static_cast<uint8_t>(seq(rng));
+
+            auto& rxed = reference[{t, addr.Get()}];
+            bool expected = std::find(rxed.begin(), rxed.end(), s) != rxed.end();
+            if (!expected)
+            {
+                rxed.push_front(s);
+                if (rxed.size() > depth)
+                {
+                    rxed.pop_back();
+                }
+            }
+            NS_TEST_ASSERT_MSG_EQ(filter.IsDuplicate(t, addr, s),
+                                  expected,
+                                  "depth " << depth << " step " << i);
+        }
+    }
+}
+
+/**
+ * \ingroup ranger-test
+ * \ingroup tests
+ *
+ * RangerMacDuplicateFilter TestSuite
+ */
+class RangerDuplicateFilterTestSuite : public TestSuite
+{
+  public:
+    RangerDuplicateFilterTestSuite();
+};
+
+RangerDuplicateFilterTestSuite::RangerDuplicateFilterTestSuite()
+    : TestSuite("ranger-duplicate-filter", UNIT)
+{
+    AddTestCase(new RangerDuplicateFilterTestCase, TestCase::QUICK);
+}
+
+static RangerDuplicateFilterTestSuite
+    g_rangerDuplicateFilterTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2011 The Boeing Company
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/boolean.h>
+#include <ns3/double.h>
+#include <ns3/lr-wpan-spectrum-value-helper.h>
+#include <ns3/mobility-helper.h>
+#include <ns3/node-container.h>
+#include <ns3/propagation-delay-model.h>
+#include <ns3/propagation-loss-model.h>
+#include <ns3/ranger-audio-application.h>
+#include <ns3/ranger-net-device.h>
+#include <ns3/simulator.h>
+#include <ns3/single-model-spectrum-channel.h>
+#include <ns3/test.h>
+#include <ns3/uinteger.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ns3;
+
+/**
+ * \ingroup ranger-test
+ * \ingroup tests
+ *
+ * Check that the event driven Tx queue checks of RangerMac and
+ * RangerRoutingProtocol give the same NWK traces, bit for bit, as the
+ * periodic ones, when several audio sources start at the same instant.
+ *
+ * Each mode runs in its own child process, so that both take the same random
+ * streams, and reports the number of NWK records and an FNV-1a digest of them.
+ */
+class RangerEventDrivenQueueTestCase : public TestCase
+{
+  public:
+    RangerEventDrivenQueueTestCase();
+
+  private:
+    void DoRun() override;
+
+    /** Result of a run, sent from the child process. */
+    struct Result
+    {
+        uint64_t records;       //!< NWK records traced
+        uint64_t audioReceives; //!< audio messages received
+        uint64_t digest;        //!< digest of the records
+    };
+
+    /**
+     * Run the scenario in a child process.
+     * \param eventDriven use the event driven queue checks
+     * \return the result of the run
+     */
+    Result RunInChild(bool eventDriven);
+
+    /**
+     * Run the scenario.
+     * \param eventDriven use the event driven queue checks
+     */
+    void RunScenario(bool eventDriven);
+
+    /**
+     * PacketTrace sink.
+     * \param record the NWK record
+     */
+    void Record(const RangerNwkPacketRecord& record);
+
+    Result m_result; //!< result of the run of this process
+};
+
+RangerEventDrivenQueueTestCase::RangerEventDrivenQueueTestCase()
+    : TestCase("Periodic and event driven queue checks with simultaneous starts")
+{
+}
+
+void
+RangerEventDrivenQueueTestCase::Record(const RangerNwkPacketRecord& record)
+{
+    m_result.records++;
+    if (record.direction == RangerNwkPacketRecord::RECEIVE &&
+        record.messageType == MessageHeader::AUDIODATA_MESSAGE)
+    {
+        m_result.audioReceives++;
+    }
+    const auto bytes = reinterpret_cast<const uint8_t*>(&record);
+    for (std::size_t i = 0; i < sizeof(record); i++)
+    {
+        m_result.digest ^= bytes[i];
+        m_result.digest *= 1099511628211ULL;
+    }
+}
+
+void
+RangerEventDrivenQueueTestCase::RunScenario(bool eventDriven)
+{
+    const uint32_t nodeCnt = 6;
+    NodeContainer nodes;
+    nodes.Create(nodeCnt);
+    MobilityHelper mobility;
+    mobility.SetPositionAllocator("ns3::GridPositionAllocator",
+                                  "DeltaX",
+                                  DoubleValue(40),
+                                  "DeltaY",
+                                  DoubleValue(40),
+                                  "GridWidth",
+                                  UintegerValue(3));
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    mobility.Install(nodes);
+
+    Ptr<SingleModelSpectrumChannel> channel = CreateObject<SingleModelSpectrumChannel>();
+    channel->AddPropagationLossModel(CreateObject<LogDistancePropagationLossModel>());
+    channel->SetPropagationDelayModel(CreateObject<ConstantSpeedPropagationDelayModel>());
+
+    LrWpanSpectrumValueHelper svh;
+    for (uint32_t i = 0; i < nodeCnt; i++)
+    {
+        Ptr<RangerNetDevice> dev = CreateObject<RangerNetDevice>();
+        dev->SetAddress(Ipv4Address(i | 0x0a000000));
+        dev->SetChannel(channel);
+        dev->GetPhy()->SetTxPowerSpectralDensity(svh.CreateTxPowerSpectralDensity(30, 11));
+        dev->GetMac()->SetAttribute("EventDrivenQueue", BooleanValue(eventDriven));
+        dev->GetRoutingProtocol()->SetAttribute("EventDrivenQueue", BooleanValue(eventDriven));
+        dev->GetRoutingProtocol()->TraceConnectWithoutContext(
+            "PacketTrace",
+            MakeCallback(&RangerEventDrivenQueueTestCase::Record, this));
+        nodes.Get(i)->AddDevice(dev);
+    }
+
+    // three sources starting at the same instant, after the neighbor discovery
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        Ptr<RangerAudioApp> app = CreateObject<RangerAudioApp>();
+        app->SetAttribute("Interval", TimeValue(MilliSeconds(100)));
+        app->SetStartTime(Seconds(3));
+        nodes.Get(2 * i)->AddApplication(app);
+    }
+
+    Simulator::Stop(Seconds(6));
+    Simulator::Run();
+    Simulator::Destroy();
+}
+
+RangerEventDrivenQueueTestCase::Result
+RangerEventDrivenQueueTestCase::RunInChild(bool eventDriven)
+{
+    int fds[2];
+    NS_ABORT_MSG_IF(pipe(fds) != 0, "pipe() failed");
+    pid_t pid = fork();
+    NS_ABORT_MSG_IF(pid < 0, "fork() failed");
+    if (pid == 0)
+    {
+        close(fds[0]);
+        m_result = Result{0, 0, 14695981039346656037ULL};
+        RunScenario(eventDriven);
+        ssize_t written = write(fds[1], &m_result, sizeof(m_result));
+        _exit(written == sizeof(m_result) ? 0 : 1);
+    }
+    close(fds[1]);
+    Result result{};
+    ssize_t got = read(fds[0], &result, sizeof(result));
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    NS_ABORT_MSG_IF(got != sizeof(result) || !WIFEXITED(status) || WEXITSTATUS(status) != 0,
+                    "child process of the " << (eventDriven ? "event driven" : "periodic")
+                                            << " run failed");
+    return result;
+}
+
+void
+RangerEventDrivenQueueTestCase::DoRun()
+{
+    Result periodic = RunInChild(false);
+    Result eventDriven = RunInChild(true);
+    NS_TEST_ASSERT_MSG_GT(periodic.audioReceives, 0, "no audio message received");
+    NS_TEST_EXPECT_MSG_EQ(eventDriven.records, periodic.records, "number of NWK records");
+    NS_TEST_EXPECT_MSG_EQ(eventDriven.audioReceives,
+                          periodic.audioReceives,
+                          "number of audio receptions");
+    NS_TEST_EXPECT_MSG_EQ(eventDriven.digest, periodic.digest, "digest of the NWK records");
+}
+
+/**
+ * \ingroup ranger-test
+ * \ingroup tests
+ *
+ * Event driven queue TestSuite
+ */
+class RangerEventDrivenQueueTestSuite : public TestSuite
+{
+  public:
+    RangerEventDrivenQueueTestSuite();
+};
+
+RangerEventDrivenQueueTestSuite::RangerEventDrivenQueueTestSuite()
+    : TestSuite("ranger-event-driven-queue", UNIT)
+{
+    AddTestCase(new RangerEventDrivenQueueTestCase, TestCase::QUICK);
+}
+
+static RangerEventDrivenQueueTestSuite
+    g_rangerEventDrivenQueueTestSuite; //!< Static variable for test initialization
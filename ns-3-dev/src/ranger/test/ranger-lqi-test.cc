@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2011 The Boeing Company
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/ranger-routing-nblist.h>
+#include <ns3/rng-seed-manager.h>
+#include <ns3/test.h>
+
+#include <random>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup ranger-test
+ * \ingroup tests
+ *
+ * The ring buffer scoring that RangerLqiWindow replaces, kept as the reference.
+ */
+class ReferenceReceiveRateBuffer
+{
+  public:
+    explicit ReferenceReceiveRateBuffer(int capacity)
+        : buffer(capacity, false),
+          capacity(capacity)
+    {
+    }
+
+    void insert(bool isReceive)
+    {
+        buffer[head] = isReceive;
+        head = (head + 1) % capacity;
+        if (head == 0 && !isFull)
+        {
+            isFull = true;
+        }
+    }
+
+    bool isBufferFull() const
+    {
+        return isFull;
+    }
+
+    uint8_t calLqi() const
+    {
+        uint8_t total_weight = 0;
+        uint8_t lqi_cal = 0;
+
+        for (int j = 0; j < capacity; j++)
+        {
+            int index = head - 1 - j;
+            if (index < 0)
+            {
+                index += capacity;
+            }
+
+            if (j == capacity - 1)
+            {
+                if (buffer[index] == false)
+                {
+                    lqi_cal += 1.0;
+                }
+                total_weight += 1.0;
+            }
+            else
+            {
+                if (buffer[index] == false)
+                {
+                    int prev_index = index - 1;
+                    if (prev_index < 0)
+                    {
+                        prev_index += capacity;
+                    }
+                    if (buffer[prev_index] == false)
+                    {
+                        lqi_cal += 2.0;
+                        total_weight += 2.0;
+                    }
+                    else
+                    {
+                        lqi_cal += 1.0;
+                        total_weight += 1.0;
+                    }
+                }
+                else
+                {
+                    total_weight += 1.0;
+                }
+            }
+        }
+
+        return (uint8_t)((1.0 - ((float)lqi_cal / (float)total_weight)) * (float)255);
+    }
+
+  private:
+    std::vector<bool> buffer;
+    int head = 0;
+    bool isFull = false;
+    int capacity;
+};
+
+/**
+ * \ingroup ranger-test
+ * \ingroup tests
+ *
+ * Check that RangerLqiWindow gives the LQI of the reference ring buffer after
+ * every insertion: exhaustively over all the reception sequences that fill the
+ * default window and a bit more, and over long random sequences for larger
+ * windows.
+ */
+class RangerLqiWindowTestCase : public TestCase
+{
+  public:
+    RangerLqiWindowTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Feed the same sequence to a RangerLqiWindow and to the reference.
+     * \param sequence the receptions, true for a received NodeInfo
+     */
+    template <uint32_t Window>
+    void CheckSequence(const std::vector<bool>& sequence);
+};
+
+RangerLqiWindowTestCase::RangerLqiWindowTestCase()
+    : TestCase("LQI of RangerLqiWindow against the ring buffer scoring")
+{
+}
+
+template <uint32_t Window>
+void
+RangerLqiWindowTestCase::CheckSequence(const std::vector<bool>& sequence)
+{
+    RangerLqiWindow<Window> window;
+    ReferenceReceiveRateBuffer reference(Window);
+    NS_TEST_ASSERT_MSG_EQ(+window.calLqi(), +reference.calLqi(), "LQI of an empty window");
+    for (std::size_t i = 0; i < sequence.size(); i++)
+    {
+        window.insert(sequence[i]);
+        reference.insert(sequence[i]);
+        NS_TEST_ASSERT_MSG_EQ(+window.calLqi(),
+                              +reference.calLqi(),
+                              "LQI after " << i + 1 << " insertions, window " << Window);
+        NS_TEST_ASSERT_MSG_EQ(window.isBufferFull(),
+                              reference.isBufferFull(),
+                              "fill state after " << i + 1 << " insertions, window " << Window);
+    }
+}
+
+void
+RangerLqiWindowTestCase::DoRun()
+{
+    // every sequence of up to MAX_NODEINFO_RECEIVE_RATE_BUFFER + 2 receptions
+    const uint32_t maxLength = MAX_NODEINFO_RECEIVE_RATE_BUFFER + 2;
+    for (uint32_t length = 0; length <= maxLength; length++)
+    {
+        for (uint32_t bits = 0; bits < (1U << length); bits++)
+        {
+            std::vector<bool> sequence(length);
+            for (uint32_t i = 0; i < length; i++)
+            {
+                sequence[i] = (bits >> i) & 1;
+            }
+            CheckSequence<MAX_NODEINFO_RECEIVE_RATE_BUFFER>(sequence);
+        }
+    }
+
+    // long random sequences, with bursts of losses
+    std::mt19937 rng(RngSeedManager::GetSeed());
+    for (double lossRate : {0.1, 0.5, 0.9})
+    {
+        std::bernoulli_distribution received(1.0 - lossRate);
+        std::vector<bool> sequence(2000);
+        for (std::size_t i = 0; i < sequence.size(); i++)
+        {
+            sequence[i] = received(rng);
+        }
+        CheckSequence<2>(sequence);
+        CheckSequence<10>(sequence);
+        CheckSequence<16>(sequence);
+        CheckSequence<17>(sequence);
+        CheckSequence<32>(sequence);
+    }
+}
+
+/**
+ * \ingroup ranger-test
+ * \ingroup tests
+ *
+ * RangerLqiWindow TestSuite
+ */
+class RangerLqiTestSuite : public TestSuite
+{
+  public:
+    RangerLqiTestSuite();
+};
+
+RangerLqiTestSuite::RangerLqiTestSuite()
+    : TestSuite("ranger-lqi", UNIT)
+{
+    AddTestCase(new RangerLqiWindowTestCase, TestCase::QUICK);
+}
+
+static RangerLqiTestSuite g_rangerLqiTestSuite; //!< Static variable for test initialization
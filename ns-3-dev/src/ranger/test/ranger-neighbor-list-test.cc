@@ -0,0 +1,456 @@
+/*
+ * Copyright (c) 2011 The Boeing Company
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/ranger-routing-nblist.h>
+#include <ns3/simulator.h>
+#include <ns3/test.h>
+
+#include <algorithm>
+#include <vector>
+
+using namespace ns3;
+
+namespace
+{
+
+/**
+ * \param addresses the two-hop neighbors, with their link status
+ * \return a NodeInfo advertising them
+ */
+MessageHeader::NodeInfo
+MakeNodeInfo(const std::vector<std::pair<Ipv4Address, uint8_t>>& addresses)
+{
+    MessageHeader::NodeInfo nodeInfo;
+    nodeInfo.linkNumber = addresses.size();
+    for (const auto& address : addresses)
+    {
+        MessageHeader::NodeInfo::LinkMessage link;
+        link.neighborAddresses = address.first;
+        link.linkStatus = address.second;
+        nodeInfo.linkMessages.push_back(link);
+    }
+    return nodeInfo;
+}
+
+/**
+ * \param addresses the two-hop neighbors, all stable
+ * \return a NodeInfo advertising them
+ */
+MessageHeader::NodeInfo
+MakeNodeInfo(const std::vector<Ipv4Address>& addresses)
+{
+    std::vector<std::pair<Ipv4Address, uint8_t>> links;
+    for (const auto& address : addresses)
+    {
+        links.emplace_back(address, NeighborStatus::STATUS_STABLE);
+    }
+    return MakeNodeInfo(links);
+}
+
+/**
+ * Let the simulation time run for a while.
+ * \param duration the time to advance
+ */
+void
+Advance(Time duration)
+{
+    Simulator::Stop(duration);
+    Simulator::Run();
+}
+
+/**
+ * \param nb the neighbor list
+ * \return the assign forward nodes it selects for a source packet
+ */
+std::vector<Ipv4Address>
+SelectSource(RangerNeighborList& nb)
+{
+    MessageHeader::AudioData header;
+    nb.GetSourceAssignNeighbor(header);
+    std::vector<Ipv4Address> assign;
+    for (uint32_t i = 0; i < header.AssignNeighbor.size(); i++)
+    {
+        assign.push_back(header.AssignNeighbor[i]);
+    }
+    return assign;
+}
+
+} // namespace
+
+/**
+ * \ingroup ranger-test
+ * \ingroup tests
+ *
+ * Checks the lookups of RangerNeighborList with more neighbors and two-hop
+ * neighbors than a byte can count, while the two-hop links move in their
+ * arena and neighbors are removed.
+ */
+class RangerNeighborListLookupTestCase : public TestCase
+{
+  public:
+    RangerNeighborListLookupTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Check every lookup of the neighbor list.
+     * \param nb the neighbor list
+     * \param present whether each neighbor is still in the list
+     * \param links the two-hop neighbors advertised by each neighbor
+     */
+    void CheckLookups(const RangerNeighborList& nb,
+                      const std::vector<bool>& present,
+                      const std::vector<std::vector<Ipv4Address>>& links);
+};
+
+RangerNeighborListLookupTestCase::RangerNeighborListLookupTestCase()
+    : TestCase("Check the neighbor and two-hop lookups above 255 entries")
+{
+}
+
+void
+RangerNeighborListLookupTestCase::CheckLookups(const RangerNeighborList& nb,
+                                               const std::vector<bool>& present,
+                                               const std::vector<std::vector<Ipv4Address>>& links)
+{
+    uint32_t expectedIndex = 0;
+    for (uint32_t i = 0; i < present.size(); i++)
+    {
+        uint32_t index = 0;
+        bool found = nb.FindNeighbor(Ipv4Address(0x0a010001 + i), index);
+        NS_TEST_ASSERT_MSG_EQ(found, present[i], "neighbor " << i);
+        if (!found)
+        {
+            continue;
+        }
+        // the neighbors keep the order they were met in
+        NS_TEST_ASSERT_MSG_EQ(index, expectedIndex, "index of neighbor " << i);
+        expectedIndex++;
+
+        TwoHopLinkView view = nb.GetTwoHopList(index);
+        NS_TEST_ASSERT_MSG_EQ(view.size(), links[i].size(), "two-hop links of neighbor " << i);
+        for (uint32_t k = 0; k < view.size(); k++)
+        {
+            NS_TEST_ASSERT_MSG_EQ(view[k].neighborAddresses,
+                                  links[i][k],
+                                  "two-hop link " << k << " of neighbor " << i);
+        }
+    }
+    NS_TEST_ASSERT_MSG_EQ(nb.GetNeighborCount(), expectedIndex, "neighbor count");
+}
+
+void
+RangerNeighborListLookupTestCase::DoRun()
+{
+    const uint32_t count = 300;
+    const Ipv4Address shared("10.3.0.1");
+    RangerNeighborList nb(Seconds(1), Seconds(1));
+    nb.SetMainAddress(Ipv4Address("10.0.0.1"));
+
+    // each neighbor reaches a two-hop neighbor of its own, and a shared one
+    std::vector<bool> present(count, true);
+    std::vector<std::vector<Ipv4Address>> links(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        links[i] = {Ipv4Address(0x0a020001 + i), shared};
+        nb.UpdateNeighborNodeStatus(Ipv4Address(0x0a010001 + i), MakeNodeInfo(links[i]));
+    }
+    CheckLookups(nb, present, links);
+    uint32_t index = 0;
+    NS_TEST_EXPECT_MSG_EQ(nb.FindNeighbor(shared, index), false, "a two-hop neighbor only");
+    NS_TEST_EXPECT_MSG_EQ(nb.FindNeighbor(Ipv4Address(0x0a010001 + count), index),
+                          false,
+                          "unknown neighbor");
+
+    // every neighbor is the only path to its own two-hop neighbor, but a
+    // single byte counts the assign forward nodes
+    MessageHeader::AudioData header;
+    nb.GetSourceAssignNeighbor(header);
+    NS_TEST_EXPECT_MSG_EQ((uint32_t)header.AssignNum, 255, "assign forward nodes");
+    NS_TEST_ASSERT_MSG_EQ(header.AssignNeighbor.size(),
+                          std::min<uint32_t>(255, MessageHeader::AudioData::MAX_ASSIGN),
+                          "assign forward nodes carried");
+    for (uint32_t i = 0; i < header.AssignNeighbor.size(); i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(header.AssignNeighbor[i],
+                              Ipv4Address(0x0a010001 + i),
+                              "assign forward node " << i);
+    }
+
+    // longer link lists no longer fit in place and move in the arena
+    for (uint32_t i = 0; i < count; i += 2)
+    {
+        links[i].push_back(Ipv4Address(0x0a020001 + count + i));
+        nb.UpdateNeighborNodeStatus(Ipv4Address(0x0a010001 + i), MakeNodeInfo(links[i]));
+    }
+    CheckLookups(nb, present, links);
+
+    // once stable, a NodeInfo counts all the neighbors up to 255
+    for (uint32_t period = 0; period < MAX_NODEINFO_RECEIVE_RATE_BUFFER; period++)
+    {
+        nb.RefreshNeighborNodeStatus();
+    }
+    MessageHeader::NodeInfo nodeInfo;
+    nb.GetNeighborNodeInfo(nodeInfo);
+    NS_TEST_EXPECT_MSG_EQ((uint32_t)nodeInfo.linkNumber, 255, "NodeInfo link number");
+    NS_TEST_EXPECT_MSG_EQ(nodeInfo.linkMessages.size(),
+                          MessageHeader::NodeInfo::MAX_LINKS,
+                          "NodeInfo links carried");
+
+    // every third neighbor falls silent until it is removed
+    for (uint32_t i = 0; i < count; i += 3)
+    {
+        present[i] = false;
+    }
+    for (uint32_t period = 0; period < MAX_NODEINFO_RECEIVE_RATE_BUFFER; period++)
+    {
+        Advance(Seconds(2));
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (present[i])
+            {
+                nb.UpdateNeighborNodeStatus(Ipv4Address(0x0a010001 + i),
+                                            MakeNodeInfo(links[i]));
+            }
+        }
+        nb.RefreshNeighborNodeStatus();
+    }
+    CheckLookups(nb, present, links);
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup ranger-test
+ * \ingroup tests
+ *
+ * Checks that the version of RangerNeighborList changes with the neighbors,
+ * their status, their two-hop links and the main address, and only then.
+ */
+class RangerNeighborListVersionTestCase : public TestCase
+{
+  public:
+    RangerNeighborListVersionTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+RangerNeighborListVersionTestCase::RangerNeighborListVersionTestCase()
+    : TestCase("Check the version bumps of the neighbor list")
+{
+}
+
+void
+RangerNeighborListVersionTestCase::DoRun()
+{
+    const Ipv4Address a("10.1.0.1");
+    const Ipv4Address b("10.1.0.2");
+    const Ipv4Address t("10.2.0.1");
+    RangerNeighborList nb(Seconds(1), Seconds(1));
+    nb.SetMainAddress(Ipv4Address("10.0.0.1"));
+
+    uint64_t version = nb.GetVersion();
+    nb.UpdateNeighborNodeStatus(a, MakeNodeInfo({t}));
+    NS_TEST_EXPECT_MSG_NE(nb.GetVersion(), version, "new neighbor");
+
+    version = nb.GetVersion();
+    nb.UpdateNeighborNodeStatus(a, MakeNodeInfo({t}));
+    NS_TEST_EXPECT_MSG_EQ(nb.GetVersion(), version, "same links");
+
+    nb.UpdateNeighborNodeStatus(a, MakeNodeInfo({{t, NeighborStatus::STATUS_UNSTABLE}}));
+    NS_TEST_EXPECT_MSG_NE(nb.GetVersion(), version, "link status change");
+
+    version = nb.GetVersion();
+    nb.UpdateNeighborNodeStatus(a, MakeNodeInfo({{t, NeighborStatus::STATUS_UNSTABLE}, {b, NeighborStatus::STATUS_NONE}}));
+    NS_TEST_EXPECT_MSG_NE(nb.GetVersion(), version, "new link");
+
+    version = nb.GetVersion();
+    nb.UpdateNeighborNodeStatus(a, MakeNodeInfo(std::vector<Ipv4Address>()));
+    NS_TEST_EXPECT_MSG_NE(nb.GetVersion(), version, "links withdrawn");
+
+    version = nb.GetVersion();
+    nb.SetMainAddress(Ipv4Address("10.0.0.2"));
+    NS_TEST_EXPECT_MSG_NE(nb.GetVersion(), version, "main address change");
+
+    // the version changes with the status of a neighbor, not with its LQI
+    uint32_t statusChanges = 0;
+    for (uint32_t period = 0; period < MAX_NODEINFO_RECEIVE_RATE_BUFFER; period++)
+    {
+        uint8_t status = nb.GetOneHopList()[0].linkStatus;
+        version = nb.GetVersion();
+        nb.RefreshNeighborNodeStatus();
+        bool changed = nb.GetOneHopList()[0].linkStatus != status;
+        NS_TEST_EXPECT_MSG_EQ((nb.GetVersion() != version),
+                              changed,
+                              "refresh " << period << ", status " << (uint32_t)status);
+        statusChanges += changed;
+    }
+    NS_TEST_EXPECT_MSG_EQ(statusChanges, 2, "none to unstable to stable");
+    NS_TEST_EXPECT_MSG_EQ((uint32_t)nb.GetOneHopList()[0].linkStatus,
+                          (uint32_t)NeighborStatus::STATUS_STABLE,
+                          "stable neighbor");
+
+    // a silent neighbor is removed
+    version = nb.GetVersion();
+    for (uint32_t period = 0; period < MAX_NODEINFO_RECEIVE_RATE_BUFFER; period++)
+    {
+        Advance(Seconds(2));
+        nb.RefreshNeighborNodeStatus();
+    }
+    NS_TEST_EXPECT_MSG_EQ(nb.isEmpty(), true, "silent neighbor removed");
+    NS_TEST_EXPECT_MSG_NE(nb.GetVersion(), version, "neighbor removed");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup ranger-test
+ * \ingroup tests
+ *
+ * Checks that the cached assign forward nodes are selected again after each
+ * kind of change of the neighbor list, and only then.
+ */
+class RangerNeighborListCacheTestCase : public TestCase
+{
+  public:
+    RangerNeighborListCacheTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Select the assign forward nodes of a source packet twice, the second
+     * selection coming from the cache.
+     * \param nb the neighbor list
+     * \param expected the expected assign forward nodes
+     * \param cached whether the first selection is expected from the cache
+     * \param step the step of the test
+     */
+    void CheckSelection(RangerNeighborList& nb,
+                        const std::vector<Ipv4Address>& expected,
+                        bool cached,
+                        const std::string& step);
+};
+
+RangerNeighborListCacheTestCase::RangerNeighborListCacheTestCase()
+    : TestCase("Check the cache of the assign forward nodes")
+{
+}
+
+void
+RangerNeighborListCacheTestCase::CheckSelection(RangerNeighborList& nb,
+                                                const std::vector<Ipv4Address>& expected,
+                                                bool cached,
+                                                const std::string& step)
+{
+    for (uint32_t call = 0; call < 2; call++)
+    {
+        uint64_t hits = nb.GetAssignCacheHits();
+        uint64_t misses = nb.GetAssignCacheMisses();
+        std::vector<Ipv4Address> assign = SelectSource(nb);
+        bool hit = call > 0 || cached;
+        NS_TEST_EXPECT_MSG_EQ(nb.GetAssignCacheHits(), hits + hit, step << ", call " << call);
+        NS_TEST_EXPECT_MSG_EQ(nb.GetAssignCacheMisses(),
+                              misses + !hit,
+                              step << ", call " << call);
+        NS_TEST_ASSERT_MSG_EQ(assign.size(), expected.size(), step << ", call " << call);
+        for (uint32_t i = 0; i < assign.size(); i++)
+        {
+            NS_TEST_EXPECT_MSG_EQ(assign[i], expected[i], step << ", call " << call);
+        }
+    }
+}
+
+void
+RangerNeighborListCacheTestCase::DoRun()
+{
+    const Ipv4Address self("10.0.0.1");
+    const Ipv4Address a("10.1.0.1");
+    const Ipv4Address b("10.1.0.2");
+    const Ipv4Address t1("10.2.0.1");
+    const Ipv4Address t2("10.2.0.2");
+    const Ipv4Address broadcast("255.255.255.255");
+    const uint8_t stable = NeighborStatus::STATUS_STABLE;
+    const uint8_t unstable = NeighborStatus::STATUS_UNSTABLE;
+    RangerNeighborList nb(Seconds(1), Seconds(1));
+    nb.SetMainAddress(self);
+
+    nb.UpdateNeighborNodeStatus(a, MakeNodeInfo({{t1, stable}}));
+    CheckSelection(nb, {a}, false, "single path");
+
+    // t1 reached through b as well, neither a nor b being a valid link yet
+    nb.UpdateNeighborNodeStatus(b, MakeNodeInfo({{t1, stable}}));
+    CheckSelection(nb, {broadcast}, false, "new neighbor");
+
+    nb.UpdateNeighborNodeStatus(b, MakeNodeInfo({{t2, stable}}));
+    CheckSelection(nb, {a, b}, false, "link change");
+    nb.UpdateNeighborNodeStatus(b, MakeNodeInfo({{t1, unstable}}));
+    CheckSelection(nb, {broadcast}, false, "link change back");
+
+    // the node itself is never a target
+    nb.SetMainAddress(t1);
+    CheckSelection(nb, {}, false, "main address change");
+    nb.SetMainAddress(self);
+    CheckSelection(nb, {broadcast}, false, "main address change back");
+
+    // a and b become unstable in the fifth period, and a gives the best link
+    for (uint32_t period = 0; period < 4; period++)
+    {
+        nb.RefreshNeighborNodeStatus();
+        CheckSelection(nb, {broadcast}, true, "LQI change");
+    }
+    nb.RefreshNeighborNodeStatus();
+    CheckSelection(nb, {a}, false, "status change");
+
+    // a falls silent: its status drops, then it is removed
+    for (uint32_t period = 0; period < MAX_NODEINFO_RECEIVE_RATE_BUFFER; period++)
+    {
+        Advance(Seconds(2));
+        nb.UpdateNeighborNodeStatus(b, MakeNodeInfo({{t1, unstable}}));
+        nb.RefreshNeighborNodeStatus();
+    }
+    uint32_t index = 0;
+    NS_TEST_EXPECT_MSG_EQ(nb.FindNeighbor(a, index), false, "silent neighbor removed");
+    CheckSelection(nb, {b}, false, "neighbor removed");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup ranger-test
+ * \ingroup tests
+ *
+ * RangerNeighborList TestSuite
+ */
+class RangerNeighborListTestSuite : public TestSuite
+{
+  public:
+    RangerNeighborListTestSuite();
+};
+
+RangerNeighborListTestSuite::RangerNeighborListTestSuite()
+    : TestSuite("ranger-neighbor-list", UNIT)
+{
+    AddTestCase(new RangerNeighborListLookupTestCase, TestCase::QUICK);
+    AddTestCase(new RangerNeighborListVersionTestCase, TestCase::QUICK);
+    AddTestCase(new RangerNeighborListCacheTestCase, TestCase::QUICK);
+}
+
+static RangerNeighborListTestSuite
+    g_rangerNeighborListTestSuite; //!< Static variable for test initialization
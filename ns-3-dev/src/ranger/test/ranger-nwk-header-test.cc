@@ -0,0 +1,272 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/packet.h>
+#include <ns3/ranger-mac-header.h>
+#include <ns3/ranger-nwk-header.h>
+#include <ns3/test.h>
+
+#include <algorithm>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup ranger-test
+ * \ingroup tests
+ *
+ * Serializes the ranger headers to a packet, then checks that both
+ * MessageHeader and MessageHeaderView read the same fields back.
+ */
+class RangerNwkHeaderTestCase : public TestCase
+{
+  public:
+    RangerNwkHeaderTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+RangerNwkHeaderTestCase::RangerNwkHeaderTestCase()
+    : TestCase("Check the round trip of the ranger headers")
+{
+}
+
+void
+RangerNwkHeaderTestCase::DoRun()
+{
+    Ipv4Address src("10.0.0.1");
+
+    // MAC header
+    {
+        RangerMacHeader mac(RangerMacHeader::RANGER_MAC_BROADCAST, 42);
+        mac.SetSrcAddr(src);
+        mac.SetDstAddr(Ipv4Address("10.0.0.2"));
+        Ptr<Packet> p = Create<Packet>(0);
+        p->AddHeader(mac);
+        RangerMacHeader rx;
+        p->RemoveHeader(rx);
+        NS_TEST_EXPECT_MSG_EQ(rx.GetSeqNum(), 42, "sequence number");
+        NS_TEST_EXPECT_MSG_EQ(rx.GetSrcAddr(), src, "source address");
+        NS_TEST_EXPECT_MSG_EQ(rx.GetDstAddr(), Ipv4Address("10.0.0.2"), "destination address");
+        NS_TEST_EXPECT_MSG_EQ(p->GetSize(), 0, "header size");
+    }
+
+    // NodeInfo, as large as a frame allows
+    {
+        MessageHeader msg;
+        msg.SetMessageType(MessageHeader::NODEINFO_MESSAGE);
+        msg.SetSrcAddress(src);
+        MessageHeader::NodeInfo& nodeInfo = msg.GetNodeInfo();
+        uint32_t links = MessageHeader::NodeInfo::MAX_LINKS;
+        for (uint32_t i = 0; i < links; i++)
+        {
+            MessageHeader::NodeInfo::LinkMessage lm;
+            lm.linkStatus = 1 + i % 2;
+            lm.neighborAddresses = Ipv4Address(0x0a000100 + i);
+            nodeInfo.linkMessages.push_back(lm);
+        }
+        nodeInfo.linkNumber = links;
+        msg.SetMessageLength(msg.GetSerializedSize());
+        Ptr<Packet> p = Create<Packet>(0);
+        p->AddHeader(msg);
+        NS_TEST_EXPECT_MSG_LT_OR_EQ(p->GetSize(), ranger::aMaxMessageSize, "too large");
+
+        MessageHeaderView view(p);
+        NS_TEST_EXPECT_MSG_EQ(view.GetMessageType(), MessageHeader::NODEINFO_MESSAGE, "type");
+        NS_TEST_EXPECT_MSG_EQ(view.GetSrcAddress(), src, "view source address");
+        NS_TEST_EXPECT_MSG_EQ(view.GetLinkNumber(), links, "view link number");
+        MessageHeader rx;
+        p->RemoveHeader(rx);
+        NS_TEST_EXPECT_MSG_EQ(rx.GetSrcAddress(), src, "source address");
+        NS_TEST_EXPECT_MSG_EQ(rx.GetNodeInfo().linkMessages.size(), links, "link number");
+        for (uint32_t i = 0; i < links; i++)
+        {
+            MessageHeader::NodeInfo::LinkMessage lm = rx.GetNodeInfo().linkMessages[i];
+            MessageHeader::NodeInfo::LinkMessage vlm = view.GetLinkMessage(i);
+            NS_TEST_EXPECT_MSG_EQ(lm.neighborAddresses, Ipv4Address(0x0a000100 + i), "address");
+            NS_TEST_EXPECT_MSG_EQ(uint32_t(lm.linkStatus), 1 + i % 2, "status");
+            NS_TEST_EXPECT_MSG_EQ(vlm.neighborAddresses, lm.neighborAddresses, "view address");
+            NS_TEST_EXPECT_MSG_EQ(vlm.linkStatus, lm.linkStatus, "view status");
+        }
+    }
+
+    // AudioData
+    {
+        MessageHeader msg;
+        msg.SetMessageType(MessageHeader::AUDIODATA_MESSAGE);
+        msg.SetSrcAddress(src);
+        MessageHeader::AudioData& audioData = msg.GetAudioData();
+        audioData.OriAddr = Ipv4Address("10.0.0.9");
+        audioData.AudioSeq = 200;
+        audioData.AudioSize = 40;
+        audioData.AssignNum = 3;
+        for (uint32_t i = 0; i < audioData.AssignNum; i++)
+        {
+            audioData.AssignNeighbor.push_back(Ipv4Address(0x0a000200 + i));
+        }
+        msg.SetMessageLength(msg.GetSerializedSize());
+        Ptr<Packet> p = Create<Packet>(0);
+        p->AddHeader(msg);
+
+        MessageHeaderView view(p);
+        NS_TEST_EXPECT_MSG_EQ(view.GetOriAddr(), Ipv4Address("10.0.0.9"), "view origin");
+        NS_TEST_EXPECT_MSG_EQ(view.GetAudioSeq(), 200, "view sequence number");
+        NS_TEST_EXPECT_MSG_EQ(view.GetAudioSize(), 40, "view audio size");
+        NS_TEST_EXPECT_MSG_EQ(view.GetAssignNum(), 3, "view assign number");
+        MessageHeader rx;
+        p->RemoveHeader(rx);
+        NS_TEST_EXPECT_MSG_EQ(rx.GetAudioData().OriAddr, Ipv4Address("10.0.0.9"), "origin");
+        NS_TEST_EXPECT_MSG_EQ(rx.GetAudioData().AssignNeighbor.size(), 3, "assign number");
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            NS_TEST_EXPECT_MSG_EQ(rx.GetAudioData().AssignNeighbor[i],
+                                  Ipv4Address(0x0a000200 + i),
+                                  "assign node");
+            NS_TEST_EXPECT_MSG_EQ(view.GetAssignNeighbor(i),
+                                  Ipv4Address(0x0a000200 + i),
+                                  "view assign node");
+        }
+    }
+
+    // MemberHeartbeat
+    {
+        MessageHeader msg;
+        msg.SetMessageType(MessageHeader::MEMBERHEARTBEAT_MESSAGE);
+        msg.SetSrcAddress(src);
+        MessageHeader::MemberHeartbeat& heartbeat = msg.GetMemberHeartbeat();
+        heartbeat.mainAddr = Ipv4Address("10.0.0.5");
+        heartbeat.roadNum = 2;
+        heartbeat.roadAddr.push_back(Ipv4Address("10.0.0.6"));
+        heartbeat.roadAddr.push_back(Ipv4Address("10.0.0.7"));
+        msg.SetMessageLength(msg.GetSerializedSize());
+        Ptr<Packet> p = Create<Packet>(0);
+        p->AddHeader(msg);
+
+        MessageHeaderView view(p);
+        NS_TEST_EXPECT_MSG_EQ(view.GetMainAddr(), Ipv4Address("10.0.0.5"), "view main address");
+        MessageHeader rx;
+        p->RemoveHeader(rx);
+        NS_TEST_EXPECT_MSG_EQ(rx.GetMemberHeartbeat().roadAddr.size(), 2, "road number");
+        NS_TEST_EXPECT_MSG_EQ(rx.GetMemberHeartbeat().roadAddr[1],
+                              Ipv4Address("10.0.0.7"),
+                              "road node");
+    }
+
+    // a NodeInfo with more links than a frame carries keeps its full size,
+    // so that the MAC refuses it, but stores only the links that fit
+    {
+        MessageHeader msg;
+        msg.SetMessageType(MessageHeader::NODEINFO_MESSAGE);
+        MessageHeader::NodeInfo& nodeInfo = msg.GetNodeInfo();
+        uint32_t links = MessageHeader::NodeInfo::MAX_LINKS + 5;
+        for (uint32_t i = 0; i < links; i++)
+        {
+            nodeInfo.linkMessages.push_back(MessageHeader::NodeInfo::LinkMessage());
+        }
+        nodeInfo.linkNumber = links;
+        NS_TEST_EXPECT_MSG_EQ(nodeInfo.linkMessages.size(),
+                              MessageHeader::NodeInfo::MAX_LINKS,
+                              "links beyond the capacity kept");
+        NS_TEST_EXPECT_MSG_GT(msg.GetSerializedSize(), ranger::aMaxMessageSize, "size too small");
+
+        // the room of the dropped links is zeroed
+        msg.SetMessageLength(msg.GetSerializedSize());
+        Ptr<Packet> p = Create<Packet>(0);
+        p->AddHeader(msg);
+        NS_TEST_EXPECT_MSG_EQ(p->GetSize(), msg.GetSerializedSize(), "serialized size");
+        std::vector<uint8_t> bytes(p->GetSize());
+        p->CopyData(bytes.data(), bytes.size());
+        uint32_t dropped = 5 * 5;
+        NS_TEST_EXPECT_MSG_EQ(std::count(bytes.end() - dropped, bytes.end(), 0),
+                              dropped,
+                              "room of the dropped links");
+    }
+
+    // the same for the assigned neighbors of an AudioData
+    {
+        MessageHeader msg;
+        msg.SetMessageType(MessageHeader::AUDIODATA_MESSAGE);
+        MessageHeader::AudioData& audioData = msg.GetAudioData();
+        uint32_t assigned = MessageHeader::AudioData::MAX_ASSIGN + 3;
+        for (uint32_t i = 0; i < assigned; i++)
+        {
+            audioData.AssignNeighbor.push_back(Ipv4Address(0x0a000001 + i));
+        }
+        audioData.AssignNum = assigned;
+        NS_TEST_EXPECT_MSG_EQ(audioData.AssignNeighbor.size(),
+                              MessageHeader::AudioData::MAX_ASSIGN,
+                              "neighbors beyond the capacity kept");
+
+        msg.SetMessageLength(msg.GetSerializedSize());
+        Ptr<Packet> p = Create<Packet>(0);
+        p->AddHeader(msg);
+        NS_TEST_EXPECT_MSG_EQ(p->GetSize(), msg.GetSerializedSize(), "serialized size");
+        std::vector<uint8_t> bytes(p->GetSize());
+        p->CopyData(bytes.data(), bytes.size());
+        uint32_t dropped = 3 * 4;
+        NS_TEST_EXPECT_MSG_EQ(std::count(bytes.end() - dropped, bytes.end(), 0),
+                              dropped,
+                              "room of the dropped neighbors");
+    }
+
+    // and for the road of a MemberHeartbeat
+    {
+        MessageHeader msg;
+        msg.SetMessageType(MessageHeader::MEMBERHEARTBEAT_MESSAGE);
+        MessageHeader::MemberHeartbeat& heartbeat = msg.GetMemberHeartbeat();
+        uint32_t road = MessageHeader::MemberHeartbeat::MAX_ROAD + 2;
+        for (uint32_t i = 0; i < road; i++)
+        {
+            heartbeat.roadAddr.push_back(Ipv4Address(0x0a000001 + i));
+        }
+        heartbeat.roadNum = road;
+        NS_TEST_EXPECT_MSG_EQ(heartbeat.roadAddr.size(),
+                              MessageHeader::MemberHeartbeat::MAX_ROAD,
+                              "road nodes beyond the capacity kept");
+
+        msg.SetMessageLength(msg.GetSerializedSize());
+        Ptr<Packet> p = Create<Packet>(0);
+        p->AddHeader(msg);
+        NS_TEST_EXPECT_MSG_EQ(p->GetSize(), msg.GetSerializedSize(), "serialized size");
+        std::vector<uint8_t> bytes(p->GetSize());
+        p->CopyData(bytes.data(), bytes.size());
+        uint32_t dropped = 2 * 4;
+        NS_TEST_EXPECT_MSG_EQ(std::count(bytes.end() - dropped, bytes.end(), 0),
+                              dropped,
+                              "room of the dropped road nodes");
+    }
+}
+
+/**
+ * \ingroup ranger-test
+ * \ingroup tests
+ *
+ * Ranger NWK header TestSuite
+ */
+class RangerNwkHeaderTestSuite : public TestSuite
+{
+  public:
+    RangerNwkHeaderTestSuite();
+};
+
+RangerNwkHeaderTestSuite::RangerNwkHeaderTestSuite()
+    : TestSuite("ranger-nwk-header", UNIT)
+{
+    AddTestCase(new RangerNwkHeaderTestCase, TestCase::QUICK);
+}
+
+static RangerNwkHeaderTestSuite
+    g_rangerNwkHeaderTestSuite; //!< Static variable for test initialization
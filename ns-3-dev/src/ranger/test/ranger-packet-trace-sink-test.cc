@@ -0,0 +1,281 @@
+/*
+ * Copyright (c) 2011 The Boeing Company
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/double.h>
+#include <ns3/lr-wpan-spectrum-value-helper.h>
+#include <ns3/mobility-helper.h>
+#include <ns3/node-container.h>
+#include <ns3/propagation-delay-model.h>
+#include <ns3/propagation-loss-model.h>
+#include <ns3/ranger-audio-application.h>
+#include <ns3/ranger-net-device.h>
+#include <ns3/ranger-packet-trace-sink.h>
+#include <ns3/simulator.h>
+#include <ns3/single-model-spectrum-channel.h>
+#include <ns3/test.h>
+#include <ns3/uinteger.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup ranger-test
+ * \ingroup tests
+ *
+ * Check that RangerPacketTraceSink writes its header and, across several
+ * buffer flushes, every record it is given, and that records given while
+ * the file is closed are counted but not written.
+ */
+class RangerPacketTraceSinkFileTestCase : public TestCase
+{
+  public:
+    RangerPacketTraceSinkFileTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+RangerPacketTraceSinkFileTestCase::RangerPacketTraceSinkFileTestCase()
+    : TestCase("Header and records of the RangerPacketTraceSink file")
+{
+}
+
+void
+RangerPacketTraceSinkFileTestCase::DoRun()
+{
+    std::string filename = CreateTempDirFilename("ranger-packet-trace.bin");
+    Ptr<RangerPacketTraceSink> sink = CreateObject<RangerPacketTraceSink>();
+
+    RangerNwkPacketRecord record{};
+    sink->Write(record);
+    NS_TEST_ASSERT_MSG_EQ(sink->GetRecordCount(), 1, "record before Open not counted");
+
+    // more records than the sink buffers, so that it flushes while writing
+    const uint32_t recordCnt = 10000;
+    sink->Open(filename);
+    for (uint32_t i = 0; i < recordCnt; i++)
+    {
+        record.direction = i % 2 ? RangerNwkPacketRecord::RECEIVE : RangerNwkPacketRecord::SEND;
+        record.messageType = MessageHeader::AUDIODATA_MESSAGE;
+        record.seq = i & 0xff;
+        record.assignNum = i % 7;
+        record.node = 0x0a000000 | (i % 13);
+        record.src = 0x0a000000 | (i % 11);
+        record.origin = 0x0a000001;
+        record.time = MilliSeconds(i).GetTimeStep();
+        sink->Write(record);
+    }
+    sink->Close();
+    sink->Write(record);
+    NS_TEST_ASSERT_MSG_EQ(sink->GetRecordCount(), recordCnt + 2, "records counted");
+    sink->Dispose();
+
+    std::ifstream file(filename, std::ios::binary);
+    NS_TEST_ASSERT_MSG_EQ(RangerPacketTraceSink::ReadHeader(file), true, "file header");
+    uint32_t i = 0;
+    while (RangerPacketTraceSink::ReadRecord(file, record))
+    {
+        NS_TEST_ASSERT_MSG_LT(i, recordCnt, "too many records in the file");
+        NS_TEST_EXPECT_MSG_EQ(uint32_t(record.direction), i % 2, "direction of record " << i);
+        NS_TEST_EXPECT_MSG_EQ(uint32_t(record.messageType),
+                              uint32_t(MessageHeader::AUDIODATA_MESSAGE),
+                              "type of record " << i);
+        NS_TEST_EXPECT_MSG_EQ(uint32_t(record.seq), (i & 0xff), "seq of record " << i);
+        NS_TEST_EXPECT_MSG_EQ(uint32_t(record.assignNum), i % 7, "assignNum of record " << i);
+        NS_TEST_EXPECT_MSG_EQ(record.node, (0x0a000000 | (i % 13)), "node of record " << i);
+        NS_TEST_EXPECT_MSG_EQ(record.src, (0x0a000000 | (i % 11)), "src of record " << i);
+        NS_TEST_EXPECT_MSG_EQ(record.origin, 0x0a000001, "origin of record " << i);
+        NS_TEST_EXPECT_MSG_EQ(record.time, MilliSeconds(i).GetTimeStep(), "time of record " << i);
+        i++;
+    }
+    NS_TEST_ASSERT_MSG_EQ(i, recordCnt, "records in the file");
+
+    // a file of another format is rejected
+    std::string other = CreateTempDirFilename("ranger-packet-trace-other.bin");
+    std::ofstream(other, std::ios::binary).write("RNRC\x01\x00\x18\x00", 8);
+    std::ifstream otherFile(other, std::ios::binary);
+    NS_TEST_ASSERT_MSG_EQ(RangerPacketTraceSink::ReadHeader(otherFile), false, "wrong magic");
+}
+
+/**
+ * \ingroup ranger-test
+ * \ingroup tests
+ *
+ * Check the records a RangerPacketTraceSink connected to the routing
+ * protocols of two nodes writes while one of them sends audio: the file
+ * holds the records of the PacketTrace sources, in order, and the audio
+ * messages are traced with the fields of their header.
+ */
+class RangerPacketTraceSinkRecordsTestCase : public TestCase
+{
+  public:
+    RangerPacketTraceSinkRecordsTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * PacketTrace sink.
+     * \param record the NWK record
+     */
+    void Record(const RangerNwkPacketRecord& record);
+
+    std::vector<RangerNwkPacketRecord> m_records; //!< records of the PacketTrace sources
+};
+
+RangerPacketTraceSinkRecordsTestCase::RangerPacketTraceSinkRecordsTestCase()
+    : TestCase("Records written by RangerPacketTraceSink in a simulation")
+{
+}
+
+void
+RangerPacketTraceSinkRecordsTestCase::Record(const RangerNwkPacketRecord& record)
+{
+    m_records.push_back(record);
+}
+
+void
+RangerPacketTraceSinkRecordsTestCase::DoRun()
+{
+    std::string filename = CreateTempDirFilename("ranger-packet-trace-run.bin");
+    Ptr<RangerPacketTraceSink> sink = CreateObject<RangerPacketTraceSink>();
+    sink->Open(filename);
+
+    NodeContainer nodes;
+    nodes.Create(2);
+    MobilityHelper mobility;
+    mobility.SetPositionAllocator("ns3::GridPositionAllocator",
+                                  "DeltaX",
+                                  DoubleValue(40),
+                                  "GridWidth",
+                                  UintegerValue(2));
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    mobility.Install(nodes);
+
+    Ptr<SingleModelSpectrumChannel> channel = CreateObject<SingleModelSpectrumChannel>();
+    channel->AddPropagationLossModel(CreateObject<LogDistancePropagationLossModel>());
+    channel->SetPropagationDelayModel(CreateObject<ConstantSpeedPropagationDelayModel>());
+
+    LrWpanSpectrumValueHelper svh;
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+        Ptr<RangerNetDevice> dev = CreateObject<RangerNetDevice>();
+        dev->SetAddress(Ipv4Address(0x0a000001 + i));
+        dev->SetChannel(channel);
+        dev->GetPhy()->SetTxPowerSpectralDensity(svh.CreateTxPowerSpectralDensity(30, 11));
+        sink->Connect(dev->GetRoutingProtocol());
+        dev->GetRoutingProtocol()->TraceConnectWithoutContext(
+            "PacketTrace",
+            MakeCallback(&RangerPacketTraceSinkRecordsTestCase::Record, this));
+        nodes.Get(i)->AddDevice(dev);
+    }
+
+    Ptr<RangerAudioApp> app = CreateObject<RangerAudioApp>();
+    app->SetAttribute("Interval", TimeValue(MilliSeconds(100)));
+    app->SetStartTime(Seconds(3));
+    app->SetStopTime(Seconds(4));
+    nodes.Get(0)->AddApplication(app);
+
+    Simulator::Stop(Seconds(5));
+    Simulator::Run();
+    sink->Close();
+    NS_TEST_ASSERT_MSG_EQ(sink->GetRecordCount(), m_records.size(), "records counted");
+
+    // the file holds the records of the trace sources, bit for bit
+    std::ifstream file(filename, std::ios::binary);
+    NS_TEST_ASSERT_MSG_EQ(RangerPacketTraceSink::ReadHeader(file), true, "file header");
+    RangerNwkPacketRecord record;
+    uint32_t i = 0;
+    while (RangerPacketTraceSink::ReadRecord(file, record))
+    {
+        NS_TEST_ASSERT_MSG_LT(i, m_records.size(), "too many records in the file");
+        NS_TEST_EXPECT_MSG_EQ(std::memcmp(&record, &m_records[i], sizeof(record)),
+                              0,
+                              "record " << i);
+        i++;
+    }
+    NS_TEST_ASSERT_MSG_EQ(i, m_records.size(), "records in the file");
+
+    // the audio messages of node 0, sent by it and received by node 1
+    const uint32_t source = 0x0a000001;
+    const uint32_t receiver = 0x0a000002;
+    std::vector<uint8_t> sent;
+    std::vector<uint8_t> received;
+    int64_t lastTime = 0;
+    for (const auto& r : m_records)
+    {
+        NS_TEST_EXPECT_MSG_GT_OR_EQ(r.time, lastTime, "records out of order");
+        lastTime = r.time;
+        if (r.messageType != MessageHeader::AUDIODATA_MESSAGE)
+        {
+            continue;
+        }
+        NS_TEST_EXPECT_MSG_EQ(r.origin, source, "origin of an audio message");
+        NS_TEST_EXPECT_MSG_GT_OR_EQ(r.time, Seconds(3).GetTimeStep(), "audio before the start");
+        if (r.direction == RangerNwkPacketRecord::SEND && r.node == source)
+        {
+            NS_TEST_EXPECT_MSG_EQ(r.src, source, "previous hop of a sent audio message");
+            sent.push_back(r.seq);
+        }
+        else if (r.direction == RangerNwkPacketRecord::RECEIVE && r.node == receiver &&
+                 r.src == source)
+        {
+            received.push_back(r.seq);
+        }
+    }
+    NS_TEST_ASSERT_MSG_GT(sent.size(), 0, "no audio message sent");
+    NS_TEST_ASSERT_MSG_GT(received.size(), 0, "no audio message received");
+    for (uint32_t j = 1; j < sent.size(); j++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(uint8_t(sent[j] - sent[j - 1]), 1, "AudioSeq of message " << j);
+    }
+    for (auto seq : received)
+    {
+        NS_TEST_EXPECT_MSG_EQ((std::find(sent.begin(), sent.end(), seq) != sent.end()),
+                              true,
+                              "AudioSeq " << uint32_t(seq) << " received but not sent");
+    }
+
+    sink->Dispose();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup ranger-test
+ * \ingroup tests
+ *
+ * RangerPacketTraceSink TestSuite
+ */
+class RangerPacketTraceSinkTestSuite : public TestSuite
+{
+  public:
+    RangerPacketTraceSinkTestSuite();
+};
+
+RangerPacketTraceSinkTestSuite::RangerPacketTraceSinkTestSuite()
+    : TestSuite("ranger-packet-trace-sink", UNIT)
+{
+    AddTestCase(new RangerPacketTraceSinkFileTestCase, TestCase::QUICK);
+    AddTestCase(new RangerPacketTraceSinkRecordsTestCase, TestCase::QUICK);
+}
+
+static RangerPacketTraceSinkTestSuite
+    g_rangerPacketTraceSinkTestSuite; //!< Static variable for test initialization
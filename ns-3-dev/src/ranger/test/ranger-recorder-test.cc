@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2011 The Boeing Company
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/ranger-recorder.h>
+#include <ns3/simulator.h>
+#include <ns3/test.h>
+
+#include <cmath>
+#include <fstream>
+
+using namespace ns3;
+
+/**
+ * \ingroup ranger-test
+ * \ingroup tests
+ *
+ * Check the moments, extrema, histogram and quantiles of
+ * RangerRunningStatistics against values computed by hand.
+ */
+class RangerRunningStatisticsTestCase : public TestCase
+{
+  public:
+    RangerRunningStatisticsTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+RangerRunningStatisticsTestCase::RangerRunningStatisticsTestCase()
+    : TestCase("Moments, histogram and quantiles of RangerRunningStatistics")
+{
+}
+
+void
+RangerRunningStatisticsTestCase::DoRun()
+{
+    const double tolerance = 1e-9;
+    RangerRunningStatistics stats(10.0, 10);
+    NS_TEST_ASSERT_MSG_EQ(stats.GetCount(), 0, "empty count");
+    NS_TEST_ASSERT_MSG_EQ(stats.GetMin(), 0.0, "empty min");
+    NS_TEST_ASSERT_MSG_EQ(stats.GetMax(), 0.0, "empty max");
+    NS_TEST_ASSERT_MSG_EQ(stats.GetVariance(), 0.0, "empty variance");
+    NS_TEST_ASSERT_MSG_EQ(stats.GetQuantile(0.5), 0.0, "empty quantile");
+
+    // 1, 2, ..., 100: mean 50.5, sample variance 100 * 101 / 12
+    for (uint32_t i = 1; i <= 100; i++)
+    {
+        stats.Add(i);
+    }
+    NS_TEST_ASSERT_MSG_EQ(stats.GetCount(), 100, "count");
+    NS_TEST_ASSERT_MSG_EQ_TOL(stats.GetMean(), 50.5, tolerance, "mean");
+    NS_TEST_ASSERT_MSG_EQ_TOL(stats.GetVariance(), 100.0 * 101 / 12, tolerance, "variance");
+    NS_TEST_ASSERT_MSG_EQ_TOL(stats.GetStdDev(),
+                              std::sqrt(100.0 * 101 / 12),
+                              tolerance,
+                              "standard deviation");
+    NS_TEST_ASSERT_MSG_EQ(stats.GetMin(), 1.0, "min");
+    NS_TEST_ASSERT_MSG_EQ(stats.GetMax(), 100.0, "max");
+
+    // bins [0, 10), ..., [80, 90), and the last one is open
+    const std::vector<uint64_t>& histogram = stats.GetHistogram();
+    NS_TEST_ASSERT_MSG_EQ(histogram.size(), 10, "bin count");
+    NS_TEST_ASSERT_MSG_EQ(histogram[0], 9, "first bin");
+    for (std::size_t i = 1; i < 9; i++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(histogram[i], 10, "bin " << i);
+    }
+    NS_TEST_ASSERT_MSG_EQ(histogram[9], 11, "open last bin");
+
+    // quantiles at the upper edge of their bin, the largest sample in the last one
+    NS_TEST_ASSERT_MSG_EQ(stats.GetQuantile(0.0), 10.0, "quantile 0");
+    NS_TEST_ASSERT_MSG_EQ(stats.GetQuantile(0.05), 10.0, "quantile 0.05");
+    NS_TEST_ASSERT_MSG_EQ(stats.GetQuantile(0.15), 20.0, "quantile 0.15");
+    NS_TEST_ASSERT_MSG_EQ(stats.GetQuantile(0.5), 60.0, "median");
+    NS_TEST_ASSERT_MSG_EQ(stats.GetQuantile(0.95), 100.0, "quantile 0.95");
+    NS_TEST_ASSERT_MSG_EQ(stats.GetQuantile(1.0), 100.0, "quantile 1");
+
+    // negative samples go to the first bin, and a quantile never exceeds the max
+    stats.Clear();
+    NS_TEST_ASSERT_MSG_EQ(stats.GetCount(), 0, "count after Clear");
+    NS_TEST_ASSERT_MSG_EQ(stats.GetHistogram()[9], 0, "histogram after Clear");
+    stats.Add(-5.0);
+    stats.Add(3.0);
+    NS_TEST_ASSERT_MSG_EQ(stats.GetHistogram()[0], 2, "negative sample");
+    NS_TEST_ASSERT_MSG_EQ(stats.GetMin(), -5.0, "negative min");
+    NS_TEST_ASSERT_MSG_EQ(stats.GetQuantile(1.0), 3.0, "quantile capped by the max");
+    NS_TEST_ASSERT_MSG_EQ_TOL(stats.GetMean(), -1.0, tolerance, "mean after Clear");
+    NS_TEST_ASSERT_MSG_EQ_TOL(stats.GetVariance(), 32.0, tolerance, "variance after Clear");
+}
+
+/**
+ * \ingroup ranger-test
+ * \ingroup tests
+ *
+ * Check that RangerRecorder unwraps the single byte AudioSeq of the messages
+ * to match every reception with the right send time, across several
+ * wrap-arounds and for late receptions, and that a reception without a
+ * matching send has no delay.
+ */
+class RangerRecorderSeqTestCase : public TestCase
+{
+  public:
+    RangerRecorderSeqTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+RangerRecorderSeqTestCase::RangerRecorderSeqTestCase()
+    : TestCase("AudioSeq unwrapping of RangerRecorder")
+{
+}
+
+void
+RangerRecorderSeqTestCase::DoRun()
+{
+    const double tolerance = 1e-9;
+    Ptr<RangerRecorder> recorder = CreateObject<RangerRecorder>();
+    Ipv4Address source("10.0.0.1");
+    Ipv4Address receiver("10.0.0.2");
+
+    // before the first send of the source, a reception has no send time
+    recorder->recordSend(source, source, 0, MilliSeconds(0));
+    recorder->recordReceive(receiver, source, 200, MilliSeconds(1));
+    NS_TEST_ASSERT_MSG_EQ(recorder->GetDelayStatistics().GetCount(), 0, "unsent seq matched");
+
+    // 600 messages, one every 10 ms, each received 5 ms later
+    for (uint32_t i = 1; i < 600; i++)
+    {
+        recorder->recordSend(source, source, i & 0xff, MilliSeconds(10 * i));
+        recorder->recordReceive(receiver, source, i & 0xff, MilliSeconds(10 * i + 5));
+    }
+    const RangerRunningStatistics& delay = recorder->GetDelayStatistics();
+    NS_TEST_ASSERT_MSG_EQ(delay.GetCount(), 599, "receptions matched with a send");
+    NS_TEST_ASSERT_MSG_EQ_TOL(delay.GetMean(), 5.0, tolerance, "delay across wrap-arounds");
+    NS_TEST_ASSERT_MSG_EQ_TOL(delay.GetMax(), 5.0, tolerance, "max delay");
+    NS_TEST_ASSERT_MSG_EQ_TOL(recorder->GetJitterStatistics().GetMax(),
+                              0.0,
+                              tolerance,
+                              "jitter of a constant delay");
+
+    // a late copy of message 400, 199 messages after it was sent
+    recorder->recordReceive(receiver, source, 400 & 0xff, MilliSeconds(6000));
+    NS_TEST_ASSERT_MSG_EQ(delay.GetCount(), 600, "late reception not matched");
+    NS_TEST_ASSERT_MSG_EQ_TOL(delay.GetMax(), 2000.0, tolerance, "delay of the late reception");
+
+    // the forwarded copies are counted, not matched
+    recorder->recordSend(receiver, source, 599 & 0xff, MilliSeconds(6001));
+    recorder->DoCalculation();
+    NS_TEST_ASSERT_MSG_EQ(recorder->GetTotalSourceCnt(), 600, "messages sent");
+    NS_TEST_ASSERT_MSG_EQ(recorder->GetTotalReceiveCnt(), 601, "messages received");
+    NS_TEST_ASSERT_MSG_EQ_TOL(recorder->GetTotalForwardCost(), 1.0 / 600, tolerance, "forwards");
+
+    recorder->Dispose();
+}
+
+/**
+ * \ingroup ranger-test
+ * \ingroup tests
+ *
+ * Check that the header of the binary snapshot file announces as many
+ * columns as each snapshot holds.
+ */
+class RangerRecorderBinaryFlushTestCase : public TestCase
+{
+  public:
+    RangerRecorderBinaryFlushTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+RangerRecorderBinaryFlushTestCase::RangerRecorderBinaryFlushTestCase()
+    : TestCase("Columns of the binary snapshot file of RangerRecorder")
+{
+}
+
+void
+RangerRecorderBinaryFlushTestCase::DoRun()
+{
+    std::string filename = CreateTempDirFilename("ranger-recorder.bin");
+    Ptr<RangerRecorder> recorder = CreateObject<RangerRecorder>();
+    recorder->EnableFlush(filename, Time(0), true);
+    recorder->recordSend(Ipv4Address("10.0.0.1"), Ipv4Address("10.0.0.1"), 0, Seconds(0));
+    recorder->recordReceive(Ipv4Address("10.0.0.2"), Ipv4Address("10.0.0.1"), 0, Seconds(0));
+    recorder->recordReceive(Ipv4Address("10.0.0.3"), Ipv4Address("10.0.0.1"), 0, Seconds(0));
+    recorder->Flush();
+    recorder->Dispose();
+
+    std::ifstream file(filename, std::ios::binary);
+    char magic[4];
+    uint16_t version;
+    uint16_t columns;
+    int64_t time;
+    uint32_t rows;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&columns), sizeof(columns));
+    file.read(reinterpret_cast<char*>(&time), sizeof(time));
+    file.read(reinterpret_cast<char*>(&rows), sizeof(rows));
+    NS_TEST_ASSERT_MSG_EQ(file.good(), true, "truncated file");
+    NS_TEST_ASSERT_MSG_EQ(std::string(magic, sizeof(magic)), "RNRC", "magic");
+    NS_TEST_ASSERT_MSG_EQ(version, 1, "version");
+    NS_TEST_ASSERT_MSG_EQ(rows, 3, "rows");
+
+    // address, then 7 columns of 8 bytes: source to delay_std_ms
+    NS_TEST_ASSERT_MSG_EQ(columns, 8, "columns in the header");
+    std::size_t rowSize = sizeof(uint32_t) + (columns - 1) * sizeof(uint64_t);
+    std::size_t headerSize = sizeof(magic) + sizeof(version) + sizeof(columns);
+    file.seekg(0, std::ios::end);
+    NS_TEST_ASSERT_MSG_EQ(static_cast<std::size_t>(file.tellg()),
+                          headerSize + sizeof(time) + sizeof(rows) + rows * rowSize,
+                          "size of the snapshot");
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup ranger-test
+ * \ingroup tests
+ *
+ * RangerRecorder TestSuite
+ */
+class RangerRecorderTestSuite : public TestSuite
+{
+  public:
+    RangerRecorderTestSuite();
+};
+
+RangerRecorderTestSuite::RangerRecorderTestSuite()
+    : TestSuite("ranger-recorder", UNIT)
+{
+    AddTestCase(new RangerRunningStatisticsTestCase, TestCase::QUICK);
+    AddTestCase(new RangerRecorderSeqTestCase, TestCase::QUICK);
+    AddTestCase(new RangerRecorderBinaryFlushTestCase, TestCase::QUICK);
+}
+
+static RangerRecorderTestSuite
+    g_rangerRecorderTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2010 CTTC
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Time the SpectrumValue operators with the kernels of each instruction set
+ * supported by the CPU, for a range of bin counts.
+ *
+ * For each (bins, level) point the time per operation is reported for an
+ * in-place product (psd *= gain), an expression building temporaries
+ * (psd * gain + noise), Sum and Integral. Every point runs about the same
+ * number of bins in total (--elements). Sum and Integral add the values in
+ * order unless --partialSums is set, see SpectrumValue::SetPartialSums.
+ *
+ * ./ns3 run "spectrum-value-benchmark"
+ * ./ns3 run "spectrum-value-benchmark --bins=64,1024 --elements=100000000"
+ * ./ns3 run "spectrum-value-benchmark --partialSums=1"
+ */
+
+#include <ns3/command-line.h>
+#include <ns3/spectrum-value.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+/// Keeps the results of the timed operations alive (external, so it is not optimized out)
+double g_sink = 0;
+
+/**
+ * Time an operation.
+ * \param iterations the number of times to run it
+ * \param op the operation
+ * \return the time per operation in ns
+ */
+template <typename Op>
+static double
+TimeOp(uint64_t iterations, Op op)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        op();
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+int
+main(int argc, char* argv[])
+{
+    std::string bins = "1,16,64,256,1024";
+    uint64_t elements = 20000000;
+    bool partialSums = false;
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("bins", "Comma separated list of bin counts", bins);
+    cmd.AddValue("elements", "Number of bins processed by each measurement", elements);
+    cmd.AddValue("partialSums", "Use the partial sums in Sum and Integral", partialSums);
+    cmd.Parse(argc, argv);
+    SpectrumValue::SetPartialSums(partialSums);
+
+    std::vector<uint32_t> counts;
+    std::istringstream iss(bins);
+    std::string item;
+    while (std::getline(iss, item, ','))
+    {
+        counts.push_back(std::stoul(item));
+    }
+
+    const char* names[] = {"scalar", "sse2", "avx2"};
+    SpectrumValue::SimdLevel maxLevel = SpectrumValue::GetMaxSimdLevel();
+    std::cout << "max level: " << names[maxLevel] << std::endl;
+    std::cout << std::setw(6) << "bins" << std::setw(8) << "level" << std::setw(12) << "*=(ns)"
+              << std::setw(12) << "a*b+c(ns)" << std::setw(12) << "Sum(ns)" << std::setw(14)
+              << "Integral(ns)" << std::endl;
+    for (auto n : counts)
+    {
+        Bands bands;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            BandInfo band;
+            band.fl = 2.4e9 + i * 1e6;
+            band.fc = band.fl + 0.5e6;
+            band.fh = band.fl + 1e6;
+            bands.push_back(band);
+        }
+        Ptr<SpectrumModel> model = Create<SpectrumModel>(bands);
+        SpectrumValue psd(model);
+        SpectrumValue gain(model);
+        SpectrumValue noise(model);
+        psd = 1e-3;
+        noise = 1e-12;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            // close to 1, so that the repeated products stay normal numbers
+            gain[i] = 1 + ((i % 2) ? 1e-9 : -1e-9);
+        }
+        uint64_t iterations = std::max<uint64_t>(elements / n, 1);
+
+        for (int level = SpectrumValue::SCALAR; level <= maxLevel; level++)
+        {
+            SpectrumValue::SetSimdLevel(SpectrumValue::SimdLevel(level));
+            SpectrumValue x = psd;
+            double inPlace = TimeOp(iterations, [&]() { x *= gain; });
+            double temporaries = TimeOp(iterations, [&]() {
+                SpectrumValue r = x * gain + noise;
+                g_sink += r[0];
+            });
+            double sum = TimeOp(iterations, [&]() { g_sink += Sum(x); });
+            double integral = TimeOp(iterations, [&]() { g_sink += Integral(x); });
+            std::cout << std::setw(6) << n << std::setw(8) << names[level] << std::fixed
+                      << std::setprecision(1) << std::setw(12) << inPlace << std::setw(12)
+                      << temporaries << std::setw(12) << sum << std::setw(14) << integral
+                      << std::endl;
+        }
+    }
+    SpectrumValue::SetSimdLevel(maxLevel);
+    return 0;
+}
@@ -130,6 +130,7 @@ MultiModelSpectrumChannel::RemoveRx(Ptr<SpectrumPhy> phy)
             break; // there should be at most one entry
         }
     }
+    ClearGainCache(phy);
 }
 
 void
@@ -185,6 +186,10 @@ MultiModelSpectrumChannel::FindAndEventuallyAddTxSpectrumModel(
     Ptr<const SpectrumModel> txSpectrumModel)
 {
     NS_LOG_FUNCTION(this << txSpectrumModel);
+#ifdef NS3_MULTITHREADED_ENABLE
+    // the iterators of the map stay valid when it is extended
+    std::lock_guard<std::mutex> lock(m_txSpectrumModelInfoMutex);
+#endif
     SpectrumModelUid_t txSpectrumModelUid = txSpectrumModel->GetUid();
     auto txInfoIterator = m_txSpectrumModelInfoMap.find(txSpectrumModelUid);
 
@@ -318,55 +323,24 @@ MultiModelSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
 
                 if (txMobility && receiverMobility)
                 {
-                    double txAntennaGain = 0;
-                    double rxAntennaGain = 0;
-                    double propagationGainDb = 0;
-                    double pathLossDb = 0;
-                    if (rxParams->txAntenna)
-                    {
-                        Angles txAngles(receiverMobility->GetPosition(), txMobility->GetPosition());
-                        txAntennaGain = rxParams->txAntenna->GetGainDb(txAngles);
-                        NS_LOG_LOGIC("txAntennaGain = " << txAntennaGain << " dB");
-                        pathLossDb -= txAntennaGain;
-                    }
-                    Ptr<AntennaModel> rxAntenna =
-                        DynamicCast<AntennaModel>((*rxPhyIterator)->GetAntenna());
-                    if (rxAntenna)
-                    {
-                        Angles rxAngles(txMobility->GetPosition(), receiverMobility->GetPosition());
-                        rxAntennaGain = rxAntenna->GetGainDb(rxAngles);
-                        NS_LOG_LOGIC("rxAntennaGain = " << rxAntennaGain << " dB");
-                        pathLossDb -= rxAntennaGain;
-                    }
-                    if (m_propagationLoss)
-                    {
-                        propagationGainDb =
-                            m_propagationLoss->CalcRxPower(0, txMobility, receiverMobility);
-                        NS_LOG_LOGIC("propagationGainDb = " << propagationGainDb << " dB");
-                        pathLossDb -= propagationGainDb;
-                    }
-                    NS_LOG_LOGIC("total pathLoss = " << pathLossDb << " dB");
+                    PathGain gain =
+                        GetPathGain(txParams, txMobility, *rxPhyIterator, receiverMobility);
                     // Gain trace
                     m_gainTrace(txMobility,
                                 receiverMobility,
-                                txAntennaGain,
-                                rxAntennaGain,
-                                propagationGainDb,
-                                pathLossDb);
+                                gain.txAntennaGain,
+                                gain.rxAntennaGain,
+                                gain.propagationGainDb,
+                                gain.pathLossDb);
                     // Pathloss trace
-                    m_pathLossTrace(txParams->txPhy, *rxPhyIterator, pathLossDb);
-                    if (pathLossDb > m_maxLossDb)
+                    m_pathLossTrace(txParams->txPhy, *rxPhyIterator, gain.pathLossDb);
+                    if (gain.pathLossDb > m_maxLossDb)
                     {
                         // beyond range
                         continue;
                     }
-                    double pathGainLinear = std::pow(10.0, (-pathLossDb) / 10.0);
-                    *(rxParams->psd) *= pathGainLinear;
-
-                    if (m_propagationDelay)
-                    {
-                        delay = m_propagationDelay->GetDelay(txMobility, receiverMobility);
-                    }
+                    *(rxParams->psd) *= gain.pathGainLinear;
+                    delay = gain.delay;
                 }
 
                 if (rxNetDevice)
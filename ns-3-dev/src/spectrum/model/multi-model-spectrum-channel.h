@@ -30,6 +30,10 @@
 #include <map>
 #include <set>
 
+#ifdef NS3_MULTITHREADED_ENABLE
+#include <mutex>
+#endif
+
 namespace ns3
 {
 
@@ -163,6 +167,14 @@ class MultiModelSpectrumChannel : public SpectrumChannel
      * Number of devices connected to the channel.
      */
     std::size_t m_numDevices;
+
+#ifdef NS3_MULTITHREADED_ENABLE
+    /**
+     * Protects m_txSpectrumModelInfoMap, which is extended by StartTx, from
+     * the threads of MultithreadedSimulatorImpl.
+     */
+    std::mutex m_txSpectrumModelInfoMutex;
+#endif
 };
 
 } // namespace ns3
@@ -25,6 +25,7 @@
 
 #include <ns3/angles.h>
 #include <ns3/antenna-model.h>
+#include <ns3/boolean.h>
 #include <ns3/double.h>
 #include <ns3/log.h>
 #include <ns3/mobility-model.h>
@@ -38,6 +39,7 @@
 #include <ns3/simulator.h>
 
 #include <algorithm>
+#include <cmath>
 
 namespace ns3
 {
@@ -47,6 +49,9 @@ NS_LOG_COMPONENT_DEFINE("SingleModelSpectrumChannel");
 NS_OBJECT_ENSURE_REGISTERED(SingleModelSpectrumChannel);
 
 SingleModelSpectrumChannel::SingleModelSpectrumChannel()
+    : m_indexCellSize(0),
+      m_spatialIndexValid(false),
+      m_maxSpeed(0)
 {
     NS_LOG_FUNCTION(this);
 }
@@ -55,6 +60,15 @@ void
 SingleModelSpectrumChannel::DoDispose()
 {
     NS_LOG_FUNCTION(this);
+    for (auto& tracked : m_trackedMobility)
+    {
+        tracked.second.mobility->TraceDisconnectWithoutContext(
+            "CourseChange",
+            MakeCallback(&SingleModelSpectrumChannel::NotifyCourseChange, this));
+    }
+    m_trackedMobility.clear();
+    m_movedMobility.clear();
+    m_grid.clear();
     m_phyList.clear();
     m_spectrumModel = nullptr;
     SpectrumChannel::DoDispose();
@@ -67,7 +81,24 @@ SingleModelSpectrumChannel::GetTypeId()
     static TypeId tid = TypeId("ns3::SingleModelSpectrumChannel")
                             .SetParent<SpectrumChannel>()
                             .SetGroupName("Spectrum")
-                            .AddConstructor<SingleModelSpectrumChannel>();
+                            .AddConstructor<SingleModelSpectrumChannel>()
+                            .AddAttribute("SpatialIndex",
+                                          "If true, transmissions only visit the receivers "
+                                          "that a grid of their positions places within "
+                                          "MaxLossDb of the transmitter. The receptions are "
+                                          "the same as without the index.",
+                                          BooleanValue(false),
+                                          MakeBooleanAccessor(
+                                              &SingleModelSpectrumChannel::m_spatialIndexEnabled),
+                                          MakeBooleanChecker())
+                            .AddAttribute("SpatialIndexCellSize",
+                                          "The side (m) of the cells of the spatial index. "
+                                          "If 0, the range of the PropagationLossModel at "
+                                          "MaxLossDb is used.",
+                                          DoubleValue(0),
+                                          MakeDoubleAccessor(
+                                              &SingleModelSpectrumChannel::m_cellSize),
+                                          MakeDoubleChecker<double>(0));
     return tid;
 }
 
@@ -79,7 +110,9 @@ SingleModelSpectrumChannel::RemoveRx(Ptr<SpectrumPhy> phy)
     if (it != std::end(m_phyList))
     {
         m_phyList.erase(it);
+        m_spatialIndexValid = false;
     }
+    ClearGainCache(phy);
 }
 
 void
@@ -89,6 +122,7 @@ SingleModelSpectrumChannel::AddRx(Ptr<SpectrumPhy> phy)
     if (std::find(m_phyList.cbegin(), m_phyList.cend(), phy) == m_phyList.cend())
     {
         m_phyList.push_back(phy);
+        m_spatialIndexValid = false;
     }
 }
 
@@ -106,124 +140,295 @@ SingleModelSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
 
     // just a sanity check routine. We might want to remove it to save some computational load --
     // one "if" statement  ;-)
-    if (!m_spectrumModel)
-    {
-        // first pak, record SpectrumModel
-        m_spectrumModel = txParams->psd->GetSpectrumModel();
-    }
-    else
     {
-        // all attached SpectrumPhy instances must use the same SpectrumModel
-        NS_ASSERT(*(txParams->psd->GetSpectrumModel()) == *m_spectrumModel);
+#ifdef NS3_MULTITHREADED_ENABLE
+        std::lock_guard<std::recursive_mutex> lock(m_mutex);
+#endif
+        if (!m_spectrumModel)
+        {
+            // first pak, record SpectrumModel
+            m_spectrumModel = txParams->psd->GetSpectrumModel();
+        }
+        else
+        {
+            // all attached SpectrumPhy instances must use the same SpectrumModel
+            NS_ASSERT(*(txParams->psd->GetSpectrumModel()) == *m_spectrumModel);
+        }
     }
 
     Ptr<MobilityModel> senderMobility = txParams->txPhy->GetMobility();
 
+#ifdef NS3_MULTITHREADED_ENABLE
+    // the transmissions of the nodes run by other threads use m_candidates
+    std::vector<std::size_t> candidates;
+#else
+    std::vector<std::size_t>& candidates = m_candidates;
+#endif
+    if (m_spatialIndexEnabled && GetCandidateReceivers(txParams, senderMobility, candidates))
+    {
+        for (auto phyIndex : candidates)
+        {
+            StartTxToReceiver(txParams, senderMobility, m_phyList[phyIndex]);
+        }
+        return;
+    }
+
     for (auto rxPhyIterator = m_phyList.begin(); rxPhyIterator != m_phyList.end(); ++rxPhyIterator)
     {
-        Ptr<NetDevice> rxNetDevice = (*rxPhyIterator)->GetDevice();
-        Ptr<NetDevice> txNetDevice = txParams->txPhy->GetDevice();
+        StartTxToReceiver(txParams, senderMobility, *rxPhyIterator);
+    }
+}
+
+void
+SingleModelSpectrumChannel::StartTxToReceiver(Ptr<SpectrumSignalParameters> txParams,
+                                              Ptr<MobilityModel> senderMobility,
+                                              Ptr<SpectrumPhy> rxPhy)
+{
+    Ptr<NetDevice> rxNetDevice = rxPhy->GetDevice();
+    Ptr<NetDevice> txNetDevice = txParams->txPhy->GetDevice();
+
+    if (rxNetDevice && txNetDevice)
+    {
+        // we assume that devices are attached to a node
+        if (rxNetDevice->GetNode()->GetId() == txNetDevice->GetNode()->GetId())
+        {
+            NS_LOG_DEBUG("Skipping the pathloss calculation among different antennas of the "
+                         "same node, not supported yet by any pathloss model in ns-3.");
+            return;
+        }
+    }
+
+    if (m_filter && m_filter->Filter(txParams, rxPhy))
+    {
+        return;
+    }
+
+    if (rxPhy != txParams->txPhy)
+    {
+        Time delay = MicroSeconds(0);
 
-        if (rxNetDevice && txNetDevice)
+        Ptr<MobilityModel> receiverMobility = rxPhy->GetMobility();
+        NS_LOG_LOGIC("copying signal parameters " << txParams);
+        Ptr<SpectrumSignalParameters> rxParams = txParams->Copy();
+
+        if (senderMobility && receiverMobility)
         {
-            // we assume that devices are attached to a node
-            if (rxNetDevice->GetNode()->GetId() == txNetDevice->GetNode()->GetId())
+            PathGain gain = GetPathGain(txParams, senderMobility, rxPhy, receiverMobility);
+            // Gain trace
+            m_gainTrace(senderMobility,
+                        receiverMobility,
+                        gain.txAntennaGain,
+                        gain.rxAntennaGain,
+                        gain.propagationGainDb,
+                        gain.pathLossDb);
+            // Pathloss trace
+            m_pathLossTrace(txParams->txPhy, rxPhy, gain.pathLossDb);
+            if (gain.pathLossDb > m_maxLossDb)
             {
-                NS_LOG_DEBUG("Skipping the pathloss calculation among different antennas of the "
-                             "same node, not supported yet by any pathloss model in ns-3.");
-                continue;
+                // beyond range
+                return;
             }
+            *(rxParams->psd) *= gain.pathGainLinear;
+            delay = gain.delay;
         }
 
-        if (m_filter && m_filter->Filter(txParams, *rxPhyIterator))
+        if (rxNetDevice)
         {
-            continue;
+            // the receiver has a NetDevice, so we expect that it is attached to a Node
+            uint32_t dstNode = rxNetDevice->GetNode()->GetId();
+            Simulator::ScheduleWithContext(dstNode,
+                                           delay,
+                                           &SingleModelSpectrumChannel::StartRx,
+                                           this,
+                                           rxParams,
+                                           rxPhy);
         }
-
-        if ((*rxPhyIterator) != txParams->txPhy)
+        else
         {
-            Time delay = MicroSeconds(0);
+            // the receiver is not attached to a NetDevice, so we cannot assume that it is
+            // attached to a node
+            Simulator::Schedule(delay,
+                                &SingleModelSpectrumChannel::StartRx,
+                                this,
+                                rxParams,
+                                rxPhy);
+        }
+    }
+}
 
-            Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility();
-            NS_LOG_LOGIC("copying signal parameters " << txParams);
-            Ptr<SpectrumSignalParameters> rxParams = txParams->Copy();
+bool
+SingleModelSpectrumChannel::GetCandidateReceivers(Ptr<const SpectrumSignalParameters> txParams,
+                                                  Ptr<MobilityModel> senderMobility,
+                                                  std::vector<std::size_t>& candidates)
+{
+    NS_LOG_FUNCTION(this);
+    // the index may only skip the receivers for which the full scan would
+    // neither schedule a reception nor fire a trace
+    if (!m_propagationLoss || !senderMobility || txParams->txAntenna || !m_gainTrace.IsEmpty() ||
+        !m_pathLossTrace.IsEmpty())
+    {
+        return false;
+    }
+    // the loss is evaluated with a 0 dBm transmitter, see StartTxToReceiver
+    double range = m_propagationLoss->GetMaxRange(0, -m_maxLossDb);
+    if (!std::isfinite(range))
+    {
+        return false;
+    }
 
-            if (senderMobility && receiverMobility)
-            {
-                double txAntennaGain = 0;
-                double rxAntennaGain = 0;
-                double propagationGainDb = 0;
-                double pathLossDb = 0;
-                if (rxParams->txAntenna)
-                {
-                    Angles txAngles(receiverMobility->GetPosition(), senderMobility->GetPosition());
-                    txAntennaGain = rxParams->txAntenna->GetGainDb(txAngles);
-                    NS_LOG_LOGIC("txAntennaGain = " << txAntennaGain << " dB");
-                    pathLossDb -= txAntennaGain;
-                }
-                Ptr<AntennaModel> rxAntenna =
-                    DynamicCast<AntennaModel>((*rxPhyIterator)->GetAntenna());
-                if (rxAntenna)
-                {
-                    Angles rxAngles(senderMobility->GetPosition(), receiverMobility->GetPosition());
-                    rxAntennaGain = rxAntenna->GetGainDb(rxAngles);
-                    NS_LOG_LOGIC("rxAntennaGain = " << rxAntennaGain << " dB");
-                    pathLossDb -= rxAntennaGain;
-                }
-                if (m_propagationLoss)
-                {
-                    propagationGainDb =
-                        m_propagationLoss->CalcRxPower(0, senderMobility, receiverMobility);
-                    NS_LOG_LOGIC("propagationGainDb = " << propagationGainDb << " dB");
-                    pathLossDb -= propagationGainDb;
-                }
-                NS_LOG_LOGIC("total pathLoss = " << pathLossDb << " dB");
-                // Gain trace
-                m_gainTrace(senderMobility,
-                            receiverMobility,
-                            txAntennaGain,
-                            rxAntennaGain,
-                            propagationGainDb,
-                            pathLossDb);
-                // Pathloss trace
-                m_pathLossTrace(txParams->txPhy, *rxPhyIterator, pathLossDb);
-                if (pathLossDb > m_maxLossDb)
-                {
-                    // beyond range
-                    continue;
-                }
-                double pathGainLinear = std::pow(10.0, (-pathLossDb) / 10.0);
-                *(rxParams->psd) *= pathGainLinear;
-
-                if (m_propagationDelay)
-                {
-                    delay = m_propagationDelay->GetDelay(senderMobility, receiverMobility);
-                }
-            }
+#ifdef NS3_MULTITHREADED_ENABLE
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+#endif
 
-            if (rxNetDevice)
+    if (!m_spatialIndexValid)
+    {
+        RebuildSpatialIndex(range);
+    }
+    else
+    {
+        for (auto mobility : m_movedMobility)
+        {
+            auto& tracked = m_trackedMobility[mobility];
+            tracked.moved = false;
+            for (auto phyIndex : tracked.phys)
             {
-                // the receiver has a NetDevice, so we expect that it is attached to a Node
-                uint32_t dstNode = rxNetDevice->GetNode()->GetId();
-                Simulator::ScheduleWithContext(dstNode,
-                                               delay,
-                                               &SingleModelSpectrumChannel::StartRx,
-                                               this,
-                                               rxParams,
-                                               *rxPhyIterator);
+                UpdateSpatialIndex(phyIndex);
             }
-            else
+        }
+        m_movedMobility.clear();
+    }
+
+    // the receivers may have moved away from their cell since they were
+    // indexed; rebuild once the uncertainty exceeds a cell
+    // (with MultithreadedSimulatorImpl, the index may have been rebuilt by a
+    // thread ahead in the current window)
+    double slack = m_maxSpeed * Abs(Simulator::Now() - m_spatialIndexTime).GetSeconds();
+    if (slack > m_indexCellSize)
+    {
+        RebuildSpatialIndex(range);
+        slack = 0;
+    }
+
+    double radius = range + slack;
+    Vector position = senderMobility->GetPosition();
+    int64_t xMin = GetCellCoordinate(position.x - radius);
+    int64_t xMax = GetCellCoordinate(position.x + radius);
+    int64_t yMin = GetCellCoordinate(position.y - radius);
+    int64_t yMax = GetCellCoordinate(position.y + radius);
+    if (static_cast<double>(xMax - xMin + 1) * static_cast<double>(yMax - yMin + 1) >
+        m_phyList.size())
+    {
+        // visiting the cells would cost more than the full scan
+        return false;
+    }
+
+    candidates = m_unindexedPhys;
+    for (auto x = xMin; x <= xMax; ++x)
+    {
+        for (auto y = yMin; y <= yMax; ++y)
+        {
+            auto cell = m_grid.find(GetCellKey(x, y));
+            if (cell != m_grid.end())
             {
-                // the receiver is not attached to a NetDevice, so we cannot assume that it is
-                // attached to a node
-                Simulator::Schedule(delay,
-                                    &SingleModelSpectrumChannel::StartRx,
-                                    this,
-                                    rxParams,
-                                    *rxPhyIterator);
+                candidates.insert(candidates.end(), cell->second.begin(), cell->second.end());
             }
         }
     }
+    // keep the order of the full scan, so that the events are scheduled in the
+    // same order
+    std::sort(candidates.begin(), candidates.end());
+    NS_LOG_LOGIC("visiting " << candidates.size() << " of " << m_phyList.size() << " receivers");
+    return true;
+}
+
+void
+SingleModelSpectrumChannel::RebuildSpatialIndex(double range)
+{
+    NS_LOG_FUNCTION(this << range);
+    m_indexCellSize = (m_cellSize > 0) ? m_cellSize : std::max(range, 1.0);
+    m_spatialIndexTime = Simulator::Now();
+    m_maxSpeed = 0;
+    m_grid.clear();
+    m_unindexedPhys.clear();
+    m_movedMobility.clear();
+    for (auto& tracked : m_trackedMobility)
+    {
+        tracked.second.phys.clear();
+        tracked.second.moved = false;
+    }
+    m_phyCell.assign(m_phyList.size(), 0);
+
+    for (std::size_t i = 0; i < m_phyList.size(); ++i)
+    {
+        Ptr<MobilityModel> mobility = m_phyList[i]->GetMobility();
+        if (!mobility || DynamicCast<AntennaModel>(m_phyList[i]->GetAntenna()))
+        {
+            // no loss is applied without a mobility model, and an antenna may
+            // add gain: these receivers are always visited
+            m_unindexedPhys.push_back(i);
+            continue;
+        }
+        auto tracked = m_trackedMobility.find(PeekPointer(mobility));
+        if (tracked == m_trackedMobility.end())
+        {
+            mobility->TraceConnectWithoutContext(
+                "CourseChange",
+                MakeCallback(&SingleModelSpectrumChannel::NotifyCourseChange, this));
+            tracked = m_trackedMobility.emplace(PeekPointer(mobility), TrackedMobility()).first;
+            tracked->second.mobility = mobility;
+        }
+        tracked->second.phys.push_back(i);
+        Vector position = mobility->GetPosition();
+        m_phyCell[i] = GetCellKey(GetCellCoordinate(position.x), GetCellCoordinate(position.y));
+        m_grid[m_phyCell[i]].push_back(i);
+        m_maxSpeed = std::max(m_maxSpeed, mobility->GetVelocity().GetLength());
+    }
+    m_spatialIndexValid = true;
+}
+
+void
+SingleModelSpectrumChannel::UpdateSpatialIndex(std::size_t phyIndex)
+{
+    NS_LOG_FUNCTION(this << phyIndex);
+    Ptr<MobilityModel> mobility = m_phyList[phyIndex]->GetMobility();
+    Vector position = mobility->GetPosition();
+    uint64_t cell = GetCellKey(GetCellCoordinate(position.x), GetCellCoordinate(position.y));
+    if (cell != m_phyCell[phyIndex])
+    {
+        auto& previous = m_grid[m_phyCell[phyIndex]];
+        previous.erase(std::find(previous.begin(), previous.end(), phyIndex));
+        m_grid[cell].push_back(phyIndex);
+        m_phyCell[phyIndex] = cell;
+    }
+    m_maxSpeed = std::max(m_maxSpeed, mobility->GetVelocity().GetLength());
+}
+
+void
+SingleModelSpectrumChannel::NotifyCourseChange(Ptr<const MobilityModel> mobility)
+{
+#ifdef NS3_MULTITHREADED_ENABLE
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+#endif
+    auto tracked = m_trackedMobility.find(PeekPointer(mobility));
+    if (m_spatialIndexValid && tracked != m_trackedMobility.end() && !tracked->second.moved)
+    {
+        tracked->second.moved = true;
+        m_movedMobility.push_back(tracked->first);
+    }
+}
+
+int64_t
+SingleModelSpectrumChannel::GetCellCoordinate(double coordinate) const
+{
+    return static_cast<int64_t>(std::floor(coordinate / m_indexCellSize));
+}
+
+uint64_t
+SingleModelSpectrumChannel::GetCellKey(int64_t x, int64_t y)
+{
+    // cells whose coordinates do not fit in 32 bits share keys, which only adds
+    // candidates to the lookup
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
 }
 
 void
@@ -23,8 +23,15 @@
 #include "spectrum-channel.h"
 #include "spectrum-model.h"
 
+#include <ns3/nstime.h>
 #include <ns3/traced-callback.h>
 
+#include <unordered_map>
+
+#ifdef NS3_MULTITHREADED_ENABLE
+#include <mutex>
+#endif
+
 namespace ns3
 {
 
@@ -34,6 +41,19 @@ namespace ns3
  * \brief SpectrumChannel implementation which handles a single spectrum model
  *
  * All SpectrumPhy layers attached to this SpectrumChannel
+ *
+ * When the SpatialIndex attribute is enabled, the receivers are kept in a
+ * uniform grid of their horizontal positions, and a transmission only visits
+ * the receivers in the cells that the PropagationLossModel can reach within
+ * MaxLossDb (see PropagationLossModel::GetMaxRange). The receivers are still
+ * processed in the order in which they were added, so the simulation is the
+ * same as with the full scan. The index falls back to the full scan whenever
+ * the range is not bounded: no MaxLossDb, chained or stochastic loss models,
+ * a transmit antenna, or a connected Gain or PathLoss trace. Receivers with
+ * an antenna or without a mobility model are always visited. The index is
+ * refreshed on the CourseChange trace of the receivers, assuming that they
+ * move at constant velocity in between, and is rebuilt when the accumulated
+ * uncertainty on the positions exceeds one cell.
  */
 class SingleModelSpectrumChannel : public SpectrumChannel
 {
@@ -69,6 +89,68 @@ class SingleModelSpectrumChannel : public SpectrumChannel
      */
     void StartRx(Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
 
+    /**
+     * Computes the loss towards one receiver and schedules the reception if
+     * the signal is within range.
+     *
+     * \param txParams the parameters of the transmitted signal
+     * \param senderMobility the mobility model of the transmitter
+     * \param rxPhy the receiver
+     */
+    void StartTxToReceiver(Ptr<SpectrumSignalParameters> txParams,
+                           Ptr<MobilityModel> senderMobility,
+                           Ptr<SpectrumPhy> rxPhy);
+
+    /**
+     * Looks up, in the spatial index, the receivers that a transmission may
+     * reach.
+     *
+     * \param txParams the parameters of the transmitted signal
+     * \param senderMobility the mobility model of the transmitter
+     * \param candidates the positions in m_phyList of the receivers to visit,
+     * in increasing order
+     * \return false if the index cannot be used for this transmission
+     */
+    bool GetCandidateReceivers(Ptr<const SpectrumSignalParameters> txParams,
+                               Ptr<MobilityModel> senderMobility,
+                               std::vector<std::size_t>& candidates);
+
+    /**
+     * Rebuilds the spatial index from the current position of all the receivers.
+     *
+     * \param range the range of the propagation loss model (m), used to size
+     * the cells when no cell size is configured
+     */
+    void RebuildSpatialIndex(double range);
+
+    /**
+     * Moves a receiver to the cell of its current position.
+     *
+     * \param phyIndex the position of the receiver in m_phyList
+     */
+    void UpdateSpatialIndex(std::size_t phyIndex);
+
+    /**
+     * Records that a receiver changed course, so that it is moved to its new
+     * cell before the next lookup.
+     *
+     * \param mobility the mobility model that changed course
+     */
+    void NotifyCourseChange(Ptr<const MobilityModel> mobility);
+
+    /**
+     * \param coordinate a horizontal coordinate (m)
+     * \return the index along the same axis of the grid cell that contains it
+     */
+    int64_t GetCellCoordinate(double coordinate) const;
+
+    /**
+     * \param x the index of a grid cell along the x axis
+     * \param y the index of a grid cell along the y axis
+     * \return the key of the cell in m_grid
+     */
+    static uint64_t GetCellKey(int64_t x, int64_t y);
+
     /**
      * List of SpectrumPhy instances attached to the channel.
      */
@@ -78,6 +160,39 @@ class SingleModelSpectrumChannel : public SpectrumChannel
      * SpectrumModel that this channel instance is supporting.
      */
     Ptr<const SpectrumModel> m_spectrumModel;
+
+    /// Receivers that share a mobility model, and whether it changed course
+    struct TrackedMobility
+    {
+        Ptr<MobilityModel> mobility;   //!< the mobility model
+        std::vector<std::size_t> phys; //!< positions of the receivers in m_phyList
+        bool moved{false};             //!< true if the receivers must be moved
+    };
+
+    bool m_spatialIndexEnabled; //!< true if the spatial index is used
+    double m_cellSize;          //!< configured cell size (m), 0 to use the range
+    double m_indexCellSize;     //!< cell size (m) of the current index
+    bool m_spatialIndexValid;   //!< false if the index must be rebuilt
+    Time m_spatialIndexTime;    //!< time of the last rebuild
+    double m_maxSpeed;          //!< highest receiver speed (m/s) since the last rebuild
+    /// Positions in m_phyList of the receivers, by grid cell
+    std::unordered_map<uint64_t, std::vector<std::size_t>> m_grid;
+    /// Grid cell of each receiver, in m_phyList order
+    std::vector<uint64_t> m_phyCell;
+    /// Positions in m_phyList of the receivers that are always visited
+    std::vector<std::size_t> m_unindexedPhys;
+    /// Mobility models whose CourseChange trace is connected
+    std::unordered_map<const MobilityModel*, TrackedMobility> m_trackedMobility;
+    /// Mobility models that changed course since the last lookup
+    std::vector<const MobilityModel*> m_movedMobility;
+    /// Scratch list of the receivers to visit
+    std::vector<std::size_t> m_candidates;
+#ifdef NS3_MULTITHREADED_ENABLE
+    /// Protects the spectrum model and the spatial index from the threads of
+    /// MultithreadedSimulatorImpl. Reading a position may notify a course
+    /// change while it is held.
+    std::recursive_mutex m_mutex;
+#endif
 };
 
 } // namespace ns3
@@ -20,10 +20,23 @@
 #include "spectrum-channel.h"
 
 #include <ns3/abort.h>
+#include <ns3/angles.h>
+#include <ns3/antenna-model.h>
+#include <ns3/boolean.h>
+#include <ns3/constant-acceleration-mobility-model.h>
+#include <ns3/constant-position-mobility-model.h>
+#include <ns3/constant-velocity-mobility-model.h>
 #include <ns3/double.h>
 #include <ns3/log.h>
+#include <ns3/net-device.h>
+#include <ns3/node.h>
 #include <ns3/pointer.h>
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
+
 namespace ns3
 {
 
@@ -32,6 +45,10 @@ NS_LOG_COMPONENT_DEFINE("SpectrumChannel");
 NS_OBJECT_ENSURE_REGISTERED(SpectrumChannel);
 
 SpectrumChannel::SpectrumChannel()
+    : m_gainCacheEnabled(false),
+      m_gainCacheTolerance(0),
+      m_gainCacheHits(0),
+      m_gainCacheMisses(0)
 {
     NS_LOG_FUNCTION(this);
 }
@@ -44,6 +61,14 @@ void
 SpectrumChannel::DoDispose()
 {
     NS_LOG_FUNCTION(this);
+    for (auto& tracked : m_gainCacheMobility)
+    {
+        tracked.second.mobility->TraceDisconnectWithoutContext(
+            "CourseChange",
+            MakeCallback(&SpectrumChannel::NotifyGainCacheCourseChange, this));
+    }
+    m_gainCacheMobility.clear();
+    m_gainCache.clear();
     m_propagationLoss = nullptr;
     m_propagationDelay = nullptr;
     m_spectrumPropagationLoss = nullptr;
@@ -77,6 +102,25 @@ SpectrumChannel::GetTypeId()
                           MakePointerAccessor(&SpectrumChannel::m_propagationLoss),
                           MakePointerChecker<PropagationLossModel>())
 
+            .AddAttribute("GainCache",
+                          "If true, the antenna gains, propagation loss and delay "
+                          "computed for a pair of PHYs are reused for the next "
+                          "signals, as long as the PHYs do not move farther than "
+                          "GainCacheTolerance. Propagation loss models that are not "
+                          "deterministic bypass the cache.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&SpectrumChannel::m_gainCacheEnabled),
+                          MakeBooleanChecker())
+
+            .AddAttribute("GainCacheTolerance",
+                          "The distance (m) each PHY of a pair may move away from the "
+                          "position where their gains were computed before the gain "
+                          "cache computes them again. With 0, the cached gains are "
+                          "only reused for the exact same positions.",
+                          DoubleValue(0),
+                          MakeDoubleAccessor(&SpectrumChannel::m_gainCacheTolerance),
+                          MakeDoubleChecker<double>(0))
+
             .AddTraceSource("Gain",
                             "This trace is fired whenever a new path loss value "
                             "is calculated. The parameters to this trace are : "
@@ -196,6 +240,239 @@ SpectrumChannel::GetPropagationDelayModel() const
     return m_propagationDelay;
 }
 
+Time
+SpectrumChannel::GetMinPropagationDelay() const
+{
+    NS_LOG_FUNCTION(this);
+    if (!m_propagationDelay)
+    {
+        return Seconds(0);
+    }
+    // the mobility model of the phys is only set when they are initialized,
+    // so use the one of the nodes
+    std::vector<std::pair<uint32_t, Ptr<MobilityModel>>> nodes;
+    for (std::size_t i = 0; i < GetNDevices(); i++)
+    {
+        Ptr<NetDevice> device = GetDevice(i);
+        if (!device || !device->GetNode())
+        {
+            continue;
+        }
+        Ptr<MobilityModel> mobility = device->GetNode()->GetObject<MobilityModel>();
+        if (!mobility)
+        {
+            return Seconds(0);
+        }
+        nodes.emplace_back(device->GetNode()->GetId(), mobility);
+    }
+
+    Time delay = Time::Max();
+    for (std::size_t i = 0; i < nodes.size(); i++)
+    {
+        for (std::size_t j = i + 1; j < nodes.size(); j++)
+        {
+            if (nodes[i].first != nodes[j].first)
+            {
+                delay = std::min(delay,
+                                 m_propagationDelay->GetDelay(nodes[i].second, nodes[j].second));
+            }
+        }
+    }
+    return delay == Time::Max() ? Seconds(0) : delay;
+}
+
+uint64_t
+SpectrumChannel::GetGainCacheHits() const
+{
+#ifdef NS3_MULTITHREADED_ENABLE
+    std::lock_guard<std::recursive_mutex> lock(m_gainCacheMutex);
+#endif
+    return m_gainCacheHits;
+}
+
+uint64_t
+SpectrumChannel::GetGainCacheMisses() const
+{
+#ifdef NS3_MULTITHREADED_ENABLE
+    std::lock_guard<std::recursive_mutex> lock(m_gainCacheMutex);
+#endif
+    return m_gainCacheMisses;
+}
+
+SpectrumChannel::PathGain
+SpectrumChannel::CalcPathGain(Ptr<const SpectrumSignalParameters> txParams,
+                              Ptr<MobilityModel> txMobility,
+                              Ptr<const SpectrumPhy> rxPhy,
+                              Ptr<MobilityModel> rxMobility,
+                              bool withDelay) const
+{
+    PathGain gain{0, 0, 0, 0, 0, Seconds(0)};
+    if (txParams->txAntenna)
+    {
+        Angles txAngles(rxMobility->GetPosition(), txMobility->GetPosition());
+        gain.txAntennaGain = txParams->txAntenna->GetGainDb(txAngles);
+        NS_LOG_LOGIC("txAntennaGain = " << gain.txAntennaGain << " dB");
+        gain.pathLossDb -= gain.txAntennaGain;
+    }
+    Ptr<AntennaModel> rxAntenna = DynamicCast<AntennaModel>(rxPhy->GetAntenna());
+    if (rxAntenna)
+    {
+        Angles rxAngles(txMobility->GetPosition(), rxMobility->GetPosition());
+        gain.rxAntennaGain = rxAntenna->GetGainDb(rxAngles);
+        NS_LOG_LOGIC("rxAntennaGain = " << gain.rxAntennaGain << " dB");
+        gain.pathLossDb -= gain.rxAntennaGain;
+    }
+    if (m_propagationLoss)
+    {
+        gain.propagationGainDb = m_propagationLoss->CalcRxPower(0, txMobility, rxMobility);
+        NS_LOG_LOGIC("propagationGainDb = " << gain.propagationGainDb << " dB");
+        gain.pathLossDb -= gain.propagationGainDb;
+    }
+    NS_LOG_LOGIC("total pathLoss = " << gain.pathLossDb << " dB");
+    if (gain.pathLossDb <= m_maxLossDb)
+    {
+        gain.pathGainLinear = std::pow(10.0, (-gain.pathLossDb) / 10.0);
+        if (withDelay && m_propagationDelay)
+        {
+            gain.delay = m_propagationDelay->GetDelay(txMobility, rxMobility);
+        }
+    }
+    return gain;
+}
+
+SpectrumChannel::PathGain
+SpectrumChannel::GetPathGain(Ptr<const SpectrumSignalParameters> txParams,
+                             Ptr<MobilityModel> txMobility,
+                             Ptr<const SpectrumPhy> rxPhy,
+                             Ptr<MobilityModel> rxMobility)
+{
+    if (!m_gainCacheEnabled || (m_propagationLoss && !m_propagationLoss->IsDeterministic()))
+    {
+        return CalcPathGain(txParams, txMobility, rxPhy, rxMobility, true);
+    }
+    // the delays of the other models may be random
+    bool withDelay = !m_propagationDelay ||
+                     DynamicCast<ConstantSpeedPropagationDelayModel>(m_propagationDelay);
+
+#ifdef NS3_MULTITHREADED_ENABLE
+    std::lock_guard<std::recursive_mutex> lock(m_gainCacheMutex);
+#endif
+    const GainCacheMobility& tx = TrackGainCacheMobility(txMobility);
+    const GainCacheMobility& rx = TrackGainCacheMobility(rxMobility);
+    auto [entry, inserted] =
+        m_gainCache.try_emplace(GainCacheKey(PeekPointer(txParams->txPhy), PeekPointer(rxPhy)));
+    GainCacheEntry& cached = entry->second;
+    if (!inserted && cached.txAntenna == PeekPointer(txParams->txAntenna))
+    {
+        if (tx.notifying && rx.notifying && !tx.moving && !rx.moving &&
+            cached.txCourseChanges == tx.courseChanges &&
+            cached.rxCourseChanges == rx.courseChanges)
+        {
+            // neither PHY moved since the gains were computed
+            m_gainCacheHits++;
+        }
+        else
+        {
+            Vector txPosition = txMobility->GetPosition();
+            Vector rxPosition = rxMobility->GetPosition();
+            if (CalculateDistance(txPosition, cached.txPosition) > m_gainCacheTolerance ||
+                CalculateDistance(rxPosition, cached.rxPosition) > m_gainCacheTolerance)
+            {
+                inserted = true;
+            }
+            else
+            {
+                m_gainCacheHits++;
+                cached.txCourseChanges = tx.courseChanges;
+                cached.rxCourseChanges = rx.courseChanges;
+            }
+        }
+        if (!inserted)
+        {
+            PathGain gain = cached.gain;
+            if (!cached.withDelay && m_propagationDelay && gain.pathLossDb <= m_maxLossDb)
+            {
+                gain.delay = m_propagationDelay->GetDelay(txMobility, rxMobility);
+            }
+            return gain;
+        }
+    }
+
+    m_gainCacheMisses++;
+    cached.gain = CalcPathGain(txParams, txMobility, rxPhy, rxMobility, withDelay);
+    cached.withDelay = withDelay;
+    cached.txAntenna = PeekPointer(txParams->txAntenna);
+    cached.txPosition = txMobility->GetPosition();
+    cached.rxPosition = rxMobility->GetPosition();
+    cached.txCourseChanges = tx.courseChanges;
+    cached.rxCourseChanges = rx.courseChanges;
+    PathGain gain = cached.gain;
+    if (!withDelay && m_propagationDelay && gain.pathLossDb <= m_maxLossDb)
+    {
+        gain.delay = m_propagationDelay->GetDelay(txMobility, rxMobility);
+    }
+    return gain;
+}
+
+const SpectrumChannel::GainCacheMobility&
+SpectrumChannel::TrackGainCacheMobility(Ptr<MobilityModel> mobility)
+{
+    auto [tracked, inserted] = m_gainCacheMobility.try_emplace(PeekPointer(mobility));
+    if (inserted)
+    {
+        tracked->second.mobility = mobility;
+        tracked->second.courseChanges = 0;
+        tracked->second.moving = mobility->GetVelocity().GetLength() > 0;
+        tracked->second.notifying = DynamicCast<ConstantPositionMobilityModel>(mobility) ||
+                                    DynamicCast<ConstantVelocityMobilityModel>(mobility) ||
+                                    DynamicCast<ConstantAccelerationMobilityModel>(mobility);
+        mobility->TraceConnectWithoutContext(
+            "CourseChange",
+            MakeCallback(&SpectrumChannel::NotifyGainCacheCourseChange, this));
+    }
+    return tracked->second;
+}
+
+void
+SpectrumChannel::NotifyGainCacheCourseChange(Ptr<const MobilityModel> mobility)
+{
+#ifdef NS3_MULTITHREADED_ENABLE
+    std::lock_guard<std::recursive_mutex> lock(m_gainCacheMutex);
+#endif
+    auto tracked = m_gainCacheMobility.find(PeekPointer(mobility));
+    if (tracked != m_gainCacheMobility.end())
+    {
+        tracked->second.courseChanges++;
+        tracked->second.moving = mobility->GetVelocity().GetLength() > 0;
+    }
+}
+
+void
+SpectrumChannel::ClearGainCache(Ptr<const SpectrumPhy> phy)
+{
+#ifdef NS3_MULTITHREADED_ENABLE
+    std::lock_guard<std::recursive_mutex> lock(m_gainCacheMutex);
+#endif
+    for (auto it = m_gainCache.begin(); it != m_gainCache.end();)
+    {
+        if (it->first.first == PeekPointer(phy) || it->first.second == PeekPointer(phy))
+        {
+            it = m_gainCache.erase(it);
+        }
+        else
+        {
+            it++;
+        }
+    }
+}
+
+std::size_t
+SpectrumChannel::GainCacheKeyHash::operator()(const GainCacheKey& key) const
+{
+    return std::hash<const SpectrumPhy*>()(key.first) * 31 +
+           std::hash<const SpectrumPhy*>()(key.second);
+}
+
 int64_t
 SpectrumChannel::AssignStreams(int64_t stream)
 {
@@ -34,6 +34,13 @@
 #include <ns3/propagation-loss-model.h>
 #include <ns3/traced-callback.h>
 
+#include <unordered_map>
+#include <utility>
+
+#ifdef NS3_MULTITHREADED_ENABLE
+#include <mutex>
+#endif
+
 namespace ns3
 {
 
@@ -125,6 +132,32 @@ class SpectrumChannel : public Channel
      */
     Ptr<PropagationDelayModel> GetPropagationDelayModel() const;
 
+    /**
+     * Get the smallest propagation delay between two devices of different
+     * nodes attached to the channel, at their current position.
+     *
+     * This is the lookahead to use with MultithreadedSimulatorImpl when the
+     * nodes only interact through the channel. It is only meaningful with a
+     * deterministic delay model, such as ConstantSpeedPropagationDelayModel,
+     * and as long as the nodes do not get closer.
+     *
+     * \returns the smallest delay, or zero if no propagation delay model is
+     * set, or if a device has no mobility model.
+     */
+    Time GetMinPropagationDelay() const;
+
+    /**
+     * \return the number of gain computations served by the gain cache
+     */
+    uint64_t GetGainCacheHits() const;
+
+    /**
+     * \return the number of gain computations made while the gain cache was
+     * enabled, because no gains were cached for the pair of PHYs or they were
+     * computed too far away
+     */
+    uint64_t GetGainCacheMisses() const;
+
     /**
      * Add the transmit filter to be used to filter possible signal receptions
      * at the StartTx() time.  This method may be called multiple
@@ -229,6 +262,14 @@ class SpectrumChannel : public Channel
     typedef void (*SignalParametersTracedCallback)(Ptr<SpectrumSignalParameters> params);
 
   protected:
+    /**
+     * Forgets the gains cached for a PHY. Called when the PHY is removed
+     * from the channel, since another PHY may later get its address.
+     *
+     * \param phy the PHY
+     */
+    void ClearGainCache(Ptr<const SpectrumPhy> phy);
+
     /**
      * This provides a base class implementation that may be subclassed
      * if needed by subclasses that might need additional stream assignments.
@@ -238,6 +279,45 @@ class SpectrumChannel : public Channel
      */
     virtual int64_t DoAssignStreams(int64_t stream);
 
+    /// The gains of a signal from a transmitter to a receiver
+    struct PathGain
+    {
+        double txAntennaGain;     //!< TX antenna gain (dB)
+        double rxAntennaGain;     //!< RX antenna gain (dB)
+        double propagationGainDb; //!< gain of the propagation loss model (dB)
+        double pathLossDb;        //!< total path loss (dB)
+        double pathGainLinear;    //!< linear gain, only set within MaxLossDb
+        Time delay;               //!< propagation delay, only set within MaxLossDb
+    };
+
+    /**
+     * Computes the gains of a signal from a transmitter to a receiver, from
+     * the antenna models, the single-frequency propagation loss model and the
+     * propagation delay model.
+     *
+     * When the GainCache attribute is set, the gains computed for a pair of
+     * PHYs are kept, and returned again as long as neither PHY moved farther
+     * than GainCacheTolerance from where they were computed. The PHYs whose
+     * ConstantPosition, ConstantVelocity or ConstantAcceleration mobility
+     * model is still since its last CourseChange are not even polled for
+     * their position; the other models, which may only update their
+     * position when it is read, are always polled. The cache is bypassed when the propagation
+     * loss model is not deterministic (PropagationLossModel::IsDeterministic),
+     * and the delay is only cached with ConstantSpeedPropagationDelayModel.
+     * The cache does not follow the changes of the orientation or of the
+     * configuration of the antennas.
+     *
+     * \param txParams the parameters of the transmitted signal
+     * \param txMobility the mobility model of the transmitter
+     * \param rxPhy the receiver
+     * \param rxMobility the mobility model of the receiver
+     * \return the gains
+     */
+    PathGain GetPathGain(Ptr<const SpectrumSignalParameters> txParams,
+                         Ptr<MobilityModel> txMobility,
+                         Ptr<const SpectrumPhy> rxPhy,
+                         Ptr<MobilityModel> rxMobility);
+
     /**
      * The `PathLoss` trace source. Exporting the pointers to the Tx and Rx
      * SpectrumPhy and a pathloss value, in dB.
@@ -293,6 +373,86 @@ class SpectrumChannel : public Channel
      * Transmit filter to be used with this channel
      */
     Ptr<SpectrumTransmitFilter> m_filter{nullptr};
+
+  private:
+    /**
+     * Computes the gains of a signal, without the gain cache.
+     *
+     * \param txParams the parameters of the transmitted signal
+     * \param txMobility the mobility model of the transmitter
+     * \param rxPhy the receiver
+     * \param rxMobility the mobility model of the receiver
+     * \param withDelay whether to compute the propagation delay
+     * \return the gains
+     */
+    PathGain CalcPathGain(Ptr<const SpectrumSignalParameters> txParams,
+                          Ptr<MobilityModel> txMobility,
+                          Ptr<const SpectrumPhy> rxPhy,
+                          Ptr<MobilityModel> rxMobility,
+                          bool withDelay) const;
+
+    /// A mobility model followed by the gain cache
+    struct GainCacheMobility
+    {
+        Ptr<MobilityModel> mobility; //!< the mobility model
+        uint64_t courseChanges;      //!< number of CourseChange notifications
+        bool moving;                 //!< non-zero velocity at the last CourseChange
+        bool notifying;              //!< fires CourseChange whenever its course changes
+    };
+
+    /**
+     * Starts following the course changes of a mobility model, if not yet done.
+     *
+     * \param mobility the mobility model
+     * \return its state
+     */
+    const GainCacheMobility& TrackGainCacheMobility(Ptr<MobilityModel> mobility);
+
+    /**
+     * Records the course change of a mobility model.
+     *
+     * \param mobility the mobility model that changed course
+     */
+    void NotifyGainCacheCourseChange(Ptr<const MobilityModel> mobility);
+
+    /// The gains cached for a pair of PHYs
+    struct GainCacheEntry
+    {
+        PathGain gain;              //!< the gains
+        bool withDelay;             //!< whether gain.delay is cached
+        const Object* txAntenna;    //!< the TX antenna of the signal
+        Vector txPosition;          //!< position of the transmitter
+        Vector rxPosition;          //!< position of the receiver
+        uint64_t txCourseChanges;   //!< CourseChange count of the transmitter
+        uint64_t rxCourseChanges;   //!< CourseChange count of the receiver
+    };
+
+    /// Key of the gain cache: the TX and RX PHYs
+    typedef std::pair<const SpectrumPhy*, const SpectrumPhy*> GainCacheKey;
+
+    /// Hash of GainCacheKey
+    struct GainCacheKeyHash
+    {
+        /**
+         * \param key the key
+         * \return the hash of the key
+         */
+        std::size_t operator()(const GainCacheKey& key) const;
+    };
+
+    bool m_gainCacheEnabled;      //!< true if the gain cache is used
+    double m_gainCacheTolerance;  //!< distance (m) the PHYs may move before recomputing
+    /// The cached gains, by pair of PHYs
+    std::unordered_map<GainCacheKey, GainCacheEntry, GainCacheKeyHash> m_gainCache;
+    /// The mobility models whose CourseChange trace is connected
+    std::unordered_map<const MobilityModel*, GainCacheMobility> m_gainCacheMobility;
+    uint64_t m_gainCacheHits;     //!< gains served by the gain cache
+    uint64_t m_gainCacheMisses;   //!< gains computed with the gain cache enabled
+#ifdef NS3_MULTITHREADED_ENABLE
+    /// Protects the gain cache from the threads of MultithreadedSimulatorImpl.
+    /// Reading a position may notify a course change while it is held.
+    mutable std::recursive_mutex m_gainCacheMutex;
+#endif
 };
 
 } // namespace ns3
@@ -67,6 +67,7 @@ SpectrumModel::SpectrumModel(const std::vector<double>& centerFreqs)
         }
         m_bands.push_back(e);
     }
+    ComputeBandWidths();
 }
 
 SpectrumModel::SpectrumModel(const Bands& bands)
@@ -74,6 +75,7 @@ SpectrumModel::SpectrumModel(const Bands& bands)
     m_uid = ++m_uidCount;
     NS_LOG_INFO("creating new SpectrumModel, m_uid=" << m_uid);
     m_bands = bands;
+    ComputeBandWidths();
 }
 
 SpectrumModel::SpectrumModel(Bands&& bands)
@@ -81,6 +83,23 @@ SpectrumModel::SpectrumModel(Bands&& bands)
 {
     m_uid = ++m_uidCount;
     NS_LOG_INFO("creating new SpectrumModel, m_uid=" << m_uid);
+    ComputeBandWidths();
+}
+
+void
+SpectrumModel::ComputeBandWidths()
+{
+    m_bandWidths.reserve(m_bands.size());
+    for (const auto& band : m_bands)
+    {
+        m_bandWidths.push_back(band.fh - band.fl);
+    }
+}
+
+const std::vector<double>&
+SpectrumModel::GetBandWidths() const
+{
+    return m_bandWidths;
 }
 
 Bands::const_iterator
@@ -141,9 +141,23 @@ class SpectrumModel : public SimpleRefCount<SpectrumModel>
      */
     bool IsOrthogonal(const SpectrumModel& other) const;
 
+    /**
+     * The widths (fh - fl) of the bands, in the order of the bands. They
+     * are computed once, for the integrals of the SpectrumValues.
+     *
+     * @return the band widths in Hz
+     */
+    const std::vector<double>& GetBandWidths() const;
+
   private:
-    Bands m_bands;            //!< Actual definition of frequency bands within this SpectrumModel
-    SpectrumModelUid_t m_uid; //!< unique id for a given set of frequencies
+    /**
+     * Compute m_bandWidths from m_bands.
+     */
+    void ComputeBandWidths();
+
+    Bands m_bands; //!< Actual definition of frequency bands within this SpectrumModel
+    std::vector<double> m_bandWidths;     //!< fh - fl of each band
+    SpectrumModelUid_t m_uid;             //!< unique id for a given set of frequencies
     static SpectrumModelUid_t m_uidCount; //!< counter to assign m_uids
 };
 
@@ -23,11 +23,662 @@
 #include <ns3/log.h>
 #include <ns3/math.h>
 
+#include <cstddef>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SPECTRUM_VALUE_X86_KERNELS
+#include <immintrin.h>
+#endif
+
 namespace ns3
 {
 
 NS_LOG_COMPONENT_DEFINE("SpectrumValue");
 
+namespace
+{
+
+/*
+ * Arithmetic kernels of SpectrumValue, one set per instruction set.
+ *
+ * The element-wise operations are exact in IEEE 754, so every set gives the
+ * same values. The reductions are only used with SetPartialSums(true); Sum,
+ * Norm and Integral otherwise add the values in order, as they always did.
+ * The reductions keep PARTIAL_SUMS partial sums, element i going
+ * to the sum i % PARTIAL_SUMS, combine them pairwise and then add the
+ * remaining elements in order. Four AVX2 registers, eight SSE2 registers and
+ * the scalar loops all follow that order, so the simulation results do not
+ * depend on the CPU running them. Below PARTIAL_SUMS values, the sums are the
+ * plain sequential ones. For the same reason the
+ * products are not fused with the sums, unless the build itself enables FMA
+ * (e.g. NS3_NATIVE_OPTIMIZATIONS) and lets the compiler contract them.
+ *
+ * The scalar kernels are in use until the static initialization of this file
+ * selects the best set, so that SpectrumValues computed by other static
+ * initializers are safe.
+ */
+
+/// Kernels for one instruction set
+struct Kernels
+{
+    void (*add)(double* x, const double* y, std::size_t n);      //!< x += y
+    void (*subtract)(double* x, const double* y, std::size_t n); //!< x -= y
+    void (*multiply)(double* x, const double* y, std::size_t n); //!< x *= y
+    void (*divide)(double* x, const double* y, std::size_t n);   //!< x /= y
+    void (*addScalar)(double* x, double s, std::size_t n);       //!< x += s
+    void (*multiplyScalar)(double* x, double s, std::size_t n);  //!< x *= s
+    void (*divideScalar)(double* x, double s, std::size_t n);    //!< x /= s
+    double (*sum)(const double* x, std::size_t n);               //!< sum of x
+    double (*sumSquares)(const double* x, std::size_t n);        //!< sum of x * x
+    double (*dot)(const double* x, const double* y, std::size_t n); //!< sum of x * y
+};
+
+void
+ScalarAdd(double* x, const double* y, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; i++)
+    {
+        x[i] += y[i];
+    }
+}
+
+void
+ScalarSubtract(double* x, const double* y, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; i++)
+    {
+        x[i] -= y[i];
+    }
+}
+
+void
+ScalarMultiply(double* x, const double* y, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; i++)
+    {
+        x[i] *= y[i];
+    }
+}
+
+void
+ScalarDivide(double* x, const double* y, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; i++)
+    {
+        x[i] /= y[i];
+    }
+}
+
+void
+ScalarAddScalar(double* x, double s, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; i++)
+    {
+        x[i] += s;
+    }
+}
+
+void
+ScalarMultiplyScalar(double* x, double s, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; i++)
+    {
+        x[i] *= s;
+    }
+}
+
+void
+ScalarDivideScalar(double* x, double s, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; i++)
+    {
+        x[i] /= s;
+    }
+}
+
+/// Number of partial sums of the reductions
+constexpr std::size_t PARTIAL_SUMS = 16;
+
+/**
+ * Combine the partial sums of a reduction, pairwise.
+ * \param p the PARTIAL_SUMS partial sums
+ * \return the sum of the partial sums
+ */
+double
+CombinePartialSums(const double* p)
+{
+    static_assert(PARTIAL_SUMS == 16, "the tree below combines 16 partial sums");
+    double a0 = p[0] + p[1];
+    double a1 = p[2] + p[3];
+    double a2 = p[4] + p[5];
+    double a3 = p[6] + p[7];
+    double a4 = p[8] + p[9];
+    double a5 = p[10] + p[11];
+    double a6 = p[12] + p[13];
+    double a7 = p[14] + p[15];
+    return ((a0 + a1) + (a2 + a3)) + ((a4 + a5) + (a6 + a7));
+}
+
+/**
+ * Sum the products x[i] * y[i], or the x[i] alone if y is null, in order.
+ * This is the reduction of the values that do not fill PARTIAL_SUMS.
+ * \param r the initial sum
+ * \param x the first values
+ * \param y the second values, or nullptr
+ * \param n the number of values
+ * \return the sum
+ */
+double
+SequentialSum(double r, const double* x, const double* y, std::size_t n)
+{
+    if (y)
+    {
+        for (std::size_t i = 0; i < n; i++)
+        {
+            r += x[i] * y[i];
+        }
+    }
+    else
+    {
+        for (std::size_t i = 0; i < n; i++)
+        {
+            r += x[i];
+        }
+    }
+    return r;
+}
+
+double
+ScalarSum(const double* x, std::size_t n)
+{
+    if (n < PARTIAL_SUMS)
+    {
+        return SequentialSum(0, x, nullptr, n);
+    }
+    // named accumulators, which the compiler keeps in registers
+    static_assert(PARTIAL_SUMS == 16, "16 partial sums");
+    double s0 = x[0];
+    double s1 = x[1];
+    double s2 = x[2];
+    double s3 = x[3];
+    double s4 = x[4];
+    double s5 = x[5];
+    double s6 = x[6];
+    double s7 = x[7];
+    double s8 = x[8];
+    double s9 = x[9];
+    double s10 = x[10];
+    double s11 = x[11];
+    double s12 = x[12];
+    double s13 = x[13];
+    double s14 = x[14];
+    double s15 = x[15];
+    std::size_t i = PARTIAL_SUMS;
+    for (; i + PARTIAL_SUMS <= n; i += PARTIAL_SUMS)
+    {
+        s0 += x[i];
+        s1 += x[i + 1];
+        s2 += x[i + 2];
+        s3 += x[i + 3];
+        s4 += x[i + 4];
+        s5 += x[i + 5];
+        s6 += x[i + 6];
+        s7 += x[i + 7];
+        s8 += x[i + 8];
+        s9 += x[i + 9];
+        s10 += x[i + 10];
+        s11 += x[i + 11];
+        s12 += x[i + 12];
+        s13 += x[i + 13];
+        s14 += x[i + 14];
+        s15 += x[i + 15];
+    }
+    double partial[PARTIAL_SUMS] = {s0, s1, s2, s3, s4, s5, s6, s7,
+                                    s8, s9, s10, s11, s12, s13, s14, s15};
+    return SequentialSum(CombinePartialSums(partial), x + i, nullptr, n - i);
+}
+
+double
+ScalarDot(const double* x, const double* y, std::size_t n)
+{
+    if (n < PARTIAL_SUMS)
+    {
+        return SequentialSum(0, x, y, n);
+    }
+    // named accumulators, which the compiler keeps in registers
+    static_assert(PARTIAL_SUMS == 16, "16 partial sums");
+    double s0 = x[0] * y[0];
+    double s1 = x[1] * y[1];
+    double s2 = x[2] * y[2];
+    double s3 = x[3] * y[3];
+    double s4 = x[4] * y[4];
+    double s5 = x[5] * y[5];
+    double s6 = x[6] * y[6];
+    double s7 = x[7] * y[7];
+    double s8 = x[8] * y[8];
+    double s9 = x[9] * y[9];
+    double s10 = x[10] * y[10];
+    double s11 = x[11] * y[11];
+    double s12 = x[12] * y[12];
+    double s13 = x[13] * y[13];
+    double s14 = x[14] * y[14];
+    double s15 = x[15] * y[15];
+    std::size_t i = PARTIAL_SUMS;
+    for (; i + PARTIAL_SUMS <= n; i += PARTIAL_SUMS)
+    {
+        s0 += x[i] * y[i];
+        s1 += x[i + 1] * y[i + 1];
+        s2 += x[i + 2] * y[i + 2];
+        s3 += x[i + 3] * y[i + 3];
+        s4 += x[i + 4] * y[i + 4];
+        s5 += x[i + 5] * y[i + 5];
+        s6 += x[i + 6] * y[i + 6];
+        s7 += x[i + 7] * y[i + 7];
+        s8 += x[i + 8] * y[i + 8];
+        s9 += x[i + 9] * y[i + 9];
+        s10 += x[i + 10] * y[i + 10];
+        s11 += x[i + 11] * y[i + 11];
+        s12 += x[i + 12] * y[i + 12];
+        s13 += x[i + 13] * y[i + 13];
+        s14 += x[i + 14] * y[i + 14];
+        s15 += x[i + 15] * y[i + 15];
+    }
+    double partial[PARTIAL_SUMS] = {s0, s1, s2, s3, s4, s5, s6, s7,
+                                    s8, s9, s10, s11, s12, s13, s14, s15};
+    return SequentialSum(CombinePartialSums(partial), x + i, y + i, n - i);
+}
+
+double
+ScalarSumSquares(const double* x, std::size_t n)
+{
+    return ScalarDot(x, x, n);
+}
+
+/// Portable kernels
+const Kernels g_scalarKernels = {ScalarAdd,
+                                 ScalarSubtract,
+                                 ScalarMultiply,
+                                 ScalarDivide,
+                                 ScalarAddScalar,
+                                 ScalarMultiplyScalar,
+                                 ScalarDivideScalar,
+                                 ScalarSum,
+                                 ScalarSumSquares,
+                                 ScalarDot};
+
+#ifdef SPECTRUM_VALUE_X86_KERNELS
+
+/**
+ * Define an element-wise SSE2 kernel of two vectors.
+ * \param name the name of the kernel
+ * \param op the scalar operator
+ * \param intrinsic the SSE2 intrinsic
+ */
+#define SSE2_VECTOR_KERNEL(name, op, intrinsic)                                                    \
+    __attribute__((target("sse2"))) void name(double* x, const double* y, std::size_t n)          \
+    {                                                                                              \
+        std::size_t i = 0;                                                                         \
+        for (; i + 2 <= n; i += 2)                                                                 \
+        {                                                                                          \
+            _mm_storeu_pd(x + i, intrinsic(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));             \
+        }                                                                                          \
+        for (; i < n; i++)                                                                         \
+        {                                                                                          \
+            x[i] op y[i];                                                                          \
+        }                                                                                          \
+    }
+
+/**
+ * Define an SSE2 kernel of a vector and a scalar.
+ * \param name the name of the kernel
+ * \param op the scalar operator
+ * \param intrinsic the SSE2 intrinsic
+ */
+#define SSE2_SCALAR_KERNEL(name, op, intrinsic)                                                    \
+    __attribute__((target("sse2"))) void name(double* x, double s, std::size_t n)                  \
+    {                                                                                              \
+        __m128d vs = _mm_set1_pd(s);                                                               \
+        std::size_t i = 0;                                                                         \
+        for (; i + 2 <= n; i += 2)                                                                 \
+        {                                                                                          \
+            _mm_storeu_pd(x + i, intrinsic(_mm_loadu_pd(x + i), vs));                              \
+        }                                                                                          \
+        for (; i < n; i++)                                                                         \
+        {                                                                                          \
+            x[i] op s;                                                                             \
+        }                                                                                          \
+    }
+
+SSE2_VECTOR_KERNEL(Sse2Add, +=, _mm_add_pd)
+SSE2_VECTOR_KERNEL(Sse2Subtract, -=, _mm_sub_pd)
+SSE2_VECTOR_KERNEL(Sse2Multiply, *=, _mm_mul_pd)
+SSE2_VECTOR_KERNEL(Sse2Divide, /=, _mm_div_pd)
+SSE2_SCALAR_KERNEL(Sse2AddScalar, +=, _mm_add_pd)
+SSE2_SCALAR_KERNEL(Sse2MultiplyScalar, *=, _mm_mul_pd)
+SSE2_SCALAR_KERNEL(Sse2DivideScalar, /=, _mm_div_pd)
+
+__attribute__((target("sse2"))) double
+Sse2Sum(const double* x, std::size_t n)
+{
+    if (n < PARTIAL_SUMS)
+    {
+        return SequentialSum(0, x, nullptr, n);
+    }
+    static_assert(PARTIAL_SUMS == 16, "8 registers of 2 partial sums");
+    __m128d a0 = _mm_loadu_pd(x);
+    __m128d a1 = _mm_loadu_pd(x + 2);
+    __m128d a2 = _mm_loadu_pd(x + 4);
+    __m128d a3 = _mm_loadu_pd(x + 6);
+    __m128d a4 = _mm_loadu_pd(x + 8);
+    __m128d a5 = _mm_loadu_pd(x + 10);
+    __m128d a6 = _mm_loadu_pd(x + 12);
+    __m128d a7 = _mm_loadu_pd(x + 14);
+    std::size_t i = PARTIAL_SUMS;
+    for (; i + PARTIAL_SUMS <= n; i += PARTIAL_SUMS)
+    {
+        a0 = _mm_add_pd(a0, _mm_loadu_pd(x + i));
+        a1 = _mm_add_pd(a1, _mm_loadu_pd(x + i + 2));
+        a2 = _mm_add_pd(a2, _mm_loadu_pd(x + i + 4));
+        a3 = _mm_add_pd(a3, _mm_loadu_pd(x + i + 6));
+        a4 = _mm_add_pd(a4, _mm_loadu_pd(x + i + 8));
+        a5 = _mm_add_pd(a5, _mm_loadu_pd(x + i + 10));
+        a6 = _mm_add_pd(a6, _mm_loadu_pd(x + i + 12));
+        a7 = _mm_add_pd(a7, _mm_loadu_pd(x + i + 14));
+    }
+    double partial[PARTIAL_SUMS];
+    _mm_storeu_pd(partial, a0);
+    _mm_storeu_pd(partial + 2, a1);
+    _mm_storeu_pd(partial + 4, a2);
+    _mm_storeu_pd(partial + 6, a3);
+    _mm_storeu_pd(partial + 8, a4);
+    _mm_storeu_pd(partial + 10, a5);
+    _mm_storeu_pd(partial + 12, a6);
+    _mm_storeu_pd(partial + 14, a7);
+    return SequentialSum(CombinePartialSums(partial), x + i, nullptr, n - i);
+}
+
+__attribute__((target("sse2"))) double
+Sse2Dot(const double* x, const double* y, std::size_t n)
+{
+    if (n < PARTIAL_SUMS)
+    {
+        return SequentialSum(0, x, y, n);
+    }
+    static_assert(PARTIAL_SUMS == 16, "8 registers of 2 partial sums");
+    __m128d a0 = _mm_mul_pd(_mm_loadu_pd(x), _mm_loadu_pd(y));
+    __m128d a1 = _mm_mul_pd(_mm_loadu_pd(x + 2), _mm_loadu_pd(y + 2));
+    __m128d a2 = _mm_mul_pd(_mm_loadu_pd(x + 4), _mm_loadu_pd(y + 4));
+    __m128d a3 = _mm_mul_pd(_mm_loadu_pd(x + 6), _mm_loadu_pd(y + 6));
+    __m128d a4 = _mm_mul_pd(_mm_loadu_pd(x + 8), _mm_loadu_pd(y + 8));
+    __m128d a5 = _mm_mul_pd(_mm_loadu_pd(x + 10), _mm_loadu_pd(y + 10));
+    __m128d a6 = _mm_mul_pd(_mm_loadu_pd(x + 12), _mm_loadu_pd(y + 12));
+    __m128d a7 = _mm_mul_pd(_mm_loadu_pd(x + 14), _mm_loadu_pd(y + 14));
+    std::size_t i = PARTIAL_SUMS;
+    for (; i + PARTIAL_SUMS <= n; i += PARTIAL_SUMS)
+    {
+        a0 = _mm_add_pd(a0, _mm_mul_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+        a1 = _mm_add_pd(a1, _mm_mul_pd(_mm_loadu_pd(x + i + 2), _mm_loadu_pd(y + i + 2)));
+        a2 = _mm_add_pd(a2, _mm_mul_pd(_mm_loadu_pd(x + i + 4), _mm_loadu_pd(y + i + 4)));
+        a3 = _mm_add_pd(a3, _mm_mul_pd(_mm_loadu_pd(x + i + 6), _mm_loadu_pd(y + i + 6)));
+        a4 = _mm_add_pd(a4, _mm_mul_pd(_mm_loadu_pd(x + i + 8), _mm_loadu_pd(y + i + 8)));
+        a5 = _mm_add_pd(a5, _mm_mul_pd(_mm_loadu_pd(x + i + 10), _mm_loadu_pd(y + i + 10)));
+        a6 = _mm_add_pd(a6, _mm_mul_pd(_mm_loadu_pd(x + i + 12), _mm_loadu_pd(y + i + 12)));
+        a7 = _mm_add_pd(a7, _mm_mul_pd(_mm_loadu_pd(x + i + 14), _mm_loadu_pd(y + i + 14)));
+    }
+    double partial[PARTIAL_SUMS];
+    _mm_storeu_pd(partial, a0);
+    _mm_storeu_pd(partial + 2, a1);
+    _mm_storeu_pd(partial + 4, a2);
+    _mm_storeu_pd(partial + 6, a3);
+    _mm_storeu_pd(partial + 8, a4);
+    _mm_storeu_pd(partial + 10, a5);
+    _mm_storeu_pd(partial + 12, a6);
+    _mm_storeu_pd(partial + 14, a7);
+    return SequentialSum(CombinePartialSums(partial), x + i, y + i, n - i);
+}
+
+__attribute__((target("sse2"))) double
+Sse2SumSquares(const double* x, std::size_t n)
+{
+    return Sse2Dot(x, x, n);
+}
+
+/// SSE2 kernels
+const Kernels g_sse2Kernels = {Sse2Add,
+                               Sse2Subtract,
+                               Sse2Multiply,
+                               Sse2Divide,
+                               Sse2AddScalar,
+                               Sse2MultiplyScalar,
+                               Sse2DivideScalar,
+                               Sse2Sum,
+                               Sse2SumSquares,
+                               Sse2Dot};
+
+/**
+ * Define an element-wise AVX2 kernel of two vectors.
+ * \param name the name of the kernel
+ * \param op the scalar operator
+ * \param intrinsic the AVX intrinsic
+ */
+#define AVX2_VECTOR_KERNEL(name, op, intrinsic)                                                    \
+    __attribute__((target("avx2"))) void name(double* x, const double* y, std::size_t n)          \
+    {                                                                                              \
+        std::size_t i = 0;                                                                         \
+        for (; i + 4 <= n; i += 4)                                                                 \
+        {                                                                                          \
+            _mm256_storeu_pd(x + i, intrinsic(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));    \
+        }                                                                                          \
+        for (; i < n; i++)                                                                         \
+        {                                                                                          \
+            x[i] op y[i];                                                                          \
+        }                                                                                          \
+    }
+
+/**
+ * Define an AVX2 kernel of a vector and a scalar.
+ * \param name the name of the kernel
+ * \param op the scalar operator
+ * \param intrinsic the AVX intrinsic
+ */
+#define AVX2_SCALAR_KERNEL(name, op, intrinsic)                                                    \
+    __attribute__((target("avx2"))) void name(double* x, double s, std::size_t n)                  \
+    {                                                                                              \
+        __m256d vs = _mm256_set1_pd(s);                                                            \
+        std::size_t i = 0;                                                                         \
+        for (; i + 4 <= n; i += 4)                                                                 \
+        {                                                                                          \
+            _mm256_storeu_pd(x + i, intrinsic(_mm256_loadu_pd(x + i), vs));                        \
+        }                                                                                          \
+        for (; i < n; i++)                                                                         \
+        {                                                                                          \
+            x[i] op s;                                                                             \
+        }                                                                                          \
+    }
+
+AVX2_VECTOR_KERNEL(Avx2Add, +=, _mm256_add_pd)
+AVX2_VECTOR_KERNEL(Avx2Subtract, -=, _mm256_sub_pd)
+AVX2_VECTOR_KERNEL(Avx2Multiply, *=, _mm256_mul_pd)
+AVX2_VECTOR_KERNEL(Avx2Divide, /=, _mm256_div_pd)
+AVX2_SCALAR_KERNEL(Avx2AddScalar, +=, _mm256_add_pd)
+AVX2_SCALAR_KERNEL(Avx2MultiplyScalar, *=, _mm256_mul_pd)
+AVX2_SCALAR_KERNEL(Avx2DivideScalar, /=, _mm256_div_pd)
+
+__attribute__((target("avx2"))) double
+Avx2Sum(const double* x, std::size_t n)
+{
+    if (n < PARTIAL_SUMS)
+    {
+        return SequentialSum(0, x, nullptr, n);
+    }
+    static_assert(PARTIAL_SUMS == 16, "4 registers of 4 partial sums");
+    __m256d a0 = _mm256_loadu_pd(x);
+    __m256d a1 = _mm256_loadu_pd(x + 4);
+    __m256d a2 = _mm256_loadu_pd(x + 8);
+    __m256d a3 = _mm256_loadu_pd(x + 12);
+    std::size_t i = PARTIAL_SUMS;
+    for (; i + PARTIAL_SUMS <= n; i += PARTIAL_SUMS)
+    {
+        a0 = _mm256_add_pd(a0, _mm256_loadu_pd(x + i));
+        a1 = _mm256_add_pd(a1, _mm256_loadu_pd(x + i + 4));
+        a2 = _mm256_add_pd(a2, _mm256_loadu_pd(x + i + 8));
+        a3 = _mm256_add_pd(a3, _mm256_loadu_pd(x + i + 12));
+    }
+    double partial[PARTIAL_SUMS];
+    _mm256_storeu_pd(partial, a0);
+    _mm256_storeu_pd(partial + 4, a1);
+    _mm256_storeu_pd(partial + 8, a2);
+    _mm256_storeu_pd(partial + 12, a3);
+    // the rest runs SSE code, which stalls while the upper halves are in use
+    _mm256_zeroupper();
+    return SequentialSum(CombinePartialSums(partial), x + i, nullptr, n - i);
+}
+
+__attribute__((target("avx2"))) double
+Avx2Dot(const double* x, const double* y, std::size_t n)
+{
+    if (n < PARTIAL_SUMS)
+    {
+        return SequentialSum(0, x, y, n);
+    }
+    static_assert(PARTIAL_SUMS == 16, "4 registers of 4 partial sums");
+    __m256d a0 = _mm256_mul_pd(_mm256_loadu_pd(x), _mm256_loadu_pd(y));
+    __m256d a1 = _mm256_mul_pd(_mm256_loadu_pd(x + 4), _mm256_loadu_pd(y + 4));
+    __m256d a2 = _mm256_mul_pd(_mm256_loadu_pd(x + 8), _mm256_loadu_pd(y + 8));
+    __m256d a3 = _mm256_mul_pd(_mm256_loadu_pd(x + 12), _mm256_loadu_pd(y + 12));
+    std::size_t i = PARTIAL_SUMS;
+    for (; i + PARTIAL_SUMS <= n; i += PARTIAL_SUMS)
+    {
+        a0 = _mm256_add_pd(a0, _mm256_mul_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+        a1 = _mm256_add_pd(a1,
+                           _mm256_mul_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4)));
+        a2 = _mm256_add_pd(a2,
+                           _mm256_mul_pd(_mm256_loadu_pd(x + i + 8), _mm256_loadu_pd(y + i + 8)));
+        a3 = _mm256_add_pd(a3,
+                           _mm256_mul_pd(_mm256_loadu_pd(x + i + 12), _mm256_loadu_pd(y + i + 12)));
+    }
+    double partial[PARTIAL_SUMS];
+    _mm256_storeu_pd(partial, a0);
+    _mm256_storeu_pd(partial + 4, a1);
+    _mm256_storeu_pd(partial + 8, a2);
+    _mm256_storeu_pd(partial + 12, a3);
+    // the rest runs SSE code, which stalls while the upper halves are in use
+    _mm256_zeroupper();
+    return SequentialSum(CombinePartialSums(partial), x + i, y + i, n - i);
+}
+
+__attribute__((target("avx2"))) double
+Avx2SumSquares(const double* x, std::size_t n)
+{
+    return Avx2Dot(x, x, n);
+}
+
+/// AVX2 kernels
+const Kernels g_avx2Kernels = {Avx2Add,
+                               Avx2Subtract,
+                               Avx2Multiply,
+                               Avx2Divide,
+                               Avx2AddScalar,
+                               Avx2MultiplyScalar,
+                               Avx2DivideScalar,
+                               Avx2Sum,
+                               Avx2SumSquares,
+                               Avx2Dot};
+
+#endif /* SPECTRUM_VALUE_X86_KERNELS */
+
+/**
+ * \return the best instruction set supported by the CPU and the build
+ */
+SpectrumValue::SimdLevel
+DetectSimdLevel()
+{
+#ifdef SPECTRUM_VALUE_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return SpectrumValue::AVX2;
+    }
+    if (__builtin_cpu_supports("sse2"))
+    {
+        return SpectrumValue::SSE2;
+    }
+#endif
+    return SpectrumValue::SCALAR;
+}
+
+/**
+ * \param level an instruction set supported by the CPU
+ * \return the kernels of that instruction set
+ */
+const Kernels*
+GetKernels(SpectrumValue::SimdLevel level)
+{
+    switch (level)
+    {
+#ifdef SPECTRUM_VALUE_X86_KERNELS
+    case SpectrumValue::AVX2:
+        return &g_avx2Kernels;
+    case SpectrumValue::SSE2:
+        return &g_sse2Kernels;
+#endif
+    default:
+        return &g_scalarKernels;
+    }
+}
+
+/// The instruction set of the kernels in use
+SpectrumValue::SimdLevel g_simdLevel = SpectrumValue::SCALAR;
+/// The kernels in use
+const Kernels* g_kernels = &g_scalarKernels;
+/// Whether Sum, Norm and Integral use the reductions of the kernels
+bool g_partialSums = false;
+
+} // namespace
+
+bool
+SpectrumValue::SetSimdLevel(SimdLevel level)
+{
+    NS_LOG_FUNCTION(level);
+    if (level > GetMaxSimdLevel())
+    {
+        return false;
+    }
+    g_simdLevel = level;
+    g_kernels = GetKernels(level);
+    return true;
+}
+
+SpectrumValue::SimdLevel
+SpectrumValue::GetSimdLevel()
+{
+    return g_simdLevel;
+}
+
+SpectrumValue::SimdLevel
+SpectrumValue::GetMaxSimdLevel()
+{
+    static SimdLevel maxLevel = DetectSimdLevel();
+    return maxLevel;
+}
+
+void
+SpectrumValue::SetPartialSums(bool partialSums)
+{
+    NS_LOG_FUNCTION(partialSums);
+    g_partialSums = partialSums;
+}
+
+bool
+SpectrumValue::GetPartialSums()
+{
+    return g_partialSums;
+}
+
+/// Select the best kernels when the library is loaded
+static bool g_simdLevelSelected [[maybe_unused]] =
+    SpectrumValue::SetSimdLevel(SpectrumValue::GetMaxSimdLevel());
+
 SpectrumValue::SpectrumValue()
 {
 }
@@ -101,47 +752,25 @@ SpectrumValue::ConstBandsEnd() const
 void
 SpectrumValue::Add(const SpectrumValue& x)
 {
-    auto it1 = m_values.begin();
-    auto it2 = x.m_values.begin();
-
     NS_ASSERT(m_spectrumModel == x.m_spectrumModel);
     NS_ASSERT(m_values.size() == x.m_values.size());
 
-    while (it1 != m_values.end())
-    {
-        *it1 += *it2;
-        ++it1;
-        ++it2;
-    }
+    g_kernels->add(m_values.data(), x.m_values.data(), m_values.size());
 }
 
 void
 SpectrumValue::Add(double s)
 {
-    auto it1 = m_values.begin();
-
-    while (it1 != m_values.end())
-    {
-        *it1 += s;
-        ++it1;
-    }
+    g_kernels->addScalar(m_values.data(), s, m_values.size());
 }
 
 void
 SpectrumValue::Subtract(const SpectrumValue& x)
 {
-    auto it1 = m_values.begin();
-    auto it2 = x.m_values.begin();
-
     NS_ASSERT(m_spectrumModel == x.m_spectrumModel);
     NS_ASSERT(m_values.size() == x.m_values.size());
 
-    while (it1 != m_values.end())
-    {
-        *it1 -= *it2;
-        ++it1;
-        ++it2;
-    }
+    g_kernels->subtract(m_values.data(), x.m_values.data(), m_values.size());
 }
 
 void
@@ -153,60 +782,32 @@ SpectrumValue::Subtract(double s)
 void
 SpectrumValue::Multiply(const SpectrumValue& x)
 {
-    auto it1 = m_values.begin();
-    auto it2 = x.m_values.begin();
-
     NS_ASSERT(m_spectrumModel == x.m_spectrumModel);
     NS_ASSERT(m_values.size() == x.m_values.size());
 
-    while (it1 != m_values.end())
-    {
-        *it1 *= *it2;
-        ++it1;
-        ++it2;
-    }
+    g_kernels->multiply(m_values.data(), x.m_values.data(), m_values.size());
 }
 
 void
 SpectrumValue::Multiply(double s)
 {
-    auto it1 = m_values.begin();
-
-    while (it1 != m_values.end())
-    {
-        *it1 *= s;
-        ++it1;
-    }
+    g_kernels->multiplyScalar(m_values.data(), s, m_values.size());
 }
 
 void
 SpectrumValue::Divide(const SpectrumValue& x)
 {
-    auto it1 = m_values.begin();
-    auto it2 = x.m_values.begin();
-
     NS_ASSERT(m_spectrumModel == x.m_spectrumModel);
     NS_ASSERT(m_values.size() == x.m_values.size());
 
-    while (it1 != m_values.end())
-    {
-        *it1 /= *it2;
-        ++it1;
-        ++it2;
-    }
+    g_kernels->divide(m_values.data(), x.m_values.data(), m_values.size());
 }
 
 void
 SpectrumValue::Divide(double s)
 {
     NS_LOG_FUNCTION(this << s);
-    auto it1 = m_values.begin();
-
-    while (it1 != m_values.end())
-    {
-        *it1 /= s;
-        ++it1;
-    }
+    g_kernels->divideScalar(m_values.data(), s, m_values.size());
 }
 
 void
@@ -321,27 +922,22 @@ SpectrumValue::Log()
 double
 Norm(const SpectrumValue& x)
 {
-    double s = 0;
-    auto it1 = x.ConstValuesBegin();
-    while (it1 != x.ConstValuesEnd())
+    const double* values = x.m_values.data();
+    if (!g_partialSums)
     {
-        s += (*it1) * (*it1);
-        ++it1;
+        return std::sqrt(SequentialSum(0, values, values, x.m_values.size()));
     }
-    return std::sqrt(s);
+    return std::sqrt(g_kernels->sumSquares(values, x.m_values.size()));
 }
 
 double
 Sum(const SpectrumValue& x)
 {
-    double s = 0;
-    auto it1 = x.ConstValuesBegin();
-    while (it1 != x.ConstValuesEnd())
+    if (!g_partialSums)
     {
-        s += (*it1);
-        ++it1;
+        return SequentialSum(0, x.m_values.data(), nullptr, x.m_values.size());
     }
-    return s;
+    return g_kernels->sum(x.m_values.data(), x.m_values.size());
 }
 
 double
@@ -360,18 +956,13 @@ Prod(const SpectrumValue& x)
 double
 Integral(const SpectrumValue& arg)
 {
-    double i = 0;
-    auto vit = arg.ConstValuesBegin();
-    auto bit = arg.ConstBandsBegin();
-    while (vit != arg.ConstValuesEnd())
+    const std::vector<double>& widths = arg.m_spectrumModel->GetBandWidths();
+    NS_ASSERT(widths.size() == arg.m_values.size());
+    if (!g_partialSums)
     {
-        NS_ASSERT(bit != arg.ConstBandsEnd());
-        i += (*vit) * (bit->fh - bit->fl);
-        ++vit;
-        ++bit;
+        return SequentialSum(0, arg.m_values.data(), widths.data(), arg.m_values.size());
     }
-    NS_ASSERT(bit == arg.ConstBandsEnd());
-    return i;
+    return g_kernels->dot(arg.m_values.data(), widths.data(), arg.m_values.size());
 }
 
 Ptr<SpectrumValue>
@@ -442,9 +1033,8 @@ operator+(double lhs, const SpectrumValue& rhs)
 SpectrumValue
 operator-(const SpectrumValue& lhs, const SpectrumValue& rhs)
 {
-    SpectrumValue res = rhs;
-    res.ChangeSign();
-    res.Add(lhs);
+    SpectrumValue res = lhs;
+    res.Subtract(rhs);
     return res;
 }
 
@@ -512,6 +1102,70 @@ operator/(double lhs, const SpectrumValue& rhs)
     return res;
 }
 
+SpectrumValue
+operator+(SpectrumValue&& lhs, const SpectrumValue& rhs)
+{
+    SpectrumValue res = std::move(lhs);
+    res.Add(rhs);
+    return res;
+}
+
+SpectrumValue
+operator+(SpectrumValue&& lhs, double rhs)
+{
+    SpectrumValue res = std::move(lhs);
+    res.Add(rhs);
+    return res;
+}
+
+SpectrumValue
+operator-(SpectrumValue&& lhs, const SpectrumValue& rhs)
+{
+    SpectrumValue res = std::move(lhs);
+    res.Subtract(rhs);
+    return res;
+}
+
+SpectrumValue
+operator-(SpectrumValue&& lhs, double rhs)
+{
+    SpectrumValue res = std::move(lhs);
+    res.Subtract(rhs);
+    return res;
+}
+
+SpectrumValue
+operator*(SpectrumValue&& lhs, const SpectrumValue& rhs)
+{
+    SpectrumValue res = std::move(lhs);
+    res.Multiply(rhs);
+    return res;
+}
+
+SpectrumValue
+operator*(SpectrumValue&& lhs, double rhs)
+{
+    SpectrumValue res = std::move(lhs);
+    res.Multiply(rhs);
+    return res;
+}
+
+SpectrumValue
+operator/(SpectrumValue&& lhs, const SpectrumValue& rhs)
+{
+    SpectrumValue res = std::move(lhs);
+    res.Divide(rhs);
+    return res;
+}
+
+SpectrumValue
+operator/(SpectrumValue&& lhs, double rhs)
+{
+    SpectrumValue res = std::move(lhs);
+    res.Divide(rhs);
+    return res;
+}
+
 SpectrumValue
 operator+(const SpectrumValue& rhs)
 {
@@ -60,6 +60,57 @@ typedef std::vector<double> Values;
 class SpectrumValue : public SimpleRefCount<SpectrumValue>
 {
   public:
+    /**
+     * Instruction sets of the arithmetic kernels of SpectrumValue.
+     */
+    enum SimdLevel
+    {
+        SCALAR, //!< portable loops
+        SSE2,   //!< 2 doubles per instruction
+        AVX2,   //!< 4 doubles per instruction
+    };
+
+    /**
+     * Select the kernels used by the element-wise operators, Sum, Norm and
+     * Integral. By default the best level supported by the CPU is used. All
+     * levels give the same results: the element-wise operations are exact,
+     * and the sums are accumulated in the same order, see SetPartialSums().
+     *
+     * \param level the instruction set
+     * \return false, and the level is left unchanged, if the CPU or the
+     * build does not support it
+     */
+    static bool SetSimdLevel(SimdLevel level);
+
+    /**
+     * \return the instruction set of the kernels in use
+     */
+    static SimdLevel GetSimdLevel();
+
+    /**
+     * \return the best instruction set supported by the CPU and the build
+     */
+    static SimdLevel GetMaxSimdLevel();
+
+    /**
+     * Select the order of the additions of Sum, Norm and Integral.
+     *
+     * By default the values are added in order, as in earlier releases, so
+     * that the simulation results do not change. With partial sums, value i
+     * goes to one of 16 partial sums, i % 16, which are then added pairwise;
+     * the SSE2 and AVX2 kernels compute these sums in parallel. The results
+     * differ from the sequential sums by rounding, but still do not depend on
+     * the instruction set.
+     *
+     * \param partialSums whether to use the partial sums
+     */
+    static void SetPartialSums(bool partialSums);
+
+    /**
+     * eturn whether Sum, Norm and Integral use the partial sums
+     */
+    static bool GetPartialSums();
+
     /**
      * @brief SpectrumValue constructor
      *
@@ -220,6 +271,15 @@ class SpectrumValue : public SimpleRefCount<SpectrumValue>
      */
     friend SpectrumValue operator+(const SpectrumValue& lhs, const SpectrumValue& rhs);
 
+    /**
+     *  addition operator reusing the storage of a temporary Left Hand Side
+     *
+     * @param lhs Left Hand Side of the operator
+     * @param rhs Right Hand Side of the operator
+     * @return the value of lhs + rhs
+     */
+    friend SpectrumValue operator+(SpectrumValue&& lhs, const SpectrumValue& rhs);
+
     /**
      *  addition operator
      *
@@ -230,6 +290,15 @@ class SpectrumValue : public SimpleRefCount<SpectrumValue>
      */
     friend SpectrumValue operator+(const SpectrumValue& lhs, double rhs);
 
+    /**
+     *  addition operator reusing the storage of a temporary Left Hand Side
+     *
+     * @param lhs Left Hand Side of the operator
+     * @param rhs Right Hand Side of the operator
+     * @return the value of lhs + rhs
+     */
+    friend SpectrumValue operator+(SpectrumValue&& lhs, double rhs);
+
     /**
      *  addition operator
      *
@@ -250,6 +319,15 @@ class SpectrumValue : public SimpleRefCount<SpectrumValue>
      */
     friend SpectrumValue operator-(const SpectrumValue& lhs, const SpectrumValue& rhs);
 
+    /**
+     *  subtraction operator reusing the storage of a temporary Left Hand Side
+     *
+     * @param lhs Left Hand Side of the operator
+     * @param rhs Right Hand Side of the operator
+     * @return the value of lhs - rhs
+     */
+    friend SpectrumValue operator-(SpectrumValue&& lhs, const SpectrumValue& rhs);
+
     /**
      *  subtraction operator
      *
@@ -260,6 +338,15 @@ class SpectrumValue : public SimpleRefCount<SpectrumValue>
      */
     friend SpectrumValue operator-(const SpectrumValue& lhs, double rhs);
 
+    /**
+     *  subtraction operator reusing the storage of a temporary Left Hand Side
+     *
+     * @param lhs Left Hand Side of the operator
+     * @param rhs Right Hand Side of the operator
+     * @return the value of lhs - rhs
+     */
+    friend SpectrumValue operator-(SpectrumValue&& lhs, double rhs);
+
     /**
      *  subtraction operator
      *
@@ -280,6 +367,15 @@ class SpectrumValue : public SimpleRefCount<SpectrumValue>
      */
     friend SpectrumValue operator*(const SpectrumValue& lhs, const SpectrumValue& rhs);
 
+    /**
+     *  multiplication operator reusing the storage of a temporary Left Hand Side
+     *
+     * @param lhs Left Hand Side of the operator
+     * @param rhs Right Hand Side of the operator
+     * @return the value of lhs * rhs
+     */
+    friend SpectrumValue operator*(SpectrumValue&& lhs, const SpectrumValue& rhs);
+
     /**
      *  multiplication by a scalar
      *
@@ -290,6 +386,15 @@ class SpectrumValue : public SimpleRefCount<SpectrumValue>
      */
     friend SpectrumValue operator*(const SpectrumValue& lhs, double rhs);
 
+    /**
+     *  multiplication operator reusing the storage of a temporary Left Hand Side
+     *
+     * @param lhs Left Hand Side of the operator
+     * @param rhs Right Hand Side of the operator
+     * @return the value of lhs * rhs
+     */
+    friend SpectrumValue operator*(SpectrumValue&& lhs, double rhs);
+
     /**
      *  multiplication of a scalar
      *
@@ -310,6 +415,15 @@ class SpectrumValue : public SimpleRefCount<SpectrumValue>
      */
     friend SpectrumValue operator/(const SpectrumValue& lhs, const SpectrumValue& rhs);
 
+    /**
+     *  division operator reusing the storage of a temporary Left Hand Side
+     *
+     * @param lhs Left Hand Side of the operator
+     * @param rhs Right Hand Side of the operator
+     * @return the value of lhs / rhs
+     */
+    friend SpectrumValue operator/(SpectrumValue&& lhs, const SpectrumValue& rhs);
+
     /**
      * division by a scalar
      *
@@ -320,6 +434,15 @@ class SpectrumValue : public SimpleRefCount<SpectrumValue>
      */
     friend SpectrumValue operator/(const SpectrumValue& lhs, double rhs);
 
+    /**
+     *  division operator reusing the storage of a temporary Left Hand Side
+     *
+     * @param lhs Left Hand Side of the operator
+     * @param rhs Right Hand Side of the operator
+     * @return the value of lhs / rhs
+     */
+    friend SpectrumValue operator/(SpectrumValue&& lhs, double rhs);
+
     /**
      * division of a scalar
      *
@@ -0,0 +1,420 @@
+/*
+ * Copyright (c) 2009 CTTC
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/boolean.h>
+#include <ns3/constant-position-mobility-model.h>
+#include <ns3/constant-velocity-mobility-model.h>
+#include <ns3/double.h>
+#include <ns3/isotropic-antenna-model.h>
+#include <ns3/net-device.h>
+#include <ns3/object-factory.h>
+#include <ns3/propagation-delay-model.h>
+#include <ns3/propagation-loss-model.h>
+#include <ns3/simulator.h>
+#include <ns3/spectrum-channel.h>
+#include <ns3/spectrum-phy.h>
+#include <ns3/spectrum-signal-parameters.h>
+#include <ns3/spectrum-value.h>
+#include <ns3/test.h>
+#include <ns3/waypoint-mobility-model.h>
+
+#include <cmath>
+#include <utility>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup spectrum-tests
+ *
+ * \brief SpectrumPhy recording the power and the time of the signals it receives.
+ */
+class GainCacheTestPhy : public SpectrumPhy
+{
+  public:
+    /** The time and the power of the received signals. */
+    std::vector<std::pair<Time, double>> m_received;
+
+    /**
+     * Constructor.
+     * \param mobility the mobility model
+     * \param model the spectrum model
+     */
+    GainCacheTestPhy(Ptr<MobilityModel> mobility, Ptr<const SpectrumModel> model)
+        : m_mobility(mobility),
+          m_model(model),
+          m_antenna(CreateObject<IsotropicAntennaModel>())
+    {
+        m_antenna->SetAttribute("Gain", DoubleValue(3));
+    }
+
+    void SetDevice(Ptr<NetDevice> d) override
+    {
+    }
+
+    Ptr<NetDevice> GetDevice() const override
+    {
+        return nullptr;
+    }
+
+    void SetMobility(Ptr<MobilityModel> m) override
+    {
+        m_mobility = m;
+    }
+
+    Ptr<MobilityModel> GetMobility() const override
+    {
+        return m_mobility;
+    }
+
+    void SetChannel(Ptr<SpectrumChannel> c) override
+    {
+    }
+
+    Ptr<const SpectrumModel> GetRxSpectrumModel() const override
+    {
+        return m_model;
+    }
+
+    Ptr<Object> GetAntenna() const override
+    {
+        return m_antenna;
+    }
+
+    void StartRx(Ptr<SpectrumSignalParameters> params) override
+    {
+        m_received.emplace_back(Simulator::Now(), (*params->psd)[0]);
+    }
+
+  private:
+    Ptr<MobilityModel> m_mobility;   //!< the mobility model
+    Ptr<const SpectrumModel> m_model; //!< the spectrum model
+    Ptr<AntennaModel> m_antenna;      //!< the antenna
+};
+
+/**
+ * \ingroup spectrum-tests
+ *
+ * \brief Check that the gain cache of the spectrum channels gives the gains
+ * of the uncached channel, with a static and a moving receiver.
+ *
+ * The same transmissions are made on a channel without and on a channel with
+ * the gain cache. With no tolerance, the received signals must be identical,
+ * also after the static receiver is moved. With a tolerance, the moving
+ * receiver gets slightly stale gains. A non-deterministic propagation loss
+ * model must bypass the cache.
+ */
+class SpectrumGainCacheTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     * \param channelType the TypeId name of the channel
+     */
+    SpectrumGainCacheTestCase(std::string channelType);
+
+  private:
+    void DoRun() override;
+
+    /** A channel, its transmitter and its receivers. */
+    struct Setup
+    {
+        Ptr<SpectrumChannel> channel;   //!< the channel
+        Ptr<GainCacheTestPhy> tx;       //!< the transmitter
+        Ptr<GainCacheTestPhy> rxStatic; //!< the static receiver
+        Ptr<GainCacheTestPhy> rxMoving; //!< the moving receiver
+    };
+
+    /**
+     * Create a channel with its PHYs.
+     * \param gainCache whether the gain cache is enabled
+     * \param tolerance the GainCacheTolerance
+     * \param randomLoss whether to chain a random loss model
+     * \return the channel and its PHYs
+     */
+    Setup CreateSetup(bool gainCache, double tolerance, bool randomLoss);
+
+    /**
+     * Transmit a signal.
+     * \param setup the channel and its PHYs
+     */
+    void Transmit(Setup setup);
+
+    std::string m_channelType;       //!< the TypeId name of the channel
+    Ptr<SpectrumModel> m_model;      //!< the spectrum model
+};
+
+SpectrumGainCacheTestCase::SpectrumGainCacheTestCase(std::string channelType)
+    : TestCase("Check the gain cache of " + channelType),
+      m_channelType(channelType)
+{
+}
+
+SpectrumGainCacheTestCase::Setup
+SpectrumGainCacheTestCase::CreateSetup(bool gainCache, double tolerance, bool randomLoss)
+{
+    Setup setup;
+    ObjectFactory factory(m_channelType);
+    factory.Set("GainCache", BooleanValue(gainCache));
+    factory.Set("GainCacheTolerance", DoubleValue(tolerance));
+    setup.channel = factory.Create<SpectrumChannel>();
+    setup.channel->AddPropagationLossModel(CreateObject<LogDistancePropagationLossModel>());
+    if (randomLoss)
+    {
+        setup.channel->AddPropagationLossModel(CreateObject<RandomPropagationLossModel>());
+    }
+    setup.channel->SetPropagationDelayModel(CreateObject<ConstantSpeedPropagationDelayModel>());
+
+    Ptr<ConstantPositionMobilityModel> txMobility = CreateObject<ConstantPositionMobilityModel>();
+    txMobility->SetPosition(Vector(0, 0, 0));
+    Ptr<ConstantPositionMobilityModel> staticMobility =
+        CreateObject<ConstantPositionMobilityModel>();
+    staticMobility->SetPosition(Vector(30, 0, 0));
+    Ptr<ConstantVelocityMobilityModel> movingMobility =
+        CreateObject<ConstantVelocityMobilityModel>();
+    movingMobility->SetPosition(Vector(0, 40, 0));
+    movingMobility->SetVelocity(Vector(2, 0, 0));
+
+    setup.tx = Create<GainCacheTestPhy>(txMobility, m_model);
+    setup.rxStatic = Create<GainCacheTestPhy>(staticMobility, m_model);
+    setup.rxMoving = Create<GainCacheTestPhy>(movingMobility, m_model);
+    setup.channel->AddRx(setup.rxStatic);
+    setup.channel->AddRx(setup.rxMoving);
+
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        Simulator::Schedule(MilliSeconds(100 * i), &SpectrumGainCacheTestCase::Transmit, this, setup);
+    }
+    // a course change of a static receiver
+    Simulator::Schedule(MilliSeconds(450),
+                        &MobilityModel::SetPosition,
+                        staticMobility,
+                        Vector(60, 0, 0));
+    return setup;
+}
+
+void
+SpectrumGainCacheTestCase::Transmit(Setup setup)
+{
+    Ptr<SpectrumSignalParameters> params = Create<SpectrumSignalParameters>();
+    params->duration = MicroSeconds(100);
+    params->psd = Create<SpectrumValue>(m_model);
+    (*params->psd) = 1e-3;
+    params->txPhy = setup.tx;
+    setup.channel->StartTx(params);
+}
+
+void
+SpectrumGainCacheTestCase::DoRun()
+{
+    BandInfo band;
+    band.fl = 2.4e9 - 1e6;
+    band.fc = 2.4e9;
+    band.fh = 2.4e9 + 1e6;
+    m_model = Create<SpectrumModel>(Bands{band});
+
+    Setup reference = CreateSetup(false, 0, false);
+    Setup cached = CreateSetup(true, 0, false);
+    Setup tolerant = CreateSetup(true, 1, false);
+    Setup random = CreateSetup(true, 1, true);
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(reference.rxStatic->m_received.size(), 10, "missing receptions");
+    NS_TEST_ASSERT_MSG_EQ(reference.rxMoving->m_received.size(), 10, "missing receptions");
+    NS_TEST_EXPECT_MSG_EQ((cached.rxStatic->m_received == reference.rxStatic->m_received),
+                          true,
+                          "cached gains differ for the static receiver");
+    NS_TEST_EXPECT_MSG_EQ((cached.rxMoving->m_received == reference.rxMoving->m_received),
+                          true,
+                          "cached gains differ for the moving receiver");
+    // the static receiver misses on the first signal and after it moved, the
+    // moving one on every signal
+    NS_TEST_EXPECT_MSG_EQ(cached.channel->GetGainCacheHits(), 8, "wrong number of hits");
+    NS_TEST_EXPECT_MSG_EQ(cached.channel->GetGainCacheMisses(), 12, "wrong number of misses");
+    NS_TEST_EXPECT_MSG_EQ(reference.channel->GetGainCacheHits() +
+                              reference.channel->GetGainCacheMisses(),
+                          0,
+                          "disabled gain cache used");
+
+    // the moving receiver moves by 0.2 m between two signals, so its gains are
+    // computed again every 6 signals
+    NS_TEST_EXPECT_MSG_EQ(tolerant.channel->GetGainCacheHits(), 16, "wrong number of hits");
+    NS_TEST_ASSERT_MSG_EQ(tolerant.rxMoving->m_received.size(), 10, "missing receptions");
+    for (std::size_t i = 0; i < 10; i++)
+    {
+        double expected = 10 * std::log10(reference.rxMoving->m_received[i].second);
+        double actual = 10 * std::log10(tolerant.rxMoving->m_received[i].second);
+        NS_TEST_EXPECT_MSG_EQ_TOL(actual, expected, 0.1, "stale gain too far off");
+    }
+
+    NS_TEST_EXPECT_MSG_EQ(random.channel->GetGainCacheHits() +
+                              random.channel->GetGainCacheMisses(),
+                          0,
+                          "gain cache used with a random loss model");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup spectrum-tests
+ *
+ * \brief Check that the gain cache polls the position of a mobility model
+ * which only updates it, and fires CourseChange, when it is read, and that
+ * it forgets the gains of a PHY removed from the channel.
+ */
+class SpectrumGainCachePollTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     * \param channelType the TypeId name of the channel
+     */
+    SpectrumGainCachePollTestCase(std::string channelType);
+
+  private:
+    void DoRun() override;
+
+    /** A channel, its transmitter and its receiver. */
+    struct Setup
+    {
+        Ptr<SpectrumChannel> channel; //!< the channel
+        Ptr<GainCacheTestPhy> tx;     //!< the transmitter
+        Ptr<GainCacheTestPhy> rx;     //!< the receiver
+    };
+
+    /**
+     * Create a channel with a static transmitter and a receiver following
+     * waypoints, with LazyNotify.
+     * \param gainCache whether the gain cache is enabled
+     * \return the channel and its PHYs
+     */
+    Setup CreateSetup(bool gainCache);
+
+    /**
+     * Transmit a signal.
+     * \param setup the channel and its PHYs
+     */
+    void Transmit(Setup setup);
+
+    std::string m_channelType;  //!< the TypeId name of the channel
+    Ptr<SpectrumModel> m_model; //!< the spectrum model
+};
+
+SpectrumGainCachePollTestCase::SpectrumGainCachePollTestCase(std::string channelType)
+    : TestCase("Check the gain cache of " + channelType + " with lazy mobility models"),
+      m_channelType(channelType)
+{
+}
+
+SpectrumGainCachePollTestCase::Setup
+SpectrumGainCachePollTestCase::CreateSetup(bool gainCache)
+{
+    Setup setup;
+    ObjectFactory factory(m_channelType);
+    factory.Set("GainCache", BooleanValue(gainCache));
+    setup.channel = factory.Create<SpectrumChannel>();
+    setup.channel->AddPropagationLossModel(CreateObject<LogDistancePropagationLossModel>());
+    setup.channel->SetPropagationDelayModel(CreateObject<ConstantSpeedPropagationDelayModel>());
+
+    Ptr<ConstantPositionMobilityModel> txMobility = CreateObject<ConstantPositionMobilityModel>();
+    txMobility->SetPosition(Vector(0, 0, 0));
+    // still until 350 ms, then walks 50 m in 100 ms; nothing tells the
+    // channel, the model only updates when it is read
+    Ptr<WaypointMobilityModel> rxMobility = CreateObject<WaypointMobilityModel>();
+    rxMobility->SetAttribute("LazyNotify", BooleanValue(true));
+    rxMobility->AddWaypoint(Waypoint(Seconds(0), Vector(10, 0, 0)));
+    rxMobility->AddWaypoint(Waypoint(MilliSeconds(350), Vector(10, 0, 0)));
+    rxMobility->AddWaypoint(Waypoint(MilliSeconds(450), Vector(60, 0, 0)));
+
+    setup.tx = Create<GainCacheTestPhy>(txMobility, m_model);
+    setup.rx = Create<GainCacheTestPhy>(rxMobility, m_model);
+    setup.channel->AddRx(setup.rx);
+
+    for (uint32_t i = 1; i <= 8; i++)
+    {
+        Simulator::Schedule(MilliSeconds(100 * i),
+                            &SpectrumGainCachePollTestCase::Transmit,
+                            this,
+                            setup);
+    }
+    // the receiver leaves and joins the channel again: its gains are
+    // computed again, although it did not move
+    Simulator::Schedule(MilliSeconds(650), &SpectrumChannel::RemoveRx, setup.channel, setup.rx);
+    Simulator::Schedule(MilliSeconds(650), &SpectrumChannel::AddRx, setup.channel, setup.rx);
+    return setup;
+}
+
+void
+SpectrumGainCachePollTestCase::Transmit(Setup setup)
+{
+    Ptr<SpectrumSignalParameters> params = Create<SpectrumSignalParameters>();
+    params->duration = MicroSeconds(100);
+    params->psd = Create<SpectrumValue>(m_model);
+    (*params->psd) = 1e-3;
+    params->txPhy = setup.tx;
+    setup.channel->StartTx(params);
+}
+
+void
+SpectrumGainCachePollTestCase::DoRun()
+{
+    BandInfo band;
+    band.fl = 2.4e9 - 1e6;
+    band.fc = 2.4e9;
+    band.fh = 2.4e9 + 1e6;
+    m_model = Create<SpectrumModel>(Bands{band});
+
+    Setup reference = CreateSetup(false);
+    Setup cached = CreateSetup(true);
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(reference.rx->m_received.size(), 8, "missing receptions");
+    NS_TEST_EXPECT_MSG_EQ((cached.rx->m_received == reference.rx->m_received),
+                          true,
+                          "cached gains differ for the lazy receiver");
+    // misses: the first signal, the one while walking, the first one at the
+    // end of the walk and the first one after joining again
+    NS_TEST_EXPECT_MSG_EQ(cached.channel->GetGainCacheMisses(), 4, "wrong number of misses");
+    NS_TEST_EXPECT_MSG_EQ(cached.channel->GetGainCacheHits(), 4, "wrong number of hits");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup spectrum-tests
+ *
+ * \brief Spectrum channel gain cache TestSuite
+ */
+class SpectrumGainCacheTestSuite : public TestSuite
+{
+  public:
+    SpectrumGainCacheTestSuite();
+};
+
+SpectrumGainCacheTestSuite::SpectrumGainCacheTestSuite()
+    : TestSuite("spectrum-gain-cache", UNIT)
+{
+    AddTestCase(new SpectrumGainCacheTestCase("ns3::SingleModelSpectrumChannel"), TestCase::QUICK);
+    AddTestCase(new SpectrumGainCacheTestCase("ns3::MultiModelSpectrumChannel"), TestCase::QUICK);
+    AddTestCase(new SpectrumGainCachePollTestCase("ns3::SingleModelSpectrumChannel"),
+                TestCase::QUICK);
+    AddTestCase(new SpectrumGainCachePollTestCase("ns3::MultiModelSpectrumChannel"),
+                TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static SpectrumGainCacheTestSuite g_spectrumGainCacheTestSuite;
@@ -26,6 +26,8 @@
 #include <ns3/test.h>
 
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 
 using namespace ns3;
@@ -93,6 +95,155 @@ SpectrumValueTestCase::DoRun()
     NS_TEST_ASSERT_MSG_SPECTRUM_VALUE_EQ_TOL(m_a, m_b, TOLERANCE, "");
 }
 
+/**
+ * \ingroup spectrum-tests
+ *
+ * \brief Check the kernels of every instruction set supported against the
+ * scalar ones, and the sums against plain sequential sums.
+ *
+ * The element-wise operations must give the same bits with every instruction
+ * set, as must the reductions. By default the reductions must give the bits of
+ * a sequential sum; with partial sums, they must be within a few ULPs of it.
+ */
+class SpectrumValueSimdTestCase : public TestCase
+{
+  public:
+    SpectrumValueSimdTestCase();
+    void DoRun() override;
+
+  private:
+    /**
+     * \param a first value
+     * \param b second value
+     * \return the distance between a and b in units in the last place
+     */
+    static uint64_t UlpDistance(double a, double b);
+
+    /**
+     * Compute the results of the operators with the kernels in use.
+     * \param x first operand
+     * \param y second operand
+     * \return the element-wise results, followed by Sum, Norm and Integral of x
+     */
+    static std::vector<double> Compute(const SpectrumValue& x, const SpectrumValue& y);
+};
+
+SpectrumValueSimdTestCase::SpectrumValueSimdTestCase()
+    : TestCase("SpectrumValue kernels of each instruction set")
+{
+}
+
+uint64_t
+SpectrumValueSimdTestCase::UlpDistance(double a, double b)
+{
+    int64_t ia;
+    int64_t ib;
+    std::memcpy(&ia, &a, sizeof(a));
+    std::memcpy(&ib, &b, sizeof(b));
+    // map the sign-magnitude representation to a monotonic one
+    ia = ia < 0 ? INT64_MIN - ia : ia;
+    ib = ib < 0 ? INT64_MIN - ib : ib;
+    return ia > ib ? uint64_t(ia) - uint64_t(ib) : uint64_t(ib) - uint64_t(ia);
+}
+
+std::vector<double>
+SpectrumValueSimdTestCase::Compute(const SpectrumValue& x, const SpectrumValue& y)
+{
+    std::vector<double> results;
+    for (const SpectrumValue& r : {x + y,
+                                   x - y,
+                                   x * y,
+                                   x / y,
+                                   x + 0.3,
+                                   x - 0.3,
+                                   x * 0.3,
+                                   x / 0.3,
+                                   (x * y + x) / y})
+    {
+        results.insert(results.end(), r.ConstValuesBegin(), r.ConstValuesEnd());
+    }
+    results.push_back(Sum(x));
+    results.push_back(Norm(x));
+    results.push_back(Integral(x));
+    return results;
+}
+
+void
+SpectrumValueSimdTestCase::DoRun()
+{
+    SpectrumValue::SimdLevel level = SpectrumValue::GetSimdLevel();
+    for (std::size_t n : {1, 3, 4, 5, 16, 63, 64, 256, 1023, 1024})
+    {
+        Bands bands;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            BandInfo band;
+            band.fl = 1e9 + i * 1e6;
+            band.fc = band.fl + 0.5e6 + (i % 3) * 1e3;
+            band.fh = band.fc + 0.5e6 + (i % 7) * 1e3;
+            bands.push_back(band);
+        }
+        Ptr<SpectrumModel> model = Create<SpectrumModel>(bands);
+        SpectrumValue x(model);
+        SpectrumValue y(model);
+        for (std::size_t i = 0; i < n; i++)
+        {
+            x[i] = 0.5 + std::fmod(i * 0.6180339887498949, 1.5);
+            y[i] = 2.0 - std::fmod(i * 0.4142135623730950, 1.25);
+        }
+
+        double sum = 0;
+        double squares = 0;
+        double integral = 0;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            sum += x[i];
+            squares += x[i] * x[i];
+            integral += x[i] * (bands[i].fh - bands[i].fl);
+        }
+
+        for (bool partialSums : {false, true})
+        {
+            SpectrumValue::SetPartialSums(partialSums);
+            NS_TEST_ASSERT_MSG_EQ(SpectrumValue::SetSimdLevel(SpectrumValue::SCALAR),
+                                  true,
+                                  "scalar kernels not available");
+            std::vector<double> expected = Compute(x, y);
+
+            // the sequential sums are the ones of earlier releases, bit for bit
+            uint64_t ulps = partialSums ? n : 0;
+            std::size_t last = expected.size() - 3;
+            NS_TEST_EXPECT_MSG_LT_OR_EQ(UlpDistance(expected[last], sum), ulps, "Sum of " << n);
+            NS_TEST_EXPECT_MSG_LT_OR_EQ(UlpDistance(expected[last + 1], std::sqrt(squares)),
+                                        ulps,
+                                        "Norm of " << n);
+            NS_TEST_EXPECT_MSG_LT_OR_EQ(UlpDistance(expected[last + 2], integral),
+                                        ulps,
+                                        "Integral of " << n);
+
+            for (auto simd : {SpectrumValue::SSE2, SpectrumValue::AVX2})
+            {
+                if (!SpectrumValue::SetSimdLevel(simd))
+                {
+                    continue;
+                }
+                std::vector<double> actual = Compute(x, y);
+                NS_TEST_ASSERT_MSG_EQ(actual.size(), expected.size(), "wrong number of results");
+                for (std::size_t i = 0; i < actual.size(); i++)
+                {
+                    NS_TEST_EXPECT_MSG_EQ(UlpDistance(actual[i], expected[i]),
+                                          0,
+                                          "result " << i << " of " << n << " bins, level "
+                                                    << simd << ", partial sums "
+                                                    << partialSums);
+                }
+            }
+        }
+    }
+    SpectrumValue::SetPartialSums(false);
+    SpectrumValue::SetSimdLevel(level);
+}
+
 /**
  * \ingroup spectrum-tests
  *
@@ -268,6 +419,8 @@ SpectrumValueTestSuite::SpectrumValueTestSuite()
     v1rs3[4] = v1[1];
     tv1rs3 = v1 >> 3;
     AddTestCase(new SpectrumValueTestCase(tv1rs3, v1rs3, "tv1rs3 = v1 >> 3"), TestCase::QUICK);
+
+    AddTestCase(new SpectrumValueSimdTestCase(), TestCase::QUICK);
 }
 
 /**
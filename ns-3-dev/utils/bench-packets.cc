@@ -20,12 +20,20 @@
 // This program can be used to benchmark packet serialization/deserialization
 // operations using Headers and Tags, for various numbers of packets 'n'
 // Sample usage:  ./ns3 run 'bench-packets --n=10000'
+// When the ranger module is built, the headers of a ranger NodeInfo frame are
+// benchmarked too.
 
+#include "ns3/abort.h"
 #include "ns3/command-line.h"
 #include "ns3/packet-metadata.h"
 #include "ns3/packet.h"
 #include "ns3/system-wall-clock-ms.h"
 
+#ifdef NS3_BENCH_PACKETS_RANGER
+#include "ns3/ranger-mac-header.h"
+#include "ns3/ranger-nwk-header.h"
+#endif
+
 #include <algorithm>
 #include <iostream>
 #include <limits>
@@ -350,6 +358,95 @@ benchByteTags(uint32_t n)
     }
 }
 
+#ifdef NS3_BENCH_PACKETS_RANGER
+/**
+ * Build the NodeInfo message of a node with 20 neighbors, nearly the
+ * largest message of a ranger frame.
+ *
+ * \returns The message header.
+ */
+static MessageHeader
+RangerNodeInfo()
+{
+    MessageHeader msg;
+    msg.SetMessageType(MessageHeader::NODEINFO_MESSAGE);
+    msg.SetSrcAddress(Ipv4Address(0xffff0000));
+    MessageHeader::NodeInfo& nodeInfo = msg.GetNodeInfo();
+    nodeInfo.linkNumber = 20;
+    for (uint32_t i = 0; i < nodeInfo.linkNumber; i++)
+    {
+        MessageHeader::NodeInfo::LinkMessage lm;
+        lm.linkStatus = 1 + i % 2;
+        lm.neighborAddresses = Ipv4Address(0xffff0001 + i);
+        nodeInfo.linkMessages.push_back(lm);
+    }
+    msg.SetMessageLength(msg.GetSerializedSize());
+    return msg;
+}
+
+/**
+ * Send and receive a ranger NodeInfo frame: add the NWK and MAC headers,
+ * then remove them from a copy and walk the links, as RangerRoutingProtocol
+ * does on reception.
+ *
+ * \param [in] n The number of frames.
+ */
+static void
+benchRanger(uint32_t n)
+{
+    MessageHeader msg = RangerNodeInfo();
+    RangerMacHeader mac(RangerMacHeader::RANGER_MAC_BROADCAST, 1);
+    uint32_t stable = 0;
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        Ptr<Packet> p = Create<Packet>(0);
+        p->AddHeader(msg);
+        p->AddHeader(mac);
+        Ptr<Packet> o = p->Copy();
+        RangerMacHeader rxMac;
+        o->RemoveHeader(rxMac);
+        MessageHeader rxMsg;
+        o->RemoveHeader(rxMsg);
+        for (const auto& lm : rxMsg.GetNodeInfo().linkMessages)
+        {
+            stable += lm.linkStatus == 2;
+        }
+    }
+    NS_ABORT_MSG_IF(stable != 10 * n, "unexpected NodeInfo content");
+}
+
+/**
+ * Same as benchRanger, but read the NodeInfo message in place with a
+ * MessageHeaderView.
+ *
+ * \param [in] n The number of frames.
+ */
+static void
+benchRangerView(uint32_t n)
+{
+    MessageHeader msg = RangerNodeInfo();
+    RangerMacHeader mac(RangerMacHeader::RANGER_MAC_BROADCAST, 1);
+    uint32_t stable = 0;
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        Ptr<Packet> p = Create<Packet>(0);
+        p->AddHeader(msg);
+        p->AddHeader(mac);
+        Ptr<Packet> o = p->Copy();
+        RangerMacHeader rxMac;
+        o->RemoveHeader(rxMac);
+        MessageHeaderView view(o);
+        for (uint32_t k = 0; k < view.GetLinkNumber(); k++)
+        {
+            stable += view.GetLinkMessage(k).linkStatus == 2;
+        }
+    }
+    NS_ABORT_MSG_IF(stable != 10 * n, "unexpected NodeInfo content");
+}
+#endif
+
 static uint64_t
 runBenchOneIteration(void (*bench)(uint32_t), uint32_t n)
 {
@@ -407,6 +504,10 @@ main(int argc, char* argv[])
     runBench(&benchD, n, minIterations, "Intermixed add/remove headers and tags");
     runBench(&benchFragment, n, minIterations, "Fragmentation and concatenation");
     runBench(&benchByteTags, n, minIterations, "Benchmark byte tags");
+#ifdef NS3_BENCH_PACKETS_RANGER
+    runBench(&benchRanger, n, minIterations, "Ranger NodeInfo frame, remove headers");
+    runBench(&benchRangerView, n, minIterations, "Ranger NodeInfo frame, read in place");
+#endif
 
     return 0;
 }
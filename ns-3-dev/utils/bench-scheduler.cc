@@ -20,10 +20,13 @@
 #include "ns3/core-module.h"
 
 #include <cmath> // sqrt
+#include <cstdlib>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <new>
 #include <string.h>
+#include <utility>
 #include <vector>
 
 using namespace ns3;
@@ -47,6 +50,46 @@ std::string g_me;
 /** Output field width for numeric data. */
 int g_fwidth = 6;
 
+/** Number of heap allocations made by the program so far. */
+uint64_t g_allocs = 0;
+
+/**
+ * Replacement of the global operator new counting the heap allocations.
+ * \param [in] size The size to allocate.
+ * \returns The allocated memory.
+ */
+void*
+operator new(std::size_t size)
+{
+    ++g_allocs;
+    void* p = std::malloc(size ? size : 1);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+/**
+ * Replacement of the global operator delete matching operator new.
+ * \param [in] p The memory to free.
+ */
+void
+operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+/**
+ * Replacement of the global sized operator delete matching operator new.
+ * \param [in] p The memory to free.
+ */
+void
+operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
 /**
  *  Benchmark instance which can do a single run.
  *
@@ -107,6 +150,7 @@ class Bench
         double simu;     /**< Time (s) for simulation. */
         uint64_t pop;    /**< Event population. */
         uint64_t events; /**< Number of events executed. */
+        uint64_t allocs; /**< Number of heap allocations during the simulation. */
     };
 
     /**
@@ -150,14 +194,16 @@ Bench::Run()
     DEB("initialization took " << init << "s");
 
     DEB("running");
+    uint64_t allocs = g_allocs;
     timer.Start();
     Simulator::Run();
     simu = timer.End() / 1000.0;
+    allocs = g_allocs - allocs;
     DEB("run took " << simu << "s");
 
     Simulator::Destroy();
 
-    return Result{init, simu, m_population, m_count};
+    return Result{init, simu, m_population, m_count, allocs};
 }
 
 void
@@ -221,6 +267,7 @@ class BenchSuite
     {
         PhaseResult init; /**< Initialization phase results. */
         PhaseResult run;  /**< Run (simulation) phase results. */
+        double allocs;    /**< Run phase heap allocations per event. */
         /**
          * Construct from the individual run result.
          *
@@ -249,7 +296,8 @@ BenchSuite::Result
 BenchSuite::Result::Bench(Bench::Result r)
 {
     return Result{{r.init, r.pop / r.init, r.init / r.pop},
-                  {r.simu, r.events / r.simu, r.simu / r.events}};
+                  {r.simu, r.events / r.simu, r.simu / r.events},
+                  static_cast<double>(r.allocs) / r.events};
 }
 
 template <typename T>
@@ -261,7 +309,7 @@ BenchSuite::Result::Log(T label) const
     LOG(std::left << std::setw(g_fwidth) << label << std::setw(g_fwidth) << init.time
                   << std::setw(g_fwidth) << init.rate << std::setw(g_fwidth) << init.period
                   << std::setw(g_fwidth) << run.time << std::setw(g_fwidth) << run.rate
-                  << std::setw(g_fwidth) << run.period);
+                  << std::setw(g_fwidth) << run.period << std::setw(g_fwidth) << allocs);
 }
 
 BenchSuite::BenchSuite(ObjectFactory& factory,
@@ -282,6 +330,7 @@ BenchSuite::BenchSuite(ObjectFactory& factory,
     {
         m_scheduler += " (default)";
     }
+    m_scheduler += std::string(", event pool: ") + (EventImpl::IsPoolEnabled() ? "on" : "off");
 
     Bench bench(pop, total);
     bench.SetRandomStream(eventStream);
@@ -320,12 +369,13 @@ BenchSuite::Header() const
                   << std::left << std::setw(g_fwidth) << "Rate (ev/s)" << std::left
                   << std::setw(g_fwidth) << "Per (s/ev)" << std::left << std::setw(g_fwidth)
                   << "Time (s)" << std::left << std::setw(g_fwidth) << "Rate (ev/s)" << std::left
-                  << "Per (s/ev)");
+                  << std::setw(g_fwidth) << "Per (s/ev)" << std::left << "Alloc/ev");
     LOG(std::setfill('-') << std::right << std::setw(g_fwidth) << " " << std::right
                           << std::setw(g_fwidth) << " " << std::right << std::setw(g_fwidth) << " "
                           << std::right << std::setw(g_fwidth) << " " << std::right
                           << std::setw(g_fwidth) << " " << std::right << std::setw(g_fwidth) << " "
-                          << std::right << std::setw(g_fwidth) << " " << std::setfill(' '));
+                          << std::right << std::setw(g_fwidth) << " " << std::right
+                          << std::setw(g_fwidth) << " " << std::setfill(' '));
 }
 
 void
@@ -346,7 +396,8 @@ BenchSuite::Log() const
     uint64_t n{0};                // number of samples
     Result average{m_results[0]}; // average
     Result moment2{{0, 0, 0},     // 2nd moment, to calculate stdev
-                   {0, 0, 0}};
+                   {0, 0, 0},
+                   0};
 
     for (; n < m_results.size(); ++n)
     {
@@ -368,6 +419,11 @@ BenchSuite::Log() const
         ACCUMULATE(run, rate);
         ACCUMULATE(run, period);
 
+        deltaPre = run.allocs - average.allocs;
+        average.allocs += deltaPre / count;
+        deltaPost = run.allocs - average.allocs;
+        moment2.allocs += deltaPre * deltaPost;
+
 #undef ACCUMULATE
     }
 
@@ -378,6 +434,7 @@ BenchSuite::Log() const
         {std::sqrt(moment2.run.time / n),
          std::sqrt(moment2.run.rate / n),
          std::sqrt(moment2.run.period / n)},
+        std::sqrt(moment2.allocs / n),
     };
 
     average.Log("average");
@@ -387,23 +444,121 @@ BenchSuite::Log() const
 
 } // BenchSuite::Log()
 
+/**
+ * A built-in event time distribution: points (delay in ns, cumulative
+ * probability) of an empirical CDF, interpolated linearly.
+ */
+struct Preset
+{
+    const char* name;                           /**< Name, for --preset. */
+    const char* description;                    /**< One line description. */
+    std::vector<std::pair<double, double>> cdf; /**< The CDF points. */
+};
+
+/**
+ * Delays of the events scheduled by the event driven run of
+ * `ranger-queue-benchmark --nodeCnts=200 --eventTrace=ranger` (829489 events
+ * over 30 s): dense PHY and CSMA/CA delays of ns to us, 116 us and 556 us
+ * MAC timers, and 1 s and 5 s protocol timers.
+ */
+const Preset g_rangerPreset = {
+    "ranger",
+    "ranger-queue-benchmark, 200 nodes",
+    {
+    {0, 0.0094},
+    {4, 0.0152},
+    {16, 0.0343},
+    {28, 0.0559},
+    {38, 0.0774},
+    {48, 0.0994},
+    {58, 0.1198},
+    {69, 0.14},
+    {81, 0.161},
+    {94, 0.1824},
+    {108, 0.2032},
+    {123, 0.2244},
+    {140, 0.2451},
+    {159, 0.2659},
+    {188, 0.2865},
+    {216, 0.3071},
+    {243, 0.3276},
+    {269, 0.3481},
+    {294, 0.3682},
+    {319, 0.3888},
+    {347, 0.4094},
+    {385, 0.4298},
+    {434, 0.4498},
+    {511, 0.4699},
+    {9359, 0.4873},
+    {40226, 0.49},
+    {47196, 0.4901},
+    {48000, 0.4952},
+    {84588, 0.4961},
+    {88000, 0.5443},
+    {112893, 0.5446},
+    {116000, 0.7377},
+    {459751, 0.7468},
+    {460000, 0.7588},
+    {476000, 0.7764},
+    {491317, 0.7771},
+    {492000, 0.7853},
+    {507346, 0.7859},
+    {508000, 0.7968},
+    {515850, 0.7969},
+    {516000, 0.8058},
+    {533155, 0.8061},
+    {536000, 0.8604},
+    {550932, 0.8606},
+    {556000, 0.9838},
+    {2240000, 0.9901},
+    {100000001, 0.9906},
+    {1000000000, 0.9976},
+    {5000000000, 0.999},
+    {29999999999, 1.0},
+    },
+};
+
+/** The built-in event time distributions. */
+const Preset* g_presets[] = {&g_rangerPreset};
+
 /**
  *  Create a RandomVariableStream to generate next event delays.
  *
- *  If the \p filename parameter is empty a default exponential time
- *  distribution will be used, with mean delay of 100 ns.
+ *  If the \p filename parameter is empty the \p preset distribution
+ *  will be used. The default preset is an exponential time distribution,
+ *  with mean delay of 100 ns.
  *
  *  If the \p filename is `-` standard input will be used.
  *
  *  \param [in] filename The delay interval source file name.
+ *  \param [in] preset The name of a built-in distribution.
  *  \returns The RandomVariableStream.
  */
 Ptr<RandomVariableStream>
-GetRandomStream(std::string filename)
+GetRandomStream(std::string filename, std::string preset)
 {
     Ptr<RandomVariableStream> stream = nullptr;
 
-    if (filename.empty())
+    if (filename.empty() && !preset.empty() && preset != "exp")
+    {
+        for (const auto p : g_presets)
+        {
+            if (preset == p->name)
+            {
+                LOG("  Event time distribution:      preset " << p->name << ", "
+                                                              << p->description);
+                auto erv = CreateObject<EmpiricalRandomVariable>();
+                erv->SetInterpolate(true);
+                for (const auto& point : p->cdf)
+                {
+                    erv->CDF(point.first, point.second);
+                }
+                stream = erv;
+            }
+        }
+        NS_ABORT_MSG_UNLESS(stream, "unknown preset " << preset);
+    }
+    else if (filename.empty())
     {
         LOG("  Event time distribution:      default exponential");
         auto erv = CreateObject<ExponentialRandomVariable>();
@@ -451,12 +606,42 @@ GetRandomStream(std::string filename)
     return stream;
 }
 
+/**
+ * Perform the runs for a single scheduler type, and log them.
+ *
+ * \param [in] factory Factory pre-configured to create the desired Scheduler.
+ * \param [in] pop The event population size.
+ * \param [in] total The total number of events to execute.
+ * \param [in] runs The number of replications.
+ * \param [in] eventStream The random stream of event delays.
+ * \param [in] calRev For the CalendarScheduler, whether the Reverse attribute was set.
+ * \param [in] comparePool Whether to perform the runs without the event pool first.
+ */
+void
+RunSuite(ObjectFactory& factory,
+         uint64_t pop,
+         uint64_t total,
+         uint64_t runs,
+         Ptr<RandomVariableStream> eventStream,
+         bool calRev,
+         bool comparePool)
+{
+    if (comparePool)
+    {
+        EventImpl::SetPoolEnabled(false);
+        BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+        EventImpl::SetPoolEnabled(true);
+    }
+    BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+}
+
 int
 main(int argc, char* argv[])
 {
     bool allSched = false;
     bool schedCal = false;
     bool schedHeap = false;
+    bool schedLadder = false;
     bool schedList = false;
     bool schedMap = false; // default scheduler
     bool schedPQ = false;
@@ -465,23 +650,33 @@ main(int argc, char* argv[])
     uint64_t total = 1000000;
     uint64_t runs = 1;
     std::string filename = "";
+    std::string preset = "exp";
     bool calRev = false;
+    bool comparePool = false;
 
     CommandLine cmd(__FILE__);
     cmd.Usage("Benchmark the simulator scheduler.\n"
               "\n"
               "Event intervals are taken from one of:\n"
               "  an exponential distribution, with mean 100 ns,\n"
+              "  a built-in distribution, given by the --preset=\"<name>\" argument,\n"
               "  an ascii file, given by the --file=\"<filename>\" argument,\n"
               "  or standard input, by the argument --file=\"-\"\n"
               "In the case of either --file form, the input is expected\n"
               "to be ascii, giving the relative event times in ns.\n"
+              "The presets are the event time distributions of recorded\n"
+              "simulations, to replay the traces themselves use --file.\n"
               "\n"
-              "If no scheduler is specified the MapScheduler will be run.");
+              "If no scheduler is specified the MapScheduler will be run.\n"
+              "\n"
+              "The Alloc/ev column gives the heap allocations per event\n"
+              "executed. With --pool, each scheduler is run without the\n"
+              "event pool first, then with it.");
     cmd.AddValue("all", "use all schedulers", allSched);
     cmd.AddValue("cal", "use CalendarScheduler", schedCal);
     cmd.AddValue("calrev", "reverse ordering in the CalendarScheduler", calRev);
     cmd.AddValue("heap", "use HeapScheduler", schedHeap);
+    cmd.AddValue("lad", "use LadderScheduler", schedLadder);
     cmd.AddValue("list", "use ListScheduler", schedList);
     cmd.AddValue("map", "use MapScheduler (default)", schedMap);
     cmd.AddValue("pri", "use PriorityQueue", schedPQ);
@@ -490,6 +685,8 @@ main(int argc, char* argv[])
     cmd.AddValue("total", "total number of events to run", total);
     cmd.AddValue("runs", "number of runs", runs);
     cmd.AddValue("file", "file of relative event times", filename);
+    cmd.AddValue("preset", "built-in event time distribution: exp, ranger", preset);
+    cmd.AddValue("pool", "compare runs without and with the event pool", comparePool);
     cmd.AddValue("prec", "printed output precision", g_fwidth);
     cmd.Parse(argc, argv);
 
@@ -503,34 +700,45 @@ main(int argc, char* argv[])
     LOG("  Number of runs per scheduler: " << runs);
     DEB("debugging is ON");
 
+    if (comparePool && !EventImpl::IsPoolEnabled())
+    {
+        LOG("  The event pool is not built (NS3_EVENT_POOL=OFF), ignoring --pool");
+        comparePool = false;
+    }
+
     if (allSched)
     {
-        schedCal = schedHeap = schedList = schedMap = schedPQ = true;
+        schedCal = schedHeap = schedLadder = schedList = schedMap = schedPQ = true;
     }
     // Set the default case if nothing else is set
-    if (!(schedCal || schedHeap || schedList || schedMap || schedPQ))
+    if (!(schedCal || schedHeap || schedLadder || schedList || schedMap || schedPQ))
     {
         schedMap = true;
     }
 
-    auto eventStream = GetRandomStream(filename);
+    auto eventStream = GetRandomStream(filename, preset);
 
     ObjectFactory factory("ns3::MapScheduler");
     if (schedCal)
     {
         factory.SetTypeId("ns3::CalendarScheduler");
         factory.Set("Reverse", BooleanValue(calRev));
-        BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+        RunSuite(factory, pop, total, runs, eventStream, calRev, comparePool);
         if (allSched)
         {
             factory.Set("Reverse", BooleanValue(!calRev));
-            BenchSuite(factory, pop, total, runs, eventStream, !calRev).Log();
+            RunSuite(factory, pop, total, runs, eventStream, !calRev, comparePool);
         }
     }
     if (schedHeap)
     {
         factory.SetTypeId("ns3::HeapScheduler");
-        BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+        RunSuite(factory, pop, total, runs, eventStream, calRev, comparePool);
+    }
+    if (schedLadder)
+    {
+        factory.SetTypeId("ns3::LadderScheduler");
+        RunSuite(factory, pop, total, runs, eventStream, calRev, comparePool);
     }
     if (schedList)
     {
@@ -541,17 +749,17 @@ main(int argc, char* argv[])
             LOG("Running List scheduler with 1/10 total events");
             listTotal /= 10;
         }
-        BenchSuite(factory, pop, listTotal, runs, eventStream, calRev).Log();
+        RunSuite(factory, pop, listTotal, runs, eventStream, calRev, comparePool);
     }
     if (schedMap)
     {
         factory.SetTypeId("ns3::MapScheduler");
-        BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+        RunSuite(factory, pop, total, runs, eventStream, calRev, comparePool);
     }
     if (schedPQ)
     {
         factory.SetTypeId("ns3::PriorityQueueScheduler");
-        BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+        RunSuite(factory, pop, total, runs, eventStream, calRev, comparePool);
     }
 
     return 0;